@@ -970,6 +970,8 @@ typedef struct zbx_hc_data
 }
 zbx_hc_data_t;
 
+typedef struct zbx_hc_ring zbx_hc_ring_t;
+
 typedef struct
 {
 	zbx_uint64_t	itemid;
@@ -980,6 +982,9 @@ typedef struct
 
 	zbx_hc_data_t	*tail;
 	zbx_hc_data_t	*head;
+
+	/* numeric values without metadata queued after the head, NULL if none */
+	zbx_hc_ring_t	*ring;
 }
 zbx_hc_item_t;
 
@@ -1178,6 +1183,9 @@ void	zbx_dc_correlation_rules_get(zbx_correlation_rules_t *rules);
 
 void	zbx_dc_get_nested_hostgroupids(zbx_uint64_t *groupids, int groupids_num, zbx_vector_uint64_t *nested_groupids);
 void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hostids);
+void	zbx_dc_get_hostids_by_groupids(const zbx_uint64_t *groupids, int groupids_num, zbx_vector_uint64_t *hostids);
+void	zbx_dc_get_hostids_by_triggerids(const zbx_vector_uint64_t *triggerids,
+		zbx_vector_uint64_pair_t *trigger_hosts);
 
 void	zbx_free_item_tag(zbx_item_tag_t *item_tag);
 
@@ -1377,6 +1385,7 @@ void	zbx_dc_close_user_macros(zbx_dc_um_handle_t *um_handle);
 
 void	zbx_dc_get_user_macro(const zbx_dc_um_handle_t *um_handle, const char *macro, const zbx_uint64_t *hostids,
 		int hostids_num, char **value);
+zbx_uint64_t	zbx_dc_get_user_macro_revision(const zbx_dc_um_handle_t *um_handle, zbx_uint64_t hostid);
 
 unsigned char	zbx_dc_get_user_macro_env(zbx_dc_um_handle_t *um_handle);
 
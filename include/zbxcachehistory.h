@@ -175,6 +175,7 @@ void	zbx_hc_get_item_values(zbx_dc_history_t *history, zbx_vector_hc_item_ptr_t
 void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items);
 int	zbx_hc_clear_item_middle(zbx_uint64_t itemid);
 int	zbx_hc_queue_get_size(void);
+void	zbx_hc_set_shard_owner(int process_num);
 int	zbx_hc_get_history_compression_age(void);
 double	zbx_hc_mem_pused(void);
 double	zbx_hc_mem_pused_lock(void);
@@ -183,7 +184,7 @@ void	zbx_hc_remove_items_by_ids(zbx_vector_uint64_t *itemids);
 typedef void (*zbx_sync_history_cache_f)(const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc,
 		zbx_history_sync_stats_t *stats);
 
-int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
+int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_get_config_forks_f get_config_forks,
 		zbx_sync_history_cache_f sync_history_cache_func, zbx_uint64_t history_cache_size,
 		zbx_uint64_t history_index_cache_size, zbx_uint64_t *trends_cache_size, char **error);
 
@@ -207,11 +208,6 @@ int	zbx_hc_proxyqueue_dequeue(zbx_uint64_t proxyid);
 void	zbx_hc_proxyqueue_clear(void);
 void	zbx_dbcache_lock(void);
 void	zbx_dbcache_unlock(void);
-void	zbx_dbcache_set_history_num(int num);
-int	zbx_dbcache_get_history_num(void);
-
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void);
-
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state);
 int	zbx_dbcache_getproxyqueue_state(void);
 void	zbx_hc_acquire(void);
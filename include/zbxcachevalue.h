@@ -45,6 +45,15 @@
  *   either zbx_history_record_vector_destroy() function (free the zbx_vc_get_values()
  *   call output) or zbx_history_record_clear() function (free the zbx_vc_get_value() call output).
  *
+ *   Aggregates over history data can be calculated with zbx_vc_reduce_values() function,
+ *   which passes cached values to the reducer without copying them.
+ *
+ *   Time window aggregates of frequently evaluated functions can be maintained by value
+ *   cache with zbx_vc_get_window_value() function. The first request registers the window
+ *   and fails, afterwards the aggregate is updated whenever item values are added to cache.
+ *   Floating point window sums use compensated summation, so sum and average results can
+ *   differ in the last bits from the sequential summation used for other requests.
+ *
  * Locking
  *
  *   The cache ensures synchronization between processes by using automatic locks whenever
@@ -91,7 +100,11 @@ ZBX_PTR_VECTOR_DECL(vc_item_stats_ptr, zbx_vc_item_stats_t *)
 
 void	zbx_vc_item_stats_free(zbx_vc_item_stats_t *vc_item_stats);
 
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error);
+/* value cache initialization flags */
+#define ZBX_VC_FLAG_LOCKFREE_READS	0x01
+#define ZBX_VC_FLAG_COMPRESSION		0x02
+
+int	zbx_vc_init(zbx_uint64_t value_cache_size, unsigned char flags, char **error);
 
 void	zbx_vc_destroy(void);
 
@@ -107,6 +120,49 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 int	zbx_vc_get_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_timespec_t *ts,
 		zbx_history_record_t *value);
 
+/* history value reducer, gets records sorted in ascending order */
+typedef void	(*zbx_vc_reduce_func_t)(const zbx_history_record_t *records, int records_num, void *data);
+
+int	zbx_vc_reduce_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_reduce_func_t reduce_func, void *data);
+
+/* incrementally maintained aggregates of numeric item values in time window */
+#define ZBX_VC_WINDOW_SUM	0
+#define ZBX_VC_WINDOW_AVG	1
+#define ZBX_VC_WINDOW_MIN	2
+#define ZBX_VC_WINDOW_MAX	3
+#define ZBX_VC_WINDOW_COUNT	4
+
+/* count window value filters */
+#define ZBX_VC_WINDOW_OP_ANY	0
+#define ZBX_VC_WINDOW_OP_EQ	1
+#define ZBX_VC_WINDOW_OP_NE	2
+#define ZBX_VC_WINDOW_OP_GT	3
+#define ZBX_VC_WINDOW_OP_GE	4
+#define ZBX_VC_WINDOW_OP_LT	5
+#define ZBX_VC_WINDOW_OP_LE	6
+#define ZBX_VC_WINDOW_OP_BITAND	7
+
+typedef struct
+{
+	/* ZBX_VC_WINDOW_* aggregate */
+	unsigned char		type;
+
+	/* ZBX_VC_WINDOW_OP_* filter of counted values */
+	unsigned char		op;
+
+	/* the window length in seconds */
+	int			seconds;
+
+	/* the value to compare with and bitand mask */
+	zbx_history_value_t	pattern;
+	zbx_uint64_t		mask;
+}
+zbx_vc_window_t;
+
+int	zbx_vc_get_window_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_vc_window_t *window,
+		const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num);
+
 int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_err);
 
 int	zbx_vc_get_statistics(zbx_vc_stats_t *stats);
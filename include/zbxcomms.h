@@ -17,6 +17,7 @@
 
 #include "zbxalgo.h"
 #include "zbxtime.h"
+#include "zbxcompress.h"
 
 #define ZBX_IPV4_MAX_CIDR_PREFIX	32	/* max number of bits in IPv4 CIDR prefix */
 #define ZBX_IPV6_MAX_CIDR_PREFIX	128	/* max number of bits in IPv6 CIDR prefix */
@@ -223,17 +224,25 @@ typedef struct
 }
 zbx_socket_t;
 
+/* receives the next chunk of (uncompressed) message data */
+typedef int	(*zbx_tcp_recv_stream_cb_t)(void *data, const char *buf, size_t len);
+
 typedef struct
 {
-	size_t		buf_dyn_bytes;
-	size_t		buf_stat_bytes;
-	size_t		offset;
-	zbx_uint64_t	expected_len;
-	zbx_uint64_t	reserved;
-	zbx_uint64_t	max_len;
-	unsigned char	expect;
-	int		protocol_version;
-	size_t		allocated;
+	size_t				buf_dyn_bytes;
+	size_t				buf_stat_bytes;
+	size_t				offset;
+	zbx_uint64_t			expected_len;
+	zbx_uint64_t			reserved;
+	zbx_uint64_t			max_len;
+	unsigned char			expect;
+	int				protocol_version;
+	size_t				allocated;
+
+	/* streaming receive, message data is passed to callback instead of being buffered */
+	zbx_tcp_recv_stream_cb_t	stream_cb;
+	void				*stream_data;
+	zbx_uncompress_stream_t		*uncompress;
 }
 zbx_tcp_recv_context_t;
 
@@ -276,6 +285,10 @@ int	zbx_socket_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char
 #define ZBX_TCP_PROTOCOL		0x01
 #define ZBX_TCP_COMPRESS		0x02
 #define ZBX_TCP_LARGE			0x04
+/* compression codec flags, set together with ZBX_TCP_COMPRESS, zlib is used when none is set */
+#define ZBX_TCP_COMPRESS_ZSTD		0x08
+#define ZBX_TCP_COMPRESS_LZ4		0x10
+#define ZBX_TCP_COMPRESS_CODECS		(ZBX_TCP_COMPRESS_ZSTD | ZBX_TCP_COMPRESS_LZ4)
 
 #define ZBX_TCP_SEC_UNENCRYPTED		1		/* do not use encryption with this socket */
 #define ZBX_TCP_SEC_TLS_PSK		2		/* use TLS with pre-shared key (PSK) with this socket */
@@ -286,6 +299,9 @@ int	zbx_socket_tls_connect(zbx_socket_t *s, unsigned int tls_connect, const char
 
 const char	*zbx_tcp_connection_type_name(unsigned int type);
 
+unsigned char	zbx_tcp_compress_codecs(void);
+int	zbx_tcp_compress_codec(unsigned char flags);
+
 #define zbx_tcp_send(s, d)				zbx_tcp_send_ext((s), (d), strlen(d), 0, ZBX_TCP_PROTOCOL, 0)
 #define zbx_tcp_send_to(s, d, timeout)			zbx_tcp_send_ext((s), (d), strlen(d), 0,	\
 									ZBX_TCP_PROTOCOL, timeout)
@@ -324,6 +340,8 @@ ssize_t	zbx_tcp_read(zbx_socket_t *s, char *buf, size_t len, short *events);
 ssize_t	zbx_tcp_write(zbx_socket_t *s, const char *buf, size_t len, short *event);
 ssize_t		zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags);
 ssize_t		zbx_tcp_recv_raw_ext(zbx_socket_t *s, int timeout);
+ssize_t		zbx_tcp_recv_stream(zbx_socket_t *s, int timeout, unsigned char flags,
+		zbx_tcp_recv_stream_cb_t cb, void *cb_data);
 const char	*zbx_tcp_recv_line(zbx_socket_t *s);
 int		zbx_tcp_read_close_notify(zbx_socket_t *s, int timeout, short *events);
 
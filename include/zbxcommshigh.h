@@ -24,7 +24,8 @@ int	zbx_connect_to_server(zbx_socket_t *sock, const char *source_ip, zbx_vector_
 void	zbx_disconnect_from_server(zbx_socket_t *sock);
 
 int	zbx_get_data_from_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved, char **error);
-int	zbx_put_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved, char **error);
+int	zbx_put_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved,
+		unsigned char codec, char **error);
 
 int	zbx_send_response_ext(zbx_socket_t *sock, int result, const char *info, const char *version, int protocol,
 		int timeout);
@@ -43,6 +44,9 @@ int	zbx_send_response_json(zbx_socket_t *sock, int result, const char *info, con
 
 int	zbx_recv_response(zbx_socket_t *sock, int timeout, char **error);
 
+void	zbx_add_compress_codecs(struct zbx_json *json);
+unsigned char	zbx_get_compress_codec(const struct zbx_json_parse *jp);
+
 void	zbx_add_redirect_response(struct zbx_json *json, const zbx_comms_redirect_t *redirect);
 int	zbx_parse_redirect_response(struct zbx_json_parse *jp, char **host, unsigned short *port,
 		zbx_uint64_t *revision, unsigned char *reset);
@@ -17,8 +17,28 @@
 
 #include "zbxtypes.h"
 
+/* compression codecs, zlib is always available while zstd and LZ4 are optional */
+#define ZBX_COMPRESS_ZLIB	0
+#define ZBX_COMPRESS_ZSTD	1
+#define ZBX_COMPRESS_LZ4	2
+
 int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out);
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out);
 const char	*zbx_compress_strerror(void);
 
+int	zbx_compress_ext(int codec, const char *in, size_t size_in, char **out, size_t *size_out);
+int	zbx_uncompress_ext(int codec, const char *in, size_t size_in, char *out, size_t *size_out);
+int	zbx_compress_codec_supported(int codec);
+const char	*zbx_compress_codec_name(int codec);
+
+typedef int	(*zbx_uncompress_stream_cb_t)(void *data, const char *out, size_t size_out);
+
+typedef struct zbx_uncompress_stream zbx_uncompress_stream_t;
+
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(int codec, size_t size, zbx_uncompress_stream_cb_t cb,
+		void *cb_data);
+int	zbx_uncompress_stream_feed(zbx_uncompress_stream_t *stream, const char *in, size_t size_in);
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream);
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream);
+
 #endif
@@ -582,6 +582,8 @@ void	zbx_db_large_query_append_sql(zbx_db_large_query_t *query, const char *sql)
 zbx_db_query_mask_t	zbx_db_set_log_masked_values(zbx_db_query_mask_t flag);
 zbx_db_query_mask_t	zbx_db_get_log_masked_values(void);
 
+zbx_uint64_t	zbx_db_get_statements_num(void);
+
 /* connection pool settings */
 #define ZBX_SETTINGS_DBPOOL			"dbpool_"
 #define ZBX_SETTINGS_DBPOOL_MAX_IDLE		ZBX_SETTINGS_DBPOOL "max_idle"
@@ -70,10 +70,36 @@ void	zbx_update_proxy_data(zbx_dc_proxy_t *proxy, char *version_str, int version
 
 int	zbx_process_agent_history_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, struct zbx_json_parse *jp,
 		zbx_timespec_t *ts, char **info);
+typedef struct zbx_sender_data_stream	zbx_sender_data_stream_t;
+
+zbx_sender_data_stream_t	*zbx_sender_data_stream_create(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock);
+int	zbx_sender_data_stream_feed(void *data, const char *buf, size_t len);
+const char	*zbx_sender_data_stream_get_json(zbx_sender_data_stream_t *stream);
+void	zbx_sender_data_stream_free(zbx_sender_data_stream_t *stream);
+
 int	zbx_process_sender_history_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, struct zbx_json_parse *jp,
-		zbx_timespec_t *ts, char **info);
+		zbx_sender_data_stream_t *stream, zbx_timespec_t *ts, char **info);
+
+typedef struct zbx_proxy_data_stream	zbx_proxy_data_stream_t;
+
+#define ZBX_PROXY_DATA_HISTORY_PROCESS	0
+#define ZBX_PROXY_DATA_HISTORY_BUFFER	1
+#define ZBX_PROXY_DATA_HISTORY_DISCARD	2
+
+/* resolves and checks source proxy from proxy data members preceding history data, */
+/* returns ZBX_PROXY_DATA_HISTORY_* value                                           */
+typedef int	(*zbx_proxy_data_stream_check_func_t)(void *data, const struct zbx_json_parse *jp,
+		const zbx_dc_proxy_t **proxy);
+
+zbx_proxy_data_stream_t	*zbx_proxy_data_stream_create(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *proxy,
+		zbx_proxy_data_stream_check_func_t check_cb, void *check_data, const zbx_timespec_t *ts,
+		unsigned char proxy_status, int proxydata_frequency);
+int	zbx_proxy_data_stream_feed(void *data, const char *buf, size_t len);
+const char	*zbx_proxy_data_stream_get_json(zbx_proxy_data_stream_t *stream);
+void	zbx_proxy_data_stream_free(zbx_proxy_data_stream_t *stream);
+
 int	zbx_process_proxy_data(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *proxy,
-		const struct zbx_json_parse *jp, const zbx_timespec_t *ts,
+		const struct zbx_json_parse *jp, zbx_proxy_data_stream_t *stream, const zbx_timespec_t *ts,
 		unsigned char proxy_status, const zbx_events_funcs_t *events_cbs, int proxydata_frequency,
 		zbx_discovery_update_host_func_t discovery_update_host_cb,
 		zbx_discovery_update_hosts_func_t discovery_update_hosts_cb,
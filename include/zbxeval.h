@@ -190,6 +190,8 @@ zbx_eval_token_t;
 
 ZBX_VECTOR_DECL(eval_token, zbx_eval_token_t)
 
+typedef struct zbx_eval_program zbx_eval_program_t;
+
 typedef struct
 {
 	const char		*expression;
@@ -203,6 +205,7 @@ typedef struct
 	zbx_eval_function_cb_t	eval_function_common_cb;
 	zbx_eval_function_cb_t	eval_function_history_cb;
 	void			*eval_function_data_cb;
+	zbx_eval_program_t	*program;
 }
 zbx_eval_context_t;
 
@@ -43,6 +43,8 @@ typedef struct
 }
 zbx_ipc_message_t;
 
+typedef struct zbx_ipc_ring zbx_ipc_ring_t;
+
 /* Messaging socket, providing blocking connections to IPC service. */
 /* The IPC socket api is used for simple write/read operations.     */
 typedef struct
@@ -54,6 +56,9 @@ typedef struct
 	unsigned char	rx_buffer[ZBX_IPC_SOCKET_BUFFER_SIZE];
 	zbx_uint32_t	rx_buffer_bytes;
 	zbx_uint32_t	rx_buffer_offset;
+
+	/* shared memory ring for messages sent from client to service (optional) */
+	zbx_ipc_ring_t	*ring;
 }
 zbx_ipc_socket_t;
 
@@ -119,6 +124,7 @@ void	*zbx_ipc_client_get_userdata(zbx_ipc_client_t *client);
 
 int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int timeout, char **error);
 void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket);
+void	zbx_ipc_socket_attach_ring(zbx_ipc_socket_t *csocket, zbx_uint32_t size);
 int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const unsigned char *data,
 		zbx_uint32_t size);
 int	zbx_ipc_socket_read(zbx_ipc_socket_t *csocket, zbx_ipc_message_t *message);
@@ -163,6 +163,7 @@
 #define ZBX_PROTO_TAG_IPMI_PASSWORD		"ipmi_password"
 #define ZBX_PROTO_TAG_DATA_TYPE			"datatype"
 #define ZBX_PROTO_TAG_PROXY_DELAY		"proxy_delay"
+#define ZBX_PROTO_TAG_COMPRESSION		"compression"
 #define ZBX_PROTO_TAG_EXPRESSIONS		"expressions"
 #define ZBX_PROTO_TAG_EXPRESSION		"expression"
 #define ZBX_PROTO_TAG_CLIENTIP			"clientip"
@@ -372,6 +373,42 @@ char		*zbx_json_raw_value_by_path_dyn(const struct zbx_json_parse *jp, const cha
 zbx_json_type_t	zbx_json_valuetype(const char *p);
 struct zbx_json	*zbx_json_clone(const struct zbx_json *src);
 
+/* incremental JSON object reader */
+
+#define ZBX_JSON_STREAM_MEMBER		0	/* top level member with non array value */
+#define ZBX_JSON_STREAM_ARRAY		1	/* start of top level member with array value */
+#define ZBX_JSON_STREAM_ELEMENT		2	/* element of top level array */
+#define ZBX_JSON_STREAM_ARRAY_END	3	/* end of top level array */
+
+/* the callback receives member name and raw JSON text of the value or array element */
+typedef int	(*zbx_json_stream_cb_t)(void *data, int event, const char *name, const char *value, size_t len);
+
+typedef struct
+{
+	zbx_json_stream_cb_t	cb;
+	void			*cb_data;
+
+	char			*name;
+	size_t			name_alloc;
+
+	/* the value being read, kept between chunks */
+	char			*value;
+	size_t			value_alloc;
+	size_t			value_offset;
+
+	int			state;
+	int			level;
+	unsigned char		string;
+	unsigned char		escape;
+	unsigned char		scalar;
+}
+zbx_json_stream_t;
+
+void	zbx_json_stream_init(zbx_json_stream_t *stream, zbx_json_stream_cb_t cb, void *cb_data);
+int	zbx_json_stream_feed(zbx_json_stream_t *stream, const char *data, size_t len);
+int	zbx_json_stream_finish(zbx_json_stream_t *stream);
+void	zbx_json_stream_clear(zbx_json_stream_t *stream);
+
 /* jsonpath support */
 
 typedef struct zbx_jsonpath_segment zbx_jsonpath_segment_t;
@@ -415,19 +452,33 @@ typedef struct
 zbx_jsonobj_el_t;
 
 typedef struct zbx_jsonpath_index zbx_jsonpath_index_t;
+typedef struct zbx_jsonpath_cache zbx_jsonpath_cache_t;
+typedef struct zbx_jsontape zbx_jsontape_t;
 
 int	zbx_jsonpath_compile(const char *path, zbx_jsonpath_t *jsonpath);
 int	zbx_jsonpath_query(const struct zbx_json_parse *jp, const char *path, char **output);
+int	zbx_jsonpath_query_data(const char *data, const zbx_jsonpath_t *jsonpath, char **output);
 void	zbx_jsonpath_clear(zbx_jsonpath_t *jsonpath);
 
 zbx_jsonpath_index_t	*zbx_jsonpath_index_create(char **error);
 void	zbx_jsonpath_index_free(zbx_jsonpath_index_t *index);
 
+zbx_jsonpath_cache_t	*zbx_jsonpath_cache_create(void);
+void	zbx_jsonpath_cache_free(zbx_jsonpath_cache_t *cache);
+const zbx_jsonpath_t	*zbx_jsonpath_cache_get(zbx_jsonpath_cache_t *cache, const char *path);
+
+zbx_jsontape_t	*zbx_jsontape_open(const char *data, char **error);
+void	zbx_jsontape_free(zbx_jsontape_t *tape);
+int	zbx_jsontape_query(zbx_jsontape_t *tape, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output);
+
 void	zbx_jsonobj_init(zbx_jsonobj_t *obj);
 int	zbx_jsonobj_open(const char *data, zbx_jsonobj_t *obj);
 void	zbx_jsonobj_clear(zbx_jsonobj_t *obj);
 int	zbx_jsonobj_query(const zbx_jsonobj_t *obj, const char *path, char **output);
 int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output);
+int	zbx_jsonobj_query_path(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output);
 int	zbx_jsonobj_to_string(char **str, size_t *str_alloc, size_t *str_offset, const zbx_jsonobj_t *obj);
 zbx_jsonobj_t	*zbx_jsonobj_get_value(const zbx_jsonobj_t *obj, const char *name);
 void	zbx_jsonobj_remove_value(zbx_jsonobj_t *obj, const char *name);
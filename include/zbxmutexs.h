@@ -53,6 +53,9 @@ typedef enum
 	ZBX_MUTEX_PROXY_BUFFER,
 	ZBX_MUTEX_VPS_MONITOR,
 	ZBX_MUTEX_DBCONN_POOL,
+	ZBX_MUTEX_HISTORY_SHARD,
+	ZBX_MUTEX_HISTORY_SHARD_LAST = ZBX_MUTEX_HISTORY_SHARD + 14,
+	ZBX_MUTEX_HISTORY_POOL,
 	/* NOTE: Do not forget to sync changes here with mutex names in diag_add_locks_info()! */
 	ZBX_MUTEX_COUNT
 }
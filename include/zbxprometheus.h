@@ -49,6 +49,9 @@ ZBX_PTR_VECTOR_DECL(prometheus_label_index, zbx_prometheus_label_index_t *)
 typedef struct
 {
 	zbx_vector_prometheus_row_t		rows;
+	/* rows indexed by metric name, created when parsing data */
+	zbx_hashset_t				metrics;
+	/* rows indexed by label values, created on demand */
 	zbx_vector_prometheus_label_index_t	indexes;
 	zbx_hashset_t				hints;
 	pthread_mutex_t				index_lock;
@@ -49,6 +49,9 @@ int	zbx_regexp_compile(const char *pattern, zbx_regexp_t **regexp, char **err_ms
 int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp,
 		zbx_uint32_t flags, char **err_msg);
 void	zbx_regexp_free(zbx_regexp_t *regexp);
+int	zbx_regexp_compile_cached(const char *pattern, const zbx_regexp_t **regexp, char **err_msg);
+int	zbx_regexp_compile_ext_cached(const char *pattern, const zbx_regexp_t **regexp, zbx_uint32_t flags,
+		char **err_msg);
 int	zbx_regexp_match_precompiled(const char *string, const zbx_regexp_t *regexp);
 int	zbx_regexp_match_precompiled2(const char *string, const zbx_regexp_t *regexp, char **err_msg);
 char	*zbx_regexp_match(const char *string, const char *pattern, int *len);
@@ -23,6 +23,13 @@
 #define SHMEM_MAX_BUCKET_SIZE		256 /* starting from this size all free chunks are put into the same bucket */
 #define ZBX_SHMEM_BUCKET_COUNT		((SHMEM_MAX_BUCKET_SIZE - ZBX_SHMEM_MIN_BUCKET_SIZE) / 8 + 1)
 
+/* shared memory creation flags */
+#define ZBX_SHMEM_FLAG_SLAB		0x01	/* serve small allocations from fixed size slots */
+
+#define ZBX_SHMEM_SLAB_CLASS_COUNT	11
+
+typedef struct zbx_shmem_slab_class zbx_shmem_slab_class_t;
+
 typedef struct
 {
 	void		*base;
@@ -43,9 +50,21 @@ typedef struct
 
 	const char	*mem_descr;
 	const char	*mem_param;
+
+	/* size classes of slab allocator, NULL if slab allocation is disabled */
+	zbx_shmem_slab_class_t	*slabs;
 }
 zbx_shmem_info_t;
 
+typedef struct
+{
+	zbx_uint64_t	slot_size;
+	unsigned int	pages;
+	unsigned int	slots_total;
+	unsigned int	slots_used;
+}
+zbx_shmem_slab_stats_t;
+
 typedef struct
 {
 	zbx_uint64_t	free_size;
@@ -56,11 +75,15 @@ typedef struct
 	unsigned int	chunks_num[ZBX_SHMEM_BUCKET_COUNT];
 	unsigned int	free_chunks;
 	unsigned int	used_chunks;
+	int		slabs_num;
+	zbx_shmem_slab_stats_t	slabs[ZBX_SHMEM_SLAB_CLASS_COUNT];
 }
 zbx_shmem_stats_t;
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
+int	zbx_shmem_create_ext(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
+		int allow_oom, unsigned char flags, char **error);
 int	zbx_shmem_create_min(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error);
 void	zbx_shmem_destroy(zbx_shmem_info_t *info);
@@ -32,6 +32,21 @@ typedef int	(*zbx_trapper_process_request_func_t)(const char *request, zbx_socke
 		zbx_get_config_forks_f get_config_forks, const zbx_config_tls_t *config_tls,
 		const char *config_frontend_allowed_ip, zbx_ipc_async_socket_t *rtc);
 
+/* request processed while receiving, the received data is passed to feed callback in chunks */
+typedef struct
+{
+	zbx_tcp_recv_stream_cb_t	feed_cb;
+	/* processes the request after the whole data was received */
+	void				(*process_cb)(void *data);
+	void				(*free_cb)(void *data);
+	void				*data;
+}
+zbx_trapper_stream_t;
+
+typedef int	(*zbx_trapper_stream_request_func_t)(const char *request, zbx_socket_t *sock,
+		const zbx_timespec_t *ts, const zbx_config_comms_args_t *config_comms, int proxydata_frequency,
+		const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc, zbx_trapper_stream_t *stream);
+
 typedef struct
 {
 	const zbx_config_comms_args_t		*config_comms;
@@ -53,6 +68,7 @@ typedef struct
 	const char				*config_ssh_key_location;
 	const char				*config_webdriver_url;
 	zbx_trapper_process_request_func_t	trapper_process_request_func_cb;
+	zbx_trapper_stream_request_func_t	trapper_stream_request_func_cb;
 	zbx_autoreg_update_host_func_t		autoreg_update_host_cb;
 	const char				*config_bridge_adapter_url;
 	const char				*config_bridge_adapter_connect_to;
@@ -21,6 +21,9 @@
 #include "zbxipcservice.h"
 #include "zbxjson.h"
 
+/* availability updates are small and infrequent */
+#define AVAILABILITY_IPC_RING_SIZE	(256 * ZBX_KIBIBYTE)
+
 int	zbx_interface_availability_compare_func(const void *d1, const void *d2)
 {
 	const zbx_interface_availability_t	*int_avail_1 = *(const zbx_interface_availability_t **)d1;
@@ -47,6 +50,8 @@ void	zbx_availability_send(zbx_uint32_t code, unsigned char *data, zbx_uint32_t
 			zabbix_log(LOG_LEVEL_CRIT, "cannot connect to availability manager service: %s", error);
 			zbx_exit(EXIT_FAILURE);
 		}
+
+		zbx_ipc_socket_attach_ring(&socket, AVAILABILITY_IPC_RING_SIZE);
 	}
 
 	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
@@ -164,8 +164,23 @@ int	zbx_get_sync_in_progress(void)
 	return sync_in_progress;
 }
 
-#define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1; } while(0)
-#define FINISH_SYNC	do { sync_in_progress = 0; UNLOCK_CACHE; UNLOCK_CACHE_CONFIG_HISTORY; } while(0)
+/* configuration sync write lock statistics, used to report how long readers are blocked */
+static ZBX_THREAD_LOCAL double	sync_lock_ts, sync_lock_sec, sync_lock_max_sec;
+
+static void	dc_sync_lock_stats_update(void)
+{
+	double	sec = zbx_time() - sync_lock_ts;
+
+	sync_lock_sec += sec;
+
+	if (sec > sync_lock_max_sec)
+		sync_lock_max_sec = sec;
+}
+
+#define START_SYNC	do { WRLOCK_CACHE_CONFIG_HISTORY; WRLOCK_CACHE; sync_in_progress = 1;			\
+				sync_lock_ts = zbx_time(); } while(0)
+#define FINISH_SYNC	do { dc_sync_lock_stats_update(); sync_in_progress = 0; UNLOCK_CACHE;			\
+				UNLOCK_CACHE_CONFIG_HISTORY; } while(0)
 
 #define ZBX_SNMP_OID_TYPE_NORMAL	0
 #define ZBX_SNMP_OID_TYPE_DYNAMIC	1
@@ -7946,8 +7961,62 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_vector_dc_function_ptr_t	function_timers, *pfunction_timers = NULL;
 	zbx_vector_trigger_ptr_t	trigger_timers, *ptrigger_timers = NULL;
 
+	/* changesets of the same stage are independent and calculated in parallel */
+	const zbx_dbsync_compare_t	macro_compares[] = {
+		{zbx_dbsync_compare_host_templates, &htmpl_sync},
+		{zbx_dbsync_compare_global_macros, &gmacro_sync},
+		{zbx_dbsync_compare_host_macros, &hmacro_sync},
+		{zbx_dbsync_compare_host_tags, &host_tag_sync}
+	};
+	const zbx_dbsync_compare_t	host_compares[] = {
+		{zbx_dbsync_compare_hosts, &hosts_sync},
+		{zbx_dbsync_compare_host_inventory, &hi_sync},
+		{zbx_dbsync_compare_proxies, &proxy_sync},
+		{zbx_dbsync_compare_host_groups, &hgroups_sync},
+		{zbx_dbsync_compare_host_group_hosts, &hgroup_host_sync},
+		{zbx_dbsync_compare_maintenances, &maintenance_sync},
+		{zbx_dbsync_compare_maintenance_tags, &maintenance_tag_sync},
+		{zbx_dbsync_compare_maintenance_periods, &maintenance_period_sync},
+		{zbx_dbsync_compare_maintenance_groups, &maintenance_group_sync},
+		{zbx_dbsync_compare_maintenance_hosts, &maintenance_host_sync},
+		{zbx_dbsync_prepare_drules, &drules_sync},
+		{zbx_dbsync_prepare_dchecks, &dchecks_sync},
+		{zbx_dbsync_prepare_httptests, &httptest_sync},
+		{zbx_dbsync_prepare_httptest_fields, &httptest_field_sync},
+		{zbx_dbsync_prepare_httpsteps, &httpstep_sync},
+		{zbx_dbsync_prepare_httpstep_fields, &httpstep_field_sync},
+		{zbx_dbsync_compare_connectors, &connector_sync},
+		{zbx_dbsync_compare_connector_tags, &connector_tag_sync},
+		{zbx_dbsync_prepare_host_proxy, &hp_sync}
+	};
+	const zbx_dbsync_compare_t	item_compares[] = {
+		{zbx_dbsync_compare_items, &items_sync},
+		{zbx_dbsync_compare_functions, &func_sync},
+		{zbx_dbsync_compare_item_preprocs, &itempp_sync},
+		{zbx_dbsync_compare_interfaces, &if_sync},
+		{zbx_dbsync_compare_item_discovery, &item_discovery_sync},
+		{zbx_dbsync_compare_item_script_param, &itemscrp_sync}
+	};
+	const zbx_dbsync_compare_t	trigger_compares[] = {
+		{zbx_dbsync_compare_triggers, &triggers_sync},
+		{zbx_dbsync_compare_trigger_tags, &trigger_tag_sync},
+		/* relies on items, must be after DCsync_items() */
+		{zbx_dbsync_compare_item_tags, &item_tag_sync},
+		{zbx_dbsync_compare_trigger_dependency, &tdep_sync},
+		{zbx_dbsync_compare_expressions, &expr_sync},
+		{zbx_dbsync_compare_actions, &action_sync},
+		{zbx_dbsync_compare_action_ops, &action_op_sync},
+		{zbx_dbsync_compare_action_conditions, &action_condition_sync},
+		{zbx_dbsync_compare_correlations, &correlation_sync},
+		{zbx_dbsync_compare_corr_conditions, &corr_condition_sync},
+		{zbx_dbsync_compare_corr_operations, &corr_operation_sync}
+	};
+
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	sync_lock_sec = 0;
+	sync_lock_max_sec = 0;
+
 	zbx_hashset_create(&activated_hosts, 100, ZBX_DEFAULT_ID_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
 	if (ZBX_DBSYNC_INIT == mode)
@@ -8071,17 +8140,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	FINISH_SYNC;
 
 	/* sync macro related data, to support macro resolving during configuration sync */
-
-	if (FAIL == zbx_dbsync_compare_host_templates(&htmpl_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_global_macros(&gmacro_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_host_macros(&hmacro_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_host_tags(&host_tag_sync))
+	if (FAIL == zbx_dbsync_compare_parallel(macro_compares, (int)ARRSIZE(macro_compares)))
 		goto out;
 
 	START_SYNC;
@@ -8103,51 +8162,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	}
 
 	/* sync host data to support host lookups when resolving macros during configuration sync */
-	if (FAIL == zbx_dbsync_compare_proxies(&proxy_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_hosts(&hosts_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_host_inventory(&hi_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_host_groups(&hgroups_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_host_group_hosts(&hgroup_host_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_maintenances(&maintenance_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_tags(&maintenance_tag_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_periods(&maintenance_period_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_groups(&maintenance_group_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_maintenance_hosts(&maintenance_host_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_prepare_drules(&drules_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_prepare_dchecks(&dchecks_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_prepare_httptests(&httptest_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_prepare_httptest_fields(&httptest_field_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_prepare_httpsteps(&httpstep_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_prepare_httpstep_fields(&httpstep_field_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_connectors(&connector_sync))
-		goto out;
-	if (FAIL == zbx_dbsync_compare_connector_tags(&connector_tag_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_prepare_host_proxy(&hp_sync))
+	if (FAIL == zbx_dbsync_compare_parallel(host_compares, (int)ARRSIZE(host_compares)))
 		goto out;
 
 	zbx_hashset_create(&psk_owners, 0, ZBX_DEFAULT_PTR_HASH_FUNC, ZBX_DEFAULT_PTR_COMPARE_FUNC);
@@ -8198,23 +8213,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_vector_uint64_destroy(&active_avail_diff);
 
 	/* sync item data to support item lookups when resolving macros during configuration sync */
-
-	if (FAIL == zbx_dbsync_compare_interfaces(&if_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_items(&items_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_item_discovery(&item_discovery_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_item_preprocs(&itempp_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_item_script_param(&itemscrp_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_functions(&func_sync))
+	if (FAIL == zbx_dbsync_compare_parallel(item_compares, (int)ARRSIZE(item_compares)))
 		goto out;
 
 	START_SYNC;
@@ -8245,38 +8244,7 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 	zbx_dc_flush_history();	/* misconfigured items generate pseudo-historic values to become notsupported */
 
 	/* sync rest of the data */
-	if (FAIL == zbx_dbsync_compare_triggers(&triggers_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_trigger_dependency(&tdep_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_expressions(&expr_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_actions(&action_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_action_ops(&action_op_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_action_conditions(&action_condition_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_trigger_tags(&trigger_tag_sync))
-		goto out;
-
-	/* relies on items, must be after DCsync_items() */
-	if (FAIL == zbx_dbsync_compare_item_tags(&item_tag_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_correlations(&correlation_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_corr_conditions(&corr_condition_sync))
-		goto out;
-
-	if (FAIL == zbx_dbsync_compare_corr_operations(&corr_operation_sync))
+	if (FAIL == zbx_dbsync_compare_parallel(trigger_compares, (int)ARRSIZE(trigger_compares)))
 		goto out;
 
 	START_SYNC;
@@ -8382,6 +8350,9 @@ zbx_uint64_t	zbx_dc_sync_configuration(unsigned char mode, zbx_synced_new_config
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() changelog  : sql:" ZBX_FS_DBL " sec (%d records)",
 				__func__, changelog_sec, changelog_num);
 
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() write lock : " ZBX_FS_DBL " sec (longest " ZBX_FS_DBL " sec).",
+				__func__, sync_lock_sec, sync_lock_max_sec);
+
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() reindex    : " ZBX_FS_DBL " sec " ZBX_FS_I64 " bytes (%d).",
 				__func__, update_sec, update_size, itemtrigs_num);
 		zabbix_log(LOG_LEVEL_DEBUG, "%s() timers     : " ZBX_FS_DBL " sec " ZBX_FS_I64 " bytes"
@@ -9039,8 +9010,8 @@ int	zbx_init_configuration_cache(zbx_get_program_type_f get_program_type, zbx_ge
 	if (SUCCEED != (ret = zbx_rwlock_create(&config_history_lock, ZBX_RWLOCK_CONFIG_HISTORY, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&config_mem, conf_cache_size, "configuration cache",
-			"CacheSize", 0, error)))
+	if (SUCCEED != (ret = zbx_shmem_create_ext(&config_mem, conf_cache_size, "configuration cache",
+			"CacheSize", 0, ZBX_SHMEM_FLAG_SLAB, error)))
 	{
 		goto out;
 	}
@@ -15082,6 +15053,104 @@ void	zbx_dc_get_hostids_by_group_name(const char *name, zbx_vector_uint64_t *hos
 	zbx_vector_uint64_uniq(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets hostids belonging to the groups and their nested groups      *
+ *                                                                            *
+ * Parameter: groupids     - [IN] the group identifiers                       *
+ *            groupids_num - [IN] the number of groups                        *
+ *            hostids      - [OUT] the sorted host identifiers                *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hostids_by_groupids(const zbx_uint64_t *groupids, int groupids_num, zbx_vector_uint64_t *hostids)
+{
+	zbx_vector_uint64_t	nested_groupids;
+
+	zbx_vector_uint64_create(&nested_groupids);
+
+	WRLOCK_CACHE;
+
+	for (int i = 0; i < groupids_num; i++)
+		dc_get_nested_hostgroupids(groupids[i], &nested_groupids);
+
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_sort(&nested_groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(&nested_groupids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	RDLOCK_CACHE;
+
+	for (int i = 0; i < nested_groupids.values_num; i++)
+	{
+		zbx_hashset_iter_t	iter;
+		zbx_uint64_t		*phostid;
+		zbx_dc_hostgroup_t	*group;
+
+		if (NULL == (group = (zbx_dc_hostgroup_t *)zbx_hashset_search(&config->hostgroups,
+				&nested_groupids.values[i])))
+		{
+			continue;
+		}
+
+		zbx_hashset_iter_reset(&group->hostids, &iter);
+
+		while (NULL != (phostid = (zbx_uint64_t *)zbx_hashset_iter_next(&iter)))
+			zbx_vector_uint64_append(hostids, *phostid);
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_destroy(&nested_groupids);
+
+	zbx_vector_uint64_sort(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets hosts of the items used in trigger expressions               *
+ *                                                                            *
+ * Parameter: triggerids    - [IN] the trigger identifiers                    *
+ *            trigger_hosts - [OUT] the sorted (triggerid, hostid) pairs      *
+ *                                                                            *
+ * Comments: Triggers missing from configuration cache are not returned.      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_dc_get_hostids_by_triggerids(const zbx_vector_uint64_t *triggerids,
+		zbx_vector_uint64_pair_t *trigger_hosts)
+{
+	RDLOCK_CACHE;
+
+	for (int i = 0; i < triggerids->values_num; i++)
+	{
+		const ZBX_DC_TRIGGER	*trigger;
+
+		if (NULL == (trigger = (const ZBX_DC_TRIGGER *)zbx_hashset_search(&config->triggers,
+				&triggerids->values[i])) || NULL == trigger->itemids)
+		{
+			continue;
+		}
+
+		for (const zbx_uint64_t *itemid = trigger->itemids; 0 != *itemid; itemid++)
+		{
+			const ZBX_DC_ITEM	*item;
+			zbx_uint64_pair_t	pair;
+
+			if (NULL == (item = (const ZBX_DC_ITEM *)zbx_hashset_search(&config->items, itemid)))
+				continue;
+
+			pair.first = trigger->triggerid;
+			pair.second = item->hostid;
+			zbx_vector_uint64_pair_append(trigger_hosts, pair);
+		}
+	}
+
+	UNLOCK_CACHE;
+
+	zbx_vector_uint64_pair_sort(trigger_hosts, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+	zbx_vector_uint64_pair_uniq(trigger_hosts, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: gets active proxy data by its name from configuration cache       *
@@ -16825,6 +16894,28 @@ void	zbx_dc_get_user_macro(const zbx_dc_um_handle_t *um_handle, const char *macr
 	um_cache_resolve(dc_um_get_cache(um_handle), hostids, hostids_num, macro, um_handle->macro_env, value);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get revision of user macros available to the specified host       *
+ *                                                                            *
+ * Parameters: um_handle - [IN] the user macro cache handle                   *
+ *             hostid    - [IN] the host identifier                           *
+ *                                                                            *
+ * Return value: The latest revision of global macros, host macros and        *
+ *               macros of templates linked to the host.                      *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_dc_get_user_macro_revision(const zbx_dc_um_handle_t *um_handle, zbx_uint64_t hostid)
+{
+	const zbx_um_cache_t	*cache = dc_um_get_cache(um_handle);
+	zbx_uint64_t		revision = 0;
+
+	um_cache_get_host_revision(cache, ZBX_UM_CACHE_GLOBAL_MACRO_HOSTID, &revision);
+	um_cache_get_host_revision(cache, hostid, &revision);
+
+	return revision;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: expand user and function  macros in the specified text value      *
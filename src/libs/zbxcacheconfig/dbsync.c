@@ -27,6 +27,7 @@
 #include "zbxinterface.h"
 #include "zbxip.h"
 #include "zbxtime.h"
+#include "zbxregexp.h"
 
 /* global correlation constants */
 #define ZBX_CORRELATION_ENABLED				0
@@ -39,12 +40,18 @@
 
 #define ZBX_DBSYNC_BATCH_SIZE			1000
 
+/* the minimum number of new changelog records to calculate update changesets in parallel */
+#define ZBX_DBSYNC_PARALLEL_CHANGELOG_MIN	10000
+
 ZBX_VECTOR_IMPL(dbsync_changelog, zbx_dbsync_changelog_t)
 ZBX_VECTOR_IMPL(dbsync_obj_changelog, zbx_dbsync_obj_changelog_t)
 ZBX_PTR_VECTOR_IMPL(dbsync, zbx_dbsync_t *)
 
 static zbx_dbsync_env_t	dbsync_env;
 
+/* database connection of changeset calculation thread, NULL for the default connection */
+static ZBX_THREAD_LOCAL zbx_dbconn_t	*dbsync_conn = NULL;
+
 /* string pool support */
 
 #define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
@@ -64,11 +71,17 @@ static char	*dbsync_strdup(const char *str)
 	void	*ptr;
 	size_t	size = REFCOUNT_FIELD_SIZE + strlen(str) + 1;
 
+	if (NULL != dbsync_env.strpool_lock)
+		pthread_mutex_lock(dbsync_env.strpool_lock);
+
 	ptr = zbx_hashset_insert_ext(&dbsync_env.strpool, str - REFCOUNT_FIELD_SIZE, size, REFCOUNT_FIELD_SIZE,
 			size, ZBX_HASHSET_UNIQ_FALSE);
 
 	(*(zbx_uint32_t *)ptr)++;
 
+	if (NULL != dbsync_env.strpool_lock)
+		pthread_mutex_unlock(dbsync_env.strpool_lock);
+
 	return (char *)ptr + REFCOUNT_FIELD_SIZE;
 }
 
@@ -486,6 +499,8 @@ int	zbx_dbsync_env_prepare(unsigned char mode)
 	zbx_vector_dbsync_create(&dbsync_env.changelog_dbsyncs);
 	zbx_vector_dbsync_create(&dbsync_env.dbsyncs);
 
+	dbsync_env.changelog_num = changelog_num;
+
 	return changelog_num;
 }
 
@@ -558,6 +573,13 @@ void	zbx_dbsync_env_clear(void)
 
 	for (i = 0; i < ARRSIZE(dbsync_env.journals); i++)
 		dbsync_journal_destroy(&dbsync_env.journals[i]);
+
+	/* changesets can reference result sets of the connections, so they are closed after changesets are cleared */
+	for (int j = 0; j < dbsync_env.conns_num; j++)
+		zbx_dbconn_free(dbsync_env.conns[j]);
+
+	dbsync_env.conns_num = 0;
+	dbsync_env.conns_opened = 0;
 }
 
 int	zbx_dbsync_env_changelog_num(void)
@@ -589,6 +611,29 @@ int	zbx_dbsync_env_changelog_dbsyncs_new_records(void)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes select statement using the database connection of the    *
+ *          current changeset calculation thread                              *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_db_result_t	dbsync_select(const char *fmt, ...)
+{
+	va_list		args;
+	zbx_db_result_t	result;
+
+	va_start(args, fmt);
+
+	if (NULL != dbsync_conn)
+		result = zbx_dbconn_vselect(dbsync_conn, fmt, args);
+	else
+		result = zbx_db_vselect(fmt, args);
+
+	va_end(args);
+
+	return result;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get rows changed since last sync                                  *
@@ -615,7 +660,7 @@ static int	dbsync_get_rows(zbx_dbsync_t *sync, char **sql, size_t *sql_alloc, si
 		if (NULL != order_field)
 			zbx_snprintf_alloc(sql, sql_alloc, sql_offset, " order by %s", order_field);
 
-		if (NULL == (result = zbx_db_select("%s", *sql)))
+		if (NULL == (result = dbsync_select("%s", *sql)))
 			return FAIL;
 
 		*sql_offset = sql_offset_reset;
@@ -871,6 +916,222 @@ int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsign
 	return SUCCEED;
 }
 
+/* changeset calculation queue shared by the threads */
+typedef struct
+{
+	const zbx_dbsync_compare_t	*compares;
+	int				compares_num;
+	int				next;		/* the next changeset to calculate */
+	int				ret;
+	pthread_mutex_t			lock;
+}
+dbsync_compare_queue_t;
+
+typedef struct
+{
+	dbsync_compare_queue_t	*queue;
+	zbx_dbconn_t		*db;
+	pthread_t		thread;
+}
+dbsync_compare_worker_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates queued changesets until the queue is empty or a        *
+ *          changeset calculation fails                                       *
+ *                                                                            *
+ * Parameters: queue - [IN/OUT] changeset calculation queue                   *
+ *             db    - [IN] database connection, NULL for the default one     *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_compare_queue_run(dbsync_compare_queue_t *queue, zbx_dbconn_t *db)
+{
+	dbsync_conn = db;
+
+	while (1)
+	{
+		const zbx_dbsync_compare_t	*compare;
+
+		pthread_mutex_lock(&queue->lock);
+
+		if (queue->next == queue->compares_num || SUCCEED != queue->ret)
+		{
+			pthread_mutex_unlock(&queue->lock);
+			break;
+		}
+
+		compare = &queue->compares[queue->next++];
+
+		pthread_mutex_unlock(&queue->lock);
+
+		if (SUCCEED != compare->compare_func(compare->sync))
+		{
+			pthread_mutex_lock(&queue->lock);
+			queue->ret = FAIL;
+			pthread_mutex_unlock(&queue->lock);
+		}
+	}
+
+	dbsync_conn = NULL;
+}
+
+static void	*dbsync_compare_worker_entry(void *args)
+{
+	dbsync_compare_worker_t	*worker = (dbsync_compare_worker_t *)args;
+
+	zbx_init_regexp_env();
+
+	dbsync_compare_queue_run(worker->queue, worker->db);
+
+	zbx_deinit_regexp_env();
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if changesets are worth calculating in parallel threads    *
+ *                                                                            *
+ * Comments: Additional database connections are opened for the parallel      *
+ *           calculation, which costs more than calculating the few changes   *
+ *           of regular update synchronization serially. So the changesets    *
+ *           are calculated in parallel only during initial synchronization   *
+ *           or when there are many configuration changes.                    *
+ *                                                                            *
+ ******************************************************************************/
+static int	dbsync_compare_is_parallel(const zbx_dbsync_compare_t *compares, int compares_num)
+{
+	if (1 == ZBX_DBSYNC_THREADS_MAX || 2 > compares_num)
+		return FAIL;
+
+	for (int i = 0; i < compares_num; i++)
+	{
+		if (ZBX_DBSYNC_INIT == compares[i].sync->mode)
+			return SUCCEED;
+	}
+
+	return ZBX_DBSYNC_PARALLEL_CHANGELOG_MIN <= dbsync_env.changelog_num ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: opens additional database connections for changeset calculation   *
+ *                                                                            *
+ * Parameters: conns_num - [IN] the number of connections to open             *
+ *                                                                            *
+ * Comments: The connections are opened once per synchronization, if the      *
+ *           database refuses new connections the changesets are calculated   *
+ *           with the connections opened so far.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	dbsync_open_connections(int conns_num)
+{
+	if (0 != dbsync_env.conns_opened)
+		return;
+
+	dbsync_env.conns_opened = 1;
+
+	while (dbsync_env.conns_num < conns_num)
+	{
+		zbx_dbconn_t	*db;
+
+		db = zbx_dbconn_create();
+		(void)zbx_dbconn_set_connect_options(db, ZBX_DB_CONNECT_ONCE);
+
+		if (ZBX_DB_OK != zbx_dbconn_open(db))
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot open additional database connection for configuration"
+					" synchronization, using %d connection(s)", dbsync_env.conns_num + 1);
+			zbx_dbconn_free(db);
+			break;
+		}
+
+		/* retry queries until database is available, like the default connection does */
+		(void)zbx_dbconn_set_connect_options(db, ZBX_DB_CONNECT_NORMAL);
+		dbsync_env.conns[dbsync_env.conns_num++] = db;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates changesets in parallel threads                         *
+ *                                                                            *
+ * Parameters: compares     - [IN] changeset calculation functions and their  *
+ *                                 changesets                                 *
+ *             compares_num - [IN] the number of changesets                   *
+ *                                                                            *
+ * Return value: SUCCEED - the changesets were successfully calculated        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The changesets must be independent - calculated from different   *
+ *           tables and journals. The configuration cache is only read while  *
+ *           calculating changesets and must not be modified until this       *
+ *           function returns, the changesets are applied afterwards by the   *
+ *           calling thread.                                                  *
+ *           Changesets are calculated in parallel only during initial        *
+ *           synchronization or when there are many changelog records.        *
+ *           Every additional thread selects data with its own database       *
+ *           connection, the calling thread uses the default connection. If   *
+ *           additional connections cannot be opened or threads cannot be     *
+ *           created, the remaining changesets are calculated by the calling  *
+ *           thread.                                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_dbsync_compare_parallel(const zbx_dbsync_compare_t *compares, int compares_num)
+{
+	dbsync_compare_queue_t	queue;
+	dbsync_compare_worker_t	workers[ZBX_DBSYNC_THREADS_MAX];
+	int			i, err, workers_num = 0, parallel;
+
+	queue.compares = compares;
+	queue.compares_num = compares_num;
+	queue.next = 0;
+	queue.ret = SUCCEED;
+
+	if (SUCCEED == (parallel = dbsync_compare_is_parallel(compares, compares_num)))
+		dbsync_open_connections(MIN(compares_num, ZBX_DBSYNC_THREADS_MAX) - 1);
+
+	if (SUCCEED != parallel || 0 == dbsync_env.conns_num || 0 != (err = pthread_mutex_init(&queue.lock, NULL)))
+	{
+		for (i = 0; i < compares_num; i++)
+		{
+			if (SUCCEED != compares[i].compare_func(compares[i].sync))
+				return FAIL;
+		}
+
+		return SUCCEED;
+	}
+
+	dbsync_env.strpool_lock = &queue.lock;
+
+	for (i = 0; i < dbsync_env.conns_num && i < compares_num - 1; i++)
+	{
+		dbsync_compare_worker_t	*worker = &workers[workers_num];
+
+		worker->queue = &queue;
+		worker->db = dbsync_env.conns[i];
+
+		if (0 != (err = pthread_create(&worker->thread, NULL, dbsync_compare_worker_entry, (void *)worker)))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot create configuration synchronization thread: %s",
+					zbx_strerror(err));
+			break;
+		}
+
+		workers_num++;
+	}
+
+	dbsync_compare_queue_run(&queue, NULL);
+
+	for (i = 0; i < workers_num; i++)
+		pthread_join(workers[i].thread, NULL);
+
+	dbsync_env.strpool_lock = NULL;
+	pthread_mutex_destroy(&queue.lock);
+
+	return queue.ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: encode serialized expression to be returned as db field           *
@@ -908,7 +1169,7 @@ static char	*encode_expression(const zbx_eval_context_t *ctx)
  *     On success this function produces a changeset with 0 or 1 record       *
  *     because 'config_autoreg_tls' table can have no more than 1 record.     *
  *     If in future you want to support multiple autoregistration PSKs and/or *
- *     select more columns in zbx_db_select() then do not forget to sync      *
+ *     select more columns in dbsync_select() then do not forget to sync      *
  *     changes with DCsync_autoreg_config() !!!                               *
  *                                                                            *
  ******************************************************************************/
@@ -919,11 +1180,11 @@ int	zbx_dbsync_compare_autoreg_psk(zbx_dbsync_t *sync)
 	int		num_records = 0;
 
 	zbx_dcsync_sql_start(sync);
-#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following zbx_db_select() */
+#define CONFIG_AUTOREG_TLS_FIELD_COUNT	2	/* number of columns in the following dbsync_select() */
 
-	if (NULL == (result = zbx_db_select("select tls_psk_identity,tls_psk"
+	if (NULL == (result = dbsync_select("select tls_psk_identity,tls_psk"
 			" from config_autoreg_tls"
-			" order by autoreg_tlsid")))	/* if you change number of columns in zbx_db_select(), */
+			" order by autoreg_tlsid")))	/* if you change number of columns in dbsync_select(), */
 							/* adjust CONFIG_AUTOREG_TLS_FIELD_COUNT */
 	{
 		return FAIL;
@@ -987,7 +1248,7 @@ int	zbx_dbsync_compare_autoreg_host(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (sync->dbresult = zbx_db_select(
+	if (NULL == (sync->dbresult = dbsync_select(
 			"select host,listen_ip,listen_dns,host_metadata,flags,listen_port,tls_accepted"
 			" from autoreg_host"
 			" where proxyid is null")))
@@ -1032,7 +1293,7 @@ int	zbx_dbsync_compare_hosts(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -1108,7 +1369,7 @@ int	zbx_dbsync_compare_host_inventory(zbx_dbsync_t *sync)
 			"poc_2_cell,poc_2_screen,poc_2_notes"
 			" from host_inventory";
 
-	if (NULL == (result = zbx_db_select("%s", sql)))
+	if (NULL == (result = dbsync_select("%s", sql)))
 	{
 		zbx_dcsync_sql_end(sync);
 		return FAIL;
@@ -1184,7 +1445,7 @@ int	zbx_dbsync_compare_host_templates(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select hostid,templateid"
 			" from hosts_templates"
 			" order by hostid")))
@@ -1326,7 +1587,7 @@ int	zbx_dbsync_compare_global_macros(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select globalmacroid,macro,value,type"
 			" from globalmacro")))
 	{
@@ -1461,7 +1722,7 @@ int	zbx_dbsync_compare_host_macros(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select hostmacroid,hostid,macro,value,type from hostmacro")))
+	if (NULL == (result = dbsync_select("select hostmacroid,hostid,macro,value,type from hostmacro")))
 		return FAIL;
 
 	dbsync_prepare(sync, 5, NULL);
@@ -1688,7 +1949,7 @@ int	zbx_dbsync_compare_interfaces(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select i.interfaceid,i.hostid,i.type,i.main,i.useip,i.ip,i.dns,i.port,"
 			"i.available,i.disable_until,i.error,i.errors_from,"
 			"s.version,s.bulk,s.community,s.securityname,s.securitylevel,s.authpassphrase,s.privpassphrase,"
@@ -1823,7 +2084,7 @@ int	zbx_dbsync_compare_items(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -1860,7 +2121,7 @@ int	zbx_dbsync_compare_item_discovery(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -1980,7 +2241,7 @@ int	zbx_dbsync_compare_triggers(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2018,7 +2279,7 @@ int	zbx_dbsync_compare_trigger_dependency(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select triggerid_down,triggerid_up from trigger_depends")))
+	if (NULL == (result = dbsync_select("select triggerid_down,triggerid_up from trigger_depends")))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -2130,7 +2391,7 @@ int	zbx_dbsync_compare_functions(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2197,7 +2458,7 @@ int	zbx_dbsync_compare_expressions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select r.name,e.expressionid,e.expression,e.expression_type,e.exp_delimiter,e.case_sensitive"
 			" from regexps r,expressions e"
 			" where r.regexpid=e.regexpid")))
@@ -2298,7 +2559,7 @@ int	zbx_dbsync_compare_actions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select actionid,eventsource,evaltype,formula"
 			" from actions"
 			" where eventsource<>%d"
@@ -2400,7 +2661,7 @@ int	zbx_dbsync_compare_action_ops(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select a.actionid,o.recovery"
 			" from actions a"
 			" left join operations o"
@@ -2500,7 +2761,7 @@ int	zbx_dbsync_compare_action_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select c.conditionid,c.actionid,c.conditiontype,c.operator,c.value,c.value2"
 			" from conditions c,actions a"
 			" where c.actionid=a.actionid"
@@ -2580,7 +2841,7 @@ int	zbx_dbsync_compare_trigger_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2618,7 +2879,7 @@ int	zbx_dbsync_compare_item_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2656,7 +2917,7 @@ int	zbx_dbsync_compare_host_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -2716,7 +2977,7 @@ int	zbx_dbsync_compare_correlations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select correlationid,name,evaltype,formula"
 			" from correlation"
 			" where status=%d",
@@ -2846,7 +3107,7 @@ int	zbx_dbsync_compare_corr_conditions(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select cc.corr_conditionid,cc.correlationid,cc.type,cct.tag,cctv.tag,cctv.value,cctv.operator,"
 				" ccg.groupid,ccg.operator,cctp.oldtag,cctp.newtag"
 			" from correlation c,corr_condition cc"
@@ -2955,7 +3216,7 @@ int	zbx_dbsync_compare_corr_operations(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select co.corr_operationid,co.correlationid,co.type"
 			" from correlation c,corr_operation co"
 			" where c.correlationid=co.correlationid"
@@ -3050,7 +3311,7 @@ int	zbx_dbsync_compare_host_groups(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select groupid,name from hstgrp where type=%d", HOSTGROUP_TYPE_HOST)))
+	if (NULL == (result = dbsync_select("select groupid,name from hstgrp where type=%d", HOSTGROUP_TYPE_HOST)))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -3122,7 +3383,7 @@ int	zbx_dbsync_compare_item_preprocs(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3212,7 +3473,7 @@ int	zbx_dbsync_compare_item_script_param(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select p.item_parameterid,p.itemid,p.name,p.value,i.hostid"
 			" from item_parameter p,items i,hosts h"
 			" where p.itemid=i.itemid"
@@ -3297,7 +3558,7 @@ int	zbx_dbsync_compare_maintenances(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
+	if (NULL == (result = dbsync_select("select maintenanceid,maintenance_type,active_since,active_till,tags_evaltype"
 						" from maintenances")))
 	{
 		return FAIL;
@@ -3395,7 +3656,7 @@ int	zbx_dbsync_compare_maintenance_tags(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenancetagid,maintenanceid,operator,tag,value"
+	if (NULL == (result = dbsync_select("select maintenancetagid,maintenanceid,operator,tag,value"
 						" from maintenance_tag")))
 	{
 		return FAIL;
@@ -3509,7 +3770,7 @@ int	zbx_dbsync_compare_maintenance_periods(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
+	if (NULL == (result = dbsync_select("select t.timeperiodid,t.timeperiod_type,t.every,t.month,t.dayofweek,t.day,"
 						"t.start_time,t.period,t.start_date,m.maintenanceid"
 					" from maintenances_windows m,timeperiods t"
 					" where t.timeperiodid=m.timeperiodid")))
@@ -3587,7 +3848,7 @@ int	zbx_dbsync_compare_maintenance_groups(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
+	if (NULL == (result = dbsync_select("select maintenanceid,groupid from maintenances_groups order by maintenanceid")))
 		return FAIL;
 
 	dbsync_prepare(sync, 2, NULL);
@@ -3667,7 +3928,7 @@ int	zbx_dbsync_compare_maintenance_hosts(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
+	if (NULL == (result = dbsync_select("select maintenanceid,hostid from maintenances_hosts order by maintenanceid")))
 	{
 		return FAIL;
 	}
@@ -3749,7 +4010,7 @@ int	zbx_dbsync_compare_host_group_hosts(zbx_dbsync_t *sync)
 
 	zbx_dcsync_sql_start(sync);
 
-	if (NULL == (result = zbx_db_select(
+	if (NULL == (result = dbsync_select(
 			"select hg.groupid,hg.hostid"
 			" from hosts_groups hg,hosts h"
 			" where hg.hostid=h.hostid"
@@ -3840,7 +4101,7 @@ int	zbx_dbsync_prepare_drules(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 
 		goto out;
@@ -3884,7 +4145,7 @@ int	zbx_dbsync_prepare_dchecks(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3922,7 +4183,7 @@ int	zbx_dbsync_prepare_httptests(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3960,7 +4221,7 @@ int	zbx_dbsync_prepare_httptest_fields(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -3997,7 +4258,7 @@ int	zbx_dbsync_prepare_httpsteps(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4034,7 +4295,7 @@ int	zbx_dbsync_prepare_httpstep_fields(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4077,7 +4338,7 @@ int	zbx_dbsync_compare_connectors(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4107,7 +4368,7 @@ int	zbx_dbsync_compare_connector_tags(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4144,7 +4405,7 @@ int	zbx_dbsync_compare_proxies(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4183,7 +4444,7 @@ int	zbx_dbsync_prepare_proxy_group(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
@@ -4226,7 +4487,7 @@ int	zbx_dbsync_prepare_host_proxy(zbx_dbsync_t *sync)
 
 	if (ZBX_DBSYNC_INIT == sync->mode)
 	{
-		if (NULL == (sync->dbresult = zbx_db_select("%s", sql)))
+		if (NULL == (sync->dbresult = dbsync_select("%s", sql)))
 			ret = FAIL;
 		goto out;
 	}
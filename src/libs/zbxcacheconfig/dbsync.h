@@ -47,6 +47,13 @@
 #define ZBX_DBSYNC_TYPE_DIFF		0
 #define ZBX_DBSYNC_TYPE_CHANGELOG	1
 
+/* the maximum number of threads calculating changesets, see zbx_dbsync_compare_parallel() */
+#if defined(HAVE_SQLITE3)
+#	define ZBX_DBSYNC_THREADS_MAX	1
+#else
+#	define ZBX_DBSYNC_THREADS_MAX	4
+#endif
+
 /* Changelog objects.                                            */
 /* This list includes virtual objects that are not written into  */
 /* changelog table, but the insert/updates/deletes are copied    */
@@ -185,9 +192,29 @@ typedef struct
 
 	zbx_vector_dbsync_t		changelog_dbsyncs;
 	zbx_vector_dbsync_t		dbsyncs;
+
+	/* the number of new changelog records in the current synchronization */
+	int				changelog_num;
+
+	/* additional database connections used to calculate changesets in parallel, */
+	/* opened on demand and kept until the end of synchronization                */
+	zbx_dbconn_t			*conns[ZBX_DBSYNC_THREADS_MAX];
+	int				conns_num;
+	unsigned char			conns_opened;
+
+	/* string pool lock, set while changesets are calculated by multiple threads */
+	pthread_mutex_t			*strpool_lock;
 }
 zbx_dbsync_env_t;
 
+/* changeset calculation function and its changeset */
+typedef struct
+{
+	int		(*compare_func)(zbx_dbsync_t *sync);
+	zbx_dbsync_t	*sync;
+}
+zbx_dbsync_compare_t;
+
 void	zbx_dbsync_env_init(zbx_dc_config_t *cache);
 void	zbx_dbsync_env_destroy(void);
 int	zbx_dbsync_env_prepare(unsigned char mode);
@@ -201,6 +228,7 @@ void	zbx_dbsync_init_changelog(zbx_dbsync_t *sync, const char *name, unsigned ch
 void	zbx_dbsync_clear(zbx_dbsync_t *sync);
 int	zbx_dbsync_get_row_num(const zbx_dbsync_t *sync);
 int	zbx_dbsync_next(zbx_dbsync_t *sync, zbx_uint64_t *rowid, char ***row, unsigned char *tag);
+int	zbx_dbsync_compare_parallel(const zbx_dbsync_compare_t *compares, int compares_num);
 
 void	dbsync_prepare(zbx_dbsync_t *sync, int columns_num, zbx_dbsync_preproc_row_func_t preproc_row_func);
 
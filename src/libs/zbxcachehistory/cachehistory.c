@@ -95,12 +95,6 @@ zbx_hc_proxyqueue_t;
 typedef struct
 {
 	zbx_hashset_t		trends;
-	zbx_dc_stats_t		stats;
-
-	zbx_hashset_t		history_items;
-	zbx_binary_heap_t	history_queue;
-
-	int			history_num;
 	int			trends_num;
 	int			trends_last_cleanup_hour;
 	int			history_num_total;
@@ -111,8 +105,6 @@ typedef struct
 	unsigned char		db_trigger_queue_lock;
 
 	zbx_hc_proxyqueue_t	proxyqueue;
-	int			processing_num;
-	double			last_error_ts;
 	double			last_warning_ts;
 	int			refcount;
 }
@@ -120,6 +112,53 @@ ZBX_DC_CACHE;
 
 static ZBX_DC_CACHE	*cache = NULL;
 
+/* History items are partitioned between shards by itemid, each shard having its own lock, memory and queue. */
+/* The first shard uses history cache lock and memory, so a single shard cache works as unsharded one.      */
+/* Lock order is history cache lock first, then the other shard locks in ascending order.                   */
+#define ZBX_HC_SHARDS_MAX	(ZBX_MUTEX_HISTORY_SHARD_LAST - ZBX_MUTEX_HISTORY_SHARD + 2)
+
+/* the minimum history cache size per shard */
+#define ZBX_HC_SHARD_SIZE_MIN	(32 * ZBX_MEBIBYTE)
+
+typedef struct
+{
+	zbx_dc_stats_t		stats;
+
+	zbx_hashset_t		history_items;
+	zbx_binary_heap_t	history_queue;
+
+	int			history_num;
+	int			processing_num;
+	double			last_error_ts;
+}
+zbx_hc_shard_data_t;
+
+typedef struct
+{
+	zbx_mutex_t		lock;
+	zbx_shmem_info_t	*mem;
+	zbx_shmem_info_t	*index_mem;
+	zbx_hc_shard_data_t	*data;
+}
+zbx_hc_shard_t;
+
+static zbx_hc_shard_t	hc_shards[ZBX_HC_SHARDS_MAX];
+static int		hc_shards_num = 0;
+
+/* Shards share half of history cache memory, so a shard receiving most of values is not limited to its own  */
+/* part. The pool is locked only when allocating or freeing pool memory, always after the shard lock.        */
+static zbx_shmem_info_t	*hc_pool_mem = NULL;
+static zbx_mutex_t	hc_pool_lock = ZBX_MUTEX_NULL;
+
+/* the shard history syncer drains first before taking items from other shards */
+static int		hc_shard_owned = 0;
+
+/* the shard locked by the current thread */
+static ZBX_THREAD_LOCAL zbx_hc_shard_data_t	*shard = NULL;
+static ZBX_THREAD_LOCAL zbx_shmem_info_t	*shard_mem = NULL;
+static ZBX_THREAD_LOCAL zbx_shmem_info_t	*shard_index_mem = NULL;
+static ZBX_THREAD_LOCAL int			shard_locked_index = 0;
+
 /* local history cache */
 #define ZBX_MAX_VALUES_LOCAL	256
 #define ZBX_STRUCT_REALLOC_STEP	8
@@ -162,6 +201,8 @@ static ZBX_THREAD_LOCAL char		*string_values = NULL;
 static ZBX_THREAD_LOCAL size_t		string_values_alloc = 0, string_values_offset = 0;
 static ZBX_THREAD_LOCAL dc_item_value_t	*item_values = NULL;
 static ZBX_THREAD_LOCAL size_t		item_values_alloc = 0, item_values_num = 0;
+static ZBX_THREAD_LOCAL dc_item_value_t	*shard_values = NULL;
+static ZBX_THREAD_LOCAL size_t		shard_values_alloc = 0;
 
 static void	hc_add_item_values(dc_item_value_t *values, int values_num);
 static void	hc_queue_item(zbx_hc_item_t *item);
@@ -169,6 +210,145 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2);
 static void	hc_get_items(zbx_vector_uint64_pair_t *items);
 static void	zbx_log_sync_trends_cache_progress(void);
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns index of history cache shard owning the item              *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_shard_index(zbx_uint64_t itemid)
+{
+	return (int)(itemid % (zbx_uint64_t)hc_shards_num);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects shard for history index and memory operations of the     *
+ *          current thread                                                    *
+ *                                                                            *
+ * Comments: The shard must be locked by caller.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_shard_set(int index)
+{
+	shard = hc_shards[index].data;
+	shard_mem = hc_shards[index].mem;
+	shard_index_mem = hc_shards[index].index_mem;
+	shard_locked_index = index;
+}
+
+static void	hc_shard_lock(int index)
+{
+	zbx_mutex_lock(hc_shards[index].lock);
+	hc_shard_set(index);
+}
+
+static void	hc_shard_unlock(int index)
+{
+	zbx_mutex_unlock(hc_shards[index].lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: locks history cache shards except the first one                   *
+ *                                                                            *
+ * Comments: The first shard is protected by history cache lock, which must   *
+ *           be held by caller.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_lock_other_shards(void)
+{
+	for (int i = 1; i < hc_shards_num; i++)
+		zbx_mutex_lock(hc_shards[i].lock);
+}
+
+static void	hc_unlock_other_shards(void)
+{
+	for (int i = hc_shards_num - 1; 0 < i; i--)
+		zbx_mutex_unlock(hc_shards[i].lock);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums value statistics of all shards                               *
+ *                                                                            *
+ * Comments: All shards must be locked by caller.                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_shard_stats(zbx_dc_stats_t *stats)
+{
+	memset(stats, 0, sizeof(zbx_dc_stats_t));
+
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		const zbx_dc_stats_t	*shard_stats = &hc_shards[i].data->stats;
+
+		stats->history_counter += shard_stats->history_counter;
+		stats->history_float_counter += shard_stats->history_float_counter;
+		stats->history_uint_counter += shard_stats->history_uint_counter;
+		stats->history_str_counter += shard_stats->history_str_counter;
+		stats->history_log_counter += shard_stats->history_log_counter;
+		stats->history_text_counter += shard_stats->history_text_counter;
+		stats->history_bin_counter += shard_stats->history_bin_counter;
+		stats->history_json_counter += shard_stats->history_json_counter;
+		stats->notsupported_counter += shard_stats->notsupported_counter;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums memory sizes of all shards and shared history pool           *
+ *                                                                            *
+ * Parameters: index      - [IN] 0 - history memory, 1 - history index memory *
+ *             total_size - [OUT]                                             *
+ *             free_size  - [OUT]                                             *
+ *                                                                            *
+ * Comments: All shards must be locked by caller.                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_get_shard_mem_size(int index, zbx_uint64_t *total_size, zbx_uint64_t *free_size)
+{
+	*total_size = 0;
+	*free_size = 0;
+
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		const zbx_shmem_info_t	*mem = (0 == index ? hc_shards[i].mem : hc_shards[i].index_mem);
+
+		*total_size += mem->total_size;
+		*free_size += mem->free_size;
+	}
+
+	if (0 == index && NULL != hc_pool_mem)
+	{
+		zbx_mutex_lock(hc_pool_lock);
+		*total_size += hc_pool_mem->total_size;
+		*free_size += hc_pool_mem->free_size;
+		zbx_mutex_unlock(hc_pool_lock);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of values in history cache                         *
+ *                                                                            *
+ * Comments: Shards are locked one at a time, so caller must not hold any     *
+ *           shard lock.                                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_get_history_num(void)
+{
+	int	history_num = 0;
+
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		zbx_mutex_lock(hc_shards[i].lock);
+		history_num += hc_shards[i].data->history_num;
+		zbx_mutex_unlock(hc_shards[i].lock);
+	}
+
+	return history_num;
+}
+
 void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 {
 	if (0 != (opt->flags & ZBX_PP_VALUE_OPT_LOG))
@@ -185,12 +365,13 @@ void	zbx_pp_value_opt_clear(zbx_pp_value_opt_t *opt)
 void	zbx_dc_get_stats_all(zbx_wcache_info_t *wcache_info)
 {
 	LOCK_CACHE;
+	hc_lock_other_shards();
+
+	hc_get_shard_stats(&wcache_info->stats);
+	hc_get_shard_mem_size(0, &wcache_info->history_total, &wcache_info->history_free);
+	hc_get_shard_mem_size(1, &wcache_info->index_total, &wcache_info->index_free);
 
-	wcache_info->stats = cache->stats;
-	wcache_info->history_free = hc_mem->free_size;
-	wcache_info->history_total = hc_mem->total_size;
-	wcache_info->index_free = hc_index_mem->free_size;
-	wcache_info->index_total = hc_index_mem->total_size;
+	hc_unlock_other_shards();
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -211,57 +392,66 @@ void	*zbx_dc_get_stats(int request)
 	static zbx_uint64_t	value_uint;
 	static double		value_double;
 	void			*ret;
+	zbx_dc_stats_t		stats;
+	zbx_uint64_t		history_total, history_free, index_total, index_free;
 
 	LOCK_CACHE;
+	hc_lock_other_shards();
+
+	hc_get_shard_stats(&stats);
+	hc_get_shard_mem_size(0, &history_total, &history_free);
+	hc_get_shard_mem_size(1, &index_total, &index_free);
+
+	hc_unlock_other_shards();
 
 	switch (request)
 	{
 		case ZBX_STATS_HISTORY_COUNTER:
-			value_uint = cache->stats.history_counter;
+			value_uint = stats.history_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FLOAT_COUNTER:
-			value_uint = cache->stats.history_float_counter;
+			value_uint = stats.history_float_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_UINT_COUNTER:
-			value_uint = cache->stats.history_uint_counter;
+			value_uint = stats.history_uint_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_STR_COUNTER:
-			value_uint = cache->stats.history_str_counter;
+			value_uint = stats.history_str_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_LOG_COUNTER:
-			value_uint = cache->stats.history_log_counter;
+			value_uint = stats.history_log_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TEXT_COUNTER:
-			value_uint = cache->stats.history_text_counter;
+			value_uint = stats.history_text_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_NOTSUPPORTED_COUNTER:
-			value_uint = cache->stats.notsupported_counter;
+			value_uint = stats.notsupported_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_TOTAL:
-			value_uint = hc_mem->total_size;
+			value_uint = history_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_USED:
-			value_uint = hc_mem->total_size - hc_mem->free_size;
+			value_uint = history_total - history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_FREE:
-			value_uint = hc_mem->free_size;
+			value_uint = history_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_PUSED:
-			value_double = 100 * (double)(hc_mem->total_size - hc_mem->free_size) / hc_mem->total_size;
+			value_double = 100 * (double)(history_total - history_free) / history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_PFREE:
-			value_double = 100 * (double)hc_mem->free_size / hc_mem->total_size;
+			value_double = 100 * (double)history_free / history_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_TREND_TOTAL:
@@ -286,32 +476,31 @@ void	*zbx_dc_get_stats(int request)
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_TOTAL:
-			value_uint = hc_index_mem->total_size;
+			value_uint = index_total;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_USED:
-			value_uint = hc_index_mem->total_size - hc_index_mem->free_size;
+			value_uint = index_total - index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_FREE:
-			value_uint = hc_index_mem->free_size;
+			value_uint = index_free;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PUSED:
-			value_double = 100 * (double)(hc_index_mem->total_size - hc_index_mem->free_size) /
-					hc_index_mem->total_size;
+			value_double = 100 * (double)(index_total - index_free) / index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_INDEX_PFREE:
-			value_double = 100 * (double)hc_index_mem->free_size / hc_index_mem->total_size;
+			value_double = 100 * (double)index_free / index_total;
 			ret = (void *)&value_double;
 			break;
 		case ZBX_STATS_HISTORY_BIN_COUNTER:
-			value_uint = cache->stats.history_bin_counter;
+			value_uint = stats.history_bin_counter;
 			ret = (void *)&value_uint;
 			break;
 		case ZBX_STATS_HISTORY_JSON_COUNTER:
-			value_uint = cache->stats.history_json_counter;
+			value_uint = stats.history_json_counter;
 			ret = (void *)&value_uint;
 			break;
 		default:
@@ -1941,9 +2130,10 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 {
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
-	zbx_binary_heap_t	tmp_history_queue;
+	zbx_binary_heap_t	tmp_history_queue[ZBX_HC_SHARDS_MAX];
+	int			i;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* History index cache might be full without any space left for queueing items from history index to  */
 	/* history queue. The solution: replace the shared-memory history queue with heap-allocated one. Add  */
@@ -1962,18 +2152,24 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 		zbx_dc_config_unlock_all_triggers();
 	}
 
-	tmp_history_queue = cache->history_queue;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_set(i);
 
-	zbx_binary_heap_create(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+		tmp_history_queue[i] = shard->history_queue;
 
-	/* add all items from history index to the new history queue */
-	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (NULL != item->tail)
+		zbx_binary_heap_create(&shard->history_queue, hc_queue_elem_compare_func,
+				ZBX_BINARY_HEAP_OPTION_EMPTY);
+		zbx_hashset_iter_reset(&shard->history_items, &iter);
+
+		/* add all items from history index to the new history queue */
+		while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 		{
-			item->status = ZBX_HC_ITEM_STATUS_NORMAL;
-			hc_queue_item(item);
+			if (NULL != item->tail)
+			{
+				item->status = ZBX_HC_ITEM_STATUS_NORMAL;
+				hc_queue_item(item);
+			}
 		}
 	}
 
@@ -1988,15 +2184,18 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 			sync_history_cache_cb(events_cbs, NULL, &stats);
 
 			zabbix_log(LOG_LEVEL_WARNING, "syncing history data... " ZBX_FS_DBL "%%",
-					(double)stats.values_num / (cache->history_num + stats.values_num) * 100);
+					(double)stats.values_num / (hc_get_history_num() + stats.values_num) * 100);
 		}
 		while (0 != zbx_hc_queue_get_size());
 
 		zabbix_log(LOG_LEVEL_WARNING, "syncing history data done");
 	}
 
-	zbx_binary_heap_destroy(&cache->history_queue);
-	cache->history_queue = tmp_history_queue;
+	for (i = 0; i < hc_shards_num; i++)
+	{
+		zbx_binary_heap_destroy(&hc_shards[i].data->history_queue);
+		hc_shards[i].data->history_queue = tmp_history_queue[i];
+	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -2009,7 +2208,9 @@ static void	sync_history_cache_full(const zbx_events_funcs_t *events_cbs)
 void	zbx_log_sync_history_cache_progress(void)
 {
 	double		pcnt = -1.0;
-	int		ts_last, ts_next, sec;
+	int		ts_last, ts_next, sec, history_num;
+
+	history_num = hc_get_history_num();
 
 	LOCK_CACHE;
 
@@ -2024,16 +2225,16 @@ void	zbx_log_sync_history_cache_progress(void)
 
 	if (0 == cache->history_progress_ts)
 	{
-		cache->history_num_total = cache->history_num;
+		cache->history_num_total = history_num;
 		cache->history_progress_ts = sec;
 	}
 
-	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == cache->history_num)
+	if (ZBX_HC_SYNC_TIME_MAX <= sec - cache->history_progress_ts || 0 == history_num)
 	{
 		if (0 != cache->history_num_total)
-			pcnt = 100 * (double)(cache->history_num_total - cache->history_num) / cache->history_num_total;
+			pcnt = 100 * (double)(cache->history_num_total - history_num) / cache->history_num_total;
 
-		cache->history_progress_ts = (0 == cache->history_num ? INT_MAX : sec);
+		cache->history_progress_ts = (0 == history_num ? INT_MAX : sec);
 	}
 
 	ts_next = cache->history_progress_ts;
@@ -2112,7 +2313,7 @@ static void	zbx_log_sync_trends_cache_progress(void)
 void	zbx_sync_history_cache(const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc,
 		zbx_history_sync_stats_t *stats)
 {
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, cache->history_num);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() history_num:%d", __func__, hc_get_history_num());
 
 	/* zbx_sync_history_cache_server or zbx_sync_history_cache_proxy */
 	sync_history_cache_cb(events_cbs, rtc, stats);
@@ -2668,25 +2869,84 @@ void	zbx_dc_add_history_variant(zbx_uint64_t itemid, unsigned char value_type, u
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds item values to history cache shard                           *
+ *                                                                            *
+ * Parameters: index      - [IN] the shard index                              *
+ *             values     - [IN] the item values to add                       *
+ *             values_num - [IN] the number of item values to add             *
+ *                                                                            *
+ * Return value: number of history syncers processing the shard values        *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_add_shard_item_values(int index, dc_item_value_t *values, int values_num)
+{
+	int	processing_num;
+
+	hc_shard_lock(index);
+
+	hc_add_item_values(values, values_num);
+	shard->history_num += values_num;
+	processing_num = shard->processing_num;
+
+	hc_shard_unlock(index);
+
+	return processing_num;
+}
+
 size_t	zbx_dc_flush_history(void)
 {
+	size_t	count = item_values_num;
+	int	processing_num;
+
 	if (0 == item_values_num)
 		return 0;
 
-	LOCK_CACHE;
+	if (1 == hc_shards_num)
+	{
+		processing_num = hc_add_shard_item_values(0, item_values, (int)item_values_num);
+	}
+	else
+	{
+		size_t	offsets[ZBX_HC_SHARDS_MAX + 1] = {0}, i;
+		int	index;
 
-	hc_add_item_values(item_values, item_values_num);
+		if (shard_values_alloc < item_values_num)
+		{
+			shard_values_alloc = item_values_alloc;
+			shard_values = (dc_item_value_t *)zbx_realloc(shard_values,
+					sizeof(dc_item_value_t) * shard_values_alloc);
+		}
 
-	cache->history_num += item_values_num;
+		/* stable partition of values by shards keeps the order of item values */
+		for (i = 0; i < item_values_num; i++)
+			offsets[hc_shard_index(item_values[i].itemid) + 1]++;
 
-	int	processing_num = cache->processing_num;
-	size_t	count = item_values_num;
+		for (index = 0; index < hc_shards_num; index++)
+			offsets[index + 1] += offsets[index];
+
+		for (i = 0; i < item_values_num; i++)
+			shard_values[offsets[hc_shard_index(item_values[i].itemid)]++] = item_values[i];
+
+		/* processing_num is set to 0 if any of the shards are not being processed */
+		processing_num = 1;
+
+		for (index = 0, i = 0; index < hc_shards_num; index++)
+		{
+			if (offsets[index] == i)
+				continue;
+
+			if (0 == hc_add_shard_item_values(index, shard_values + i, (int)(offsets[index] - i)))
+				processing_num = 0;
+
+			i = offsets[index];
+		}
+	}
 
 	item_values_num = 0;
 	string_values_offset = 0;
 
-	UNLOCK_CACHE;
-
 	zbx_vps_monitor_add_collected((zbx_uint64_t)count);
 
 	if (0 != processing_num)
@@ -2701,7 +2961,72 @@ size_t	zbx_dc_flush_history(void)
  *                                                                            *
  ******************************************************************************/
 ZBX_SHMEM_FUNC_IMPL(__hc_index, hc_index_mem)
-ZBX_SHMEM_FUNC_IMPL(__hc, hc_mem)
+ZBX_SHMEM_FUNC_IMPL(__hc_shard_index, shard_index_mem)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if memory was allocated from shared history pool           *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_pool_owns(const void *ptr)
+{
+	if (NULL == hc_pool_mem || ptr < hc_pool_mem->lo_bound || ptr >= hc_pool_mem->hi_bound)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates history value memory                                    *
+ *                                                                            *
+ * Comments: Memory is allocated from the current shard, falling back to the  *
+ *           shared history pool when the shard is full.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	*__hc_shmem_malloc_func(void *old, size_t size)
+{
+	void	*ptr;
+
+	if (NULL != (ptr = zbx_shmem_malloc(shard_mem, old, size)) || NULL == hc_pool_mem)
+		return ptr;
+
+	zbx_mutex_lock(hc_pool_lock);
+	ptr = zbx_shmem_malloc(hc_pool_mem, old, size);
+	zbx_mutex_unlock(hc_pool_lock);
+
+	return ptr;
+}
+
+static void	*__hc_shmem_realloc_func(void *old, size_t size)
+{
+	void	*ptr;
+
+	if (NULL == old)
+		return __hc_shmem_malloc_func(NULL, size);
+
+	if (SUCCEED != hc_pool_owns(old))
+		return zbx_shmem_realloc(shard_mem, old, size);
+
+	zbx_mutex_lock(hc_pool_lock);
+	ptr = zbx_shmem_realloc(hc_pool_mem, old, size);
+	zbx_mutex_unlock(hc_pool_lock);
+
+	return ptr;
+}
+
+static void	__hc_shmem_free_func(void *ptr)
+{
+	if (SUCCEED != hc_pool_owns(ptr))
+	{
+		zbx_shmem_free(shard_mem, ptr);
+		return;
+	}
+
+	zbx_mutex_lock(hc_pool_lock);
+	zbx_shmem_free(hc_pool_mem, ptr);
+	zbx_mutex_unlock(hc_pool_lock);
+}
 
 /******************************************************************************
  *                                                                            *
@@ -2719,12 +3044,12 @@ static int	hc_queue_elem_compare_func(const void *d1, const void *d2)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: free history item data allocated in history cache                 *
+ * Purpose: free history item data value allocated in history cache           *
  *                                                                            *
  * Parameters: data - [IN] history item data                                  *
  *                                                                            *
  ******************************************************************************/
-static void	hc_free_data(zbx_hc_data_t *data)
+static void	hc_free_data_value(zbx_hc_data_t *data)
 {
 	if (ITEM_STATE_NOTSUPPORTED == data->state)
 	{
@@ -2760,95 +3085,449 @@ static void	hc_free_data(zbx_hc_data_t *data)
 			}
 		}
 	}
-
-	__hc_shmem_free_func(data);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: put back item into history queue                                  *
+ * Purpose: free history item data allocated in history cache                 *
  *                                                                            *
  * Parameters: data - [IN] history item data                                  *
  *                                                                            *
  ******************************************************************************/
-static void	hc_queue_item(zbx_hc_item_t *item)
+static void	hc_free_data(zbx_hc_data_t *data)
 {
-	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
-
-	zbx_binary_heap_insert(&cache->history_queue, &elem);
+	hc_free_data_value(data);
+	__hc_shmem_free_func(data);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: returns history item by itemid                                    *
+ * history value ring                                                         *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Numeric values without metadata are the bulk of collected data. Instead of *
+ * allocating history data node per value, such values queued after the last  *
+ * node of item are stored in item value ring - a chain of chunks holding     *
+ * timestamps and values in contiguous arrays. The first chunk is allocated   *
+ * together with ring header, the following chunks double in size up to the   *
+ * maximum chunk size. Values are never copied when ring grows and a smaller  *
+ * chunk is allocated if shared memory is too fragmented for the preferred    *
+ * size.                                                                      *
  *                                                                            *
- * Return value: the history item or NULL if the requested item is not in     *
- *               history cache                                                *
+ * The oldest item value (tail) is always kept as history data node, so       *
+ * history syncers can process it without knowing about rings. When tail is   *
+ * processed and there are no more nodes, the next ring value is moved into   *
+ * the tail node.                                                             *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+
+#define ZBX_HC_RING_CHUNK_MIN	4
+#define ZBX_HC_RING_CHUNK_MAX	256
+
+typedef struct zbx_hc_ring_chunk
 {
-	return (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid);
+	zbx_timespec_t			*ts;
+	zbx_history_value_t		*values;
+	int				values_alloc;
+
+	/* the index of the oldest and the newest value in chunk, last_value is -1 in empty chunk */
+	int				first_value;
+	int				last_value;
+
+	/* the next (newer) chunk */
+	struct zbx_hc_ring_chunk	*next;
 }
+zbx_hc_ring_chunk_t;
+
+struct zbx_hc_ring
+{
+	/* the chunk with the oldest values */
+	zbx_hc_ring_chunk_t	*tail;
+
+	/* the chunk where new values are appended */
+	zbx_hc_ring_chunk_t	*head;
+
+	int			values_num;
+	unsigned char		value_type;
+	unsigned char		flags;
+
+	/* the first chunk, allocated together with ring header */
+	zbx_hc_ring_chunk_t	chunk;
+};
+
+#define ZBX_HC_RING_VALUES_SIZE(values_alloc)	\
+		((size_t)(values_alloc) * (sizeof(zbx_timespec_t) + sizeof(zbx_history_value_t)))
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds a new item to history cache                                  *
+ * Purpose: check if value can be stored in item value ring                   *
  *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
- *                      [IN] the item data                                    *
+ * Parameters: ring       - [IN] the item value ring, can be NULL             *
+ *             item_value - [IN] the item value                               *
  *                                                                            *
- * Return value: the added history item                                       *
+ * Return value: SUCCEED - the value can be stored in ring                    *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
-{
-	zbx_hc_item_t	item_local = {.itemid = itemid, .status = ZBX_HC_ITEM_STATUS_NORMAL,
-			.cache = ZBX_HC_ITEM_CACHE_TRUE, .values_num = 0, .tail = data, .head = data};
-
-	return (zbx_hc_item_t *)zbx_hashset_insert(&cache->history_items, &item_local, sizeof(item_local));
-}
-
-void	zbx_hc_remove_items_by_ids(zbx_vector_uint64_t *itemids)
+static int	hc_ring_accepts_value(const zbx_hc_ring_t *ring, const dc_item_value_t *item_value)
 {
-	LOCK_CACHE;
-
-	for (int i = 0; i < itemids->values_num; i++)
-	{
-		zbx_hc_item_t	*item = hc_get_item(itemids->values[i]);
+	if (ITEM_STATE_NORMAL != item_value->state)
+		return FAIL;
 
-		if (NULL == item)
-			continue;
+	if (ITEM_VALUE_TYPE_FLOAT != item_value->value_type && ITEM_VALUE_TYPE_UINT64 != item_value->value_type)
+		return FAIL;
 
-		if (NULL == item->tail)
-		{
-			zbx_hashset_remove_direct(&cache->history_items, item);
-			continue;
-		}
+	if (0 != (item_value->flags & (ZBX_DC_FLAG_META | ZBX_DC_FLAG_NOVALUE | ZBX_DC_FLAG_LLD | ZBX_DC_FLAG_UNDEF)))
+		return FAIL;
 
-		item->cache = ZBX_HC_ITEM_CACHE_FALSE;
-	}
+	if (NULL != ring && (ring->value_type != item_value->value_type || ring->flags != item_value->flags))
+		return FAIL;
 
-	UNLOCK_CACHE;
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: item might already being processed and last value might hold      *
- *          metadata, clear all values except first and last                  *
- *                                                                            *
- * Parameters: itemid - [IN] the item id                                      *
+ * Purpose: initialize item value ring chunk                                  *
  *                                                                            *
- * Return value: number of values cleared or FAIL if item was not found       *
+ * Parameters: chunk        - [OUT] the chunk                                 *
+ *             values_alloc - [IN] the number of value slots                  *
+ *             storage      - [IN] the memory for timestamps and values       *
  *                                                                            *
  ******************************************************************************/
-int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
+static void	hc_ring_chunk_init(zbx_hc_ring_chunk_t *chunk, int values_alloc, void *storage)
 {
-	int	i = 0;
-
-	LOCK_CACHE;
+	chunk->ts = (zbx_timespec_t *)storage;
+	chunk->values = (zbx_history_value_t *)(chunk->ts + values_alloc);
+	chunk->values_alloc = values_alloc;
+	chunk->first_value = 0;
+	chunk->last_value = -1;
+	chunk->next = NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate item value ring chunk                                    *
+ *                                                                            *
+ * Parameters: values_alloc - [IN] the preferred number of value slots        *
+ *                                                                            *
+ * Return value: the allocated chunk or NULL if there was not enough memory   *
+ *                                                                            *
+ * Comments: If the preferred size cannot be allocated smaller chunks are     *
+ *           tried, so the ring does not need more contiguous memory than     *
+ *           history data nodes would.                                        *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_ring_chunk_t	*hc_ring_chunk_create(int values_alloc)
+{
+	zbx_hc_ring_chunk_t	*chunk;
+
+	for (; ZBX_HC_RING_CHUNK_MIN <= values_alloc; values_alloc /= 2)
+	{
+		if (NULL != (chunk = (zbx_hc_ring_chunk_t *)__hc_shmem_malloc_func(NULL,
+				ZBX_SIZE_T_ALIGN8(sizeof(zbx_hc_ring_chunk_t)) + ZBX_HC_RING_VALUES_SIZE(values_alloc))))
+		{
+			hc_ring_chunk_init(chunk, values_alloc, (char *)chunk +
+					ZBX_SIZE_T_ALIGN8(sizeof(zbx_hc_ring_chunk_t)));
+
+			return chunk;
+		}
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate item value ring                                          *
+ *                                                                            *
+ * Return value: the allocated ring or NULL if there was not enough memory    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_ring_t	*hc_ring_create(unsigned char value_type, unsigned char flags)
+{
+	zbx_hc_ring_t	*ring;
+
+	if (NULL == (ring = (zbx_hc_ring_t *)__hc_shmem_malloc_func(NULL, ZBX_SIZE_T_ALIGN8(sizeof(zbx_hc_ring_t)) +
+			ZBX_HC_RING_VALUES_SIZE(ZBX_HC_RING_CHUNK_MIN))))
+	{
+		return NULL;
+	}
+
+	hc_ring_chunk_init(&ring->chunk, ZBX_HC_RING_CHUNK_MIN, (char *)ring + ZBX_SIZE_T_ALIGN8(sizeof(zbx_hc_ring_t)));
+	ring->tail = &ring->chunk;
+	ring->head = &ring->chunk;
+	ring->values_num = 0;
+	ring->value_type = value_type;
+	ring->flags = flags;
+
+	return ring;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free item value ring chunk unless it's allocated with ring header *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_ring_chunk_free(zbx_hc_ring_t *ring, zbx_hc_ring_chunk_t *chunk)
+{
+	if (&ring->chunk != chunk)
+		__hc_shmem_free_func(chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free item value ring with all its chunks                          *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_ring_free(zbx_hc_ring_t *ring)
+{
+	zbx_hc_ring_chunk_t	*chunk, *next;
+
+	for (chunk = ring->tail; NULL != chunk; chunk = next)
+	{
+		next = chunk->next;
+		hc_ring_chunk_free(ring, chunk);
+	}
+
+	__hc_shmem_free_func(ring);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: append value to item value ring                                   *
+ *                                                                            *
+ * Parameters: item       - [IN] the history item                             *
+ *             item_value - [IN] the item value                               *
+ *                                                                            *
+ * Return value: SUCCEED - the value was appended                             *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_append(zbx_hc_item_t *item, const dc_item_value_t *item_value)
+{
+	zbx_hc_ring_t		*ring = item->ring;
+	zbx_hc_ring_chunk_t	*chunk;
+	int			index;
+
+	if (NULL == ring)
+	{
+		if (NULL == (ring = hc_ring_create(item_value->value_type, item_value->flags)))
+			return FAIL;
+
+		item->ring = ring;
+	}
+	else if (ring->head->last_value == ring->head->values_alloc - 1)
+	{
+		if (NULL == (chunk = hc_ring_chunk_create(MIN(ring->head->values_alloc * 2, ZBX_HC_RING_CHUNK_MAX))))
+			return FAIL;
+
+		ring->head->next = chunk;
+		ring->head = chunk;
+	}
+
+	chunk = ring->head;
+	index = ++chunk->last_value;
+	chunk->ts[index] = item_value->ts;
+
+	if (ITEM_VALUE_TYPE_FLOAT == item_value->value_type)
+		chunk->values[index].dbl = item_value->value.value_dbl;
+	else
+		chunk->values[index].ui64 = item_value->value.value_uint;
+
+	ring->values_num++;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move the oldest value from item value ring into history data      *
+ *                                                                            *
+ * Parameters: item - [IN] the history item                                   *
+ *             data - [OUT] the history data                                  *
+ *                                                                            *
+ * Comments: The chunks are freed when their last value is moved and the      *
+ *           ring is freed together with its last value.                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_ring_pop(zbx_hc_item_t *item, zbx_hc_data_t *data)
+{
+	zbx_hc_ring_t		*ring = item->ring;
+	zbx_hc_ring_chunk_t	*chunk = ring->tail;
+
+	data->value = chunk->values[chunk->first_value];
+	data->ts = chunk->ts[chunk->first_value];
+	data->lastlogsize = 0;
+	data->sz_value = 0;
+	data->mtime = 0;
+	data->value_type = ring->value_type;
+	data->flags = ring->flags;
+	data->state = ITEM_STATE_NORMAL;
+
+	if (0 == --ring->values_num)
+	{
+		hc_ring_free(ring);
+		item->ring = NULL;
+	}
+	else if (++chunk->first_value > chunk->last_value)
+	{
+		ring->tail = chunk->next;
+		hc_ring_chunk_free(ring, chunk);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: move item value ring values to history data nodes                 *
+ *                                                                            *
+ * Parameters: item - [IN] the history item                                   *
+ *                                                                            *
+ * Return value: SUCCEED - all ring values were moved                         *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ * Comments: Values are moved one by one, so the value order is preserved    *
+ *           also when the function fails and is called again later.          *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_flush(zbx_hc_item_t *item)
+{
+	while (NULL != item->ring)
+	{
+		zbx_hc_data_t	*data;
+
+		if (NULL == (data = (zbx_hc_data_t *)__hc_shmem_malloc_func(NULL, sizeof(zbx_hc_data_t))))
+			return FAIL;
+
+		hc_ring_pop(item, data);
+		data->next = NULL;
+
+		item->head->next = data;
+		item->head = data;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove all values from item value ring except the newest one      *
+ *                                                                            *
+ * Parameters: item - [IN] the history item                                   *
+ *                                                                            *
+ * Return value: number of removed values                                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	hc_ring_clear_middle(zbx_hc_item_t *item)
+{
+	zbx_hc_ring_t		*ring = item->ring;
+	zbx_hc_ring_chunk_t	*chunk;
+	int			removed_num;
+
+	while (ring->tail != ring->head)
+	{
+		chunk = ring->tail;
+		ring->tail = chunk->next;
+		hc_ring_chunk_free(ring, chunk);
+	}
+
+	removed_num = ring->values_num - 1;
+	ring->head->first_value = ring->head->last_value;
+	ring->values_num = 1;
+
+	return removed_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: put back item into history queue                                  *
+ *                                                                            *
+ * Parameters: data - [IN] history item data                                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_queue_item(zbx_hc_item_t *item)
+{
+	zbx_binary_heap_elem_t	elem = {item->itemid, (void *)item};
+
+	zbx_binary_heap_insert(&shard->history_queue, &elem);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns history item by itemid                                    *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item id                                      *
+ *                                                                            *
+ * Return value: the history item or NULL if the requested item is not in     *
+ *               history cache                                                *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_item_t	*hc_get_item(zbx_uint64_t itemid)
+{
+	return (zbx_hc_item_t *)zbx_hashset_search(&shard->history_items, &itemid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds a new item to history cache                                  *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item id                                      *
+ *                      [IN] the item data                                    *
+ *                                                                            *
+ * Return value: the added history item                                       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_hc_item_t	*hc_add_item(zbx_uint64_t itemid, zbx_hc_data_t *data)
+{
+	zbx_hc_item_t	item_local = {.itemid = itemid, .status = ZBX_HC_ITEM_STATUS_NORMAL,
+			.cache = ZBX_HC_ITEM_CACHE_TRUE, .values_num = 0, .tail = data, .head = data};
+
+	return (zbx_hc_item_t *)zbx_hashset_insert(&shard->history_items, &item_local, sizeof(item_local));
+}
+
+void	zbx_hc_remove_items_by_ids(zbx_vector_uint64_t *itemids)
+{
+	for (int index = 0; index < hc_shards_num; index++)
+	{
+		hc_shard_lock(index);
+
+		for (int i = 0; i < itemids->values_num; i++)
+		{
+			zbx_hc_item_t	*item;
+
+			if (index != hc_shard_index(itemids->values[i]))
+				continue;
+
+			if (NULL == (item = hc_get_item(itemids->values[i])))
+				continue;
+
+			if (NULL == item->tail)
+			{
+				zbx_hashset_remove_direct(&shard->history_items, item);
+				continue;
+			}
+
+			item->cache = ZBX_HC_ITEM_CACHE_FALSE;
+		}
+
+		hc_shard_unlock(index);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: item might already being processed and last value might hold      *
+ *          metadata, clear all values except first and last                  *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item id                                      *
+ *                                                                            *
+ * Return value: number of values cleared or FAIL if item was not found       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
+{
+	int	i = 0, index = hc_shard_index(itemid);
+
+	hc_shard_lock(index);
 
 	zbx_hc_item_t	*item;
 
@@ -2856,7 +3535,24 @@ int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
 	{
 		if (NULL != item->tail)
 		{
-			if (NULL != item->tail->next)
+			if (NULL != item->ring)
+			{
+				/* the last value is in ring, remove all nodes except tail */
+				while (NULL != item->tail->next)
+				{
+					zbx_hc_data_t	*next = item->tail->next;
+
+					item->tail->next = next->next;
+
+					hc_free_data(next);
+					i++;
+				}
+
+				item->head = item->tail;
+				i += hc_ring_clear_middle(item);
+				item->values_num -= i;
+			}
+			else if (NULL != item->tail->next)
 			{
 				for (zbx_hc_data_t *tail = item->tail; NULL != tail->next->next;)
 				{
@@ -2872,13 +3568,13 @@ int	zbx_hc_clear_item_middle(zbx_uint64_t itemid)
 			else
 				item->cache = ZBX_HC_ITEM_CACHE_FALSE;
 
-			cache->history_num -= i;
+			shard->history_num -= i;
 		}
 	}
 	else
 		i = FAIL;
 
-	UNLOCK_CACHE;
+	hc_shard_unlock(index);
 
 	return i;
 }
@@ -2973,6 +3669,47 @@ static int	hc_clone_history_log_data(zbx_log_value_t **dst, const dc_item_value_
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates history cache statistics with the added item value        *
+ *                                                                            *
+ * Parameters: item_value - [IN] the item value                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_update_value_stats(const dc_item_value_t *item_value)
+{
+	switch (item_value->item_value_type)
+	{
+		case ITEM_VALUE_TYPE_FLOAT:
+			shard->stats.history_float_counter++;
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+			shard->stats.history_uint_counter++;
+			break;
+		case ITEM_VALUE_TYPE_STR:
+			shard->stats.history_str_counter++;
+			break;
+		case ITEM_VALUE_TYPE_TEXT:
+			shard->stats.history_text_counter++;
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			shard->stats.history_log_counter++;
+			break;
+		case ITEM_VALUE_TYPE_BIN:
+			shard->stats.history_bin_counter++;
+			break;
+		case ITEM_VALUE_TYPE_JSON:
+			shard->stats.history_json_counter++;
+			break;
+		case ITEM_VALUE_TYPE_NONE:
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			zbx_exit(EXIT_FAILURE);
+	}
+
+	shard->stats.history_counter++;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: clones item value from local cache into history cache             *
@@ -3015,7 +3752,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		(*data)->sz_value = item_value->value.value_str.len;
 		(*data)->value_type = item_value->value_type;
 
-		cache->stats.notsupported_counter++;
+		shard->stats.notsupported_counter++;
 
 		return SUCCEED;
 	}
@@ -3028,8 +3765,8 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 		(*data)->sz_value = item_value->value.value_str.len;
 		(*data)->value_type = ITEM_VALUE_TYPE_TEXT;
 
-		cache->stats.history_text_counter++;
-		cache->stats.history_counter++;
+		shard->stats.history_text_counter++;
+		shard->stats.history_counter++;
 
 		return SUCCEED;
 	}
@@ -3065,36 +3802,7 @@ static int	hc_clone_history_data(zbx_hc_data_t **data, const dc_item_value_t *it
 				zbx_exit(EXIT_FAILURE);
 		}
 
-		switch (item_value->item_value_type)
-		{
-			case ITEM_VALUE_TYPE_FLOAT:
-				cache->stats.history_float_counter++;
-				break;
-			case ITEM_VALUE_TYPE_UINT64:
-				cache->stats.history_uint_counter++;
-				break;
-			case ITEM_VALUE_TYPE_STR:
-				cache->stats.history_str_counter++;
-				break;
-			case ITEM_VALUE_TYPE_TEXT:
-				cache->stats.history_text_counter++;
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				cache->stats.history_log_counter++;
-				break;
-			case ITEM_VALUE_TYPE_BIN:
-				cache->stats.history_bin_counter++;
-				break;
-			case ITEM_VALUE_TYPE_JSON:
-				cache->stats.history_json_counter++;
-				break;
-			case ITEM_VALUE_TYPE_NONE:
-			default:
-				THIS_SHOULD_NEVER_HAPPEN;
-				zbx_exit(EXIT_FAILURE);
-		}
-
-		cache->stats.history_counter++;
+		hc_update_value_stats(item_value);
 	}
 
 	(*data)->value_type = item_value->value_type;
@@ -3127,13 +3835,13 @@ static void	hc_log_history_cache_usage(zbx_vector_uint64_pair_t *items)
 	const char	*log_msg = "History cache is full. Sleeping for 1 second.";
 	double		time_now = zbx_time();
 
-	if (SEC_PER_MIN > time_now - cache->last_error_ts)
+	if (SEC_PER_MIN > time_now - shard->last_error_ts)
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "%s", log_msg);
 		return;
 	}
 
-	cache->last_error_ts = time_now;
+	shard->last_error_ts = time_now;
 
 	zabbix_log(LOG_LEVEL_WARNING, "%s", log_msg);
 	zbx_hc_log_high_cache_usage(items);
@@ -3170,6 +3878,31 @@ void	zbx_hc_log_high_cache_usage(zbx_vector_uint64_pair_t *items)
 	zbx_free(str);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: releases history cache shard lock and waits for history syncers   *
+ *          to free space in the shard or shared history pool                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_wait_for_free_space(void)
+{
+	zbx_vector_uint64_pair_t	items;
+	int				index = shard_locked_index;
+
+	zbx_vector_uint64_pair_create(&items);
+
+	hc_get_items(&items);
+
+	hc_shard_unlock(index);
+
+	hc_log_history_cache_usage(&items);
+
+	zbx_vector_uint64_pair_destroy(&items);
+	sleep(1);
+
+	hc_shard_lock(index);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: adds item values to the history cache                             *
@@ -3194,6 +3927,33 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 
 		item_value = &values[i];
 
+		/* values not fitting into item value ring must be queued after the ring values */
+		while (NULL != (item = hc_get_item(item_value->itemid)) && NULL != item->ring &&
+				SUCCEED != hc_ring_accepts_value(item->ring, item_value) &&
+				SUCCEED != hc_ring_flush(item))
+		{
+			hc_wait_for_free_space();
+		}
+
+		/* numeric values queued after other item values are stored in item value ring */
+		if (NULL != item && NULL != item->tail && SUCCEED == hc_ring_accepts_value(item->ring, item_value))
+		{
+			while (SUCCEED != hc_ring_append(item, item_value))
+			{
+				hc_wait_for_free_space();
+
+				if (NULL == (item = hc_get_item(item_value->itemid)) || NULL == item->tail)
+					break;
+			}
+
+			if (NULL != item && NULL != item->tail)
+			{
+				hc_update_value_stats(item_value);
+				item->values_num++;
+				continue;
+			}
+		}
+
 		/* a record with metadata and no value can be dropped if  */
 		/* the metadata update is copied to the last queued value */
 		if (NULL != (item = hc_get_item(item_value->itemid)) && 0 != (item_value->flags & ZBX_DC_FLAG_NOVALUE))
@@ -3217,20 +3977,7 @@ static void	hc_add_item_values(dc_item_value_t *values, int values_num)
 		{
 			do
 			{
-				zbx_vector_uint64_pair_t	items;
-
-				zbx_vector_uint64_pair_create(&items);
-
-				hc_get_items(&items);
-
-				UNLOCK_CACHE;
-
-				hc_log_history_cache_usage(&items);
-
-				zbx_vector_uint64_pair_destroy(&items);
-				sleep(1);
-
-				LOCK_CACHE;
+				hc_wait_for_free_space();
 			}
 			while (SUCCEED != hc_clone_history_data(&data, item_value));
 
@@ -3336,7 +4083,10 @@ static void	hc_copy_history_data(zbx_dc_history_t *history, zbx_uint64_t itemid,
  * Parameters: history_items - [OUT] the locked history items                 *
  *                                                                            *
  * Comments: The history_items must be returned back to history cache with    *
- *           zbx_hc_push_items() function after they have been processed.         *
+ *           zbx_hc_push_items() function after they have been processed.     *
+ *           Items are taken from the shard owned by the history syncer. When *
+ *           it is empty, items are taken from the next non-empty shard, so   *
+ *           all items of the batch always belong to the same shard.          *
  *                                                                            *
  ******************************************************************************/
 void	zbx_hc_pop_items(zbx_vector_hc_item_ptr_t *history_items)
@@ -3344,17 +4094,27 @@ void	zbx_hc_pop_items(zbx_vector_hc_item_ptr_t *history_items)
 	zbx_binary_heap_elem_t	*elem;
 	zbx_hc_item_t		*item;
 
-	while (ZBX_HC_SYNC_MAX > history_items->values_num && FAIL == zbx_binary_heap_empty(&cache->history_queue))
+	for (int i = 0; i < hc_shards_num && 0 == history_items->values_num; i++)
 	{
-		elem = zbx_binary_heap_find_min(&cache->history_queue);
-		item = elem->data;
-		zbx_vector_hc_item_ptr_append(history_items, item);
+		int	index = (hc_shard_owned + i) % hc_shards_num;
 
-		zbx_binary_heap_remove_min(&cache->history_queue);
-	}
+		hc_shard_lock(index);
+
+		while (ZBX_HC_SYNC_MAX > history_items->values_num &&
+				FAIL == zbx_binary_heap_empty(&shard->history_queue))
+		{
+			elem = zbx_binary_heap_find_min(&shard->history_queue);
+			item = elem->data;
+			zbx_vector_hc_item_ptr_append(history_items, item);
+
+			zbx_binary_heap_remove_min(&shard->history_queue);
+		}
+
+		if (0 != history_items->values_num)
+			shard->processing_num++;
 
-	if (0 != history_items->values_num)
-		cache->processing_num++;
+		hc_shard_unlock(index);
+	}
 }
 
 /******************************************************************************
@@ -3393,9 +4153,12 @@ static void	hc_remove_item(zbx_hc_item_t *item)
 		item->tail = next;
 	}
 
-	cache->history_num -= item->values_num - 1;
+	if (NULL != item->ring)
+		hc_ring_free(item->ring);
+
+	shard->history_num -= item->values_num - 1;
 
-	zbx_hashset_remove_direct(&cache->history_items, item);
+	zbx_hashset_remove_direct(&shard->history_items, item);
 }
 
 /******************************************************************************
@@ -3412,10 +4175,18 @@ static void	hc_remove_item(zbx_hc_item_t *item)
  ******************************************************************************/
 void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 {
-	int		i;
+	int		i, index;
 	zbx_hc_item_t	*item;
 	zbx_hc_data_t	*data_free;
 
+	if (0 == history_items->values_num)
+		return;
+
+	/* all items popped in one batch belong to the same shard */
+	index = hc_shard_index(history_items->values[0]->itemid);
+
+	hc_shard_lock(index);
+
 	for (i = 0; i < history_items->values_num; i++)
 	{
 		item = history_items->values[i];
@@ -3428,6 +4199,8 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 				hc_queue_item(item);
 				break;
 			case ZBX_HC_ITEM_STATUS_NORMAL:
+				shard->history_num--;
+
 				if (ZBX_HC_ITEM_CACHE_FALSE == item->cache)
 				{
 					hc_remove_item(item);
@@ -3435,6 +4208,17 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 				}
 
 				item->values_num--;
+
+				if (NULL == item->tail->next && NULL != item->ring)
+				{
+					/* reuse tail node for the next value in ring */
+					hc_free_data_value(item->tail);
+					hc_ring_pop(item, item->tail);
+					item->ts = item->tail->ts;
+					hc_queue_item(item);
+					break;
+				}
+
 				data_free = item->tail;
 				item->tail = item->tail->next;
 				hc_free_data(data_free);
@@ -3451,17 +4235,43 @@ void	zbx_hc_push_items(zbx_vector_hc_item_ptr_t *history_items)
 		}
 	}
 
-	cache->processing_num--;
+	shard->processing_num--;
+
+	hc_shard_unlock(index);
 }
 
 /******************************************************************************
  *                                                                            *
  * Purpose: retrieve the size of history queue                                *
  *                                                                            *
+ * Comments: Shards are locked one at a time, so caller must not hold any     *
+ *           shard lock.                                                      *
+ *                                                                            *
  ******************************************************************************/
 int	zbx_hc_queue_get_size(void)
 {
-	return cache->history_queue.elems_num;
+	int	size = 0;
+
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		zbx_mutex_lock(hc_shards[i].lock);
+		size += hc_shards[i].data->history_queue.elems_num;
+		zbx_mutex_unlock(hc_shards[i].lock);
+	}
+
+	return size;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sets the history cache shard owned by history syncer              *
+ *                                                                            *
+ * Parameters: process_num - [IN] the history syncer process number           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_hc_set_shard_owner(int process_num)
+{
+	hc_shard_owned = (process_num - 1) % hc_shards_num;
 }
 
 int	zbx_hc_get_history_compression_age(void)
@@ -3489,11 +4299,18 @@ int	zbx_hc_get_history_compression_age(void)
  *                                                                            *
  * Purpose: calculate usage percentage of hc memory buffer                    *
  *                                                                            *
+ * Comments: History cache lock must be held by caller.                       *
+ *                                                                            *
  ******************************************************************************/
 double	zbx_hc_mem_pused(void)
 {
-	return 100 * (double)(zbx_dbcache_get_hc_mem()->total_size - zbx_dbcache_get_hc_mem()->free_size) /
-			zbx_dbcache_get_hc_mem()->total_size;
+	zbx_uint64_t	total_size, free_size;
+
+	hc_lock_other_shards();
+	hc_get_shard_mem_size(0, &total_size, &free_size);
+	hc_unlock_other_shards();
+
+	return 100 * (double)(total_size - free_size) / total_size;
 }
 
 double	zbx_hc_mem_pused_lock(void)
@@ -3556,16 +4373,48 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocates history cache shard data                                *
+ *                                                                            *
+ * Parameters: index - [IN] the shard index                                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_init_shard(int index)
+{
+	hc_shard_set(index);
+
+	shard = (zbx_hc_shard_data_t *)__hc_shard_index_shmem_malloc_func(NULL, sizeof(zbx_hc_shard_data_t));
+	memset(shard, 0, sizeof(zbx_hc_shard_data_t));
+
+	zbx_hashset_create_ext(&shard->history_items, ZBX_HC_ITEMS_INIT_SIZE,
+			ZBX_DEFAULT_ID_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
+			__hc_shard_index_shmem_malloc_func, __hc_shard_index_shmem_realloc_func,
+			__hc_shard_index_shmem_free_func);
+
+	zbx_binary_heap_create_ext(&shard->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
+			__hc_shard_index_shmem_malloc_func, __hc_shard_index_shmem_realloc_func,
+			__hc_shard_index_shmem_free_func);
+
+	hc_shards[index].data = shard;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Allocate shared memory for database cache                         *
  *                                                                            *
+ * Comments: History cache is split into one shard per history syncer, up to  *
+ *           ZBX_HC_SHARDS_MAX shards having at least ZBX_HC_SHARD_SIZE_MIN   *
+ *           of memory each. With multiple shards half of history memory is   *
+ *           kept in a pool shared by all shards.                             *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
+int	zbx_init_database_cache(zbx_get_program_type_f get_program_type, zbx_get_config_forks_f get_config_forks,
 		zbx_sync_history_cache_f sync_history_cache_func, zbx_uint64_t history_cache_size,
 		zbx_uint64_t history_index_cache_size, zbx_uint64_t *trends_cache_size, char **error)
 {
-	int	ret;
+	int		ret, i;
+	zbx_uint64_t	pool_size;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -3584,8 +4433,30 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
 	if (SUCCEED != (ret = zbx_mutex_create(&cache_ids_lock, ZBX_MUTEX_CACHE_IDS, error)))
 		goto out;
 
-	if (SUCCEED != (ret = zbx_shmem_create(&hc_mem, history_cache_size, "history cache",
-			"HistoryCacheSize", 1, error)))
+	hc_shards_num = MIN(get_config_forks(ZBX_PROCESS_TYPE_HISTSYNCER), ZBX_HC_SHARDS_MAX);
+	hc_shards_num = MIN(hc_shards_num, (int)(history_cache_size / ZBX_HC_SHARD_SIZE_MIN));
+	hc_shards_num = MAX(hc_shards_num, 1);
+
+	if (1 < hc_shards_num)
+	{
+		pool_size = history_cache_size / 2;
+		history_cache_size -= pool_size;
+
+		if (SUCCEED != (ret = zbx_mutex_create(&hc_pool_lock, ZBX_MUTEX_HISTORY_POOL, error)))
+			goto out;
+
+		if (SUCCEED != (ret = zbx_shmem_create_ext(&hc_pool_mem, pool_size, "history cache pool",
+				"HistoryCacheSize", 1, ZBX_SHMEM_FLAG_SLAB, error)))
+		{
+			goto out;
+		}
+	}
+
+	history_cache_size /= (zbx_uint64_t)hc_shards_num;
+	history_index_cache_size /= (zbx_uint64_t)hc_shards_num;
+
+	if (SUCCEED != (ret = zbx_shmem_create_ext(&hc_mem, history_cache_size, "history cache",
+			"HistoryCacheSize", 1, ZBX_SHMEM_FLAG_SLAB, error)))
 	{
 		goto out;
 	}
@@ -3596,18 +4467,38 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
 		goto out;
 	}
 
+	hc_shards[0].lock = cache_lock;
+	hc_shards[0].mem = hc_mem;
+	hc_shards[0].index_mem = hc_index_mem;
+
+	for (i = 1; i < hc_shards_num; i++)
+	{
+		if (SUCCEED != (ret = zbx_mutex_create(&hc_shards[i].lock, ZBX_MUTEX_HISTORY_SHARD + i - 1, error)))
+			goto out;
+
+		if (SUCCEED != (ret = zbx_shmem_create_ext(&hc_shards[i].mem, history_cache_size,
+				"history cache shard", "HistoryCacheSize", 1, ZBX_SHMEM_FLAG_SLAB, error)))
+		{
+			goto out;
+		}
+
+		if (SUCCEED != (ret = zbx_shmem_create(&hc_shards[i].index_mem, history_index_cache_size,
+				"history index cache shard", "HistoryIndexCacheSize", 0, error)))
+		{
+			goto out;
+		}
+	}
+
 	cache = (ZBX_DC_CACHE *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_CACHE));
 	memset(cache, 0, sizeof(ZBX_DC_CACHE));
 
 	ids = (ZBX_DC_IDS *)__hc_index_shmem_malloc_func(NULL, sizeof(ZBX_DC_IDS));
 	memset(ids, 0, sizeof(ZBX_DC_IDS));
 
-	zbx_hashset_create_ext(&cache->history_items, ZBX_HC_ITEMS_INIT_SIZE,
-			ZBX_DEFAULT_ID_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	for (i = 0; i < hc_shards_num; i++)
+		hc_init_shard(i);
 
-	zbx_binary_heap_create_ext(&cache->history_queue, hc_queue_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY,
-			__hc_index_shmem_malloc_func, __hc_index_shmem_realloc_func, __hc_index_shmem_free_func);
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() history cache shards:%d", __func__, hc_shards_num);
 
 	if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_SERVER))
 	{
@@ -3625,10 +4516,8 @@ int	zbx_init_database_cache(zbx_get_program_type_f get_program_type,
 	}
 
 	cache->refcount = 0;
-	cache->processing_num = 0;
 	cache->history_num_total = 0;
 	cache->history_progress_ts = 0;
-	cache->last_error_ts = 0;
 	cache->last_warning_ts = 0;
 	cache->trends_progress_ts = 0;
 
@@ -3673,6 +4562,23 @@ void	zbx_free_database_cache(int sync, const zbx_events_funcs_t *events_cbs)
 
 	cache = NULL;
 
+	for (int i = 1; i < hc_shards_num; i++)
+	{
+		zbx_shmem_destroy(hc_shards[i].mem);
+		zbx_shmem_destroy(hc_shards[i].index_mem);
+		zbx_mutex_destroy(&hc_shards[i].lock);
+	}
+
+	memset(hc_shards, 0, sizeof(hc_shards));
+	hc_shards_num = 0;
+
+	if (NULL != hc_pool_mem)
+	{
+		zbx_shmem_destroy(hc_pool_mem);
+		hc_pool_mem = NULL;
+		zbx_mutex_destroy(&hc_pool_lock);
+	}
+
 	zbx_shmem_destroy(hc_mem);
 	hc_mem = NULL;
 	zbx_shmem_destroy(hc_index_mem);
@@ -3799,12 +4705,56 @@ out:
  ******************************************************************************/
 void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
 {
-	LOCK_CACHE;
+	*values_num = 0;
+	*items_num = 0;
 
-	*values_num = cache->history_num;
-	*items_num = cache->history_items.num_data;
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
 
-	UNLOCK_CACHE;
+		*values_num += (zbx_uint64_t)shard->history_num;
+		*items_num += (zbx_uint64_t)shard->history_items.num_data;
+
+		hc_shard_unlock(i);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds shared memory allocator statistics of a shard                *
+ *                                                                            *
+ ******************************************************************************/
+static void	hc_add_mem_stats(zbx_shmem_stats_t *stats, const zbx_shmem_stats_t *shard_stats)
+{
+	int	i;
+
+	stats->free_size += shard_stats->free_size;
+	stats->used_size += shard_stats->used_size;
+	stats->overhead += shard_stats->overhead;
+	stats->free_chunks += shard_stats->free_chunks;
+	stats->used_chunks += shard_stats->used_chunks;
+
+	if (0 != shard_stats->min_chunk_size && (0 == stats->min_chunk_size ||
+			shard_stats->min_chunk_size < stats->min_chunk_size))
+	{
+		stats->min_chunk_size = shard_stats->min_chunk_size;
+	}
+
+	if (shard_stats->max_chunk_size > stats->max_chunk_size)
+		stats->max_chunk_size = shard_stats->max_chunk_size;
+
+	for (i = 0; i < ZBX_SHMEM_BUCKET_COUNT; i++)
+		stats->chunks_num[i] += shard_stats->chunks_num[i];
+
+	for (i = 0; i < shard_stats->slabs_num; i++)
+	{
+		stats->slabs[i].slot_size = shard_stats->slabs[i].slot_size;
+		stats->slabs[i].pages += shard_stats->slabs[i].pages;
+		stats->slabs[i].slots_total += shard_stats->slabs[i].slots_total;
+		stats->slabs[i].slots_used += shard_stats->slabs[i].slots_used;
+	}
+
+	stats->slabs_num = shard_stats->slabs_num;
 }
 
 /******************************************************************************
@@ -3814,15 +4764,41 @@ void	zbx_hc_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num)
  ******************************************************************************/
 void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
 {
-	LOCK_CACHE;
+	zbx_shmem_stats_t	shard_stats;
 
 	if (NULL != data)
-		zbx_shmem_get_stats(hc_mem, data);
+		memset(data, 0, sizeof(zbx_shmem_stats_t));
 
 	if (NULL != index)
-		zbx_shmem_get_stats(hc_index_mem, index);
+		memset(index, 0, sizeof(zbx_shmem_stats_t));
 
-	UNLOCK_CACHE;
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+
+		if (NULL != data)
+		{
+			zbx_shmem_get_stats(hc_shards[i].mem, &shard_stats);
+			hc_add_mem_stats(data, &shard_stats);
+		}
+
+		if (NULL != index)
+		{
+			zbx_shmem_get_stats(hc_shards[i].index_mem, &shard_stats);
+			hc_add_mem_stats(index, &shard_stats);
+		}
+
+		hc_shard_unlock(i);
+	}
+
+	if (NULL != data && NULL != hc_pool_mem)
+	{
+		zbx_mutex_lock(hc_pool_lock);
+		zbx_shmem_get_stats(hc_pool_mem, &shard_stats);
+		zbx_mutex_unlock(hc_pool_lock);
+
+		hc_add_mem_stats(data, &shard_stats);
+	}
 }
 
 /******************************************************************************
@@ -3832,40 +4808,37 @@ void	zbx_hc_get_mem_stats(zbx_shmem_stats_t *data, zbx_shmem_stats_t *index)
  ******************************************************************************/
 int	zbx_hc_is_itemid_cached(zbx_uint64_t itemid)
 {
-	int		ret = FAIL;
+	int		ret = FAIL, index = hc_shard_index(itemid);
 	zbx_hc_item_t	*item;
 
-	LOCK_CACHE;
+	hc_shard_lock(index);
 
-	if (NULL != (item = (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid)) && NULL != item->tail)
+	if (NULL != (item = hc_get_item(itemid)) && NULL != item->tail)
 		ret = SUCCEED;
 
-	UNLOCK_CACHE;
+	hc_shard_unlock(index);
 
 	return ret;
 }
 
 int	zbx_hc_is_itemid_cached_and_normal(zbx_uint64_t itemid)
 {
-	int		ret = FAIL;
+	int		ret = FAIL, index = hc_shard_index(itemid);
 	zbx_hc_item_t	*item;
 
-	LOCK_CACHE;
+	hc_shard_lock(index);
 
-	if (NULL != (item = (zbx_hc_item_t *)zbx_hashset_search(&cache->history_items, &itemid)) &&
-			NULL != item->tail && ITEM_STATE_NORMAL == item->tail->state)
-	{
-			ret = SUCCEED;
-	}
+	if (NULL != (item = hc_get_item(itemid)) && NULL != item->tail && ITEM_STATE_NORMAL == item->tail->state)
+		ret = SUCCEED;
 
-	UNLOCK_CACHE;
+	hc_shard_unlock(index);
 
 	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get statistics of cached items                                    *
+ * Purpose: get statistics of cached items in the current shard              *
  *                                                                            *
  ******************************************************************************/
 static void	hc_get_items(zbx_vector_uint64_pair_t *items)
@@ -3873,9 +4846,9 @@ static void	hc_get_items(zbx_vector_uint64_pair_t *items)
 	zbx_hashset_iter_t	iter;
 	zbx_hc_item_t		*item;
 
-	zbx_vector_uint64_pair_reserve(items, cache->history_items.num_data);
+	zbx_vector_uint64_pair_reserve(items, (size_t)items->values_num + (size_t)shard->history_items.num_data);
 
-	zbx_hashset_iter_reset(&cache->history_items, &iter);
+	zbx_hashset_iter_reset(&shard->history_items, &iter);
 	while (NULL != (item = (zbx_hc_item_t *)zbx_hashset_iter_next(&iter)))
 	{
 		if (0 != item->values_num)
@@ -3907,16 +4880,32 @@ int	zbx_hc_check_high_usage_timer(void)
  ******************************************************************************/
 void	zbx_hc_get_items(zbx_vector_uint64_pair_t *items)
 {
-	LOCK_CACHE;
-
-	hc_get_items(items);
-
-	UNLOCK_CACHE;
+	for (int i = 0; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+		hc_get_items(items);
+		hc_shard_unlock(i);
+	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get statistics of cached items                                    *
+ *                                                                            *
+ * Comments: History cache lock must be held by caller.                       *
+ *                                                                            *
+ ******************************************************************************/
 void	zbx_hc_get_items_unlocked(zbx_vector_uint64_pair_t *items)
 {
+	hc_shard_set(0);
 	hc_get_items(items);
+
+	for (int i = 1; i < hc_shards_num; i++)
+	{
+		hc_shard_lock(i);
+		hc_get_items(items);
+		hc_shard_unlock(i);
+	}
 }
 
 void	zbx_hc_acquire(void)
@@ -4054,21 +5043,6 @@ void	zbx_dbcache_unlock(void)
 	UNLOCK_CACHE;
 }
 
-void	zbx_dbcache_set_history_num(int num)
-{
-	cache->history_num = num;
-}
-
-int	zbx_dbcache_get_history_num(void)
-{
-	return cache->history_num;
-}
-
-zbx_shmem_info_t	*zbx_dbcache_get_hc_mem(void)
-{
-	return hc_mem;
-}
-
 void	zbx_dbcache_setproxyqueue_state(int proxyqueue_state)
 {
 	cache->proxyqueue.state = proxyqueue_state;
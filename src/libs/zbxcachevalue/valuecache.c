@@ -16,9 +16,12 @@
 
 #include "zbxmutexs.h"
 #include "zbxtime.h"
+#include "zbxnum.h"
 #include "zbxalgo.h"
 #include "zbxhistory.h"
 #include "zbxshmem.h"
+#include "zbxtypes_ext.h"
+#include "valuecache_codec.h"
 
 /*
  * The cache (zbx_vc_cache_t) is organized as a hashset of item records (zbx_vc_item_t).
@@ -87,6 +90,47 @@ ZBX_SHMEM_FUNC_IMPL(__vc, vc_mem)
 
 #define ZBX_VC_ITEM_EXPIRE_PERIOD	SEC_PER_DAY
 
+#if defined(HAVE_STDATOMIC_H) && ATOMIC_LLONG_LOCK_FREE == 2
+#	define ZBX_VC_LOCKFREE
+#endif
+
+/* the maximum number of processes/threads reading cache without locking, others use read lock */
+#define ZBX_VC_READERS_MAX	256
+
+#define ZBX_VC_CACHE_LINE_SIZE	64
+
+/* the lock-free reader state */
+typedef struct
+{
+	/* the cache epoch when reader entered read section, 0 if reader is not active */
+	zbx_atomic_uint64_t	epoch;
+
+	/* 1 if the slot is claimed by a reader */
+	zbx_atomic_uint32_t	claimed;
+
+	/* pad to cache line to avoid false sharing between readers */
+	char			padding[ZBX_VC_CACHE_LINE_SIZE - sizeof(zbx_uint64_t) - sizeof(zbx_uint32_t)];
+}
+zbx_vc_reader_t;
+
+/* the memory block removed from cache, but possibly still accessed by lock-free readers */
+typedef struct
+{
+	void		*ptr;
+
+	/* the cache epoch when block was retired */
+	zbx_uint64_t	epoch;
+}
+zbx_vc_retired_t;
+
+/* the immutable copy of items hashset slot array reference used by lock-free readers */
+typedef struct
+{
+	ZBX_HASHSET_ENTRY_T	**slots;
+	int			num_slots;
+}
+zbx_vc_items_index_t;
+
 /* the data chunk used to store data fragment */
 typedef struct zbx_vc_chunk
 {
@@ -105,6 +149,14 @@ typedef struct zbx_vc_chunk
 	/* the number of item value slots in chunk */
 	int			slots_num;
 
+	/* The size of encoded values in packed chunk, 0 for unpacked chunks.     */
+	/* Packed chunk stores the last value in the first slot followed by the    */
+	/* encoded values, see vch_item_pack_chunk().                              */
+	int			packed_size;
+
+	/* the unique identifier of packed chunk, used to cache unpacked values  */
+	zbx_uint64_t		packed_id;
+
 	/* the item value data */
 	zbx_history_record_t	slots[1];
 }
@@ -118,6 +170,68 @@ zbx_vc_chunk_t;
 #define ZBX_VC_MAX_CHUNK_RECORDS	((64 * ZBX_KIBIBYTE - sizeof(zbx_vc_chunk_t)) / \
 		sizeof(zbx_history_record_t) + 1)
 
+/* the minimum number of values in chunk to pack it */
+#define ZBX_VC_PACK_MIN_RECORDS		16
+
+/* the maximum number of incremental windows per item */
+#define ZBX_VC_WINDOWS_MAX		8
+
+/* windows not requested for this period are removed */
+#define ZBX_VC_WINDOW_EXPIRE_PERIOD	SEC_PER_HOUR
+
+/* the window last request time is updated with this precision */
+#define ZBX_VC_WINDOW_TOUCH_PERIOD	SEC_PER_MIN
+
+/* the initial number of min/max window candidate slots */
+#define ZBX_VC_WINDOW_DEQUE_INIT	16
+
+/* the incremental aggregates of window values */
+typedef struct
+{
+	/* the number of values in window */
+	int			values_num;
+
+	/* the number of values matching count window filter */
+	int			count;
+
+	/* the sum of values, floating point for average */
+	zbx_history_value_t	sum;
+
+	/* the compensation of floating point sum rounding errors */
+	double			sum_comp;
+}
+zbx_vc_window_aggr_t;
+
+/* the time window of item values with incrementally maintained aggregate */
+typedef struct zbx_vc_window_data
+{
+	struct zbx_vc_window_data	*next;
+
+	zbx_vc_window_t			window;
+
+	/* the window contains values with timestamps after left and up to the newest cached value */
+	zbx_timespec_t			left;
+
+	zbx_vc_window_aggr_t		aggr;
+
+	/* The number of values removed since the floating point sum was recalculated.  */
+	/* The sum is recalculated after all window values are replaced to reset        */
+	/* accumulated rounding errors.                                                 */
+	int				removed_num;
+
+	/* the last time the window was requested */
+	int				last_used;
+
+	/* The min/max candidate ring buffer. Candidates are ordered by timestamp and    */
+	/* every candidate is smaller (larger) than all older candidates, so the first  */
+	/* candidate is the window minimum (maximum).                                   */
+	zbx_history_record_t		*deque;
+	int				deque_alloc;
+	int				deque_first;
+	int				deque_num;
+}
+zbx_vc_window_data_t;
+
 /* the value cache item data */
 typedef struct
 {
@@ -180,6 +294,9 @@ typedef struct
 
 	/* the first (oldest) chunk of item history data              */
 	zbx_vc_chunk_t	*tail;
+
+	/* the incremental value windows                              */
+	zbx_vc_window_data_t	*windows;
 }
 zbx_vc_item_t;
 
@@ -212,6 +329,32 @@ typedef struct
 
 	/* the string pool for str, text and log item values */
 	zbx_hashset_t	strpool;
+
+	/* 1 if values can be read without locking the cache (ValueCacheLockFreeReads) */
+	int		lockfree;
+
+	/* the write sequence number, odd while cache is locked for writing */
+	zbx_atomic_uint64_t	seq;
+
+	/* the reclamation epoch, incremented whenever retired memory is reclaimed */
+	zbx_atomic_uint64_t	epoch;
+
+	/* the lock-free reader slots */
+	zbx_vc_reader_t		*readers;
+
+	/* the memory blocks waiting to be freed when no readers can access them */
+	zbx_vc_retired_t	*retired;
+	int			retired_num;
+	int			retired_alloc;
+
+	/* the items hashset slots published for lock-free readers */
+	zbx_vc_items_index_t	*items_index;
+
+	/* 1 if filled numeric value chunks are packed (ValueCacheCompression) */
+	int		compression;
+
+	/* the identifier of last packed chunk */
+	zbx_uint64_t	last_packed_id;
 }
 zbx_vc_cache_t;
 
@@ -232,7 +375,8 @@ ZBX_VECTOR_IMPL(vc_itemweight, zbx_vc_item_weight_t)
 typedef enum
 {
 	ZBX_VC_UPDATE_STATS,
-	ZBX_VC_UPDATE_RANGE
+	ZBX_VC_UPDATE_RANGE,
+	ZBX_VC_UPDATE_WINDOW
 }
 zbx_vc_item_update_type_t;
 
@@ -248,11 +392,20 @@ enum
 	ZBX_VC_UPDATE_RANGE_NOW
 };
 
+enum
+{
+	ZBX_VC_UPDATE_WINDOW_TS,
+	ZBX_VC_UPDATE_WINDOW_NOW
+};
+
 typedef struct
 {
 	zbx_uint64_t			itemid;
 	zbx_vc_item_update_type_t	type;
 	int				data[2];
+
+	/* the requested window for ZBX_VC_UPDATE_WINDOW update */
+	zbx_vc_window_t			window;
 }
 zbx_vc_item_update_t;
 
@@ -275,1510 +428,2990 @@ static void	vc_cache_item_update(zbx_uint64_t itemid, zbx_vc_item_update_type_t
 	update->data[1] = arg2;
 }
 
-/* the value cache */
-static zbx_vc_cache_t	*vc_cache = NULL;
-
-#define	RDLOCK_CACHE	zbx_rwlock_rdlock(vc_lock)
-#define	WRLOCK_CACHE	zbx_rwlock_wrlock(vc_lock)
-#define	UNLOCK_CACHE	zbx_rwlock_unlock(vc_lock)
-
-/* function prototypes */
-static size_t	vch_item_free_cache(zbx_vc_item_t *item);
-static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk);
-static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num);
-static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp);
-
-/*********************************************************************************
- *                                                                               *
- * Purpose: reads item history data from database                                *
- *                                                                               *
- * Parameters:  itemid        - [IN] the itemid                                  *
- *              value_type    - [IN] the value type (see ITEM_VALUE_TYPE_* defs) *
- *              values        - [OUT] the item history data values               *
- *              range_start   - [IN] the interval start time                     *
- *              range_end     - [IN] the interval end time                       *
- *                                                                               *
- * Return value: SUCCEED - the history data were read successfully               *
- *               FAIL - otherwise                                                *
- *                                                                               *
- * Comments: This function reads all values from the specified range             *
- *           [range_start, range_end]                                            *
- *                                                                               *
- *********************************************************************************/
-static int	vc_db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
-		int range_start, int range_end)
+static void	vc_cache_window_update(zbx_uint64_t itemid, const zbx_vc_window_t *window, int ts, int now)
 {
-	/* decrement interval start point because interval starting point is excluded by history backend */
-	if (0 != range_start)
-		range_start--;
+	zbx_vc_item_update_t	*update;
 
-	return zbx_history_get_values(itemid, value_type, range_start, 0, range_end, values);
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_WINDOW, ts, now);
+
+	update = &vc_itemupdates.values[vc_itemupdates.values_num - 1];
+	update->window = *window;
 }
 
-/************************************************************************************
- *                                                                                  *
- * Purpose: reads item history data from database                                   *
- *                                                                                  *
- * Parameters:  itemid      - [IN] the itemid                                       *
- *              value_type  - [IN] the value type (see ITEM_VALUE_TYPE_* defs)      *
- *              values      - [OUT] the item history data values                    *
- *              range_start - [IN] the interval start time                          *
- *              count       - [IN] the number of values to read                     *
- *              range_end   - [IN] the interval end time                            *
- *              ts          - [IN] the requested timestamp                          *
- *                                                                                  *
- * Return value: SUCCEED - the history data were read successfully                  *
- *               FAIL - otherwise                                                   *
- *                                                                                  *
- * Comments: This function will return the smallest data interval on seconds scale  *
- *           that includes the requested values.                                    *
- *                                                                                  *
- ************************************************************************************/
-static int	vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
-		zbx_vector_history_record_t *values, int range_start, int count, int range_end,
-		const zbx_timespec_t *ts)
-{
-	int	first_timestamp, last_timestamp, i, left = 0, values_start;
+/* the value cache */
+static zbx_vc_cache_t	*vc_cache = NULL;
 
-	/* remember the number of values already stored in values vector */
-	values_start = values->values_num;
+static void	vc_write_begin(void);
+static void	vc_write_end(void);
 
-	if (0 != range_start)
-		range_start--;
+#define	RDLOCK_CACHE	zbx_rwlock_rdlock(vc_lock)
+#define	WRLOCK_CACHE	do { zbx_rwlock_wrlock(vc_lock); vc_write_begin(); } while (0)
+#define	UNLOCK_CACHE	do { vc_write_end(); zbx_rwlock_unlock(vc_lock); } while (0)
 
-	/* Count based requests can 'split' the data of oldest second. For example if we have    */
-	/* values with timestamps Ta.0 Tb.0, Tb.5, Tc.0 then requesting 2 values from [0, Tc]    */
-	/* range will return Tb.5, Tc.0,leaving Tb.0 value in database. However because          */
-	/* second is the smallest time unit history backends can work with, data must be cached  */
-	/* by second intervals - it cannot have some values from Tb cached and some not.         */
-	/* This is achieved by two means:                                                        */
-	/*   1) request more (by one) values than we need. In most cases there will be no        */
-	/*      multiple values per second (exceptions are logs and trapper items) - for example */
-	/*      Ta.0, Tb.0, Tc.0. We need 2 values from Tc. Requesting 3 values gets us          */
-	/*      Ta.0, Tb.0, Tc.0. As Ta != Tb we can be sure that all values from the last       */
-	/*      timestamp (Tb) have been cached. So we can drop Ta.0 and return Tb.0, Tc.0.      */
-	/*   2) Re-read the last second. For example if we have values with timestamps           */
-	/*      Ta.0 Tb.0, Tb.5, Tc.0, then requesting 3 values from Tc gets us Tb.0, Tb.5, Tc.0.*/
-	/*      Now we cannot be sure that there are no more values with Tb.* timestamp. So the  */
-	/*      only thing we can do is to:                                                      */
-	/*        a) remove values with Tb.* timestamp from result,                              */
-	/*        b) read all values with Tb.* timestamp from database,                          */
-	/*        c) add read values to the result.                                              */
-	if (FAIL == zbx_history_get_values(itemid, value_type, range_start, count + 1, range_end, values))
-		return FAIL;
+/* the unpacked values of packed chunk, cached per process/thread */
+typedef struct
+{
+	const zbx_vc_chunk_t	*chunk;
+	zbx_uint64_t		packed_id;
+	zbx_history_record_t	*slots;
+	int			slots_alloc;
+}
+zbx_vc_unpacked_t;
 
-	/* returned less than requested - all values are read */
-	if (count > values->values_num - values_start)
-		return SUCCEED;
+/* the number of simultaneously accessed packed chunks */
+#define ZBX_VC_UNPACKED_NUM	2
 
-	/* Check if some of values aren't past the required range. For example we have values    */
-	/* with timestamps Ta.0, Tb.0, Tb.5. As history backends work on seconds interval we     */
-	/* can only request values from Tb which would include Tb.5, even if the requested       */
-	/* end timestamp was less (for example Tb.0);                                            */
+static ZBX_THREAD_LOCAL zbx_vc_unpacked_t	vc_unpacked[ZBX_VC_UNPACKED_NUM];
+static ZBX_THREAD_LOCAL int			vc_unpacked_next;
 
-	/* values from history backend are sorted in descending order by timestamp seconds */
-	first_timestamp = values->values[values->values_num - 1].timestamp.sec;
-	last_timestamp = values->values[values_start].timestamp.sec;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets chunk value slots                                            *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk                                         *
+ *                                                                            *
+ * Return value: The chunk value slots, indexed by first_value..last_value.   *
+ *                                                                            *
+ * Comments: Packed chunks are decoded into process/thread local buffer,      *
+ *           which is valid until values of another two packed chunks are     *
+ *           requested. The returned slots must not be modified.              *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_history_record_t	*vch_chunk_slots(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_unpacked_t	*unpacked;
+	int			i;
 
-	for (i = values_start; i < values->values_num && values->values[i].timestamp.sec == last_timestamp; i++)
-	{
-		if (0 > zbx_timespec_compare(ts, &values->values[i].timestamp))
-			left++;
-	}
+	if (0 == chunk->packed_size)
+		return (zbx_history_record_t *)chunk->slots;
 
-	/* read missing data */
-	if (0 != left)
+	for (i = 0; i < ZBX_VC_UNPACKED_NUM; i++)
 	{
-		int	offset;
+		unpacked = &vc_unpacked[i];
 
-		/* drop the first (oldest) second to ensure range cutoff at full second */
-		while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == first_timestamp)
+		if (unpacked->chunk == chunk && unpacked->packed_id == chunk->packed_id)
 		{
-			values->values_num--;
-			zbx_history_record_clear(&values->values[values->values_num], value_type);
-			left++;
+			vc_unpacked_next = (i + 1) % ZBX_VC_UNPACKED_NUM;
+			return unpacked->slots;
 		}
+	}
 
-		offset = values->values_num;
-
-		if (FAIL == zbx_history_get_values(itemid, value_type, range_start, left, first_timestamp, values))
-			return FAIL;
-
-		/* returned less than requested - all values are read */
-		if (left > values->values_num - offset)
-			return SUCCEED;
+	unpacked = &vc_unpacked[vc_unpacked_next];
+	vc_unpacked_next = (vc_unpacked_next + 1) % ZBX_VC_UNPACKED_NUM;
 
-		first_timestamp = values->values[values->values_num - 1].timestamp.sec;
+	if (unpacked->slots_alloc < chunk->slots_num)
+	{
+		unpacked->slots_alloc = chunk->slots_num;
+		unpacked->slots = (zbx_history_record_t *)zbx_realloc(unpacked->slots,
+				sizeof(zbx_history_record_t) * (size_t)unpacked->slots_alloc);
 	}
 
-	/* drop the first (oldest) second to ensure range cutoff at full second */
-	while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == first_timestamp)
+	if (SUCCEED != zbx_vc_codec_decode((const unsigned char *)&chunk->slots[1], (size_t)chunk->packed_size,
+			item->value_type, unpacked->slots, chunk->slots_num))
 	{
-		values->values_num--;
-		zbx_history_record_clear(&values->values[values->values_num], value_type);
+		/* can happen only with lock-free reads, which discard values read during cache update */
+		memset(unpacked->slots, 0, sizeof(zbx_history_record_t) * (size_t)chunk->slots_num);
+		unpacked->chunk = NULL;
+
+		return unpacked->slots;
 	}
 
-	/* check if there are enough values matching the request range */
+	unpacked->chunk = chunk;
+	unpacked->packed_id = chunk->packed_id;
 
-	for (i = values_start; i < values->values_num; i++)
-	{
-		if (0 <= zbx_timespec_compare(ts, &values->values[i].timestamp))
-			count--;
-	}
+	return unpacked->slots;
+}
 
-	if (0 >= count)
-		return SUCCEED;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets unpacked chunk values cached by current process/thread     *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_chunk_reset_unpacked(void)
+{
+	int	i;
 
-	/* re-read the first (oldest) second */
-	return zbx_history_get_values(itemid, value_type, first_timestamp - 1, 0, first_timestamp, values);
+	for (i = 0; i < ZBX_VC_UNPACKED_NUM; i++)
+		vc_unpacked[i].chunk = NULL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item history data for the specified time period directly from *
- *          database                                                          *
+ * Purpose: gets the last (newest) chunk value without unpacking chunk        *
  *                                                                            *
- * Parameters: itemid     - [IN] the item id                                  *
- *             value_type - [IN] the item value type                          *
- *             values     - [OUT] the item history data stored time/value     *
- *                          pairs in descending order                         *
- *             seconds    - [IN] the time period to retrieve data for         *
- *             count      - [IN] the number of history values to retrieve     *
- *             ts         - [IN] the period end timestamp                     *
+ ******************************************************************************/
+static const zbx_history_record_t	*vch_chunk_last(const zbx_vc_chunk_t *chunk)
+{
+	return 0 == chunk->packed_size ? &chunk->slots[chunk->last_value] : &chunk->slots[0];
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ * Purpose: gets the memory size allocated for chunk                          *
  *                                                                            *
  ******************************************************************************/
-static int	vc_db_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static size_t	vch_chunk_size(const zbx_vc_chunk_t *chunk)
 {
-	int	ret = FAIL, i, j, range_start;
+	if (0 != chunk->packed_size)
+		return sizeof(zbx_vc_chunk_t) + (size_t)chunk->packed_size;
 
-	if (0 == count)
-	{
-		/* read one more second to cover for possible nanosecond shift */
-		ret = vc_db_read_values_by_time(itemid, value_type, values, ts->sec - seconds, ts->sec);
-	}
-	else
-	{
-		/* read one more second to cover for possible nanosecond shift */
-		range_start = (0 == seconds ? 0 : ts->sec - seconds);
-		ret = vc_db_read_values_by_time_and_count(itemid, value_type, values, range_start, count, ts->sec, ts);
-	}
+	return sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
+}
 
-	if (SUCCEED != ret)
-		return ret;
+/*
+ * Lock-free reads (ValueCacheLockFreeReads=1)
+ *
+ * Writers still serialize on the cache lock, but additionally increment the write sequence
+ * number when locking and unlocking the cache. Readers copy values without locking and
+ * validate the copy by checking that the sequence number was even and did not change
+ * during the read - otherwise the values are discarded and read again under the lock.
+ *
+ * Memory released by writers might still be accessed by lock-free readers, so instead of
+ * being freed it is retired together with the current epoch. Readers publish the epoch when
+ * entering read section and retired memory is freed only when all active readers have
+ * entered after it was retired.
+ */
 
-	zbx_vector_history_record_sort(values, zbx_history_record_compare_desc);
+#if defined(ZBX_VC_LOCKFREE)
 
-	/* History backend returns values by full second intervals. With nanosecond resolution */
-	/* some of returned values might be outside the requested range, for example:          */
-	/*   returned values: |.o...o..o.|.o...o..o.|.o...o..o.|.o...o..o.|                    */
-	/*   request range:        \_______________________________/                           */
-	/* Check if there are any values before and past the requested range and remove them.  */
+/* the lock-free reader slot index of current process/thread, -1 - not claimed, -2 - no free slots */
+static ZBX_THREAD_LOCAL int	vc_reader_slot = -1;
 
-	/* find the last value with timestamp less or equal to the requested range end point */
-	for (i = 0; i < values->values_num; i++)
-	{
-		if (0 >= zbx_timespec_compare(&values->values[i].timestamp, ts))
-			break;
-	}
-
-	/* all values are past requested range (timestamp greater than requested), return empty vector */
-	if (i == values->values_num)
-	{
-		zbx_history_record_vector_clean(values, value_type);
-		return SUCCEED;
-	}
-
-	/* remove values with timestamp greater than the requested */
-	if (0 != i)
-	{
-		for (j = 0; j < i; j++)
-			zbx_history_record_clear(&values->values[j], value_type);
-
-		for (j = 0; i < values->values_num; i++, j++)
-			values->values[j] = values->values[i];
-
-		values->values_num = j;
-	}
-
-	/* for count based requests remove values exceeding requested count */
-	if (0 != count)
-	{
-		while (count < values->values_num)
-			zbx_history_record_clear(&values->values[--values->values_num], value_type);
-	}
-
-	/* for time based requests remove values with timestamp outside requested range */
-	if (0 != seconds)
-	{
-		zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+/* 1 if current process/thread has locked cache for writing in lock-free read mode */
+static ZBX_THREAD_LOCAL int	vc_write_locked = 0;
 
-		while (0 < values->values_num &&
-				0 >= zbx_timespec_compare(&values->values[values->values_num - 1].timestamp, &start))
-		{
-			zbx_history_record_clear(&values->values[--values->values_num], value_type);
-		}
-	}
+/* the number of reader epoch checks before writer starts sleeping while waiting for readers */
+#define VC_LOCKFREE_SPIN_MAX		64
 
-	return SUCCEED;
-}
+/* the initial and maximum sleep time in nanoseconds while waiting for readers */
+#define VC_LOCKFREE_SLEEP_MIN		1000
+#define VC_LOCKFREE_SLEEP_MAX		1000000
 
-/******************************************************************************************************************
- *                                                                                                                *
- * Common API                                                                                                     *
- *                                                                                                                *
- ******************************************************************************************************************/
+/* check if pointer references value cache memory, used to detect torn reads */
+#define VC_LOCKFREE_PTR_VALID(ptr)	((const void *)(ptr) >= vc_mem->lo_bound &&	\
+		(const void *)(ptr) < vc_mem->hi_bound)
 
 /******************************************************************************
  *                                                                            *
- * String pool definitions & functions                                        *
+ * Purpose: get the oldest epoch of active lock-free readers                  *
+ *                                                                            *
+ * Return value: the oldest active reader epoch or ZBX_MAX_UINT64 if there    *
+ *               are no active readers                                        *
  *                                                                            *
  ******************************************************************************/
-
-#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
-
-static zbx_hash_t	vc_strpool_hash_func(const void *data)
+static zbx_uint64_t	vc_lockfree_min_epoch(void)
 {
-	return ZBX_DEFAULT_STRING_HASH_FUNC((const char *)data + REFCOUNT_FIELD_SIZE);
-}
+	zbx_uint64_t	epoch, min_epoch = ZBX_MAX_UINT64;
+	int		i;
 
-static int	vc_strpool_compare_func(const void *d1, const void *d2)
-{
-	return strcmp((const char *)d1 + REFCOUNT_FIELD_SIZE, (const char *)d2 + REFCOUNT_FIELD_SIZE);
+	for (i = 0; i < ZBX_VC_READERS_MAX; i++)
+	{
+		if (0 != (epoch = atomic_load(&vc_cache->readers[i].epoch)) && epoch < min_epoch)
+			min_epoch = epoch;
+	}
+
+	return min_epoch;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compares two item weight data structures by their 'weight'        *
+ * Purpose: free retired memory that cannot be accessed by readers anymore    *
  *                                                                            *
- * Parameters: a1   - [IN] first item weight data structure                   *
- *             a2   - [IN] second item weight data structure                  *
+ * Comments: The cache must be locked for writing. Readers entering after the *
+ *           epoch increment either see cache being written or the updated    *
+ *           data, so they cannot reach memory retired before.                *
  *                                                                            *
  ******************************************************************************/
-static int	vc_item_weight_compare(const void *a1, const void *a2)
+static void	vc_lockfree_reclaim(void)
 {
-	const zbx_vc_item_weight_t	*d1 = (const zbx_vc_item_weight_t *)a1;
-	const zbx_vc_item_weight_t	*d2 = (const zbx_vc_item_weight_t *)a2;
+	zbx_uint64_t	min_epoch;
+	int		i, j;
 
-	ZBX_RETURN_IF_NOT_EQUAL(d1->weight, d2->weight);
+	if (0 == vc_cache->retired_num)
+		return;
 
-	return 0;
+	atomic_fetch_add(&vc_cache->epoch, 1);
+	min_epoch = vc_lockfree_min_epoch();
+
+	for (i = 0, j = 0; i < vc_cache->retired_num; i++)
+	{
+		if (vc_cache->retired[i].epoch < min_epoch)
+			__vc_shmem_free_func(vc_cache->retired[i].ptr);
+		else
+			vc_cache->retired[j++] = vc_cache->retired[i];
+	}
+
+	vc_cache->retired_num = j;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: updates cache and item statistics                                 *
- *                                                                            *
- * Parameters: item    - [IN] the item (optional)                             *
- *             hits    - [IN] the number of hits to add                       *
- *             misses  - [IN] the number of misses to add                     *
- *                                                                            *
- * Comments: The misses are added only to cache statistics, while hits are    *
- *           added to both - item and cache statistics.                       *
+ * Purpose: wait until all active readers leave read section and free all     *
+ *          retired memory                                                    *
  *                                                                            *
  ******************************************************************************/
-static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses, int now)
+static void	vc_lockfree_synchronize(void)
 {
-	if (NULL != item)
-	{
-		int	hour;
+	zbx_uint64_t	epoch;
+	int		i, spins = 0;
+	struct timespec	delay = {0, VC_LOCKFREE_SLEEP_MIN};
 
-		item->hits += (zbx_uint64_t)hits;
-		item->last_accessed = now;
+	epoch = atomic_fetch_add(&vc_cache->epoch, 1);
 
-		hour = item->last_accessed / SEC_PER_HOUR;
-		if (hour != item->hour)
+	/* Readers do not block, so the wait is limited by the time of copying item values. A reader */
+	/* might be preempted though, so after a short spin the CPU is yielded with growing sleeps.   */
+	while (vc_lockfree_min_epoch() <= epoch)
+	{
+		if (VC_LOCKFREE_SPIN_MAX > spins)
 		{
-			item->last_hourly_num = item->hourly_num;
-			item->hourly_num = 0;
-			item->hour = hour;
+			spins++;
+			continue;
 		}
 
-		if (hits + misses > item->hourly_num)
-			item->hourly_num = hits + misses;
-	}
+		nanosleep(&delay, NULL);
 
-	if (ZBX_VC_ENABLED == vc_state)
-	{
-		vc_cache->hits += (zbx_uint64_t)hits;
-		vc_cache->misses += (zbx_uint64_t)misses;
+		if (VC_LOCKFREE_SLEEP_MAX > delay.tv_nsec)
+			delay.tv_nsec = MIN(delay.tv_nsec * 2, VC_LOCKFREE_SLEEP_MAX);
 	}
+
+	for (i = 0; i < vc_cache->retired_num; i++)
+		__vc_shmem_free_func(vc_cache->retired[i].ptr);
+
+	vc_cache->retired_num = 0;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: is used to sort items by value count in descending order          *
+ * Purpose: defer freeing of memory block until readers cannot access it      *
+ *                                                                            *
+ * Parameters: ptr - [IN] the memory block to free                            *
  *                                                                            *
  ******************************************************************************/
-static int	vc_compare_items_by_total_values(const void *d1, const void *d2)
+static void	vc_lockfree_retire(void *ptr)
 {
-	const zbx_vc_item_t	*c1 = *(const zbx_vc_item_t * const *)d1;
-	const zbx_vc_item_t	*c2 = *(const zbx_vc_item_t * const *)d2;
+	/* free blocks that are not accessible by readers anymore before growing the retired list */
+	if (vc_cache->retired_num == vc_cache->retired_alloc)
+		vc_lockfree_reclaim();
 
-	ZBX_RETURN_IF_NOT_EQUAL(c2->values_total, c1->values_total);
+	if (vc_cache->retired_num == vc_cache->retired_alloc)
+	{
+		zbx_vc_retired_t	*retired;
+		int			retired_alloc;
 
-	return 0;
+		retired_alloc = (0 == vc_cache->retired_alloc ? 64 : vc_cache->retired_alloc * 2);
+
+		if (NULL == (retired = (zbx_vc_retired_t *)__vc_shmem_realloc_func(vc_cache->retired,
+				sizeof(zbx_vc_retired_t) * (size_t)retired_alloc)))
+		{
+			/* not enough memory to track retired block - wait for readers and free it directly */
+			vc_lockfree_synchronize();
+			__vc_shmem_free_func(ptr);
+			return;
+		}
+
+		vc_cache->retired = retired;
+		vc_cache->retired_alloc = retired_alloc;
+	}
+
+	vc_cache->retired[vc_cache->retired_num].ptr = ptr;
+	vc_cache->retired[vc_cache->retired_num].epoch = atomic_load(&vc_cache->epoch);
+	vc_cache->retired_num++;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: find out items responsible for low memory                         *
+ * Purpose: publish items hashset slots for lock-free readers if they were    *
+ *          changed                                                           *
+ *                                                                            *
+ * Comments: If index cannot be allocated readers fall back to locked reads   *
+ *           until next successful publishing.                                *
  *                                                                            *
  ******************************************************************************/
-static void	vc_dump_items_statistics(void)
+static void	vc_lockfree_publish_index(void)
 {
-	zbx_vc_item_t		*item;
-	zbx_hashset_iter_t	iter;
-	int			i, total = 0, limit;
-	zbx_vector_ptr_t	items;
-
-	zabbix_log(LOG_LEVEL_WARNING, "=== most used items statistics for value cache ===");
-
-	zbx_vector_ptr_create(&items);
-
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	zbx_vc_items_index_t	*index;
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	if (NULL != (index = vc_cache->items_index) && index->slots == vc_cache->items.slots &&
+			index->num_slots == vc_cache->items.num_slots)
 	{
-		zbx_vector_ptr_append(&items, item);
-		total += item->values_total;
+		return;
 	}
 
-	zbx_vector_ptr_sort(&items, vc_compare_items_by_total_values);
-
-	for (i = 0, limit = MIN(items.values_num, ZBX_VC_LOW_MEMORY_ITEM_PRINT_LIMIT); i < limit; i++)
+	if (NULL != (index = (zbx_vc_items_index_t *)__vc_shmem_malloc_func(NULL, sizeof(zbx_vc_items_index_t))))
 	{
-		item = (zbx_vc_item_t *)items.values[i];
-
-		zabbix_log(LOG_LEVEL_WARNING, "itemid:" ZBX_FS_UI64 " active range:%d hits:" ZBX_FS_UI64 " count:%d"
-				" perc:" ZBX_FS_DBL "%%", item->itemid, item->active_range, item->hits,
-				item->values_total, 100 * (double)item->values_total / total);
+		index->slots = vc_cache->items.slots;
+		index->num_slots = vc_cache->items.num_slots;
 	}
 
-	zbx_vector_ptr_destroy(&items);
+	atomic_thread_fence(memory_order_release);
 
-	zabbix_log(LOG_LEVEL_WARNING, "==================================================");
+	if (NULL != vc_cache->items_index)
+		vc_lockfree_retire(vc_cache->items_index);
+
+	vc_cache->items_index = index;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: logs warning when item allocation in cache failed due to          *
- *          insufficient space.                                               *
+ * Purpose: get lock-free reader slot of the current process/thread           *
  *                                                                            *
- * Comments: The failed alloc warning is written to log every 5 minutes.      *
+ * Return value: the reader slot or NULL if all slots are claimed             *
+ *                                                                            *
+ * Comments: Slots are claimed on first lock-free read and are kept until     *
+ *           cache is destroyed.                                              *
  *                                                                            *
  ******************************************************************************/
-static void	vc_warn_alloc(const zbx_vc_item_t *item, size_t requested_bytes)
+static zbx_vc_reader_t	*vc_lockfree_reader(void)
 {
-	time_t	now;
+	int	i;
 
-	now = time(NULL);
+	if (0 <= vc_reader_slot)
+		return &vc_cache->readers[vc_reader_slot];
 
-	if (now - vc_cache->last_alloc_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
+	if (-1 != vc_reader_slot)
+		return NULL;
+
+	for (i = 0; i < ZBX_VC_READERS_MAX; i++)
 	{
-		vc_cache->last_alloc_warning_time = now;
+		zbx_uint32_t	claimed = 0;
 
-		zabbix_log(LOG_LEVEL_WARNING, "cannot allocate " ZBX_FS_SIZE_T " bytes for itemid:" ZBX_FS_UI64
-				" in value cache", (zbx_fs_size_t)requested_bytes, item->itemid);
+		if (0 != atomic_compare_exchange_strong(&vc_cache->readers[i].claimed, &claimed, 1))
+		{
+			vc_reader_slot = i;
+			return &vc_cache->readers[i];
+		}
 	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "all value cache lock-free reader slots are used, falling back to locked reads");
+	vc_reader_slot = -2;
+
+	return NULL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: logs low memory warning                                           *
+ * Purpose: find item in the published items index without locking cache     *
  *                                                                            *
- * Comments: The low memory warning is written to log every 5 minutes when    *
- *           cache is working in the low memory mode.                         *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *             seq    - [IN] the write sequence number at read section start  *
+ *                                                                            *
+ * Return value: the item or NULL if item was not found or the index was      *
+ *               modified during search                                       *
  *                                                                            *
  ******************************************************************************/
-static void	vc_warn_low_memory(void)
+static const zbx_vc_item_t	*vc_lockfree_find_item(zbx_uint64_t itemid, zbx_uint64_t seq)
 {
-	int	now;
+	const zbx_vc_items_index_t	*index;
+	const ZBX_HASHSET_ENTRY_T	*entry;
+	zbx_hash_t			hash;
 
-	now = (int)time(NULL);
+	if (NULL == (index = vc_cache->items_index) || 0 == index->num_slots)
+		return NULL;
 
-	if (now - vc_cache->mode_time > ZBX_VC_LOW_MEMORY_RESET_PERIOD)
-	{
-		vc_cache->mode = ZBX_VC_MODE_NORMAL;
-		vc_cache->mode_time = now;
+	hash = ZBX_DEFAULT_ID_HASH_FUNC(&itemid);
 
-		zabbix_log(LOG_LEVEL_WARNING, "value cache has been switched from low memory to normal operation mode");
-	}
-	else if (now - vc_cache->last_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
+	for (entry = index->slots[hash % (zbx_hash_t)index->num_slots]; NULL != entry; entry = entry->next)
 	{
-		vc_cache->last_warning_time = now;
-		vc_dump_items_statistics();
-		zbx_shmem_dump_stats(LOG_LEVEL_WARNING, vc_mem);
+		if (!VC_LOCKFREE_PTR_VALID(entry) || seq != atomic_load_explicit(&vc_cache->seq, memory_order_acquire))
+			return NULL;
 
-		zabbix_log(LOG_LEVEL_WARNING, "value cache is fully used: please increase ValueCacheSize"
-				" configuration parameter");
+		if (entry->hash == hash && *(const zbx_uint64_t *)entry->data == itemid)
+			return (const zbx_vc_item_t *)entry->data;
 	}
+
+	return NULL;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees space in cache by dropping items not accessed for more than *
- *          24 hours                                                          *
+ * Purpose: copy item history records from cache without locking             *
  *                                                                            *
- * Parameters: source_item - [IN] the item requesting more space to store its *
- *                                data                                        *
+ * Parameters: item    - [IN] the item                                        *
+ *             seq     - [IN] the write sequence number at read section start *
+ *             values  - [OUT] the item history records, string and log       *
+ *                             values still reference cache memory            *
+ *             seconds - [IN] the time period to retrieve data for            *
+ *             count   - [IN] the number of history values to retrieve        *
+ *             ts      - [IN] the requested period end timestamp              *
  *                                                                            *
- * Return value:  number of bytes freed                                       *
+ * Return value: SUCCEED - the records were copied                            *
+ *               FAIL    - inconsistent item data, cache was modified         *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_release_unused_items(const zbx_vc_item_t *source_item)
+static int	vc_lockfree_copy_records(const zbx_vc_item_t *item, zbx_uint64_t seq,
+		zbx_vector_history_record_t *values, int seconds, int count, const zbx_timespec_t *ts)
 {
-	int			timestamp;
-	zbx_hashset_iter_t	iter;
-	zbx_vc_item_t		*item;
-	size_t			freed = 0;
+	const zbx_vc_chunk_t		*chunk;
+	const zbx_history_record_t	*slots;
+	zbx_timespec_t			start = {ts->sec - seconds, ts->ns};
+	int				index, first_value, last_value;
 
-	if (NULL == vc_cache)
-		return freed;
+	for (chunk = item->head; NULL != chunk; chunk = chunk->prev)
+	{
+		if (!VC_LOCKFREE_PTR_VALID(chunk) || seq != atomic_load_explicit(&vc_cache->seq, memory_order_acquire))
+			return FAIL;
 
-	timestamp = (int)time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD;
+		first_value = chunk->first_value;
+		last_value = chunk->last_value;
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+		if (0 > first_value || first_value > last_value || last_value >= chunk->slots_num ||
+				(size_t)chunk->slots_num > ZBX_VC_MAX_CHUNK_RECORDS)
+		{
+			return FAIL;
+		}
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
-	{
-		if (0 != item->last_accessed && item->last_accessed < timestamp && source_item != item)
+		if (0 != chunk->packed_size && (0 > chunk->packed_size || (size_t)chunk->packed_size >
+				(size_t)((const char *)vc_mem->hi_bound - (const char *)&chunk->slots[1])))
 		{
-			freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
-			zbx_hashset_iter_remove(&iter);
+			return FAIL;
+		}
+
+		slots = vch_chunk_slots(item, chunk);
+
+		for (index = last_value; index >= first_value; index--)
+		{
+			const zbx_history_record_t	*record = &slots[index];
+
+			if (0 < zbx_timespec_compare(&record->timestamp, ts))
+				continue;
+
+			if (0 != seconds && 0 >= zbx_timespec_compare(&record->timestamp, &start))
+				return SUCCEED;
+
+			zbx_vector_history_record_append_ptr(values, (zbx_history_record_t *)record);
+
+			if (values->values_num == count)
+				return SUCCEED;
 		}
 	}
 
-	return freed;
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees space in cache to store the specified number of bytes by    *
- *          dropping the least accessed items                                 *
+ * Purpose: get item values from cache without locking                        *
  *                                                                            *
- * Parameters: item  - [IN] the item requesting more space to store its data  *
- *             space - [IN] the number of bytes to free                       *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data                       *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
  *                                                                            *
- * Comments: The caller item must not be removed from cache to avoid          *
- *           complications (ie - checking if item still is in cache every     *
- *           time after calling vc_free_space() function).                    *
- *           vc_free_space() attempts to free at least min_free_request       *
- *           bytes of space to reduce number of space release requests.       *
+ * Return value:  SUCCEED - the values were retrieved from cache              *
+ *                FAIL    - the values must be retrieved with cache locked    *
+ *                                                                            *
+ * Comments: Only requests fully covered by cached data are served, anything  *
+ *           requiring database access or cache update falls back to locked   *
+ *           reads.                                                           *
  *                                                                            *
  ******************************************************************************/
-static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
+static int	vc_lockfree_get_values(zbx_uint64_t itemid, unsigned char value_type,
+		zbx_vector_history_record_t *values, int seconds, int count, const zbx_timespec_t *ts)
 {
-	zbx_hashset_iter_t		iter;
-	zbx_vc_item_t			*item;
-	int				i;
-	size_t				freed;
-	zbx_vector_vc_itemweight_t	items;
+	const zbx_vc_item_t	*item;
+	zbx_vc_reader_t		*reader;
+	zbx_uint64_t		seq;
+	int			ret = FAIL, range_start, range_timestamp, now, i;
 
-	/* reserve at least min_free_request bytes to avoid spamming with free space requests */
-	if (space < vc_cache->min_free_request)
-		space = vc_cache->min_free_request;
+	if (0 == vc_cache->lockfree || NULL == (reader = vc_lockfree_reader()))
+		return FAIL;
 
-	/* first remove items with the last accessed time older than a day */
-	if ((freed = vc_release_unused_items(source_item)) >= space)
-		return;
+	/* enter read section, the epoch must be published before reading cache data */
+	atomic_store(&reader->epoch, atomic_load(&vc_cache->epoch));
 
-	/* failed to free enough space by removing old items, entering low memory mode */
-	vc_cache->mode = ZBX_VC_MODE_LOWMEM;
-	vc_cache->mode_time = (int)time(NULL);
+	seq = atomic_load(&vc_cache->seq);
 
-	vc_warn_low_memory();
-	vc_warn_alloc(source_item, space);
+	if (0 != (seq & 1) || ZBX_VC_MODE_NORMAL != vc_cache->mode)
+		goto out;
 
-	/* remove items with least hits/size ratio */
-	zbx_vector_vc_itemweight_create(&items);
+	if (NULL == (item = vc_lockfree_find_item(itemid, seq)) || value_type != item->value_type)
+		goto out;
 
-	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+	if (0 == count)
+	{
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
+	}
+	else
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
 
-	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	zbx_vector_history_record_clear(values);
+
+	if (SUCCEED != vc_lockfree_copy_records(item, seq, values, seconds, count, ts))
+		goto out;
+
+	/* check if the requested range is cached, otherwise cache must be updated from database */
+	if (ZBX_ITEM_STATUS_CACHED_ALL != item->status && (0 == item->db_cached_from ||
+			(range_start < item->db_cached_from && (0 == count || values->values_num != count))))
 	{
-		/* don't remove the item that requested the space and also keep */
-		/* items currently being accessed                               */
-		if (item != source_item)
-		{
-			zbx_vc_item_weight_t	weight = {.item = item};
+		goto out;
+	}
 
-			if (0 < item->values_total)
-				weight.weight = (double)item->hits / item->values_total;
+	atomic_thread_fence(memory_order_acquire);
 
-			zbx_vector_vc_itemweight_append_ptr(&items, &weight);
+	if (seq != atomic_load_explicit(&vc_cache->seq, memory_order_relaxed))
+		goto out;
+
+	/* the records are consistent, copy values referenced in cache before leaving read section */
+	if (ITEM_VALUE_TYPE_STR == value_type || ITEM_VALUE_TYPE_TEXT == value_type ||
+			ITEM_VALUE_TYPE_LOG == value_type)
+	{
+		for (i = 0; i < values->values_num; i++)
+		{
+			zbx_history_record_t	record = values->values[i];
+
+			zbx_history_record_copy(&values->values[i], &record, value_type);
 		}
 	}
 
-	zbx_vector_vc_itemweight_sort(&items, vc_item_weight_compare);
+	now = (int)time(NULL);
 
-	for (i = 0; i < items.values_num && freed < space; i++)
+	if (0 == count)
 	{
-		item = items.values[i].item;
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	}
+	else if (count > values->values_num)
+	{
+		if (0 != seconds)
+		{
+			range_timestamp = ts->sec - seconds;
+			vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+		}
+	}
+	else
+	{
+		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+	}
 
-		freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
-		zbx_hashset_remove_direct(&vc_cache->items, item);
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_STATS, values->values_num, 0);
+
+	ret = SUCCEED;
+out:
+	if (SUCCEED != ret)
+	{
+		/* values unpacked during inconsistent read must not be reused */
+		vch_chunk_reset_unpacked();
+		zbx_vector_history_record_clear(values);
 	}
-	zbx_vector_vc_itemweight_destroy(&items);
+
+	atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+
+	return ret;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: appends the specified value to value vector                       *
- *                                                                            *
- * Parameters: vector     - [IN/OUT] the value vector                         *
- *             value_type - [IN] the type of value to append                  *
- *             value      - [IN] the value to append                          *
- *                                                                            *
- * Comments: Additional memory is allocated to store string, text and log     *
- *           value contents. This memory must be freed by the caller.         *
- *                                                                            *
- ******************************************************************************/
-static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
-		zbx_history_record_t *value)
+#else
+
+static int	vc_lockfree_get_values(zbx_uint64_t itemid, unsigned char value_type,
+		zbx_vector_history_record_t *values, int seconds, int count, const zbx_timespec_t *ts)
 {
-	zbx_history_record_t	record;
+	ZBX_UNUSED(itemid);
+	ZBX_UNUSED(value_type);
+	ZBX_UNUSED(values);
+	ZBX_UNUSED(seconds);
+	ZBX_UNUSED(count);
+	ZBX_UNUSED(ts);
 
-	zbx_history_record_copy(&record, value, value_type);
-	zbx_vector_history_record_append_ptr(vector, &record);
+	return FAIL;
 }
 
+#endif
+
 /******************************************************************************
  *                                                                            *
- * Purpose: allocate cache memory to store item's resources                   *
- *                                                                            *
- * Parameters: item   - [IN] the item                                         *
- *             size   - [IN] the number of bytes to allocate                  *
- *                                                                            *
- * Return value:  The pointer to allocated memory or NULL if there is not     *
- *                enough shared memory.                                       *
- *                                                                            *
- * Comments: If allocation fails this function attempts to free the required  *
- *           space in cache by calling vc_free_space() and tries again. If it *
- *           still fails a NULL value is returned.                            *
+ * Purpose: mark start of cache write section for lock-free readers           *
  *                                                                            *
  ******************************************************************************/
-static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
+static void	vc_write_begin(void)
 {
-	char	*ptr;
-
-	if (NULL == (ptr = (char *)__vc_shmem_malloc_func(NULL, size)))
+#if defined(ZBX_VC_LOCKFREE)
+	if (0 != vc_cache->lockfree)
 	{
-		/* If failed to allocate required memory, try to free space in      */
-		/* cache and allocate again. If there still is not enough space -   */
-		/* return NULL as failure.                                          */
-		vc_release_space(item, size);
-		ptr = (char *)__vc_shmem_malloc_func(NULL, size);
+		atomic_fetch_add(&vc_cache->seq, 1);
+		vc_write_locked = 1;
 	}
-
-	return ptr;
+#endif
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies string to the cache memory                                 *
- *                                                                            *
- * Parameters: item  - [IN] the item                                          *
- *             str   - [IN] the string to copy                                *
- *                                                                            *
- * Return value:  The pointer to the copied string or NULL if there was not   *
- *                enough space in cache.                                      *
- *                                                                            *
- * Comments: If the string pool already contains matching string, then its    *
- *           reference counter is incremented and the string returned.        *
- *                                                                            *
- *           Otherwise cache memory is allocated to store the specified       *
- *           string. If the allocation fails this function attempts to free   *
- *           the required space in cache by calling vc_release_space() and    *
- *           tries again. If it still fails then a NULL value is returned.    *
+ * Purpose: mark end of cache write section for lock-free readers, free       *
+ *          retired memory that is not accessed by readers anymore            *
  *                                                                            *
  ******************************************************************************/
-static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
+static void	vc_write_end(void)
 {
-	void	*ptr;
-	int	tries = 0;
-	size_t	len;
-
-	len = strlen(str) + 1;
+#if defined(ZBX_VC_LOCKFREE)
+	if (0 == vc_write_locked)
+		return;
 
-	while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
-			REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE, REFCOUNT_FIELD_SIZE + len,
-			ZBX_HASHSET_UNIQ_FALSE)))
-	{
-		/* If there is not enough space - free enough to store string + hashset entry overhead */
-		/* and try inserting one more time. If it fails again, then fail the function.         */
-		if (0 == tries++)
-			vc_release_space(item, len + REFCOUNT_FIELD_SIZE + sizeof(ZBX_HASHSET_ENTRY_T));
-		else
-			return NULL;
-	}
+	vc_write_locked = 0;
 
-	(*(zbx_uint32_t *)ptr)++;
+	vc_lockfree_publish_index();
+	vc_lockfree_reclaim();
 
-	return (char *)ptr + REFCOUNT_FIELD_SIZE;
+	atomic_fetch_add(&vc_cache->seq, 1);
+#endif
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes string from cache string pool                             *
- *                                                                            *
- * Parameters: str   - [IN] the string to remove                              *
- *                                                                            *
- * Return value: the number of bytes freed                                    *
- *                                                                            *
- * Comments: This function decrements the string reference counter and        *
- *           removes it from the string pool when counter becomes zero.       *
+ * Purpose: frees value cache memory                                          *
  *                                                                            *
- *           Note - only strings created with vc_item_strdup() function must  *
- *           be freed with vc_item_strfree().                                 *
+ * Comments: In lock-free read mode the memory is freed when it cannot be     *
+ *           accessed by readers anymore.                                     *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_strfree(char *str)
+static void	vc_mem_free_func(void *ptr)
 {
-	size_t	freed = 0;
-
-	if (NULL != str)
+#if defined(ZBX_VC_LOCKFREE)
+	if (0 != vc_cache->lockfree)
 	{
-		void	*ptr = str - REFCOUNT_FIELD_SIZE;
-
-		if (0 == --(*(zbx_uint32_t *)ptr))
-		{
-			freed = strlen(str) + REFCOUNT_FIELD_SIZE + 1;
-			zbx_hashset_remove_direct(&vc_cache->strpool, ptr);
-		}
+		vc_lockfree_retire(ptr);
+		return;
 	}
-
-	return freed;
+#endif
+	__vc_shmem_free_func(ptr);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies log value to the cache memory                              *
- *                                                                            *
- * Parameters: item  - [IN] the item                                          *
- *             log   - [IN] the log value to copy                             *
- *                                                                            *
- * Return value:  The pointer to the copied log value or NULL if there was    *
- *                not enough space in cache.                                  *
+ * Purpose: reallocates items hashset slots                                   *
  *                                                                            *
- * Comments: Cache memory is allocated to store the log value. If the         *
- *           allocation fails this function attempts to free the required     *
- *           space in cache by calling vc_release_space() and tries again.    *
- *           If it still fails then a NULL value is returned.                 *
+ * Comments: In lock-free read mode the old slots might still be accessed by  *
+ *           readers, so they are copied to a new memory block and retired    *
+ *           instead of being resized in place.                               *
  *                                                                            *
  ******************************************************************************/
-static zbx_log_value_t	*vc_item_logdup(zbx_vc_item_t *item, const zbx_log_value_t *log)
+static void	*vc_items_realloc_func(void *old, size_t size)
 {
-	zbx_log_value_t	*plog = NULL;
-
-	if (NULL == (plog = (zbx_log_value_t *)vc_item_malloc(item, sizeof(zbx_log_value_t))))
-		return NULL;
-
-	plog->timestamp = log->timestamp;
-	plog->logeventid = log->logeventid;
-	plog->severity = log->severity;
-
-	if (NULL != log->source)
-	{
-		if (NULL == (plog->source = vc_item_strdup(item, log->source)))
-			goto fail;
-	}
-	else
-		plog->source = NULL;
+	void	*ptr;
 
-	if (NULL == (plog->value = vc_item_strdup(item, log->value)))
-		goto fail;
+	if (0 == vc_cache->lockfree || NULL == old)
+		return __vc_shmem_realloc_func(old, size);
 
-	return plog;
-fail:
-	vc_item_strfree(plog->source);
+	if (NULL == (ptr = __vc_shmem_malloc_func(NULL, size)))
+		return NULL;
 
-	__vc_shmem_free_func(plog);
+	memcpy(ptr, old, (size_t)vc_cache->items.num_slots * sizeof(ZBX_HASHSET_ENTRY_T *));
+	vc_mem_free_func(old);
 
-	return NULL;
+	return ptr;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes log resource from cache memory                            *
- *                                                                            *
- * Parameters: str   - [IN] the log to remove                                 *
- *                                                                            *
- * Return value: the number of bytes freed                                    *
- *                                                                            *
- * Comments: Note - only logs created with vc_item_logdup() function must     *
- *           be freed with vc_item_logfree().                                 *
+ * Purpose: frees memory retired by writers if possible                       *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_logfree(zbx_log_value_t *log)
+static void	vc_mem_reclaim(void)
 {
-	size_t	freed = 0;
+#if defined(ZBX_VC_LOCKFREE)
+	if (0 != vc_cache->lockfree)
+		vc_lockfree_reclaim();
+#endif
+}
 
-	if (NULL != log)
-	{
-		freed += vc_item_strfree(log->source);
-		freed += vc_item_strfree(log->value);
+/* function prototypes */
+static size_t	vch_item_free_cache(zbx_vc_item_t *item);
+static size_t	vc_item_free_windows(zbx_vc_item_t *item);
+static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk);
+static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num);
+static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp);
 
-		__vc_shmem_free_func(log);
-		freed += sizeof(zbx_log_value_t);
-	}
+/*********************************************************************************
+ *                                                                               *
+ * Purpose: reads item history data from database                                *
+ *                                                                               *
+ * Parameters:  itemid        - [IN] the itemid                                  *
+ *              value_type    - [IN] the value type (see ITEM_VALUE_TYPE_* defs) *
+ *              values        - [OUT] the item history data values               *
+ *              range_start   - [IN] the interval start time                     *
+ *              range_end     - [IN] the interval end time                       *
+ *                                                                               *
+ * Return value: SUCCEED - the history data were read successfully               *
+ *               FAIL - otherwise                                                *
+ *                                                                               *
+ * Comments: This function reads all values from the specified range             *
+ *           [range_start, range_end]                                            *
+ *                                                                               *
+ *********************************************************************************/
+static int	vc_db_read_values_by_time(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values,
+		int range_start, int range_end)
+{
+	/* decrement interval start point because interval starting point is excluded by history backend */
+	if (0 != range_start)
+		range_start--;
 
-	return freed;
+	return zbx_history_get_values(itemid, value_type, range_start, 0, range_end, values);
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: frees cache resources of the specified item value range           *
- *                                                                            *
- * Parameters: item    - [IN] the item                                        *
- *             values  - [IN] the target value array                          *
- *             first   - [IN] the first value to free                         *
- *             last    - [IN] the last value to free                          *
+/************************************************************************************
+ *                                                                                  *
+ * Purpose: reads item history data from database                                   *
+ *                                                                                  *
+ * Parameters:  itemid      - [IN] the itemid                                       *
+ *              value_type  - [IN] the value type (see ITEM_VALUE_TYPE_* defs)      *
+ *              values      - [OUT] the item history data values                    *
+ *              range_start - [IN] the interval start time                          *
+ *              count       - [IN] the number of values to read                     *
+ *              range_end   - [IN] the interval end time                            *
+ *              ts          - [IN] the requested timestamp                          *
+ *                                                                                  *
+ * Return value: SUCCEED - the history data were read successfully                  *
+ *               FAIL - otherwise                                                   *
+ *                                                                                  *
+ * Comments: This function will return the smallest data interval on seconds scale  *
+ *           that includes the requested values.                                    *
+ *                                                                                  *
+ ************************************************************************************/
+static int	vc_db_read_values_by_time_and_count(zbx_uint64_t itemid, int value_type,
+		zbx_vector_history_record_t *values, int range_start, int count, int range_end,
+		const zbx_timespec_t *ts)
+{
+	int	first_timestamp, last_timestamp, i, left = 0, values_start;
+
+	/* remember the number of values already stored in values vector */
+	values_start = values->values_num;
+
+	if (0 != range_start)
+		range_start--;
+
+	/* Count based requests can 'split' the data of oldest second. For example if we have    */
+	/* values with timestamps Ta.0 Tb.0, Tb.5, Tc.0 then requesting 2 values from [0, Tc]    */
+	/* range will return Tb.5, Tc.0,leaving Tb.0 value in database. However because          */
+	/* second is the smallest time unit history backends can work with, data must be cached  */
+	/* by second intervals - it cannot have some values from Tb cached and some not.         */
+	/* This is achieved by two means:                                                        */
+	/*   1) request more (by one) values than we need. In most cases there will be no        */
+	/*      multiple values per second (exceptions are logs and trapper items) - for example */
+	/*      Ta.0, Tb.0, Tc.0. We need 2 values from Tc. Requesting 3 values gets us          */
+	/*      Ta.0, Tb.0, Tc.0. As Ta != Tb we can be sure that all values from the last       */
+	/*      timestamp (Tb) have been cached. So we can drop Ta.0 and return Tb.0, Tc.0.      */
+	/*   2) Re-read the last second. For example if we have values with timestamps           */
+	/*      Ta.0 Tb.0, Tb.5, Tc.0, then requesting 3 values from Tc gets us Tb.0, Tb.5, Tc.0.*/
+	/*      Now we cannot be sure that there are no more values with Tb.* timestamp. So the  */
+	/*      only thing we can do is to:                                                      */
+	/*        a) remove values with Tb.* timestamp from result,                              */
+	/*        b) read all values with Tb.* timestamp from database,                          */
+	/*        c) add read values to the result.                                              */
+	if (FAIL == zbx_history_get_values(itemid, value_type, range_start, count + 1, range_end, values))
+		return FAIL;
+
+	/* returned less than requested - all values are read */
+	if (count > values->values_num - values_start)
+		return SUCCEED;
+
+	/* Check if some of values aren't past the required range. For example we have values    */
+	/* with timestamps Ta.0, Tb.0, Tb.5. As history backends work on seconds interval we     */
+	/* can only request values from Tb which would include Tb.5, even if the requested       */
+	/* end timestamp was less (for example Tb.0);                                            */
+
+	/* values from history backend are sorted in descending order by timestamp seconds */
+	first_timestamp = values->values[values->values_num - 1].timestamp.sec;
+	last_timestamp = values->values[values_start].timestamp.sec;
+
+	for (i = values_start; i < values->values_num && values->values[i].timestamp.sec == last_timestamp; i++)
+	{
+		if (0 > zbx_timespec_compare(ts, &values->values[i].timestamp))
+			left++;
+	}
+
+	/* read missing data */
+	if (0 != left)
+	{
+		int	offset;
+
+		/* drop the first (oldest) second to ensure range cutoff at full second */
+		while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == first_timestamp)
+		{
+			values->values_num--;
+			zbx_history_record_clear(&values->values[values->values_num], value_type);
+			left++;
+		}
+
+		offset = values->values_num;
+
+		if (FAIL == zbx_history_get_values(itemid, value_type, range_start, left, first_timestamp, values))
+			return FAIL;
+
+		/* returned less than requested - all values are read */
+		if (left > values->values_num - offset)
+			return SUCCEED;
+
+		first_timestamp = values->values[values->values_num - 1].timestamp.sec;
+	}
+
+	/* drop the first (oldest) second to ensure range cutoff at full second */
+	while (0 < values->values_num && values->values[values->values_num - 1].timestamp.sec == first_timestamp)
+	{
+		values->values_num--;
+		zbx_history_record_clear(&values->values[values->values_num], value_type);
+	}
+
+	/* check if there are enough values matching the request range */
+
+	for (i = values_start; i < values->values_num; i++)
+	{
+		if (0 <= zbx_timespec_compare(ts, &values->values[i].timestamp))
+			count--;
+	}
+
+	if (0 >= count)
+		return SUCCEED;
+
+	/* re-read the first (oldest) second */
+	return zbx_history_get_values(itemid, value_type, first_timestamp - 1, 0, first_timestamp, values);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get item history data for the specified time period directly from *
+ *          database                                                          *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             values     - [OUT] the item history data stored time/value     *
+ *                          pairs in descending order                         *
+ *             seconds    - [IN] the time period to retrieve data for         *
+ *             count      - [IN] the number of history values to retrieve     *
+ *             ts         - [IN] the period end timestamp                     *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_db_get_values(zbx_uint64_t itemid, int value_type, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
+{
+	int	ret = FAIL, i, j, range_start;
+
+	if (0 == count)
+	{
+		/* read one more second to cover for possible nanosecond shift */
+		ret = vc_db_read_values_by_time(itemid, value_type, values, ts->sec - seconds, ts->sec);
+	}
+	else
+	{
+		/* read one more second to cover for possible nanosecond shift */
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
+		ret = vc_db_read_values_by_time_and_count(itemid, value_type, values, range_start, count, ts->sec, ts);
+	}
+
+	if (SUCCEED != ret)
+		return ret;
+
+	zbx_vector_history_record_sort(values, zbx_history_record_compare_desc);
+
+	/* History backend returns values by full second intervals. With nanosecond resolution */
+	/* some of returned values might be outside the requested range, for example:          */
+	/*   returned values: |.o...o..o.|.o...o..o.|.o...o..o.|.o...o..o.|                    */
+	/*   request range:        \_______________________________/                           */
+	/* Check if there are any values before and past the requested range and remove them.  */
+
+	/* find the last value with timestamp less or equal to the requested range end point */
+	for (i = 0; i < values->values_num; i++)
+	{
+		if (0 >= zbx_timespec_compare(&values->values[i].timestamp, ts))
+			break;
+	}
+
+	/* all values are past requested range (timestamp greater than requested), return empty vector */
+	if (i == values->values_num)
+	{
+		zbx_history_record_vector_clean(values, value_type);
+		return SUCCEED;
+	}
+
+	/* remove values with timestamp greater than the requested */
+	if (0 != i)
+	{
+		for (j = 0; j < i; j++)
+			zbx_history_record_clear(&values->values[j], value_type);
+
+		for (j = 0; i < values->values_num; i++, j++)
+			values->values[j] = values->values[i];
+
+		values->values_num = j;
+	}
+
+	/* for count based requests remove values exceeding requested count */
+	if (0 != count)
+	{
+		while (count < values->values_num)
+			zbx_history_record_clear(&values->values[--values->values_num], value_type);
+	}
+
+	/* for time based requests remove values with timestamp outside requested range */
+	if (0 != seconds)
+	{
+		zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+
+		while (0 < values->values_num &&
+				0 >= zbx_timespec_compare(&values->values[values->values_num - 1].timestamp, &start))
+		{
+			zbx_history_record_clear(&values->values[--values->values_num], value_type);
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Common API                                                                                                     *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+
+/******************************************************************************
+ *                                                                            *
+ * String pool definitions & functions                                        *
+ *                                                                            *
+ ******************************************************************************/
+
+#define REFCOUNT_FIELD_SIZE	sizeof(zbx_uint32_t)
+
+static zbx_hash_t	vc_strpool_hash_func(const void *data)
+{
+	return ZBX_DEFAULT_STRING_HASH_FUNC((const char *)data + REFCOUNT_FIELD_SIZE);
+}
+
+static int	vc_strpool_compare_func(const void *d1, const void *d2)
+{
+	return strcmp((const char *)d1 + REFCOUNT_FIELD_SIZE, (const char *)d2 + REFCOUNT_FIELD_SIZE);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares two item weight data structures by their 'weight'        *
+ *                                                                            *
+ * Parameters: a1   - [IN] first item weight data structure                   *
+ *             a2   - [IN] second item weight data structure                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_item_weight_compare(const void *a1, const void *a2)
+{
+	const zbx_vc_item_weight_t	*d1 = (const zbx_vc_item_weight_t *)a1;
+	const zbx_vc_item_weight_t	*d2 = (const zbx_vc_item_weight_t *)a2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(d1->weight, d2->weight);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates cache and item statistics                                 *
+ *                                                                            *
+ * Parameters: item    - [IN] the item (optional)                             *
+ *             hits    - [IN] the number of hits to add                       *
+ *             misses  - [IN] the number of misses to add                     *
+ *                                                                            *
+ * Comments: The misses are added only to cache statistics, while hits are    *
+ *           added to both - item and cache statistics.                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_update_statistics(zbx_vc_item_t *item, int hits, int misses, int now)
+{
+	if (NULL != item)
+	{
+		int	hour;
+
+		item->hits += (zbx_uint64_t)hits;
+		item->last_accessed = now;
+
+		hour = item->last_accessed / SEC_PER_HOUR;
+		if (hour != item->hour)
+		{
+			item->last_hourly_num = item->hourly_num;
+			item->hourly_num = 0;
+			item->hour = hour;
+		}
+
+		if (hits + misses > item->hourly_num)
+			item->hourly_num = hits + misses;
+	}
+
+	if (ZBX_VC_ENABLED == vc_state)
+	{
+		vc_cache->hits += (zbx_uint64_t)hits;
+		vc_cache->misses += (zbx_uint64_t)misses;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: is used to sort items by value count in descending order          *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_compare_items_by_total_values(const void *d1, const void *d2)
+{
+	const zbx_vc_item_t	*c1 = *(const zbx_vc_item_t * const *)d1;
+	const zbx_vc_item_t	*c2 = *(const zbx_vc_item_t * const *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(c2->values_total, c1->values_total);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find out items responsible for low memory                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_dump_items_statistics(void)
+{
+	zbx_vc_item_t		*item;
+	zbx_hashset_iter_t	iter;
+	int			i, total = 0, limit;
+	zbx_vector_ptr_t	items;
+
+	zabbix_log(LOG_LEVEL_WARNING, "=== most used items statistics for value cache ===");
+
+	zbx_vector_ptr_create(&items);
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_ptr_append(&items, item);
+		total += item->values_total;
+	}
+
+	zbx_vector_ptr_sort(&items, vc_compare_items_by_total_values);
+
+	for (i = 0, limit = MIN(items.values_num, ZBX_VC_LOW_MEMORY_ITEM_PRINT_LIMIT); i < limit; i++)
+	{
+		item = (zbx_vc_item_t *)items.values[i];
+
+		zabbix_log(LOG_LEVEL_WARNING, "itemid:" ZBX_FS_UI64 " active range:%d hits:" ZBX_FS_UI64 " count:%d"
+				" perc:" ZBX_FS_DBL "%%", item->itemid, item->active_range, item->hits,
+				item->values_total, 100 * (double)item->values_total / total);
+	}
+
+	zbx_vector_ptr_destroy(&items);
+
+	zabbix_log(LOG_LEVEL_WARNING, "==================================================");
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs warning when item allocation in cache failed due to          *
+ *          insufficient space.                                               *
+ *                                                                            *
+ * Comments: The failed alloc warning is written to log every 5 minutes.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_warn_alloc(const zbx_vc_item_t *item, size_t requested_bytes)
+{
+	time_t	now;
+
+	now = time(NULL);
+
+	if (now - vc_cache->last_alloc_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
+	{
+		vc_cache->last_alloc_warning_time = now;
+
+		zabbix_log(LOG_LEVEL_WARNING, "cannot allocate " ZBX_FS_SIZE_T " bytes for itemid:" ZBX_FS_UI64
+				" in value cache", (zbx_fs_size_t)requested_bytes, item->itemid);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: logs low memory warning                                           *
+ *                                                                            *
+ * Comments: The low memory warning is written to log every 5 minutes when    *
+ *           cache is working in the low memory mode.                         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_warn_low_memory(void)
+{
+	int	now;
+
+	now = (int)time(NULL);
+
+	if (now - vc_cache->mode_time > ZBX_VC_LOW_MEMORY_RESET_PERIOD)
+	{
+		vc_cache->mode = ZBX_VC_MODE_NORMAL;
+		vc_cache->mode_time = now;
+
+		zabbix_log(LOG_LEVEL_WARNING, "value cache has been switched from low memory to normal operation mode");
+	}
+	else if (now - vc_cache->last_warning_time > ZBX_VC_LOW_MEMORY_WARNING_PERIOD)
+	{
+		vc_cache->last_warning_time = now;
+		vc_dump_items_statistics();
+		zbx_shmem_dump_stats(LOG_LEVEL_WARNING, vc_mem);
+
+		zabbix_log(LOG_LEVEL_WARNING, "value cache is fully used: please increase ValueCacheSize"
+				" configuration parameter");
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees space in cache by dropping items not accessed for more than *
+ *          24 hours                                                          *
+ *                                                                            *
+ * Parameters: source_item - [IN] the item requesting more space to store its *
+ *                                data                                        *
+ *                                                                            *
+ * Return value:  number of bytes freed                                       *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_release_unused_items(const zbx_vc_item_t *source_item)
+{
+	int			timestamp;
+	zbx_hashset_iter_t	iter;
+	zbx_vc_item_t		*item;
+	size_t			freed = 0;
+
+	if (NULL == vc_cache)
+		return freed;
+
+	timestamp = (int)time(NULL) - ZBX_VC_ITEM_EXPIRE_PERIOD;
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (0 != item->last_accessed && item->last_accessed < timestamp && source_item != item)
+		{
+			freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
+			zbx_hashset_iter_remove(&iter);
+		}
+	}
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees space in cache to store the specified number of bytes by    *
+ *          dropping the least accessed items                                 *
+ *                                                                            *
+ * Parameters: item  - [IN] the item requesting more space to store its data  *
+ *             space - [IN] the number of bytes to free                       *
+ *                                                                            *
+ * Comments: The caller item must not be removed from cache to avoid          *
+ *           complications (ie - checking if item still is in cache every     *
+ *           time after calling vc_free_space() function).                    *
+ *           vc_free_space() attempts to free at least min_free_request       *
+ *           bytes of space to reduce number of space release requests.       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_release_space(zbx_vc_item_t *source_item, size_t space)
+{
+	zbx_hashset_iter_t		iter;
+	zbx_vc_item_t			*item;
+	int				i;
+	size_t				freed;
+	zbx_vector_vc_itemweight_t	items;
+
+	/* reserve at least min_free_request bytes to avoid spamming with free space requests */
+	if (space < vc_cache->min_free_request)
+		space = vc_cache->min_free_request;
+
+	/* first remove items with the last accessed time older than a day */
+	if ((freed = vc_release_unused_items(source_item)) >= space)
+		return;
+
+	/* failed to free enough space by removing old items, entering low memory mode */
+	vc_cache->mode = ZBX_VC_MODE_LOWMEM;
+	vc_cache->mode_time = (int)time(NULL);
+
+	vc_warn_low_memory();
+	vc_warn_alloc(source_item, space);
+
+	/* remove items with least hits/size ratio */
+	zbx_vector_vc_itemweight_create(&items);
+
+	zbx_hashset_iter_reset(&vc_cache->items, &iter);
+
+	while (NULL != (item = (zbx_vc_item_t *)zbx_hashset_iter_next(&iter)))
+	{
+		/* don't remove the item that requested the space and also keep */
+		/* items currently being accessed                               */
+		if (item != source_item)
+		{
+			zbx_vc_item_weight_t	weight = {.item = item};
+
+			if (0 < item->values_total)
+				weight.weight = (double)item->hits / item->values_total;
+
+			zbx_vector_vc_itemweight_append_ptr(&items, &weight);
+		}
+	}
+
+	zbx_vector_vc_itemweight_sort(&items, vc_item_weight_compare);
+
+	for (i = 0; i < items.values_num && freed < space; i++)
+	{
+		item = items.values[i].item;
+
+		freed += vch_item_free_cache(item) + sizeof(zbx_vc_item_t);
+		zbx_hashset_remove_direct(&vc_cache->items, item);
+	}
+	zbx_vector_vc_itemweight_destroy(&items);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: appends the specified value to value vector                       *
+ *                                                                            *
+ * Parameters: vector     - [IN/OUT] the value vector                         *
+ *             value_type - [IN] the type of value to append                  *
+ *             value      - [IN] the value to append                          *
+ *                                                                            *
+ * Comments: Additional memory is allocated to store string, text and log     *
+ *           value contents. This memory must be freed by the caller.         *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_history_record_vector_append(zbx_vector_history_record_t *vector, int value_type,
+		zbx_history_record_t *value)
+{
+	zbx_history_record_t	record;
+
+	zbx_history_record_copy(&record, value, value_type);
+	zbx_vector_history_record_append_ptr(vector, &record);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate cache memory to store item's resources                   *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             size   - [IN] the number of bytes to allocate                  *
+ *                                                                            *
+ * Return value:  The pointer to allocated memory or NULL if there is not     *
+ *                enough shared memory.                                       *
+ *                                                                            *
+ * Comments: If allocation fails this function attempts to free the required  *
+ *           space in cache by calling vc_free_space() and tries again. If it *
+ *           still fails a NULL value is returned.                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	*vc_item_malloc(zbx_vc_item_t *item, size_t size)
+{
+	char	*ptr;
+
+	if (NULL == (ptr = (char *)__vc_shmem_malloc_func(NULL, size)))
+	{
+		/* If failed to allocate required memory, try to free space in      */
+		/* cache and allocate again. If there still is not enough space -   */
+		/* return NULL as failure.                                          */
+		vc_release_space(item, size);
+		vc_mem_reclaim();
+		ptr = (char *)__vc_shmem_malloc_func(NULL, size);
+	}
+
+	return ptr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies string to the cache memory                                 *
+ *                                                                            *
+ * Parameters: item  - [IN] the item                                          *
+ *             str   - [IN] the string to copy                                *
+ *                                                                            *
+ * Return value:  The pointer to the copied string or NULL if there was not   *
+ *                enough space in cache.                                      *
+ *                                                                            *
+ * Comments: If the string pool already contains matching string, then its    *
+ *           reference counter is incremented and the string returned.        *
+ *                                                                            *
+ *           Otherwise cache memory is allocated to store the specified       *
+ *           string. If the allocation fails this function attempts to free   *
+ *           the required space in cache by calling vc_release_space() and    *
+ *           tries again. If it still fails then a NULL value is returned.    *
+ *                                                                            *
+ ******************************************************************************/
+static char	*vc_item_strdup(zbx_vc_item_t *item, const char *str)
+{
+	void	*ptr;
+	int	tries = 0;
+	size_t	len;
+
+	len = strlen(str) + 1;
+
+	while (NULL == (ptr = zbx_hashset_insert_ext(&vc_cache->strpool, str - REFCOUNT_FIELD_SIZE,
+			REFCOUNT_FIELD_SIZE + len, REFCOUNT_FIELD_SIZE, REFCOUNT_FIELD_SIZE + len,
+			ZBX_HASHSET_UNIQ_FALSE)))
+	{
+		/* If there is not enough space - free enough to store string + hashset entry overhead */
+		/* and try inserting one more time. If it fails again, then fail the function.         */
+		if (0 == tries++)
+			vc_release_space(item, len + REFCOUNT_FIELD_SIZE + sizeof(ZBX_HASHSET_ENTRY_T));
+		else
+			return NULL;
+	}
+
+	(*(zbx_uint32_t *)ptr)++;
+
+	return (char *)ptr + REFCOUNT_FIELD_SIZE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes string from cache string pool                             *
+ *                                                                            *
+ * Parameters: str   - [IN] the string to remove                              *
+ *                                                                            *
+ * Return value: the number of bytes freed                                    *
+ *                                                                            *
+ * Comments: This function decrements the string reference counter and        *
+ *           removes it from the string pool when counter becomes zero.       *
+ *                                                                            *
+ *           Note - only strings created with vc_item_strdup() function must  *
+ *           be freed with vc_item_strfree().                                 *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_item_strfree(char *str)
+{
+	size_t	freed = 0;
+
+	if (NULL != str)
+	{
+		void	*ptr = str - REFCOUNT_FIELD_SIZE;
+
+		if (0 == --(*(zbx_uint32_t *)ptr))
+		{
+			freed = strlen(str) + REFCOUNT_FIELD_SIZE + 1;
+			zbx_hashset_remove_direct(&vc_cache->strpool, ptr);
+		}
+	}
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies log value to the cache memory                              *
+ *                                                                            *
+ * Parameters: item  - [IN] the item                                          *
+ *             log   - [IN] the log value to copy                             *
+ *                                                                            *
+ * Return value:  The pointer to the copied log value or NULL if there was    *
+ *                not enough space in cache.                                  *
+ *                                                                            *
+ * Comments: Cache memory is allocated to store the log value. If the         *
+ *           allocation fails this function attempts to free the required     *
+ *           space in cache by calling vc_release_space() and tries again.    *
+ *           If it still fails then a NULL value is returned.                 *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_log_value_t	*vc_item_logdup(zbx_vc_item_t *item, const zbx_log_value_t *log)
+{
+	zbx_log_value_t	*plog = NULL;
+
+	if (NULL == (plog = (zbx_log_value_t *)vc_item_malloc(item, sizeof(zbx_log_value_t))))
+		return NULL;
+
+	plog->timestamp = log->timestamp;
+	plog->logeventid = log->logeventid;
+	plog->severity = log->severity;
+
+	if (NULL != log->source)
+	{
+		if (NULL == (plog->source = vc_item_strdup(item, log->source)))
+			goto fail;
+	}
+	else
+		plog->source = NULL;
+
+	if (NULL == (plog->value = vc_item_strdup(item, log->value)))
+		goto fail;
+
+	return plog;
+fail:
+	vc_item_strfree(plog->source);
+
+	vc_mem_free_func(plog);
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes log resource from cache memory                            *
+ *                                                                            *
+ * Parameters: str   - [IN] the log to remove                                 *
+ *                                                                            *
+ * Return value: the number of bytes freed                                    *
+ *                                                                            *
+ * Comments: Note - only logs created with vc_item_logdup() function must     *
+ *           be freed with vc_item_logfree().                                 *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_item_logfree(zbx_log_value_t *log)
+{
+	size_t	freed = 0;
+
+	if (NULL != log)
+	{
+		freed += vc_item_strfree(log->source);
+		freed += vc_item_strfree(log->value);
+
+		vc_mem_free_func(log);
+		freed += sizeof(zbx_log_value_t);
+	}
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees cache resources of the specified item value range           *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *             values  - [IN] the target value array                          *
+ *             first   - [IN] the first value to free                         *
+ *             last    - [IN] the last value to free                          *
+ *                                                                            *
+ * Return value: the number of bytes freed                                    *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *values, int first, int last)
+{
+	size_t	freed = 0;
+	int 	i;
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			for (i = first; i <= last; i++)
+				freed += vc_item_strfree(values[i].value.str);
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			for (i = first; i <= last; i++)
+				freed += vc_item_logfree(values[i].value.log);
+			break;
+		case ITEM_VALUE_TYPE_UINT64:
+		case ITEM_VALUE_TYPE_FLOAT:
+			break;
+		case ITEM_VALUE_TYPE_JSON:
+		case ITEM_VALUE_TYPE_BIN:
+		case ITEM_VALUE_TYPE_NONE:
+		default:
+			THIS_SHOULD_NEVER_HAPPEN;
+			zbx_exit(EXIT_FAILURE);
+	}
+
+	item->values_total -= (last - first + 1);
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item from cache and frees resources allocated for it      *
+ *                                                                            *
+ * Parameters: item    - [IN] the item                                        *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_remove_item(zbx_vc_item_t *item)
+{
+	vch_item_free_cache(item);
+	zbx_hashset_remove_direct(&vc_cache->items, item);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item from cache and frees resources allocated for it      *
+ *                                                                            *
+ * Parameters: itemid - [IN] the item identifier                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_remove_item_by_id(zbx_uint64_t itemid)
+{
+	zbx_vc_item_t	*item;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+		return;
+
+	vch_item_free_cache(item);
+	zbx_hashset_remove_direct(&vc_cache->items, item);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes items from cache and frees resources allocated for them   *
+ *                                                                            *
+ * Parameters: itemids - [IN] the item identifiers                            *
+ *                                                                            *
+ * Comments: If unused items are not cleared from value cache periodically    *
+ *           then they will only be cleared when value cache is full, see     *
+ *           vc_release_space(). Cleared items can be cached again.           *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_remove_items_by_ids(zbx_vector_uint64_t *itemids)
+{
+	int	i;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		return;
+
+	if (0 == itemids->values_num)
+		return;
+
+	WRLOCK_CACHE;
+
+	for (i = 0; i < itemids->values_num; i++)
+		vc_remove_item_by_id(itemids->values[i]);
+
+	UNLOCK_CACHE;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates the timestamp from which the item is being cached         *
+ *                                                                            *
+ * Parameters: item      - [IN] the item                                      *
+ *             timestamp - [IN] the timestamp from which all item values are  *
+ *                              guaranteed to be cached                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
+{
+	if (0 == item->db_cached_from || timestamp < item->db_cached_from)
+		item->db_cached_from = timestamp;
+}
+
+/******************************************************************************************************************
+ *                                                                                                                *
+ * History storage API                                                                                            *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+/*
+ * The value cache caches all values from the largest request range to
+ * the current time. The history data are stored in variable size chunks
+ * as illustrated in the following diagram:
+ *
+ *  .----------------.
+ *  | zbx_vc_cache_t |
+ *  |----------------|      .---------------.
+ *  | items          |----->| zbx_vc_item_t |-.
+ *  '----------------'      |---------------| |-.
+ *  .-----------------------| tail          | | |
+ *  |                   .---| head          | | |
+ *  |                   |   '---------------' | |
+ *  |                   |     '---------------' |
+ *  |                   |       '---------------'
+ *  |                   |
+ *  |                   '-------------------------------------------------.
+ *  |                                                                     |
+ *  |  .----------------.                                                 |
+ *  '->| zbx_vc_chunk_t |<-.                                              |
+ *     |----------------|  |  .----------------.                          |
+ *     | next           |---->| zbx_vc_chunk_t |<-.                       |
+ *     | prev           |  |  |----------------|  |  .----------------.   |
+ *     '----------------'  |  | next           |---->| zbx_vc_chunk_t |<--'
+ *                         '--| prev           |  |  |----------------|
+ *                            '----------------'  |  | next           |
+ *                                                '--| prev           |
+ *                                                   '----------------'
+ *
+ * The history values are stored in a double linked list of data chunks, holding
+ * variable number of records (depending on largest request size).
+ *
+ * After adding a new chunk, the older chunks (outside the largest request
+ * range) are automatically removed from cache.
+ */
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates item range with current request range                     *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             range  - [IN] the request range                                *
+ *             now    - [IN] the current timestamp                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
+{
+	int		diff, last_value_timestamp;
+	unsigned char	hour;
+
+	if (VC_MIN_RANGE > range)
+		range = VC_MIN_RANGE;
+
+	if (item->daily_range < range)
+		item->daily_range = range;
+
+	hour = (unsigned char)((now / SEC_PER_HOUR) & 0xff);
+
+	if (0 > (diff = hour - item->range_sync_hour))
+		diff += 0xff;
+
+	if (NULL != item->head)
+		last_value_timestamp = vch_chunk_last(item->head)->timestamp.sec;
+	else
+		last_value_timestamp = now;
+
+	if (item->active_range < item->daily_range || (ZBX_VC_RANGE_SYNC_PERIOD < diff &&
+			(now - last_value_timestamp) / SEC_PER_HOUR < ZBX_VC_RANGE_SYNC_PERIOD))
+	{
+		item->active_range = item->daily_range;
+		item->daily_range = range;
+		item->range_sync_hour = hour;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates optimal number of slots for an item data chunk         *
+ *                                                                            *
+ * Parameters:  item        - [IN] the item                                   *
+ *              values_new  - [IN] the number of values to be added           *
+ *                                                                            *
+ * Return value: the number of slots for a new item data chunk                *
+ *                                                                            *
+ * Comments: From size perspective the optimal slot count per chunk is        *
+ *           approximately square root of the number of cached values.        *
+ *           Still creating too many chunks might affect timeshift request    *
+ *           performance, so don't try creating more than 32 chunks unless    *
+ *           the calculated slot count exceeds the maximum limit.             *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
+{
+	int	nslots, values;
+
+	values = item->values_total + values_new;
+
+	nslots = (int)zbx_isqrt32((unsigned int)values);
+
+	if ((values + nslots - 1) / nslots + 1 > 32)
+		nslots = values / 32;
+
+	if (nslots > (int)ZBX_VC_MAX_CHUNK_RECORDS)
+		nslots = ZBX_VC_MAX_CHUNK_RECORDS;
+	if (nslots < (int)ZBX_VC_MIN_CHUNK_RECORDS)
+		nslots = ZBX_VC_MIN_CHUNK_RECORDS;
+
+	return nslots;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds a new data chunk at the end of item's history data list      *
+ *                                                                            *
+ * Parameters: item          - [IN/OUT] the item to add chunk to              *
+ *             nslots        - [IN] the number of slots in the new chunk      *
+ *             insert_before - [IN] the target chunk before which the new     *
+ *                             chunk must be inserted. If this value is NULL  *
+ *                             then the new chunk is appended at the end of   *
+ *                             chunk list (making it the newest chunk).       *
+ *                                                                            *
+ * Return value:  SUCCEED - the chunk was added successfully                  *
+ *                FAIL - failed to create a new chunk (not enough memory)     *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *insert_before)
+{
+	zbx_vc_chunk_t	*chunk;
+	size_t		chunk_size;
+
+	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+
+	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
+		return FAIL;
+
+	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
+	chunk->slots_num = nslots;
+
+	chunk->next = insert_before;
+	chunk->prev = (NULL == insert_before ? item->head : insert_before->prev);
+
+#if defined(ZBX_VC_LOCKFREE)
+	/* lock-free readers follow the prev links, chunk must be initialized before linking */
+	atomic_thread_fence(memory_order_release);
+#endif
+
+	if (NULL == insert_before)
+	{
+		if (NULL != item->head)
+			item->head->next = chunk;
+		else
+			item->tail = chunk;
+
+		item->head = chunk;
+	}
+	else
+	{
+		insert_before->prev = chunk;
+
+		if (item->tail == insert_before)
+			item->tail = chunk;
+		else
+			chunk->prev->next = chunk;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find the index of the last value in chunk with timestamp less or  *
+ *          equal to the specified timestamp.                                 *
+ *                                                                            *
+ * Parameters:  item  - [IN] the chunk owner item                             *
+ *              chunk - [IN] the chunk                                        *
+ *              ts    - [IN] the target timestamp                             *
+ *                                                                            *
+ * Return value: The index of the last value in chunk with timestamp less or  *
+ *               equal to the specified timestamp.                            *
+ *               -1 is returned in the case of failure (meaning that all      *
+ *               values have timestamps greater than the target timestamp).   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_chunk_find_last_value_before(const zbx_vc_item_t *item, const zbx_vc_chunk_t *chunk,
+		const zbx_timespec_t *ts)
+{
+	int				start = chunk->first_value, end = chunk->last_value, middle;
+	const zbx_history_record_t	*slots;
+
+	/* check if the last value timestamp is already greater or equal to the specified timestamp */
+	if (0 >= zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, ts))
+		return end;
+
+	/* chunk contains only one value, which did not pass the above check, return failure */
+	if (start == end)
+		return -1;
+
+	slots = vch_chunk_slots(item, chunk);
+
+	/* perform value lookup using binary search */
+	while (start != end)
+	{
+		middle = start + (end - start) / 2;
+
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
+		{
+			end = middle;
+			continue;
+		}
+
+		if (0 >= zbx_timespec_compare(&slots[middle + 1].timestamp, ts))
+		{
+			start = middle;
+			continue;
+		}
+
+		return middle;
+	}
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets the chunk and index of the last value with a timestamp less  *
+ *          or equal to the specified timestamp                               *
+ *                                                                            *
+ * Parameters:  item          - [IN] the item                                 *
+ *              ts            - [IN] the target timestamp                     *
+ *                                   (NULL - current time)                    *
+ *              pchunk        - [OUT] the chunk containing the target value   *
+ *              pindex        - [OUT] the index of the target value           *
+ *                                                                            *
+ * Return value: SUCCEED - the last value was found successfully              *
+ *               FAIL - all values in cache have timestamps greater than the  *
+ *                      target (timeshift) timestamp.                         *
+ *                                                                            *
+ * Comments: If end_timestamp value is 0, then simply the last item value in  *
+ *           cache is returned.                                               *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
+		int *pindex)
+{
+	zbx_vc_chunk_t	*chunk = item->head;
+	int		index;
+
+	if (NULL == chunk)
+		return FAIL;
+
+	index = chunk->last_value;
+
+	if (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, ts))
+	{
+		while (0 < zbx_timespec_compare(&vch_chunk_slots(item, chunk)[chunk->first_value].timestamp, ts))
+		{
+			chunk = chunk->prev;
+			/* there are no values for requested range, return failure */
+			if (NULL == chunk)
+				return FAIL;
+		}
+		index = vch_chunk_find_last_value_before(item, chunk, ts);
+	}
+
+	*pchunk = chunk;
+	*pindex = index;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies value in the specified item's chunk slot                   *
+ *                                                                            *
+ * Parameters: chunk        - [IN/OUT] the target chunk                       *
+ *             index        - [IN] the target slot                            *
+ *             source_value - [IN] the value to copy                          *
+ *                                                                            *
+ * Return value: SUCCEED - the value was copied successfully                  *
+ *               FAIL    - the value copying failed (not enough space for     *
+ *                         string, text or log type data)                     *
+ *                                                                            *
+ * Comments: This function is used to copy data to cache. The contents of     *
+ *           str, text and log type values are stored in cache string pool.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int index,
+		const zbx_history_record_t *source_value)
+{
+	zbx_history_record_t	*value;
+	int			ret = FAIL;
+
+	value = &chunk->slots[index];
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
+				goto out;
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
+				goto out;
+			break;
+		default:
+			value->value = source_value->value;
+	}
+	value->timestamp = source_value->timestamp;
+
+	ret = SUCCEED;
+out:
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies values at the beginning of item tail chunk                 *
+ *                                                                            *
+ * Parameters: item       - [IN/OUT] the target item                          *
+ *             values     - [IN] the values to copy                           *
+ *             values_num - [IN] the number of values to copy                 *
+ *                                                                            *
+ * Return value: SUCCEED - the values were copied successfully                *
+ *               FAIL    - the value copying failed (not enough space for     *
+ *                         string, text or log type data)                     *
+ *                                                                            *
+ * Comments: This function is used to copy data to cache. The contents of     *
+ *           str, text and log type values are stored in cache string pool.   *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+{
+	int	i, ret = FAIL, first_value = item->tail->first_value;
+
+	switch (item->value_type)
+	{
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			for (i = values_num - 1; i >= 0; i--)
+			{
+				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+
+				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
+					goto out;
+
+				value->timestamp = values[i].timestamp;
+				item->tail->first_value--;
+			}
+			ret = SUCCEED;
+
+			break;
+		case ITEM_VALUE_TYPE_LOG:
+			for (i = values_num - 1; i >= 0; i--)
+			{
+				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+
+				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
+					goto out;
+
+				value->timestamp = values[i].timestamp;
+				item->tail->first_value--;
+			}
+			ret = SUCCEED;
+
+			break;
+		default:
+			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
+					(size_t)values_num * sizeof(zbx_history_record_t));
+			item->tail->first_value -= values_num;
+			ret = SUCCEED;
+	}
+out:
+	item->values_total += first_value - item->tail->first_value;
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees chunk and all resources allocated to store its values       *
+ *                                                                            *
+ * Parameters: item    - [IN] the chunk owner item                            *
+ *             chunk   - [IN] the chunk to free                               *
+ *                                                                            *
+ * Return value: the number of bytes freed                                    *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	size_t	freed;
+
+	freed = vch_chunk_size(chunk);
+	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+
+	vc_mem_free_func(chunk);
+
+	return freed;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data chunk                                   *
+ *                                                                            *
+ * Parameters: item    - [IN ] the chunk owner item                           *
+ *             chunk   - [IN] the chunk to remove                             *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	if (NULL != chunk->next)
+		chunk->next->prev = chunk->prev;
+
+	if (NULL != chunk->prev)
+		chunk->prev->next = chunk->next;
+
+	if (chunk == item->head)
+		item->head = chunk->prev;
+
+	if (chunk == item->tail)
+		item->tail = chunk->next;
+
+	vch_item_free_chunk(item, chunk);
+}
+
+/******************************************************************************
  *                                                                            *
- * Return value: the number of bytes freed                                    *
+ * Purpose: replaces item history data chunk with another chunk containing   *
+ *          the same values                                                   *
+ *                                                                            *
+ * Parameters: item      - [IN] the chunk owner item                          *
+ *             chunk     - [IN] the chunk to replace                          *
+ *             new_chunk - [IN] the new chunk                                 *
  *                                                                            *
  ******************************************************************************/
-static size_t	vc_item_free_values(zbx_vc_item_t *item, zbx_history_record_t *values, int first, int last)
+static void	vch_item_replace_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, zbx_vc_chunk_t *new_chunk)
 {
-	size_t	freed = 0;
-	int 	i;
+#if defined(ZBX_VC_LOCKFREE)
+	/* lock-free readers follow the prev links, chunk must be initialized before linking */
+	atomic_thread_fence(memory_order_release);
+#endif
+	if (NULL != chunk->next)
+		chunk->next->prev = new_chunk;
+	else
+		item->head = new_chunk;
 
-	switch (item->value_type)
+	if (NULL != chunk->prev)
+		chunk->prev->next = new_chunk;
+	else
+		item->tail = new_chunk;
+
+	vc_mem_free_func(chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: packs filled item history data chunk                              *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk to pack                                 *
+ *                                                                            *
+ * Comments: Only float and unsigned values are packed. The head chunk is     *
+ *           never packed as new values are added to it. The chunk is left    *
+ *           unpacked if packing does not reduce its size or there is not     *
+ *           enough memory for the packed chunk.                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_pack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*packed;
+	unsigned char	*data;
+	int		values_num;
+	size_t		chunk_size, packed_size;
+
+	if (0 == vc_cache->compression || chunk == item->head || 0 != chunk->packed_size)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
+		return;
+
+	if (ZBX_VC_PACK_MIN_RECORDS > (values_num = chunk->last_value - chunk->first_value + 1))
+		return;
+
+	chunk_size = vch_chunk_size(chunk);
+	data = (unsigned char *)zbx_malloc(NULL, chunk_size);
+
+	packed_size = zbx_vc_codec_encode(&chunk->slots[chunk->first_value], values_num, item->value_type, data,
+			chunk_size);
+
+	if (0 == packed_size || sizeof(zbx_vc_chunk_t) + packed_size >= chunk_size)
+		goto out;
+
+	if (NULL == (packed = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, sizeof(zbx_vc_chunk_t) + packed_size)))
+		goto out;
+
+	packed->prev = chunk->prev;
+	packed->next = chunk->next;
+	packed->first_value = 0;
+	packed->last_value = values_num - 1;
+	packed->slots_num = values_num;
+	packed->packed_size = (int)packed_size;
+	packed->packed_id = ++vc_cache->last_packed_id;
+	packed->slots[0] = chunk->slots[chunk->last_value];
+	memcpy(&packed->slots[1], data, packed_size);
+
+	vch_item_replace_chunk(item, chunk, packed);
+out:
+	zbx_free(data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unpacks item history data chunk so its values can be modified     *
+ *                                                                            *
+ * Parameters: item  - [IN] the chunk owner item                              *
+ *             chunk - [IN] the chunk to unpack                               *
+ *                                                                            *
+ * Return value: the unpacked chunk or NULL if there is not enough memory     *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vc_chunk_t	*vch_item_unpack_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+{
+	zbx_vc_chunk_t	*unpacked;
+
+	if (0 == chunk->packed_size)
+		return chunk;
+
+	if (NULL == (unpacked = (zbx_vc_chunk_t *)__vc_shmem_malloc_func(NULL, sizeof(zbx_vc_chunk_t) +
+			(size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t))))
 	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			for (i = first; i <= last; i++)
-				freed += vc_item_strfree(values[i].value.str);
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			for (i = first; i <= last; i++)
-				freed += vc_item_logfree(values[i].value.log);
-			break;
-		case ITEM_VALUE_TYPE_UINT64:
-		case ITEM_VALUE_TYPE_FLOAT:
+		return NULL;
+	}
+
+	memcpy(unpacked, chunk, offsetof(zbx_vc_chunk_t, slots));
+	unpacked->packed_size = 0;
+	unpacked->packed_id = 0;
+	memcpy(unpacked->slots, vch_chunk_slots(item, chunk), (size_t)chunk->slots_num * sizeof(zbx_history_record_t));
+
+	vch_item_replace_chunk(item, chunk, unpacked);
+
+	return unpacked;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data that are outside (older) the maximum    *
+ *          request range                                                     *
+ *                                                                            *
+ * Parameters:  item      - [IN] the target item                              *
+ *              timestamp - [IN] last timestamp in active range               *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
+{
+	zbx_vc_chunk_t	*next;
+
+	if (0 != item->active_range)
+	{
+		zbx_vc_chunk_t	*tail = item->tail;
+		zbx_vc_chunk_t	*chunk = tail;
+
+		timestamp -= item->active_range;
+
+		/* Try to remove chunks with all history values older than maximum request range, maximum */
+		/* request range should be calculated from last received value with which active range    */
+		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
+		while (NULL != chunk && vch_chunk_last(chunk)->timestamp.sec < timestamp &&
+				vch_chunk_last(chunk)->timestamp.sec != vch_chunk_last(item->head)->timestamp.sec)
+		{
+			/* don't remove the head chunk */
+			if (NULL == (next = chunk->next))
+				break;
+
+			/* Values with the same timestamps (seconds resolution) always should be either   */
+			/* kept in cache or removed together. There should not be a case when one of them */
+			/* is in cache and the second is dropped.                                         */
+			/* Here we are handling rare case, when the last value of first chunk has the     */
+			/* same timestamp (seconds resolution) as the first value in the second chunk.    */
+			/* In this case increase the first value index of the next chunk until the first  */
+			/* value timestamp is greater.                                                    */
+
+			if (vch_chunk_slots(item, next)[next->first_value].timestamp.sec !=
+					vch_chunk_last(next)->timestamp.sec)
+			{
+				while (vch_chunk_slots(item, next)[next->first_value].timestamp.sec ==
+						vch_chunk_last(chunk)->timestamp.sec)
+				{
+					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
+					next->first_value++;
+				}
+			}
+
+			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
+			item->db_cached_from = vch_chunk_last(chunk)->timestamp.sec + 1;
+
+			vch_item_remove_chunk(item, chunk);
+
+			chunk = next;
+		}
+
+		/* reset the status flags if data was removed from cache */
+		if (tail != item->tail)
+			item->status = 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes item history data that are older than the specified       *
+ *          timestamp                                                         *
+ *                                                                            *
+ * Parameters:  item      - [IN] the target item                              *
+ *              timestamp - [IN] the timestamp (number of seconds since the   *
+ *                               Epoch)                                       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
+{
+	zbx_vc_chunk_t	*chunk = item->tail;
+
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		item->status = 0;
+
+	/* try to remove chunks with all history values older than the timestamp */
+	while (NULL != chunk && vch_chunk_slots(item, chunk)[chunk->first_value].timestamp.sec < timestamp)
+	{
+		zbx_vc_chunk_t	*next;
+
+		/* If chunk contains values with timestamp greater or equal - remove */
+		/* only the values with less timestamp. Otherwise remove the while   */
+		/* chunk and check next one.                                         */
+		if (vch_chunk_last(chunk)->timestamp.sec >= timestamp)
+		{
+			while (vch_chunk_slots(item, chunk)[chunk->first_value].timestamp.sec < timestamp)
+			{
+				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
+				chunk->first_value++;
+			}
+
 			break;
-		case ITEM_VALUE_TYPE_JSON:
-		case ITEM_VALUE_TYPE_BIN:
-		case ITEM_VALUE_TYPE_NONE:
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-			zbx_exit(EXIT_FAILURE);
+		}
+
+		next = chunk->next;
+		vch_item_remove_chunk(item, chunk);
+		chunk = next;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds one item history value at the end of current item's history  *
+ *          data                                                              *
+ *                                                                            *
+ * Parameters:  item   - [IN] the item to add history data to                 *
+ *              value  - [IN] the item history data value                     *
+ *                                                                            *
+ * Return value: SUCCEED - the history data value was added successfully      *
+ *               FAIL - failed to add history data value (not enough memory)  *
+ *                                                                            *
+ * Comments: In the case of failure the item will be removed from cache       *
+ *           later.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
+{
+	int		ret = FAIL, index, sindex, nslots = 0;
+	zbx_vc_chunk_t	*chunk, *schunk, *unpacked = NULL;
+
+	if (NULL != item->head && 0 < zbx_history_record_compare_asc(vch_chunk_last(item->head), value))
+	{
+		if (0 < zbx_history_record_compare_asc(&vch_chunk_slots(item, item->tail)[item->tail->first_value],
+				value))
+		{
+			/* If the added value has the same or older timestamp as the first value in cache */
+			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
+			/* values with matching timestamp seconds are kept in cache.                      */
+			vch_item_remove_values(item, value->timestamp.sec + 1);
+
+			/* empty items must be removed to avoid situation when a new value is added to cache */
+			/* while other values with matching timestamp seconds are not cached                 */
+			if (NULL == item->head)
+				goto out;
+
+			/* if the value is newer than the database cached from timestamp we must */
+			/* adjust the cached from timestamp to exclude this value                */
+			if (item->db_cached_from <= value->timestamp.sec)
+				item->db_cached_from = value->timestamp.sec + 1;
+
+			ret = SUCCEED;
+			goto out;
+		}
+
+		/* values newer than the added value are shifted, so their chunks must be unpacked */
+		for (chunk = item->head->prev; NULL != chunk && 0 < zbx_history_record_compare_asc(
+				vch_chunk_last(chunk), value); chunk = chunk->prev)
+		{
+			if (0 != chunk->packed_size && NULL == (unpacked = chunk = vch_item_unpack_chunk(item, chunk)))
+				goto out;
+		}
+
+		sindex = item->head->last_value;
+		schunk = item->head;
+
+		if (0 == item->head->slots_num - item->head->last_value - 1)
+		{
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
+				goto out;
+		}
+		else
+			item->head->last_value++;
+
+		item->values_total++;
+
+		chunk = item->head;
+		index = item->head->last_value;
+
+		do
+		{
+			chunk->slots[index] = schunk->slots[sindex];
+
+			chunk = schunk;
+			index = sindex;
+
+			if (--sindex < schunk->first_value)
+			{
+				if (NULL == (schunk = schunk->prev))
+				{
+					memset(&chunk->slots[index], 0, sizeof(zbx_vc_chunk_t));
+					THIS_SHOULD_NEVER_HAPPEN;
+
+					goto out;
+				}
+
+				sindex = schunk->last_value;
+			}
+		}
+		while (0 < zbx_timespec_compare(&vch_chunk_slots(item, schunk)[sindex].timestamp, &value->timestamp));
 	}
+	else
+	{
+		/* find the number of free slots on the right side in last (head) chunk */
+		if (NULL != item->head)
+			nslots = item->head->slots_num - item->head->last_value - 1;
+
+		if (0 == nslots)
+		{
+			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
+				goto out;
+		}
+		else
+			item->head->last_value++;
 
-	item->values_total -= (last - first + 1);
+		item->values_total++;
 
-	return freed;
-}
+		chunk = item->head;
+		index = item->head->last_value;
+	}
 
-/******************************************************************************
- *                                                                            *
- * Purpose: removes item from cache and frees resources allocated for it      *
- *                                                                            *
- * Parameters: item    - [IN] the item                                        *
- *                                                                            *
- ******************************************************************************/
-static void	vc_remove_item(zbx_vc_item_t *item)
-{
-	vch_item_free_cache(item);
-	zbx_hashset_remove_direct(&vc_cache->items, item);
-}
+	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
+		goto out;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: removes item from cache and frees resources allocated for it      *
- *                                                                            *
- * Parameters: itemid - [IN] the item identifier                              *
- *                                                                            *
- ******************************************************************************/
-static void	vc_remove_item_by_id(zbx_uint64_t itemid)
-{
-	zbx_vc_item_t	*item;
+	/* pack the chunks unpacked to insert the value */
+	for (chunk = unpacked; NULL != chunk && chunk != item->head; chunk = schunk)
+	{
+		schunk = chunk->next;
+		vch_item_pack_chunk(item, chunk);
+	}
 
-	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
-		return;
+	/* pack the previous head chunk when new head chunk is added */
+	if (NULL != item->head->prev && item->head->first_value == item->head->last_value)
+		vch_item_pack_chunk(item, item->head->prev);
 
-	vch_item_free_cache(item);
-	zbx_hashset_remove_direct(&vc_cache->items, item);
+	ret = SUCCEED;
+out:
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes items from cache and frees resources allocated for them   *
+ * Purpose: adds item history values at the beginning of current item's       *
+ *          history data                                                      *
  *                                                                            *
- * Parameters: itemids - [IN] the item identifiers                            *
+ * Parameters:  item   - [IN] the item to add history data to                 *
+ *              values - [IN] the item history data values                    *
+ *              num    - [IN] the number of history data values to add        *
  *                                                                            *
- * Comments: If unused items are not cleared from value cache periodically    *
- *           then they will only be cleared when value cache is full, see     *
- *           vc_release_space(). Cleared items can be cached again.           *
+ * Return value: SUCCEED - the history data values were added successfully    *
+ *               FAIL - failed to add history data values (not enough memory) *
+ *                                                                            *
+ * Comments: In the case of failure the item is removed from cache.           *
+ *           Overlapping values (by timestamp seconds) are ignored.           *
  *                                                                            *
  ******************************************************************************/
-void	zbx_vc_remove_items_by_ids(zbx_vector_uint64_t *itemids)
+static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
 {
-	int	i;
-
-	if (ZBX_VC_DISABLED == vc_state)
-		return;
-
-	if (0 == itemids->values_num)
-		return;
-
-	WRLOCK_CACHE;
+	int 		count = values_num, ret = FAIL;
+	zbx_vc_chunk_t	*chunk, *next;
 
-	for (i = 0; i < itemids->values_num; i++)
-		vc_remove_item_by_id(itemids->values[i]);
-
-	UNLOCK_CACHE;
-}
+	/* skip values already added to the item cache by another process */
+	if (NULL != item->tail)
+	{
+		int	sec = vch_chunk_slots(item, item->tail)[item->tail->first_value].timestamp.sec;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: updates the timestamp from which the item is being cached         *
- *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             timestamp - [IN] the timestamp from which all item values are  *
- *                              guaranteed to be cached                       *
- *                                                                            *
- ******************************************************************************/
-static void	vc_item_update_db_cached_from(zbx_vc_item_t *item, int timestamp)
-{
-	if (0 == item->db_cached_from || timestamp < item->db_cached_from)
-		item->db_cached_from = timestamp;
-}
+		while (--count >= 0 && values[count].timestamp.sec >= sec)
+			;
+		++count;
+	}
 
-/******************************************************************************************************************
- *                                                                                                                *
- * History storage API                                                                                            *
- *                                                                                                                *
- ******************************************************************************************************************/
-/*
- * The value cache caches all values from the largest request range to
- * the current time. The history data are stored in variable size chunks
- * as illustrated in the following diagram:
- *
- *  .----------------.
- *  | zbx_vc_cache_t |
- *  |----------------|      .---------------.
- *  | items          |----->| zbx_vc_item_t |-.
- *  '----------------'      |---------------| |-.
- *  .-----------------------| tail          | | |
- *  |                   .---| head          | | |
- *  |                   |   '---------------' | |
- *  |                   |     '---------------' |
- *  |                   |       '---------------'
- *  |                   |
- *  |                   '-------------------------------------------------.
- *  |                                                                     |
- *  |  .----------------.                                                 |
- *  '->| zbx_vc_chunk_t |<-.                                              |
- *     |----------------|  |  .----------------.                          |
- *     | next           |---->| zbx_vc_chunk_t |<-.                       |
- *     | prev           |  |  |----------------|  |  .----------------.   |
- *     '----------------'  |  | next           |---->| zbx_vc_chunk_t |<--'
- *                         '--| prev           |  |  |----------------|
- *                            '----------------'  |  | next           |
- *                                                '--| prev           |
- *                                                   '----------------'
- *
- * The history values are stored in a double linked list of data chunks, holding
- * variable number of records (depending on largest request size).
- *
- * After adding a new chunk, the older chunks (outside the largest request
- * range) are automatically removed from cache.
- */
+	while (0 != count)
+	{
+		int	copy_slots, nslots = 0;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: updates item range with current request range                     *
- *                                                                            *
- * Parameters: item   - [IN] the item                                         *
- *             range  - [IN] the request range                                *
- *             now    - [IN] the current timestamp                            *
- *                                                                            *
- ******************************************************************************/
-static void	vch_item_update_range(zbx_vc_item_t *item, int range, int now)
-{
-	int		diff, last_value_timestamp;
-	unsigned char	hour;
+		/* find the number of free slots on the left side in first (tail) chunk, packed chunks can't be modified */
+		if (NULL != item->tail && 0 == item->tail->packed_size)
+			nslots = item->tail->first_value;
 
-	if (VC_MIN_RANGE > range)
-		range = VC_MIN_RANGE;
+		if (0 == nslots)
+		{
+			nslots = vch_item_chunk_slot_count(item, count);
 
-	if (item->daily_range < range)
-		item->daily_range = range;
+			if (FAIL == vch_item_add_chunk(item, nslots, item->tail))
+				goto out;
 
-	hour = (unsigned char)((now / SEC_PER_HOUR) & 0xff);
+			item->tail->last_value = nslots - 1;
+			item->tail->first_value = nslots;
+		}
 
-	if (0 > (diff = hour - item->range_sync_hour))
-		diff += 0xff;
+		/* copy values to chunk */
+		copy_slots = MIN(nslots, count);
+		count -= copy_slots;
 
-	if (NULL != item->head)
-		last_value_timestamp = item->head->slots[item->head->last_value].timestamp.sec;
-	else
-		last_value_timestamp = now;
+		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
+			goto out;
+	}
 
-	if (item->active_range < item->daily_range || (ZBX_VC_RANGE_SYNC_PERIOD < diff &&
-			(now - last_value_timestamp) / SEC_PER_HOUR < ZBX_VC_RANGE_SYNC_PERIOD))
+	/* pack the filled chunks, the head chunk is packed when the next head chunk is added */
+	for (chunk = item->tail; NULL != chunk && chunk != item->head; chunk = next)
 	{
-		item->active_range = item->daily_range;
-		item->daily_range = range;
-		item->range_sync_hour = hour;
+		next = chunk->next;
+		vch_item_pack_chunk(item, chunk);
 	}
+
+	ret = SUCCEED;
+out:
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: calculates optimal number of slots for an item data chunk         *
+ * Purpose: cache item history data for the specified time period             *
  *                                                                            *
- * Parameters:  item        - [IN] the item                                   *
- *              values_new  - [IN] the number of values to be added           *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
  *                                                                            *
- * Return value: the number of slots for a new item data chunk                *
+ * Return value:  >=0    - the number of values read from database            *
+ *                FAIL   - an error occurred while trying to cache values     *
  *                                                                            *
- * Comments: From size perspective the optimal slot count per chunk is        *
- *           approximately square root of the number of cached values.        *
- *           Still creating too many chunks might affect timeshift request    *
- *           performance, so don't try creating more than 32 chunks unless    *
- *           the calculated slot count exceeds the maximum limit.             *
+ * Comments: This function checks if the requested value range is cached and  *
+ *           updates cache from database if necessary.                        *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_chunk_slot_count(zbx_vc_item_t *item, int values_new)
+static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
 {
-	int	nslots, values;
-
-	values = item->values_total + values_new;
+	int				ret, range_end;
+	zbx_vector_history_record_t	records;
+	zbx_uint64_t			itemid;
+	unsigned char			value_type;
 
-	nslots = (int)zbx_isqrt32((unsigned int)values);
+	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
+		return SUCCEED;
 
-	if ((values + nslots - 1) / nslots + 1 > 32)
-		nslots = values / 32;
+	/* check if the requested period is in the cached range */
+	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
+		return SUCCEED;
 
-	if (nslots > (int)ZBX_VC_MAX_CHUNK_RECORDS)
-		nslots = ZBX_VC_MAX_CHUNK_RECORDS;
-	if (nslots < (int)ZBX_VC_MIN_CHUNK_RECORDS)
-		nslots = ZBX_VC_MIN_CHUNK_RECORDS;
+	/* find if the cache should be updated to cover the required range */
+	if (NULL != (*item)->tail)
+	{
+		/* we need to get item values before the first cached value, but not including it */
+		range_end = vch_chunk_slots(*item, (*item)->tail)[(*item)->tail->first_value].timestamp.sec - 1;
+	}
+	else
+		range_end = ZBX_JAN_2038;
 
-	return nslots;
-}
+	/* update cache if necessary */
+	if (range_start >= range_end)
+		return SUCCEED;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: adds a new data chunk at the end of item's history data list      *
- *                                                                            *
- * Parameters: item          - [IN/OUT] the item to add chunk to              *
- *             nslots        - [IN] the number of slots in the new chunk      *
- *             insert_before - [IN] the target chunk before which the new     *
- *                             chunk must be inserted. If this value is NULL  *
- *                             then the new chunk is appended at the end of   *
- *                             chunk list (making it the newest chunk).       *
- *                                                                            *
- * Return value:  SUCCEED - the chunk was added successfully                  *
- *                FAIL - failed to create a new chunk (not enough memory)     *
- *                                                                            *
- ******************************************************************************/
-static int	vch_item_add_chunk(zbx_vc_item_t *item, int nslots, zbx_vc_chunk_t *insert_before)
-{
-	zbx_vc_chunk_t	*chunk;
-	size_t		chunk_size;
+	zbx_vector_history_record_create(&records);
+	itemid = (*item)->itemid;
+	value_type = (*item)->value_type;
 
-	chunk_size =sizeof(zbx_vc_chunk_t) + sizeof(zbx_history_record_t) * (size_t)(nslots - 1);
+	UNLOCK_CACHE;
 
-	if (NULL == (chunk = (zbx_vc_chunk_t *)vc_item_malloc(item, chunk_size)))
-		return FAIL;
+	if (SUCCEED == (ret = vc_db_read_values_by_time(itemid, value_type, &records, range_start, range_end)))
+		zbx_vector_history_record_sort(&records, zbx_history_record_compare_asc);
 
-	memset(chunk, 0, sizeof(zbx_vc_chunk_t));
-	chunk->slots_num = nslots;
+	WRLOCK_CACHE;
 
-	chunk->next = insert_before;
+	if (SUCCEED != ret)
+		goto out;
 
-	if (NULL == insert_before)
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
-		chunk->prev = item->head;
-
-		if (NULL != item->head)
-			item->head->next = chunk;
-		else
-			item->tail = chunk;
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
 
-		item->head = chunk;
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
+				sizeof(new_item))))
+		{
+			ret = FAIL;
+			goto out;
+		}
 	}
-	else
-	{
-		chunk->prev = insert_before->prev;
-		insert_before->prev = chunk;
 
-		if (item->tail == insert_before)
-			item->tail = chunk;
-		else
-			chunk->prev->next = chunk;
+	/* when updating cache with time based request we can always reset status flags */
+	/* flag even if the requested period contains no data                           */
+	(*item)->status = 0;
+
+	if (0 < records.values_num)
+	{
+		if (SUCCEED != (ret = vch_item_add_values_at_tail(*item, records.values, records.values_num)))
+			goto out;
 	}
 
-	return SUCCEED;
+	ret = records.values_num;
+	vc_item_update_db_cached_from(*item, range_start);
+out:
+	zbx_history_record_vector_destroy(&records, value_type);
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: find the index of the last value in chunk with timestamp less or  *
- *          equal to the specified timestamp.                                 *
+ * Purpose: cache the specified number of history data values for time period *
+ *          since timestamp                                                   *
  *                                                                            *
- * Parameters:  chunk - [IN] the chunk                                        *
- *              ts    - [IN] the target timestamp                             *
+ * Parameters: item        - [IN] the item                                    *
+ *             range_start - [IN] the interval start time                     *
+ *             count       - [IN] the number of history values to retrieve    *
+ *             ts          - [IN] the target timestamp                        *
  *                                                                            *
- * Return value: The index of the last value in chunk with timestamp less or  *
- *               equal to the specified timestamp.                            *
- *               -1 is returned in the case of failure (meaning that all      *
- *               values have timestamps greater than the target timestamp).   *
+ * Return value:  >=0    - the number of values read from database            *
+ *                FAIL   - an error occurred while trying to cache values     *
+ *                                                                            *
+ * Comments: This function checks if the requested number of values is cached *
+ *           and updates cache from database if necessary.                    *
  *                                                                            *
  ******************************************************************************/
-static int	vch_chunk_find_last_value_before(const zbx_vc_chunk_t *chunk, const zbx_timespec_t *ts)
+static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int range_start, int count,
+		const zbx_timespec_t *ts)
 {
-	int	start = chunk->first_value, end = chunk->last_value, middle;
+	int				ret = SUCCEED, cached_records = 0, range_end, records_offset;
+	zbx_vector_history_record_t	records;
+	zbx_uint64_t			itemid;
+	unsigned char			value_type;
 
-	/* check if the last value timestamp is already greater or equal to the specified timestamp */
-	if (0 >= zbx_timespec_compare(&chunk->slots[end].timestamp, ts))
-		return end;
+	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
+		return SUCCEED;
 
-	/* chunk contains only one value, which did not pass the above check, return failure */
-	if (start == end)
-		return -1;
+	/* check if the requested period is in the cached range */
+	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
+		return SUCCEED;
 
-	/* perform value lookup using binary search */
-	while (start != end)
+	/* find if the cache should be updated to cover the required count */
+	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
 	{
-		middle = start + (end - start) / 2;
+		zbx_vc_chunk_t	*chunk;
+		int		index;
 
-		if (0 < zbx_timespec_compare(&chunk->slots[middle].timestamp, ts))
+		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index))
 		{
-			end = middle;
-			continue;
-		}
+			cached_records = index - chunk->first_value + 1;
 
-		if (0 >= zbx_timespec_compare(&chunk->slots[middle + 1].timestamp, ts))
-		{
-			start = middle;
-			continue;
+			while (NULL != (chunk = chunk->prev) && cached_records < count)
+				cached_records += chunk->last_value - chunk->first_value + 1;
 		}
+	}
 
-		return middle;
+	/* update cache if necessary */
+	if (cached_records >= count)
+		return SUCCEED;
+
+	/* get the end timestamp to which (including) the values should be cached */
+	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
+		range_end = vch_chunk_slots(*item, (*item)->tail)[(*item)->tail->first_value].timestamp.sec - 1;
+	else
+		range_end = ZBX_JAN_2038;
+
+	itemid = (*item)->itemid;
+	value_type = (*item)->value_type;
+	UNLOCK_CACHE;
+
+	zbx_vector_history_record_create(&records);
+
+	if (range_end > ts->sec)
+	{
+		ret = vc_db_read_values_by_time(itemid, value_type, &records, ts->sec + 1, range_end);
+		range_end = ts->sec;
 	}
 
-	return -1;
-}
+	records_offset = records.values_num;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: gets the chunk and index of the last value with a timestamp less  *
- *          or equal to the specified timestamp                               *
- *                                                                            *
- * Parameters:  item          - [IN] the item                                 *
- *              ts            - [IN] the target timestamp                     *
- *                                   (NULL - current time)                    *
- *              pchunk        - [OUT] the chunk containing the target value   *
- *              pindex        - [OUT] the index of the target value           *
- *                                                                            *
- * Return value: SUCCEED - the last value was found successfully              *
- *               FAIL - all values in cache have timestamps greater than the  *
- *                      target (timeshift) timestamp.                         *
- *                                                                            *
- * Comments: If end_timestamp value is 0, then simply the last item value in  *
- *           cache is returned.                                               *
- *                                                                            *
- ******************************************************************************/
-static int	vch_item_get_last_value(const zbx_vc_item_t *item, const zbx_timespec_t *ts, zbx_vc_chunk_t **pchunk,
-		int *pindex)
-{
-	zbx_vc_chunk_t	*chunk = item->head;
-	int		index;
+	if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(itemid, value_type, &records,
+			range_start, count - cached_records, range_end, ts)))
+	{
+		zbx_vector_history_record_sort(&records, zbx_history_record_compare_asc);
+	}
 
-	if (NULL == chunk)
-		return FAIL;
+	WRLOCK_CACHE;
 
-	index = chunk->last_value;
+	if (SUCCEED != ret)
+		goto out;
 
-	if (0 < zbx_timespec_compare(&chunk->slots[index].timestamp, ts))
+	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
 	{
-		while (0 < zbx_timespec_compare(&chunk->slots[chunk->first_value].timestamp, ts))
+		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+
+		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
 		{
-			chunk = chunk->prev;
-			/* there are no values for requested range, return failure */
-			if (NULL == chunk)
-				return FAIL;
+			ret = FAIL;
+			goto out;
 		}
-		index = vch_chunk_find_last_value_before(chunk, ts);
 	}
 
-	*pchunk = chunk;
-	*pindex = index;
+	if (0 < records.values_num)
+		ret = vch_item_add_values_at_tail(*item, records.values, records.values_num);
 
-	return SUCCEED;
+	if (SUCCEED != ret)
+		goto out;
+
+	ret = records.values_num;
+
+	if (0 == range_start && count - cached_records > records.values_num - records_offset)
+	{
+		(*item)->active_range = 0;
+		(*item)->daily_range = 0;
+		(*item)->status = ZBX_ITEM_STATUS_CACHED_ALL;
+	}
+
+	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
+	{
+		vc_item_update_db_cached_from(*item,
+				vch_chunk_slots(*item, (*item)->tail)[(*item)->tail->first_value].timestamp.sec);
+	}
+	else if (0 != range_start)
+		vc_item_update_db_cached_from(*item, range_start);
+
+out:
+	zbx_history_record_vector_destroy(&records, value_type);
+
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies value in the specified item's chunk slot                   *
- *                                                                            *
- * Parameters: chunk        - [IN/OUT] the target chunk                       *
- *             index        - [IN] the target slot                            *
- *             source_value - [IN] the value to copy                          *
- *                                                                            *
- * Return value: SUCCEED - the value was copied successfully                  *
- *               FAIL    - the value copying failed (not enough space for     *
- *                         string, text or log type data)                     *
+ * Purpose: retrieves item history data from cache                            *
  *                                                                            *
- * Comments: This function is used to copy data to cache. The contents of     *
- *           str, text and log type values are stored in cache string pool.   *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order                           *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             ts        - [IN] the requested period end timestamp            *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_copy_value(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk, int index,
-		const zbx_history_record_t *source_value)
+static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		const zbx_timespec_t *ts)
 {
-	zbx_history_record_t	*value;
-	int			ret = FAIL;
+	int		index, now;
+	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
+	zbx_vc_chunk_t	*chunk;
 
-	value = &chunk->slots[index];
+	now = (int)time(NULL);
+	/* add another second to include nanosecond shifts */
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
 
-	switch (item->value_type)
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
 	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			if (NULL == (value->value.str = vc_item_strdup(item, source_value->value.str)))
-				goto out;
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			if (NULL == (value->value.log = vc_item_logdup(item, source_value->value.log)))
-				goto out;
-			break;
-		default:
-			value->value = source_value->value;
+		/* Cache does not contain records for the specified timeshift & seconds range. */
+		/* Return empty vector with success.                                           */
+		return;
 	}
-	value->timestamp = source_value->timestamp;
 
-	ret = SUCCEED;
-out:
-	return ret;
+	/* fill the values vector with item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, &start))
+	{
+		zbx_history_record_t	*slots = vch_chunk_slots(item, chunk);
+
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
+
+		if (NULL == (chunk = chunk->prev))
+			break;
+
+		index = chunk->last_value;
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: copies values at the beginning of item tail chunk                 *
- *                                                                            *
- * Parameters: item       - [IN/OUT] the target item                          *
- *             values     - [IN] the values to copy                           *
- *             values_num - [IN] the number of values to copy                 *
- *                                                                            *
- * Return value: SUCCEED - the values were copied successfully                *
- *               FAIL    - the value copying failed (not enough space for     *
- *                         string, text or log type data)                     *
+ * Purpose: retrieves item history data from cache                            *
  *                                                                            *
- * Comments: This function is used to copy data to cache. The contents of     *
- *           str, text and log type values are stored in cache string pool.   *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order, optional                 *
+ *                         If null then cache is updated if necessary, but no *
+ *                         values are returned. Used to ensure that cache     *
+ *                         contains a value of the specified timestamp.       *
+ *             seconds   - [IN] the time period                               *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             timestamp - [IN] the target timestamp                          *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_copy_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
+		int seconds, int count, const zbx_timespec_t *ts)
 {
-	int	i, ret = FAIL, first_value = item->tail->first_value;
+	int		index, now, range_timestamp;
+	zbx_vc_chunk_t	*chunk;
+	zbx_timespec_t	start;
 
-	switch (item->value_type)
+	/* set start timestamp of the requested time period */
+	if (0 != seconds)
 	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			for (i = values_num - 1; i >= 0; i--)
-			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
-
-				if (NULL == (value->value.str = vc_item_strdup(item, values[i].value.str)))
-					goto out;
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
+	}
+	else
+	{
+		start.sec = 0;
+		start.ns = 0;
+	}
 
-				value->timestamp = values[i].timestamp;
-				item->tail->first_value--;
-			}
-			ret = SUCCEED;
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+	{
+		/* return empty vector with success */
+		goto out;
+	}
 
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			for (i = values_num - 1; i >= 0; i--)
-			{
-				zbx_history_record_t	*value = &item->tail->slots[item->tail->first_value - 1];
+	/* fill the values vector with item history values until the <count> values are read    */
+	/* or no more values within specified time period                                       */
+	/* fill the values vector with item history values until the start timestamp is reached */
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, &start))
+	{
+		zbx_history_record_t	*slots = vch_chunk_slots(item, chunk);
 
-				if (NULL == (value->value.log = vc_item_logdup(item, values[i].value.log)))
-					goto out;
+		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&slots[index].timestamp, &start))
+		{
+			vc_history_record_vector_append(values, item->value_type, &slots[index--]);
 
-				value->timestamp = values[i].timestamp;
-				item->tail->first_value--;
-			}
-			ret = SUCCEED;
+			if (values->values_num == count)
+				goto out;
+		}
 
+		if (NULL == (chunk = chunk->prev))
 			break;
-		default:
-			memcpy(&item->tail->slots[item->tail->first_value - values_num], values,
-					(size_t)values_num * sizeof(zbx_history_record_t));
-			item->tail->first_value -= values_num;
-			ret = SUCCEED;
+
+		index = chunk->last_value;
 	}
 out:
-	item->values_total += first_value - item->tail->first_value;
+	if (count > values->values_num)
+	{
+		if (0 == seconds)
+			return;
 
-	return ret;
+		/* set the range equal to the period plus one second to include nanosecond shifts */
+		range_timestamp = ts->sec - seconds;
+	}
+	else
+	{
+		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
+		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+	}
+
+	now = (int)time(NULL);
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees chunk and all resources allocated to store its values       *
+ * Purpose: get item values for the specified range                           *
  *                                                                            *
- * Parameters: item    - [IN] the chunk owner item                            *
- *             chunk   - [IN] the chunk to free                               *
+ * Parameters: item      - [IN] the item                                      *
+ *             values    - [OUT] the item history data stored time/value      *
+ *                         pairs in undefined order, optional                 *
+ *                         If null then cache is updated if necessary, but no *
+ *                         values are returned. Used to ensure that cache     *
+ *                         contains a value of the specified timestamp.       *
+ *             seconds   - [IN] the time period to retrieve data for          *
+ *             count     - [IN] the number of history values to retrieve      *
+ *             ts        - [IN] the target timestamp                          *
  *                                                                            *
- * Return value: the number of bytes freed                                    *
+ * Return value:  SUCCEED - the item history data was retrieved successfully  *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: This function returns data from cache if necessary updating it   *
+ *           from DB. If cache update was required and failed (not enough     *
+ *           memory to cache DB values), then this function also fails.       *
+ *                                                                            *
+ *           If <count> is set then value range is defined as <count> values  *
+ *           before <timestamp>. Otherwise the range is defined as <seconds>  *
+ *           seconds before <timestamp>.                                      *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
+static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
+		int count, const zbx_timespec_t *ts)
 {
-	size_t	freed;
+	int	ret, records_read, hits, misses, range_start;
 
-	freed = sizeof(zbx_vc_chunk_t) + (size_t)(chunk->slots_num - 1) * sizeof(zbx_history_record_t);
-	freed += vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->last_value);
+	zbx_vector_history_record_clear(values);
 
-	__vc_shmem_free_func(chunk);
+	if (0 == count)
+	{
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
 
-	return freed;
-}
+		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
+			goto out;
 
-/******************************************************************************
- *                                                                            *
- * Purpose: removes item history data chunk                                   *
- *                                                                            *
- * Parameters: item    - [IN ] the chunk owner item                           *
- *             chunk   - [IN] the chunk to remove                             *
- *                                                                            *
- ******************************************************************************/
-static void	vch_item_remove_chunk(zbx_vc_item_t *item, zbx_vc_chunk_t *chunk)
-{
-	if (NULL != chunk->next)
-		chunk->next->prev = chunk->prev;
+		records_read = ret;
 
-	if (NULL != chunk->prev)
-		chunk->prev->next = chunk->next;
+		vch_item_get_values_by_time(item, values, seconds, ts);
 
-	if (chunk == item->head)
-		item->head = chunk->prev;
+		if (records_read > values->values_num)
+			records_read = values->values_num;
+	}
+	else
+	{
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
 
-	if (chunk == item->tail)
-		item->tail = chunk->next;
+		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
+			goto out;
 
-	vch_item_free_chunk(item, chunk);
+		records_read = ret;
+
+		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
+
+		if (records_read > values->values_num)
+			records_read = values->values_num;
+	}
+
+	hits = values->values_num - records_read;
+	misses = records_read;
+
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+
+	ret = SUCCEED;
+out:
+	return ret;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes item history data that are outside (older) the maximum    *
- *          request range                                                     *
+ * Purpose: find the index of the first value in chunk slots with timestamp   *
+ *          greater than the specified timestamp                              *
  *                                                                            *
- * Parameters:  item      - [IN] the target item                              *
- *              timestamp - [IN] last timestamp in active range               *
+ * Parameters: slots - [IN] the chunk value slots                             *
+ *             start - [IN] the first slot to check                           *
+ *             end   - [IN] the last slot to check                            *
+ *             ts    - [IN] the target timestamp                              *
+ *                                                                            *
+ * Return value: The index of the first value with timestamp greater than the *
+ *               specified timestamp or end + 1 if there are no such values.  *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_clean_cache(zbx_vc_item_t *item, int timestamp)
+static int	vch_slots_find_first_value_after(const zbx_history_record_t *slots, int start, int end,
+		const zbx_timespec_t *ts)
 {
-	zbx_vc_chunk_t	*next;
+	int	middle;
 
-	if (0 != item->active_range)
-	{
-		zbx_vc_chunk_t	*tail = item->tail;
-		zbx_vc_chunk_t	*chunk = tail;
-
-		timestamp -= item->active_range;
-
-		/* Try to remove chunks with all history values older than maximum request range, maximum */
-		/* request range should be calculated from last received value with which active range    */
-		/* was calculated to avoid dropping of chunks that might be still used in count request.  */
-		while (NULL != chunk && chunk->slots[chunk->last_value].timestamp.sec < timestamp &&
-				chunk->slots[chunk->last_value].timestamp.sec !=
-						item->head->slots[item->head->last_value].timestamp.sec)
-		{
-			/* don't remove the head chunk */
-			if (NULL == (next = chunk->next))
-				break;
-
-			/* Values with the same timestamps (seconds resolution) always should be either   */
-			/* kept in cache or removed together. There should not be a case when one of them */
-			/* is in cache and the second is dropped.                                         */
-			/* Here we are handling rare case, when the last value of first chunk has the     */
-			/* same timestamp (seconds resolution) as the first value in the second chunk.    */
-			/* In this case increase the first value index of the next chunk until the first  */
-			/* value timestamp is greater.                                                    */
-
-			if (next->slots[next->first_value].timestamp.sec != next->slots[next->last_value].timestamp.sec)
-			{
-				while (next->slots[next->first_value].timestamp.sec ==
-						chunk->slots[chunk->last_value].timestamp.sec)
-				{
-					vc_item_free_values(item, next->slots, next->first_value, next->first_value);
-					next->first_value++;
-				}
-			}
-
-			/* set the database cached from timestamp to the last (oldest) removed value timestamp + 1 */
-			item->db_cached_from = chunk->slots[chunk->last_value].timestamp.sec + 1;
-
-			vch_item_remove_chunk(item, chunk);
+	end++;
 
-			chunk = next;
-		}
+	while (start != end)
+	{
+		middle = start + (end - start) / 2;
 
-		/* reset the status flags if data was removed from cache */
-		if (tail != item->tail)
-			item->status = 0;
+		if (0 < zbx_timespec_compare(&slots[middle].timestamp, ts))
+			end = middle;
+		else
+			start = middle + 1;
 	}
+
+	return start;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: removes item history data that are older than the specified       *
- *          timestamp                                                         *
+ * Purpose: passes cached item history data to reducer                        *
  *                                                                            *
- * Parameters:  item      - [IN] the target item                              *
- *              timestamp - [IN] the timestamp (number of seconds since the   *
- *                               Epoch)                                       *
+ * Parameters: item        - [IN] the item                                    *
+ *             start       - [IN] the period start timestamp (exclusive)      *
+ *             count       - [IN] the number of values to pass, 0 - all       *
+ *                                values in the period                        *
+ *             ts          - [IN] the period end timestamp                    *
+ *             reduce_func - [IN] the reducer                                 *
+ *             data        - [IN] the reducer data                            *
+ *             oldest      - [OUT] the timestamp of the oldest passed value   *
+ *                                                                            *
+ * Return value: The number of values passed to reducer.                      *
+ *                                                                            *
+ * Comments: The values are passed as spans of chunk slots, the same values   *
+ *           vch_item_get_values_by_time_and_count() would return.            *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_remove_values(zbx_vc_item_t *item, int timestamp)
+static int	vch_item_reduce_range(const zbx_vc_item_t *item, const zbx_timespec_t *start, int count,
+		const zbx_timespec_t *ts, zbx_vc_reduce_func_t reduce_func, void *data, zbx_timespec_t *oldest)
 {
-	zbx_vc_chunk_t	*chunk = item->tail;
+	int		index, first, values_num = 0;
+	zbx_vc_chunk_t	*chunk;
 
-	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
-		item->status = 0;
+	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
+		return 0;
 
-	/* try to remove chunks with all history values older than the timestamp */
-	while (NULL != chunk && chunk->slots[chunk->first_value].timestamp.sec < timestamp)
+	while (0 < zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, start))
 	{
-		zbx_vc_chunk_t	*next;
+		const zbx_history_record_t	*slots = vch_chunk_slots(item, chunk);
 
-		/* If chunk contains values with timestamp greater or equal - remove */
-		/* only the values with less timestamp. Otherwise remove the while   */
-		/* chunk and check next one.                                         */
-		if (chunk->slots[chunk->last_value].timestamp.sec >= timestamp)
+		first = vch_slots_find_first_value_after(slots, chunk->first_value, index, start);
+
+		if (0 != count && index - first + 1 > count - values_num)
+			first = index - (count - values_num) + 1;
+
+		if (first <= index)
 		{
-			while (chunk->slots[chunk->first_value].timestamp.sec < timestamp)
-			{
-				vc_item_free_values(item, chunk->slots, chunk->first_value, chunk->first_value);
-				chunk->first_value++;
-			}
+			reduce_func(&slots[first], index - first + 1, data);
+			values_num += index - first + 1;
+			*oldest = slots[first].timestamp;
+		}
 
+		/* stop if the period start or the requested number of values was reached within chunk */
+		if (first != chunk->first_value || NULL == (chunk = chunk->prev))
 			break;
-		}
 
-		next = chunk->next;
-		vch_item_remove_chunk(item, chunk);
-		chunk = next;
+		index = chunk->last_value;
 	}
+
+	return values_num;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds one item history value at the end of current item's history  *
- *          data                                                              *
+ * Purpose: reduces item values for the specified range                       *
  *                                                                            *
- * Parameters:  item   - [IN] the item to add history data to                 *
- *              value  - [IN] the item history data value                     *
+ * Parameters: item        - [IN] the item                                    *
+ *             seconds     - [IN] the time period to reduce data for          *
+ *             count       - [IN] the number of history values to reduce      *
+ *             ts          - [IN] the target timestamp                        *
+ *             reduce_func - [IN] the reducer                                 *
+ *             data        - [IN] the reducer data                            *
+ *             values_num  - [OUT] the number of reduced values               *
  *                                                                            *
- * Return value: SUCCEED - the history data value was added successfully      *
- *               FAIL - failed to add history data value (not enough memory)  *
+ * Return value:  SUCCEED - the item history data was reduced successfully    *
+ *                FAIL    - the item history data was not reduced             *
  *                                                                            *
- * Comments: In the case of failure the item will be removed from cache       *
- *           later.                                                           *
+ * Comments: This function updates cache from DB the same way as              *
+ *           vch_item_get_values() does, but instead of copying values they   *
+ *           are passed to reducer directly from cache chunks.                *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_add_value_at_head(zbx_vc_item_t *item, const zbx_history_record_t *value)
+static int	vch_item_reduce_values(zbx_vc_item_t *item, int seconds, int count, const zbx_timespec_t *ts,
+		zbx_vc_reduce_func_t reduce_func, void *data, int *values_num)
 {
-	int		ret = FAIL, index, sindex, nslots = 0;
-	zbx_vc_chunk_t	*chunk, *schunk;
+	int		ret, records_read, range_start, now;
+	zbx_timespec_t	start, oldest;
 
-	if (NULL != item->head &&
-			0 < zbx_history_record_compare_asc(&item->head->slots[item->head->last_value], value))
+	if (0 == count)
 	{
-		if (0 < zbx_history_record_compare_asc(&item->tail->slots[item->tail->first_value], value))
-		{
-			/* If the added value has the same or older timestamp as the first value in cache */
-			/* we can't add it to keep cache consistency. Additionally we must make sure no   */
-			/* values with matching timestamp seconds are kept in cache.                      */
-			vch_item_remove_values(item, value->timestamp.sec + 1);
-
-			/* empty items must be removed to avoid situation when a new value is added to cache */
-			/* while other values with matching timestamp seconds are not cached                 */
-			if (NULL == item->head)
-				goto out;
-
-			/* if the value is newer than the database cached from timestamp we must */
-			/* adjust the cached from timestamp to exclude this value                */
-			if (item->db_cached_from <= value->timestamp.sec)
-				item->db_cached_from = value->timestamp.sec + 1;
+		if (0 > (range_start = ts->sec - seconds))
+			range_start = 0;
 
-			ret = SUCCEED;
+		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
 			goto out;
-		}
-
-		sindex = item->head->last_value;
-		schunk = item->head;
-
-		if (0 == item->head->slots_num - item->head->last_value - 1)
-		{
-			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
-				goto out;
-		}
-		else
-			item->head->last_value++;
-
-		item->values_total++;
-
-		chunk = item->head;
-		index = item->head->last_value;
-
-		do
-		{
-			chunk->slots[index] = schunk->slots[sindex];
 
-			chunk = schunk;
-			index = sindex;
+		records_read = ret;
 
-			if (--sindex < schunk->first_value)
-			{
-				if (NULL == (schunk = schunk->prev))
-				{
-					memset(&chunk->slots[index], 0, sizeof(zbx_vc_chunk_t));
-					THIS_SHOULD_NEVER_HAPPEN;
+		now = (int)time(NULL);
+		/* add another second to include nanosecond shifts */
+		vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
 
-					goto out;
-				}
+		start.sec = ts->sec - seconds;
+		start.ns = ts->ns;
 
-				sindex = schunk->last_value;
-			}
-		}
-		while (0 < zbx_timespec_compare(&schunk->slots[sindex].timestamp, &value->timestamp));
+		*values_num = vch_item_reduce_range(item, &start, 0, ts, reduce_func, data, &oldest);
 	}
 	else
 	{
-		/* find the number of free slots on the right side in last (head) chunk */
-		if (NULL != item->head)
-			nslots = item->head->slots_num - item->head->last_value - 1;
+		range_start = (0 == seconds ? 0 : ts->sec - seconds);
 
-		if (0 == nslots)
+		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
+			goto out;
+
+		records_read = ret;
+
+		if (0 != seconds)
 		{
-			if (FAIL == vch_item_add_chunk(item, vch_item_chunk_slot_count(item, 1), NULL))
-				goto out;
+			start.sec = ts->sec - seconds;
+			start.ns = ts->ns;
 		}
 		else
-			item->head->last_value++;
+		{
+			start.sec = 0;
+			start.ns = 0;
+		}
 
-		item->values_total++;
+		*values_num = vch_item_reduce_range(item, &start, count, ts, reduce_func, data, &oldest);
 
-		chunk = item->head;
-		index = item->head->last_value;
+		if (count <= *values_num)
+		{
+			/* the requested number of values was reduced, set the range to the oldest value timestamp */
+			now = (int)time(NULL);
+			vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - oldest.sec + 1, now);
+		}
+		else if (0 != seconds)
+		{
+			/* set the range equal to the period plus one second to include nanosecond shifts */
+			now = (int)time(NULL);
+			vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - ts->sec + seconds, now);
+		}
 	}
 
-	if (SUCCEED != vch_item_copy_value(item, chunk, index, value))
-		goto out;
+	if (records_read > *values_num)
+		records_read = *values_num;
+
+	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, *values_num - records_read, records_read);
 
 	ret = SUCCEED;
 out:
@@ -1787,492 +3420,643 @@ out:
 
 /******************************************************************************
  *                                                                            *
- * Purpose: adds item history values at the beginning of current item's       *
- *          history data                                                      *
- *                                                                            *
- * Parameters:  item   - [IN] the item to add history data to                 *
- *              values - [IN] the item history data values                    *
- *              num    - [IN] the number of history data values to add        *
+ * Purpose: frees resources allocated for item history data                   *
  *                                                                            *
- * Return value: SUCCEED - the history data values were added successfully    *
- *               FAIL - failed to add history data values (not enough memory) *
+ * Parameters: item    - [IN] the item                                        *
  *                                                                            *
- * Comments: In the case of failure the item is removed from cache.           *
- *           Overlapping values (by timestamp seconds) are ignored.           *
+ * Return value: the size of freed memory (bytes)                             *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_add_values_at_tail(zbx_vc_item_t *item, const zbx_history_record_t *values, int values_num)
+static size_t	vch_item_free_cache(zbx_vc_item_t *item)
 {
-	int 	count = values_num, ret = FAIL;
+	size_t	freed;
 
-	/* skip values already added to the item cache by another process */
-	if (NULL != item->tail)
-	{
-		int	sec = item->tail->slots[item->tail->first_value].timestamp.sec;
+	zbx_vc_chunk_t	*chunk = item->tail;
 
-		while (--count >= 0 && values[count].timestamp.sec >= sec)
-			;
-		++count;
-	}
+	freed = vc_item_free_windows(item);
 
-	while (0 != count)
+	while (NULL != chunk)
 	{
-		int	copy_slots, nslots = 0;
-
-		/* find the number of free slots on the left side in first (tail) chunk */
-		if (NULL != item->tail)
-			nslots = item->tail->first_value;
-
-		if (0 == nslots)
-		{
-			nslots = vch_item_chunk_slot_count(item, count);
+		zbx_vc_chunk_t	*next = chunk->next;
 
-			if (FAIL == vch_item_add_chunk(item, nslots, item->tail))
-				goto out;
+		freed += vch_item_free_chunk(item, chunk);
+		chunk = next;
+	}
+	item->values_total = 0;
+	item->head = NULL;
+	item->tail = NULL;
 
-			item->tail->last_value = nslots - 1;
-			item->tail->first_value = nslots;
-		}
+	return freed;
+}
 
-		/* copy values to chunk */
-		copy_slots = MIN(nslots, count);
-		count -= copy_slots;
+/******************************************************************************************************************
+ *                                                                                                                *
+ * Incremental windows                                                                                            *
+ *                                                                                                                *
+ ******************************************************************************************************************/
+/*
+ * Aggregates of frequently requested time periods are updated when new values are added to cache
+ * instead of aggregating all period values on every request.
+ *
+ * The window contains values after its left timestamp up to the newest cached value. When a new
+ * value is added the left timestamp is moved by the same amount and the values falling out of
+ * window are subtracted from the aggregates. Minimum and maximum are tracked with monotonic
+ * candidate queue, so every value is added to and removed from window once.
+ *
+ * Windows are registered by requests (see zbx_vc_get_window_value()) and removed when they are not
+ * requested anymore, when values are added out of order or when the window values are dropped
+ * from cache. Windows are accessed only with cache locked, lock-free readers never use them.
+ */
 
-		if (FAIL == vch_item_copy_values_at_tail(item, values + count, copy_slots))
-			goto out;
-	}
+#define VC_WINDOW_DEQUE(wdata, i)	(wdata)->deque[((wdata)->deque_first + (i)) % (wdata)->deque_alloc]
 
-	ret = SUCCEED;
-out:
-	return ret;
+typedef struct
+{
+	zbx_vc_item_t		*item;
+	zbx_vc_window_data_t	*wdata;
+	zbx_vc_window_aggr_t	*aggr;
+	int			ret;
 }
+vc_window_walk_t;
 
 /******************************************************************************
  *                                                                            *
- * Purpose: cache item history data for the specified time period             *
- *                                                                            *
- * Parameters: item        - [IN] the item                                    *
- *             range_start - [IN] the interval start time                     *
- *                                                                            *
- * Return value:  >=0    - the number of values read from database            *
- *                FAIL   - an error occurred while trying to cache values     *
+ * Purpose: passes cached item values with timestamps in the specified range  *
+ *          to walker in ascending order                                      *
  *                                                                            *
- * Comments: This function checks if the requested value range is cached and  *
- *           updates cache from database if necessary.                        *
+ * Parameters: item      - [IN] the item                                      *
+ *             from      - [IN] the range start timestamp (exclusive)         *
+ *             to        - [IN] the range end timestamp, NULL - up to the     *
+ *                              newest value                                  *
+ *             walk_func - [IN] the walker                                    *
+ *             data      - [IN] the walker data                               *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_cache_values_by_time(zbx_vc_item_t **item, int range_start)
+static void	vch_item_walk_range(const zbx_vc_item_t *item, const zbx_timespec_t *from, const zbx_timespec_t *to,
+		zbx_vc_reduce_func_t walk_func, void *data)
 {
-	int				ret, range_end;
-	zbx_vector_history_record_t	records;
-	zbx_uint64_t			itemid;
-	unsigned char			value_type;
-
-	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
-		return SUCCEED;
-
-	/* check if the requested period is in the cached range */
-	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
-		return SUCCEED;
+	const zbx_vc_chunk_t	*chunk;
+	int			first, last;
 
-	/* find if the cache should be updated to cover the required range */
-	if (NULL != (*item)->tail)
+	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
-		/* we need to get item values before the first cached value, but not including it */
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
-	}
-	else
-		range_end = ZBX_JAN_2038;
+		const zbx_history_record_t	*slots;
 
-	/* update cache if necessary */
-	if (range_start >= range_end)
-		return SUCCEED;
+		if (0 >= zbx_timespec_compare(&vch_chunk_last(chunk)->timestamp, from))
+			continue;
 
-	zbx_vector_history_record_create(&records);
-	itemid = (*item)->itemid;
-	value_type = (*item)->value_type;
+		slots = vch_chunk_slots(item, chunk);
+		first = vch_slots_find_first_value_after(slots, chunk->first_value, chunk->last_value, from);
 
-	UNLOCK_CACHE;
+		if (NULL != to)
+			last = vch_slots_find_first_value_after(slots, first, chunk->last_value, to) - 1;
+		else
+			last = chunk->last_value;
 
-	if (SUCCEED == (ret = vc_db_read_values_by_time(itemid, value_type, &records, range_start, range_end)))
-		zbx_vector_history_record_sort(&records, zbx_history_record_compare_asc);
+		if (first <= last)
+			walk_func(&slots[first], last - first + 1, data);
 
-	WRLOCK_CACHE;
+		if (last != chunk->last_value)
+			break;
+	}
+}
 
-	if (SUCCEED != ret)
-		goto out;
+static int	vc_window_compare(const zbx_vc_window_t *w1, const zbx_vc_window_t *w2)
+{
+	if (w1->type != w2->type || w1->seconds != w2->seconds)
+		return FAIL;
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
-	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+	if (ZBX_VC_WINDOW_COUNT != w1->type)
+		return SUCCEED;
 
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item,
-				sizeof(new_item))))
-		{
-			ret = FAIL;
-			goto out;
-		}
-	}
+	if (w1->op != w2->op || w1->pattern.ui64 != w2->pattern.ui64 || w1->mask != w2->mask)
+		return FAIL;
 
-	/* when updating cache with time based request we can always reset status flags */
-	/* flag even if the requested period contains no data                           */
-	(*item)->status = 0;
+	return SUCCEED;
+}
 
-	if (0 < records.values_num)
-	{
-		if (SUCCEED != (ret = vch_item_add_values_at_tail(*item, records.values, records.values_num)))
-			goto out;
-	}
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if all window values are cached                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_is_cached(const zbx_vc_item_t *item, const zbx_timespec_t *left)
+{
+	if (NULL == item->head)
+		return FAIL;
 
-	ret = records.values_num;
-	vc_item_update_db_cached_from(*item, range_start);
-out:
-	zbx_history_record_vector_destroy(&records, value_type);
+	if (ZBX_ITEM_STATUS_CACHED_ALL == item->status)
+		return SUCCEED;
+
+	if (0 == item->db_cached_from || item->db_cached_from > left->sec)
+		return FAIL;
 
-	return ret;
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: cache the specified number of history data values for time period *
- *          since timestamp                                                   *
- *                                                                            *
- * Parameters: item        - [IN] the item                                    *
- *             range_start - [IN] the interval start time                     *
- *             count       - [IN] the number of history values to retrieve    *
- *             ts          - [IN] the target timestamp                        *
- *                                                                            *
- * Return value:  >=0    - the number of values read from database            *
- *                FAIL   - an error occurred while trying to cache values     *
+ * Purpose: checks if value matches count window filter                       *
  *                                                                            *
- * Comments: This function checks if the requested number of values is cached *
- *           and updates cache from database if necessary.                    *
+ * Comments: Floating point values are compared using epsilon, the same way   *
+ *           as in count() function.                                          *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_cache_values_by_time_and_count(zbx_vc_item_t **item, int range_start, int count,
-		const zbx_timespec_t *ts)
+static int	vc_window_match(const zbx_vc_window_t *window, unsigned char value_type,
+		const zbx_history_value_t *value)
 {
-	int				ret = SUCCEED, cached_records = 0, range_end, records_offset;
-	zbx_vector_history_record_t	records;
-	zbx_uint64_t			itemid;
-	unsigned char			value_type;
+	int	ret;
 
-	if (ZBX_ITEM_STATUS_CACHED_ALL == (*item)->status)
-		return SUCCEED;
-
-	/* check if the requested period is in the cached range */
-	if (0 != (*item)->db_cached_from && range_start >= (*item)->db_cached_from)
+	if (ZBX_VC_WINDOW_OP_ANY == window->op)
 		return SUCCEED;
 
-	/* find if the cache should be updated to cover the required count */
-	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
 	{
-		zbx_vc_chunk_t	*chunk;
-		int		index;
+		double	epsilon = zbx_get_double_epsilon(), diff = value->dbl - window->pattern.dbl;
 
-		if (SUCCEED == vch_item_get_last_value(*item, ts, &chunk, &index))
+		switch (window->op)
 		{
-			cached_records = index - chunk->first_value + 1;
+			case ZBX_VC_WINDOW_OP_EQ:
+				ret = fabs(diff) <= epsilon;
+				break;
+			case ZBX_VC_WINDOW_OP_NE:
+				ret = !(fabs(diff) <= epsilon);
+				break;
+			case ZBX_VC_WINDOW_OP_GT:
+				ret = diff > epsilon;
+				break;
+			case ZBX_VC_WINDOW_OP_GE:
+				ret = diff >= -epsilon;
+				break;
+			case ZBX_VC_WINDOW_OP_LT:
+				ret = -diff > epsilon;
+				break;
+			case ZBX_VC_WINDOW_OP_LE:
+				ret = -diff >= -epsilon;
+				break;
+			default:
+				ret = 0;
+		}
+	}
+	else
+	{
+		zbx_uint64_t	ui64 = value->ui64, pattern = window->pattern.ui64;
 
-			while (NULL != (chunk = chunk->prev) && cached_records < count)
-				cached_records += chunk->last_value - chunk->first_value + 1;
+		switch (window->op)
+		{
+			case ZBX_VC_WINDOW_OP_EQ:
+				ret = ui64 == pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_NE:
+				ret = ui64 != pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_GT:
+				ret = ui64 > pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_GE:
+				ret = ui64 >= pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_LT:
+				ret = ui64 < pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_LE:
+				ret = ui64 <= pattern;
+				break;
+			case ZBX_VC_WINDOW_OP_BITAND:
+				ret = (ui64 & window->mask) == pattern;
+				break;
+			default:
+				ret = 0;
 		}
 	}
 
-	/* update cache if necessary */
-	if (cached_records >= count)
-		return SUCCEED;
+	return 0 != ret ? SUCCEED : FAIL;
+}
 
-	/* get the end timestamp to which (including) the values should be cached */
-	if (0 != (*item)->db_cached_from && NULL != (*item)->head)
-		range_end = (*item)->tail->slots[(*item)->tail->first_value].timestamp.sec - 1;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to floating point sum with Neumaier compensation       *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_add_dbl(zbx_vc_window_aggr_t *aggr, double value)
+{
+	double	sum = aggr->sum.dbl + value;
+
+	if (fabs(aggr->sum.dbl) >= fabs(value))
+		aggr->sum_comp += (aggr->sum.dbl - sum) + value;
 	else
-		range_end = ZBX_JAN_2038;
+		aggr->sum_comp += (value - sum) + aggr->sum.dbl;
 
-	itemid = (*item)->itemid;
-	value_type = (*item)->value_type;
-	UNLOCK_CACHE;
+	aggr->sum.dbl = sum;
+}
 
-	zbx_vector_history_record_create(&records);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to or subtracts it from window aggregates              *
+ *                                                                            *
+ * Parameters: window     - [IN] the window                                   *
+ *             value_type - [IN] the item value type                          *
+ *             aggr       - [IN/OUT] the window aggregates                    *
+ *             value      - [IN] the value                                    *
+ *             sign       - [IN] 1 - add value, -1 - subtract value           *
+ *                                                                            *
+ ******************************************************************************/
+static void	vc_window_aggr_update(const zbx_vc_window_t *window, unsigned char value_type,
+		zbx_vc_window_aggr_t *aggr, const zbx_history_value_t *value, int sign)
+{
+	aggr->values_num += sign;
 
-	if (range_end > ts->sec)
+	switch (window->type)
 	{
-		ret = vc_db_read_values_by_time(itemid, value_type, &records, ts->sec + 1, range_end);
-		range_end = ts->sec;
+		case ZBX_VC_WINDOW_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+				vc_window_add_dbl(aggr, sign * value->dbl);
+			else if (0 < sign)
+				aggr->sum.ui64 += value->ui64;
+			else
+				aggr->sum.ui64 -= value->ui64;
+			break;
+		case ZBX_VC_WINDOW_AVG:
+			if (ITEM_VALUE_TYPE_FLOAT == value_type)
+				vc_window_add_dbl(aggr, sign * value->dbl);
+			else
+				vc_window_add_dbl(aggr, sign * (double)value->ui64);
+			break;
+		case ZBX_VC_WINDOW_COUNT:
+			if (SUCCEED == vc_window_match(window, value_type, value))
+				aggr->count += sign;
+			break;
 	}
+}
 
-	records_offset = records.values_num;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the older candidate value can be removed from min/max   *
+ *          window after adding the newer value                               *
+ *                                                                            *
+ * Comments: Equal older values are removed, so the newest of equal values is *
+ *           returned like when searching values starting with the newest.    *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_is_dominated(const zbx_vc_window_t *window, unsigned char value_type,
+		const zbx_history_value_t *older, const zbx_history_value_t *newer)
+{
+	int	ret;
 
-	if (SUCCEED == ret && SUCCEED == (ret = vc_db_read_values_by_time_and_count(itemid, value_type, &records,
-			range_start, count - cached_records, range_end, ts)))
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
 	{
-		zbx_vector_history_record_sort(&records, zbx_history_record_compare_asc);
+		if (ZBX_VC_WINDOW_MIN == window->type)
+			ret = older->dbl >= newer->dbl;
+		else
+			ret = older->dbl <= newer->dbl;
+	}
+	else
+	{
+		if (ZBX_VC_WINDOW_MIN == window->type)
+			ret = older->ui64 >= newer->ui64;
+		else
+			ret = older->ui64 <= newer->ui64;
 	}
 
-	WRLOCK_CACHE;
+	return 0 != ret ? SUCCEED : FAIL;
+}
 
-	if (SUCCEED != ret)
-		goto out;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to min/max window candidates                           *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - not enough memory                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_push(zbx_vc_item_t *item, zbx_vc_window_data_t *wdata, const zbx_history_record_t *record)
+{
+	while (0 < wdata->deque_num && SUCCEED == vc_window_is_dominated(&wdata->window, item->value_type,
+			&VC_WINDOW_DEQUE(wdata, wdata->deque_num - 1).value, &record->value))
+	{
+		wdata->deque_num--;
+	}
 
-	if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	if (wdata->deque_num == wdata->deque_alloc)
 	{
-		zbx_vc_item_t	new_item = {.itemid = itemid, .value_type = value_type};
+		zbx_history_record_t	*deque;
+		int			i, deque_alloc = (0 == wdata->deque_alloc ? ZBX_VC_WINDOW_DEQUE_INIT :
+						wdata->deque_alloc * 2);
 
-		if (NULL == (*item = (zbx_vc_item_t *)zbx_hashset_insert(&vc_cache->items, &new_item, sizeof(new_item))))
+		if (NULL == (deque = (zbx_history_record_t *)vc_item_malloc(item,
+				sizeof(zbx_history_record_t) * (size_t)deque_alloc)))
 		{
-			ret = FAIL;
-			goto out;
+			return FAIL;
 		}
+
+		for (i = 0; i < wdata->deque_num; i++)
+			deque[i] = VC_WINDOW_DEQUE(wdata, i);
+
+		if (NULL != wdata->deque)
+			__vc_shmem_free_func(wdata->deque);
+
+		wdata->deque = deque;
+		wdata->deque_alloc = deque_alloc;
+		wdata->deque_first = 0;
 	}
 
-	if (0 < records.values_num)
-		ret = vch_item_add_values_at_tail(*item, records.values, records.values_num);
+	VC_WINDOW_DEQUE(wdata, wdata->deque_num++) = *record;
 
-	if (SUCCEED != ret)
-		goto out;
+	return SUCCEED;
+}
 
-	ret = records.values_num;
+static void	vc_window_add_values(const zbx_history_record_t *records, int records_num, void *data)
+{
+	vc_window_walk_t	*walk = (vc_window_walk_t *)data;
+	zbx_vc_window_data_t	*wdata = walk->wdata;
+	int			i;
 
-	if (0 == range_start && count - cached_records > records.values_num - records_offset)
+	for (i = 0; i < records_num; i++)
 	{
-		(*item)->active_range = 0;
-		(*item)->daily_range = 0;
-		(*item)->status = ZBX_ITEM_STATUS_CACHED_ALL;
-	}
+		vc_window_aggr_update(&wdata->window, walk->item->value_type, walk->aggr, &records[i].value, 1);
 
-	if ((count <= records.values_num || 0 == range_start) && 0 != records.values_num)
-	{
-		vc_item_update_db_cached_from(*item,
-				(*item)->tail->slots[(*item)->tail->first_value].timestamp.sec);
+		if ((ZBX_VC_WINDOW_MIN == wdata->window.type || ZBX_VC_WINDOW_MAX == wdata->window.type) &&
+				SUCCEED == walk->ret)
+		{
+			walk->ret = vc_window_push(walk->item, wdata, &records[i]);
+		}
 	}
-	else if (0 != range_start)
-		vc_item_update_db_cached_from(*item, range_start);
+}
 
-out:
-	zbx_history_record_vector_destroy(&records, value_type);
+static void	vc_window_remove_values(const zbx_history_record_t *records, int records_num, void *data)
+{
+	vc_window_walk_t	*walk = (vc_window_walk_t *)data;
+	int			i;
 
-	return ret;
+	for (i = 0; i < records_num; i++)
+		vc_window_aggr_update(&walk->wdata->window, walk->item->value_type, walk->aggr, &records[i].value, -1);
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: calculates window aggregates from cached values                   *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order                           *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             ts        - [IN] the requested period end timestamp            *
+ * Return value: SUCCEED - the aggregates were calculated                     *
+ *               FAIL    - not enough memory                                  *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time(const zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		const zbx_timespec_t *ts)
+static int	vc_window_rebuild(zbx_vc_item_t *item, zbx_vc_window_data_t *wdata)
 {
-	int		index, now;
-	zbx_timespec_t	start = {ts->sec - seconds, ts->ns};
-	zbx_vc_chunk_t	*chunk;
+	vc_window_walk_t	walk = {.item = item, .wdata = wdata, .aggr = &wdata->aggr, .ret = SUCCEED};
 
-	now = (int)time(NULL);
-	/* add another second to include nanosecond shifts */
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, seconds + now - ts->sec + 1, now);
+	memset(&wdata->aggr, 0, sizeof(wdata->aggr));
+	wdata->removed_num = 0;
+	wdata->deque_first = 0;
+	wdata->deque_num = 0;
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
-	{
-		/* Cache does not contain records for the specified timeshift & seconds range. */
-		/* Return empty vector with success.                                           */
-		return;
-	}
+	vch_item_walk_range(item, &wdata->left, NULL, vc_window_add_values, &walk);
 
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
-	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+	return walk.ret;
+}
 
-		if (NULL == (chunk = chunk->prev))
-			break;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees window                                                      *
+ *                                                                            *
+ * Return value: the size of freed memory (bytes)                             *
+ *                                                                            *
+ ******************************************************************************/
+static size_t	vc_window_free(zbx_vc_window_data_t *wdata)
+{
+	size_t	freed = sizeof(zbx_vc_window_data_t);
 
-		index = chunk->last_value;
+	if (NULL != wdata->deque)
+	{
+		freed += sizeof(zbx_history_record_t) * (size_t)wdata->deque_alloc;
+		__vc_shmem_free_func(wdata->deque);
 	}
+
+	__vc_shmem_free_func(wdata);
+
+	return freed;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: retrieves item history data from cache                            *
+ * Purpose: frees item windows                                                *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period                               *
- *             count     - [IN] the number of history values to retrieve      *
- *             timestamp - [IN] the target timestamp                          *
+ * Return value: the size of freed memory (bytes)                             *
  *                                                                            *
  ******************************************************************************/
-static void	vch_item_get_values_by_time_and_count(zbx_vc_item_t *item, zbx_vector_history_record_t *values,
-		int seconds, int count, const zbx_timespec_t *ts)
+static size_t	vc_item_free_windows(zbx_vc_item_t *item)
 {
-	int		index, now, range_timestamp;
-	zbx_vc_chunk_t	*chunk;
-	zbx_timespec_t	start;
+	size_t			freed = 0;
+	zbx_vc_window_data_t	*wdata;
 
-	/* set start timestamp of the requested time period */
-	if (0 != seconds)
-	{
-		start.sec = ts->sec - seconds;
-		start.ns = ts->ns;
-	}
-	else
+	while (NULL != (wdata = item->windows))
 	{
-		start.sec = 0;
-		start.ns = 0;
+		item->windows = wdata->next;
+		freed += vc_window_free(wdata);
 	}
 
-	if (FAIL == vch_item_get_last_value(item, ts, &chunk, &index))
-	{
-		/* return empty vector with success */
-		goto out;
-	}
+	return freed;
+}
 
-	/* fill the values vector with item history values until the <count> values are read    */
-	/* or no more values within specified time period                                       */
-	/* fill the values vector with item history values until the start timestamp is reached */
-	while (0 < zbx_timespec_compare(&chunk->slots[chunk->last_value].timestamp, &start))
-	{
-		while (index >= chunk->first_value && 0 < zbx_timespec_compare(&chunk->slots[index].timestamp, &start))
-		{
-			vc_history_record_vector_append(values, item->value_type, &chunk->slots[index--]);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds the newest item value to window                              *
+ *                                                                            *
+ * Parameters: item   - [IN] the item                                         *
+ *             wdata  - [IN] the window                                       *
+ *             record - [IN] the added value, already stored in cache         *
+ *             now    - [IN] the current time                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the window was updated                             *
+ *               FAIL    - the window must be removed                         *
+ *                                                                            *
+ ******************************************************************************/
+static int	vc_window_add_value(zbx_vc_item_t *item, zbx_vc_window_data_t *wdata, const zbx_history_record_t *record,
+		int now)
+{
+	vc_window_walk_t	walk = {.item = item, .wdata = wdata, .aggr = &wdata->aggr, .ret = SUCCEED};
+	zbx_timespec_t		left = {record->timestamp.sec - wdata->window.seconds, record->timestamp.ns};
+	int			values_num;
 
-			if (values->values_num == count)
-				goto out;
-		}
+	if (ZBX_VC_WINDOW_EXPIRE_PERIOD < now - wdata->last_used)
+		return FAIL;
 
-		if (NULL == (chunk = chunk->prev))
-			break;
+	if (SUCCEED != vc_window_is_cached(item, &wdata->left))
+		return FAIL;
 
-		index = chunk->last_value;
-	}
-out:
-	if (count > values->values_num)
-	{
-		if (0 == seconds)
-			return;
+	vc_window_add_values(record, 1, &walk);
 
-		/* set the range equal to the period plus one second to include nanosecond shifts */
-		range_timestamp = ts->sec - seconds;
+	if (SUCCEED != walk.ret)
+		return FAIL;
+
+	if (0 >= zbx_timespec_compare(&left, &wdata->left))
+		return SUCCEED;
+
+	values_num = wdata->aggr.values_num;
+	vch_item_walk_range(item, &wdata->left, &left, vc_window_remove_values, &walk);
+
+	while (0 < wdata->deque_num && 0 >= zbx_timespec_compare(&VC_WINDOW_DEQUE(wdata, 0).timestamp, &left))
+	{
+		wdata->deque_first = (wdata->deque_first + 1) % wdata->deque_alloc;
+		wdata->deque_num--;
 	}
-	else
+
+	wdata->removed_num += values_num - wdata->aggr.values_num;
+	wdata->left = left;
+
+	/* recalculate floating point sum after all values are replaced to reset rounding errors */
+	if ((ZBX_VC_WINDOW_AVG == wdata->window.type || (ZBX_VC_WINDOW_SUM == wdata->window.type &&
+			ITEM_VALUE_TYPE_FLOAT == item->value_type)) && wdata->removed_num > wdata->aggr.values_num)
 	{
-		/* the requested number of values was retrieved, set the range to the oldest value timestamp */
-		range_timestamp = values->values[values->values_num - 1].timestamp.sec - 1;
+		return vc_window_rebuild(item, wdata);
 	}
 
-	now = (int)time(NULL);
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_RANGE, now - range_timestamp, now);
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: get item values for the specified range                           *
+ * Purpose: adds the newest item value to item windows                        *
  *                                                                            *
- * Parameters: item      - [IN] the item                                      *
- *             values    - [OUT] the item history data stored time/value      *
- *                         pairs in undefined order, optional                 *
- *                         If null then cache is updated if necessary, but no *
- *                         values are returned. Used to ensure that cache     *
- *                         contains a value of the specified timestamp.       *
- *             seconds   - [IN] the time period to retrieve data for          *
- *             count     - [IN] the number of history values to retrieve      *
- *             ts        - [IN] the target timestamp                          *
+ * Parameters: item   - [IN] the item                                         *
+ *             record - [IN] the added value, already stored in cache         *
+ *             now    - [IN] the current time                                 *
  *                                                                            *
- * Return value:  SUCCEED - the item history data was retrieved successfully  *
- *                FAIL    - the item history data was not retrieved           *
+ ******************************************************************************/
+static void	vc_item_update_windows(zbx_vc_item_t *item, const zbx_history_record_t *record, int now)
+{
+	zbx_vc_window_data_t	*wdata, **pwdata = &item->windows;
+
+	while (NULL != (wdata = *pwdata))
+	{
+		if (SUCCEED != vc_window_add_value(item, wdata, record, now))
+		{
+			*pwdata = wdata->next;
+			vc_window_free(wdata);
+			continue;
+		}
+
+		pwdata = &wdata->next;
+	}
+}
+
+/******************************************************************************
  *                                                                            *
- * Comments: This function returns data from cache if necessary updating it   *
- *           from DB. If cache update was required and failed (not enough     *
- *           memory to cache DB values), then this function also fails.       *
+ * Purpose: registers window request                                          *
  *                                                                            *
- *           If <count> is set then value range is defined as <count> values  *
- *           before <timestamp>. Otherwise the range is defined as <seconds>  *
- *           seconds before <timestamp>.                                      *
+ * Parameters: item   - [IN] the item                                         *
+ *             window - [IN] the requested window                             *
+ *             ts     - [IN] the request end timestamp                        *
+ *             now    - [IN] the current time                                 *
+ *                                                                            *
+ * Comments: A new window is created if all its values are cached.            *
  *                                                                            *
  ******************************************************************************/
-static int	vch_item_get_values(zbx_vc_item_t *item, zbx_vector_history_record_t *values, int seconds,
-		int count, const zbx_timespec_t *ts)
+static void	vc_item_use_window(zbx_vc_item_t *item, const zbx_vc_window_t *window, int ts, int now)
 {
-	int	ret, records_read, hits, misses, range_start;
-
-	zbx_vector_history_record_clear(values);
+	zbx_vc_window_data_t	*wdata, **pwdata = &item->windows;
+	const zbx_timespec_t	*last;
+	int			windows_num = 0;
 
-	if (0 == count)
+	while (NULL != (wdata = *pwdata))
 	{
-		if (0 > (range_start = ts->sec - seconds))
-			range_start = 0;
-
-		if (FAIL == (ret = vch_item_cache_values_by_time(&item, range_start)))
-			goto out;
-
-		records_read = ret;
+		if (SUCCEED == vc_window_compare(&wdata->window, window))
+		{
+			if (SUCCEED == vc_window_is_cached(item, &wdata->left))
+			{
+				wdata->last_used = now;
+				return;
+			}
 
-		vch_item_get_values_by_time(item, values, seconds, ts);
+			*pwdata = wdata->next;
+			vc_window_free(wdata);
+			continue;
+		}
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
+		windows_num++;
+		pwdata = &wdata->next;
 	}
-	else
-	{
-		range_start = (0 == seconds ? 0 : ts->sec - seconds);
 
-		if (FAIL == (ret = vch_item_cache_values_by_time_and_count(&item, range_start, count, ts)))
-			goto out;
+	if (ZBX_VC_WINDOWS_MAX <= windows_num || ZBX_VC_MODE_NORMAL != vc_cache->mode || NULL == item->head)
+		return;
 
-		records_read = ret;
+	/* windows can be used only by requests including the newest value */
+	last = &vch_chunk_last(item->head)->timestamp;
 
-		vch_item_get_values_by_time_and_count(item, values, seconds, count, ts);
+	if (ts < last->sec)
+		return;
 
-		if (records_read > values->values_num)
-			records_read = values->values_num;
-	}
+	if (NULL == (wdata = (zbx_vc_window_data_t *)vc_item_malloc(item, sizeof(zbx_vc_window_data_t))))
+		return;
 
-	hits = values->values_num - records_read;
-	misses = records_read;
+	memset(wdata, 0, sizeof(zbx_vc_window_data_t));
+	wdata->window = *window;
+	wdata->left.sec = last->sec - window->seconds;
+	wdata->left.ns = last->ns;
+	wdata->last_used = now;
 
-	vc_cache_item_update(item->itemid, ZBX_VC_UPDATE_STATS, hits, misses);
+	if (SUCCEED != vc_window_is_cached(item, &wdata->left) || SUCCEED != vc_window_rebuild(item, wdata))
+	{
+		vc_window_free(wdata);
+		return;
+	}
 
-	ret = SUCCEED;
-out:
-	return ret;
+	wdata->next = item->windows;
+	item->windows = wdata;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: frees resources allocated for item history data                   *
+ * Purpose: gets window aggregate for period ending after the newest value    *
  *                                                                            *
- * Parameters: item    - [IN] the item                                        *
+ * Parameters: item       - [IN] the item                                     *
+ *             wdata      - [IN] the window                                   *
+ *             start      - [IN] the period start timestamp (exclusive), not  *
+ *                               older than window left timestamp             *
+ *             value      - [OUT] the aggregate value                         *
+ *             values_num - [OUT] the number of values in period              *
  *                                                                            *
- * Return value: the size of freed memory (bytes)                             *
+ * Comments: Values between window left timestamp and period start are        *
+ *           excluded without modifying window.                               *
  *                                                                            *
  ******************************************************************************/
-static size_t	vch_item_free_cache(zbx_vc_item_t *item)
+static void	vc_window_get_value(zbx_vc_item_t *item, zbx_vc_window_data_t *wdata, const zbx_timespec_t *start,
+		zbx_history_value_t *value, int *values_num)
 {
-	size_t	freed = 0;
+	zbx_vc_window_aggr_t	aggr = wdata->aggr;
+	vc_window_walk_t	walk = {.item = item, .wdata = wdata, .aggr = &aggr, .ret = SUCCEED};
+	int			i;
 
-	zbx_vc_chunk_t	*chunk = item->tail;
+	if (0 < zbx_timespec_compare(start, &wdata->left))
+		vch_item_walk_range(item, &wdata->left, start, vc_window_remove_values, &walk);
 
-	while (NULL != chunk)
+	switch (wdata->window.type)
 	{
-		zbx_vc_chunk_t	*next = chunk->next;
-
-		freed += vch_item_free_chunk(item, chunk);
-		chunk = next;
+		case ZBX_VC_WINDOW_SUM:
+			if (ITEM_VALUE_TYPE_FLOAT != item->value_type)
+			{
+				value->ui64 = aggr.sum.ui64;
+				break;
+			}
+			ZBX_FALLTHROUGH;
+		case ZBX_VC_WINDOW_AVG:
+			/* drop rounding errors left after subtracting all values */
+			value->dbl = (0 != aggr.values_num ? aggr.sum.dbl + aggr.sum_comp : 0);
+			break;
+		case ZBX_VC_WINDOW_COUNT:
+			value->ui64 = (zbx_uint64_t)aggr.count;
+			break;
+		default:
+			for (i = 0; i < wdata->deque_num; i++)
+			{
+				if (0 < zbx_timespec_compare(&VC_WINDOW_DEQUE(wdata, i).timestamp, start))
+				{
+					*value = VC_WINDOW_DEQUE(wdata, i).value;
+					break;
+				}
+			}
 	}
-	item->values_total = 0;
-	item->head = NULL;
-	item->tail = NULL;
 
-	return freed;
+	*values_num = aggr.values_num;
 }
 
 /******************************************************************************************************************
@@ -2285,8 +4069,12 @@ static size_t	vch_item_free_cache(zbx_vc_item_t *item)
  *                                                                            *
  * Purpose: initializes value cache                                           *
  *                                                                            *
+ * Parameters: value_cache_size - [IN] the value cache size                   *
+ *             flags            - [IN] ZBX_VC_FLAG_* flags                    *
+ *             error            - [OUT] the error message                     *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
+int	zbx_vc_init(zbx_uint64_t value_cache_size, unsigned char flags, char **error)
 {
 	zbx_uint64_t	size_reserved;
 	int		ret = FAIL;
@@ -2320,7 +4108,7 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 
 	zbx_hashset_create_ext(&vc_cache->items, VC_ITEMS_INIT_SIZE,
 			ZBX_DEFAULT_ID_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+			__vc_shmem_malloc_func, vc_items_realloc_func, vc_mem_free_func);
 
 	if (NULL == vc_cache->items.slots)
 	{
@@ -2330,7 +4118,7 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 
 	zbx_hashset_create_ext(&vc_cache->strpool, VC_STRPOOL_INIT_SIZE,
 			vc_strpool_hash_func, vc_strpool_compare_func, NULL,
-			__vc_shmem_malloc_func, __vc_shmem_realloc_func, __vc_shmem_free_func);
+			__vc_shmem_malloc_func, __vc_shmem_realloc_func, vc_mem_free_func);
 
 	if (NULL == vc_cache->strpool.slots)
 	{
@@ -2338,6 +4126,30 @@ int	zbx_vc_init(zbx_uint64_t value_cache_size, char **error)
 		goto out;
 	}
 
+	if (0 != (flags & ZBX_VC_FLAG_COMPRESSION))
+		vc_cache->compression = 1;
+
+	if (0 != (flags & ZBX_VC_FLAG_LOCKFREE_READS))
+	{
+#if defined(ZBX_VC_LOCKFREE)
+		if (NULL == (vc_cache->readers = (zbx_vc_reader_t *)__vc_shmem_malloc_func(NULL,
+				sizeof(zbx_vc_reader_t) * ZBX_VC_READERS_MAX)))
+		{
+			*error = zbx_strdup(*error, "cannot allocate value cache lock-free reader slots");
+			goto out;
+		}
+
+		memset(vc_cache->readers, 0, sizeof(zbx_vc_reader_t) * ZBX_VC_READERS_MAX);
+		atomic_init(&vc_cache->seq, 0);
+		atomic_init(&vc_cache->epoch, 1);
+		vc_cache->lockfree = 1;
+		vc_lockfree_publish_index();
+#else
+		zabbix_log(LOG_LEVEL_WARNING, "lock-free value cache reads are not supported on this platform,"
+				" ignoring ValueCacheLockFreeReads parameter");
+#endif
+	}
+
 	/* the free space request should be 5% of cache size, but no more than 128KB */
 	vc_cache->min_free_request = (value_cache_size / 100) * 5;
 	if (vc_cache->min_free_request > 128 * ZBX_KIBIBYTE)
@@ -2368,6 +4180,21 @@ void	zbx_vc_destroy(void)
 	{
 		zbx_vector_vc_itemupdate_destroy(&vc_itemupdates);
 
+#if defined(ZBX_VC_LOCKFREE)
+		if (0 != vc_cache->lockfree)
+		{
+			vc_lockfree_synchronize();
+			vc_cache->lockfree = 0;
+
+			if (NULL != vc_cache->items_index)
+				__vc_shmem_free_func(vc_cache->items_index);
+
+			if (NULL != vc_cache->retired)
+				__vc_shmem_free_func(vc_cache->retired);
+
+			__vc_shmem_free_func(vc_cache->readers);
+		}
+#endif
 		zbx_hashset_destroy(&vc_cache->items);
 		zbx_hashset_destroy(&vc_cache->strpool);
 
@@ -2458,7 +4285,7 @@ static int	vc_is_value_type_supported(unsigned char value_type)
 int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_err)
 {
 	zbx_vc_item_t		*item;
-	int			i;
+	int			i, now;
 	zbx_dc_history_t	*h;
 
 	if (SUCCEED != zbx_history_add_values(history, flush_err))
@@ -2467,6 +4294,8 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_
 	if (ZBX_VC_DISABLED == vc_state)
 		return SUCCEED;
 
+	now = (int)time(NULL);
+
 	WRLOCK_CACHE;
 
 	for (i = 0; i < history->values_num; i++)
@@ -2503,7 +4332,7 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_
 			int			last_value_timestamp;
 
 			if (NULL != head)
-				last_value_timestamp = head->slots[head->last_value].timestamp.sec;
+				last_value_timestamp = vch_chunk_last(head)->timestamp.sec;
 			else
 				last_value_timestamp = (int)time(NULL);
 
@@ -2513,6 +4342,13 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_
 			/* Also remove item if the value adding failed. In this case we             */
 			/* won't have the latest data in cache - so the requests must go directly   */
 			/* to the database.                                                         */
+			/* values added out of order change the aggregated window values */
+			if (NULL != item->windows && NULL != head &&
+					0 < zbx_history_record_compare_asc(vch_chunk_last(head), &record))
+			{
+				vc_item_free_windows(item);
+			}
+
 			if (item->value_type != h->entry.value_type ||
 					FAIL == vch_item_add_value_at_head(item, &record))
 			{
@@ -2520,6 +4356,9 @@ int	zbx_vc_add_values(zbx_vector_dc_history_ptr_t *history, zbx_uint64_t *flush_
 				continue;
 			}
 
+			if (NULL != item->windows)
+				vc_item_update_windows(item, &record, now);
+
 			/* try to remove old (unused) chunks if a new chunk was added */
 			if (head != item->head)
 				vch_item_clean_cache(item, last_value_timestamp);
@@ -2963,6 +4802,13 @@ int	zbx_vc_get_values(zbx_uint64_t itemid, unsigned char value_type, zbx_vector_
 	else
 		zbx_vector_history_record_reserve(values, 8);
 
+	if (ZBX_VC_DISABLED != vc_state && SUCCEED == vc_lockfree_get_values(itemid, value_type, values, seconds,
+			count, ts))
+	{
+		ret = SUCCEED;
+		goto finish;
+	}
+
 	RDLOCK_CACHE;
 
 	if (ZBX_VC_DISABLED == vc_state)
@@ -3002,13 +4848,216 @@ out:
 	}
 
 	UNLOCK_CACHE;
-
+finish:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
 			__func__, zbx_result_string(ret), values->values_num, cache_used);
 
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reduce item history data with the specified reducer               *
+ *                                                                            *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             value_type  - [IN] the item value type                         *
+ *             seconds     - [IN] the time period to reduce data for          *
+ *             count       - [IN] the number of history values to reduce      *
+ *             ts          - [IN] the period end timestamp                    *
+ *             reduce_func - [IN] the reducer                                 *
+ *             data        - [IN] the reducer data                            *
+ *                                                                            *
+ * Return value:  SUCCEED - the item history data was reduced successfully    *
+ *                FAIL    - the item history data was not retrieved           *
+ *                                                                            *
+ * Comments: The reducer gets the same values zbx_vc_get_values() would       *
+ *           return, without copying them out of cache. The values are passed *
+ *           in spans of records sorted in ascending order, while the spans   *
+ *           are passed in descending order - the newest values first.        *
+ *                                                                            *
+ *           The reducer is called with cache locked and records referencing  *
+ *           cache memory, so it must not access value cache nor keep record  *
+ *           pointers.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_reduce_values(zbx_uint64_t itemid, unsigned char value_type, int seconds, int count,
+		const zbx_timespec_t *ts, zbx_vc_reduce_func_t reduce_func, void *data)
+{
+	zbx_vc_item_t			*item, new_item;
+	zbx_vector_history_record_t	values;
+	int				ret = FAIL, cache_used = 1, values_num = 0, i;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() itemid:" ZBX_FS_UI64 " value_type:%d count:%d period:%d end_timestamp"
+			" '%s'", __func__, itemid, value_type, count, seconds, zbx_timespec_str(ts));
+
+	if (SUCCEED != vc_is_value_type_supported(value_type))
+		return FAIL;
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (ZBX_VC_MODE_LOWMEM == vc_cache->mode)
+		vc_warn_low_memory();
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		if (ZBX_VC_MODE_NORMAL != vc_cache->mode)
+			goto out;
+
+		memset(&new_item, 0, sizeof(new_item));
+		new_item.itemid = itemid;
+		new_item.value_type = value_type;
+		item = &new_item;
+	}
+	else if (item->value_type != value_type)
+		goto out;
+
+	ret = vch_item_reduce_values(item, seconds, count, ts, reduce_func, data, &values_num);
+out:
+	if (FAIL == ret)
+	{
+		cache_used = 0;
+
+		UNLOCK_CACHE;
+
+		zbx_history_record_vector_create(&values);
+
+		if (SUCCEED == (ret = vc_db_get_values(itemid, value_type, &values, seconds, count, ts)))
+		{
+			/* database values are sorted in descending order, pass them one by one */
+			for (i = 0; i < values.values_num; i++)
+				reduce_func(&values.values[i], 1, data);
+
+			values_num = values.values_num;
+		}
+
+		zbx_history_record_vector_destroy(&values, value_type);
+
+		WRLOCK_CACHE;
+
+		if (ZBX_VC_DISABLED != vc_state)
+			vc_remove_item_by_id(itemid);
+
+		if (SUCCEED == ret)
+			vc_update_statistics(NULL, 0, values_num, (int)time(NULL));
+	}
+
+	UNLOCK_CACHE;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s count:%d cached:%d",
+			__func__, zbx_result_string(ret), values_num, cache_used);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets incrementally maintained aggregate of item values in time    *
+ *          window                                                            *
+ *                                                                            *
+ * Parameters: itemid     - [IN] the item id                                  *
+ *             value_type - [IN] the item value type                          *
+ *             window     - [IN] the window                                   *
+ *             ts         - [IN] the window end timestamp                     *
+ *             value      - [OUT] the aggregate value:                        *
+ *                                 sum - the sum of values                    *
+ *                                 avg - the floating point sum of values     *
+ *                                 min, max - the minimum, maximum value,     *
+ *                                            unset if there are no values    *
+ *                                 count - the number of matching values      *
+ *             values_num - [OUT] the number of values in window              *
+ *                                                                            *
+ * Return value:  SUCCEED - the aggregate was retrieved                       *
+ *                FAIL    - the window is not maintained by cache or the      *
+ *                          floating point sum overflowed                     *
+ *                                                                            *
+ * Comments: The window is registered by the first request and maintained     *
+ *           from the next cache statistics flush, so the caller must         *
+ *           calculate aggregate from history values when FAIL is returned.   *
+ *           Windows cover values up to the newest cached value, so only      *
+ *           requests ending at or after the newest value can be served.      *
+ *           Floating point sums are maintained with Neumaier compensated     *
+ *           summation, so they can differ in the last bits from sequential   *
+ *           summation of the same values (usually being more precise).       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_get_window_value(zbx_uint64_t itemid, unsigned char value_type, const zbx_vc_window_t *window,
+		const zbx_timespec_t *ts, zbx_history_value_t *value, int *values_num)
+{
+	zbx_vc_item_t		*item;
+	zbx_vc_window_data_t	*wdata;
+	zbx_timespec_t		start;
+	int			ret = FAIL, now, request = 0;
+
+	if ((ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type) || 0 >= window->seconds)
+		return FAIL;
+
+	now = (int)time(NULL);
+
+	RDLOCK_CACHE;
+
+	if (ZBX_VC_DISABLED == vc_state)
+		goto out;
+
+	if (NULL == (item = (zbx_vc_item_t *)zbx_hashset_search(&vc_cache->items, &itemid)))
+	{
+		/* the window is created after the item values are cached by fallback request */
+		request = 1;
+		goto out;
+	}
+
+	if (item->value_type != value_type || NULL == item->head ||
+			0 < zbx_timespec_compare(&vch_chunk_last(item->head)->timestamp, ts))
+	{
+		goto out;
+	}
+
+	request = 1;
+
+	for (wdata = item->windows; NULL != wdata; wdata = wdata->next)
+	{
+		if (SUCCEED == vc_window_compare(&wdata->window, window))
+			break;
+	}
+
+	start.sec = ts->sec - window->seconds;
+	start.ns = ts->ns;
+
+	if (NULL == wdata || SUCCEED != vc_window_is_cached(item, &wdata->left) ||
+			0 > zbx_timespec_compare(&start, &wdata->left))
+	{
+		goto out;
+	}
+
+	vc_window_get_value(item, wdata, &start, value, values_num);
+
+	/* let the caller sum values sequentially if floating point sum overflows */
+	if ((ZBX_VC_WINDOW_AVG == window->type || (ZBX_VC_WINDOW_SUM == window->type &&
+			ITEM_VALUE_TYPE_FLOAT == value_type)) && 0 == isfinite(value->dbl))
+	{
+		goto out;
+	}
+
+	/* update window request time with reduced precision to avoid flushing it after every request */
+	if (ZBX_VC_WINDOW_TOUCH_PERIOD > now - wdata->last_used)
+		request = 0;
+
+	/* add another second to include nanosecond shifts */
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_RANGE, window->seconds + now - ts->sec + 1, now);
+	vc_cache_item_update(itemid, ZBX_VC_UPDATE_STATS, *values_num, 0);
+
+	ret = SUCCEED;
+out:
+	if (0 != request)
+		vc_cache_window_update(itemid, window, ts->sec, now);
+
+	UNLOCK_CACHE;
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: get the last history value with a timestamp less or equal to the  *
@@ -3224,6 +5273,10 @@ void	zbx_vc_flush_stats(void)
 				vc_update_statistics(item, update->data[ZBX_VC_UPDATE_STATS_HITS],
 						update->data[ZBX_VC_UPDATE_STATS_MISSES], now);
 				break;
+			case ZBX_VC_UPDATE_WINDOW:
+				vc_item_use_window(item, &update->window, update->data[ZBX_VC_UPDATE_WINDOW_TS],
+						update->data[ZBX_VC_UPDATE_WINDOW_NOW]);
+				break;
 		}
 	}
 
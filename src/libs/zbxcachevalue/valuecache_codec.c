@@ -0,0 +1,479 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "valuecache_codec.h"
+
+#include "zbxcommon.h"
+
+/*
+ * Gorilla style encoding of numeric item history values.
+ *
+ * The first value is stored raw - 32 bits of timestamp seconds, 30 bits of nanoseconds and
+ * 64 bits of value. The following values are stored as:
+ *   timestamp seconds     - zigzag encoded delta-of-delta in variable length bucket
+ *   timestamp nanoseconds - '0' if not changed, otherwise '1' followed by raw 30 bits
+ *   float value           - XOR with previous value:
+ *                           '0'  - the value is not changed
+ *                           '10' - meaningful XOR bits fit into previous leading/trailing zero window
+ *                           '11' - 5 bits of leading zeros, 6 bits of meaningful bit count and
+ *                                  the meaningful bits
+ *   unsigned value        - zigzag encoded delta-of-delta in variable length bucket
+ *
+ * The variable length bucket is '0' for zero value, otherwise '10', '110', '1110' or '1111'
+ * prefix followed by value of the corresponding bucket width.
+ */
+
+#define VC_CODEC_NS_BITS	30
+
+static const int	vc_codec_sec_widths[] = {7, 9, 12, 32};
+static const int	vc_codec_ui64_widths[] = {8, 16, 32, 64};
+
+typedef struct
+{
+	unsigned char	*data;
+
+	/* the buffer size in bits */
+	size_t		size;
+
+	/* the number of written bits */
+	size_t		pos;
+}
+vc_codec_writer_t;
+
+static int	vc_codec_write_bits(vc_codec_writer_t *writer, zbx_uint64_t value, int bits)
+{
+	if (writer->pos + (size_t)bits > writer->size)
+		return FAIL;
+
+	while (0 < bits)
+	{
+		unsigned char	*byte = writer->data + (writer->pos >> 3);
+		int		offset = (int)(writer->pos & 7), n = MIN(8 - offset, bits);
+		unsigned char	part = (unsigned char)((value >> (bits - n)) & ((1u << n) - 1));
+
+		if (0 == offset)
+			*byte = 0;
+
+		*byte |= (unsigned char)(part << (8 - offset - n));
+		writer->pos += (size_t)n;
+		bits -= n;
+	}
+
+	return SUCCEED;
+}
+
+static int	vc_codec_read_bits(zbx_vc_codec_reader_t *reader, int bits, zbx_uint64_t *value)
+{
+	zbx_uint64_t	result = 0;
+
+	if (reader->pos + (size_t)bits > reader->size)
+		return FAIL;
+
+	while (0 < bits)
+	{
+		unsigned char	byte = reader->data[reader->pos >> 3];
+		int		offset = (int)(reader->pos & 7), n = MIN(8 - offset, bits);
+
+		result = (result << n) | (zbx_uint64_t)((byte >> (8 - offset - n)) & ((1u << n) - 1));
+		reader->pos += (size_t)n;
+		bits -= n;
+	}
+
+	*value = result;
+
+	return SUCCEED;
+}
+
+static zbx_uint64_t	vc_codec_zigzag_encode(zbx_int64_t value)
+{
+	return 0 > value ? ~((zbx_uint64_t)value << 1) : (zbx_uint64_t)value << 1;
+}
+
+static zbx_int64_t	vc_codec_zigzag_decode(zbx_uint64_t value)
+{
+	return (zbx_int64_t)((value >> 1) ^ (~(value & 1) + 1));
+}
+
+static int	vc_codec_write_bucket(vc_codec_writer_t *writer, zbx_uint64_t value, const int *widths)
+{
+	static const zbx_uint64_t	prefixes[] = {0x2, 0x6, 0xe, 0xf};
+	static const int		prefix_bits[] = {2, 3, 4, 4};
+	int				i;
+
+	if (0 == value)
+		return vc_codec_write_bits(writer, 0, 1);
+
+	for (i = 0; i < 3; i++)
+	{
+		if (value < ((zbx_uint64_t)1 << widths[i]))
+			break;
+	}
+
+	if (SUCCEED != vc_codec_write_bits(writer, prefixes[i], prefix_bits[i]))
+		return FAIL;
+
+	return vc_codec_write_bits(writer, value, widths[i]);
+}
+
+static int	vc_codec_read_bucket(zbx_vc_codec_reader_t *reader, const int *widths, zbx_uint64_t *value)
+{
+	zbx_uint64_t	bit;
+	int		i;
+
+	for (i = 0; i < 4; i++)
+	{
+		if (SUCCEED != vc_codec_read_bits(reader, 1, &bit))
+			return FAIL;
+
+		if (0 == bit)
+			break;
+	}
+
+	if (0 == i)
+	{
+		*value = 0;
+		return SUCCEED;
+	}
+
+	return vc_codec_read_bits(reader, widths[i - 1], value);
+}
+
+static int	vc_codec_leading_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & ((zbx_uint64_t)1 << 63)))
+	{
+		value <<= 1;
+		n++;
+	}
+
+	return n;
+}
+
+static int	vc_codec_trailing_zeros(zbx_uint64_t value)
+{
+	int	n = 0;
+
+	while (0 == (value & 1))
+	{
+		value >>= 1;
+		n++;
+	}
+
+	return n;
+}
+
+static zbx_uint64_t	vc_codec_value_bits(const zbx_history_value_t *value, unsigned char value_type)
+{
+	zbx_uint64_t	bits;
+
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		memcpy(&bits, &value->dbl, sizeof(bits));
+	else
+		bits = value->ui64;
+
+	return bits;
+}
+
+static void	vc_codec_set_value_bits(zbx_history_value_t *value, unsigned char value_type, zbx_uint64_t bits)
+{
+	if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		memcpy(&value->dbl, &bits, sizeof(bits));
+	else
+		value->ui64 = bits;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: encodes numeric history values                                    *
+ *                                                                            *
+ * Parameters: values     - [IN] the values to encode, sorted by timestamp    *
+ *             values_num - [IN] the number of values                         *
+ *             value_type - [IN] ITEM_VALUE_TYPE_FLOAT or                     *
+ *                               ITEM_VALUE_TYPE_UINT64                       *
+ *             data       - [OUT] the encoded data                            *
+ *             size       - [IN] the output buffer size                       *
+ *                                                                            *
+ * Return value: The encoded data size or 0 if values did not fit in buffer.  *
+ *                                                                            *
+ ******************************************************************************/
+size_t	zbx_vc_codec_encode(const zbx_history_record_t *values, int values_num, unsigned char value_type,
+		unsigned char *data, size_t size)
+{
+	vc_codec_writer_t	writer = {.data = data, .size = size * 8};
+	int			i, delta_sec = 0, leading = -1, trailing = 0;
+	zbx_uint64_t		delta_ui64 = 0;
+
+	if (0 == values_num)
+		return 0;
+
+	if (SUCCEED != vc_codec_write_bits(&writer, (zbx_uint32_t)values[0].timestamp.sec, 32) ||
+			SUCCEED != vc_codec_write_bits(&writer, (zbx_uint64_t)values[0].timestamp.ns,
+					VC_CODEC_NS_BITS) ||
+			SUCCEED != vc_codec_write_bits(&writer, vc_codec_value_bits(&values[0].value, value_type), 64))
+	{
+		return 0;
+	}
+
+	for (i = 1; i < values_num; i++)
+	{
+		const zbx_history_record_t	*last = &values[i - 1], *value = &values[i];
+		zbx_uint64_t			bits, last_bits;
+		int				delta;
+
+		delta = value->timestamp.sec - last->timestamp.sec;
+
+		if (SUCCEED != vc_codec_write_bucket(&writer,
+				vc_codec_zigzag_encode((zbx_int64_t)delta - delta_sec), vc_codec_sec_widths))
+		{
+			return 0;
+		}
+
+		delta_sec = delta;
+
+		if (value->timestamp.ns == last->timestamp.ns)
+		{
+			if (SUCCEED != vc_codec_write_bits(&writer, 0, 1))
+				return 0;
+		}
+		else
+		{
+			if (SUCCEED != vc_codec_write_bits(&writer, 1, 1) || SUCCEED != vc_codec_write_bits(&writer,
+					(zbx_uint64_t)value->timestamp.ns, VC_CODEC_NS_BITS))
+			{
+				return 0;
+			}
+		}
+
+		bits = vc_codec_value_bits(&value->value, value_type);
+		last_bits = vc_codec_value_bits(&last->value, value_type);
+
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+		{
+			zbx_uint64_t	xor = bits ^ last_bits;
+			int		lead, trail;
+
+			if (0 == xor)
+			{
+				if (SUCCEED != vc_codec_write_bits(&writer, 0, 1))
+					return 0;
+
+				continue;
+			}
+
+			if (31 < (lead = vc_codec_leading_zeros(xor)))
+				lead = 31;
+
+			trail = vc_codec_trailing_zeros(xor);
+
+			if (-1 != leading && lead >= leading && trail >= trailing)
+			{
+				if (SUCCEED != vc_codec_write_bits(&writer, 2, 2) || SUCCEED != vc_codec_write_bits(&writer,
+						xor >> trailing, 64 - leading - trailing))
+				{
+					return 0;
+				}
+
+				continue;
+			}
+
+			if (SUCCEED != vc_codec_write_bits(&writer, 3, 2) ||
+					SUCCEED != vc_codec_write_bits(&writer, (zbx_uint64_t)lead, 5) ||
+					SUCCEED != vc_codec_write_bits(&writer, (zbx_uint64_t)(63 - lead - trail), 6) ||
+					SUCCEED != vc_codec_write_bits(&writer, xor >> trail, 64 - lead - trail))
+			{
+				return 0;
+			}
+
+			leading = lead;
+			trailing = trail;
+		}
+		else
+		{
+			zbx_uint64_t	delta_value = bits - last_bits;
+
+			if (SUCCEED != vc_codec_write_bucket(&writer,
+					vc_codec_zigzag_encode((zbx_int64_t)(delta_value - delta_ui64)),
+					vc_codec_ui64_widths))
+			{
+				return 0;
+			}
+
+			delta_ui64 = delta_value;
+		}
+	}
+
+	return (writer.pos + 7) >> 3;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes encoded value stream reader                           *
+ *                                                                            *
+ * Parameters: reader     - [OUT] the reader                                  *
+ *             data       - [IN] the encoded data                             *
+ *             size       - [IN] the encoded data size                        *
+ *             value_type - [IN] the value type                               *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_vc_codec_reader_init(zbx_vc_codec_reader_t *reader, const unsigned char *data, size_t size,
+		unsigned char value_type)
+{
+	memset(reader, 0, sizeof(zbx_vc_codec_reader_t));
+
+	reader->data = data;
+	reader->size = size * 8;
+	reader->value_type = value_type;
+	reader->leading = -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes next value from encoded value stream                      *
+ *                                                                            *
+ * Parameters: reader - [IN/OUT] the reader                                   *
+ *             value  - [OUT] the decoded value                               *
+ *                                                                            *
+ * Return value: SUCCEED - the value was decoded                              *
+ *               FAIL    - end of data or malformed data                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_codec_reader_next(zbx_vc_codec_reader_t *reader, zbx_history_record_t *value)
+{
+	zbx_uint64_t	bits, flag;
+
+	if (0 == reader->values_num)
+	{
+		zbx_uint64_t	sec, ns;
+
+		if (SUCCEED != vc_codec_read_bits(reader, 32, &sec) ||
+				SUCCEED != vc_codec_read_bits(reader, VC_CODEC_NS_BITS, &ns) ||
+				SUCCEED != vc_codec_read_bits(reader, 64, &bits))
+		{
+			return FAIL;
+		}
+
+		reader->last.timestamp.sec = (int)(zbx_uint32_t)sec;
+		reader->last.timestamp.ns = (int)ns;
+		vc_codec_set_value_bits(&reader->last.value, reader->value_type, bits);
+	}
+	else
+	{
+		zbx_uint64_t	last_bits;
+
+		if (SUCCEED != vc_codec_read_bucket(reader, vc_codec_sec_widths, &bits))
+			return FAIL;
+
+		reader->delta_sec += (int)vc_codec_zigzag_decode(bits);
+		reader->last.timestamp.sec += reader->delta_sec;
+
+		if (SUCCEED != vc_codec_read_bits(reader, 1, &flag))
+			return FAIL;
+
+		if (0 != flag)
+		{
+			if (SUCCEED != vc_codec_read_bits(reader, VC_CODEC_NS_BITS, &bits))
+				return FAIL;
+
+			reader->last.timestamp.ns = (int)bits;
+		}
+
+		last_bits = vc_codec_value_bits(&reader->last.value, reader->value_type);
+
+		if (ITEM_VALUE_TYPE_FLOAT == reader->value_type)
+		{
+			if (SUCCEED != vc_codec_read_bits(reader, 1, &flag))
+				return FAIL;
+
+			if (0 != flag)
+			{
+				zbx_uint64_t	xor;
+
+				if (SUCCEED != vc_codec_read_bits(reader, 1, &flag))
+					return FAIL;
+
+				if (0 != flag)
+				{
+					zbx_uint64_t	lead, meaningful;
+
+					if (SUCCEED != vc_codec_read_bits(reader, 5, &lead) ||
+							SUCCEED != vc_codec_read_bits(reader, 6, &meaningful))
+					{
+						return FAIL;
+					}
+
+					if (64 < lead + meaningful + 1)
+						return FAIL;
+
+					reader->leading = (int)lead;
+					reader->trailing = 63 - (int)lead - (int)meaningful;
+				}
+				else if (-1 == reader->leading)
+					return FAIL;
+
+				if (SUCCEED != vc_codec_read_bits(reader, 64 - reader->leading - reader->trailing, &xor))
+					return FAIL;
+
+				last_bits ^= xor << reader->trailing;
+			}
+		}
+		else
+		{
+			if (SUCCEED != vc_codec_read_bucket(reader, vc_codec_ui64_widths, &bits))
+				return FAIL;
+
+			reader->delta_ui64 += (zbx_uint64_t)vc_codec_zigzag_decode(bits);
+			last_bits += reader->delta_ui64;
+		}
+
+		vc_codec_set_value_bits(&reader->last.value, reader->value_type, last_bits);
+	}
+
+	reader->values_num++;
+	*value = reader->last;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes numeric history values                                    *
+ *                                                                            *
+ * Parameters: data       - [IN] the encoded data                             *
+ *             size       - [IN] the encoded data size                        *
+ *             value_type - [IN] the value type                               *
+ *             values     - [OUT] the decoded values                          *
+ *             values_num - [IN] the number of values to decode               *
+ *                                                                            *
+ * Return value: SUCCEED - the values were decoded                            *
+ *               FAIL    - malformed data                                     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_vc_codec_decode(const unsigned char *data, size_t size, unsigned char value_type,
+		zbx_history_record_t *values, int values_num)
+{
+	zbx_vc_codec_reader_t	reader;
+	int			i;
+
+	zbx_vc_codec_reader_init(&reader, data, size, value_type);
+
+	for (i = 0; i < values_num; i++)
+	{
+		if (SUCCEED != zbx_vc_codec_reader_next(&reader, &values[i]))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
@@ -0,0 +1,53 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_VALUECACHE_CODEC_H
+#define ZABBIX_VALUECACHE_CODEC_H
+
+#include "zbxhistory.h"
+
+/* the packed value stream reader, values are decoded one by one */
+typedef struct
+{
+	const unsigned char	*data;
+
+	/* the data size and read position in bits */
+	size_t			size;
+	size_t			pos;
+
+	unsigned char		value_type;
+
+	/* the number of decoded values */
+	int			values_num;
+
+	/* the last decoded value and deltas used to decode next value */
+	zbx_history_record_t	last;
+	int			delta_sec;
+	zbx_uint64_t		delta_ui64;
+	int			leading;
+	int			trailing;
+}
+zbx_vc_codec_reader_t;
+
+size_t	zbx_vc_codec_encode(const zbx_history_record_t *values, int values_num, unsigned char value_type,
+		unsigned char *data, size_t size);
+
+void	zbx_vc_codec_reader_init(zbx_vc_codec_reader_t *reader, const unsigned char *data, size_t size,
+		unsigned char value_type);
+int	zbx_vc_codec_reader_next(zbx_vc_codec_reader_t *reader, zbx_history_record_t *value);
+
+int	zbx_vc_codec_decode(const unsigned char *data, size_t size, unsigned char value_type,
+		zbx_history_record_t *values, int values_num);
+
+#endif
@@ -16,6 +16,7 @@
 
 #include "eval.h"
 #include "funcparam.h"
+#include "funcreduce.h"
 #include "anomalystl.h"
 
 #include "zbxvariant.h"
@@ -1267,47 +1268,71 @@ static int	evaluate_COUNT(zbx_variant_t *value, const zbx_dc_evaluate_item_t *it
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (COUNT_ALL == unique && SUCCEED == func_reduce_count_supported(&pdata, item->value_type))
 	{
-		*error = zbx_strdup(*error, "cannot get values from value cache");
-		goto clean;
-	}
+		func_reduce_t	reduce;
+		int		reduced;
 
-	if (COUNT_UNIQUE == unique)
-	{
-		switch (item->value_type)
-		{
-			case ITEM_VALUE_TYPE_UINT64:
-				zbx_vector_history_record_sort(&values, history_record_uint64_compare);
-				zbx_vector_history_record_uniq(&values, history_record_uint64_compare);
-				break;
-			case ITEM_VALUE_TYPE_FLOAT:
-				zbx_vector_history_record_sort(&values, history_record_float_compare);
-				zbx_vector_history_record_uniq(&values, history_record_float_compare);
-				break;
-			case ITEM_VALUE_TYPE_LOG:
-				zbx_vector_history_record_sort(&values, history_record_log_compare);
-				zbx_vector_history_record_log_uniq(&values, history_record_log_compare);
-				break;
-			default:
-				zbx_vector_history_record_sort(&values, history_record_str_compare);
-				zbx_vector_history_record_str_uniq(&values, history_record_str_compare);
-		}
-	}
+		func_reduce_init(&reduce, item->value_type);
+		reduce.pdata = &pdata;
+		reduce.limit = limit;
 
-	/* skip counting values one by one if filter matches any value */
-	if (OP_ANY != pdata.op)
-	{
-		if (FAIL == zbx_execute_count_with_pattern(pattern, item->value_type, &pdata, &values, limit, &count,
-				error))
+		reduced = func_reduce_values(item->itemid, seconds, nvalues, &ts_end, ZBX_VC_WINDOW_COUNT,
+				func_reduce_count, &reduce);
+		count = reduce.count;
+
+		func_reduce_clear(&reduce);
+
+		if (FAIL == reduced)
 		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
 			goto clean;
 		}
 	}
 	else
 	{
-		if ((count = values.values_num) > limit)
-			count = limit;
+		if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+		{
+			*error = zbx_strdup(*error, "cannot get values from value cache");
+			goto clean;
+		}
+
+		if (COUNT_UNIQUE == unique)
+		{
+			switch (item->value_type)
+			{
+				case ITEM_VALUE_TYPE_UINT64:
+					zbx_vector_history_record_sort(&values, history_record_uint64_compare);
+					zbx_vector_history_record_uniq(&values, history_record_uint64_compare);
+					break;
+				case ITEM_VALUE_TYPE_FLOAT:
+					zbx_vector_history_record_sort(&values, history_record_float_compare);
+					zbx_vector_history_record_uniq(&values, history_record_float_compare);
+					break;
+				case ITEM_VALUE_TYPE_LOG:
+					zbx_vector_history_record_sort(&values, history_record_log_compare);
+					zbx_vector_history_record_log_uniq(&values, history_record_log_compare);
+					break;
+				default:
+					zbx_vector_history_record_sort(&values, history_record_str_compare);
+					zbx_vector_history_record_str_uniq(&values, history_record_str_compare);
+			}
+		}
+
+		/* skip counting values one by one if filter matches any value */
+		if (OP_ANY != pdata.op)
+		{
+			if (FAIL == zbx_execute_count_with_pattern(pattern, item->value_type, &pdata, &values, limit,
+					&count, error))
+			{
+				goto clean;
+			}
+		}
+		else
+		{
+			if ((count = values.values_num) > limit)
+				count = limit;
+		}
 	}
 
 	zbx_variant_set_dbl(value, count);
@@ -1345,14 +1370,13 @@ out:
 static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, zbx_history_selector_t *selector, char **error)
 {
-	int				i, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_vector_history_record_t	values;
-	zbx_history_value_t		result;
-	zbx_timespec_t			ts_end = *ts;
+	int		ret = FAIL, seconds = 0, nvalues = 0;
+	func_reduce_t	reduce;
+	zbx_timespec_t	ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	func_reduce_init(&reduce, item->value_type);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1393,31 +1417,17 @@ static int	evaluate_SUM(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == func_reduce_values(item->itemid, seconds, nvalues, &ts_end, ZBX_VC_WINDOW_SUM, func_reduce_sum,
+			&reduce))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-	{
-		result.dbl = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.dbl += values.values[i].value.dbl;
-	}
-	else
-	{
-		result.ui64 = 0;
-
-		for (i = 0; i < values.values_num; i++)
-			result.ui64 += values.values[i].value.ui64;
-	}
-
-	zbx_history_value2variant(&result, item->value_type, value);
+	zbx_history_value2variant(&reduce.value, item->value_type, value);
 	ret = SUCCEED;
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	func_reduce_clear(&reduce);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1443,13 +1453,13 @@ out:
 static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, zbx_history_selector_t *selector, char **error)
 {
-	int				ret = FAIL, i, seconds = 0, nvalues = 0;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int		ret = FAIL, seconds = 0, nvalues = 0;
+	func_reduce_t	reduce;
+	zbx_timespec_t	ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	func_reduce_init(&reduce, item->value_type);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1490,28 +1500,20 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		goto out;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == func_reduce_values(item->itemid, seconds, nvalues, &ts_end, ZBX_VC_WINDOW_AVG, func_reduce_avg,
+			&reduce))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < reduce.values_num)
 	{
-		double	avg = 0;
+		double	avg = reduce.value.dbl;
 
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += values.values[i].value.dbl / (i + 1) - avg / (i + 1);
-		}
-		else
-		{
-			for (i = 0; i < values.values_num; i++)
-				avg += (double)values.values[i].value.ui64;
+		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
+			avg = avg / reduce.values_num;
 
-			avg = avg / values.values_num;
-		}
 		zbx_variant_set_dbl(value, avg);
 
 		ret = SUCCEED;
@@ -1522,7 +1524,7 @@ static int	evaluate_AVG(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	func_reduce_clear(&reduce);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1664,17 +1666,6 @@ static int	evaluate_LOGTIMESTAMP(zbx_variant_t *value, const zbx_dc_evaluate_ite
 #define EVALUATE_MIN	0
 #define EVALUATE_MAX	1
 
-#define LOOP_FIND_MIN_OR_MAX(type, mode_op)							\
-	do											\
-	{											\
-		for (i = 1; i < values.values_num; i++)							\
-		{											\
-			if (values.values[i].value.type mode_op values.values[index].value.type)	\
-				index = i;								\
-		}											\
-	}												\
-	while(0)
-
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluate function 'min' or 'max' for the item.                    *
@@ -1695,13 +1686,13 @@ static int	evaluate_LOGTIMESTAMP(zbx_variant_t *value, const zbx_dc_evaluate_ite
 static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, int min_or_max, zbx_history_selector_t *selector, char **error)
 {
-	int				i, ret = FAIL, seconds = 0, nvalues = 0;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int		ret = FAIL, seconds = 0, nvalues = 0, reduced;
+	func_reduce_t	reduce;
+	zbx_timespec_t	ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	func_reduce_init(&reduce, item->value_type);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1742,40 +1733,26 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 			THIS_SHOULD_NEVER_HAPPEN;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (EVALUATE_MIN == min_or_max)
+	{
+		reduced = func_reduce_values(item->itemid, seconds, nvalues, &ts_end, ZBX_VC_WINDOW_MIN, func_reduce_min,
+				&reduce);
+	}
+	else
+	{
+		reduced = func_reduce_values(item->itemid, seconds, nvalues, &ts_end, ZBX_VC_WINDOW_MAX, func_reduce_max,
+				&reduce);
+	}
+
+	if (FAIL == reduced)
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < reduce.values_num)
 	{
-		int	index = 0;
-
-		if (ITEM_VALUE_TYPE_UINT64 == item->value_type)
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(ui64, >);
-			}
-		}
-		else
-		{
-			if (EVALUATE_MIN == min_or_max)
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, <);
-			}
-			else
-			{
-				LOOP_FIND_MIN_OR_MAX(dbl, >);
-			}
-		}
-
-		zbx_history_value2variant(&values.values[index].value, item->value_type, value);
+		zbx_history_value2variant(&reduce.value, item->value_type, value);
 		ret = SUCCEED;
 	}
 	else
@@ -1784,7 +1761,7 @@ static int	evaluate_MIN_or_MAX(zbx_variant_t *value, const zbx_dc_evaluate_item_
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	func_reduce_clear(&reduce);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -1811,14 +1788,14 @@ out:
 static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item_t *item, const char *parameters,
 		const zbx_timespec_t *ts, zbx_history_selector_t *selector, char **error)
 {
-	int				ret = FAIL, seconds = 0, nvalues = 0;
-	double				percentage;
-	zbx_vector_history_record_t	values;
-	zbx_timespec_t			ts_end = *ts;
+	int		ret = FAIL, seconds = 0, nvalues = 0;
+	double		percentage;
+	func_reduce_t	reduce;
+	zbx_timespec_t	ts_end = *ts;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	zbx_history_record_vector_create(&values);
+	func_reduce_init(&reduce, item->value_type);
 
 	if (ITEM_VALUE_TYPE_FLOAT != item->value_type && ITEM_VALUE_TYPE_UINT64 != item->value_type)
 	{
@@ -1866,27 +1843,19 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item
 		goto out;
 	}
 
-	if (FAIL == zbx_vc_get_values(item->itemid, item->value_type, &values, seconds, nvalues, &ts_end))
+	if (FAIL == zbx_vc_reduce_values(item->itemid, item->value_type, seconds, nvalues, &ts_end,
+			func_reduce_collect, &reduce))
 	{
 		*error = zbx_strdup(*error, "cannot get values from value cache");
 		goto out;
 	}
 
-	if (0 < values.values_num)
+	if (0 < reduce.values_num)
 	{
-		int	index;
+		zbx_history_value_t	result;
 
-		if (ITEM_VALUE_TYPE_FLOAT == item->value_type)
-			zbx_vector_history_record_sort(&values, history_record_float_compare);
-		else
-			zbx_vector_history_record_sort(&values, history_record_uint64_compare);
-
-		if (0 == percentage)
-			index = 1;
-		else
-			index = (int)ceil(values.values_num * (percentage / 100));
-
-		zbx_history_value2variant(&values.values[index - 1].value, item->value_type, value);
+		func_reduce_percentile(&reduce, percentage, &result);
+		zbx_history_value2variant(&result, item->value_type, value);
 
 		ret = SUCCEED;
 	}
@@ -1896,7 +1865,7 @@ static int	evaluate_PERCENTILE(zbx_variant_t  *value, const zbx_dc_evaluate_item
 		*error = zbx_strdup(*error, "not enough data");
 	}
 out:
-	zbx_history_record_vector_destroy(&values, item->value_type);
+	func_reduce_clear(&reduce);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
@@ -0,0 +1,876 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "funcreduce.h"
+
+#include "zbxnum.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#	include <immintrin.h>
+#	define FUNC_REDUCE_SIMD	1
+#endif
+
+#define FUNC_REDUCE_IMPL_UNKNOWN	-1
+
+#define FUNC_REDUCE_MIN	0
+#define FUNC_REDUCE_MAX	1
+
+#define FUNC_REDUCE_SIGN_BIT	__UINT64_C(0x8000000000000000)
+
+static int	func_reduce_impl = FUNC_REDUCE_IMPL_UNKNOWN;
+
+/*
+ * Scalar kernels. Minimum and maximum are searched starting with the newest value, so that from equal
+ * values (0 and -0) the same value is selected as when searching in history value vector.
+ */
+
+static double	func_reduce_extremum_dbl_scalar(const zbx_history_record_t *records, int records_num, int mode)
+{
+	double	result = records[records_num - 1].value.dbl;
+	int	i;
+
+	for (i = records_num - 2; i >= 0; i--)
+	{
+		if (FUNC_REDUCE_MIN == mode ? records[i].value.dbl < result : records[i].value.dbl > result)
+			result = records[i].value.dbl;
+	}
+
+	return result;
+}
+
+static zbx_uint64_t	func_reduce_extremum_ui64_scalar(const zbx_history_record_t *records, int records_num,
+		int mode)
+{
+	zbx_uint64_t	result = records[records_num - 1].value.ui64;
+	int		i;
+
+	for (i = records_num - 2; i >= 0; i--)
+	{
+		if (FUNC_REDUCE_MIN == mode ? records[i].value.ui64 < result : records[i].value.ui64 > result)
+			result = records[i].value.ui64;
+	}
+
+	return result;
+}
+
+static zbx_uint64_t	func_reduce_sum_ui64_scalar(const zbx_history_record_t *records, int records_num)
+{
+	zbx_uint64_t	sum = 0;
+	int		i;
+
+	for (i = 0; i < records_num; i++)
+		sum += records[i].value.ui64;
+
+	return sum;
+}
+
+static int	func_reduce_count_dbl_scalar(const zbx_history_record_t *records, int records_num, int op,
+		double pattern, double epsilon)
+{
+	int	i, count = 0;
+
+	for (i = 0; i < records_num; i++)
+	{
+		double	value = records[i].value.dbl;
+
+		switch (op)
+		{
+			case OP_EQ:
+				count += (fabs(value - pattern) <= epsilon);
+				break;
+			case OP_NE:
+				count += !(fabs(value - pattern) <= epsilon);
+				break;
+			case OP_GT:
+				count += (value - pattern > epsilon);
+				break;
+			case OP_GE:
+				count += (value - pattern >= -epsilon);
+				break;
+			case OP_LT:
+				count += (pattern - value > epsilon);
+				break;
+			case OP_LE:
+				count += (pattern - value >= -epsilon);
+				break;
+		}
+	}
+
+	return count;
+}
+
+static int	func_reduce_count_ui64_scalar(const zbx_history_record_t *records, int records_num, int op,
+		zbx_uint64_t pattern, zbx_uint64_t mask)
+{
+	int	i, count = 0;
+
+	for (i = 0; i < records_num; i++)
+	{
+		zbx_uint64_t	value = records[i].value.ui64;
+
+		switch (op)
+		{
+			case OP_EQ:
+				count += (value == pattern);
+				break;
+			case OP_NE:
+				count += (value != pattern);
+				break;
+			case OP_GT:
+				count += (value > pattern);
+				break;
+			case OP_GE:
+				count += (value >= pattern);
+				break;
+			case OP_LT:
+				count += (value < pattern);
+				break;
+			case OP_LE:
+				count += (value <= pattern);
+				break;
+			case OP_BITAND:
+				count += ((value & mask) == pattern);
+				break;
+		}
+	}
+
+	return count;
+}
+
+#ifdef FUNC_REDUCE_SIMD
+
+/*
+ * AVX2 kernels. History records are 16 bytes long with value in the upper half, so values of
+ * 4 records are loaded with two loads and unpacked into single vector. Unpacking does not
+ * preserve the value order, which does not matter for the calculated aggregates.
+ */
+
+__attribute__((target("avx2")))
+static __m256i	func_reduce_load_avx2(const zbx_history_record_t *records)
+{
+	return _mm256_unpackhi_epi64(_mm256_loadu_si256((const __m256i *)records),
+			_mm256_loadu_si256((const __m256i *)(records + 2)));
+}
+
+__attribute__((target("avx2")))
+static double	func_reduce_extremum_dbl_avx2(const zbx_history_record_t *records, int records_num, int mode)
+{
+	double	lanes[4], result;
+	__m256d	acc, v;
+	int	i;
+
+	acc = _mm256_set1_pd(records[records_num - 1].value.dbl);
+
+	for (i = 0; i + 4 <= records_num; i += 4)
+	{
+		v = _mm256_castsi256_pd(func_reduce_load_avx2(&records[i]));
+		acc = (FUNC_REDUCE_MIN == mode ? _mm256_min_pd(acc, v) : _mm256_max_pd(acc, v));
+	}
+
+	_mm256_storeu_pd(lanes, acc);
+	result = lanes[0];
+
+	for (; i < records_num; i++)
+	{
+		if (FUNC_REDUCE_MIN == mode ? records[i].value.dbl < result : records[i].value.dbl > result)
+			result = records[i].value.dbl;
+	}
+
+	for (i = 1; i < 4; i++)
+	{
+		if (FUNC_REDUCE_MIN == mode ? lanes[i] < result : lanes[i] > result)
+			result = lanes[i];
+	}
+
+	return result;
+}
+
+__attribute__((target("avx2")))
+static zbx_uint64_t	func_reduce_extremum_ui64_avx2(const zbx_history_record_t *records, int records_num,
+		int mode)
+{
+	zbx_uint64_t	lanes[4], result;
+	__m256i		sign, acc, v, m;
+	int		i;
+
+	/* flip sign bit to compare unsigned values with signed comparison */
+	sign = _mm256_set1_epi64x((long long)FUNC_REDUCE_SIGN_BIT);
+	acc = _mm256_set1_epi64x((long long)(records[records_num - 1].value.ui64 ^ FUNC_REDUCE_SIGN_BIT));
+
+	for (i = 0; i + 4 <= records_num; i += 4)
+	{
+		v = _mm256_xor_si256(func_reduce_load_avx2(&records[i]), sign);
+		m = (FUNC_REDUCE_MIN == mode ? _mm256_cmpgt_epi64(acc, v) : _mm256_cmpgt_epi64(v, acc));
+		acc = _mm256_blendv_epi8(acc, v, m);
+	}
+
+	_mm256_storeu_si256((__m256i *)lanes, _mm256_xor_si256(acc, sign));
+	result = lanes[0];
+
+	for (; i < records_num; i++)
+	{
+		if (FUNC_REDUCE_MIN == mode ? records[i].value.ui64 < result : records[i].value.ui64 > result)
+			result = records[i].value.ui64;
+	}
+
+	for (i = 1; i < 4; i++)
+	{
+		if (FUNC_REDUCE_MIN == mode ? lanes[i] < result : lanes[i] > result)
+			result = lanes[i];
+	}
+
+	return result;
+}
+
+__attribute__((target("avx2")))
+static zbx_uint64_t	func_reduce_sum_ui64_avx2(const zbx_history_record_t *records, int records_num)
+{
+	zbx_uint64_t	lanes[4];
+	__m256i		acc = _mm256_setzero_si256();
+	int		i;
+
+	for (i = 0; i + 4 <= records_num; i += 4)
+		acc = _mm256_add_epi64(acc, func_reduce_load_avx2(&records[i]));
+
+	_mm256_storeu_si256((__m256i *)lanes, acc);
+
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+			func_reduce_sum_ui64_scalar(&records[i], records_num - i);
+}
+
+/* sums 64-bit lane counters */
+__attribute__((target("avx2")))
+static int	func_reduce_lanes_sum_avx2(__m256i acc)
+{
+	zbx_uint64_t	lanes[4];
+
+	_mm256_storeu_si256((__m256i *)lanes, acc);
+
+	return (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx2")))
+static int	func_reduce_count_dbl_avx2(const zbx_history_record_t *records, int records_num, int op,
+		double pattern, double epsilon)
+{
+	__m256d	p, eps, neg_eps, abs_mask, v, m;
+	__m256i	acc = _mm256_setzero_si256();
+	int	i;
+
+	p = _mm256_set1_pd(pattern);
+	eps = _mm256_set1_pd(epsilon);
+	neg_eps = _mm256_set1_pd(-epsilon);
+	abs_mask = _mm256_castsi256_pd(_mm256_set1_epi64x((long long)~FUNC_REDUCE_SIGN_BIT));
+
+	for (i = 0; i + 4 <= records_num; i += 4)
+	{
+		v = _mm256_castsi256_pd(func_reduce_load_avx2(&records[i]));
+
+		switch (op)
+		{
+			case OP_EQ:
+				m = _mm256_cmp_pd(_mm256_and_pd(_mm256_sub_pd(v, p), abs_mask), eps, _CMP_LE_OQ);
+				break;
+			case OP_NE:
+				m = _mm256_cmp_pd(_mm256_and_pd(_mm256_sub_pd(v, p), abs_mask), eps, _CMP_NLE_UQ);
+				break;
+			case OP_GT:
+				m = _mm256_cmp_pd(_mm256_sub_pd(v, p), eps, _CMP_GT_OQ);
+				break;
+			case OP_GE:
+				m = _mm256_cmp_pd(_mm256_sub_pd(v, p), neg_eps, _CMP_GE_OQ);
+				break;
+			case OP_LT:
+				m = _mm256_cmp_pd(_mm256_sub_pd(p, v), eps, _CMP_GT_OQ);
+				break;
+			case OP_LE:
+				m = _mm256_cmp_pd(_mm256_sub_pd(p, v), neg_eps, _CMP_GE_OQ);
+				break;
+			default:
+				return 0;
+		}
+
+		/* matching lanes are set to -1 */
+		acc = _mm256_sub_epi64(acc, _mm256_castpd_si256(m));
+	}
+
+	return func_reduce_lanes_sum_avx2(acc) +
+			func_reduce_count_dbl_scalar(&records[i], records_num - i, op, pattern, epsilon);
+}
+
+__attribute__((target("avx2")))
+static int	func_reduce_count_ui64_avx2(const zbx_history_record_t *records, int records_num, int op,
+		zbx_uint64_t pattern, zbx_uint64_t mask)
+{
+	__m256i	sign, p, p_signed, and_mask, v, m, acc = _mm256_setzero_si256();
+	int	i, count;
+
+	sign = _mm256_set1_epi64x((long long)FUNC_REDUCE_SIGN_BIT);
+	p = _mm256_set1_epi64x((long long)pattern);
+	p_signed = _mm256_xor_si256(p, sign);
+	and_mask = _mm256_set1_epi64x((long long)mask);
+
+	for (i = 0; i + 4 <= records_num; i += 4)
+	{
+		v = func_reduce_load_avx2(&records[i]);
+
+		/* not equal, less or equal and greater or equal are counted by inverting the opposite match */
+		switch (op)
+		{
+			case OP_EQ:
+			case OP_NE:
+				m = _mm256_cmpeq_epi64(v, p);
+				break;
+			case OP_GT:
+			case OP_LE:
+				m = _mm256_cmpgt_epi64(_mm256_xor_si256(v, sign), p_signed);
+				break;
+			case OP_LT:
+			case OP_GE:
+				m = _mm256_cmpgt_epi64(p_signed, _mm256_xor_si256(v, sign));
+				break;
+			case OP_BITAND:
+				m = _mm256_cmpeq_epi64(_mm256_and_si256(v, and_mask), p);
+				break;
+			default:
+				return 0;
+		}
+
+		/* matching lanes are set to -1 */
+		acc = _mm256_sub_epi64(acc, m);
+	}
+
+	count = func_reduce_lanes_sum_avx2(acc);
+
+	if (OP_NE == op || OP_LE == op || OP_GE == op)
+		count = i - count;
+
+	return count + func_reduce_count_ui64_scalar(&records[i], records_num - i, op, pattern, mask);
+}
+
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the reduce kernel implementation in use                   *
+ *                                                                            *
+ ******************************************************************************/
+int	func_reduce_get_impl(void)
+{
+	if (FUNC_REDUCE_IMPL_UNKNOWN == func_reduce_impl)
+	{
+#ifdef FUNC_REDUCE_SIMD
+		if (0 != __builtin_cpu_supports("avx2"))
+			func_reduce_impl = FUNC_REDUCE_IMPL_AVX2;
+		else
+#endif
+			func_reduce_impl = FUNC_REDUCE_IMPL_SCALAR;
+	}
+
+	return func_reduce_impl;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects the reduce kernel implementation                          *
+ *                                                                            *
+ * Parameters: impl - [IN] FUNC_REDUCE_IMPL_* implementation                  *
+ *                                                                            *
+ * Return value: SUCCEED - the implementation was selected                    *
+ *               FAIL    - the implementation is not supported by CPU         *
+ *                                                                            *
+ * Comments: The implementation is selected automatically on the first        *
+ *           reduction, this function is used to compare implementations in   *
+ *           tests.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	func_reduce_set_impl(int impl)
+{
+	switch (impl)
+	{
+		case FUNC_REDUCE_IMPL_SCALAR:
+			break;
+#ifdef FUNC_REDUCE_SIMD
+		case FUNC_REDUCE_IMPL_AVX2:
+			if (0 == __builtin_cpu_supports("avx2"))
+				return FAIL;
+			break;
+#endif
+		default:
+			return FAIL;
+	}
+
+	func_reduce_impl = impl;
+
+	return SUCCEED;
+}
+
+static double	func_reduce_extremum_dbl(const zbx_history_record_t *records, int records_num, int mode)
+{
+#ifdef FUNC_REDUCE_SIMD
+	if (FUNC_REDUCE_IMPL_AVX2 == func_reduce_impl)
+	{
+		double	result = func_reduce_extremum_dbl_avx2(records, records_num, mode);
+
+		/* vector search does not distinguish 0 from -0, repeat the search in value order */
+		if (0.0 != result)
+			return result;
+	}
+#endif
+	return func_reduce_extremum_dbl_scalar(records, records_num, mode);
+}
+
+static zbx_uint64_t	func_reduce_extremum_ui64(const zbx_history_record_t *records, int records_num, int mode)
+{
+#ifdef FUNC_REDUCE_SIMD
+	if (FUNC_REDUCE_IMPL_AVX2 == func_reduce_impl)
+		return func_reduce_extremum_ui64_avx2(records, records_num, mode);
+#endif
+	return func_reduce_extremum_ui64_scalar(records, records_num, mode);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes reducer data                                          *
+ *                                                                            *
+ * Parameters: reduce     - [OUT] the reducer data                            *
+ *             value_type - [IN] the item value type (float or unsigned)      *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_init(func_reduce_t *reduce, unsigned char value_type)
+{
+	memset(reduce, 0, sizeof(func_reduce_t));
+	reduce->value_type = value_type;
+
+	zbx_vector_dbl_create(&reduce->values_dbl);
+	zbx_vector_uint64_create(&reduce->values_ui64);
+
+	(void)func_reduce_get_impl();
+}
+
+void	func_reduce_clear(func_reduce_t *reduce)
+{
+	zbx_vector_dbl_destroy(&reduce->values_dbl);
+	zbx_vector_uint64_destroy(&reduce->values_ui64);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if values can be counted by func_reduce_count() reducer    *
+ *                                                                            *
+ * Parameters: pdata      - [IN] the count pattern                            *
+ *             value_type - [IN] the item value type                          *
+ *                                                                            *
+ * Return value: SUCCEED - numeric values are compared with numeric pattern   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	func_reduce_count_supported(const zbx_eval_count_pattern_data_t *pdata, unsigned char value_type)
+{
+	if (ITEM_VALUE_TYPE_FLOAT != value_type && ITEM_VALUE_TYPE_UINT64 != value_type)
+		return FAIL;
+
+	switch (pdata->op)
+	{
+		case OP_ANY:
+			return SUCCEED;
+		case OP_EQ:
+		case OP_NE:
+		case OP_GT:
+		case OP_GE:
+		case OP_LT:
+		case OP_LE:
+			return 0 != pdata->numeric_search ? SUCCEED : FAIL;
+		case OP_BITAND:
+			return 0 != pdata->numeric_search && ITEM_VALUE_TYPE_UINT64 == value_type ? SUCCEED : FAIL;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sums history values                                               *
+ *                                                                            *
+ * Comments: Floating point values are summed starting with the newest value  *
+ *           to get the same result as summing history value vector.          *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_sum(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_t	*reduce = (func_reduce_t *)data;
+	int		i;
+
+	if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+		for (i = records_num - 1; i >= 0; i--)
+			reduce->value.dbl += records[i].value.dbl;
+	}
+	else
+	{
+#ifdef FUNC_REDUCE_SIMD
+		if (FUNC_REDUCE_IMPL_AVX2 == func_reduce_impl)
+			reduce->value.ui64 += func_reduce_sum_ui64_avx2(records, records_num);
+		else
+#endif
+			reduce->value.ui64 += func_reduce_sum_ui64_scalar(records, records_num);
+	}
+
+	reduce->values_num += records_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates average of floating point history values or sum of     *
+ *          unsigned history values converted to floating point               *
+ *                                                                            *
+ * Comments: The values are processed starting with the newest value to get   *
+ *           the same result as processing history value vector.              *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_avg(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_t	*reduce = (func_reduce_t *)data;
+	double		avg = reduce->value.dbl;
+	int		i, n = reduce->values_num;
+
+	if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+		for (i = records_num - 1; i >= 0; i--, n++)
+			avg += records[i].value.dbl / (n + 1) - avg / (n + 1);
+	}
+	else
+	{
+		for (i = records_num - 1; i >= 0; i--)
+			avg += (double)records[i].value.ui64;
+	}
+
+	reduce->value.dbl = avg;
+	reduce->values_num += records_num;
+}
+
+static void	func_reduce_extremum(func_reduce_t *reduce, const zbx_history_record_t *records, int records_num,
+		int mode)
+{
+	if (0 == records_num)
+		return;
+
+	if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+		double	value = func_reduce_extremum_dbl(records, records_num, mode);
+
+		/* older values replace the result only if they are strictly less/greater */
+		if (0 == reduce->values_num || (FUNC_REDUCE_MIN == mode ? value < reduce->value.dbl :
+				value > reduce->value.dbl))
+		{
+			reduce->value.dbl = value;
+		}
+	}
+	else
+	{
+		zbx_uint64_t	value = func_reduce_extremum_ui64(records, records_num, mode);
+
+		if (0 == reduce->values_num || (FUNC_REDUCE_MIN == mode ? value < reduce->value.ui64 :
+				value > reduce->value.ui64))
+		{
+			reduce->value.ui64 = value;
+		}
+	}
+
+	reduce->values_num += records_num;
+}
+
+void	func_reduce_min(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_extremum((func_reduce_t *)data, records, records_num, FUNC_REDUCE_MIN);
+}
+
+void	func_reduce_max(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_extremum((func_reduce_t *)data, records, records_num, FUNC_REDUCE_MAX);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: counts history values matching count pattern                      *
+ *                                                                            *
+ * Comments: The pattern must be checked with func_reduce_count_supported().  *
+ *           The values are not counted after the count limit is reached.     *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_count(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_t				*reduce = (func_reduce_t *)data;
+	const zbx_eval_count_pattern_data_t	*pdata = reduce->pdata;
+
+	reduce->values_num += records_num;
+
+	if (reduce->count >= reduce->limit)
+		return;
+
+	if (OP_ANY == pdata->op)
+	{
+		reduce->count += records_num;
+	}
+	else if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+#ifdef FUNC_REDUCE_SIMD
+		if (FUNC_REDUCE_IMPL_AVX2 == func_reduce_impl)
+		{
+			reduce->count += func_reduce_count_dbl_avx2(records, records_num, pdata->op, pdata->pattern_dbl,
+					zbx_get_double_epsilon());
+		}
+		else
+#endif
+		{
+			reduce->count += func_reduce_count_dbl_scalar(records, records_num, pdata->op,
+					pdata->pattern_dbl, zbx_get_double_epsilon());
+		}
+	}
+	else
+	{
+#ifdef FUNC_REDUCE_SIMD
+		if (FUNC_REDUCE_IMPL_AVX2 == func_reduce_impl)
+		{
+			reduce->count += func_reduce_count_ui64_avx2(records, records_num, pdata->op,
+					pdata->pattern_ui64, pdata->pattern2_ui64);
+		}
+		else
+#endif
+		{
+			reduce->count += func_reduce_count_ui64_scalar(records, records_num, pdata->op,
+					pdata->pattern_ui64, pdata->pattern2_ui64);
+		}
+	}
+
+	if (reduce->count > reduce->limit)
+		reduce->count = reduce->limit;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: collects history values for percentile calculation                *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_collect(const zbx_history_record_t *records, int records_num, void *data)
+{
+	func_reduce_t	*reduce = (func_reduce_t *)data;
+	int		i;
+
+	if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+		for (i = 0; i < records_num; i++)
+			zbx_vector_dbl_append(&reduce->values_dbl, records[i].value.dbl);
+	}
+	else
+	{
+		for (i = 0; i < records_num; i++)
+			zbx_vector_uint64_append(&reduce->values_ui64, records[i].value.ui64);
+	}
+
+	reduce->values_num += records_num;
+}
+
+/*
+ * Selects the k-th smallest value (0 based) with Hoare's selection algorithm. The values are
+ * partially reordered.
+ */
+#define FUNC_REDUCE_SELECT_IMPL(__id, __type)								\
+													\
+static __type	func_reduce_select_##__id(__type *values, int values_num, int k)			\
+{													\
+	int	left = 0, right = values_num - 1;							\
+													\
+	while (left < right)										\
+	{												\
+		__type	pivot = values[left + (right - left) / 2], tmp;					\
+		int	i = left, j = right;								\
+													\
+		while (i <= j)										\
+		{											\
+			while (values[i] < pivot)							\
+				i++;									\
+													\
+			while (values[j] > pivot)							\
+				j--;									\
+													\
+			if (i <= j)									\
+			{										\
+				tmp = values[i];							\
+				values[i++] = values[j];						\
+				values[j--] = tmp;							\
+			}										\
+		}											\
+													\
+		if (k <= j)										\
+			right = j;									\
+		else if (k >= i)									\
+			left = i;									\
+		else											\
+			break;										\
+	}												\
+													\
+	return values[k];										\
+}
+
+FUNC_REDUCE_SELECT_IMPL(dbl, double)
+FUNC_REDUCE_SELECT_IMPL(ui64, zbx_uint64_t)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculates percentile of values collected by                      *
+ *          func_reduce_collect() reducer                                     *
+ *                                                                            *
+ * Parameters: reduce     - [IN] the reducer data with at least one value     *
+ *             percentage - [IN] the percentage (0-100)                       *
+ *             value      - [OUT] the percentile                              *
+ *                                                                            *
+ * Comments: The value at the percentile position of sorted values is         *
+ *           selected without sorting all values.                             *
+ *                                                                            *
+ ******************************************************************************/
+void	func_reduce_percentile(func_reduce_t *reduce, double percentage, zbx_history_value_t *value)
+{
+	int	index;
+
+	if (0 == percentage)
+		index = 1;
+	else
+		index = (int)ceil(reduce->values_num * (percentage / 100));
+
+	if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+	{
+		value->dbl = func_reduce_select_dbl(reduce->values_dbl.values, reduce->values_dbl.values_num,
+				index - 1);
+	}
+	else
+	{
+		value->ui64 = func_reduce_select_ui64(reduce->values_ui64.values, reduce->values_ui64.values_num,
+				index - 1);
+	}
+}
+
+static unsigned char	func_reduce_window_op(int op)
+{
+	switch (op)
+	{
+		case OP_EQ:
+			return ZBX_VC_WINDOW_OP_EQ;
+		case OP_NE:
+			return ZBX_VC_WINDOW_OP_NE;
+		case OP_GT:
+			return ZBX_VC_WINDOW_OP_GT;
+		case OP_GE:
+			return ZBX_VC_WINDOW_OP_GE;
+		case OP_LT:
+			return ZBX_VC_WINDOW_OP_LT;
+		case OP_LE:
+			return ZBX_VC_WINDOW_OP_LE;
+		case OP_BITAND:
+			return ZBX_VC_WINDOW_OP_BITAND;
+		default:
+			return ZBX_VC_WINDOW_OP_ANY;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets aggregate of the newest values from value cache window       *
+ *                                                                            *
+ * Return value: SUCCEED - the reducer data was set from window aggregate     *
+ *               FAIL    - the window is not maintained by value cache        *
+ *                                                                            *
+ ******************************************************************************/
+static int	func_reduce_window(zbx_uint64_t itemid, int seconds, const zbx_timespec_t *ts,
+		unsigned char window_type, func_reduce_t *reduce)
+{
+	zbx_vc_window_t		window;
+	zbx_history_value_t	value;
+	int			values_num;
+
+	memset(&window, 0, sizeof(window));
+	window.type = window_type;
+	window.seconds = seconds;
+
+	if (ZBX_VC_WINDOW_COUNT == window_type)
+	{
+		window.op = func_reduce_window_op(reduce->pdata->op);
+
+		if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+		{
+			window.pattern.dbl = reduce->pdata->pattern_dbl;
+		}
+		else
+		{
+			window.pattern.ui64 = reduce->pdata->pattern_ui64;
+			window.mask = reduce->pdata->pattern2_ui64;
+		}
+	}
+
+	if (SUCCEED != zbx_vc_get_window_value(itemid, reduce->value_type, &window, ts, &value, &values_num))
+		return FAIL;
+
+	if (0 == (reduce->values_num = values_num))
+		return SUCCEED;
+
+	switch (window_type)
+	{
+		case ZBX_VC_WINDOW_AVG:
+			/* Floating point average is the compensated window sum divided by the number of values   */
+			/* and can differ in the last bits from the running mean calculated by func_reduce_avg(). */
+			/* Unsigned values are summed as floating point values.                                   */
+			if (ITEM_VALUE_TYPE_FLOAT == reduce->value_type)
+				reduce->value.dbl = value.dbl / values_num;
+			else
+				reduce->value.dbl = value.dbl;
+			break;
+		case ZBX_VC_WINDOW_COUNT:
+			reduce->count = (value.ui64 > (zbx_uint64_t)reduce->limit ? reduce->limit : (int)value.ui64);
+			break;
+		default:
+			reduce->value = value;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reduces history values using value cache window if possible       *
+ *                                                                            *
+ * Parameters: itemid      - [IN] the item id                                 *
+ *             seconds     - [IN] the time period                             *
+ *             count       - [IN] the number of values                        *
+ *             ts          - [IN] the period end timestamp                    *
+ *             window_type - [IN] the ZBX_VC_WINDOW_* aggregate matching      *
+ *                                reducer                                     *
+ *             reduce_func - [IN] the reducer                                 *
+ *             reduce      - [IN/OUT] the reducer data                        *
+ *                                                                            *
+ * Return value: SUCCEED - the values were reduced                            *
+ *               FAIL    - the values were not retrieved                      *
+ *                                                                            *
+ * Comments: Time period aggregates of the newest values are maintained by    *
+ *           value cache, so evaluating them does not depend on the period    *
+ *           length. Other periods are reduced by zbx_vc_reduce_values().     *
+ *                                                                            *
+ ******************************************************************************/
+int	func_reduce_values(zbx_uint64_t itemid, int seconds, int count, const zbx_timespec_t *ts,
+		unsigned char window_type, zbx_vc_reduce_func_t reduce_func, func_reduce_t *reduce)
+{
+	if (0 == count && 0 < seconds && SUCCEED == func_reduce_window(itemid, seconds, ts, window_type, reduce))
+		return SUCCEED;
+
+	return zbx_vc_reduce_values(itemid, reduce->value_type, seconds, count, ts, reduce_func, reduce);
+}
@@ -0,0 +1,68 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_FUNCREDUCE_H
+#define ZABBIX_FUNCREDUCE_H
+
+#include "zbxhistory.h"
+#include "zbxalgo.h"
+#include "zbxeval.h"
+#include "zbxcachevalue.h"
+
+#define FUNC_REDUCE_IMPL_SCALAR	0
+#define FUNC_REDUCE_IMPL_AVX2	1
+
+int	func_reduce_get_impl(void);
+int	func_reduce_set_impl(int impl);
+
+/* numeric history value reducer data, see zbx_vc_reduce_values() */
+typedef struct
+{
+	unsigned char				value_type;
+
+	/* the number of reduced values */
+	int					values_num;
+
+	/* the sum, minimum or maximum value, floating point average or unsigned sum for average */
+	zbx_history_value_t			value;
+
+	/* count() pattern, the number of matching values and the count limit */
+	const zbx_eval_count_pattern_data_t	*pdata;
+	int					count;
+	int					limit;
+
+	/* collected values for percentile() */
+	zbx_vector_dbl_t			values_dbl;
+	zbx_vector_uint64_t			values_ui64;
+}
+func_reduce_t;
+
+void	func_reduce_init(func_reduce_t *reduce, unsigned char value_type);
+void	func_reduce_clear(func_reduce_t *reduce);
+
+int	func_reduce_count_supported(const zbx_eval_count_pattern_data_t *pdata, unsigned char value_type);
+
+void	func_reduce_sum(const zbx_history_record_t *records, int records_num, void *data);
+void	func_reduce_avg(const zbx_history_record_t *records, int records_num, void *data);
+void	func_reduce_min(const zbx_history_record_t *records, int records_num, void *data);
+void	func_reduce_max(const zbx_history_record_t *records, int records_num, void *data);
+void	func_reduce_count(const zbx_history_record_t *records, int records_num, void *data);
+void	func_reduce_collect(const zbx_history_record_t *records, int records_num, void *data);
+
+void	func_reduce_percentile(func_reduce_t *reduce, double percentage, zbx_history_value_t *value);
+
+int	func_reduce_values(zbx_uint64_t itemid, int seconds, int count, const zbx_timespec_t *ts,
+		unsigned char window_type, zbx_vc_reduce_func_t reduce_func, func_reduce_t *reduce);
+
+#endif
@@ -964,6 +964,81 @@ ssize_t	zbx_tcp_write(zbx_socket_t *s, const char *buf, size_t len, short *event
 #define ZBX_TCP_HEADER_DATA	"ZBXD"
 #define ZBX_TCP_HEADER_LEN	ZBX_CONST_STRLEN(ZBX_TCP_HEADER_DATA)
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns compression codec flags supported by this build          *
+ *                                                                            *
+ * Return value: ZBX_TCP_COMPRESS_ZSTD, ZBX_TCP_COMPRESS_LZ4 or their         *
+ *               combination, zlib is always supported and has no flag        *
+ *                                                                            *
+ ******************************************************************************/
+unsigned char	zbx_tcp_compress_codecs(void)
+{
+	unsigned char	codecs = 0;
+
+	if (SUCCEED == zbx_compress_codec_supported(ZBX_COMPRESS_ZSTD))
+		codecs |= ZBX_TCP_COMPRESS_ZSTD;
+
+	if (SUCCEED == zbx_compress_codec_supported(ZBX_COMPRESS_LZ4))
+		codecs |= ZBX_TCP_COMPRESS_LZ4;
+
+	return codecs;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets compression codec from protocol flags                        *
+ *                                                                            *
+ * Parameters: flags - [IN] protocol flags                                    *
+ *                                                                            *
+ * Return value: the compression codec (ZBX_COMPRESS_*)                       *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_tcp_compress_codec(unsigned char flags)
+{
+	if (0 != (flags & ZBX_TCP_COMPRESS_ZSTD))
+		return ZBX_COMPRESS_ZSTD;
+
+	if (0 != (flags & ZBX_TCP_COMPRESS_LZ4))
+		return ZBX_COMPRESS_LZ4;
+
+	return ZBX_COMPRESS_ZLIB;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validates protocol flags of received message header               *
+ *                                                                            *
+ * Parameters: protocol - [IN] the received protocol flags                    *
+ *             flags    - [IN] the additionally accepted flags                *
+ *                                                                            *
+ * Return value: SUCCEED - the flags are valid                                *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Codec flags are accepted only with compression flag and only     *
+ *           for codecs supported by this build.                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	tcp_protocol_validate(unsigned char protocol, unsigned char flags)
+{
+	unsigned char	codecs;
+
+	if (0 == (protocol & ZBX_TCP_PROTOCOL))
+		return FAIL;
+
+	if (0 != (protocol & ~(ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | ZBX_TCP_COMPRESS_CODECS | flags)))
+		return FAIL;
+
+	if (0 == (codecs = (protocol & ZBX_TCP_COMPRESS_CODECS)))
+		return SUCCEED;
+
+	/* only one codec flag can be set */
+	if (0 != (codecs & (codecs - 1)) || 0 == (protocol & ZBX_TCP_COMPRESS))
+		return FAIL;
+
+	return 0 != (codecs & zbx_tcp_compress_codecs()) ? SUCCEED : FAIL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: initialize TCP send context for sending data over socket          *
@@ -1012,12 +1087,22 @@ int	zbx_tcp_send_context_init(const char *data, size_t len, size_t reserved, uns
 		return FAIL;
 	}
 
+	if (0 == (flags & ZBX_TCP_COMPRESS))
+		flags &= ~ZBX_TCP_COMPRESS_CODECS;
+
 	if (0 != (flags & ZBX_TCP_COMPRESS))
 	{
 		/* compress if not compressed yet */
 		if (0 == reserved)
 		{
-			if (SUCCEED != zbx_compress(data, len, &context->compressed_data, &context->send_len))
+			int	codec, ret;
+
+			if (ZBX_COMPRESS_ZLIB == (codec = zbx_tcp_compress_codec(flags)))
+				ret = zbx_compress(data, len, &context->compressed_data, &context->send_len);
+			else
+				ret = zbx_compress_ext(codec, data, len, &context->compressed_data, &context->send_len);
+
+			if (SUCCEED != ret)
 			{
 				zbx_set_socket_strerror("cannot compress data: %s", zbx_compress_strerror());
 
@@ -2217,6 +2302,45 @@ int	zbx_socket_check_deadline(zbx_socket_t *s)
 #define ZBX_TCP_EXPECT_LENGTH		4
 #define ZBX_TCP_EXPECT_SIZE		5
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: passes received message data to stream callback                   *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             context - [IN/OUT] the receive context                         *
+ *                                                                            *
+ * Return value: SUCCEED - the data was processed                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Data exceeding the expected message length is not passed to      *
+ *           callback, it is only counted to report length mismatch.          *
+ *                                                                            *
+ ******************************************************************************/
+static int	tcp_recv_stream_flush(zbx_socket_t *s, zbx_tcp_recv_context_t *context)
+{
+	size_t	len = 0;
+	int	ret = SUCCEED;
+
+	if (context->buf_dyn_bytes < context->expected_len)
+		len = (size_t)MIN(context->buf_stat_bytes, context->expected_len - context->buf_dyn_bytes);
+
+	if (0 != len)
+	{
+		if (NULL != context->uncompress)
+		{
+			if (SUCCEED != (ret = zbx_uncompress_stream_feed(context->uncompress, s->buf_stat, len)))
+				zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+		}
+		else if (SUCCEED != (ret = context->stream_cb(context->stream_data, s->buf_stat, len)))
+			zbx_set_socket_strerror("cannot process received data");
+	}
+
+	context->buf_dyn_bytes += context->buf_stat_bytes;
+	context->buf_stat_bytes = 0;
+
+	return ret;
+}
+
 void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *tcp_recv_context, unsigned char flags)
 {
 	tcp_recv_context->buf_dyn_bytes = 0;
@@ -2243,6 +2367,9 @@ void	zbx_tcp_recv_context_init(zbx_socket_t *s, zbx_tcp_recv_context_t *tcp_recv
 #endif
 	zbx_socket_free(s);
 	tcp_recv_context->allocated = 0;
+	tcp_recv_context->stream_cb = NULL;
+	tcp_recv_context->stream_data = NULL;
+	tcp_recv_context->uncompress = NULL;
 
 	s->buf_type = ZBX_BUF_TYPE_STAT;
 	s->buffer = s->buf_stat;
@@ -2270,6 +2397,13 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 			context->buf_dyn_bytes += (size_t)nbytes;
 		}
 
+		if (ZBX_TCP_EXPECT_SIZE == context->expect && NULL != context->stream_cb &&
+				SUCCEED != tcp_recv_stream_flush(s, context))
+		{
+			nbytes = ZBX_PROTO_ERROR;
+			goto out;
+		}
+
 		if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
 			break;
 
@@ -2303,8 +2437,7 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 			context->expect = ZBX_TCP_EXPECT_VERSION_VALIDATE;
 			context->protocol_version = s->buf_stat[ZBX_TCP_HEADER_LEN];
 
-			if (0 == (context->protocol_version & ZBX_TCP_PROTOCOL) ||
-					context->protocol_version > (ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | flags))
+			if (SUCCEED != tcp_protocol_validate((unsigned char)context->protocol_version, flags))
 			{
 				/* invalid protocol version, abort receiving */
 				break;
@@ -2368,7 +2501,22 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 				goto out;
 			}
 
-			if (sizeof(s->buf_stat) > context->expected_len)
+			if (NULL != context->stream_cb)
+			{
+				context->buf_stat_bytes -= context->offset;
+				memmove(s->buf_stat, s->buf_stat + context->offset, context->buf_stat_bytes);
+
+				if (0 != (context->protocol_version & ZBX_TCP_COMPRESS) &&
+						NULL == (context->uncompress = zbx_uncompress_stream_create(
+						zbx_tcp_compress_codec((unsigned char)context->protocol_version),
+						context->reserved, context->stream_cb, context->stream_data)))
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+			}
+			else if (sizeof(s->buf_stat) > context->expected_len)
 			{
 				context->buf_stat_bytes -= context->offset;
 				memmove(s->buf_stat, s->buf_stat + context->offset, context->buf_stat_bytes);
@@ -2396,6 +2544,12 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 
 			context->expect = ZBX_TCP_EXPECT_SIZE;
 
+			if (NULL != context->stream_cb && SUCCEED != tcp_recv_stream_flush(s, context))
+			{
+				nbytes = ZBX_PROTO_ERROR;
+				goto out;
+			}
+
 			if (context->buf_stat_bytes + context->buf_dyn_bytes >= context->expected_len)
 				break;
 		}
@@ -2405,7 +2559,20 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 	{
 		if (context->buf_stat_bytes + context->buf_dyn_bytes == context->expected_len)
 		{
-			if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
+			if (NULL != context->stream_cb)
+			{
+				if (NULL != context->uncompress &&
+						SUCCEED != zbx_uncompress_stream_finish(context->uncompress))
+				{
+					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
+					nbytes = ZBX_PROTO_ERROR;
+					goto out;
+				}
+
+				/* the data was passed to stream callback, socket buffer is left empty */
+				s->read_bytes = 0;
+			}
+			else if (0 != (context->protocol_version & ZBX_TCP_COMPRESS))
 			{
 				char	*out;
 				size_t	out_size = context->reserved;
@@ -2420,8 +2587,10 @@ ssize_t	zbx_tcp_recv_context(zbx_socket_t *s, zbx_tcp_recv_context_t *context, u
 					goto out;
 				}
 
-				if (FAIL == zbx_uncompress(s->buffer, context->buf_stat_bytes + context->buf_dyn_bytes,
-						out, &out_size))
+				if (FAIL == zbx_uncompress_ext(
+						zbx_tcp_compress_codec((unsigned char)context->protocol_version),
+						s->buffer, context->buf_stat_bytes + context->buf_dyn_bytes, out,
+						&out_size))
 				{
 					zbx_free(out);
 					zbx_set_socket_strerror("cannot uncompress data: %s", zbx_compress_strerror());
@@ -2539,6 +2708,49 @@ ssize_t	zbx_tcp_recv_ext(zbx_socket_t *s, int timeout, unsigned char flags)
 	return nbytes;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receive data passing it to callback in chunks                     *
+ *                                                                            *
+ * Parameters: s       - [IN] the socket                                      *
+ *             timeout - [IN] the receive timeout, 0 to use socket timeout    *
+ *             flags   - [IN] ZBX_TCP_* receive flags                         *
+ *             cb      - [IN] the callback to receive message data            *
+ *             cb_data - [IN] the callback data                               *
+ *                                                                            *
+ * Return value: number of bytes received - success,                          *
+ *               FAIL - an error occurred                                     *
+ *                                                                            *
+ * Comments: Compressed messages are uncompressed incrementally, so large     *
+ *           messages are never kept in memory as a whole. The socket buffer  *
+ *           is left empty.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_tcp_recv_stream(zbx_socket_t *s, int timeout, unsigned char flags, zbx_tcp_recv_stream_cb_t cb,
+		void *cb_data)
+{
+	zbx_tcp_recv_context_t	tcp_recv_context;
+	ssize_t			nbytes;
+
+	if (0 != timeout)
+		zbx_socket_set_deadline(s, timeout);
+
+	zbx_tcp_recv_context_init(s, &tcp_recv_context, flags);
+	tcp_recv_context.stream_cb = cb;
+	tcp_recv_context.stream_data = cb_data;
+
+	if (FAIL != (nbytes = zbx_tcp_recv_context(s, &tcp_recv_context, flags, NULL)))
+		nbytes += (ssize_t)tcp_recv_context.buf_dyn_bytes;
+
+	if (NULL != tcp_recv_context.uncompress)
+		zbx_uncompress_stream_free(tcp_recv_context.uncompress);
+
+	if (0 != timeout)
+		zbx_socket_set_deadline(s, 0);
+
+	return nbytes;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: receive data till connection is closed                            *
@@ -19,6 +19,8 @@
 #include "zbxip.h"
 #include "zbxcomms.h"
 #include "zbxnum.h"
+#include "zbxstr.h"
+#include "zbxcompress.h"
 
 #if !defined(_WINDOWS) && !defined(__MINGW32)
 #include "zbxnix.h"
@@ -206,17 +208,27 @@ exit:
  *                                                                            *
  * Purpose: send data to server                                               *
  *                                                                            *
+ * Parameters: sock        - [IN] connection socket                           *
+ *             buffer      - [IN/OUT] the compressed data                     *
+ *             buffer_size - [IN] the compressed data size                    *
+ *             reserved    - [IN] the uncompressed data size                  *
+ *             codec       - [IN] the codec flag (ZBX_TCP_COMPRESS_*) used to *
+ *                                compress data, 0 for zlib                   *
+ *             error       - [OUT] the error message                          *
+ *                                                                            *
  * Return value: SUCCEED - processed successfully                             *
  *               FAIL - an error occurred                                     *
  *                                                                            *
  ******************************************************************************/
-int	zbx_put_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved, char **error)
+int	zbx_put_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved,
+		unsigned char codec, char **error)
 {
 	int	ret = FAIL;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() datalen:" ZBX_FS_SIZE_T, __func__, (zbx_fs_size_t)buffer_size);
 
-	if (SUCCEED != zbx_tcp_send_ext(sock, *buffer, buffer_size, reserved, ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS, 0))
+	if (SUCCEED != zbx_tcp_send_ext(sock, *buffer, buffer_size, reserved,
+			ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | codec, 0))
 	{
 		*error = zbx_strdup(*error, zbx_socket_strerror());
 		goto out;
@@ -397,6 +409,78 @@ out:
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add compression codecs supported in addition to zlib to request   *
+ *                                                                            *
+ * Parameters: json - [IN/OUT] json request                                   *
+ *                                                                            *
+ * Comments: The peer compresses its reply with the preferred common codec    *
+ *           and sets the codec flag in protocol header. Older versions       *
+ *           ignore this tag and keep using zlib.                             *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_add_compress_codecs(struct zbx_json *json)
+{
+	unsigned char	codecs;
+	char		buf[64];
+	size_t		offset = 0;
+
+	if (0 == (codecs = zbx_tcp_compress_codecs()))
+		return;
+
+	/* list codecs in the order of preference */
+	if (0 != (codecs & ZBX_TCP_COMPRESS_ZSTD))
+	{
+		offset += zbx_snprintf(buf + offset, sizeof(buf) - offset, "%s",
+				zbx_compress_codec_name(ZBX_COMPRESS_ZSTD));
+	}
+
+	if (0 != (codecs & ZBX_TCP_COMPRESS_LZ4))
+	{
+		zbx_snprintf(buf + offset, sizeof(buf) - offset, "%s%s", 0 == offset ? "" : ",",
+				zbx_compress_codec_name(ZBX_COMPRESS_LZ4));
+	}
+
+	zbx_json_addstring(json, ZBX_PROTO_TAG_COMPRESSION, buf, ZBX_JSON_TYPE_STRING);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: select the preferred compression codec supported by both peers    *
+ *                                                                            *
+ * Parameters: jp - [IN] json request with codecs supported by peer           *
+ *                                                                            *
+ * Return value: ZBX_TCP_COMPRESS_ZSTD or ZBX_TCP_COMPRESS_LZ4 codec flag,    *
+ *               0 if zlib must be used                                       *
+ *                                                                            *
+ ******************************************************************************/
+unsigned char	zbx_get_compress_codec(const struct zbx_json_parse *jp)
+{
+	unsigned char	codecs;
+	char		buf[64];
+
+	if (0 == (codecs = zbx_tcp_compress_codecs()))
+		return 0;
+
+	if (SUCCEED != zbx_json_value_by_name(jp, ZBX_PROTO_TAG_COMPRESSION, buf, sizeof(buf), NULL))
+		return 0;
+
+	if (0 != (codecs & ZBX_TCP_COMPRESS_ZSTD) &&
+			SUCCEED == zbx_str_in_list(buf, zbx_compress_codec_name(ZBX_COMPRESS_ZSTD), ','))
+	{
+		return ZBX_TCP_COMPRESS_ZSTD;
+	}
+
+	if (0 != (codecs & ZBX_TCP_COMPRESS_LZ4) &&
+			SUCCEED == zbx_str_in_list(buf, zbx_compress_codec_name(ZBX_COMPRESS_LZ4), ','))
+	{
+		return ZBX_TCP_COMPRESS_LZ4;
+	}
+
+	return 0;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add redirection information to json response                      *
@@ -17,11 +17,20 @@
 #include "zbxcommon.h"
 
 #ifdef HAVE_ZLIB
-#include "zlib.h"
+#	include "zlib.h"
+#endif
+
+#ifdef HAVE_ZSTD
+#	include <zstd.h>
+#endif
+
+#ifdef HAVE_LZ4
+#	include <lz4.h>
+#endif
 
 #define ZBX_COMPRESS_STRERROR_LEN	512
 
-static int	zbx_zlib_errno = 0;
+static char	zbx_compress_error[ZBX_COMPRESS_STRERROR_LEN];
 
 /******************************************************************************
  *                                                                            *
@@ -30,35 +39,216 @@ static int	zbx_zlib_errno = 0;
  ******************************************************************************/
 const char	*zbx_compress_strerror(void)
 {
-	static char	message[ZBX_COMPRESS_STRERROR_LEN];
+	return zbx_compress_error;
+}
 
-	switch (zbx_zlib_errno)
+#ifdef HAVE_ZLIB
+static void	zlib_set_error(int zlib_errno)
+{
+	switch (zlib_errno)
 	{
 		case Z_ERRNO:
-			zbx_strlcpy(message, zbx_strerror(errno), sizeof(message));
+			zbx_strlcpy(zbx_compress_error, zbx_strerror(errno), sizeof(zbx_compress_error));
 			break;
 		case Z_MEM_ERROR:
-			zbx_strlcpy(message, "not enough memory", sizeof(message));
+			zbx_strlcpy(zbx_compress_error, "not enough memory", sizeof(zbx_compress_error));
 			break;
 		case Z_BUF_ERROR:
-			zbx_strlcpy(message, "not enough space in output buffer", sizeof(message));
+			zbx_strlcpy(zbx_compress_error, "not enough space in output buffer",
+					sizeof(zbx_compress_error));
 			break;
 		case Z_DATA_ERROR:
-			zbx_strlcpy(message, "corrupted input data", sizeof(message));
+			zbx_strlcpy(zbx_compress_error, "corrupted input data", sizeof(zbx_compress_error));
 			break;
 		default:
-			zbx_snprintf(message, sizeof(message), "unknown error (%d)", zbx_zlib_errno);
+			zbx_snprintf(zbx_compress_error, sizeof(zbx_compress_error), "unknown error (%d)",
+					zlib_errno);
 			break;
 	}
+}
+
+static int	zlib_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	Bytef	*buf;
+	uLongf	buf_size;
+	int	zlib_errno;
+
+	buf_size = compressBound(size_in);
+	buf = (Bytef *)zbx_malloc(NULL, buf_size);
+
+	if (Z_OK != (zlib_errno = compress(buf, &buf_size, (const Bytef *)in, size_in)))
+	{
+		zlib_set_error(zlib_errno);
+		zbx_free(buf);
+		return FAIL;
+	}
+
+	*out = (char *)buf;
+	*size_out = buf_size;
+
+	return SUCCEED;
+}
+
+static int	zlib_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
+{
+	uLongf	size_o = *size_out;
+	int	zlib_errno;
+
+	if (Z_OK != (zlib_errno = uncompress((Bytef *)out, &size_o, (const Bytef *)in, size_in)))
+	{
+		zlib_set_error(zlib_errno);
+		return FAIL;
+	}
+
+	*size_out = size_o;
+
+	return SUCCEED;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+/* the fastest regular level, it still compresses JSON better than zlib default level */
+#define ZBX_ZSTD_LEVEL	1
+
+static int	zstd_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	char	*buf;
+	size_t	buf_size, ret;
+
+	buf_size = ZSTD_compressBound(size_in);
+	buf = (char *)zbx_malloc(NULL, buf_size);
+
+	if (0 != ZSTD_isError(ret = ZSTD_compress(buf, buf_size, in, size_in, ZBX_ZSTD_LEVEL)))
+	{
+		zbx_strlcpy(zbx_compress_error, ZSTD_getErrorName(ret), sizeof(zbx_compress_error));
+		zbx_free(buf);
+		return FAIL;
+	}
+
+	*out = buf;
+	*size_out = ret;
+
+	return SUCCEED;
+}
+
+static int	zstd_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
+{
+	size_t	ret;
+
+	if (0 != ZSTD_isError(ret = ZSTD_decompress(out, *size_out, in, size_in)))
+	{
+		zbx_strlcpy(zbx_compress_error, ZSTD_getErrorName(ret), sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	*size_out = ret;
+
+	return SUCCEED;
+}
+#endif
+
+#ifdef HAVE_LZ4
+static int	lz4_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	char	*buf;
+	int	buf_size, ret;
+
+	if (LZ4_MAX_INPUT_SIZE < size_in)
+	{
+		zbx_strlcpy(zbx_compress_error, "input data size exceeds LZ4 limit", sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	buf_size = LZ4_compressBound((int)size_in);
+	buf = (char *)zbx_malloc(NULL, (size_t)buf_size);
+
+	if (0 >= (ret = LZ4_compress_default(in, buf, (int)size_in, buf_size)))
+	{
+		zbx_strlcpy(zbx_compress_error, "not enough space in output buffer", sizeof(zbx_compress_error));
+		zbx_free(buf);
+		return FAIL;
+	}
+
+	*out = buf;
+	*size_out = (size_t)ret;
+
+	return SUCCEED;
+}
+
+static int	lz4_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
+{
+	int	ret;
+
+	if (INT_MAX < size_in)
+	{
+		zbx_strlcpy(zbx_compress_error, "input data size exceeds LZ4 limit", sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	if (0 > (ret = LZ4_decompress_safe(in, out, (int)size_in, (int)MIN(*size_out, INT_MAX))))
+	{
+		zbx_strlcpy(zbx_compress_error, "corrupted input data", sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	*size_out = (size_t)ret;
+
+	return SUCCEED;
+}
+#endif
 
-	return message;
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if compression codec is available in this build            *
+ *                                                                            *
+ * Parameters: codec - [IN] the compression codec (ZBX_COMPRESS_*)            *
+ *                                                                            *
+ * Return value: SUCCEED - the codec is supported                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_compress_codec_supported(int codec)
+{
+	switch (codec)
+	{
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+			return SUCCEED;
+#endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			return SUCCEED;
+#endif
+#ifdef HAVE_LZ4
+		case ZBX_COMPRESS_LZ4:
+			return SUCCEED;
+#endif
+		default:
+			return FAIL;
+	}
+}
+
+const char	*zbx_compress_codec_name(int codec)
+{
+	switch (codec)
+	{
+		case ZBX_COMPRESS_ZLIB:
+			return "zlib";
+		case ZBX_COMPRESS_ZSTD:
+			return "zstd";
+		case ZBX_COMPRESS_LZ4:
+			return "lz4";
+		default:
+			return "unknown";
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: compress data                                                     *
+ * Purpose: compress data with the specified codec                            *
  *                                                                            *
- * Parameters: in       - [IN] the data to compress                           *
+ * Parameters: codec    - [IN] the compression codec (ZBX_COMPRESS_*)         *
+ *             in       - [IN] the data to compress                           *
  *             size_in  - [IN] the input data size                            *
  *             out      - [OUT] the compressed data                           *
  *             size_out - [OUT] the compressed data size                      *
@@ -70,31 +260,40 @@ const char	*zbx_compress_strerror(void)
  *           caller.                                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+int	zbx_compress_ext(int codec, const char *in, size_t size_in, char **out, size_t *size_out)
 {
-	Bytef	*buf;
-	uLongf	buf_size;
-
-	buf_size = compressBound(size_in);
-	buf = (Bytef *)zbx_malloc(NULL, buf_size);
-
-	if (Z_OK != (zbx_zlib_errno = compress(buf, &buf_size, (const Bytef *)in, size_in)))
+	switch (codec)
 	{
-		zbx_free(buf);
-		return FAIL;
-	}
-
-	*out = (char *)buf;
-	*size_out = buf_size;
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+			return zlib_compress(in, size_in, out, size_out);
+#endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			return zstd_compress(in, size_in, out, size_out);
+#endif
+#ifdef HAVE_LZ4
+		case ZBX_COMPRESS_LZ4:
+			return lz4_compress(in, size_in, out, size_out);
+#endif
+		default:
+			ZBX_UNUSED(in);
+			ZBX_UNUSED(size_in);
+			ZBX_UNUSED(out);
+			ZBX_UNUSED(size_out);
 
-	return SUCCEED;
+			zbx_snprintf(zbx_compress_error, sizeof(zbx_compress_error), "%s compression is not supported",
+					zbx_compress_codec_name(codec));
+			return FAIL;
+	}
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: uncompress data                                                   *
+ * Purpose: uncompress data with the specified codec                          *
  *                                                                            *
- * Parameters: in       - [IN] the data to uncompress                         *
+ * Parameters: codec    - [IN] the compression codec (ZBX_COMPRESS_*)         *
+ *             in       - [IN] the data to uncompress                         *
  *             size_in  - [IN] the input data size                            *
  *             out      - [OUT] the uncompressed data                         *
  *             size_out - [IN/OUT] the buffer and uncompressed data size      *
@@ -103,41 +302,395 @@ int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
+int	zbx_uncompress_ext(int codec, const char *in, size_t size_in, char *out, size_t *size_out)
+{
+	switch (codec)
+	{
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+			return zlib_uncompress(in, size_in, out, size_out);
+#endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			return zstd_uncompress(in, size_in, out, size_out);
+#endif
+#ifdef HAVE_LZ4
+		case ZBX_COMPRESS_LZ4:
+			return lz4_uncompress(in, size_in, out, size_out);
+#endif
+		default:
+			ZBX_UNUSED(in);
+			ZBX_UNUSED(size_in);
+			ZBX_UNUSED(out);
+			ZBX_UNUSED(size_out);
+
+			zbx_snprintf(zbx_compress_error, sizeof(zbx_compress_error), "%s compression is not supported",
+					zbx_compress_codec_name(codec));
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compress data with zlib                                           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+{
+	return zbx_compress_ext(ZBX_COMPRESS_ZLIB, in, size_in, out, size_out);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompress zlib compressed data                                   *
+ *                                                                            *
+ ******************************************************************************/
 int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
 {
-	uLongf	size_o = *size_out;
+	return zbx_uncompress_ext(ZBX_COMPRESS_ZLIB, in, size_in, out, size_out);
+}
+
+/* the output buffer size of streaming decompression */
+#define ZBX_UNCOMPRESS_STREAM_BUF_LEN	(64 * ZBX_KIBIBYTE)
+
+struct zbx_uncompress_stream
+{
+	int				codec;
+
+	/* the expected and current uncompressed data size */
+	size_t				size;
+	size_t				size_out;
+
+	zbx_uncompress_stream_cb_t	cb;
+	void				*cb_data;
+
+	char				*buf;
+
+	/* set when the end of compressed stream is reached */
+	unsigned char			done;
+#ifdef HAVE_ZLIB
+	z_stream			zlib;
+#endif
+#ifdef HAVE_ZSTD
+	ZSTD_DStream			*zstd;
+#endif
+#ifdef HAVE_LZ4
+	/* LZ4 block format cannot be uncompressed incrementally, compressed data is buffered */
+	char				*in;
+	size_t				in_alloc;
+	size_t				in_offset;
+#endif
+};
+
+static int	uncompress_stream_flush(zbx_uncompress_stream_t *stream, const char *out, size_t size_out)
+{
+	if (0 == size_out)
+		return SUCCEED;
 
-	if (Z_OK != (zbx_zlib_errno = uncompress((Bytef *)out, &size_o, (const Bytef *)in, size_in)))
+	if (stream->size - stream->size_out < size_out)
+	{
+		zbx_strlcpy(zbx_compress_error, "uncompressed data exceeds expected size", sizeof(zbx_compress_error));
 		return FAIL;
+	}
 
-	*size_out = size_o;
+	stream->size_out += size_out;
+
+	if (SUCCEED != stream->cb(stream->cb_data, out, size_out))
+	{
+		zbx_strlcpy(zbx_compress_error, "cannot process uncompressed data", sizeof(zbx_compress_error));
+		return FAIL;
+	}
 
 	return SUCCEED;
 }
 
-#else
+#ifdef HAVE_ZLIB
+static int	zlib_uncompress_stream_feed(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
+{
+	int	zlib_errno;
 
-int	zbx_compress(const char *in, size_t size_in, char **out, size_t *size_out)
+	stream->zlib.next_in = (Bytef *)in;
+	stream->zlib.avail_in = (uInt)size_in;
+
+	do
+	{
+		stream->zlib.next_out = (Bytef *)stream->buf;
+		stream->zlib.avail_out = ZBX_UNCOMPRESS_STREAM_BUF_LEN;
+
+		zlib_errno = inflate(&stream->zlib, Z_NO_FLUSH);
+
+		if (Z_OK != zlib_errno && Z_STREAM_END != zlib_errno && Z_BUF_ERROR != zlib_errno)
+		{
+			zlib_set_error(zlib_errno);
+			return FAIL;
+		}
+
+		if (SUCCEED != uncompress_stream_flush(stream, stream->buf,
+				ZBX_UNCOMPRESS_STREAM_BUF_LEN - stream->zlib.avail_out))
+		{
+			return FAIL;
+		}
+
+		if (Z_STREAM_END == zlib_errno)
+		{
+			stream->done = 1;
+			break;
+		}
+	}
+	while (0 == stream->zlib.avail_out);
+
+	if (0 != stream->zlib.avail_in)
+	{
+		zlib_set_error(Z_DATA_ERROR);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static int	zstd_uncompress_stream_feed(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
 {
-	ZBX_UNUSED(in);
-	ZBX_UNUSED(size_in);
-	ZBX_UNUSED(out);
-	ZBX_UNUSED(size_out);
-	return FAIL;
+	ZSTD_inBuffer	in_buf = {in, size_in, 0};
+	ZSTD_outBuffer	out_buf;
+	size_t		ret;
+
+	do
+	{
+		out_buf.dst = stream->buf;
+		out_buf.size = ZBX_UNCOMPRESS_STREAM_BUF_LEN;
+		out_buf.pos = 0;
+
+		if (0 != ZSTD_isError(ret = ZSTD_decompressStream(stream->zstd, &out_buf, &in_buf)))
+		{
+			zbx_strlcpy(zbx_compress_error, ZSTD_getErrorName(ret), sizeof(zbx_compress_error));
+			return FAIL;
+		}
+
+		if (SUCCEED != uncompress_stream_flush(stream, stream->buf, out_buf.pos))
+			return FAIL;
+
+		/* zero return value means that the frame was fully decoded and flushed */
+		stream->done = (0 == ret);
+	}
+	while (in_buf.pos < in_buf.size || out_buf.pos == out_buf.size);
+
+	return SUCCEED;
 }
+#endif
 
-int	zbx_uncompress(const char *in, size_t size_in, char *out, size_t *size_out)
+#ifdef HAVE_LZ4
+static int	lz4_uncompress_stream_finish(zbx_uncompress_stream_t *stream)
 {
-	ZBX_UNUSED(in);
-	ZBX_UNUSED(size_in);
-	ZBX_UNUSED(out);
-	ZBX_UNUSED(size_out);
-	return FAIL;
+	char	*out;
+	size_t	size_out = stream->size;
+	int	ret;
+
+	out = (char *)zbx_malloc(NULL, MAX(size_out, 1));
+
+	if (SUCCEED == (ret = lz4_uncompress(stream->in, stream->in_offset, out, &size_out)))
+		ret = uncompress_stream_flush(stream, out, size_out);
+
+	zbx_free(out);
+	stream->done = 1;
+
+	return ret;
 }
+#endif
 
-const char	*zbx_compress_strerror(void)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates incremental decompressor                                  *
+ *                                                                            *
+ * Parameters: codec   - [IN] the compression codec (ZBX_COMPRESS_*)          *
+ *             size    - [IN] the expected uncompressed data size             *
+ *             cb      - [IN] the callback to receive uncompressed data       *
+ *             cb_data - [IN] the callback data                               *
+ *                                                                            *
+ * Return value: the decompressor or NULL if the codec is not supported       *
+ *                                                                            *
+ * Comments: Uncompressed data is passed to callback in chunks as soon as it  *
+ *           is available, so neither compressed nor uncompressed data must   *
+ *           be kept in memory. The exception is LZ4 which is buffered and    *
+ *           uncompressed by zbx_uncompress_stream_finish().                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uncompress_stream_t	*zbx_uncompress_stream_create(int codec, size_t size, zbx_uncompress_stream_cb_t cb,
+		void *cb_data)
+{
+	zbx_uncompress_stream_t	*stream;
+
+	if (SUCCEED != zbx_compress_codec_supported(codec))
+	{
+		zbx_snprintf(zbx_compress_error, sizeof(zbx_compress_error), "%s compression is not supported",
+				zbx_compress_codec_name(codec));
+		return NULL;
+	}
+
+	stream = (zbx_uncompress_stream_t *)zbx_malloc(NULL, sizeof(zbx_uncompress_stream_t));
+	memset(stream, 0, sizeof(zbx_uncompress_stream_t));
+
+	stream->codec = codec;
+	stream->size = size;
+	stream->cb = cb;
+	stream->cb_data = cb_data;
+
+	switch (codec)
+	{
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+		{
+			int	zlib_errno;
+
+			if (Z_OK != (zlib_errno = inflateInit(&stream->zlib)))
+			{
+				zlib_set_error(zlib_errno);
+				zbx_free(stream);
+				return NULL;
+			}
+			break;
+		}
+#endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			if (NULL == (stream->zstd = ZSTD_createDStream()))
+			{
+				zbx_strlcpy(zbx_compress_error, "not enough memory", sizeof(zbx_compress_error));
+				zbx_free(stream);
+				return NULL;
+			}
+
+			ZSTD_initDStream(stream->zstd);
+			break;
+#endif
+		default:
+			break;
+	}
+
+	if (ZBX_COMPRESS_LZ4 != codec)
+		stream->buf = (char *)zbx_malloc(NULL, ZBX_UNCOMPRESS_STREAM_BUF_LEN);
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: uncompresses the next chunk of compressed data                    *
+ *                                                                            *
+ * Parameters: stream  - [IN] the decompressor                                *
+ *             in      - [IN] the compressed data chunk                       *
+ *             size_in - [IN] the compressed data chunk size                  *
+ *                                                                            *
+ * Return value: SUCCEED - the data was uncompressed and processed            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_feed(zbx_uncompress_stream_t *stream, const char *in, size_t size_in)
 {
-	return "";
+	if (0 == size_in)
+		return SUCCEED;
+
+	if (0 != stream->done)
+	{
+		zbx_strlcpy(zbx_compress_error, "data after the end of compressed stream", sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	switch (stream->codec)
+	{
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+			return zlib_uncompress_stream_feed(stream, in, size_in);
+#endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			return zstd_uncompress_stream_feed(stream, in, size_in);
+#endif
+#ifdef HAVE_LZ4
+		case ZBX_COMPRESS_LZ4:
+			if (stream->in_alloc - stream->in_offset < size_in)
+			{
+				stream->in_alloc = stream->in_offset + MAX(size_in, stream->in_alloc / 2 + 1);
+				stream->in = (char *)zbx_realloc(stream->in, stream->in_alloc);
+			}
+
+			memcpy(stream->in + stream->in_offset, in, size_in);
+			stream->in_offset += size_in;
+
+			return SUCCEED;
+#endif
+		default:
+			ZBX_UNUSED(in);
+
+			THIS_SHOULD_NEVER_HAPPEN;
+			return FAIL;
+	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks that all compressed data was received and uncompressed     *
+ *                                                                            *
+ * Parameters: stream - [IN] the decompressor                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the data was uncompressed into expected size       *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_uncompress_stream_finish(zbx_uncompress_stream_t *stream)
+{
+#ifdef HAVE_LZ4
+	if (ZBX_COMPRESS_LZ4 == stream->codec && 0 == stream->done &&
+			SUCCEED != lz4_uncompress_stream_finish(stream))
+	{
+		return FAIL;
+	}
+#endif
+	if (0 == stream->done)
+	{
+		zbx_strlcpy(zbx_compress_error, "unexpected end of compressed data", sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	if (stream->size_out != stream->size)
+	{
+		zbx_strlcpy(zbx_compress_error, "size of uncompressed data is less than expected",
+				sizeof(zbx_compress_error));
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees incremental decompressor                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_uncompress_stream_free(zbx_uncompress_stream_t *stream)
+{
+	switch (stream->codec)
+	{
+#ifdef HAVE_ZLIB
+		case ZBX_COMPRESS_ZLIB:
+			inflateEnd(&stream->zlib);
+			break;
 #endif
+#ifdef HAVE_ZSTD
+		case ZBX_COMPRESS_ZSTD:
+			ZSTD_freeDStream(stream->zstd);
+			break;
+#endif
+#ifdef HAVE_LZ4
+		case ZBX_COMPRESS_LZ4:
+			zbx_free(stream->in);
+			break;
+#endif
+		default:
+			break;
+	}
+
+	zbx_free(stream->buf);
+	zbx_free(stream);
+}
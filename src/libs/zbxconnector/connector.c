@@ -29,6 +29,8 @@ static int	connector_initialized;
 
 #define CONNECTOR_INITIALIZED_YES	1
 
+#define CONNECTOR_IPC_RING_SIZE	ZBX_MEBIBYTE
+
 void	zbx_connector_init(void)
 {
 	connector_initialized = CONNECTOR_INITIALIZED_YES;
@@ -63,6 +65,8 @@ void	zbx_connector_send(zbx_uint32_t code, unsigned char *data, zbx_uint32_t siz
 			zabbix_log(LOG_LEVEL_CRIT, "cannot connect to connector manager service: %s", error);
 			zbx_exit(EXIT_FAILURE);
 		}
+
+		zbx_ipc_socket_attach_ring(&socket, CONNECTOR_IPC_RING_SIZE);
 	}
 
 	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
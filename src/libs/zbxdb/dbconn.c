@@ -52,6 +52,9 @@ static const zbx_db_config_t	*db_config = NULL;
 
 static zbx_db_query_mask_t	db_log_masked_values = ZBX_DB_DONT_MASK_QUERIES;
 
+/* number of SQL statements sent to database by this process */
+static zbx_uint64_t	db_statements_num;
+
 #if defined(HAVE_POSTGRESQL)
 static ZBX_THREAD_LOCAL char	ZBX_PG_ESCAPE_BACKSLASH = 1;
 #elif defined(HAVE_SQLITE3)
@@ -875,6 +878,8 @@ static int	dbconn_vexecute(zbx_dbconn_t *db, const char *fmt, va_list args)
 		goto clean;
 	}
 
+	db_statements_num++;
+
 	if (SUCCEED == ZBX_CHECK_LOG_LEVEL(LOG_LEVEL_DEBUG))
 	{
 		char		buf_sql_trunc[MAX_BUFFER_LEN + 1];
@@ -1216,6 +1221,8 @@ static zbx_db_result_t	dbconn_vselect(zbx_dbconn_t *db, const char *fmt, va_list
 		goto clean;
 	}
 
+	db_statements_num++;
+
 	zabbix_log(LOG_LEVEL_DEBUG, "query [txnlev:%d] [%s]", db->txn_level, sql);
 
 #if defined(HAVE_MYSQL)
@@ -2817,3 +2824,17 @@ zbx_db_query_mask_t	zbx_db_get_log_masked_values(void)
 	return db_log_masked_values;
 #endif
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns number of SQL statements sent to database by the current  *
+ *          process                                                           *
+ *                                                                            *
+ * Comments: The counter is never reset, callers measure statements of an     *
+ *           operation as the difference between two counter values.          *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	zbx_db_get_statements_num(void)
+{
+	return db_statements_num;
+}
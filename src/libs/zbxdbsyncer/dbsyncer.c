@@ -124,6 +124,7 @@ ZBX_THREAD_ENTRY(zbx_dbsyncer_thread, args)
 			server_num, (process_name = get_process_type_string(process_type)), process_num);
 
 	zbx_hc_acquire();
+	zbx_hc_set_shard_owner(process_num);
 	zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
 
 #define STAT_INTERVAL	5	/* if a process is busy and does not sleep then update status not faster than */
@@ -1243,85 +1243,106 @@ static int	proxy_item_validator(zbx_history_recv_item_t *item, zbx_socket_t *soc
 	return SUCCEED;
 }
 
+/* history data processing state, kept between history data batches */
+typedef struct
+{
+	zbx_ipc_async_socket_t		*rtc;
+	zbx_socket_t			*sock;
+	zbx_client_item_validator_t	validator_func;
+	void				*validator_args;
+	zbx_session_t			*session;
+	zbx_proxy_suppress_t		*nodata_win;
+	unsigned int			mode;
+	const char			*source;
+
+	zbx_history_recv_item_t		*items;
+	int				*errcodes;
+	zbx_timespec_t			unique_shift;
+	int				processed_num;
+	int				total_num;
+	double				sec;
+	char				*error;
+}
+zbx_history_recv_t;
+
+static void	history_recv_init(zbx_history_recv_t *recv, zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
+		zbx_client_item_validator_t validator_func, void *validator_args, zbx_session_t *session,
+		zbx_proxy_suppress_t *nodata_win, unsigned int mode, const char *source)
+{
+	recv->rtc = rtc;
+	recv->sock = sock;
+	recv->validator_func = validator_func;
+	recv->validator_args = validator_args;
+	recv->session = session;
+	recv->nodata_win = nodata_win;
+	recv->mode = mode;
+	recv->source = source;
+
+	recv->items = (zbx_history_recv_item_t *)zbx_malloc(NULL, sizeof(zbx_history_recv_item_t) *
+			ZBX_HISTORY_VALUES_MAX);
+	recv->errcodes = (int *)zbx_malloc(NULL, sizeof(int) * ZBX_HISTORY_VALUES_MAX);
+	recv->unique_shift.sec = 0;
+	recv->unique_shift.ns = 0;
+	recv->processed_num = 0;
+	recv->total_num = 0;
+	recv->sec = zbx_time();
+	recv->error = NULL;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: parses history data array and processes the data                  *
  *                                                                            *
- * Parameters:                                                                *
- *   rtc            - [IN] RTC socket                                         *
- *   sock           - [IN]  socket for host permission validation             *
- *   validator_func - [IN]  function to validate item permission              *
- *   validator_args - [IN]  validator function arguments                      *
- *   jp_data        - [IN]  JSON with history data array                      *
- *   session        - [IN]  the data session                                  *
- *   nodata_win     - [OUT] counter of delayed values                         *
- *   info           - [OUT] address of a pointer to the info string           *
- *                          (should be freed by the caller)                   *
- *   mode           - [IN]  item retrieve mode is used to retrieve            *
- *                          only necessary data to reduce time spent          *
- *                          holding read lock                                 *
- *   source         - [IN]  data source (proxy, agent)                        *
- *                                                                            *
- * Return value:  SUCCEED - processed successfully                            *
- *                FAIL    - an error occurred                                 *
+ * Parameters: recv    - [IN/OUT] history data processing state               *
+ *             jp_data - [IN] JSON with history data array                    *
  *                                                                            *
- * Comments: This function is used to process history data received from      *
- *           proxy or agent.                                                  *
+ * Comments: The session last value identifier is updated after the whole     *
+ *           array is processed, so the array can be a part of history data   *
+ *           received in batches.                                             *
  *                                                                            *
  ******************************************************************************/
-static int	process_history_data_by_itemids(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
-		zbx_client_item_validator_t validator_func, void *validator_args, struct zbx_json_parse *jp_data,
-		zbx_session_t *session, zbx_proxy_suppress_t *nodata_win, char **info, unsigned int mode,
-		const char *source)
+static void	history_recv_process(zbx_history_recv_t *recv, struct zbx_json_parse *jp_data)
 {
 	const char		*pnext = NULL;
-	int			ret = SUCCEED, processed_num = 0, total_num = 0, values_num, read_num, i, *errcodes;
-	double			sec;
-	zbx_history_recv_item_t	*items;
-	char			*error = NULL;
+	int			values_num, read_num, i;
 	zbx_uint64_t		itemids[ZBX_HISTORY_VALUES_MAX] = {0}, last_valueid = 0;
 	zbx_agent_value_t	values[ZBX_HISTORY_VALUES_MAX] = {0};
-	zbx_timespec_t		unique_shift = {0, 0};
-
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
-
-	items = (zbx_history_recv_item_t *)zbx_malloc(NULL, sizeof(zbx_history_recv_item_t) * ZBX_HISTORY_VALUES_MAX);
-	errcodes = (int *)zbx_malloc(NULL, sizeof(int) * ZBX_HISTORY_VALUES_MAX);
-
-	sec = zbx_time();
 
 	while (SUCCEED == parse_history_data_by_itemids(jp_data, &pnext, values, itemids, &values_num, &read_num,
-			&unique_shift, &error) && 0 != values_num)
+			&recv->unique_shift, &recv->error) && 0 != values_num)
 	{
-		zbx_dc_config_history_recv_get_items_by_itemids(items, itemids, errcodes, (size_t)values_num, mode);
+		zbx_dc_config_history_recv_get_items_by_itemids(recv->items, itemids, recv->errcodes,
+				(size_t)values_num, recv->mode);
 
 		for (i = 0; i < values_num; i++)
 		{
-			if (SUCCEED != errcodes[i])
+			if (SUCCEED != recv->errcodes[i])
 				continue;
 
 			/* check and discard if duplicate data */
-			if (NULL != session && 0 != values[i].id && values[i].id <= session->last_id)
+			if (NULL != recv->session && 0 != values[i].id && values[i].id <= recv->session->last_id)
 			{
-				errcodes[i] = FAIL;
+				recv->errcodes[i] = FAIL;
 				continue;
 			}
 
-			if (SUCCEED != validator_func(&items[i], sock, validator_args, &error))
+			if (SUCCEED != recv->validator_func(&recv->items[i], recv->sock, recv->validator_args,
+					&recv->error))
 			{
-				if (NULL != error)
+				if (NULL != recv->error)
 				{
-					zabbix_log(LOG_LEVEL_WARNING, "%s", error);
-					zbx_free(error);
+					zabbix_log(LOG_LEVEL_WARNING, "%s", recv->error);
+					zbx_free(recv->error);
 				}
 
-				errcodes[i] = FAIL;
+				recv->errcodes[i] = FAIL;
 			}
 		}
 
-		processed_num += zbx_process_history_data(rtc, items, values, errcodes, values_num, nodata_win);
+		recv->processed_num += zbx_process_history_data(recv->rtc, recv->items, values, recv->errcodes,
+				values_num, recv->nodata_win);
 
-		total_num += read_num;
+		recv->total_num += read_num;
 
 		last_valueid = values[values_num - 1].id;
 
@@ -1331,40 +1352,92 @@ static int	process_history_data_by_itemids(zbx_ipc_async_socket_t *rtc, zbx_sock
 			break;
 	}
 
-	if (NULL != session && 0 != last_valueid)
+	if (NULL != recv->session && 0 != last_valueid)
 	{
 		/* last_valueid uniquely identifies each historical value (itemid/timestamp) generated by Zabbix      */
 		/* agent for active items. It allows Zabbix server to detect and discard duplicates by comparing it   */
 		/* to the last known last_valueid. It is always being incremented, so the situation when last_valueid */
 		/* is smaller than the last known last_valueid represents a network anomaly and is logged.            */
-		if (session->last_id > last_valueid)
+		if (recv->session->last_id > last_valueid)
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "received value identifier " ZBX_FS_UI64 " from %s "
 					ZBX_FS_UI64 " is lower than the last processed value identifier " ZBX_FS_UI64,
-					last_valueid, source, session->hostid, session->last_id);
+					last_valueid, recv->source, recv->session->hostid, recv->session->last_id);
 		}
 		else
-			session->last_id = last_valueid;
+			recv->session->last_id = last_valueid;
 	}
+}
 
-	zbx_free(errcodes);
-	zbx_free(items);
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees history data processing state and reports the result        *
+ *                                                                            *
+ * Parameters: recv - [IN] history data processing state                      *
+ *             info - [OUT] address of a pointer to the info string           *
+ *                          (should be freed by the caller)                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	history_recv_finish(zbx_history_recv_t *recv, char **info)
+{
+	zbx_free(recv->errcodes);
+	zbx_free(recv->items);
 
-	if (NULL == error)
+	if (NULL == recv->error)
 	{
-		ret = SUCCEED;
 		*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
-				processed_num, total_num - processed_num, total_num, zbx_time() - sec);
+				recv->processed_num, recv->total_num - recv->processed_num, recv->total_num,
+				zbx_time() - recv->sec);
 	}
 	else
 	{
 		zbx_free(*info);
-		*info = error;
+		*info = recv->error;
 	}
+}
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses history data array and processes the data                  *
+ *                                                                            *
+ * Parameters:                                                                *
+ *   rtc            - [IN] RTC socket                                         *
+ *   sock           - [IN]  socket for host permission validation             *
+ *   validator_func - [IN]  function to validate item permission              *
+ *   validator_args - [IN]  validator function arguments                      *
+ *   jp_data        - [IN]  JSON with history data array                      *
+ *   session        - [IN]  the data session                                  *
+ *   nodata_win     - [OUT] counter of delayed values                         *
+ *   info           - [OUT] address of a pointer to the info string           *
+ *                          (should be freed by the caller)                   *
+ *   mode           - [IN]  item retrieve mode is used to retrieve            *
+ *                          only necessary data to reduce time spent          *
+ *                          holding read lock                                 *
+ *   source         - [IN]  data source (proxy, agent)                        *
+ *                                                                            *
+ * Return value:  SUCCEED - processed successfully                            *
+ *                FAIL    - an error occurred                                 *
+ *                                                                            *
+ * Comments: This function is used to process history data received from      *
+ *           proxy or agent.                                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	process_history_data_by_itemids(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
+		zbx_client_item_validator_t validator_func, void *validator_args, struct zbx_json_parse *jp_data,
+		zbx_session_t *session, zbx_proxy_suppress_t *nodata_win, char **info, unsigned int mode,
+		const char *source)
+{
+	zbx_history_recv_t	recv;
 
-	return ret;
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	history_recv_init(&recv, rtc, sock, validator_func, validator_args, session, nodata_win, mode, source);
+	history_recv_process(&recv, jp_data);
+	history_recv_finish(&recv, info);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(SUCCEED));
+
+	return SUCCEED;
 }
 
 /******************************************************************************
@@ -1502,71 +1575,111 @@ static int	item_timestamp_compare(const void *d1, const void *d2)
 	return 0;
 }
 
-static void	process_history_data_by_keys(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
-		zbx_client_item_validator_t validator_func, void *validator_args, char **info,
-		struct zbx_json_parse *jp_data, const char *token)
+/* host:key history data processing state, kept between history data batches */
+typedef struct
+{
+	zbx_ipc_async_socket_t		*rtc;
+	zbx_socket_t			*sock;
+	zbx_client_item_validator_t	validator_func;
+	void				*validator_args;
+	const char			*token;
+
+	zbx_host_key_t			*hostkeys;
+	zbx_history_recv_item_t		*items;
+	zbx_session_t			*session;
+	zbx_uint64_t			last_hostid;
+	zbx_timespec_t			unique_shift;
+	int				processed_num;
+	int				total_num;
+	double				sec;
+
+	/* hashset to ensure that triplets (itemid, timestamp seconds, timestamp nanoseconds) are unique */
+	zbx_hashset_t			timestamps;
+	int				timestamps_collision_num;
+}
+zbx_hostkey_recv_t;
+
+static void	hostkey_recv_init(zbx_hostkey_recv_t *recv, zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
+		zbx_client_item_validator_t validator_func, void *validator_args, const char *token)
+{
+	recv->rtc = rtc;
+	recv->sock = sock;
+	recv->validator_func = validator_func;
+	recv->validator_args = validator_args;
+	recv->token = token;
+
+	recv->items = (zbx_history_recv_item_t *)zbx_malloc(NULL, sizeof(zbx_history_recv_item_t) *
+			ZBX_HISTORY_VALUES_MAX);
+	recv->hostkeys = (zbx_host_key_t *)zbx_malloc(NULL, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+	memset(recv->hostkeys, 0, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
+	recv->session = NULL;
+	recv->last_hostid = 0;
+	recv->unique_shift.sec = 0;
+	recv->unique_shift.ns = 0;
+	recv->processed_num = 0;
+	recv->total_num = 0;
+	recv->sec = zbx_time();
+
+	zbx_hashset_create(&recv->timestamps, ZBX_HISTORY_VALUES_MAX, item_timestamp_hash, item_timestamp_compare);
+	recv->timestamps_collision_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: parses host:key history data array and processes the data         *
+ *                                                                            *
+ * Parameters: recv    - [IN/OUT] history data processing state               *
+ *             jp_data - [IN] JSON with history data array                    *
+ *                                                                            *
+ * Comments: The timestamp uniqueness is ensured across all processed arrays, *
+ *           so the array can be a part of history data received in batches.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	hostkey_recv_process(zbx_hostkey_recv_t *recv, struct zbx_json_parse *jp_data)
 {
-	int			values_num, read_num, processed_num = 0, total_num = 0, i;
-	zbx_timespec_t		unique_shift = {0, 0};
+	int			values_num, read_num, i;
 	const char		*pnext = NULL;
 	char			*error = NULL;
-	zbx_host_key_t		*hostkeys;
-	zbx_history_recv_item_t	*items;
-	zbx_session_t		*session = NULL;
-	zbx_uint64_t		last_hostid = 0;
 	zbx_agent_value_t	values[ZBX_HISTORY_VALUES_MAX];
 	int			errcodes[ZBX_HISTORY_VALUES_MAX];
-	double			sec;
-
-	/* hashset to ensure that triplets (itemid, timestamp seconds, timestamp nanoseconds) are unique */
-	zbx_hashset_t		timestamps;
-	int			timestamps_collision_num = 0;
 
 	/* Try to achieve uniqueness of triplets (itemid, timestamp seconds, timestamp nanoseconds) for up to */
 	/* N=1000 history records. Therefore, set a limit up to N*(N-1)/2 = 1000*(1000-1)/2 = ~ 500000 collisions. */
 #define TIMESTAMPS_COLLISIONS_MAX	500000
 
-	sec = zbx_time();
-
-	items = (zbx_history_recv_item_t *)zbx_malloc(NULL, sizeof(zbx_history_recv_item_t) * ZBX_HISTORY_VALUES_MAX);
-	hostkeys = (zbx_host_key_t *)zbx_malloc(NULL, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
-	memset(hostkeys, 0, sizeof(zbx_host_key_t) * ZBX_HISTORY_VALUES_MAX);
-
-	zbx_hashset_create(&timestamps, ZBX_HISTORY_VALUES_MAX, item_timestamp_hash, item_timestamp_compare);
-
-	while (SUCCEED == parse_history_data(jp_data, &pnext, values, hostkeys, &values_num, &read_num,
-			&unique_shift) && 0 != values_num)
+	while (SUCCEED == parse_history_data(jp_data, &pnext, values, recv->hostkeys, &values_num, &read_num,
+			&recv->unique_shift) && 0 != values_num)
 	{
-		zbx_dc_config_history_recv_get_items_by_keys(items, hostkeys, errcodes, (size_t)values_num);
+		zbx_dc_config_history_recv_get_items_by_keys(recv->items, recv->hostkeys, errcodes, (size_t)values_num);
 
 		for (i = 0; i < values_num; i++)
 		{
 			if (SUCCEED != errcodes[i])
 			{
 				zabbix_log(LOG_LEVEL_DEBUG, "cannot retrieve key \"%s\" on host \"%s\" from "
-						"configuration cache", hostkeys[i].key, hostkeys[i].host);
+						"configuration cache", recv->hostkeys[i].key, recv->hostkeys[i].host);
 				continue;
 			}
 
-			if (last_hostid != items[i].host.hostid)
+			if (recv->last_hostid != recv->items[i].host.hostid)
 			{
-				last_hostid = items[i].host.hostid;
+				recv->last_hostid = recv->items[i].host.hostid;
 
-				if (NULL != token)
+				if (NULL != recv->token)
 				{
-					session = zbx_dc_get_or_create_session(last_hostid, token,
+					recv->session = zbx_dc_get_or_create_session(recv->last_hostid, recv->token,
 							ZBX_SESSION_TYPE_DATA);
 				}
 			}
 
 			/* check and discard if duplicate data */
-			if (NULL != session && 0 != values[i].id && values[i].id <= session->last_id)
+			if (NULL != recv->session && 0 != values[i].id && values[i].id <= recv->session->last_id)
 			{
 				errcodes[i] = FAIL;
 				continue;
 			}
 
-			if (SUCCEED != validator_func(&items[i], sock, validator_args, &error))
+			if (SUCCEED != recv->validator_func(&recv->items[i], recv->sock, recv->validator_args, &error))
 			{
 				if (NULL != error)
 				{
@@ -1576,60 +1689,93 @@ static void	process_history_data_by_keys(zbx_ipc_async_socket_t *rtc, zbx_socket
 				else
 				{
 					zabbix_log(LOG_LEVEL_DEBUG, "unknown validation error for item \"%s\"",
-							(NULL == items[i].key) ? items[i].key_orig : items[i].key);
+							(NULL == recv->items[i].key) ? recv->items[i].key_orig :
+							recv->items[i].key);
 				}
 
 				errcodes[i] = FAIL;
 			}
 			else
 			{
-				item_timestamp_t	it = {.itemid = items[i].itemid, .ts = values[i].ts};
+				item_timestamp_t	it = {.itemid = recv->items[i].itemid, .ts = values[i].ts};
 
-				while (NULL != zbx_hashset_search(&timestamps, &it))
+				while (NULL != zbx_hashset_search(&recv->timestamps, &it))
 				{
 					/* Triplet (itemid, timestamp seconds, timestamp nanoseconds) is not unique. */
 					/* Try again with next nanosecond.*/
 					values[i].ts.ns++;
 					zbx_timespec_normalize(&values[i].ts);
 					it.ts = values[i].ts;
-					timestamps_collision_num++;
+					recv->timestamps_collision_num++;
 				}
 
-				if (TIMESTAMPS_COLLISIONS_MAX < timestamps_collision_num)
+				if (TIMESTAMPS_COLLISIONS_MAX < recv->timestamps_collision_num)
 				{
-					timestamps_collision_num = 0;
-					zbx_hashset_clear(&timestamps);
+					recv->timestamps_collision_num = 0;
+					zbx_hashset_clear(&recv->timestamps);
 				}
 
-				zbx_hashset_insert(&timestamps, &it, sizeof(item_timestamp_t));
+				zbx_hashset_insert(&recv->timestamps, &it, sizeof(item_timestamp_t));
 			}
 
-			if (NULL != session)
-				session->last_id = values[i].id;
+			if (NULL != recv->session)
+				recv->session->last_id = values[i].id;
 		}
 
-		processed_num += zbx_process_history_data(rtc, items, values, errcodes, values_num, NULL);
-		total_num += read_num;
+		recv->processed_num += zbx_process_history_data(recv->rtc, recv->items, values, errcodes, values_num,
+				NULL);
+		recv->total_num += read_num;
 
 		zbx_agent_values_clean(values, values_num);
 
 		if (NULL == pnext)
 			break;
 	}
+#undef TIMESTAMPS_COLLISIONS_MAX
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees host:key history data processing state and reports the      *
+ *          result                                                            *
+ *                                                                            *
+ * Parameters: recv - [IN] history data processing state                      *
+ *             info - [OUT] address of a pointer to the info string           *
+ *                          (should be freed by the caller), NULL if the      *
+ *                          result is not needed                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	hostkey_recv_finish(zbx_hostkey_recv_t *recv, char **info)
+{
+	int	i;
 
 	for (i = 0; i < ZBX_HISTORY_VALUES_MAX; i++)
 	{
-		zbx_free(hostkeys[i].host);
-		zbx_free(hostkeys[i].key);
+		zbx_free(recv->hostkeys[i].host);
+		zbx_free(recv->hostkeys[i].key);
 	}
 
-	zbx_hashset_destroy(&timestamps);
-	zbx_free(hostkeys);
-	zbx_free(items);
+	zbx_hashset_destroy(&recv->timestamps);
+	zbx_free(recv->hostkeys);
+	zbx_free(recv->items);
+
+	if (NULL == info)
+		return;
 
 	*info = zbx_dsprintf(*info, "processed: %d; failed: %d; total: %d; seconds spent: " ZBX_FS_DBL,
-			processed_num, total_num - processed_num, total_num, zbx_time() - sec);
-#undef TIMESTAMPS_COLLISIONS_MAX
+			recv->processed_num, recv->total_num - recv->processed_num, recv->total_num,
+			zbx_time() - recv->sec);
+}
+
+static void	process_history_data_by_keys(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
+		zbx_client_item_validator_t validator_func, void *validator_args, char **info,
+		struct zbx_json_parse *jp_data, const char *token)
+{
+	zbx_hostkey_recv_t	recv;
+
+	hostkey_recv_init(&recv, rtc, sock, validator_func, validator_args, token);
+	hostkey_recv_process(&recv, jp_data);
+	hostkey_recv_finish(&recv, info);
 }
 
 /******************************************************************************
@@ -1789,6 +1935,67 @@ out:
 	return ret;
 }
 
+/* sender data received as stream, history data is processed in batches while receiving */
+struct zbx_sender_data_stream
+{
+	zbx_ipc_async_socket_t	*rtc;
+	zbx_socket_t		*sock;
+
+	zbx_json_stream_t	json_stream;
+
+	/* sender data members that are processed after the data is received */
+	struct zbx_json		json;
+
+	/* set when history data array has been received */
+	unsigned char		history_started;
+	/* set while history data array is being received */
+	unsigned char		history_array;
+	/* SUCCEED - history data is being processed, FAIL - data collection is paused, */
+	/* SUCCEED_PARTIAL - the host is redirected                                      */
+	int			history_ret;
+	char			*info;
+
+	zbx_host_rights_t	rights;
+	zbx_hostkey_recv_t	history;
+
+	/* the history data rows batch */
+	char			*rows;
+	size_t			rows_alloc;
+	size_t			rows_offset;
+	int			rows_num;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if sender data host is redirected                          *
+ *                                                                            *
+ * Parameters: host - [IN] the host name of the first history record          *
+ *             sock - [IN] connection socket                                  *
+ *             info - [OUT] the redirect response                             *
+ *                                                                            *
+ * Return value: SUCCEED_PARTIAL - the host is redirected                     *
+ *               other           - otherwise                                  *
+ *                                                                            *
+ ******************************************************************************/
+static int	sender_check_redirect(const char *host, zbx_socket_t *sock, char **info)
+{
+	zbx_comms_redirect_t	redirect;
+	zbx_uint64_t		hostid;
+	int			ret;
+
+	if (SUCCEED_PARTIAL == (ret = zbx_dc_config_get_hostid_by_name(host, sock, &hostid, &redirect)))
+	{
+		struct zbx_json	j;
+
+		zbx_json_init(&j, 1024);
+		zbx_add_redirect_response(&j, &redirect);
+		*info = zbx_strdup(*info, j.buffer);
+		zbx_json_free(&j);
+	}
+
+	return ret;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process history data received from Zabbix sender                  *
@@ -1796,6 +2003,8 @@ out:
  * Parameters: rtc          - [IN] RTC socket                                 *
  *             sock         - [IN] connection socket                          *
  *             jp           - [IN] JSON with history data                     *
+ *             stream       - [IN] sender data stream if history data was     *
+ *                                 processed while receiving (optional)       *
  *             ts           - [IN] connection timestamp                       *
  *             info         - [OUT] address of a pointer to the info string   *
  *                                  (should be freed by the caller)           *
@@ -1805,7 +2014,7 @@ out:
  *                                                                            *
  ******************************************************************************/
 int	zbx_process_sender_history_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, struct zbx_json_parse *jp,
-		zbx_timespec_t *ts, char **info)
+		zbx_sender_data_stream_t *stream, zbx_timespec_t *ts, char **info)
 {
 	zbx_host_rights_t	rights = {0};
 	int			ret = FAIL;
@@ -1813,6 +2022,25 @@ int	zbx_process_sender_history_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *s
 	struct zbx_json_parse	jp_data;
 	char			host[ZBX_HOSTNAME_BUF_LEN];
 
+	if (NULL != stream && 0 != stream->history_started)
+	{
+		log_client_timediff(LOG_LEVEL_DEBUG, jp, ts);
+
+		if (SUCCEED == (ret = stream->history_ret))
+		{
+			hostkey_recv_finish(&stream->history, info);
+			stream->history_ret = FAIL;
+		}
+		else
+		{
+			zbx_free(*info);
+			*info = stream->info;
+			stream->info = NULL;
+		}
+
+		return ret;
+	}
+
 	if (SUCCEED == zbx_vps_monitor_capped())
 	{
 		*info = zbx_strdup(*info, "data collection has been paused");
@@ -1825,22 +2053,10 @@ int	zbx_process_sender_history_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *s
 
 	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_DATA, &jp_data))
 	{
-		if (SUCCEED == peek_hostkey_host(&jp_data, host, sizeof(host), info))
+		if (SUCCEED == peek_hostkey_host(&jp_data, host, sizeof(host), info) &&
+				SUCCEED_PARTIAL == (ret = sender_check_redirect(host, sock, info)))
 		{
-			zbx_comms_redirect_t	redirect;
-			zbx_uint64_t		hostid;
-
-			if (SUCCEED_PARTIAL == (ret = zbx_dc_config_get_hostid_by_name(host, sock, &hostid, &redirect)))
-			{
-				struct zbx_json	j;
-
-				zbx_json_init(&j, 1024);
-				zbx_add_redirect_response(&j, &redirect);
-				*info = zbx_strdup(NULL, j.buffer);
-				zbx_json_free(&j);
-
-				goto out;
-			}
+			goto out;
 		}
 
 		process_history_data_by_keys(rtc, sock, sender_item_validator, &rights, info, &jp_data, NULL);
@@ -1854,6 +2070,226 @@ out:
 	return ret;
 }
 
+static int	sender_data_stream_flush(zbx_sender_data_stream_t *stream)
+{
+	struct zbx_json_parse	jp_data;
+	zbx_dc_um_handle_t	*um_handle;
+
+	if (0 == stream->rows_num)
+		return SUCCEED;
+
+	zbx_chrcpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset, ']');
+
+	/* invalid history data rejects the whole sender data, the same as when parsing the whole data */
+	if (SUCCEED != zbx_json_open(stream->rows, &jp_data))
+		return FAIL;
+
+	um_handle = zbx_dc_open_user_macros();
+	hostkey_recv_process(&stream->history, &jp_data);
+	zbx_dc_close_user_macros(um_handle);
+
+	stream->rows_offset = 0;
+	stream->rows_num = 0;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks the first history record before processing history data     *
+ *                                                                            *
+ * Return value: SUCCEED - the history data can be processed                  *
+ *               other   - the history data must be discarded                 *
+ *                                                                            *
+ ******************************************************************************/
+static int	sender_data_stream_begin(zbx_sender_data_stream_t *stream, const char *row)
+{
+	struct zbx_json_parse	jp_row;
+	char			host[ZBX_HOSTNAME_BUF_LEN];
+	zbx_dc_um_handle_t	*um_handle;
+	int			ret = SUCCEED;
+
+	if (SUCCEED != zbx_json_brackets_open(row, &jp_row) ||
+			SUCCEED != zbx_json_value_by_name(&jp_row, ZBX_PROTO_TAG_HOST, host, sizeof(host), NULL))
+	{
+		return SUCCEED;
+	}
+
+	um_handle = zbx_dc_open_user_macros();
+
+	if (SUCCEED_PARTIAL == sender_check_redirect(host, stream->sock, &stream->info))
+	{
+		hostkey_recv_finish(&stream->history, NULL);
+		ret = SUCCEED_PARTIAL;
+	}
+
+	zbx_dc_close_user_macros(um_handle);
+
+	return ret;
+}
+
+static int	sender_data_stream_cb(void *data, int event, const char *name, const char *value, size_t len)
+{
+	zbx_sender_data_stream_t	*stream = (zbx_sender_data_stream_t *)data;
+
+	switch (event)
+	{
+		case ZBX_JSON_STREAM_MEMBER:
+			zbx_json_addraw(&stream->json, name, value);
+			break;
+		case ZBX_JSON_STREAM_ARRAY:
+			if (0 == strcmp(name, ZBX_PROTO_TAG_DATA) && 0 == stream->history_started)
+			{
+				stream->history_started = 1;
+				stream->history_array = 1;
+
+				if (SUCCEED == zbx_vps_monitor_capped())
+				{
+					stream->info = zbx_strdup(NULL, "data collection has been paused");
+					stream->history_ret = FAIL;
+					break;
+				}
+
+				hostkey_recv_init(&stream->history, stream->rtc, stream->sock, sender_item_validator,
+						&stream->rights, NULL);
+				stream->history_ret = SUCCEED;
+				break;
+			}
+
+			zbx_json_addarray(&stream->json, name);
+			break;
+		case ZBX_JSON_STREAM_ELEMENT:
+			if (0 == stream->history_array)
+			{
+				zbx_json_addraw(&stream->json, NULL, value);
+				break;
+			}
+
+			if (SUCCEED != stream->history_ret)
+				break;
+
+			/* the first record host can be redirected, the same as when processing the whole array */
+			if (0 == stream->history.total_num && 0 == stream->rows_num &&
+					SUCCEED != (stream->history_ret = sender_data_stream_begin(stream, value)))
+			{
+				break;
+			}
+
+			zbx_chrcpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset,
+					0 == stream->rows_num ? '[' : ',');
+			zbx_strncpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset, value, len);
+
+			if (ZBX_HISTORY_VALUES_MAX == ++stream->rows_num)
+				return sender_data_stream_flush(stream);
+			break;
+		case ZBX_JSON_STREAM_ARRAY_END:
+			if (0 == stream->history_array)
+			{
+				zbx_json_close(&stream->json);
+				break;
+			}
+
+			stream->history_array = 0;
+
+			if (SUCCEED == stream->history_ret)
+				return sender_data_stream_flush(stream);
+			break;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates sender data stream                                        *
+ *                                                                            *
+ * Parameters: rtc  - [IN] RTC socket                                         *
+ *             sock - [IN] connection socket                                  *
+ *                                                                            *
+ * Return value: the sender data stream                                       *
+ *                                                                            *
+ * Comments: The received data is fed with zbx_sender_data_stream_feed(). The *
+ *           history data rows are processed in batches while receiving,      *
+ *           the result is reported by zbx_process_sender_history_data().     *
+ *                                                                            *
+ ******************************************************************************/
+zbx_sender_data_stream_t	*zbx_sender_data_stream_create(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock)
+{
+	zbx_sender_data_stream_t	*stream;
+
+	stream = (zbx_sender_data_stream_t *)zbx_malloc(NULL, sizeof(zbx_sender_data_stream_t));
+	memset(stream, 0, sizeof(zbx_sender_data_stream_t));
+
+	stream->rtc = rtc;
+	stream->sock = sock;
+	stream->history_ret = FAIL;
+
+	zbx_json_stream_init(&stream->json_stream, sender_data_stream_cb, stream);
+	zbx_json_init(&stream->json, ZBX_JSON_STAT_BUF_LEN);
+
+	return stream;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes the next chunk of received sender data                  *
+ *                                                                            *
+ * Parameters: data - [IN] the sender data stream                             *
+ *             buf  - [IN] the data chunk                                     *
+ *             len  - [IN] the data chunk length                              *
+ *                                                                            *
+ * Return value: SUCCEED - the data was processed                             *
+ *               FAIL    - invalid sender data                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_sender_data_stream_feed(void *data, const char *buf, size_t len)
+{
+	zbx_sender_data_stream_t	*stream = (zbx_sender_data_stream_t *)data;
+
+	if (SUCCEED != zbx_json_stream_feed(&stream->json_stream, buf, len))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid sender data from \"%s\": %s", stream->sock->peer,
+				zbx_json_strerror());
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets sender data that was not processed while receiving            *
+ *                                                                            *
+ * Parameters: stream - [IN] the sender data stream                           *
+ *                                                                            *
+ * Return value: sender data JSON without streamed history data or NULL if    *
+ *               the data was incomplete                                      *
+ *                                                                            *
+ ******************************************************************************/
+const char	*zbx_sender_data_stream_get_json(zbx_sender_data_stream_t *stream)
+{
+	if (SUCCEED != zbx_json_stream_finish(&stream->json_stream))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid sender data from \"%s\": %s", stream->sock->peer,
+				zbx_json_strerror());
+		return NULL;
+	}
+
+	return stream->json.buffer;
+}
+
+void	zbx_sender_data_stream_free(zbx_sender_data_stream_t *stream)
+{
+	if (SUCCEED == stream->history_ret)
+		hostkey_recv_finish(&stream->history, NULL);
+
+	zbx_json_stream_clear(&stream->json_stream);
+	zbx_json_free(&stream->json);
+	zbx_free(stream->info);
+	zbx_free(stream->rows);
+	zbx_free(stream);
+}
+
 static void	zbx_dservice_ptr_free(zbx_dservice_t *service)
 {
 	zbx_free(service);
@@ -2671,6 +3107,89 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks proxy communication delay before processing proxy data     *
+ *                                                                            *
+ * Parameters: ts                  - [IN] timestamp when proxy connection was *
+ *                                        established                         *
+ *             proxy_status        - [IN] active or passive proxy mode        *
+ *             proxydata_frequency - [IN]                                     *
+ *             diff                - [IN/OUT] the properties to update        *
+ *                                                                            *
+ * Return value:  SUCCEED - the delay was checked                             *
+ *                FAIL    - cannot get proxy communication delay              *
+ *                                                                            *
+ ******************************************************************************/
+static int	proxy_data_begin(const zbx_timespec_t *ts, unsigned char proxy_status, int proxydata_frequency,
+		zbx_proxy_diff_t *diff)
+{
+	int	flags_old, lastaccess;
+
+	if (SUCCEED != zbx_dc_get_proxy_nodata_win(diff->hostid, &diff->nodata_win, &lastaccess))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot get proxy communication delay");
+		return FAIL;
+	}
+
+	diff->lastaccess = lastaccess;
+
+	flags_old = diff->nodata_win.flags;
+	/* first packet can be empty for active proxy */
+	check_proxy_nodata(ts, proxy_status, proxydata_frequency, diff);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "%s() flag_win:%d/%d flag:%d proxy_status:%d period_end:%d delay:" ZBX_FS_TIME_T
+			" timestamp:%d lastaccess:" ZBX_FS_TIME_T " proxy_delay:%d", __func__,
+			diff->nodata_win.flags, flags_old, (int)diff->flags, proxy_status,
+			diff->nodata_win.period_end, (zbx_fs_time_t)(ts->sec - diff->lastaccess), ts->sec,
+			(zbx_fs_time_t)diff->lastaccess, diff->proxy_delay);
+
+	if (ZBX_FLAGS_PROXY_DIFF_UNSET != diff->flags)
+		zbx_dc_update_proxy(diff);
+
+	return SUCCEED;
+}
+
+/* proxy data received as stream, history data is processed in batches while receiving */
+struct zbx_proxy_data_stream
+{
+	zbx_ipc_async_socket_t			*rtc;
+	const zbx_dc_proxy_t			*proxy;
+	zbx_proxy_data_stream_check_func_t	check_cb;
+	void					*check_data;
+	const zbx_timespec_t			*ts;
+	unsigned char				proxy_status;
+	int					proxydata_frequency;
+
+	zbx_json_stream_t	json_stream;
+
+	/* proxy data members that are processed after the data is received */
+	struct zbx_json		json;
+
+	int			version_ret;
+	char			session_token[ZBX_SESSION_TOKEN_SIZE + 1];
+	zbx_session_t		*session;
+
+	/* set when history data processing has been started */
+	unsigned char		history_started;
+	/* set while history data array is being received */
+	unsigned char		history_array;
+	/* set when history data was rejected by proxy check */
+	unsigned char		history_discard;
+	/* set when any data has been received */
+	unsigned char		received;
+
+	zbx_proxy_diff_t	proxy_diff;
+	int			flags_old;
+	zbx_history_recv_t	history;
+
+	/* the history data rows batch */
+	char			*rows;
+	size_t			rows_alloc;
+	size_t			rows_offset;
+	int			rows_num;
+};
+
 /*****************************************************************************
  *                                                                           *
  * Purpose: processes 'proxy data' request                                   *
@@ -2679,6 +3198,9 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
  *    rtc                         - [IN] RTC socket                          *
  *    proxy                       - [IN] source proxy                        *
  *    jp                          - [IN] JSON with proxy data                *
+ *    stream                      - [IN] proxy data stream if history data   *
+ *                                       was processed while receiving,      *
+ *                                       NULL otherwise (optional)           *
  *    ts                          - [IN] timestamp when proxy connection was *
  *                                       established                         *
  *    proxy_status                - [IN] active or passive proxy mode        *
@@ -2699,7 +3221,7 @@ static void	check_proxy_nodata_empty(const zbx_timespec_t *ts, unsigned char pro
  *                                                                           *
  *****************************************************************************/
 int	zbx_process_proxy_data(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *proxy,
-		const struct zbx_json_parse *jp, const zbx_timespec_t *ts,
+		const struct zbx_json_parse *jp, zbx_proxy_data_stream_t *stream, const zbx_timespec_t *ts,
 		unsigned char proxy_status, const zbx_events_funcs_t *events_cbs, int proxydata_frequency,
 		zbx_discovery_update_host_func_t discovery_update_host_cb,
 		zbx_discovery_update_hosts_func_t discovery_update_hosts_cb,
@@ -2712,25 +3234,27 @@ int	zbx_process_proxy_data(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *pr
 		zbx_autoreg_prepare_host_func_t autoreg_prepare_host_cb, int *more, char **error)
 {
 	struct zbx_json_parse	jp_data;
-	int			ret = SUCCEED, flags_old, lastaccess;
+	int			ret = SUCCEED, flags_old;
 	char			*error_step = NULL, value[MAX_STRING_LEN];
 	size_t			error_alloc = 0, error_offset = 0;
 	zbx_proxy_diff_t	proxy_diff;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
-	proxy_diff.hostid = proxy->proxyid;
+	if (NULL != stream && 0 == stream->history_started)
+		stream = NULL;
 
-	if (SUCCEED != (ret = zbx_dc_get_proxy_nodata_win(proxy_diff.hostid, &proxy_diff.nodata_win,
-			&lastaccess)))
+	if (NULL != stream)
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot get proxy communication delay");
-		ret = FAIL;
-		goto out;
+		/* communication delay was checked when history data processing was started */
+		proxy_diff = stream->proxy_diff;
+		flags_old = stream->flags_old;
+	}
+	else
+	{
+		proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
+		proxy_diff.hostid = proxy->proxyid;
 	}
-
-	proxy_diff.lastaccess = lastaccess;
 
 	if (NULL != more)
 	{
@@ -2746,18 +3270,17 @@ int	zbx_process_proxy_data(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *pr
 		proxy_diff.proxy_delay = 0;
 
 	proxy_diff.flags |= ZBX_FLAGS_PROXY_DIFF_UPDATE_PROXYDELAY;
-	flags_old = proxy_diff.nodata_win.flags;
-	/* first packet can be empty for active proxy */
-	check_proxy_nodata(ts, proxy_status, proxydata_frequency, &proxy_diff);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "%s() flag_win:%d/%d flag:%d proxy_status:%d period_end:%d delay:" ZBX_FS_TIME_T
-			" timestamp:%d lastaccess:" ZBX_FS_TIME_T " proxy_delay:%d", __func__,
-			proxy_diff.nodata_win.flags, flags_old, (int)proxy_diff.flags, proxy_status,
-			proxy_diff.nodata_win.period_end, (zbx_fs_time_t)(ts->sec - proxy_diff.lastaccess), ts->sec,
-			(zbx_fs_time_t)proxy_diff.lastaccess, proxy_diff.proxy_delay);
+	if (NULL == stream)
+	{
+		if (SUCCEED != proxy_data_begin(ts, proxy_status, proxydata_frequency, &proxy_diff))
+		{
+			ret = FAIL;
+			goto out;
+		}
 
-	if (ZBX_FLAGS_PROXY_DIFF_UNSET != proxy_diff.flags)
-		zbx_dc_update_proxy(&proxy_diff);
+		flags_old = proxy_diff.nodata_win.flags;
+	}
 
 	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_INTERFACE_AVAILABILITY, &jp_data))
 	{
@@ -2765,9 +3288,12 @@ int	zbx_process_proxy_data(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *pr
 			zbx_strcatnl_alloc(error, &error_alloc, &error_offset, error_step);
 	}
 
-	flags_old = proxy_diff.nodata_win.flags;
-
-	if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
+	if (NULL != stream)
+	{
+		history_recv_finish(&stream->history, &error_step);
+		stream->history_started = 0;
+	}
+	else if (SUCCEED == zbx_json_brackets_by_name(jp, ZBX_PROTO_TAG_HISTORY_DATA, &jp_data))
 	{
 		zbx_session_t	*session = NULL;
 
@@ -3150,3 +3676,302 @@ int	zbx_check_protocol_version(zbx_dc_proxy_t *proxy, int version)
 
 	return SUCCEED;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if history data can be processed while receiving and      *
+ *          prepares history data processing                                  *
+ *                                                                            *
+ * Return value: ZBX_PROXY_DATA_HISTORY_PROCESS - history data will be        *
+ *                                                processed in batches        *
+ *               ZBX_PROXY_DATA_HISTORY_BUFFER  - history data must be        *
+ *                                                buffered                    *
+ *               ZBX_PROXY_DATA_HISTORY_DISCARD - history data must be        *
+ *                                                discarded                   *
+ *                                                                            *
+ * Comments: Proxy version and data session must be known before history      *
+ *           data, otherwise history data is processed after the whole proxy  *
+ *           data is received. When the source proxy is not known yet it is   *
+ *           resolved by check callback from the members received so far.     *
+ *                                                                            *
+ ******************************************************************************/
+static int	proxy_data_stream_begin(zbx_proxy_data_stream_t *stream)
+{
+	if (0 != stream->history_started)
+		return ZBX_PROXY_DATA_HISTORY_PROCESS;
+
+	if (0 != stream->history_discard)
+		return ZBX_PROXY_DATA_HISTORY_DISCARD;
+
+	if (SUCCEED != stream->version_ret || '\0' == *stream->session_token)
+		return ZBX_PROXY_DATA_HISTORY_BUFFER;
+
+	if (NULL == stream->proxy)
+	{
+		struct zbx_json_parse	jp;
+		int			ret;
+
+		if (NULL == stream->check_cb || SUCCEED != zbx_json_open(stream->json.buffer, &jp))
+			return ZBX_PROXY_DATA_HISTORY_BUFFER;
+
+		if (ZBX_PROXY_DATA_HISTORY_PROCESS != (ret = stream->check_cb(stream->check_data, &jp,
+				&stream->proxy)))
+		{
+			return ret;
+		}
+	}
+
+	stream->session = zbx_dc_get_or_create_session(stream->proxy->proxyid, stream->session_token,
+			ZBX_SESSION_TYPE_DATA);
+
+	stream->proxy_diff.flags = ZBX_FLAGS_PROXY_DIFF_UNSET;
+	stream->proxy_diff.hostid = stream->proxy->proxyid;
+	stream->proxy_diff.proxy_delay = 0;
+
+	if (SUCCEED != proxy_data_begin(stream->ts, stream->proxy_status, stream->proxydata_frequency,
+			&stream->proxy_diff))
+	{
+		return ZBX_PROXY_DATA_HISTORY_BUFFER;
+	}
+
+	stream->flags_old = stream->proxy_diff.nodata_win.flags;
+
+	history_recv_init(&stream->history, stream->rtc, NULL, proxy_item_validator,
+			(void *)&stream->proxy->proxyid, stream->session, &stream->proxy_diff.nodata_win,
+			ZBX_ITEM_GET_PROCESS, "proxy");
+	stream->history_started = 1;
+
+	return ZBX_PROXY_DATA_HISTORY_PROCESS;
+}
+
+static void	proxy_data_stream_flush(zbx_proxy_data_stream_t *stream)
+{
+	struct zbx_json_parse	jp_data;
+
+	if (0 == stream->rows_num)
+		return;
+
+	zbx_chrcpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset, ']');
+
+	/* stop processing after invalid history data, the same as when processing the whole array */
+	if (NULL == stream->history.error)
+	{
+		if (SUCCEED == zbx_json_open(stream->rows, &jp_data))
+			history_recv_process(&stream->history, &jp_data);
+		else
+			stream->history.error = zbx_strdup(NULL, zbx_json_strerror());
+	}
+
+	stream->rows_offset = 0;
+	stream->rows_num = 0;
+}
+
+static int	proxy_data_stream_cb(void *data, int event, const char *name, const char *value, size_t len)
+{
+	zbx_proxy_data_stream_t	*stream = (zbx_proxy_data_stream_t *)data;
+	char			buffer[MAX_STRING_LEN];
+
+	switch (event)
+	{
+		case ZBX_JSON_STREAM_MEMBER:
+			if (0 == strcmp(name, ZBX_PROTO_TAG_VERSION))
+			{
+				if (NULL != zbx_json_decodevalue(value, buffer, sizeof(buffer), NULL))
+				{
+					/* compatibility issues are reported when the whole data is processed */
+					if (ZBX_PROXY_VERSION_CURRENT == zbx_get_proxy_compatibility(
+							zbx_get_proxy_protocol_version_int(buffer)))
+					{
+						stream->version_ret = SUCCEED;
+					}
+				}
+			}
+			else if (0 == strcmp(name, ZBX_PROTO_TAG_SESSION))
+			{
+				if (NULL != zbx_json_decodevalue(value, buffer, sizeof(buffer), NULL) &&
+						ZBX_SESSION_TOKEN_SIZE == strlen(buffer))
+				{
+					zbx_strlcpy(stream->session_token, buffer, sizeof(stream->session_token));
+				}
+			}
+
+			zbx_json_addraw(&stream->json, name, value);
+			break;
+		case ZBX_JSON_STREAM_ARRAY:
+			if (0 == strcmp(name, ZBX_PROTO_TAG_HISTORY_DATA))
+			{
+				switch (proxy_data_stream_begin(stream))
+				{
+					case ZBX_PROXY_DATA_HISTORY_PROCESS:
+						stream->history_array = 1;
+						return SUCCEED;
+					case ZBX_PROXY_DATA_HISTORY_DISCARD:
+						/* keep empty history data to report that it was not processed */
+						stream->history_array = 1;
+						stream->history_discard = 1;
+						break;
+				}
+			}
+
+			zbx_json_addarray(&stream->json, name);
+			break;
+		case ZBX_JSON_STREAM_ELEMENT:
+			if (0 == stream->history_array)
+			{
+				zbx_json_addraw(&stream->json, NULL, value);
+				break;
+			}
+
+			if (0 != stream->history_discard)
+				break;
+
+			zbx_chrcpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset,
+					0 == stream->rows_num ? '[' : ',');
+			zbx_strncpy_alloc(&stream->rows, &stream->rows_alloc, &stream->rows_offset, value, len);
+
+			if (ZBX_HISTORY_VALUES_MAX == ++stream->rows_num)
+				proxy_data_stream_flush(stream);
+			break;
+		case ZBX_JSON_STREAM_ARRAY_END:
+			if (0 == stream->history_array || 0 != stream->history_discard)
+				zbx_json_close(&stream->json);
+			else
+				proxy_data_stream_flush(stream);
+
+			stream->history_array = 0;
+			break;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates proxy data stream                                         *
+ *                                                                            *
+ * Parameters: rtc                 - [IN] RTC socket                          *
+ *             proxy               - [IN] source proxy, NULL if it is not     *
+ *                                        known before receiving the data     *
+ *             check_cb            - [IN] callback to resolve and check       *
+ *                                        source proxy before history data is *
+ *                                        processed (optional)                *
+ *             check_data          - [IN] the check callback data             *
+ *             ts                  - [IN] timestamp when proxy connection was *
+ *                                        established, must be set before     *
+ *                                        data is received                    *
+ *             proxy_status        - [IN] active or passive proxy mode        *
+ *             proxydata_frequency - [IN]                                     *
+ *                                                                            *
+ * Return value: the proxy data stream                                        *
+ *                                                                            *
+ * Comments: The received data is fed with zbx_proxy_data_stream_feed(). When *
+ *           proxy version and data session precede history data the history *
+ *           rows are processed in batches while receiving, other proxy data  *
+ *           members are collected and processed by zbx_process_proxy_data()  *
+ *           afterwards.                                                      *
+ *           Active proxy is known only from the received data, so the check  *
+ *           callback is called with the members preceding history data. It   *
+ *           can also reject history data, for example when history cache is  *
+ *           full, then history rows are skipped while receiving.             *
+ *                                                                            *
+ ******************************************************************************/
+zbx_proxy_data_stream_t	*zbx_proxy_data_stream_create(zbx_ipc_async_socket_t *rtc, const zbx_dc_proxy_t *proxy,
+		zbx_proxy_data_stream_check_func_t check_cb, void *check_data, const zbx_timespec_t *ts,
+		unsigned char proxy_status, int proxydata_frequency)
+{
+	zbx_proxy_data_stream_t	*stream;
+
+	stream = (zbx_proxy_data_stream_t *)zbx_malloc(NULL, sizeof(zbx_proxy_data_stream_t));
+	memset(stream, 0, sizeof(zbx_proxy_data_stream_t));
+
+	stream->rtc = rtc;
+	stream->proxy = proxy;
+	stream->check_cb = check_cb;
+	stream->check_data = check_data;
+	stream->ts = ts;
+	stream->proxy_status = proxy_status;
+	stream->proxydata_frequency = proxydata_frequency;
+	stream->version_ret = FAIL;
+
+	zbx_json_stream_init(&stream->json_stream, proxy_data_stream_cb, stream);
+	zbx_json_init(&stream->json, ZBX_JSON_STAT_BUF_LEN);
+
+	return stream;
+}
+
+static void	proxy_data_stream_log_error(const zbx_proxy_data_stream_t *stream)
+{
+	/* errors of data received from active proxy are reported by the caller with connection address */
+	if (PROXY_OPERATING_MODE_PASSIVE != stream->proxy_status)
+		return;
+
+	zabbix_log(LOG_LEVEL_WARNING, "proxy \"%s\" at \"%s\" returned invalid proxy data: %s",
+			stream->proxy->name, stream->proxy->addr, zbx_json_strerror());
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes the next chunk of received proxy data                   *
+ *                                                                            *
+ * Parameters: data - [IN] the proxy data stream                              *
+ *             buf  - [IN] the data chunk                                     *
+ *             len  - [IN] the data chunk length                              *
+ *                                                                            *
+ * Return value: SUCCEED - the data was processed                             *
+ *               FAIL    - invalid proxy data                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_proxy_data_stream_feed(void *data, const char *buf, size_t len)
+{
+	zbx_proxy_data_stream_t	*stream = (zbx_proxy_data_stream_t *)data;
+
+	stream->received = 1;
+
+	if (SUCCEED != zbx_json_stream_feed(&stream->json_stream, buf, len))
+	{
+		proxy_data_stream_log_error(stream);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets proxy data that was not processed while receiving            *
+ *                                                                            *
+ * Parameters: stream - [IN] the proxy data stream                            *
+ *                                                                            *
+ * Return value: proxy data JSON without streamed history data, empty string  *
+ *               if no data was received or NULL if the data was incomplete   *
+ *                                                                            *
+ ******************************************************************************/
+const char	*zbx_proxy_data_stream_get_json(zbx_proxy_data_stream_t *stream)
+{
+	if (0 == stream->received)
+		return "";
+
+	if (SUCCEED != zbx_json_stream_finish(&stream->json_stream))
+	{
+		proxy_data_stream_log_error(stream);
+		return NULL;
+	}
+
+	return stream->json.buffer;
+}
+
+void	zbx_proxy_data_stream_free(zbx_proxy_data_stream_t *stream)
+{
+	if (0 != stream->history_started)
+	{
+		char	*info = NULL;
+
+		history_recv_finish(&stream->history, &info);
+		zbx_free(info);
+	}
+
+	zbx_json_stream_clear(&stream->json_stream);
+	zbx_json_free(&stream->json);
+	zbx_free(stream->rows);
+	zbx_free(stream);
+}
@@ -197,6 +197,27 @@ void	zbx_diag_add_mem_stats(struct zbx_json *json, const char *name, const zbx_s
 
 	zbx_json_close(json);
 	zbx_json_close(json);
+
+	if (0 != stats->slabs_num)
+	{
+		zbx_json_addarray(json, "slabs");
+
+		for (i = 0; i < stats->slabs_num; i++)
+		{
+			if (0 == stats->slabs[i].pages)
+				continue;
+
+			zbx_json_addobject(json, NULL);
+			zbx_json_adduint64(json, "size", stats->slabs[i].slot_size);
+			zbx_json_adduint64(json, "pages", stats->slabs[i].pages);
+			zbx_json_adduint64(json, "slots", stats->slabs[i].slots_total);
+			zbx_json_adduint64(json, "used", stats->slabs[i].slots_used);
+			zbx_json_close(json);
+		}
+
+		zbx_json_close(json);
+	}
+
 	zbx_json_close(json);
 }
 
@@ -414,14 +435,26 @@ void	zbx_diag_add_locks_info(struct zbx_json *json)
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_KSTAT", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_DBCONN_POOL"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_DBCONN_POOL", "ZBX_MUTEX_HISTORY_SHARD_1",
+				"ZBX_MUTEX_HISTORY_SHARD_2", "ZBX_MUTEX_HISTORY_SHARD_3", "ZBX_MUTEX_HISTORY_SHARD_4",
+				"ZBX_MUTEX_HISTORY_SHARD_5", "ZBX_MUTEX_HISTORY_SHARD_6", "ZBX_MUTEX_HISTORY_SHARD_7",
+				"ZBX_MUTEX_HISTORY_SHARD_8", "ZBX_MUTEX_HISTORY_SHARD_9", "ZBX_MUTEX_HISTORY_SHARD_10",
+				"ZBX_MUTEX_HISTORY_SHARD_11", "ZBX_MUTEX_HISTORY_SHARD_12", "ZBX_MUTEX_HISTORY_SHARD_13",
+				"ZBX_MUTEX_HISTORY_SHARD_14", "ZBX_MUTEX_HISTORY_SHARD_15",
+				"ZBX_MUTEX_HISTORY_POOL"};
 #else
 	const char	*names[ZBX_MUTEX_COUNT] = {"ZBX_MUTEX_LOG", "ZBX_MUTEX_CACHE", "ZBX_MUTEX_TRENDS",
 				"ZBX_MUTEX_CACHE_IDS", "ZBX_MUTEX_SELFMON", "ZBX_MUTEX_CPUSTATS", "ZBX_MUTEX_DISKSTATS",
 				"ZBX_MUTEX_VALUECACHE", "ZBX_MUTEX_VMWARE", "ZBX_MUTEX_SQLITE3",
 				"ZBX_MUTEX_PROCSTAT", "ZBX_MUTEX_PROXY_HISTORY", "ZBX_MUTEX_MODBUS",
 				"ZBX_MUTEX_TREND_FUNC", "ZBX_MUTEX_REMOTE_COMMANDS", "ZBX_MUTEX_PROXY_BUFFER",
-				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_DBCONN_POOL"};
+				"ZBX_MUTEX_VPS_MONITOR", "ZBX_MUTEX_DBCONN_POOL", "ZBX_MUTEX_HISTORY_SHARD_1",
+				"ZBX_MUTEX_HISTORY_SHARD_2", "ZBX_MUTEX_HISTORY_SHARD_3", "ZBX_MUTEX_HISTORY_SHARD_4",
+				"ZBX_MUTEX_HISTORY_SHARD_5", "ZBX_MUTEX_HISTORY_SHARD_6", "ZBX_MUTEX_HISTORY_SHARD_7",
+				"ZBX_MUTEX_HISTORY_SHARD_8", "ZBX_MUTEX_HISTORY_SHARD_9", "ZBX_MUTEX_HISTORY_SHARD_10",
+				"ZBX_MUTEX_HISTORY_SHARD_11", "ZBX_MUTEX_HISTORY_SHARD_12", "ZBX_MUTEX_HISTORY_SHARD_13",
+				"ZBX_MUTEX_HISTORY_SHARD_14", "ZBX_MUTEX_HISTORY_SHARD_15",
+				"ZBX_MUTEX_HISTORY_POOL"};
 #endif
 	zbx_json_addarray(json, ZBX_DIAG_LOCKS);
 
@@ -0,0 +1,327 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxeval.h"
+#include "eval.h"
+
+#include "zbxalgo.h"
+#include "zbxvariant.h"
+
+/* output stack operand tracked during compilation */
+typedef struct
+{
+	int		start;	/* index of the first instruction evaluating the operand */
+	zbx_variant_t	value;	/* constant value, ZBX_VARIANT_NONE if the value is known only at runtime */
+}
+eval_operand_t;
+
+static unsigned char	eval_token_opcode(zbx_token_type_t type)
+{
+	switch (type)
+	{
+		case ZBX_EVAL_TOKEN_OP_MINUS:
+			return EVAL_OP_MINUS;
+		case ZBX_EVAL_TOKEN_OP_NOT:
+			return EVAL_OP_NOT;
+		case ZBX_EVAL_TOKEN_OP_ADD:
+			return EVAL_OP_ADD;
+		case ZBX_EVAL_TOKEN_OP_SUB:
+			return EVAL_OP_SUB;
+		case ZBX_EVAL_TOKEN_OP_MUL:
+			return EVAL_OP_MUL;
+		case ZBX_EVAL_TOKEN_OP_DIV:
+			return EVAL_OP_DIV;
+		case ZBX_EVAL_TOKEN_OP_EQ:
+			return EVAL_OP_EQ;
+		case ZBX_EVAL_TOKEN_OP_NE:
+			return EVAL_OP_NE;
+		case ZBX_EVAL_TOKEN_OP_LT:
+			return EVAL_OP_LT;
+		case ZBX_EVAL_TOKEN_OP_LE:
+			return EVAL_OP_LE;
+		case ZBX_EVAL_TOKEN_OP_GT:
+			return EVAL_OP_GT;
+		case ZBX_EVAL_TOKEN_OP_GE:
+			return EVAL_OP_GE;
+		case ZBX_EVAL_TOKEN_OP_AND:
+			return EVAL_OP_AND;
+		case ZBX_EVAL_TOKEN_OP_OR:
+			return EVAL_OP_OR;
+		default:
+			return EVAL_OP_TOKEN;
+	}
+}
+
+static zbx_eval_instr_t	*eval_program_append(zbx_eval_program_t *program, unsigned char op, int index)
+{
+	zbx_eval_instr_t	*instr = &program->instrs[program->instrs_num++];
+
+	instr->op = op;
+	instr->index = (zbx_uint32_t)index;
+	instr->value.ui64 = 0;
+
+	return instr;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates token with constant operands                            *
+ *                                                                            *
+ * Parameters: ctx          - [IN] evaluation context                         *
+ *             token        - [IN] token to evaluate                          *
+ *             operands     - [IN] token operands                             *
+ *             operands_num - [IN] number of token operands                   *
+ *             value        - [OUT] the result                                *
+ *                                                                            *
+ * Return value: SUCCEED - the token was evaluated                            *
+ *               FAIL    - operands are not constant or evaluation failed,    *
+ *                         the token must be evaluated at runtime             *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_evaluate_constant(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		const eval_operand_t *operands, int operands_num, zbx_variant_t *value)
+{
+	zbx_vector_var_t	output;
+	char			*error = NULL;
+	int			i, ret = FAIL;
+
+	for (i = 0; i < operands_num; i++)
+	{
+		if (ZBX_VARIANT_NONE == operands[i].value.type)
+			return FAIL;
+	}
+
+	zbx_vector_var_create(&output);
+
+	for (i = 0; i < operands_num; i++)
+	{
+		zbx_variant_t	arg;
+
+		zbx_variant_copy(&arg, &operands[i].value);
+		zbx_vector_var_append_ptr(&output, &arg);
+	}
+
+	if (SUCCEED == eval_execute_token(ctx, token, &output, &error) && 1 == output.values_num &&
+			ZBX_VARIANT_NONE != output.values[0].type && ZBX_VARIANT_ERR != output.values[0].type)
+	{
+		*value = output.values[0];
+		output.values_num = 0;
+		ret = SUCCEED;
+	}
+
+	zbx_free(error);
+
+	for (i = 0; i < output.values_num; i++)
+		zbx_variant_clear(&output.values[i]);
+
+	zbx_vector_var_destroy(&output);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets constant value of operand token                              *
+ *                                                                            *
+ * Parameters: ctx   - [IN] evaluation context                                *
+ *             token - [IN] operand token                                     *
+ *             value - [OUT] the constant value                               *
+ *                                                                            *
+ * Return value: SUCCEED - the token is constant                              *
+ *               FAIL    - the token value is known only at runtime           *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_get_constant_value(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token,
+		zbx_variant_t *value)
+{
+	if (ZBX_EVAL_TOKEN_VAR_NUM != token->type && ZBX_EVAL_TOKEN_VAR_STR != token->type)
+		return FAIL;
+
+	if (ZBX_VARIANT_NONE != token->value.type)
+		return FAIL;
+
+	/* user macros in constants are substituted after the expression was compiled */
+	if (SUCCEED == eval_has_usermacro(ctx->expression + token->loc.l, token->loc.r - token->loc.l + 1))
+		return FAIL;
+
+	return eval_evaluate_constant(ctx, token, NULL, 0, value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles parsed expression into program                           *
+ *                                                                            *
+ * Parameters: ctx - [IN] evaluation context                                  *
+ *                                                                            *
+ * Return value: The compiled program or NULL if the expression cannot be     *
+ *               compiled or compilation would not speed up its evaluation.   *
+ *                                                                            *
+ * Comments: Numeric constants are parsed and operators with constant         *
+ *           operands are evaluated during compilation. Operators get typed   *
+ *           instructions that are evaluated without converting numeric       *
+ *           operands. All other tokens are executed by their handlers.       *
+ *                                                                            *
+ ******************************************************************************/
+zbx_eval_program_t	*eval_compile(const zbx_eval_context_t *ctx)
+{
+	zbx_eval_program_t	*program;
+	eval_operand_t		*operands, *operand;
+	zbx_eval_instr_t	*instr;
+	zbx_variant_t		value;
+	int			i, j, operands_num = 0, typed_num = 0, ret = FAIL;
+
+	if (NULL == ctx->expression || 0 == ctx->stack.values_num)
+		return NULL;
+
+	program = (zbx_eval_program_t *)zbx_malloc(NULL, sizeof(zbx_eval_program_t));
+	program->instrs = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) *
+			(size_t)ctx->stack.values_num);
+	program->instrs_num = 0;
+	program->depth = 0;
+
+	operands = (eval_operand_t *)zbx_malloc(NULL, sizeof(eval_operand_t) * (size_t)ctx->stack.values_num);
+
+	for (i = 0; i < ctx->stack.values_num; i++)
+	{
+		const zbx_eval_token_t	*token = &ctx->stack.values[i];
+
+		switch (token->type)
+		{
+			case ZBX_EVAL_TOKEN_NOP:
+				continue;
+			case ZBX_EVAL_TOKEN_VAR_NUM:
+			case ZBX_EVAL_TOKEN_VAR_STR:
+			case ZBX_EVAL_TOKEN_VAR_MACRO:
+			case ZBX_EVAL_TOKEN_VAR_USERMACRO:
+			case ZBX_EVAL_TOKEN_FUNCTIONID:
+			case ZBX_EVAL_TOKEN_ARG_QUERY:
+			case ZBX_EVAL_TOKEN_ARG_PERIOD:
+			case ZBX_EVAL_TOKEN_ARG_NULL:
+				operand = &operands[operands_num++];
+				operand->start = program->instrs_num;
+
+				if (SUCCEED != eval_get_constant_value(ctx, token, &operand->value))
+				{
+					zbx_variant_set_none(&operand->value);
+					eval_program_append(program, EVAL_OP_TOKEN, i);
+					break;
+				}
+
+				switch (operand->value.type)
+				{
+					case ZBX_VARIANT_DBL:
+						instr = eval_program_append(program, EVAL_OP_PUSH_DBL, i);
+						instr->value.dbl = operand->value.data.dbl;
+						typed_num++;
+						break;
+					case ZBX_VARIANT_UI64:
+						instr = eval_program_append(program, EVAL_OP_PUSH_UI64, i);
+						instr->value.ui64 = operand->value.data.ui64;
+						typed_num++;
+						break;
+					default:
+						eval_program_append(program, EVAL_OP_TOKEN, i);
+						break;
+				}
+				break;
+			case ZBX_EVAL_TOKEN_FUNCTION:
+			case ZBX_EVAL_TOKEN_HIST_FUNCTION:
+				if (operands_num < (int)token->opt)
+					goto out;
+
+				for (j = operands_num - (int)token->opt; j < operands_num; j++)
+					zbx_variant_clear(&operands[j].value);
+
+				operands_num -= (int)token->opt;
+				operand = &operands[operands_num++];
+
+				if (0 == token->opt)
+					operand->start = program->instrs_num;
+
+				zbx_variant_set_none(&operand->value);
+				eval_program_append(program, EVAL_OP_TOKEN, i);
+				break;
+			case ZBX_EVAL_TOKEN_EXCEPTION:
+				/* exception stops expression evaluation, the remaining tokens are not reachable */
+				eval_program_append(program, EVAL_OP_TOKEN, i);
+				ret = SUCCEED;
+				goto out;
+			default:
+				if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+					j = 1;
+				else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+					j = 2;
+				else
+					goto out;
+
+				if (operands_num < j)
+					goto out;
+
+				operand = &operands[operands_num - j];
+				zbx_variant_set_none(&value);
+
+				if (SUCCEED == eval_evaluate_constant(ctx, token, operand, j, &value) &&
+						ZBX_VARIANT_DBL == value.type)
+				{
+					program->instrs_num = operand->start;
+					instr = eval_program_append(program, EVAL_OP_PUSH_DBL, i);
+					instr->value.dbl = value.data.dbl;
+				}
+				else
+				{
+					zbx_variant_clear(&value);
+					zbx_variant_set_none(&value);
+					eval_program_append(program, eval_token_opcode(token->type), i);
+				}
+
+				typed_num++;
+
+				for (; 1 < j; j--)
+					zbx_variant_clear(&operands[--operands_num].value);
+
+				zbx_variant_clear(&operand->value);
+				operand->value = value;
+				break;
+		}
+
+		if (program->depth < operands_num)
+			program->depth = operands_num;
+	}
+
+	ret = SUCCEED;
+out:
+	for (i = 0; i < operands_num; i++)
+		zbx_variant_clear(&operands[i].value);
+
+	zbx_free(operands);
+
+	if (SUCCEED != ret || 0 == typed_num)
+	{
+		eval_program_free(program);
+		return NULL;
+	}
+
+	return program;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees compiled expression program                                 *
+ *                                                                            *
+ ******************************************************************************/
+void	eval_program_free(zbx_eval_program_t *program)
+{
+	zbx_free(program->instrs);
+	zbx_free(program);
+}
@@ -17,9 +17,54 @@
 
 #include "zbxeval.h"
 
+/* compiled expression instruction codes */
+#define EVAL_OP_TOKEN		0	/* execute source token */
+#define EVAL_OP_PUSH_DBL	1
+#define EVAL_OP_PUSH_UI64	2
+#define EVAL_OP_MINUS		3
+#define EVAL_OP_NOT		4
+#define EVAL_OP_ADD		5
+#define EVAL_OP_SUB		6
+#define EVAL_OP_MUL		7
+#define EVAL_OP_DIV		8
+#define EVAL_OP_EQ		9
+#define EVAL_OP_NE		10
+#define EVAL_OP_LT		11
+#define EVAL_OP_LE		12
+#define EVAL_OP_GT		13
+#define EVAL_OP_GE		14
+#define EVAL_OP_AND		15
+#define EVAL_OP_OR		16
+
+typedef struct
+{
+	unsigned char	op;
+	zbx_uint32_t	index;		/* source token index in evaluation stack */
+	union
+	{
+		double		dbl;
+		zbx_uint64_t	ui64;
+	}
+	value;				/* constant value for push instructions */
+}
+zbx_eval_instr_t;
+
+struct zbx_eval_program
+{
+	zbx_eval_instr_t	*instrs;
+	int			instrs_num;
+	int			depth;		/* maximum output stack depth */
+};
+
 int	eval_suffixed_number_parse(const char *value, char *suffix);
 int	eval_compare_token(const zbx_eval_context_t *ctx, const zbx_strloc_t *loc, const char *text,
 		size_t len);
 size_t	eval_parse_query(const char *str, const char **phost, const char **pkey, const char **pfilter);
+int	eval_has_usermacro(const char *str, size_t len);
+
+int	eval_execute_token(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_vector_var_t *output,
+		char **error);
+zbx_eval_program_t	*eval_compile(const zbx_eval_context_t *ctx);
+void	eval_program_free(zbx_eval_program_t *program);
 
 #endif
@@ -3189,6 +3189,263 @@ static void	eval_throw_exception(zbx_vector_var_t *output, char **error)
 	zbx_variant_set_none(arg);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates single token of pre-parsed expression                   *
+ *                                                                            *
+ * Parameters: ctx    - [IN] evaluation context                               *
+ *             token  - [IN] token to evaluate                                *
+ *             output - [IN/OUT] output value stack                           *
+ *             error  - [OUT] error message in case of failure                *
+ *                                                                            *
+ * Return value: SUCCEED - token was evaluated successfully                   *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	eval_execute_token(const zbx_eval_context_t *ctx, const zbx_eval_token_t *token, zbx_vector_var_t *output,
+		char **error)
+{
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		return eval_execute_op_unary(ctx, token, output, error);
+
+	if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
+		return eval_execute_op_binary(ctx, token, output, error);
+
+	switch (token->type)
+	{
+		case ZBX_EVAL_TOKEN_NOP:
+			return SUCCEED;
+		case ZBX_EVAL_TOKEN_VAR_NUM:
+		case ZBX_EVAL_TOKEN_VAR_STR:
+		case ZBX_EVAL_TOKEN_VAR_MACRO:
+		case ZBX_EVAL_TOKEN_VAR_USERMACRO:
+			return eval_execute_push_value(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_ARG_QUERY:
+		case ZBX_EVAL_TOKEN_ARG_PERIOD:
+			return eval_execute_push_value(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_ARG_NULL:
+			eval_execute_push_null(output);
+			return SUCCEED;
+		case ZBX_EVAL_TOKEN_FUNCTION:
+			return eval_execute_common_function(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_HIST_FUNCTION:
+			return eval_execute_history_function(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_FUNCTIONID:
+			if (ZBX_VARIANT_NONE == token->value.type)
+			{
+				*error = zbx_strdup(*error, "trigger history functions must be pre-calculated");
+				return FAIL;
+			}
+			return eval_execute_push_value(ctx, token, output, error);
+		case ZBX_EVAL_TOKEN_EXCEPTION:
+			eval_throw_exception(output, error);
+			return FAIL;
+		default:
+			*error = zbx_dsprintf(*error, "unknown token at \"%s\"", ctx->expression + token->loc.l);
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets numeric operand value without converting the variant        *
+ *                                                                            *
+ * Parameters: value - [IN] operand                                           *
+ *             dbl   - [OUT] operand value                                    *
+ *                                                                            *
+ * Return value: SUCCEED - operand is a valid number                          *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_get_numeric_operand(const zbx_variant_t *value, double *dbl)
+{
+	switch (value->type)
+	{
+		case ZBX_VARIANT_DBL:
+			*dbl = value->data.dbl;
+			return 0 == isnan(*dbl) ? SUCCEED : FAIL;
+		case ZBX_VARIANT_UI64:
+			*dbl = (double)value->data.ui64;
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compares two floating point values the same way as variants      *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_compare_dbl(double left, double right)
+{
+	if (SUCCEED == zbx_double_compare(left, right))
+		return 0;
+
+	return left < right ? -1 : 1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: evaluates compiled operator with numeric operands                 *
+ *                                                                            *
+ * Parameters: op    - [IN] instruction code                                  *
+ *             left  - [IN] left operand (NULL for unary operators)           *
+ *             right - [IN] right operand                                     *
+ *             value - [OUT] operator result                                  *
+ *                                                                            *
+ * Return value: SUCCEED - operator was evaluated                             *
+ *               FAIL    - operands are not numeric or the operation failed,  *
+ *                         the operator must be evaluated by generic token    *
+ *                         handler to get the same result or error message    *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_execute_op_numeric(unsigned char op, const zbx_variant_t *left, const zbx_variant_t *right,
+		double *value)
+{
+	double	l = 0, r;
+
+	if (SUCCEED != eval_get_numeric_operand(right, &r))
+		return FAIL;
+
+	if (NULL != left && SUCCEED != eval_get_numeric_operand(left, &l))
+		return FAIL;
+
+	switch (op)
+	{
+		case EVAL_OP_MINUS:
+			*value = -r;
+			break;
+		case EVAL_OP_NOT:
+			*value = (SUCCEED == zbx_double_compare(r, 0) ? 1 : 0);
+			break;
+		case EVAL_OP_EQ:
+		case EVAL_OP_NE:
+			if (ZBX_VARIANT_UI64 == left->type && ZBX_VARIANT_UI64 == right->type)
+				*value = (left->data.ui64 == right->data.ui64 ? 1 : 0);
+			else
+				*value = (0 == eval_compare_dbl(l, r) ? 1 : 0);
+
+			if (EVAL_OP_NE == op)
+				*value = 1 - *value;
+			return SUCCEED;
+		case EVAL_OP_LT:
+			*value = (0 > eval_compare_dbl(l, r) ? 1 : 0);
+			return SUCCEED;
+		case EVAL_OP_LE:
+			*value = (0 >= eval_compare_dbl(l, r) ? 1 : 0);
+			return SUCCEED;
+		case EVAL_OP_GT:
+			*value = (0 < eval_compare_dbl(l, r) ? 1 : 0);
+			return SUCCEED;
+		case EVAL_OP_GE:
+			*value = (0 <= eval_compare_dbl(l, r) ? 1 : 0);
+			return SUCCEED;
+		case EVAL_OP_AND:
+			*value = (SUCCEED == zbx_double_compare(l, 0) || SUCCEED == zbx_double_compare(r, 0) ? 0 : 1);
+			return SUCCEED;
+		case EVAL_OP_OR:
+			*value = (SUCCEED != zbx_double_compare(l, 0) || SUCCEED != zbx_double_compare(r, 0) ? 1 : 0);
+			return SUCCEED;
+		case EVAL_OP_ADD:
+			*value = l + r;
+			break;
+		case EVAL_OP_SUB:
+			*value = l - r;
+			break;
+		case EVAL_OP_MUL:
+			*value = l * r;
+			break;
+		case EVAL_OP_DIV:
+			if (SUCCEED == zbx_double_compare(r, 0))
+				return FAIL;
+			*value = l / r;
+			break;
+		default:
+			return FAIL;
+	}
+
+	if (FP_ZERO != fpclassify(*value) && FP_NORMAL != fpclassify(*value))
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: executes compiled expression program                              *
+ *                                                                            *
+ * Parameters: ctx    - [IN] evaluation context                               *
+ *             output - [IN/OUT] output value stack                           *
+ *             error  - [OUT] error message in case of failure                *
+ *                                                                            *
+ * Return value: SUCCEED - program was executed successfully                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Constants are pushed without parsing and operators with numeric  *
+ *           operands are evaluated in place. Everything else is delegated to *
+ *           the token handlers.                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	eval_execute_program(const zbx_eval_context_t *ctx, zbx_vector_var_t *output, char **error)
+{
+	const zbx_eval_program_t	*program = ctx->program;
+	int				i;
+
+	zbx_vector_var_reserve(output, (size_t)program->depth);
+
+	for (i = 0; i < program->instrs_num; i++)
+	{
+		const zbx_eval_instr_t	*instr = &program->instrs[i];
+		zbx_variant_t		*left, *right, value;
+		double			dbl;
+
+		switch (instr->op)
+		{
+			case EVAL_OP_PUSH_DBL:
+				zbx_variant_set_dbl(&value, instr->value.dbl);
+				zbx_vector_var_append_ptr(output, &value);
+				continue;
+			case EVAL_OP_PUSH_UI64:
+				zbx_variant_set_ui64(&value, instr->value.ui64);
+				zbx_vector_var_append_ptr(output, &value);
+				continue;
+			case EVAL_OP_TOKEN:
+				break;
+			case EVAL_OP_MINUS:
+			case EVAL_OP_NOT:
+				if (1 > output->values_num)
+					break;
+
+				right = &output->values[output->values_num - 1];
+
+				if (SUCCEED != eval_execute_op_numeric(instr->op, NULL, right, &dbl))
+					break;
+
+				zbx_variant_set_dbl(right, dbl);
+				continue;
+			default:
+				if (2 > output->values_num)
+					break;
+
+				left = &output->values[output->values_num - 2];
+				right = &output->values[output->values_num - 1];
+
+				if (SUCCEED != eval_execute_op_numeric(instr->op, left, right, &dbl))
+					break;
+
+				zbx_variant_set_dbl(left, dbl);
+				output->values_num--;
+				continue;
+		}
+
+		if (SUCCEED != eval_execute_token(ctx, &ctx->stack.values[instr->index], output, error))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: evaluates pre-parsed expression                                   *
@@ -3208,70 +3465,21 @@ static int	eval_execute(const zbx_eval_context_t *ctx, zbx_variant_t *value, cha
 	char			*errmsg = NULL;
 
 	zbx_vector_var_create(&output);
-	zbx_vector_var_reserve(&output, 3);
 
-	for (i = 0; i < ctx->stack.values_num; i++)
+	if (NULL != ctx->program)
+	{
+		if (SUCCEED != eval_execute_program(ctx, &output, &errmsg))
+			goto out;
+	}
+	else
 	{
-		zbx_eval_token_t	*token = &ctx->stack.values[i];
+		zbx_vector_var_reserve(&output, 3);
 
-		if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR1))
+		for (i = 0; i < ctx->stack.values_num; i++)
 		{
-			if (SUCCEED != eval_execute_op_unary(ctx, token, &output, &errmsg))
+			if (SUCCEED != eval_execute_token(ctx, &ctx->stack.values[i], &output, &errmsg))
 				goto out;
 		}
-		else if (0 != (token->type & ZBX_EVAL_CLASS_OPERATOR2))
-		{
-			if (SUCCEED != eval_execute_op_binary(ctx, token, &output, &errmsg))
-				goto out;
-		}
-		else
-		{
-			switch (token->type)
-			{
-				case ZBX_EVAL_TOKEN_NOP:
-					break;
-				case ZBX_EVAL_TOKEN_VAR_NUM:
-				case ZBX_EVAL_TOKEN_VAR_STR:
-				case ZBX_EVAL_TOKEN_VAR_MACRO:
-				case ZBX_EVAL_TOKEN_VAR_USERMACRO:
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_ARG_QUERY:
-				case ZBX_EVAL_TOKEN_ARG_PERIOD:
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_ARG_NULL:
-					eval_execute_push_null(&output);
-					break;
-				case ZBX_EVAL_TOKEN_FUNCTION:
-					if (SUCCEED != eval_execute_common_function(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_HIST_FUNCTION:
-					if (SUCCEED != eval_execute_history_function(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_FUNCTIONID:
-					if (ZBX_VARIANT_NONE == token->value.type)
-					{
-						errmsg = zbx_strdup(errmsg, "trigger history functions must be"
-								" pre-calculated");
-						goto out;
-					}
-					if (SUCCEED != eval_execute_push_value(ctx, token, &output, &errmsg))
-						goto out;
-					break;
-				case ZBX_EVAL_TOKEN_EXCEPTION:
-					eval_throw_exception(&output, &errmsg);
-					goto out;
-				default:
-					errmsg = zbx_dsprintf(errmsg, "unknown token at \"%s\"",
-							ctx->expression + token->loc.l);
-					goto out;
-			}
-		}
 	}
 
 	if (1 != output.values_num)
@@ -138,6 +138,73 @@ static zbx_uint32_t	deserialize_variant(const unsigned char *ptr,  zbx_variant_t
 	return ptr - start;
 }
 
+static void	serialize_program(unsigned char **buffer, size_t *size, const zbx_eval_program_t *program,
+		unsigned char **ptr)
+{
+	int	i;
+
+	reserve_buffer(buffer, size, 12, ptr);
+	*ptr += zbx_serialize_uint31_compact(*ptr, program->instrs_num);
+	*ptr += zbx_serialize_uint31_compact(*ptr, program->depth);
+
+	for (i = 0; i < program->instrs_num; i++)
+	{
+		const zbx_eval_instr_t	*instr = &program->instrs[i];
+
+		/* 1 byte instruction code, 6 bytes compact uint31 and 8 bytes constant value */
+		reserve_buffer(buffer, size, 15, ptr);
+
+		**ptr = instr->op;
+		(*ptr)++;
+		*ptr += zbx_serialize_uint31_compact(*ptr, instr->index);
+
+		switch (instr->op)
+		{
+			case EVAL_OP_PUSH_DBL:
+				*ptr += zbx_serialize_double(*ptr, instr->value.dbl);
+				break;
+			case EVAL_OP_PUSH_UI64:
+				*ptr += zbx_serialize_uint64(*ptr, instr->value.ui64);
+				break;
+		}
+	}
+}
+
+static zbx_eval_program_t	*deserialize_program(const unsigned char *ptr)
+{
+	zbx_eval_program_t	*program;
+	zbx_uint32_t		instrs_num, depth;
+	int			i;
+
+	ptr += zbx_deserialize_uint31_compact(ptr, &instrs_num);
+	ptr += zbx_deserialize_uint31_compact(ptr, &depth);
+
+	program = (zbx_eval_program_t *)zbx_malloc(NULL, sizeof(zbx_eval_program_t));
+	program->instrs = (zbx_eval_instr_t *)zbx_malloc(NULL, sizeof(zbx_eval_instr_t) * instrs_num);
+	program->instrs_num = (int)instrs_num;
+	program->depth = (int)depth;
+
+	for (i = 0; i < program->instrs_num; i++)
+	{
+		zbx_eval_instr_t	*instr = &program->instrs[i];
+
+		ptr += zbx_deserialize_char(ptr, &instr->op);
+		ptr += zbx_deserialize_uint31_compact(ptr, &instr->index);
+
+		switch (instr->op)
+		{
+			case EVAL_OP_PUSH_DBL:
+				ptr += zbx_deserialize_double(ptr, &instr->value.dbl);
+				break;
+			case EVAL_OP_PUSH_UI64:
+				ptr += zbx_deserialize_uint64(ptr, &instr->value.ui64);
+				break;
+		}
+	}
+
+	return program;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: serializes evaluation context into buffer                         *
@@ -152,6 +219,8 @@ static zbx_uint32_t	deserialize_variant(const unsigned char *ptr,  zbx_variant_t
  *           serialized, making it impossible to reconstruct the expression   *
  *           text with replaced tokens. Context serialization/deserialization *
  *           must be used for context caching.                                *
+ *           The compiled expression program is appended after the tokens,    *
+ *           so it is cached together with the serialized context.            *
  *                                                                            *
  * Return value: size of serialized data                                      *
  *                                                                            *
@@ -159,10 +228,12 @@ static zbx_uint32_t	deserialize_variant(const unsigned char *ptr,  zbx_variant_t
 size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t malloc_func,
 		unsigned char **data)
 {
-	int		i;
-	unsigned char	buffer_static[ZBX_EVAL_STATIC_BUFFER_SIZE], *buffer = buffer_static, *ptr = buffer, len_buff[6];
-	size_t		buffer_size = ZBX_EVAL_STATIC_BUFFER_SIZE;
-	zbx_uint32_t	len, len_offset;
+	int			i;
+	unsigned char		buffer_static[ZBX_EVAL_STATIC_BUFFER_SIZE], *buffer = buffer_static, *ptr = buffer,
+				len_buff[6];
+	size_t			buffer_size = ZBX_EVAL_STATIC_BUFFER_SIZE;
+	zbx_uint32_t		len, len_offset;
+	zbx_eval_program_t	*program;
 
 	if (NULL == malloc_func)
 		malloc_func = ZBX_DEFAULT_MEM_MALLOC_FUNC;
@@ -185,6 +256,14 @@ size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t m
 		serialize_variant(&buffer, &buffer_size, &token->value, &ptr);
 	}
 
+	if (NULL != (program = ctx->program) || NULL != (program = eval_compile(ctx)))
+	{
+		serialize_program(&buffer, &buffer_size, program, &ptr);
+
+		if (program != ctx->program)
+			eval_program_free(program);
+	}
+
 	len = ptr - buffer;
 
 	len_offset = zbx_serialize_uint31_compact(len_buff, len);
@@ -213,13 +292,15 @@ size_t	zbx_eval_serialize(const zbx_eval_context_t *ctx, zbx_mem_malloc_func_t m
 void	zbx_eval_deserialize(zbx_eval_context_t *ctx, const char *expression, zbx_uint64_t rules,
 		const unsigned char *data)
 {
-	zbx_uint32_t	i, tokens_num, len, pos;
+	zbx_uint32_t		i, tokens_num, len, pos;
+	const unsigned char	*end;
 
 	memset(ctx, 0, sizeof(zbx_eval_context_t));
 	ctx->expression = expression;
 	ctx->rules = rules;
 
 	data += zbx_deserialize_uint31_compact(data, &len);
+	end = data + len;
 	data += zbx_deserialize_uint31_compact(data, &tokens_num);
 	zbx_vector_eval_token_create(&ctx->stack);
 	zbx_vector_eval_token_reserve(&ctx->stack, tokens_num);
@@ -239,6 +320,9 @@ void	zbx_eval_deserialize(zbx_eval_context_t *ctx, const char *expression, zbx_u
 
 		data += deserialize_variant(data, &token->value);
 	}
+
+	if (data < end)
+		ctx->program = deserialize_program(data);
 }
 
 int	zbx_eval_compare_tokens_by_loc(const void *d1, const void *d2)
@@ -486,7 +570,7 @@ void	zbx_eval_compose_expression(const zbx_eval_context_t *ctx, char **expressio
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-static int	eval_has_usermacro(const char *str, size_t len)
+int	eval_has_usermacro(const char *str, size_t len)
 {
 	const char	*ptr;
 
@@ -1183,6 +1267,7 @@ void	zbx_eval_copy(zbx_eval_context_t *dst, const zbx_eval_context_t *src, const
 
 	dst->expression = expression;
 	dst->rules = src->rules;
+	dst->program = NULL;
 	zbx_vector_eval_token_create(&dst->stack);
 	zbx_vector_eval_token_reserve(&dst->stack, (size_t)src->stack.values_num);
 
@@ -1192,6 +1192,12 @@ static void	eval_clear(zbx_eval_context_t *ctx)
 
 		zbx_vector_eval_token_destroy(&ctx->stack);
 	}
+
+	if (NULL != ctx->program)
+	{
+		eval_program_free(ctx->program);
+		ctx->program = NULL;
+	}
 }
 
 /******************************************************************************
@@ -1218,6 +1224,7 @@ static int	eval_parse_expression(zbx_eval_context_t *ctx, const char *expression
 	ctx->last_token_type = ZBX_EVAL_CLASS_SEPARATOR;
 	ctx->const_index = 0;
 	ctx->functionid_index = 0;
+	ctx->program = NULL;
 	zbx_vector_eval_token_create(&ctx->stack);
 	zbx_vector_eval_token_reserve(&ctx->stack, 16);
 	zbx_vector_eval_token_create(&ctx->ops);
@@ -35,8 +35,23 @@
 #include "zbxcacheconfig.h"
 #include "zbxregexp.h"
 #include "zbxtime.h"
+#include "zbxcompress.h"
 #include "zbx_dbversion_constants.h"
 
+/* the maximum size of uncompressed data posted in single insert request */
+#define ZBX_CLICKHOUSE_CHUNK_SIZE		(4 * ZBX_MEBIBYTE)
+
+/* smaller inserts are posted without compression */
+#define ZBX_CLICKHOUSE_COMPRESS_MIN_SIZE	ZBX_KIBIBYTE
+
+/* the default and maximum number of concurrent insert requests, every request */
+/* buffers up to one chunk of data until it is posted                          */
+#define ZBX_CLICKHOUSE_POOL_SIZE_DEFAULT	8
+#define ZBX_CLICKHOUSE_POOL_SIZE_MAX		64
+
+#define ZBX_CLICKHOUSE_COMPRESSION_NONE		"none"
+#define ZBX_CLICKHOUSE_COMPRESSION_DEFLATE	"deflate"
+
 typedef struct
 {
 	unsigned char		value_type;
@@ -64,6 +79,7 @@ typedef struct
 	char					*fetch_url;
 
 	struct curl_slist			*curl_headers;
+	struct curl_slist			*curl_headers_deflate;
 
 	zbx_vector_clickhouse_conn_ptr_t	conns;
 	zbx_vector_clickhouse_conn_ptr_t	active_conns;
@@ -73,9 +89,14 @@ typedef struct
 	int					log_slow_queries;
 	int					ssl_verify_peer;
 	int					ssl_verify_host;
+	int					compress;
+	int					pool_size;
 
 	zbx_uint64_t				value_type_flags;
 
+	/* errors of inserts flushed early, before flush() was called */
+	zbx_uint64_t				flush_err;
+
 	const char				*base_url;
 	const char				*username;
 	const char				*password;
@@ -94,6 +115,8 @@ zbx_clickhouse_data_t;
 static char	*clickhouse_history_tables[] = {"history", "history_str", "history_log", "history_uint", "history_text",
 					"history_bin", "history_json", "unsupported"};
 
+static zbx_uint64_t	history_clickhouse_flush(void *data);
+
 static void	clickhouse_conn_free(zbx_clickhouse_conn_t *conn)
 {
 	curl_easy_cleanup(conn->handle);
@@ -110,6 +133,7 @@ static void	history_clickhouse_data_free(zbx_clickhouse_data_t *data)
 	zbx_vector_clickhouse_conn_ptr_destroy(&data->conns);
 
 	curl_slist_free_all(data->curl_headers);
+	curl_slist_free_all(data->curl_headers_deflate);
 	curl_multi_cleanup(data->mhandle);
 
 	zbx_free(data->db);
@@ -202,6 +226,8 @@ static void	history_clickhouse_validate_options(const zbx_history_option_t *opti
 				HISTORY_PROVIDER_OPTION_SSL_CERT_LOCATION ","
 				HISTORY_PROVIDER_OPTION_SSL_KEY_LOCATION ","
 				HISTORY_PROVIDER_OPTION_PRECACHE ","
+				HISTORY_PROVIDER_OPTION_COMPRESSION ","
+				HISTORY_PROVIDER_OPTION_POOL_SIZE ","
 			;
 
 	for (int i = 0; i < options_num; i++)
@@ -290,6 +316,45 @@ static void	*history_clickhouse_create_data(const zbx_history_option_t *options,
 	if (NULL != (value = history_option_value(options, options_num, HISTORY_PROVIDER_OPTION_LOG_SLOW_QUERIES)))
 		data->log_slow_queries = atoi(value);
 
+#ifdef HAVE_ZLIB
+	data->compress = 1;
+#endif
+	if (NULL != (value = history_option_value(options, options_num, HISTORY_PROVIDER_OPTION_COMPRESSION)))
+	{
+		if (0 == strcmp(value, ZBX_CLICKHOUSE_COMPRESSION_NONE))
+		{
+			data->compress = 0;
+		}
+		else if (0 != strcmp(value, ZBX_CLICKHOUSE_COMPRESSION_DEFLATE))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "unsupported ClickHouse history provider compression \"%s\","
+					" using default", value);
+		}
+		else if (0 == data->compress)
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "ClickHouse history provider compression \"%s\" requires"
+					" zlib support, data will be sent uncompressed", value);
+		}
+	}
+
+	data->pool_size = ZBX_CLICKHOUSE_POOL_SIZE_DEFAULT;
+
+	if (NULL != (value = history_option_value(options, options_num, HISTORY_PROVIDER_OPTION_POOL_SIZE)))
+	{
+		unsigned int	pool_size;
+
+		if (SUCCEED != zbx_is_uint_range(value, &pool_size, 1, ZBX_CLICKHOUSE_POOL_SIZE_MAX))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "invalid ClickHouse history provider pool size \"%s\","
+					" using default %d", value, ZBX_CLICKHOUSE_POOL_SIZE_DEFAULT);
+		}
+		else
+			data->pool_size = (int)pool_size;
+	}
+
+	if (0 != data->compress)
+		data->curl_headers_deflate = curl_slist_append(NULL, "Content-Encoding: " ZBX_CLICKHOUSE_COMPRESSION_DEFLATE);
+
 	zbx_vector_clickhouse_conn_ptr_create(&data->conns);
 	zbx_vector_clickhouse_conn_ptr_create(&data->active_conns);
 
@@ -460,6 +525,102 @@ static int	is_json_object(const char *json_str)
 	return FAIL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: queue insert request with single chunk of history data           *
+ *                                                                            *
+ * Parameters:                                                                *
+ *     d          - [IN] internal ClickHouse data                             *
+ *     value_type - [IN] value type (ITEM_VALUE_TYPE_*)                       *
+ *     url        - [IN] insert request URL                                   *
+ *     data       - [IN/OUT] RowBinary encoded data                           *
+ *     data_alloc - [IN/OUT] allocated data size                              *
+ *     data_size  - [IN] encoded data size                                    *
+ *                                                                            *
+ * Comments: If the data is not compressed, the data buffer is passed to      *
+ *           connection and reset, otherwise it can be reused for encoding    *
+ *           next chunk.                                                      *
+ *           Queued requests are flushed when their number reaches pool size, *
+ *           limiting concurrent requests and buffered data to pool size      *
+ *           chunks. Errors of such flushes are returned by the next flush(). *
+ *                                                                            *
+ ******************************************************************************/
+static void	history_clickhouse_queue_chunk(zbx_clickhouse_data_t *d, unsigned char value_type, const char *url,
+		char **data, size_t *data_alloc, size_t data_size)
+{
+	zbx_clickhouse_conn_t	*conn;
+	char			*error = NULL, *post_data = NULL;
+	size_t			post_data_size = 0;
+	struct curl_slist	*headers = d->curl_headers;
+	CURLoption		opt;
+	CURLcode		err;
+
+	conn = history_clickhouse_get_conn(d, value_type);
+
+	if (NULL == conn->handle && SUCCEED != history_clickhouse_conn_init(conn, d, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: %s", error);
+		zbx_free(error);
+		history_clickhouse_release_conn(d, conn);
+
+		return;
+	}
+
+	if (0 != d->compress && ZBX_CLICKHOUSE_COMPRESS_MIN_SIZE <= data_size)
+	{
+		if (SUCCEED == zbx_compress(*data, data_size, &post_data, &post_data_size))
+		{
+			headers = d->curl_headers_deflate;
+		}
+		else
+		{
+			zabbix_log(LOG_LEVEL_DEBUG, "cannot compress ClickHouse insert data: %s",
+					zbx_compress_strerror());
+		}
+	}
+
+	if (NULL == post_data)
+	{
+		post_data = *data;
+		post_data_size = data_size;
+		*data = NULL;
+		*data_alloc = 0;
+	}
+
+	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_URL, url)) ||
+		CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_HTTPHEADER, headers)) ||
+		CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_POSTFIELDSIZE, (long)post_data_size)) ||
+		CURLE_OK != (err = curl_easy_setopt(conn->handle, opt = CURLOPT_POSTFIELDS, post_data)))
+	{
+		zbx_free(post_data);
+		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: cannot set curl option %d: %s",
+				(int)opt, curl_easy_strerror(err));
+		history_clickhouse_release_conn(d, conn);
+
+		return;
+	}
+
+	if (NULL != conn->post_data)
+	{
+		THIS_SHOULD_NEVER_HAPPEN_MSG("ClickHouse connection buffer has not been freed before write");
+		zbx_free(conn->post_data);
+	}
+
+	conn->post_data = post_data;
+
+	if (0 != conn->resp.page.alloc)
+	{
+		conn->resp.page.offset = 0;
+		*conn->resp.page.data = '\0';
+	}
+	*conn->resp.errbuf = '\0';
+
+	zbx_vector_clickhouse_conn_ptr_append(&d->active_conns, conn);
+
+	if (d->pool_size <= d->active_conns.values_num)
+		d->flush_err |= history_clickhouse_flush(d);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: write history data to ClickHouse                                  *
@@ -470,7 +631,9 @@ static int	is_json_object(const char *json_str)
  *     entries     - [IN] array of history entries to write                   *
  *     entries_num - [IN] number of entries to write                          *
  *                                                                            *
- * Comments: The data are buffered until flush() is called.                   *
+ * Comments: The data are buffered until flush() is called. Large batches are *
+ *           split into multiple insert requests of limited size, which are   *
+ *           compressed and posted in parallel by up to pool size requests.   *
  *                                                                            *
  ******************************************************************************/
 static void	history_clickhouse_write(void *data, unsigned char value_type,
@@ -478,11 +641,8 @@ static void	history_clickhouse_write(void *data, unsigned char value_type,
 {
 #define ZBX_CLICKHOUSE_ASYNC_INSERT	"&async_insert=1&wait_for_async_insert=0"
 	zbx_clickhouse_data_t	*d = (zbx_clickhouse_data_t *)data;
-	zbx_clickhouse_conn_t	*conn;
-	char			*error = NULL, url[MAX_STRING_LEN], *post_data = NULL;
+	char			url[MAX_STRING_LEN], *post_data = NULL;
 	size_t			post_data_alloc = 0, post_data_offset = 0;
-	CURLcode		err;
-	int			ret = FAIL;
 
 	/* bin is not supported */
 	if (ITEM_VALUE_TYPE_BIN == value_type)
@@ -492,16 +652,6 @@ static void	history_clickhouse_write(void *data, unsigned char value_type,
 		return;
 	}
 
-	conn = history_clickhouse_get_conn(d, value_type);
-
-	if (NULL == conn->handle && SUCCEED != history_clickhouse_conn_init(conn, d, &error))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: %s", error);
-		zbx_free(error);
-
-		goto out;
-	}
-
 	if (ITEM_VALUE_TYPE_JSON == value_type)
 	{
 		zbx_snprintf(url, sizeof(url), "%s?database=%s"
@@ -515,20 +665,18 @@ static void	history_clickhouse_write(void *data, unsigned char value_type,
 			d->db, clickhouse_history_tables[value_type]);
 	}
 
-	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, CURLOPT_URL, url)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: cannot set curl option %d: %s",
-				(int)CURLOPT_URL, curl_easy_strerror(err));
-		goto out;
-	}
-
-	post_data_alloc = entries_num * (sizeof(zbx_uint64_t) * 3) + 8;
-	post_data = zbx_malloc(NULL, post_data_alloc);
-
 	for (int i = 0; i < entries_num; i++)
 	{
 		const zbx_history_entry_t	*entry = entries[i];
 
+		if (NULL == post_data)
+		{
+			post_data_alloc = MIN((size_t)(entries_num - i) * (sizeof(zbx_uint64_t) * 3) + 8,
+					ZBX_CLICKHOUSE_CHUNK_SIZE + ZBX_KIBIBYTE);
+			post_data = zbx_malloc(NULL, post_data_alloc);
+			post_data_offset = 0;
+		}
+
 		history_clickhouse_write_uint64(entry->itemid, &post_data, &post_data_alloc, &post_data_offset);
 		history_clickhouse_write_uint64((zbx_uint64_t)entry->ts.sec * 1000000000ULL + entry->ts.ns,
 				&post_data, &post_data_alloc, &post_data_offset);
@@ -579,45 +727,19 @@ static void	history_clickhouse_write(void *data, unsigned char value_type,
 				THIS_SHOULD_NEVER_HAPPEN_MSG("unexpected value type %u", (unsigned char)value_type);
 				break;
 		}
-	}
-
-	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, CURLOPT_POSTFIELDSIZE, post_data_offset)))
-	{
-		zbx_free(post_data);
-		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: cannot set curl option %d: %s",
-				(int)CURLOPT_POSTFIELDSIZE, curl_easy_strerror(err));
-		goto out;
-	}
-
-	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, CURLOPT_POSTFIELDS, post_data)))
-	{
-		zbx_free(post_data);
-		zabbix_log(LOG_LEVEL_WARNING, "cannot write data to ClickHouse: cannot set curl option %d: %s",
-				(int)CURLOPT_POSTFIELDS, curl_easy_strerror(err));
-		goto out;
-	}
 
-	if (NULL != conn->post_data)
-	{
-		THIS_SHOULD_NEVER_HAPPEN_MSG("ClickHouse connection buffer has not been freed before write");
-		zbx_free(conn->post_data);
+		if (ZBX_CLICKHOUSE_CHUNK_SIZE <= post_data_offset)
+		{
+			history_clickhouse_queue_chunk(d, value_type, url, &post_data, &post_data_alloc,
+					post_data_offset);
+			post_data_offset = 0;
+		}
 	}
 
-	conn->post_data = post_data;
+	if (0 != post_data_offset)
+		history_clickhouse_queue_chunk(d, value_type, url, &post_data, &post_data_alloc, post_data_offset);
 
-	if (0 != conn->resp.page.alloc)
-	{
-		conn->resp.page.offset = 0;
-		*conn->resp.page.data = '\0';
-	}
-	*conn->resp.errbuf = '\0';
-
-	ret = SUCCEED;
-out:
-	if (SUCCEED == ret)
-		zbx_vector_clickhouse_conn_ptr_append(&d->active_conns, conn);
-	else
-		history_clickhouse_release_conn(d, conn);
+	zbx_free(post_data);
 #undef ZBX_CLICKHOUSE_ASYNC_INSERT
 }
 
@@ -807,19 +929,21 @@ out:
  * Parameters:                                                                *
  *     data - [IN] internal ClickHouse data                                   *
  *                                                                            *
- * Return value: flush error bitmap                                           *
+ * Return value: flush error bitmap, including errors of early flushes         *
  *                                                                            *
  ******************************************************************************/
 static zbx_uint64_t	history_clickhouse_flush(void *data)
 {
 	zbx_clickhouse_data_t	*d = (zbx_clickhouse_data_t *)data;
-	zbx_uint64_t		flush_err = 0;
+	zbx_uint64_t		flush_err = d->flush_err;
 	int			attempts_num = 0;
 	CURLMcode		code;
 	CURLcode		err;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() active connections:%d", __func__, d->active_conns.values_num);
 
+	d->flush_err = 0;
+
 	if (0 == d->active_conns.values_num)
 		goto out;
 
@@ -833,8 +957,7 @@ static zbx_uint64_t	history_clickhouse_flush(void *data)
 						curl_multi_strerror(code));
 		}
 
-		zabbix_log(LOG_LEVEL_TRACE, "posting history to ClickHouse for value_type %d: %s", conn->value_type,
-				conn->post_data);
+		zabbix_log(LOG_LEVEL_TRACE, "posting history to ClickHouse for value_type %d", conn->value_type);
 	}
 
 	while (1)
@@ -894,241 +1017,175 @@ out:
 	return flush_err;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: parse log value from JSON                                         *
- *                                                                            *
- * Parameters:                                                                *
- *     jp  - [IN] row with log data as JSON array of values                   *
- *     p   - [IN] pointer to current position in JSON data                    *
- *     log - [OUT] log value structure to fill                                *
- *                                                                            *
- * Return value: pointer to next position in JSON data or NULL on failure     *
- *                                                                            *
- ******************************************************************************/
-static const char	*history_clickhouse_parse_log_value(const struct zbx_json_parse *jp, const char *p,
-		zbx_log_value_t *log)
+static int	history_clickhouse_read_leb128(const unsigned char **data, const unsigned char *end,
+		zbx_uint64_t *value)
 {
-	char	buf[MAX_ID_LEN] = {0};
-	size_t	source_alloc = 0;
+	const unsigned char	*ptr = *data;
+	int			shift = 0;
 
-	if (NULL == (p = zbx_json_next_value_dyn(jp, p, &log->source, &source_alloc, NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse log source from row \"%s\"", jp->start);
-		return NULL;
-	}
+	*value = 0;
 
-	if (NULL == (p = zbx_json_next_value(jp, p, buf, sizeof(buf), NULL)))
+	do
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse log severity from row \"%s\"", jp->start);
-		return NULL;
-	}
-	log->severity = atoi(buf);
+		if (ptr >= end || 64 <= shift)
+			return FAIL;
 
-	if (NULL == (p = zbx_json_next_value(jp, p, buf, sizeof(buf), NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse log eventid from row \"%s\"", jp->start);
-		return NULL;
+		*value |= (zbx_uint64_t)(*ptr & 0x7f) << shift;
+		shift += 7;
 	}
-	log->logeventid = atoi(buf);
+	while (0 != (*ptr++ & 0x80));
 
-	if (NULL == (p = zbx_json_next_value(jp, p, buf, sizeof(buf), NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse log timestamp from row \"%s\"", jp->start);
-		return NULL;
-	}
-	log->timestamp = atoi(buf);
+	*data = ptr;
 
-	return p;
+	return SUCCEED;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: parse numeric value (float or uint64) from JSON row               *
- *                                                                            *
- * Parameters:                                                                *
- *     jp         - [IN] row with data as JSON array of values                *
- *     p          - [IN] pointer to current position in JSON data             *
- *     value_type - [IN] value type (ITEM_VALUE_TYPE_FLOAT or                 *
- *                       ITEM_VALUE_TYPE_UINT64)                              *
- *     record     - [OUT] history record structure to fill                    *
- *                                                                            *
- * Return value: pointer to next position in JSON data or NULL on failure     *
- *                                                                            *
- ******************************************************************************/
-static const char	*history_clickhouse_parse_numeric_value(const struct zbx_json_parse *jp, const char *p,
-		unsigned char value_type, zbx_history_record_t *record)
+static int	history_clickhouse_read_text(const unsigned char **data, const unsigned char *end, char **str)
 {
-	char	buf[ZBX_MAX_DOUBLE_LEN + 1];
+	zbx_uint64_t	len;
 
-	if (NULL == (p = zbx_json_next_value(jp, p, buf, sizeof(buf), NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse value from row \"%s\"", jp->start);
-		return NULL;
-	}
+	if (SUCCEED != history_clickhouse_read_leb128(data, end, &len) || (zbx_uint64_t)(end - *data) < len)
+		return FAIL;
 
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_FLOAT:
-			if (FAIL == zbx_is_double(buf, &record->value.dbl))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot parse floating value \"%s\"", buf);
-				return NULL;
-			}
-			break;
-		case ITEM_VALUE_TYPE_UINT64:
-			if (FAIL == zbx_is_uint64(buf, &record->value.ui64))
-			{
-				zabbix_log(LOG_LEVEL_WARNING, "cannot parse unsigned 64-bit value \"%s\"", buf);
-				return NULL;
-			}
-			break;
-		default:
-			THIS_SHOULD_NEVER_HAPPEN;
-			return NULL;
-	}
+	*str = (char *)zbx_malloc(NULL, (size_t)len + 1);
+	memcpy(*str, *data, (size_t)len);
+	(*str)[len] = '\0';
+	*data += len;
 
-	return p;
+	return SUCCEED;
 }
 
-/******************************************************************************
- *                                                                            *
- * Purpose: parse non-numeric value (str, text or log) from JSON row          *
- *                                                                            *
- * Parameters:                                                                *
- *     jp         - [IN] row with data as JSON array of values                *
- *     p          - [IN] pointer to current position in JSON data             *
- *     value_type - [IN] item value type                                      *
- *     record     - [OUT] history record structure to fill                    *
- *                                                                            *
- * Return value: pointer to next position in JSON data or NULL on failure     *
- *                                                                            *
- ******************************************************************************/
-static const char	*history_clickhouse_parse_value(const struct zbx_json_parse *jp, const char *p,
-		unsigned char value_type, zbx_history_record_t *record)
+static int	history_clickhouse_read_uint64(const unsigned char **data, const unsigned char *end,
+		zbx_uint64_t *ui64)
 {
-	char	*buf = NULL;
-	size_t	buf_alloc = 0;
+	zbx_uint64_t	number;
 
-	if (NULL == (p = zbx_json_next_value_dyn(jp, p, &buf, &buf_alloc, NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse value from row \"%s\"", jp->start);
-		zbx_free(buf);
-		return NULL;
-	}
+	if ((size_t)(end - *data) < sizeof(number))
+		return FAIL;
 
-	switch (value_type)
-	{
-		case ITEM_VALUE_TYPE_STR:
-		case ITEM_VALUE_TYPE_TEXT:
-			record->value.str = buf;
-			break;
-		case ITEM_VALUE_TYPE_LOG:
-			record->value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
-			record->value.log->value = buf;
-			record->value.log->source = NULL;
+	memcpy(&number, *data, sizeof(number));
+	*ui64 = zbx_letoh_uint64(number);
+	*data += sizeof(number);
 
-			if (NULL == (p = history_clickhouse_parse_log_value(jp, p, record->value.log)))
-			{
-				zbx_history_record_clear(record, ITEM_VALUE_TYPE_LOG);
-				return NULL;
-			}
-			break;
-		default:
-			zbx_free(buf);
-			THIS_SHOULD_NEVER_HAPPEN;
-			return NULL;
-	}
+	return SUCCEED;
+}
+
+static int	history_clickhouse_read_dbl(const unsigned char **data, const unsigned char *end, double *dbl)
+{
+	zbx_uint64_t	number;
 
-	return p;
+	if (SUCCEED != history_clickhouse_read_uint64(data, end, &number))
+		return FAIL;
+
+	memcpy(dbl, &number, sizeof(number));
+
+	return SUCCEED;
+}
+
+static int	history_clickhouse_read_uint32(const unsigned char **data, const unsigned char *end,
+		zbx_uint32_t *ui32)
+{
+	zbx_uint32_t	number;
+
+	if ((size_t)(end - *data) < sizeof(number))
+		return FAIL;
+
+	memcpy(&number, *data, sizeof(number));
+	*ui32 = zbx_letoh_uint32(number);
+	*data += sizeof(number);
+
+	return SUCCEED;
 }
 
 /******************************************************************************
  *                                                                            *
- * Purpose: parse item identifier from JSON row                               *
+ * Purpose: parse log value from RowBinary row                                *
  *                                                                            *
- * Parameters: jp     - [IN] row with data as JSON array of values            *
- *             p      - [IN] pointer to current position in JSON data         *
- *             itemid - [OUT] parsed item identifier                          *
+ * Parameters:                                                                *
+ *     data - [IN/OUT] pointer to current position in response data          *
+ *     end  - [IN] end of response data                                       *
+ *     log  - [OUT] log value structure to fill                               *
  *                                                                            *
- * Return value: pointer to next position in JSON data or NULL on failure     *
+ * Return value: SUCCEED - the log value was parsed successfully              *
+ *               FAIL    - response data is truncated                         *
  *                                                                            *
  ******************************************************************************/
-static const char	*history_clickhouse_parse_itemid(const struct zbx_json_parse *jp, const char *p,
-		zbx_uint64_t *itemid)
+static int	history_clickhouse_parse_log_value(const unsigned char **data, const unsigned char *end,
+		zbx_log_value_t *log)
 {
-	char		buf[MAX_ID_LEN + 1];
+	zbx_uint32_t	severity, logeventid;
+	zbx_uint64_t	timestamp;
 
-	if (NULL == (p = zbx_json_next_value(jp, NULL, buf, sizeof(buf), NULL)))
+	if (SUCCEED != history_clickhouse_read_text(data, end, &log->value) ||
+			SUCCEED != history_clickhouse_read_text(data, end, &log->source) ||
+			SUCCEED != history_clickhouse_read_uint32(data, end, &severity) ||
+			SUCCEED != history_clickhouse_read_uint32(data, end, &logeventid) ||
+			SUCCEED != history_clickhouse_read_uint64(data, end, &timestamp))
 	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse itemid from row \"%s\"", jp->start);
-		return NULL;
+		return FAIL;
 	}
 
-	if (SUCCEED != zbx_is_uint64(buf, itemid))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "invalid itemid starting with \"%s\"", jp->start);
-		return NULL;
-	}
+	log->severity = (int)severity;
+	log->logeventid = (int)logeventid;
+	log->timestamp = (int)timestamp;
 
-	return p;
+	return SUCCEED;
 }
 
-
 /******************************************************************************
  *                                                                            *
- * Purpose: parse single row of ClickHouse response and add to records vector *
+ * Purpose: parse single row of ClickHouse RowBinary response                 *
  *                                                                            *
  * Parameters:                                                                *
- *     jp         - [IN] row with log data as JSON array of values            *
- *     p          - [IN] pointer to current position in JSON data             *
+ *     data       - [IN/OUT] pointer to current position in response data    *
+ *     end        - [IN] end of response data                                 *
  *     value_type - [IN] value type (ITEM_VALUE_TYPE_*)                       *
  *     record     - [OUT] parsed history record                               *
  *                                                                            *
- * Return value: pointer to next position in JSON data or NULL on failure     *
+ * Return value: SUCCEED - the row was parsed successfully                    *
+ *               FAIL    - response data is truncated or value type is not    *
+ *                         supported                                          *
+ *                                                                            *
+ * Comments: The row contains clock_ns (DateTime64(9) as nanoseconds since    *
+ *           epoch) followed by value and for log values - source, severity,  *
+ *           logeventid and timestamp columns.                                *
  *                                                                            *
  ******************************************************************************/
-static const char	*history_clickhouse_parse_row(const struct zbx_json_parse *jp, const char *p,
+static int	history_clickhouse_parse_row(const unsigned char **data, const unsigned char *end,
 		unsigned char value_type, zbx_history_record_t *record)
 {
-	char	clock_ns[MAX_ID_LEN * 2], *ptr;
-
-	if (NULL == (p = zbx_json_next_value(jp, p, clock_ns, sizeof(clock_ns), NULL)))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "cannot parse value timestamp from row \"%s\"", jp->start);
-		return NULL;
-	}
-
-	if (NULL == (ptr = strchr(clock_ns, '.')))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "invalid value timestamp format \"%s\"", clock_ns);
-		return NULL;
-	}
-
-	*ptr++ = '\0';
+	zbx_uint64_t	clock_ns;
 
-	if (FAIL == zbx_is_uint32(clock_ns, &record->timestamp.sec))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "invalid value timestamp seconds value \"%s\"", clock_ns);
-		return NULL;
-	}
+	if (SUCCEED != history_clickhouse_read_uint64(data, end, &clock_ns))
+		return FAIL;
 
-	if (FAIL == zbx_is_uint32(ptr, &record->timestamp.ns))
-	{
-		zabbix_log(LOG_LEVEL_WARNING, "invalid value timestamp nanoseconds value \"%s\"", ptr);
-		return NULL;
-	}
+	record->timestamp.sec = (int)(clock_ns / 1000000000);
+	record->timestamp.ns = (int)(clock_ns % 1000000000);
 
 	switch (value_type)
 	{
 		case ITEM_VALUE_TYPE_FLOAT:
+			return history_clickhouse_read_dbl(data, end, &record->value.dbl);
 		case ITEM_VALUE_TYPE_UINT64:
-			return history_clickhouse_parse_numeric_value(jp, p, value_type, record);
+			return history_clickhouse_read_uint64(data, end, &record->value.ui64);
+		case ITEM_VALUE_TYPE_STR:
+		case ITEM_VALUE_TYPE_TEXT:
+			return history_clickhouse_read_text(data, end, &record->value.str);
+		case ITEM_VALUE_TYPE_LOG:
+			record->value.log = (zbx_log_value_t *)zbx_malloc(NULL, sizeof(zbx_log_value_t));
+			memset(record->value.log, 0, sizeof(zbx_log_value_t));
+
+			if (SUCCEED != history_clickhouse_parse_log_value(data, end, record->value.log))
+			{
+				zbx_history_record_clear(record, ITEM_VALUE_TYPE_LOG);
+				return FAIL;
+			}
+
+			return SUCCEED;
 		default:
-			return history_clickhouse_parse_value(jp, p, value_type, record);
+			THIS_SHOULD_NEVER_HAPPEN;
+			return FAIL;
 	}
-
-	return NULL;
 }
 
 /******************************************************************************
@@ -1136,49 +1193,41 @@ static const char	*history_clickhouse_parse_row(const struct zbx_json_parse *jp,
  * Purpose: parse ClickHouse response and extract history records             *
  *                                                                            *
  * Parameters:                                                                *
- *     response   - [IN] ClickHouse response as string                        *
- *     value_type - [IN] value type (ITEM_VALUE_TYPE_*)                       *
- *     values     - [OUT] array of parsed history records                     *
+ *     response      - [IN] ClickHouse response in RowBinary format           *
+ *     response_size - [IN] response size                                     *
+ *     value_type    - [IN] value type (ITEM_VALUE_TYPE_*)                    *
+ *     values        - [OUT] array of parsed history records                  *
  *                                                                            *
  * Return value: number of parsed records                                     *
  *                                                                            *
  ******************************************************************************/
-static int	history_clickhouse_parse_response(char *response, unsigned char value_type,
-		zbx_history_record_t **values)
+static int	history_clickhouse_parse_response(const char *response, size_t response_size,
+		unsigned char value_type, zbx_history_record_t **values)
 {
 	zbx_vector_history_record_t	records;
-	char				*start, *end;
+	const unsigned char		*data, *end;
 
 	if (NULL == response)
 		return 0;
 
 	zbx_vector_history_record_create(&records);
 
-	for (start = response;; start = end + 1)
-	{
-		struct zbx_json_parse	jp;
+	data = (const unsigned char *)response;
+	end = data + response_size;
 
-		if (NULL != (end = strchr(start, '\n')))
-			*end = '\0';
+	while (data < end)
+	{
+		const unsigned char	*row = data;
+		zbx_history_record_t	record = {0};
 
-		if ('\0' != *start)
+		if (SUCCEED != history_clickhouse_parse_row(&data, end, value_type, &record))
 		{
-			if (FAIL != zbx_json_open(start, &jp))
-			{
-				const char		*p = NULL;
-				zbx_history_record_t	record = {0};
-
-				if (NULL != history_clickhouse_parse_row(&jp, p, value_type, &record))
-					zbx_vector_history_record_append(&records, record);
-			}
-			else
-				zabbix_log(LOG_LEVEL_WARNING, "cannot parse row: %s", start);
-		}
-
-		if (NULL == end)
+			zabbix_log(LOG_LEVEL_WARNING, "cannot parse ClickHouse response: invalid row at offset "
+					ZBX_FS_SIZE_T, (zbx_fs_size_t)(row - (const unsigned char *)response));
 			break;
+		}
 
-		*end = '\n';
+		zbx_vector_history_record_append(&records, record);
 	}
 
 	*values = records.values;
@@ -1223,6 +1272,13 @@ static int	clickhouse_conn_post(zbx_clickhouse_conn_t *conn, zbx_clickhouse_data
 		goto out;
 	}
 
+	/* connections are shared with compressed inserts */
+	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, CURLOPT_HTTPHEADER, d->curl_headers)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot set HTTPHEADER option: %s", curl_easy_strerror(err));
+		goto out;
+	}
+
 	if (CURLE_OK != (err = curl_easy_setopt(conn->handle, CURLOPT_POSTFIELDSIZE, strlen(data))))
 	{
 		*error = zbx_dsprintf(NULL, "cannot set CURLOPT_POSTFIELDSIZE option: %s", curl_easy_strerror(err));
@@ -1363,7 +1419,7 @@ static int	history_clickhouse_fetch(void *data, zbx_uint64_t itemid, unsigned ch
 	if (0 != count)
 		zbx_snprintf_alloc(&query, &query_alloc, &query_offset, " LIMIT %d", count);
 
-	zbx_strcpy_alloc(&query, &query_alloc, &query_offset, " format JSONCompactEachRow");
+	zbx_strcpy_alloc(&query, &query_alloc, &query_offset, " format RowBinary");
 
 	zabbix_log(LOG_LEVEL_DEBUG, "query: %s", query);
 
@@ -1373,7 +1429,10 @@ static int	history_clickhouse_fetch(void *data, zbx_uint64_t itemid, unsigned ch
 		zbx_free(errmsg);
 	}
 	else
-		ret = history_clickhouse_parse_response(conn->resp.page.data, value_type, values);
+	{
+		ret = history_clickhouse_parse_response(conn->resp.page.data, conn->resp.page.offset, value_type,
+				values);
+	}
 
 	zbx_free(query);
 	history_clickhouse_release_conn(d, conn);
@@ -1388,73 +1447,63 @@ static int	history_clickhouse_fetch(void *data, zbx_uint64_t itemid, unsigned ch
  * Purpose: parse ClickHouse batch response and populate item history results *
  *                                                                            *
  * Parameters:                                                                *
- *     response   - [IN] ClickHouse response as string                        *
- *     value_type - [IN] value type (ITEM_VALUE_TYPE_*)                       *
- *     results    - [IN/OUT] vector of item history structures to fill        *
+ *     response      - [IN] ClickHouse response in RowBinary format           *
+ *     response_size - [IN] response size                                     *
+ *     value_type    - [IN] value type (ITEM_VALUE_TYPE_*)                    *
+ *     results       - [IN/OUT] vector of item history structures to fill     *
  *                                                                            *
  * Return value: number of items with history data received                   *
  *                                                                            *
  ******************************************************************************/
-static int	history_clickhouse_parse_batch_response(char *response, unsigned char value_type,
-		zbx_vector_item_history_t *results)
+static int	history_clickhouse_parse_batch_response(const char *response, size_t response_size,
+		unsigned char value_type, zbx_vector_item_history_t *results)
 {
-	char			*start, *end;
+	const unsigned char	*data, *end;
 	zbx_item_history_t	*hist = NULL;
 	int			batches_num = 0;
 
 	if (NULL == response)
 		return 0;
 
-	for (start = response;; start = end + 1)
+	data = (const unsigned char *)response;
+	end = data + response_size;
+
+	while (data < end)
 	{
-		struct zbx_json_parse	jp;
+		const unsigned char	*row = data;
+		zbx_uint64_t		itemid;
+		zbx_history_record_t	record = {0};
 
-		if ('\0' == *start)
+		if (SUCCEED != history_clickhouse_read_uint64(&data, end, &itemid) ||
+				SUCCEED != history_clickhouse_parse_row(&data, end, value_type, &record))
+		{
+			zabbix_log(LOG_LEVEL_WARNING, "cannot parse ClickHouse response: invalid row at offset "
+					ZBX_FS_SIZE_T, (zbx_fs_size_t)(row - (const unsigned char *)response));
 			break;
+		}
 
-		if (NULL != (end = strchr(start, '\n')))
-			*end = '\0';
-
-		if (FAIL != zbx_json_open(start, &jp))
+		if (NULL == hist || hist->itemid != itemid)
 		{
-			const char		*p = NULL;
-			zbx_uint64_t		itemid;
-			zbx_history_record_t	record;
-
-			if (NULL != (p = history_clickhouse_parse_itemid(&jp, p, &itemid)) &&
-					NULL != history_clickhouse_parse_row(&jp, p, value_type, &record))
-			{
-				if (NULL == hist || hist->itemid != itemid)
-				{
-					int			index;
-					zbx_item_history_t	hist_local;
-
-					hist_local.itemid = itemid;
-
-					index = zbx_vector_item_history_bsearch(results, hist_local,
-							zbx_item_history_compare_by_itemid);
+			int			index;
+			zbx_item_history_t	hist_local;
 
-					if (FAIL == index)
-					{
-						THIS_SHOULD_NEVER_HAPPEN;
-						zbx_history_record_clear(&record, value_type);
-						break;
-					}
+			hist_local.itemid = itemid;
 
-					hist = &results->values[index];
-					batches_num++;
-				}
+			index = zbx_vector_item_history_bsearch(results, hist_local,
+					zbx_item_history_compare_by_itemid);
 
-				zbx_vector_history_record_append(&hist->rows, record);
+			if (FAIL == index)
+			{
+				THIS_SHOULD_NEVER_HAPPEN;
+				zbx_history_record_clear(&record, value_type);
+				break;
 			}
-		}
-		else
-			zabbix_log(LOG_LEVEL_WARNING, "cannot parse row: %s", start);
 
-		if (NULL == end)
-			break;
+			hist = &results->values[index];
+			batches_num++;
+		}
 
-		*end = '\n';
+		zbx_vector_history_record_append(&hist->rows, record);
 	}
 
 	return batches_num;
@@ -1517,7 +1566,7 @@ static int	history_clickhouse_fetch_batch(void *data, zbx_vector_item_history_t
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " and clock_ns>='" ZBX_FS_TIME_T ".0'", start + 1);
 
 	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " order by itemid,clock_ns desc limit %d by itemid"
-			" format JSONCompactEachRow", limit);
+			" format RowBinary", limit);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "batch query: %s", sql);
 
@@ -1529,7 +1578,10 @@ static int	history_clickhouse_fetch_batch(void *data, zbx_vector_item_history_t
 		zbx_free(errmsg);
 	}
 	else
-		ret = history_clickhouse_parse_batch_response(conn->resp.page.data, value_type, results);
+	{
+		ret = history_clickhouse_parse_batch_response(conn->resp.page.data, conn->resp.page.offset,
+				value_type, results);
+	}
 
 	zbx_free(sql);
 	history_clickhouse_release_conn(d, conn);
@@ -686,6 +686,8 @@ void	history_log_options(zbx_history_option_t *options, int options_num)
 			HISTORY_PROVIDER_OPTION_PRECACHE ","
 			HISTORY_PROVIDER_OPTION_NAME ","
 			HISTORY_PROVIDER_OPTION_DATE_INDEX ","
+			HISTORY_PROVIDER_OPTION_COMPRESSION ","
+			HISTORY_PROVIDER_OPTION_POOL_SIZE ","
 	;
 
 
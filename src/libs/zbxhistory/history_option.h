@@ -41,6 +41,8 @@
 #define HISTORY_PROVIDER_OPTION_SSL_CA_LOCATION		"ssl_ca_location"
 #define HISTORY_PROVIDER_OPTION_SSL_CERT_LOCATION	"ssl_cert_location"
 #define HISTORY_PROVIDER_OPTION_SSL_KEY_LOCATION	"ssl_key_location"
+#define HISTORY_PROVIDER_OPTION_COMPRESSION		"compression"
+#define HISTORY_PROVIDER_OPTION_POOL_SIZE		"pool_size"
 
 ZBX_VECTOR_DECL(history_option, zbx_history_option_t)
 
@@ -0,0 +1,684 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+/* memfd_create() and struct ucred */
+#define _GNU_SOURCE
+
+#include "zbxcommon.h"
+
+#ifdef HAVE_IPCSERVICE
+
+#include "ipcring.h"
+
+#ifdef ZBX_IPC_RING
+
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+
+/* the ring data area size limits, the size is always power of two */
+#define ZBX_IPC_RING_SIZE_MIN		(64 * ZBX_KIBIBYTE)
+#define ZBX_IPC_RING_SIZE_MAX		(64 * ZBX_MEBIBYTE)
+
+/* larger messages are sent over socket so they do not starve the ring */
+#define ZBX_IPC_RING_MESSAGE_MAX(ring)	((ring)->size / 4)
+
+#define ZBX_IPC_RING_ALIGN(x)		(((x) + 7) & ~(zbx_uint32_t)7)
+#define ZBX_IPC_RING_CACHE_LINE		64
+
+/* The ring control block placed at the start of shared memory. The head and tail are   */
+/* free running positions, the data offset is position modulo data size. The tail and   */
+/* head are kept on separate cache lines as they are written by different processes.    */
+typedef struct
+{
+	/* the write position, updated by client */
+	atomic_uint	tail;
+
+	/* set by client before waiting for free space, cleared by service when ringing space doorbell */
+	atomic_int	writer_waiting;
+	unsigned char	pad1[ZBX_IPC_RING_CACHE_LINE - sizeof(atomic_uint) - sizeof(atomic_int)];
+
+	/* the read position, updated by service */
+	atomic_uint	head;
+
+	/* set by service before waiting for doorbell, cleared by client when ringing it */
+	atomic_int	waiting;
+	unsigned char	pad2[ZBX_IPC_RING_CACHE_LINE - sizeof(atomic_uint) - sizeof(atomic_int)];
+}
+zbx_ipc_ring_ctl_t;
+
+#define ZBX_IPC_RING_MAP_SIZE(size)	(sizeof(zbx_ipc_ring_ctl_t) + (size))
+
+struct zbx_ipc_ring
+{
+	zbx_ipc_ring_ctl_t	*ctl;
+	unsigned char		*data;
+
+	/* the data area size */
+	zbx_uint32_t		size;
+
+	/* the shared memory descriptor, kept by client until it's passed to service */
+	int			shmfd;
+
+	/* the eventfd descriptor used to wake up service */
+	int			doorbell;
+
+	/* the eventfd descriptor used to wake up client waiting for free space */
+	int			space;
+};
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: rounds requested ring size up to power of two within limits       *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_uint32_t	ipc_ring_adjust_size(zbx_uint32_t size)
+{
+	zbx_uint32_t	adjusted = ZBX_IPC_RING_SIZE_MIN;
+
+	while (adjusted < size && ZBX_IPC_RING_SIZE_MAX > adjusted)
+		adjusted <<= 1;
+
+	return adjusted;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: maps ring shared memory                                           *
+ *                                                                            *
+ * Parameters: shmfd    - [IN] the shared memory descriptor                   *
+ *             size     - [IN] the ring data area size                        *
+ *             doorbell - [IN] the doorbell descriptor                        *
+ *             space    - [IN] the space doorbell descriptor                  *
+ *             error    - [OUT] the error message                             *
+ *                                                                            *
+ * Return value: the mapped ring or NULL on error.                            *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_ipc_ring_t	*ipc_ring_map(int shmfd, zbx_uint32_t size, int doorbell, int space, char **error)
+{
+	void		*addr;
+	zbx_ipc_ring_t	*ring;
+
+	if (MAP_FAILED == (addr = mmap(NULL, ZBX_IPC_RING_MAP_SIZE(size), PROT_READ | PROT_WRITE, MAP_SHARED, shmfd,
+			0)))
+	{
+		*error = zbx_dsprintf(*error, "cannot map IPC ring: %s", zbx_strerror(errno));
+		return NULL;
+	}
+
+	ring = (zbx_ipc_ring_t *)zbx_malloc(NULL, sizeof(zbx_ipc_ring_t));
+	ring->ctl = (zbx_ipc_ring_ctl_t *)addr;
+	ring->data = (unsigned char *)addr + sizeof(zbx_ipc_ring_ctl_t);
+	ring->size = size;
+	ring->shmfd = shmfd;
+	ring->doorbell = doorbell;
+	ring->space = space;
+
+	return ring;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: creates IPC ring on client side                                   *
+ *                                                                            *
+ * Parameters: ring  - [OUT] the created ring                                 *
+ *             size  - [IN] the requested ring data area size                 *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was created                               *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The size is rounded up to power of two and limited to the        *
+ *           range supported by service.                                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_create(zbx_ipc_ring_t **ring, zbx_uint32_t size, char **error)
+{
+	int	shmfd, doorbell = -1, space = -1;
+
+	size = ipc_ring_adjust_size(size);
+
+	if (-1 == (shmfd = memfd_create("zbx_ipc_ring", MFD_CLOEXEC)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create IPC ring memory: %s", zbx_strerror(errno));
+		return FAIL;
+	}
+
+	if (-1 == ftruncate(shmfd, (off_t)ZBX_IPC_RING_MAP_SIZE(size)))
+	{
+		*error = zbx_dsprintf(*error, "cannot set IPC ring memory size: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (-1 == (doorbell = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create IPC ring doorbell: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (-1 == (space = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)))
+	{
+		*error = zbx_dsprintf(*error, "cannot create IPC ring space doorbell: %s", zbx_strerror(errno));
+		goto out;
+	}
+
+	if (NULL == (*ring = ipc_ring_map(shmfd, size, doorbell, space, error)))
+		goto out;
+
+	atomic_init(&(*ring)->ctl->tail, 0);
+	atomic_init(&(*ring)->ctl->writer_waiting, 0);
+	atomic_init(&(*ring)->ctl->head, 0);
+	atomic_init(&(*ring)->ctl->waiting, 1);
+
+	return SUCCEED;
+out:
+	if (-1 != space)
+		close(space);
+
+	if (-1 != doorbell)
+		close(doorbell);
+
+	close(shmfd);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: unmaps IPC ring and closes its descriptors                        *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_free(zbx_ipc_ring_t *ring)
+{
+	munmap(ring->ctl, ZBX_IPC_RING_MAP_SIZE(ring->size));
+
+	if (-1 != ring->shmfd)
+		close(ring->shmfd);
+
+	close(ring->doorbell);
+	close(ring->space);
+	zbx_free(ring);
+}
+
+int	zbx_ipc_ring_get_doorbell(const zbx_ipc_ring_t *ring)
+{
+	return ring->doorbell;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the peer runs under the same user                       *
+ *                                                                            *
+ * Parameters: fd - [IN] the connected socket                                 *
+ *                                                                            *
+ * Return value: SUCCEED - the peer can share IPC ring                        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Both sides of connection perform the same check, so they always  *
+ *           agree whether the ring is used.                                  *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_check_peer(int fd)
+{
+	struct ucred	cred;
+	socklen_t	len = sizeof(cred);
+
+	if (0 != getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len))
+		return FAIL;
+
+	return cred.uid == geteuid() ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends ring attach message together with ring descriptors          *
+ *                                                                            *
+ * Parameters: fd    - [IN] the connected socket                              *
+ *             ring  - [IN] the ring to pass                                  *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the attach message was sent                        *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The shared memory descriptor is closed after it has been sent,   *
+ *           the mapping stays valid.                                         *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_send_attach(int fd, zbx_ipc_ring_t *ring, char **error)
+{
+	zbx_uint32_t	header[2] = {ZBX_IPC_RING_CODE_ATTACH, 0};
+	struct iovec	iov;
+	struct msghdr	msg;
+	struct cmsghdr	*cmsg;
+	int		fds[3];
+	union
+	{
+		char		buf[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr	align;
+	}
+	control;
+	ssize_t		n;
+
+	fds[0] = ring->shmfd;
+	fds[1] = ring->doorbell;
+	fds[2] = ring->space;
+
+	iov.iov_base = header;
+	iov.iov_len = sizeof(header);
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+	while (-1 == (n = sendmsg(fd, &msg, 0)))
+	{
+		if (EINTR != errno)
+		{
+			*error = zbx_dsprintf(*error, "cannot send IPC ring attach message: %s", zbx_strerror(errno));
+			return FAIL;
+		}
+	}
+
+	if (sizeof(header) != (size_t)n)
+	{
+		*error = zbx_strdup(*error, "cannot send IPC ring attach message: partial write");
+		return FAIL;
+	}
+
+	close(ring->shmfd);
+	ring->shmfd = -1;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads data from socket, attaching IPC ring if its descriptors     *
+ *          were passed along with the data                                   *
+ *                                                                            *
+ * Parameters: fd     - [IN] the socket                                       *
+ *             buffer - [OUT] the read data                                   *
+ *             size   - [IN] the buffer size                                  *
+ *             ring   - [IN/OUT] the attached ring                            *
+ *                                                                            *
+ * Return value: The number of bytes read, 0 if the connection was closed or  *
+ *               -1 on error with errno set (like read() function).           *
+ *                                                                            *
+ * Comments: Descriptors are accepted only once per connection and only from  *
+ *           peers running under the same user. Otherwise the read fails, so  *
+ *           the connection is dropped instead of losing ring messages.       *
+ *                                                                            *
+ ******************************************************************************/
+ssize_t	zbx_ipc_ring_recv(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_ipc_ring_t **ring)
+{
+	struct iovec	iov;
+	struct msghdr	msg;
+	struct cmsghdr	*cmsg;
+	int		fds[3];
+	union
+	{
+		char		buf[CMSG_SPACE(sizeof(fds))];
+		struct cmsghdr	align;
+	}
+	control;
+	ssize_t		n;
+	char		*error = NULL;
+	struct stat	st;
+	zbx_uint32_t	ring_size;
+
+	iov.iov_base = buffer;
+	iov.iov_len = size;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control.buf;
+	msg.msg_controllen = sizeof(control.buf);
+
+	if (0 >= (n = recvmsg(fd, &msg, MSG_CMSG_CLOEXEC)))
+		return n;
+
+	if (NULL == (cmsg = CMSG_FIRSTHDR(&msg)) || SOL_SOCKET != cmsg->cmsg_level || SCM_RIGHTS != cmsg->cmsg_type)
+		return n;
+
+	if (CMSG_LEN(sizeof(fds)) != cmsg->cmsg_len)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "unexpected descriptors received from IPC client");
+		goto fail;
+	}
+
+	memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+	if (NULL != *ring || SUCCEED != zbx_ipc_ring_check_peer(fd))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "unexpected IPC ring attach request");
+		goto clean;
+	}
+
+	if (0 != fstat(fds[0], &st) || (off_t)ZBX_IPC_RING_MAP_SIZE(ZBX_IPC_RING_SIZE_MIN) > st.st_size ||
+			(off_t)ZBX_IPC_RING_MAP_SIZE(ZBX_IPC_RING_SIZE_MAX) < st.st_size)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid IPC ring memory size");
+		goto clean;
+	}
+
+	/* the data area size is derived from memory size, it must be power of two within limits */
+	ring_size = (zbx_uint32_t)(st.st_size - (off_t)sizeof(zbx_ipc_ring_ctl_t));
+
+	if (ring_size != ipc_ring_adjust_size(ring_size))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "invalid IPC ring data size %u", ring_size);
+		goto clean;
+	}
+
+	if (NULL == (*ring = ipc_ring_map(fds[0], ring_size, fds[1], fds[2], &error)))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "%s", error);
+		zbx_free(error);
+		goto clean;
+	}
+
+	close(fds[0]);
+	(*ring)->shmfd = -1;
+
+	return n;
+clean:
+	close(fds[0]);
+	close(fds[1]);
+	close(fds[2]);
+fail:
+	errno = EPROTO;
+
+	return -1;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies data into ring at the specified position                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_ring_copy_in(zbx_ipc_ring_t *ring, zbx_uint32_t pos, const void *data, zbx_uint32_t size)
+{
+	zbx_uint32_t	offset = pos & (ring->size - 1), chunk;
+
+	chunk = MIN(size, ring->size - offset);
+	memcpy(ring->data + offset, data, chunk);
+
+	if (chunk != size)
+		memcpy(ring->data, (const unsigned char *)data + chunk, size - chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies data from ring at the specified position                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_ring_copy_out(const zbx_ipc_ring_t *ring, zbx_uint32_t pos, void *data, zbx_uint32_t size)
+{
+	zbx_uint32_t	offset = pos & (ring->size - 1), chunk;
+
+	chunk = MIN(size, ring->size - offset);
+	memcpy(data, ring->data + offset, chunk);
+
+	if (chunk != size)
+		memcpy((unsigned char *)data + chunk, ring->data, size - chunk);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes record to ring                                             *
+ *                                                                            *
+ * Parameters: ring     - [IN] the ring                                       *
+ *             code     - [IN] the message code                               *
+ *             data     - [IN] the message data                               *
+ *             size     - [IN] the message data size                          *
+ *             reserved - [IN] the space to leave free after the record       *
+ *                                                                            *
+ * Return value: SUCCEED - the record was written                             *
+ *               FAIL    - not enough free space in ring                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_ring_write(zbx_ipc_ring_t *ring, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size,
+		zbx_uint32_t reserved)
+{
+	zbx_uint32_t	head, tail, header[2], record_size;
+
+	/* sequentially consistent load pairs with service storing head and checking writer waiting flag */
+	head = atomic_load(&ring->ctl->head);
+	tail = atomic_load_explicit(&ring->ctl->tail, memory_order_relaxed);
+	record_size = ZBX_IPC_HEADER_SIZE + ZBX_IPC_RING_ALIGN(size);
+
+	if (ring->size - (tail - head) < record_size + reserved)
+		return FAIL;
+
+	header[0] = code;
+	header[1] = size;
+	ipc_ring_copy_in(ring, tail, header, ZBX_IPC_HEADER_SIZE);
+
+	if (0 != size)
+		ipc_ring_copy_in(ring, tail + ZBX_IPC_HEADER_SIZE, data, size);
+
+	/* sequentially consistent store pairs with service setting waiting flag and re-checking tail */
+	atomic_store(&ring->ctl->tail, tail + record_size);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes message to ring and wakes up service if it's waiting       *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             code - [IN] the message code                                   *
+ *             data - [IN] the message data                                   *
+ *             size - [IN] the message data size                              *
+ *                                                                            *
+ * Return value: SUCCEED - the message was written                            *
+ *               FAIL    - the message is too large or ring is full, it must  *
+ *                         be sent over socket after writing marker           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_write(zbx_ipc_ring_t *ring, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size)
+{
+	const zbx_uint64_t	one = 1;
+
+	if (ZBX_IPC_RING_MESSAGE_MAX(ring) < size)
+		return FAIL;
+
+	/* always leave space for marker, so a message can be sent over socket when ring is full */
+	if (SUCCEED != ipc_ring_write(ring, code, data, size, ZBX_IPC_HEADER_SIZE))
+		return FAIL;
+
+	if (0 != atomic_exchange(&ring->ctl->waiting, 0))
+	{
+		while (-1 == write(ring->doorbell, &one, sizeof(one)) && EINTR == errno)
+			;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: writes marker telling that the next message is sent over socket   *
+ *                                                                            *
+ * Parameters: ring - [IN] the ring                                           *
+ *             fd   - [IN] the socket connected to service                    *
+ *                                                                            *
+ * Return value: SUCCEED - the marker was written                             *
+ *               FAIL    - the connection was closed or poll failed           *
+ *                                                                            *
+ * Comments: The service is not woken up - it drains ring up to the marker    *
+ *           when the socket message is received.                             *
+ *           If the space reserved for marker was already used by previous    *
+ *           marker the client blocks until service rings space doorbell      *
+ *           after reading ring. The socket is polled as well, so the client  *
+ *           does not hang if service is gone.                                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_write_marker(zbx_ipc_ring_t *ring, int fd)
+{
+	struct pollfd	pfds[2];
+	zbx_uint64_t	value;
+
+	while (SUCCEED != ipc_ring_write(ring, ZBX_IPC_RING_CODE_MARKER, NULL, 0, 0))
+	{
+		atomic_store(&ring->ctl->writer_waiting, 1);
+
+		/* re-check after setting the flag as service could have read ring meanwhile */
+		if (SUCCEED == ipc_ring_write(ring, ZBX_IPC_RING_CODE_MARKER, NULL, 0, 0))
+		{
+			atomic_store(&ring->ctl->writer_waiting, 0);
+			break;
+		}
+
+		pfds[0].fd = ring->space;
+		pfds[0].events = POLLIN;
+		pfds[0].revents = 0;
+		pfds[1].fd = fd;
+		pfds[1].events = 0;
+		pfds[1].revents = 0;
+
+		if (-1 == poll(pfds, 2, -1))
+		{
+			if (EINTR == errno)
+				continue;
+
+			return FAIL;
+		}
+
+		if (0 != (pfds[1].revents & (POLLHUP | POLLERR | POLLNVAL)))
+			return FAIL;
+
+		while (-1 == read(ring->space, &value, sizeof(value)) && EINTR == errno)
+			;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reads message from ring                                           *
+ *                                                                            *
+ * Parameters: ring  - [IN] the ring                                          *
+ *             code  - [OUT] the message code                                 *
+ *             data  - [OUT] the message data (allocated, NULL if empty)      *
+ *             size  - [OUT] the message data size                            *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED            - the message was read                    *
+ *               ZBX_IPC_RING_EMPTY - the ring is empty                       *
+ *               FAIL               - the ring contains invalid record        *
+ *                                                                            *
+ * Comments: The ring memory is writable by client, so record positions and   *
+ *           sizes are validated before copying data. After reading the space *
+ *           doorbell is rung if client is waiting for free space.            *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_read(zbx_ipc_ring_t *ring, zbx_uint32_t *code, unsigned char **data, zbx_uint32_t *size,
+		char **error)
+{
+	const zbx_uint64_t	one = 1;
+	zbx_uint32_t		head, tail, header[2], used, record_size;
+
+	head = atomic_load_explicit(&ring->ctl->head, memory_order_relaxed);
+	tail = atomic_load_explicit(&ring->ctl->tail, memory_order_acquire);
+
+	if (head == tail)
+		return ZBX_IPC_RING_EMPTY;
+
+	if (ring->size < (used = tail - head) || ZBX_IPC_HEADER_SIZE > used)
+	{
+		*error = zbx_dsprintf(*error, "invalid IPC ring positions head:%u tail:%u", head, tail);
+		return FAIL;
+	}
+
+	ipc_ring_copy_out(ring, head, header, ZBX_IPC_HEADER_SIZE);
+
+	if (ZBX_IPC_RING_MESSAGE_MAX(ring) < header[1] ||
+			(record_size = ZBX_IPC_HEADER_SIZE + ZBX_IPC_RING_ALIGN(header[1])) > used)
+	{
+		*error = zbx_dsprintf(*error, "invalid IPC ring message size:%u available:%u", header[1], used);
+		return FAIL;
+	}
+
+	*code = header[0];
+	*size = header[1];
+
+	if (0 != *size)
+	{
+		*data = (unsigned char *)zbx_malloc(NULL, *size);
+		ipc_ring_copy_out(ring, head + ZBX_IPC_HEADER_SIZE, *data, *size);
+	}
+	else
+		*data = NULL;
+
+	/* sequentially consistent store pairs with client setting writer waiting flag and re-checking head */
+	atomic_store(&ring->ctl->head, head + record_size);
+
+	if (0 != atomic_load(&ring->ctl->writer_waiting) && 0 != atomic_exchange(&ring->ctl->writer_waiting, 0))
+	{
+		while (-1 == write(ring->space, &one, sizeof(one)) && EINTR == errno)
+			;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares service to wait for doorbell                             *
+ *                                                                            *
+ * Return value: SUCCEED - the ring is empty and client will ring doorbell    *
+ *                         after writing the next message                     *
+ *               FAIL    - new messages were written meanwhile                *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_ipc_ring_wait(zbx_ipc_ring_t *ring)
+{
+	atomic_store(&ring->ctl->waiting, 1);
+
+	if (atomic_load(&ring->ctl->tail) == atomic_load_explicit(&ring->ctl->head, memory_order_relaxed))
+		return SUCCEED;
+
+	atomic_store(&ring->ctl->waiting, 0);
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets doorbell counter before draining ring                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_ring_clear_doorbell(zbx_ipc_ring_t *ring)
+{
+	zbx_uint64_t	value;
+
+	while (-1 == read(ring->doorbell, &value, sizeof(value)) && EINTR == errno)
+		;
+}
+
+#endif
+
+#endif
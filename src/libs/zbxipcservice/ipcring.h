@@ -0,0 +1,54 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_IPCRING_H
+#define ZABBIX_IPCRING_H
+
+#include "zbxipcservice.h"
+
+#if defined(HAVE_FUNCTION_MEMFD_CREATE) && defined(HAVE_FUNCTION_EVENTFD) && defined(HAVE_STDATOMIC_H) && \
+		2 == ATOMIC_INT_LOCK_FREE
+#	define ZBX_IPC_RING	1
+#endif
+
+#ifdef ZBX_IPC_RING
+
+/* Reserved message codes. The attach message is sent over socket together with ring */
+/* and doorbell descriptors, the marker is written to ring to tell that the next      */
+/* message was sent over socket.                                                      */
+#define ZBX_IPC_RING_CODE_ATTACH	0xffffffff
+#define ZBX_IPC_RING_CODE_MARKER	0xfffffffe
+
+/* returned by zbx_ipc_ring_read() when there are no messages to read */
+#define ZBX_IPC_RING_EMPTY	1
+
+int	zbx_ipc_ring_create(zbx_ipc_ring_t **ring, zbx_uint32_t size, char **error);
+void	zbx_ipc_ring_free(zbx_ipc_ring_t *ring);
+int	zbx_ipc_ring_get_doorbell(const zbx_ipc_ring_t *ring);
+
+int	zbx_ipc_ring_check_peer(int fd);
+int	zbx_ipc_ring_send_attach(int fd, zbx_ipc_ring_t *ring, char **error);
+ssize_t	zbx_ipc_ring_recv(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_ipc_ring_t **ring);
+
+int	zbx_ipc_ring_write(zbx_ipc_ring_t *ring, zbx_uint32_t code, const unsigned char *data, zbx_uint32_t size);
+int	zbx_ipc_ring_write_marker(zbx_ipc_ring_t *ring, int fd);
+
+int	zbx_ipc_ring_read(zbx_ipc_ring_t *ring, zbx_uint32_t *code, unsigned char **data, zbx_uint32_t *size,
+		char **error);
+int	zbx_ipc_ring_wait(zbx_ipc_ring_t *ring);
+void	zbx_ipc_ring_clear_doorbell(zbx_ipc_ring_t *ring);
+
+#endif
+
+#endif
@@ -23,6 +23,7 @@
 #endif
 
 #include "zbxipcservice.h"
+#include "ipcring.h"
 #include "zbxalgo.h"
 #include "zbxstr.h"
 #include "zbxtime.h"
@@ -57,6 +58,13 @@ struct zbx_ipc_client
 	zbx_queue_ptr_t		tx_queue;
 	struct event		*tx_event;
 
+#ifdef ZBX_IPC_RING
+	/* the client ring doorbell event */
+	struct event		*ring_event;
+
+	/* set when ring marker was read and ring reading must wait for socket message */
+	unsigned char		ring_blocked;
+#endif
 	zbx_uint64_t		id;
 	unsigned char		state;
 
@@ -99,6 +107,9 @@ static void	event_free(struct event *event)
 
 static void	ipc_client_read_event_cb(evutil_socket_t fd, short what, void *arg);
 static void	ipc_client_write_event_cb(evutil_socket_t fd, short what, void *arg);
+#ifdef ZBX_IPC_RING
+static void	ipc_client_ring_event_cb(evutil_socket_t fd, short what, void *arg);
+#endif
 
 static const char	*ipc_get_path(void)
 {
@@ -208,7 +219,7 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
  *                                                                            *
  * Purpose: reads data from a socket                                          *
  *                                                                            *
- * Parameters: fd        - [IN] the socket file descriptor                    *
+ * Parameters: csocket   - [IN] the IPC socket                                *
  *             data      - [IN] the data                                      *
  *             size      - [IN] the data size                                 *
  *             size_sent - [IN] the actual size read from socket              *
@@ -218,15 +229,22 @@ static int	ipc_write_data(int fd, const unsigned char *data, zbx_uint32_t size,
  *                                                                            *
  * Comments: When reading data from non-blocking sockets SUCCEED will be      *
  *           returned also if there were no more data to read.                *
+ *           If the ring descriptors are passed along with data the ring is   *
+ *           attached to the socket.                                          *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size)
+static int	ipc_read_data(zbx_ipc_socket_t *csocket, unsigned char *buffer, zbx_uint32_t size,
+		zbx_uint32_t *read_size)
 {
-	int	n;
+	ssize_t	n;
 
 	*read_size = 0;
 
-	while (-1 == (n = read(fd, buffer + *read_size, size - *read_size)))
+#ifdef ZBX_IPC_RING
+	while (-1 == (n = zbx_ipc_ring_recv(csocket->fd, buffer, size, &csocket->ring)))
+#else
+	while (-1 == (n = read(csocket->fd, buffer, size)))
+#endif
 	{
 		if (EINTR == errno)
 			continue;
@@ -240,7 +258,7 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
 	if (0 == n)
 		return FAIL;
 
-	*read_size += n;
+	*read_size = (zbx_uint32_t)n;
 
 	return SUCCEED;
 }
@@ -249,7 +267,7 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *                                                                            *
  * Purpose: reads data from a socket until the requested data has been read   *
  *                                                                            *
- * Parameters: fd        - [IN] the socket file descriptor                    *
+ * Parameters: csocket   - [IN] the IPC socket                                *
  *             buffer    - [IN] the data                                      *
  *             size      - [IN] the data size                                 *
  *             read_size - [IN] the actual size read from socket              *
@@ -262,7 +280,8 @@ static int	ipc_read_data(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_u
  *           the requested data has been read.                                *
  *                                                                            *
  ******************************************************************************/
-static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size, zbx_uint32_t *read_size)
+static int	ipc_read_data_full(zbx_ipc_socket_t *csocket, unsigned char *buffer, zbx_uint32_t size,
+		zbx_uint32_t *read_size)
 {
 	int		ret = FAIL;
 	zbx_uint32_t	offset = 0, chunk_size;
@@ -271,7 +290,7 @@ static int	ipc_read_data_full(int fd, unsigned char *buffer, zbx_uint32_t size,
 
 	while (offset < size)
 	{
-		if (FAIL == ipc_read_data(fd, buffer + offset, size - offset, &chunk_size))
+		if (FAIL == ipc_read_data(csocket, buffer + offset, size - offset, &chunk_size))
 			goto out;
 
 		if (0 == chunk_size)
@@ -465,13 +484,13 @@ static int	ipc_socket_read_message(zbx_ipc_socket_t *csocket, zbx_uint32_t *head
 			/* long messages will be read directly into message buffer */
 			if (ZBX_IPC_SOCKET_BUFFER_SIZE * 0.75 < data_size)
 			{
-				ret = ipc_read_data_full(csocket->fd, *data + offset, data_size, &read_size);
+				ret = ipc_read_data_full(csocket, *data + offset, data_size, &read_size);
 				*rx_bytes += read_size;
 				goto out;
 			}
 		}
 
-		if (FAIL == ipc_read_data(csocket->fd, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
+		if (FAIL == ipc_read_data(csocket, csocket->rx_buffer, ZBX_IPC_SOCKET_BUFFER_SIZE, &read_size))
 			goto out;
 
 		/* it's possible that nothing will be read on non-blocking sockets, return success */
@@ -513,6 +532,14 @@ static void	ipc_client_free_events(zbx_ipc_client_t *client)
 		event_free(client->tx_event);
 		client->tx_event = NULL;
 	}
+
+#ifdef ZBX_IPC_RING
+	if (NULL != client->ring_event)
+	{
+		event_free(client->ring_event);
+		client->ring_event = NULL;
+	}
+#endif
 }
 
 /******************************************************************************
@@ -571,6 +598,117 @@ static void	ipc_client_push_rx_message(zbx_ipc_client_t *client)
 	client->rx_bytes = 0;
 }
 
+#ifdef ZBX_IPC_RING
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds messages written to client ring to received messages queue   *
+ *                                                                            *
+ * Parameters: client - [IN] the client to read                               *
+ *                                                                            *
+ * Return value: SUCCEED - the ring was read                                  *
+ *               FAIL    - the ring contains invalid record                   *
+ *                                                                            *
+ * Comments: Reading stops at marker until the message sent over socket is    *
+ *           received. After invalid record the ring is not read anymore and  *
+ *           the client must be dropped.                                      *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_read_ring(zbx_ipc_client_t *client)
+{
+	zbx_ipc_message_t	*message;
+	zbx_uint32_t		code, size;
+	unsigned char		*data;
+	char			*error = NULL;
+	int			ret;
+
+	while (0 == client->ring_blocked)
+	{
+		if (SUCCEED != (ret = zbx_ipc_ring_read(client->csocket.ring, &code, &data, &size, &error)))
+		{
+			if (FAIL == ret)
+			{
+				zabbix_log(LOG_LEVEL_WARNING, "cannot read IPC ring of clientid:" ZBX_FS_UI64 ": %s",
+						client->id, error);
+				zbx_free(error);
+				client->ring_blocked = 1;
+
+				return FAIL;
+			}
+
+			if (SUCCEED == zbx_ipc_ring_wait(client->csocket.ring))
+				break;
+
+			continue;
+		}
+
+		if (ZBX_IPC_RING_CODE_MARKER == code)
+		{
+			client->ring_blocked = 1;
+			break;
+		}
+
+		message = (zbx_ipc_message_t *)zbx_malloc(NULL, sizeof(zbx_ipc_message_t));
+		message->code = code;
+		message->size = size;
+		message->data = data;
+		zbx_queue_ptr_push(&client->rx_queue, message);
+	}
+
+	return SUCCEED;
+}
+#endif
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes message received from socket                            *
+ *                                                                            *
+ * Parameters: client - [IN] the client                                       *
+ *                                                                            *
+ * Return value: SUCCEED - the message was processed                          *
+ *               FAIL    - the client ring contains invalid record            *
+ *                                                                            *
+ * Comments: When client uses ring the messages written to ring before the    *
+ *           socket message marker are queued first to keep the order.        *
+ *                                                                            *
+ ******************************************************************************/
+static int	ipc_client_complete_rx_message(zbx_ipc_client_t *client)
+{
+#ifdef ZBX_IPC_RING
+	if (NULL != client->service && NULL != client->csocket.ring)
+	{
+		if (NULL == client->ring_event)
+		{
+			if (ZBX_IPC_RING_CODE_ATTACH == client->rx_header[ZBX_IPC_MESSAGE_CODE])
+			{
+				client->ring_event = event_new(client->service->ev,
+						zbx_ipc_ring_get_doorbell(client->csocket.ring), EV_READ | EV_PERSIST,
+						ipc_client_ring_event_cb, (void *)client);
+				event_add(client->ring_event, NULL);
+
+				zabbix_log(LOG_LEVEL_DEBUG, "attached IPC ring to clientid:" ZBX_FS_UI64, client->id);
+
+				zbx_free(client->rx_data);
+				client->rx_bytes = 0;
+				return SUCCEED;
+			}
+		}
+		else
+		{
+			if (0 == client->ring_blocked && SUCCEED != ipc_client_read_ring(client))
+				return FAIL;
+
+			client->ring_blocked = 0;
+			ipc_client_push_rx_message(client);
+
+			return ipc_client_read_ring(client);
+		}
+	}
+#endif
+	ipc_client_push_rx_message(client);
+
+	return SUCCEED;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: prepares to send the next message in send queue                   *
@@ -618,11 +756,20 @@ static int	ipc_client_read(zbx_ipc_client_t *client)
 		{
 			zbx_free(client->rx_data);
 			client->rx_bytes = 0;
+
+#ifdef ZBX_IPC_RING
+			/* messages written to ring before closing connection must not be lost */
+			if (NULL != client->ring_event)
+				(void)ipc_client_read_ring(client);
+#endif
 			return FAIL;
 		}
 
-		if (SUCCEED == (rc = ipc_message_is_completed(client->rx_header, client->rx_bytes)))
-			ipc_client_push_rx_message(client);
+		if (SUCCEED == (rc = ipc_message_is_completed(client->rx_header, client->rx_bytes)) &&
+				SUCCEED != ipc_client_complete_rx_message(client))
+		{
+			return FAIL;
+		}
 	}
 
 	while (SUCCEED == rc);
@@ -864,6 +1011,31 @@ static void	ipc_client_write_event_cb(evutil_socket_t fd, short what, void *arg)
 		event_del(client->tx_event);
 }
 
+#ifdef ZBX_IPC_RING
+/******************************************************************************
+ *                                                                            *
+ * Purpose: service client ring doorbell libevent callback                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	ipc_client_ring_event_cb(evutil_socket_t fd, short what, void *arg)
+{
+	zbx_ipc_client_t	*client = (zbx_ipc_client_t *)arg;
+
+	ZBX_UNUSED(fd);
+	ZBX_UNUSED(what);
+
+	zbx_ipc_ring_clear_doorbell(client->csocket.ring);
+
+	if (SUCCEED != ipc_client_read_ring(client))
+	{
+		ipc_client_free_events(client);
+		ipc_service_remove_client(client->service, client);
+	}
+
+	ipc_service_push_client(client->service, client);
+}
+#endif
+
 /******************************************************************************
  *                                                                            *
  * Purpose: asynchronous socket write event libevent callback                 *
@@ -1138,6 +1310,7 @@ int	zbx_ipc_socket_open(zbx_ipc_socket_t *csocket, const char *service_name, int
 
 	csocket->rx_buffer_bytes = 0;
 	csocket->rx_buffer_offset = 0;
+	csocket->ring = NULL;
 
 	ret = SUCCEED;
 out:
@@ -1162,9 +1335,72 @@ void	zbx_ipc_socket_close(zbx_ipc_socket_t *csocket)
 		csocket->fd = -1;
 	}
 
+#ifdef ZBX_IPC_RING
+	if (NULL != csocket->ring)
+	{
+		zbx_ipc_ring_free(csocket->ring);
+		csocket->ring = NULL;
+	}
+#endif
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: attaches shared memory ring to opened IPC socket                  *
+ *                                                                            *
+ * Parameters: csocket - [IN/OUT] an opened IPC socket to the service         *
+ *             size    - [IN] the ring data area size, rounded up to power of *
+ *                            two and limited to 64 KiB - 64 MiB range        *
+ *                                                                            *
+ * Comments: Messages written to socket with attached ring are copied into    *
+ *           shared memory ring read directly by the service, the service is  *
+ *           woken up with eventfd doorbell only if it's waiting for data.    *
+ *           Messages larger than quarter of ring and messages not fitting    *
+ *           into ring are still sent over socket, so the size should be      *
+ *           chosen according to the service message rate and size.           *
+ *           The ring is not attached if the service runs under a different   *
+ *           user or if the platform does not support it, in which case the   *
+ *           socket is used as before.                                        *
+ *           The ring has single writer, so the socket must not be shared     *
+ *           between processes or threads.                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_ipc_socket_attach_ring(zbx_ipc_socket_t *csocket, zbx_uint32_t size)
+{
+#ifdef ZBX_IPC_RING
+	zbx_ipc_ring_t	*ring;
+	char		*error = NULL;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL != csocket->ring || SUCCEED != zbx_ipc_ring_check_peer(csocket->fd))
+		goto out;
+
+	if (SUCCEED != zbx_ipc_ring_create(&ring, size, &error))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "cannot create IPC ring: %s", error);
+		zbx_free(error);
+		goto out;
+	}
+
+	if (SUCCEED != zbx_ipc_ring_send_attach(csocket->fd, ring, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "%s", error);
+		zbx_free(error);
+		zbx_ipc_ring_free(ring);
+		goto out;
+	}
+
+	csocket->ring = ring;
+out:
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() ring:%s", __func__, (NULL != csocket->ring ? "yes" : "no"));
+#else
+	ZBX_UNUSED(csocket);
+	ZBX_UNUSED(size);
+#endif
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: writes a message to IPC service                                   *
@@ -1185,6 +1421,23 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+#ifdef ZBX_IPC_RING
+	if (NULL != csocket->ring)
+	{
+		if (SUCCEED == zbx_ipc_ring_write(csocket->ring, code, data, size))
+		{
+			ret = SUCCEED;
+			goto out;
+		}
+
+		/* tell service to wait for the message from socket */
+		if (SUCCEED != zbx_ipc_ring_write_marker(csocket->ring, csocket->fd))
+		{
+			ret = FAIL;
+			goto out;
+		}
+	}
+#endif
 	if (SUCCEED == ipc_socket_write_message(csocket, code, data, size, &size_sent) &&
 			size_sent == size + ZBX_IPC_HEADER_SIZE)
 	{
@@ -1192,7 +1445,9 @@ int	zbx_ipc_socket_write(zbx_ipc_socket_t *csocket, zbx_uint32_t code, const uns
 	}
 	else
 		ret = FAIL;
-
+#ifdef ZBX_IPC_RING
+out:
+#endif
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
 
 	return ret;
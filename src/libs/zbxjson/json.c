@@ -17,6 +17,7 @@
 #include "zbxjson.h"
 #include "json_parser.h"
 #include "jsonpath.h"
+#include "json_scan.h"
 
 #include "zbxnum.h"
 
@@ -591,9 +592,10 @@ static zbx_json_type_t	__zbx_json_type(const char *p)
  ******************************************************************************/
 static const char	*__zbx_json_rbracket(const char *p)
 {
-	int	level = 0;
-	int	state = 0; /* 0 - outside string; 1 - inside string */
-	char	lbracket, rbracket;
+	int		level = 0;
+	int		state = 0; /* 0 - outside string; 1 - inside string */
+	char		lbracket, rbracket;
+	json_scanner_t	scanner;
 
 	assert(p);
 
@@ -604,7 +606,9 @@ static const char	*__zbx_json_rbracket(const char *p)
 
 	rbracket = ('{' == lbracket ? '}' : ']');
 
-	while ('\0' != *p)
+	json_scanner_init(&scanner);
+
+	while ('\0' != *(p = json_scan_structural(&scanner, p)))
 	{
 		switch (*p)
 		{
@@ -691,8 +695,9 @@ int	zbx_json_open(const char *buffer, struct zbx_json_parse *jp)
  ******************************************************************************/
 const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 {
-	int	level = 0;
-	int	state = 0;	/* 0 - outside string; 1 - inside string */
+	int		level = 0;
+	int		state = 0;	/* 0 - outside string; 1 - inside string */
+	json_scanner_t	scanner;
 
 	if (1 == jp->end - jp->start)	/* empty object or array */
 		return NULL;
@@ -704,7 +709,9 @@ const char	*zbx_json_next(const struct zbx_json_parse *jp, const char *p)
 		return p;
 	}
 
-	while (p <= jp->end)
+	json_scanner_init(&scanner);
+
+	while ((p = json_scan_structural(&scanner, p)) <= jp->end)
 	{
 		switch (*p)
 		{
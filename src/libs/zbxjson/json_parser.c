@@ -16,6 +16,7 @@
 
 #include "json.h"
 #include "jsonobj.h"
+#include "json_scan.h"
 
 #include "zbxalgo.h"
 
@@ -69,7 +70,8 @@ static zbx_int64_t	json_parse_string(const char *start, char **str, char **error
 	/* skip starting '"' */
 	ptr++;
 
-	while ('"' != *ptr)
+	/* skip to the next quote, escape or control character */
+	while ('"' != *(ptr = json_scan_string(ptr)))
 	{
 		/* unexpected end of string data, failing */
 		if ('\0' == *ptr)
@@ -0,0 +1,322 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "json_scan.h"
+
+#include "zbxcommon.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#	include <immintrin.h>
+#	define JSON_SCAN_SIMD	1
+#endif
+
+/* character classes */
+#define JSON_SCAN_STRING	0	/* '"', '\\' and control characters, including terminating zero */
+#define JSON_SCAN_STRUCTURAL	1	/* '"', '\\', '{', '}', '[', ']', ',' and terminating zero */
+
+#define JSON_SCAN_BLOCK_SIZE	64
+
+#define JSON_SCAN_IMPL_UNKNOWN	-1
+
+static int	json_scan_impl = JSON_SCAN_IMPL_UNKNOWN;
+
+static int	json_scan_is_string(unsigned char c)
+{
+	return '"' == c || '\\' == c || 0x1f >= c;
+}
+
+static int	json_scan_is_structural(unsigned char c)
+{
+	switch (c)
+	{
+		case '"':
+		case '\\':
+		case '{':
+		case '}':
+		case '[':
+		case ']':
+		case ',':
+		case '\0':
+			return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+#ifdef JSON_SCAN_SIMD
+
+typedef zbx_uint64_t	(*json_scan_block_func_t)(const unsigned char *block, int cls);
+
+static json_scan_block_func_t	json_scan_block;
+
+static unsigned int	json_scan_mask_sse2(__m128i v, int cls)
+{
+	__m128i	m;
+
+	m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+
+	if (JSON_SCAN_STRING == cls)
+	{
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(_mm_and_si128(v, _mm_set1_epi8((char)0xe0)), _mm_setzero_si128()));
+	}
+	else
+	{
+		/* setting 0x20 bit maps '[' to '{' and ']' to '}' */
+		__m128i	b = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(b, _mm_set1_epi8('{')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(b, _mm_set1_epi8('}')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(',')));
+		m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_setzero_si128()));
+	}
+
+	return (unsigned int)_mm_movemask_epi8(m);
+}
+
+static zbx_uint64_t	json_scan_block_sse2(const unsigned char *block, int cls)
+{
+	zbx_uint64_t	mask = 0;
+	int		i;
+
+	for (i = 0; i < JSON_SCAN_BLOCK_SIZE; i += 16)
+		mask |= (zbx_uint64_t)json_scan_mask_sse2(_mm_load_si128((const __m128i *)(block + i)), cls) << i;
+
+	return mask;
+}
+
+__attribute__((target("avx2")))
+static zbx_uint64_t	json_scan_block_avx2(const unsigned char *block, int cls)
+{
+	zbx_uint64_t	mask = 0;
+	int		i;
+
+	for (i = 0; i < JSON_SCAN_BLOCK_SIZE; i += 32)
+	{
+		__m256i	v, m;
+
+		v = _mm256_load_si256((const __m256i *)(block + i));
+		m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')),
+				_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+
+		if (JSON_SCAN_STRING == cls)
+		{
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(_mm256_and_si256(v, _mm256_set1_epi8((char)0xe0)),
+					_mm256_setzero_si256()));
+		}
+		else
+		{
+			__m256i	b = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(b, _mm256_set1_epi8('{')));
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(b, _mm256_set1_epi8('}')));
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')));
+			m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_setzero_si256()));
+		}
+
+		mask |= (zbx_uint64_t)(unsigned int)_mm256_movemask_epi8(m) << i;
+	}
+
+	return mask;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the first character of the specified class starting with   *
+ *          the block containing p                                            *
+ *                                                                            *
+ * Parameters: block     - [IN] the aligned block containing p                *
+ *             mask      - [IN] the class mask of the block                   *
+ *             p         - [IN] the scan start position                       *
+ *             cls       - [IN] the character class                           *
+ *             last      - [OUT] the last scanned block (can be NULL)         *
+ *             last_mask - [OUT] the class mask of the last scanned block     *
+ *                               (can be NULL)                                *
+ *                                                                            *
+ * Comments: The input is read in 64 byte blocks aligned to 64 bytes, so the  *
+ *           reads never cross the page containing the terminating zero.      *
+ *           Terminating zero belongs to all classes and stops the scan.      *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*json_scan_blocks(const unsigned char *block, zbx_uint64_t mask, const char *p, int cls,
+		const unsigned char **last, zbx_uint64_t *last_mask)
+{
+	zbx_uint64_t	rest;
+
+	if (0 == (rest = mask >> ((const unsigned char *)p - block)))
+	{
+		do
+		{
+			block += JSON_SCAN_BLOCK_SIZE;
+		}
+		while (0 == (mask = json_scan_block(block, cls)));
+
+		p = (const char *)block;
+		rest = mask;
+	}
+
+	if (NULL != last)
+	{
+		*last = block;
+		*last_mask = mask;
+	}
+
+	return p + __builtin_ctzll(rest);
+}
+
+#define JSON_SCAN_ALIGN(p)	((const unsigned char *)((uintptr_t)(p) & ~(uintptr_t)(JSON_SCAN_BLOCK_SIZE - 1)))
+
+#endif
+
+static void	json_scan_init(void)
+{
+#ifdef JSON_SCAN_SIMD
+	if (0 != __builtin_cpu_supports("avx2"))
+		(void)json_scan_set_impl(JSON_SCAN_IMPL_AVX2);
+	else
+		(void)json_scan_set_impl(JSON_SCAN_IMPL_SSE2);
+#else
+	(void)json_scan_set_impl(JSON_SCAN_IMPL_SCALAR);
+#endif
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: returns the scan implementation in use                            *
+ *                                                                            *
+ ******************************************************************************/
+int	json_scan_get_impl(void)
+{
+	if (JSON_SCAN_IMPL_UNKNOWN == json_scan_impl)
+		json_scan_init();
+
+	return json_scan_impl;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: selects the scan implementation                                   *
+ *                                                                            *
+ * Parameters: impl - [IN] JSON_SCAN_IMPL_* implementation                    *
+ *                                                                            *
+ * Return value: SUCCEED - the implementation was selected                    *
+ *               FAIL    - the implementation is not supported by CPU         *
+ *                                                                            *
+ * Comments: The implementation is selected automatically on the first scan,  *
+ *           this function is used to compare implementations in tests.       *
+ *                                                                            *
+ ******************************************************************************/
+int	json_scan_set_impl(int impl)
+{
+	switch (impl)
+	{
+		case JSON_SCAN_IMPL_SCALAR:
+			break;
+#ifdef JSON_SCAN_SIMD
+		case JSON_SCAN_IMPL_SSE2:
+			json_scan_block = json_scan_block_sse2;
+			break;
+		case JSON_SCAN_IMPL_AVX2:
+			if (0 == __builtin_cpu_supports("avx2"))
+				return FAIL;
+
+			json_scan_block = json_scan_block_avx2;
+			break;
+#endif
+		default:
+			return FAIL;
+	}
+
+	json_scan_impl = impl;
+
+	return SUCCEED;
+}
+
+void	json_scanner_init(json_scanner_t *scanner)
+{
+	scanner->block = NULL;
+	scanner->mask = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the next structural character                               *
+ *                                                                            *
+ * Parameters: scanner - [IN/OUT] the structural index of the last scanned    *
+ *                                block                                       *
+ *             p       - [IN] the scan start position                         *
+ *                                                                            *
+ * Return value: pointer to the first '"', '\\', '{', '}', '[', ']', ',' or   *
+ *               terminating zero at or after p                               *
+ *                                                                            *
+ * Comments: The block index is kept in scanner so that consecutive scans     *
+ *           within the same block reuse it.                                  *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_structural(json_scanner_t *scanner, const char *p)
+{
+	if (JSON_SCAN_IMPL_UNKNOWN == json_scan_impl)
+		json_scan_init();
+
+#ifdef JSON_SCAN_SIMD
+	if (JSON_SCAN_IMPL_SCALAR != json_scan_impl)
+	{
+		const unsigned char	*block = JSON_SCAN_ALIGN(p);
+
+		if (block != scanner->block)
+		{
+			scanner->block = block;
+			scanner->mask = json_scan_block(block, JSON_SCAN_STRUCTURAL);
+		}
+
+		return json_scan_blocks(block, scanner->mask, p, JSON_SCAN_STRUCTURAL, &scanner->block,
+				&scanner->mask);
+	}
+#else
+	ZBX_UNUSED(scanner);
+#endif
+	while (SUCCEED != json_scan_is_structural((unsigned char)*p))
+		p++;
+
+	return p;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: finds the next character inside JSON string that must be checked *
+ *                                                                            *
+ * Parameters: p - [IN] the scan start position                               *
+ *                                                                            *
+ * Return value: pointer to the first '"', '\\' or control character          *
+ *               (including terminating zero) at or after p                   *
+ *                                                                            *
+ ******************************************************************************/
+const char	*json_scan_string(const char *p)
+{
+	if (JSON_SCAN_IMPL_UNKNOWN == json_scan_impl)
+		json_scan_init();
+
+#ifdef JSON_SCAN_SIMD
+	if (JSON_SCAN_IMPL_SCALAR != json_scan_impl)
+	{
+		const unsigned char	*block = JSON_SCAN_ALIGN(p);
+
+		return json_scan_blocks(block, json_scan_block(block, JSON_SCAN_STRING), p, JSON_SCAN_STRING, NULL,
+				NULL);
+	}
+#endif
+	while (0 == json_scan_is_string((unsigned char)*p))
+		p++;
+
+	return p;
+}
@@ -0,0 +1,39 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#ifndef ZABBIX_JSON_SCAN_H
+#define ZABBIX_JSON_SCAN_H
+
+#include "zbxtypes.h"
+
+#define JSON_SCAN_IMPL_SCALAR	0
+#define JSON_SCAN_IMPL_SSE2	1
+#define JSON_SCAN_IMPL_AVX2	2
+
+/* structural character index of the last scanned input block */
+typedef struct
+{
+	const unsigned char	*block;
+	zbx_uint64_t		mask;
+}
+json_scanner_t;
+
+void	json_scanner_init(json_scanner_t *scanner);
+const char	*json_scan_structural(json_scanner_t *scanner, const char *p);
+const char	*json_scan_string(const char *p);
+
+int	json_scan_get_impl(void);
+int	json_scan_set_impl(int impl);
+
+#endif
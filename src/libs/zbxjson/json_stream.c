@@ -0,0 +1,432 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxjson.h"
+#include "json.h"
+
+#include "zbxstr.h"
+
+/* stream reader states */
+#define JSON_STREAM_OBJECT		0	/* expecting object start */
+#define JSON_STREAM_NAME_OR_END		1	/* expecting member name or object end */
+#define JSON_STREAM_NAME		2	/* expecting member name */
+#define JSON_STREAM_NAME_DATA		3	/* reading member name */
+#define JSON_STREAM_COLON		4	/* expecting name separator */
+#define JSON_STREAM_VALUE		5	/* expecting member value */
+#define JSON_STREAM_VALUE_DATA		6	/* reading member value */
+#define JSON_STREAM_NEXT		7	/* expecting member separator or object end */
+#define JSON_STREAM_ELEMENT_OR_END	8	/* expecting array element or array end */
+#define JSON_STREAM_ELEMENT		9	/* expecting array element */
+#define JSON_STREAM_ELEMENT_DATA	10	/* reading array element */
+#define JSON_STREAM_ELEMENT_NEXT	11	/* expecting element separator or array end */
+#define JSON_STREAM_END			12	/* the object was read */
+#define JSON_STREAM_ERROR		13
+
+/* value reading results */
+#define JSON_STREAM_READ_MORE		0	/* the character belongs to value, value continues */
+#define JSON_STREAM_READ_LAST		1	/* the character is the last value character */
+#define JSON_STREAM_READ_AFTER		2	/* the character follows the value and must be processed again */
+#define JSON_STREAM_READ_FAIL		3	/* invalid value */
+
+static int	json_stream_is_space(char c)
+{
+	switch (c)
+	{
+		case ' ':
+		case '\t':
+		case '\r':
+		case '\n':
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+static void	json_stream_value_start(zbx_json_stream_t *stream)
+{
+	stream->value_offset = 0;
+	stream->level = 0;
+	stream->string = 0;
+	stream->escape = 0;
+	stream->scalar = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: tracks value boundaries character by character                    *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the stream reader                            *
+ *             c      - [IN] the next character                               *
+ *                                                                            *
+ * Return value: JSON_STREAM_READ_* result code                               *
+ *                                                                            *
+ * Comments: Only value boundaries are checked, nested data must be validated *
+ *           by the callback (for example with zbx_json_open()).              *
+ *                                                                            *
+ ******************************************************************************/
+static int	json_stream_read(zbx_json_stream_t *stream, char c)
+{
+	if (0 != stream->string)
+	{
+		if (0 != stream->escape)
+			stream->escape = 0;
+		else if ('\\' == c)
+			stream->escape = 1;
+		else if ('"' == c)
+		{
+			stream->string = 0;
+
+			if (0 == stream->level)
+				return JSON_STREAM_READ_LAST;
+		}
+
+		return JSON_STREAM_READ_MORE;
+	}
+
+	switch (c)
+	{
+		case '"':
+			if (0 != stream->scalar)
+				return JSON_STREAM_READ_FAIL;
+
+			stream->string = 1;
+			return JSON_STREAM_READ_MORE;
+		case '{':
+		case '[':
+			if (0 != stream->scalar)
+				return JSON_STREAM_READ_FAIL;
+
+			stream->level++;
+			return JSON_STREAM_READ_MORE;
+		case '}':
+		case ']':
+			if (0 == stream->level)
+				return 0 != stream->scalar ? JSON_STREAM_READ_AFTER : JSON_STREAM_READ_FAIL;
+
+			if (0 == --stream->level)
+				return JSON_STREAM_READ_LAST;
+
+			return JSON_STREAM_READ_MORE;
+		case ',':
+		case ' ':
+		case '\t':
+		case '\r':
+		case '\n':
+			if (0 == stream->level)
+				return 0 != stream->scalar ? JSON_STREAM_READ_AFTER : JSON_STREAM_READ_FAIL;
+
+			return JSON_STREAM_READ_MORE;
+		default:
+			if (0 == stream->level)
+			{
+				if (0 == isalnum((unsigned char)c) && NULL == strchr("+-.", c))
+					return JSON_STREAM_READ_FAIL;
+
+				stream->scalar = 1;
+			}
+
+			return JSON_STREAM_READ_MORE;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: initializes JSON stream reader                                    *
+ *                                                                            *
+ * Parameters: stream  - [OUT] the stream reader                              *
+ *             cb      - [IN] the callback to receive members and top level   *
+ *                            array elements                                  *
+ *             cb_data - [IN] the callback data                               *
+ *                                                                            *
+ * Comments: The reader accepts a single JSON object split into arbitrary     *
+ *           chunks. Top level members are passed to callback as soon as they *
+ *           are read, members with array values are passed element by        *
+ *           element, so only the largest element must fit in memory.         *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_json_stream_init(zbx_json_stream_t *stream, zbx_json_stream_cb_t cb, void *cb_data)
+{
+	memset(stream, 0, sizeof(zbx_json_stream_t));
+
+	stream->cb = cb;
+	stream->cb_data = cb_data;
+	stream->state = JSON_STREAM_OBJECT;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees resources allocated by JSON stream reader                   *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_json_stream_clear(zbx_json_stream_t *stream)
+{
+	zbx_free(stream->name);
+	zbx_free(stream->value);
+}
+
+static void	json_stream_append(zbx_json_stream_t *stream, const char *start, const char *end)
+{
+	size_t	len = (size_t)(end - start);
+
+	if (stream->value_alloc < stream->value_offset + len + 1)
+	{
+		while (stream->value_alloc < stream->value_offset + len + 1)
+			stream->value_alloc = (0 == stream->value_alloc ? ZBX_KIBIBYTE : stream->value_alloc * 2);
+
+		stream->value = (char *)zbx_realloc(stream->value, stream->value_alloc);
+	}
+
+	memcpy(stream->value + stream->value_offset, start, len);
+	stream->value_offset += len;
+	stream->value[stream->value_offset] = '\0';
+}
+
+static int	json_stream_fail(zbx_json_stream_t *stream, const char *message, char c)
+{
+	zbx_set_json_strerror("%s, found '%c'", message, c);
+	stream->state = JSON_STREAM_ERROR;
+
+	return FAIL;
+}
+
+static int	json_stream_notify(zbx_json_stream_t *stream, int event)
+{
+	if (SUCCEED != stream->cb(stream->cb_data, event, stream->name, stream->value, stream->value_offset))
+	{
+		stream->state = JSON_STREAM_ERROR;
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes the next chunk of JSON data                             *
+ *                                                                            *
+ * Parameters: stream - [IN/OUT] the stream reader                            *
+ *             data   - [IN] the data chunk                                   *
+ *             len    - [IN] the data chunk length                            *
+ *                                                                            *
+ * Return value: SUCCEED - the chunk was processed                            *
+ *               FAIL    - invalid JSON data or the callback failed           *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_stream_feed(zbx_json_stream_t *stream, const char *data, size_t len)
+{
+	const char	*ptr, *start = NULL, *end = data + len;
+
+	if (JSON_STREAM_ERROR == stream->state)
+		return FAIL;
+
+	for (ptr = data; ptr < end;)
+	{
+		int	ret;
+
+		switch (stream->state)
+		{
+			case JSON_STREAM_OBJECT:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if ('{' != *ptr)
+					return json_stream_fail(stream, "invalid object format, expected '{'", *ptr);
+
+				stream->state = JSON_STREAM_NAME_OR_END;
+				break;
+			case JSON_STREAM_NAME_OR_END:
+				if ('}' == *ptr)
+				{
+					stream->state = JSON_STREAM_END;
+					break;
+				}
+				ZBX_FALLTHROUGH;
+			case JSON_STREAM_NAME:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if ('"' != *ptr)
+					return json_stream_fail(stream, "invalid object format, expected member name",
+							*ptr);
+
+				json_stream_value_start(stream);
+				stream->state = JSON_STREAM_NAME_DATA;
+				continue;
+			case JSON_STREAM_COLON:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if (':' != *ptr)
+					return json_stream_fail(stream, "invalid object format, expected ':'", *ptr);
+
+				stream->state = JSON_STREAM_VALUE;
+				break;
+			case JSON_STREAM_VALUE:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if ('[' == *ptr)
+				{
+					json_stream_value_start(stream);
+					json_stream_append(stream, ptr, ptr);
+
+					if (SUCCEED != json_stream_notify(stream, ZBX_JSON_STREAM_ARRAY))
+						return FAIL;
+
+					stream->state = JSON_STREAM_ELEMENT_OR_END;
+					break;
+				}
+
+				json_stream_value_start(stream);
+				stream->state = JSON_STREAM_VALUE_DATA;
+				continue;
+			case JSON_STREAM_NEXT:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if (',' == *ptr)
+					stream->state = JSON_STREAM_NAME;
+				else if ('}' == *ptr)
+					stream->state = JSON_STREAM_END;
+				else
+					return json_stream_fail(stream, "invalid object format, expected ',' or '}'",
+							*ptr);
+				break;
+			case JSON_STREAM_ELEMENT_OR_END:
+				if (']' == *ptr)
+				{
+					json_stream_value_start(stream);
+					json_stream_append(stream, ptr, ptr);
+
+					if (SUCCEED != json_stream_notify(stream, ZBX_JSON_STREAM_ARRAY_END))
+						return FAIL;
+
+					stream->state = JSON_STREAM_NEXT;
+					break;
+				}
+				ZBX_FALLTHROUGH;
+			case JSON_STREAM_ELEMENT:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				json_stream_value_start(stream);
+				stream->state = JSON_STREAM_ELEMENT_DATA;
+				continue;
+			case JSON_STREAM_ELEMENT_NEXT:
+				if (SUCCEED == json_stream_is_space(*ptr))
+					break;
+
+				if (',' == *ptr)
+				{
+					stream->state = JSON_STREAM_ELEMENT;
+					break;
+				}
+
+				if (']' != *ptr)
+					return json_stream_fail(stream, "invalid array format, expected ',' or ']'",
+							*ptr);
+
+				json_stream_value_start(stream);
+				json_stream_append(stream, ptr, ptr);
+
+				if (SUCCEED != json_stream_notify(stream, ZBX_JSON_STREAM_ARRAY_END))
+					return FAIL;
+
+				stream->state = JSON_STREAM_NEXT;
+				break;
+			case JSON_STREAM_END:
+				if (SUCCEED != json_stream_is_space(*ptr))
+					return json_stream_fail(stream, "invalid data after object end", *ptr);
+				break;
+			case JSON_STREAM_NAME_DATA:
+			case JSON_STREAM_VALUE_DATA:
+			case JSON_STREAM_ELEMENT_DATA:
+				if (NULL == start)
+					start = ptr;
+
+				if (JSON_STREAM_READ_MORE == (ret = json_stream_read(stream, *ptr)))
+					break;
+
+				if (JSON_STREAM_READ_FAIL == ret)
+					return json_stream_fail(stream, "invalid value format", *ptr);
+
+				json_stream_append(stream, start, JSON_STREAM_READ_LAST == ret ? ptr + 1 : ptr);
+				start = NULL;
+
+				if (JSON_STREAM_NAME_DATA == stream->state)
+				{
+					if (NULL == zbx_json_decodevalue_dyn(stream->value, &stream->name,
+							&stream->name_alloc, NULL))
+					{
+						return json_stream_fail(stream, "invalid member name", *ptr);
+					}
+
+					stream->state = JSON_STREAM_COLON;
+				}
+				else if (JSON_STREAM_VALUE_DATA == stream->state)
+				{
+					if (SUCCEED != json_stream_notify(stream, ZBX_JSON_STREAM_MEMBER))
+						return FAIL;
+
+					stream->state = JSON_STREAM_NEXT;
+				}
+				else
+				{
+					if (SUCCEED != json_stream_notify(stream, ZBX_JSON_STREAM_ELEMENT))
+						return FAIL;
+
+					stream->state = JSON_STREAM_ELEMENT_NEXT;
+				}
+
+				if (JSON_STREAM_READ_AFTER == ret)
+					continue;
+				break;
+			default:
+				THIS_SHOULD_NEVER_HAPPEN;
+				stream->state = JSON_STREAM_ERROR;
+				return FAIL;
+		}
+
+		ptr++;
+	}
+
+	/* keep the partially read value till the next chunk */
+	if (NULL != start)
+		json_stream_append(stream, start, end);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if the whole JSON object was read                          *
+ *                                                                            *
+ * Return value: SUCCEED - the object was read                                *
+ *               FAIL    - the data was incomplete or invalid                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_json_stream_finish(zbx_json_stream_t *stream)
+{
+	if (JSON_STREAM_ERROR == stream->state)
+		return FAIL;
+
+	if (JSON_STREAM_END != stream->state)
+	{
+		zbx_set_json_strerror("unexpected end of JSON data");
+		stream->state = JSON_STREAM_ERROR;
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
@@ -15,6 +15,7 @@
 #include "jsonpath.h"
 
 #include "json.h"
+#include "json_parser.h"
 
 #include "zbxregexp.h"
 #include "zbxvariant.h"
@@ -1911,17 +1912,16 @@ static void	jsonpath_variant_to_boolean(zbx_variant_t *value)
  ******************************************************************************/
 static int	jsonpath_regexp_match(const char *text, const char *pattern, double *result)
 {
-	zbx_regexp_t	*rxp;
-	char		*error = NULL;
+	const zbx_regexp_t	*rxp;
+	char			*error = NULL;
 
-	if (FAIL == zbx_regexp_compile(pattern, &rxp, &error))
+	if (FAIL == zbx_regexp_compile_cached(pattern, &rxp, &error))
 	{
 		zbx_set_json_strerror("invalid regular expression in JSON path: %s", error);
 		zbx_free(error);
 		return FAIL;
 	}
 	*result = (0 == zbx_regexp_match_precompiled(text, rxp) ? 1.0 : 0.0);
-	zbx_regexp_free(rxp);
 
 	return SUCCEED;
 }
@@ -2872,30 +2872,27 @@ static void	jsonpath_ctx_clear(zbx_jsonpath_context_t *ctx)
 
 /******************************************************************************
  *                                                                            *
- * Purpose: perform jsonpath query on the specified json object               *
+ * Purpose: perform compiled jsonpath query on the specified json object      *
  *                                                                            *
- * Parameters: obj    - [IN] json object                                      *
- *             index  - [IN] jsonpath index (optional)                        *
- *             path   - [IN] jsonpath                                         *
- *             output - [OUT] output value                                    *
+ * Parameters: obj      - [IN] json object                                    *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             jsonpath - [IN] compiled jsonpath                              *
+ *             output   - [OUT] output value                                  *
  *                                                                            *
  * Return value: SUCCEED - the query was performed successfully (empty result *
  *                         being counted as successful query)                 *
  *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+int	zbx_jsonobj_query_path(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output)
 {
 	zbx_jsonpath_context_t	ctx;
-	zbx_jsonpath_t		jsonpath;
 	int			ret = SUCCEED;
 
-	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
-		return FAIL;
-
 	ctx.found = 0;
 	ctx.root = obj;
-	ctx.path = &jsonpath;
+	ctx.path = jsonpath;
 	zbx_vector_jsonobj_ref_create(&ctx.objects);
 	ctx.index = index;
 
@@ -2914,15 +2911,15 @@ int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index,
 	if (SUCCEED == ret)
 	{
 		zbx_vector_jsonobj_ref_t	out;
-		int				definite_path = jsonpath.definite, path_depth;
+		int				definite_path = jsonpath->definite, path_depth;
 
 		zbx_vector_jsonobj_ref_create(&out);
 
-		path_depth = jsonpath.segments_num;
-		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath.segments[path_depth - 1].type)
+		path_depth = jsonpath->segments_num;
+		while (0 < path_depth && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[path_depth - 1].type)
 			path_depth--;
 
-		if (path_depth < jsonpath.segments_num)
+		if (path_depth < jsonpath->segments_num)
 		{
 			if (SUCCEED == (ret = jsonpath_apply_functions(&ctx, path_depth, &definite_path, &out)))
 				ret = jsonpath_format_query_result(&out, definite_path, output);
@@ -2935,6 +2932,34 @@ int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index,
 	}
 
 	jsonpath_ctx_clear(&ctx);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform jsonpath query on the specified json object               *
+ *                                                                            *
+ * Parameters: obj    - [IN] json object                                      *
+ *             index  - [IN] jsonpath index (optional)                        *
+ *             path   - [IN] jsonpath                                         *
+ *             output - [OUT] output value                                    *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonobj_query_ext(const zbx_jsonobj_t *obj, zbx_jsonpath_index_t *index, const char *path, char **output)
+{
+	zbx_jsonpath_t	jsonpath;
+	int		ret;
+
+	if (FAIL == zbx_jsonpath_compile(path, &jsonpath))
+		return FAIL;
+
+	ret = zbx_jsonobj_query_path(obj, index, &jsonpath, output);
+
 	zbx_jsonpath_clear(&jsonpath);
 
 	return ret;
@@ -2945,6 +2970,388 @@ int	zbx_jsonobj_query(const zbx_jsonobj_t *obj, const char *path, char **output)
 	return zbx_jsonobj_query_ext(obj, NULL, path, output);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if jsonpath segment matches single name or index            *
+ *                                                                            *
+ * Parameters: segment - [IN] the jsonpath segment                            *
+ *                                                                            *
+ * Return value: SUCCEED - the segment is simple                              *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	jsonpath_segment_is_simple(const zbx_jsonpath_segment_t *segment)
+{
+	if (ZBX_JSONPATH_SEGMENT_MATCH_LIST != segment->type || 0 != segment->detached ||
+			NULL == segment->data.list.values || NULL != segment->data.list.values->next)
+	{
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if jsonpath consists only of single name or index segments *
+ *                                                                            *
+ * Parameters: jsonpath - [IN] the compiled jsonpath                          *
+ *                                                                            *
+ * Return value: SUCCEED - the jsonpath is simple                             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_is_simple(const zbx_jsonpath_t *jsonpath)
+{
+	int	i;
+
+	if (0 == jsonpath->segments_num)
+		return FAIL;
+
+	for (i = 0; i < jsonpath->segments_num; i++)
+	{
+		if (SUCCEED != jsonpath_segment_is_simple(&jsonpath->segments[i]))
+			return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copy json value in the same format as definite jsonpath query     *
+ *          result                                                            *
+ *                                                                            *
+ * Parameters: p      - [IN] the validated json value                         *
+ *             output - [OUT] the output value                                *
+ *                                                                            *
+ * Return value: SUCCEED - the value was copied successfully                  *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+int	jsonpath_copy_data_value(const char *p, char **output)
+{
+	size_t		output_alloc = 0, output_offset = 0;
+	int		ret;
+	zbx_jsonobj_t	obj;
+
+	jsonobj_init(&obj, ZBX_JSON_TYPE_UNKNOWN);
+
+	if (0 != json_parse_value(p, &obj, 0, NULL))
+		ret = jsonpath_str_copy_value(output, &output_alloc, &output_offset, &obj);
+	else
+		ret = FAIL;
+
+	zbx_jsonobj_clear(&obj);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find object member value by name                                  *
+ *                                                                            *
+ * Parameters: jp         - [IN] the json object                              *
+ *             name       - [IN] the member name                              *
+ *             buf        - [IN/OUT] the member name decoding buffer          *
+ *             buf_alloc  - [IN/OUT] the decoding buffer size                 *
+ *                                                                            *
+ * Return value: pointer to the member value or NULL if not found             *
+ *                                                                            *
+ * Comments: The last member is returned if the name is not unique to match  *
+ *           json object parser behavior.                                     *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*jsonpath_simple_get_member(const struct zbx_json_parse *jp, const char *name, char **buf,
+		size_t *buf_alloc)
+{
+	const char	*p = NULL, *value = NULL;
+
+	while (NULL != (p = zbx_json_next(jp, p)) && p < jp->end)
+	{
+		if (NULL == (p = zbx_json_decodevalue_dyn(p, buf, buf_alloc, NULL)))
+			return NULL;
+
+		SKIP_WHITESPACE(p);
+
+		if (':' != *p++)
+			return NULL;
+
+		SKIP_WHITESPACE(p);
+
+		if (0 == strcmp(*buf, name))
+			value = p;
+	}
+
+	return value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: find array element by index                                       *
+ *                                                                            *
+ * Parameters: jp    - [IN] the json array                                    *
+ *             index - [IN] the element index, negative index is counted from *
+ *                          the end of array                                  *
+ *                                                                            *
+ * Return value: pointer to the element or NULL if not found                  *
+ *                                                                            *
+ ******************************************************************************/
+static const char	*jsonpath_simple_get_element(const struct zbx_json_parse *jp, int index)
+{
+	const char	*p = NULL;
+
+	if (0 > index)
+		index += zbx_json_count(jp);
+
+	if (0 > index)
+		return NULL;
+
+	while (NULL != (p = zbx_json_next(jp, p)) && p < jp->end)
+	{
+		if (0 == index--)
+			return p;
+	}
+
+	return NULL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform simple jsonpath query directly on json data               *
+ *                                                                            *
+ * Parameters: data     - [IN] the validated json data                        *
+ *             jsonpath - [IN] the compiled simple jsonpath                   *
+ *             output   - [OUT] the output value                              *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsonpath_query_simple(const char *data, const zbx_jsonpath_t *jsonpath, char **output)
+{
+	struct zbx_json_parse	jp;
+	const char		*p = data;
+	char			*buf = NULL;
+	size_t			buf_alloc = 0;
+	int			i, ret = SUCCEED;
+
+	SKIP_WHITESPACE(p);
+
+	for (i = 0; i < jsonpath->segments_num; i++)
+	{
+		const zbx_jsonpath_list_t	*list = &jsonpath->segments[i].data.list;
+
+		if (SUCCEED != zbx_json_brackets_open(p, &jp))
+			goto out;
+
+		if ('{' == *p && ZBX_JSONPATH_LIST_NAME == list->type)
+		{
+			p = jsonpath_simple_get_member(&jp, list->values->data, &buf, &buf_alloc);
+		}
+		else if ('[' == *p && ZBX_JSONPATH_LIST_INDEX == list->type)
+		{
+			int	index;
+
+			memcpy(&index, list->values->data, sizeof(index));
+			p = jsonpath_simple_get_element(&jp, index);
+		}
+		else
+			p = NULL;
+
+		if (NULL == p)
+			goto out;
+	}
+
+	ret = jsonpath_copy_data_value(p, output);
+out:
+	zbx_free(buf);
+
+	return ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform compiled jsonpath query on json data                      *
+ *                                                                            *
+ * Parameters: data     - [IN] the json data                                  *
+ *             jsonpath - [IN] the compiled jsonpath                          *
+ *             output   - [OUT] the output value                              *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Paths consisting only of single name or index segments are      *
+ *           resolved directly over the validated json data without building *
+ *           json object tree, other paths are queried from json object.     *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsonpath_query_data(const char *data, const zbx_jsonpath_t *jsonpath, char **output)
+{
+	int		ret;
+	zbx_jsonobj_t	obj;
+
+	if (SUCCEED == jsonpath_is_simple(jsonpath) && 0 != zbx_json_validate(data, NULL))
+		return jsonpath_query_simple(data, jsonpath, output);
+
+	if (SUCCEED != zbx_jsonobj_open(data, &obj))
+		return FAIL;
+
+	ret = zbx_jsonobj_query_path(&obj, NULL, jsonpath, output);
+
+	zbx_jsonobj_clear(&obj);
+
+	return ret;
+}
+
+/* compiled jsonpath cache support */
+
+#define JSONPATH_CACHE_SIZE	4096
+
+typedef struct
+{
+	char		*path;
+	zbx_jsonpath_t	jsonpath;
+	zbx_uint64_t	lastaccess;
+}
+zbx_jsonpath_cache_el_t;
+
+ZBX_PTR_VECTOR_DECL(jsonpath_cache_el_ptr, zbx_jsonpath_cache_el_t *)
+ZBX_PTR_VECTOR_IMPL(jsonpath_cache_el_ptr, zbx_jsonpath_cache_el_t *)
+
+struct zbx_jsonpath_cache
+{
+	zbx_hashset_t	paths;
+	zbx_uint64_t	access;
+};
+
+static zbx_hash_t	jsonpath_cache_el_hash(const void *v)
+{
+	const zbx_jsonpath_cache_el_t	*el = (const zbx_jsonpath_cache_el_t *)v;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(el->path);
+}
+
+static int	jsonpath_cache_el_compare(const void *v1, const void *v2)
+{
+	const zbx_jsonpath_cache_el_t	*el1 = (const zbx_jsonpath_cache_el_t *)v1;
+	const zbx_jsonpath_cache_el_t	*el2 = (const zbx_jsonpath_cache_el_t *)v2;
+
+	return strcmp(el1->path, el2->path);
+}
+
+static void	jsonpath_cache_el_clear(void *v)
+{
+	zbx_jsonpath_cache_el_t	*el = (zbx_jsonpath_cache_el_t *)v;
+
+	zbx_free(el->path);
+	zbx_jsonpath_clear(&el->jsonpath);
+}
+
+static int	jsonpath_cache_el_compare_access(const void *v1, const void *v2)
+{
+	const zbx_jsonpath_cache_el_t	*el1 = *(const zbx_jsonpath_cache_el_t * const *)v1;
+	const zbx_jsonpath_cache_el_t	*el2 = *(const zbx_jsonpath_cache_el_t * const *)v2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(el1->lastaccess, el2->lastaccess);
+
+	return 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create compiled jsonpath cache                                    *
+ *                                                                            *
+ ******************************************************************************/
+zbx_jsonpath_cache_t	*zbx_jsonpath_cache_create(void)
+{
+	zbx_jsonpath_cache_t	*cache;
+
+	cache = (zbx_jsonpath_cache_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_cache_t));
+	zbx_hashset_create_ext(&cache->paths, 0, jsonpath_cache_el_hash, jsonpath_cache_el_compare,
+			jsonpath_cache_el_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	cache->access = 0;
+
+	return cache;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free compiled jsonpath cache                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_jsonpath_cache_free(zbx_jsonpath_cache_t *cache)
+{
+	zbx_hashset_destroy(&cache->paths);
+	zbx_free(cache);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: remove the least recently used half of cached jsonpaths           *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsonpath_cache_trim(zbx_jsonpath_cache_t *cache)
+{
+	zbx_vector_jsonpath_cache_el_ptr_t	els;
+	zbx_hashset_iter_t			iter;
+	zbx_jsonpath_cache_el_t			*el;
+	int					i;
+
+	zbx_vector_jsonpath_cache_el_ptr_create(&els);
+	zbx_vector_jsonpath_cache_el_ptr_reserve(&els, (size_t)cache->paths.num_data);
+
+	zbx_hashset_iter_reset(&cache->paths, &iter);
+	while (NULL != (el = (zbx_jsonpath_cache_el_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_jsonpath_cache_el_ptr_append(&els, el);
+
+	zbx_vector_jsonpath_cache_el_ptr_sort(&els, jsonpath_cache_el_compare_access);
+
+	for (i = 0; i < els.values_num / 2; i++)
+		zbx_hashset_remove_direct(&cache->paths, els.values[i]);
+
+	zbx_vector_jsonpath_cache_el_ptr_destroy(&els);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled jsonpath from cache, compiling it if necessary       *
+ *                                                                            *
+ * Parameters: cache - [IN] the compiled jsonpath cache                       *
+ *             path  - [IN] the jsonpath                                      *
+ *                                                                            *
+ * Return value: The compiled jsonpath or NULL if the path compilation failed *
+ *               (the error can be retrieved with zbx_json_strerror()).       *
+ *                                                                            *
+ * Comments: The returned jsonpath is valid until the next cache call.        *
+ *                                                                            *
+ ******************************************************************************/
+const zbx_jsonpath_t	*zbx_jsonpath_cache_get(zbx_jsonpath_cache_t *cache, const char *path)
+{
+	zbx_jsonpath_cache_el_t	el_local, *el;
+
+	el_local.path = (char *)path;
+
+	if (NULL == (el = (zbx_jsonpath_cache_el_t *)zbx_hashset_search(&cache->paths, &el_local)))
+	{
+		if (FAIL == zbx_jsonpath_compile(path, &el_local.jsonpath))
+			return NULL;
+
+		if (JSONPATH_CACHE_SIZE <= cache->paths.num_data)
+			jsonpath_cache_trim(cache);
+
+		el_local.path = zbx_strdup(NULL, path);
+		el = (zbx_jsonpath_cache_el_t *)zbx_hashset_insert(&cache->paths, &el_local, sizeof(el_local));
+	}
+
+	el->lastaccess = ++cache->access;
+
+	return &el->jsonpath;
+}
+
 #if !defined(_WINDOWS) && !defined(__MINGW32__)
 /* jsonobject index hashset support */
 
@@ -23,7 +23,7 @@
 typedef struct
 {
 	const zbx_jsonobj_t		*root;		/* the root object */
-	zbx_jsonpath_t			*path;
+	const zbx_jsonpath_t		*path;
 	unsigned char			found;		/* set to 1 when one object was matched and */
 							/* no more matches are required             */
 	zbx_vector_jsonobj_ref_t	objects;	/* the matched objects */
@@ -186,4 +186,7 @@ typedef struct
 }
 zbx_jsonobj_index_el_t;
 
+int	jsonpath_segment_is_simple(const zbx_jsonpath_segment_t *segment);
+int	jsonpath_copy_data_value(const char *p, char **output);
+
 #endif
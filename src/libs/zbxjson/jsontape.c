@@ -0,0 +1,535 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "jsonpath.h"
+
+#include "json.h"
+#include "json_parser.h"
+#include "json_scan.h"
+#include "jsonobj.h"
+#include "zbxalgo.h"
+#include "zbxnum.h"
+#include "zbxstr.h"
+
+#if !defined(_WINDOWS) && !defined(__MINGW32__)
+
+/* JSON tape is a flat array of tokens - one token per value and object member name in document order. */
+/* Containers are followed by their contents, the next token index allows to skip value with all its    */
+/* contents. Member lookup indexes and json objects are created only for the accessed containers.       */
+
+typedef struct
+{
+	zbx_uint32_t	offset;		/* the value offset in json data */
+	zbx_uint32_t	next;		/* the index of the token following value with all its contents */
+}
+zbx_jsontape_token_t;
+
+ZBX_VECTOR_DECL(jsontape_token, zbx_jsontape_token_t)
+ZBX_VECTOR_IMPL(jsontape_token, zbx_jsontape_token_t)
+
+/* object member name index */
+typedef struct
+{
+	char		*name;
+	zbx_uint32_t	value;
+}
+zbx_jsontape_member_t;
+
+/* container lookup index */
+typedef struct
+{
+	zbx_uint64_t		token;
+	zbx_hashset_t		members;	/* object member values by name */
+	zbx_vector_uint32_t	elements;	/* array element values */
+}
+zbx_jsontape_index_t;
+
+/* json object created from container contents */
+typedef struct
+{
+	zbx_uint64_t	token;
+	zbx_jsonobj_t	obj;
+}
+zbx_jsontape_obj_t;
+
+struct zbx_jsontape
+{
+	char				*data;
+	zbx_vector_jsontape_token_t	tokens;
+	zbx_hashset_t			indexes;
+	zbx_hashset_t			objects;
+	pthread_mutex_t			lock;
+};
+
+static zbx_hash_t	jsontape_member_hash(const void *v)
+{
+	const zbx_jsontape_member_t	*member = (const zbx_jsontape_member_t *)v;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(member->name);
+}
+
+static int	jsontape_member_compare(const void *v1, const void *v2)
+{
+	const zbx_jsontape_member_t	*member1 = (const zbx_jsontape_member_t *)v1;
+	const zbx_jsontape_member_t	*member2 = (const zbx_jsontape_member_t *)v2;
+
+	return strcmp(member1->name, member2->name);
+}
+
+static void	jsontape_member_clear(void *v)
+{
+	zbx_jsontape_member_t	*member = (zbx_jsontape_member_t *)v;
+
+	zbx_free(member->name);
+}
+
+static void	jsontape_index_clear(void *v)
+{
+	zbx_jsontape_index_t	*index = (zbx_jsontape_index_t *)v;
+
+	zbx_hashset_destroy(&index->members);
+	zbx_vector_uint32_destroy(&index->elements);
+}
+
+static void	jsontape_obj_clear(void *v)
+{
+	zbx_jsontape_obj_t	*obj = (zbx_jsontape_obj_t *)v;
+
+	zbx_jsonobj_clear(&obj->obj);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: validate json data                                                *
+ *                                                                            *
+ * Parameters: data  - [IN] the json data                                     *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: SUCCEED - the data is valid json object or array             *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: The same error messages as zbx_jsonobj_open() are returned.      *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsontape_validate(const char *data, char **error)
+{
+	zbx_int64_t	offset;
+
+	SKIP_WHITESPACE(data);
+
+	switch (*data)
+	{
+		case '{':
+			if (0 == (offset = json_parse_object(data, NULL, 0, error)))
+				return FAIL;
+			break;
+		case '[':
+			if (0 == (offset = json_parse_array(data, NULL, 0, error)))
+				return FAIL;
+			break;
+		default:
+			/* not json data, failing */
+			(void)json_error("invalid object format, expected opening character '{' or '['", data, error);
+			return FAIL;
+	}
+
+	data += offset;
+	SKIP_WHITESPACE(data);
+
+	if ('\0' != *data)
+	{
+		(void)json_error("invalid data trailing JSON object", data, error);
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static void	jsontape_add_token(zbx_jsontape_t *tape, const char *p, zbx_uint32_t next)
+{
+	zbx_jsontape_token_t	token;
+
+	token.offset = (zbx_uint32_t)(p - tape->data);
+	token.next = next;
+
+	zbx_vector_jsontape_token_append(&tape->tokens, token);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create tokens from validated json data                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsontape_parse(zbx_jsontape_t *tape)
+{
+	const char		*p = tape->data;
+	zbx_vector_uint32_t	containers;
+
+	zbx_vector_uint32_create(&containers);
+
+	/* reserve for average value length of 8 characters */
+	zbx_vector_jsontape_token_reserve(&tape->tokens, strlen(p) / 8 + 1);
+
+	while (1)
+	{
+		SKIP_WHITESPACE(p);
+
+		switch (*p)
+		{
+			case '\0':
+				zbx_vector_uint32_destroy(&containers);
+				return;
+			case '{':
+			case '[':
+				zbx_vector_uint32_append(&containers, (zbx_uint32_t)tape->tokens.values_num);
+				jsontape_add_token(tape, p++, 0);
+				break;
+			case '}':
+			case ']':
+				tape->tokens.values[containers.values[containers.values_num - 1]].next =
+						(zbx_uint32_t)tape->tokens.values_num;
+				zbx_vector_uint32_remove_noorder(&containers, containers.values_num - 1);
+				p++;
+				break;
+			case ',':
+			case ':':
+				p++;
+				break;
+			case '"':
+				jsontape_add_token(tape, p++, (zbx_uint32_t)tape->tokens.values_num + 1);
+
+				while ('"' != *(p = json_scan_string(p)))
+					p += 2;	/* skip escaped character */
+				p++;
+				break;
+			default:
+				jsontape_add_token(tape, p, (zbx_uint32_t)tape->tokens.values_num + 1);
+
+				while ('\0' != *p && NULL == strchr(",]}" ZBX_WHITESPACE, *p))
+					p++;
+		}
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create json tape                                                  *
+ *                                                                            *
+ * Parameters: data  - [IN] the json data                                     *
+ *             error - [OUT] the error message                                *
+ *                                                                            *
+ * Return value: The created json tape or NULL if the data is not valid json  *
+ *               object or array.                                             *
+ *                                                                            *
+ * Comments: Json tape can be queried from multiple threads.                  *
+ *                                                                            *
+ ******************************************************************************/
+zbx_jsontape_t	*zbx_jsontape_open(const char *data, char **error)
+{
+	zbx_jsontape_t	*tape;
+	int		err;
+
+	if (ZBX_MAX_UINT31_1 < strlen(data))
+	{
+		*error = zbx_strdup(NULL, "JSON data is too large");
+		return NULL;
+	}
+
+	if (SUCCEED != jsontape_validate(data, error))
+		return NULL;
+
+	tape = (zbx_jsontape_t *)zbx_malloc(NULL, sizeof(zbx_jsontape_t));
+
+	if (0 != (err = pthread_mutex_init(&tape->lock, NULL)))
+	{
+		*error = zbx_dsprintf(NULL, "cannot initialize json tape mutex: %s", zbx_strerror(err));
+		zbx_free(tape);
+		return NULL;
+	}
+
+	tape->data = zbx_strdup(NULL, data);
+	zbx_vector_jsontape_token_create(&tape->tokens);
+	jsontape_parse(tape);
+
+	zbx_hashset_create_ext(&tape->indexes, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			jsontape_index_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_hashset_create_ext(&tape->objects, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			jsontape_obj_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+
+	return tape;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: free json tape                                                    *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_jsontape_free(zbx_jsontape_t *tape)
+{
+	pthread_mutex_destroy(&tape->lock);
+
+	zbx_hashset_destroy(&tape->objects);
+	zbx_hashset_destroy(&tape->indexes);
+	zbx_vector_jsontape_token_destroy(&tape->tokens);
+	zbx_free(tape->data);
+	zbx_free(tape);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create container lookup index                                     *
+ *                                                                            *
+ * Parameters: tape  - [IN] the json tape                                     *
+ *             index - [IN/OUT] the container index                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	jsontape_index_build(const zbx_jsontape_t *tape, zbx_jsontape_index_t *index)
+{
+	const zbx_jsontape_token_t	*container = &tape->tokens.values[index->token];
+	zbx_uint32_t			i = (zbx_uint32_t)index->token + 1;
+
+	zbx_hashset_create_ext(&index->members, 0, jsontape_member_hash, jsontape_member_compare,
+			jsontape_member_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	zbx_vector_uint32_create(&index->elements);
+
+	if ('[' == tape->data[container->offset])
+	{
+		for (; i < container->next; i = tape->tokens.values[i].next)
+			zbx_vector_uint32_append(&index->elements, i);
+
+		return;
+	}
+
+	for (; i < container->next; i = tape->tokens.values[i + 1].next)
+	{
+		zbx_jsontape_member_t	member_local = {.name = NULL}, *member;
+		size_t			name_alloc = 0;
+
+		(void)zbx_json_decodevalue_dyn(tape->data + tape->tokens.values[i].offset, &member_local.name,
+				&name_alloc, NULL);
+		member_local.value = i + 1;
+
+		/* the last member is used if the name is not unique to match json object parser behavior */
+		if (NULL != (member = (zbx_jsontape_member_t *)zbx_hashset_search(&index->members, &member_local)))
+		{
+			member->value = member_local.value;
+			zbx_free(member_local.name);
+		}
+		else
+			zbx_hashset_insert(&index->members, &member_local, sizeof(member_local));
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get container lookup index, creating it on first access           *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_jsontape_index_t	*jsontape_index_get(zbx_jsontape_t *tape, zbx_uint32_t token)
+{
+	zbx_jsontape_index_t	index_local, *index;
+
+	index_local.token = token;
+
+	pthread_mutex_lock(&tape->lock);
+
+	if (NULL == (index = (zbx_jsontape_index_t *)zbx_hashset_search(&tape->indexes, &index_local)))
+	{
+		jsontape_index_build(tape, &index_local);
+		index = (zbx_jsontape_index_t *)zbx_hashset_insert(&tape->indexes, &index_local, sizeof(index_local));
+	}
+
+	pthread_mutex_unlock(&tape->lock);
+
+	return index;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get json object of the specified value, creating it on first      *
+ *          access                                                            *
+ *                                                                            *
+ ******************************************************************************/
+static const zbx_jsonobj_t	*jsontape_obj_get(zbx_jsontape_t *tape, zbx_uint32_t token)
+{
+	zbx_jsontape_obj_t	obj_local, *obj;
+
+	obj_local.token = token;
+
+	pthread_mutex_lock(&tape->lock);
+
+	if (NULL == (obj = (zbx_jsontape_obj_t *)zbx_hashset_search(&tape->objects, &obj_local)))
+	{
+		jsonobj_init(&obj_local.obj, ZBX_JSON_TYPE_UNKNOWN);
+		(void)json_parse_value(tape->data + tape->tokens.values[token].offset, &obj_local.obj, 0, NULL);
+		obj = (zbx_jsontape_obj_t *)zbx_hashset_insert(&tape->objects, &obj_local, sizeof(obj_local));
+	}
+
+	pthread_mutex_unlock(&tape->lock);
+
+	return &obj->obj;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: match single name or index jsonpath segment                       *
+ *                                                                            *
+ * Parameters: tape    - [IN] the json tape                                   *
+ *             token   - [IN] the container token                             *
+ *             segment - [IN] the simple jsonpath segment                     *
+ *             value   - [OUT] the matched value token                        *
+ *                                                                            *
+ * Return value: SUCCEED - the segment was matched                            *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsontape_match_segment(zbx_jsontape_t *tape, zbx_uint32_t token,
+		const zbx_jsonpath_segment_t *segment, zbx_uint32_t *value)
+{
+	const zbx_jsontape_index_t	*index;
+	const zbx_jsonpath_list_t	*list = &segment->data.list;
+	char				type = tape->data[tape->tokens.values[token].offset];
+
+	if ('{' == type && ZBX_JSONPATH_LIST_NAME == list->type)
+	{
+		zbx_jsontape_member_t	member_local, *member;
+
+		index = jsontape_index_get(tape, token);
+		member_local.name = (char *)list->values->data;
+
+		if (NULL == (member = (zbx_jsontape_member_t *)zbx_hashset_search(&index->members, &member_local)))
+			return FAIL;
+
+		*value = member->value;
+
+		return SUCCEED;
+	}
+
+	if ('[' == type && ZBX_JSONPATH_LIST_INDEX == list->type)
+	{
+		int	query_index;
+
+		index = jsontape_index_get(tape, token);
+		memcpy(&query_index, list->values->data, sizeof(query_index));
+
+		if (0 > query_index)
+			query_index += index->elements.values_num;
+
+		if (0 > query_index || query_index >= index->elements.values_num)
+			return FAIL;
+
+		*value = index->elements.values[query_index];
+
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the number of leading jsonpath segments that can be matched   *
+ *          directly on json tape                                             *
+ *                                                                            *
+ ******************************************************************************/
+static int	jsontape_path_prefix(const zbx_jsonpath_t *jsonpath)
+{
+	int	prefix, i, j;
+
+	for (prefix = 0; prefix < jsonpath->segments_num; prefix++)
+	{
+		if (SUCCEED != jsonpath_segment_is_simple(&jsonpath->segments[prefix]))
+			break;
+	}
+
+	if (prefix == jsonpath->segments_num)
+		return prefix;
+
+	/* functions must be applied to values matched by json object query to keep their names */
+	if (0 < prefix && ZBX_JSONPATH_SEGMENT_FUNCTION == jsonpath->segments[prefix].type)
+		prefix--;
+
+	/* absolute paths in expressions must be resolved from the document root */
+	for (i = prefix; i < jsonpath->segments_num; i++)
+	{
+		const zbx_jsonpath_segment_t	*segment = &jsonpath->segments[i];
+
+		if (ZBX_JSONPATH_SEGMENT_MATCH_EXPRESSION != segment->type)
+			continue;
+
+		for (j = 0; j < segment->data.expression.tokens.values_num; j++)
+		{
+			if (ZBX_JSONPATH_TOKEN_PATH_ABSOLUTE == segment->data.expression.tokens.values[j]->type)
+				return 0;
+		}
+	}
+
+	return prefix;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: perform compiled jsonpath query on json tape                      *
+ *                                                                            *
+ * Parameters: tape     - [IN] the json tape                                  *
+ *             index    - [IN] jsonpath index (optional)                      *
+ *             jsonpath - [IN] the compiled jsonpath                          *
+ *             output   - [OUT] the output value                              *
+ *                                                                            *
+ * Return value: SUCCEED - the query was performed successfully (empty result *
+ *                         being counted as successful query)                 *
+ *               FAIL    - otherwise                                          *
+ *                                                                            *
+ * Comments: Leading single name or index segments are matched directly on    *
+ *           json tape. The rest of jsonpath is queried from json object      *
+ *           created only for the matched value.                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_jsontape_query(zbx_jsontape_t *tape, zbx_jsonpath_index_t *index, const zbx_jsonpath_t *jsonpath,
+		char **output)
+{
+	zbx_jsonpath_t	path_local;
+	zbx_uint32_t	token = 0;
+	int		i, prefix;
+
+	prefix = jsontape_path_prefix(jsonpath);
+
+	for (i = 0; i < prefix; i++)
+	{
+		if (SUCCEED == jsontape_match_segment(tape, token, &jsonpath->segments[i], &token))
+			continue;
+
+		/* without functions nothing can be matched by the rest of jsonpath */
+		if (ZBX_JSONPATH_SEGMENT_FUNCTION != jsonpath->segments[jsonpath->segments_num - 1].type)
+			return SUCCEED;
+
+		prefix = 0;
+		token = 0;
+		break;
+	}
+
+	if (0 != prefix && prefix == jsonpath->segments_num)
+		return jsonpath_copy_data_value(tape->data + tape->tokens.values[token].offset, output);
+
+	path_local = *jsonpath;
+	path_local.segments += prefix;
+	path_local.segments_num -= prefix;
+
+	return zbx_jsonobj_query_path(jsontape_obj_get(tape, token), index, &path_local, output);
+}
+
+#endif
@@ -620,10 +620,10 @@ int	item_preproc_2dec(zbx_variant_t *value, int op_type, char **errmsg)
  ******************************************************************************/
 int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errmsg)
 {
-	char		*pattern, *output, *new_value = NULL;
-	char		*regex_error = NULL;
-	zbx_regexp_t	*regex = NULL;
-	int		ret = FAIL;
+	char			*pattern, *output, *new_value = NULL;
+	char			*regex_error = NULL;
+	const zbx_regexp_t	*regex;
+	int			ret = FAIL;
 
 	if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 		return FAIL;
@@ -638,7 +638,8 @@ int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errm
 
 	*output++ = '\0';
 
-	if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &regex_error))	/* PCRE_MULTILINE is not used here */
+	/* PCRE_MULTILINE is not used here */
+	if (FAIL == zbx_regexp_compile_ext_cached(pattern, &regex, 0, &regex_error))
 	{
 		*errmsg = zbx_dsprintf(*errmsg, "invalid regular expression: %s", regex_error);
 		zbx_free(regex_error);
@@ -656,9 +657,6 @@ int	item_preproc_regsub_op(zbx_variant_t *value, const char *params, char **errm
 
 	ret = SUCCEED;
 out:
-	if (NULL != regex)
-		zbx_regexp_free(regex);
-
 	zbx_free(pattern);
 
 	return ret;
@@ -758,11 +756,11 @@ out:
  ******************************************************************************/
 int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params, char **error)
 {
-	zbx_variant_t	value_str;
-	int		ret = FAIL;
-	zbx_regexp_t	*regex;
-	char		*errptr = NULL;
-	char		*errmsg;
+	zbx_variant_t		value_str;
+	int			ret = FAIL;
+	const zbx_regexp_t	*regex;
+	char			*errptr = NULL;
+	char			*errmsg;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -772,7 +770,7 @@ int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params,
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (FAIL == zbx_regexp_compile_cached(params, &regex, &errptr))
 	{
 		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
 		zbx_free(errptr);
@@ -783,8 +781,6 @@ int	item_preproc_validate_regex(const zbx_variant_t *value, const char *params,
 		errmsg = zbx_strdup(NULL, "value does not match regular expression");
 	else
 		ret = SUCCEED;
-
-	zbx_regexp_free(regex);
 out:
 	zbx_variant_clear(&value_str);
 
@@ -813,11 +809,11 @@ out:
  ******************************************************************************/
 int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *params, char **error)
 {
-	zbx_variant_t	value_str;
-	int		ret = FAIL;
-	zbx_regexp_t	*regex;
-	char		*errptr = NULL;
-	char		*errmsg;
+	zbx_variant_t		value_str;
+	int			ret = FAIL;
+	const zbx_regexp_t	*regex;
+	char			*errptr = NULL;
+	char			*errmsg;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -827,7 +823,7 @@ int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *para
 		goto out;
 	}
 
-	if (FAIL == zbx_regexp_compile(params, &regex, &errptr))
+	if (FAIL == zbx_regexp_compile_cached(params, &regex, &errptr))
 	{
 		errmsg = zbx_dsprintf(NULL, "invalid regular expression pattern: %s", errptr);
 		zbx_free(errptr);
@@ -840,8 +836,6 @@ int	item_preproc_validate_not_regex(const zbx_variant_t *value, const char *para
 	}
 	else
 		ret = SUCCEED;
-
-	zbx_regexp_free(regex);
 out:
 	zbx_variant_clear(&value_str);
 
@@ -1092,10 +1086,10 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 {
 #define ZBX_PP_MATCH_TYPE_MATCHES	0
 #define ZBX_PP_MATCH_TYPE_ANY		-1
-	zbx_variant_t	value_str;
-	int		ret = SUCCEED, match_type = ZBX_PP_MATCH_TYPE_ANY;
-	char		*pattern = NULL, *newline, *out = NULL, *errptr = NULL;
-	zbx_regexp_t	*regex;
+	zbx_variant_t		value_str;
+	int			ret = SUCCEED, match_type = ZBX_PP_MATCH_TYPE_ANY;
+	char			*pattern = NULL, *newline, *out = NULL, *errptr = NULL;
+	const zbx_regexp_t	*regex;
 
 	zbx_variant_copy(&value_str, value);
 
@@ -1111,7 +1105,7 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 
 	if (ZBX_PP_MATCH_TYPE_MATCHES == match_type)
 	{
-		if (FAIL == zbx_regexp_compile_ext(pattern, &regex, 0, &errptr))
+		if (FAIL == zbx_regexp_compile_ext_cached(pattern, &regex, 0, &errptr))
 		{
 			*error = zbx_dsprintf(*error, "invalid regular expression: %s", errptr);
 			zbx_free(errptr);
@@ -1134,7 +1128,7 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 	{
 		int	res;
 
-		if (FAIL == zbx_regexp_compile(pattern, &regex, &errptr))
+		if (FAIL == zbx_regexp_compile_cached(pattern, &regex, &errptr))
 		{
 			*error = zbx_dsprintf(*error, "invalid regular expression: %s", errptr);
 			zbx_free(errptr);
@@ -1154,8 +1148,6 @@ int	item_preproc_check_error_regex(const zbx_variant_t *value, const char *param
 			ret = FAIL;
 		}
 	}
-
-	zbx_regexp_free(regex);
 out:
 	zbx_free(pattern);
 	zbx_variant_clear(&value_str);
@@ -74,7 +74,7 @@ static void	pp_cache_free(zbx_pp_cache_t *cache)
 		switch (cache->type)
 		{
 			case ZBX_PREPROC_JSONPATH:
-				zbx_jsonobj_clear(&((zbx_pp_cache_jsonpath_t *)cache->data)->obj);
+				zbx_jsontape_free(((zbx_pp_cache_jsonpath_t *)cache->data)->tape);
 				zbx_jsonpath_index_free(((zbx_pp_cache_jsonpath_t *)cache->data)->index);
 				break;
 			case ZBX_PREPROC_PROMETHEUS_PATTERN:
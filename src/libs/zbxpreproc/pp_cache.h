@@ -21,7 +21,7 @@
 
 typedef struct
 {
-	zbx_jsonobj_t		obj;
+	zbx_jsontape_t		*tape;
 	zbx_jsonpath_index_t	*index;
 }
 zbx_pp_cache_jsonpath_t;
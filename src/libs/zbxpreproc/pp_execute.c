@@ -239,7 +239,8 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
  *                                                                            *
  * Purpose: execute jsonpath query                                            *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
+ * Parameters: ctx    - [IN] worker specific execution context                *
+ *             cache  - [IN] preprocessing cache                              *
  *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *             errmsg - [OUT]                                                 *
@@ -248,32 +249,45 @@ static int	pp_execute_regsub(zbx_variant_t *value, const char *params)
  *               FAIL    - otherwise.                                         *
  *                                                                            *
  ******************************************************************************/
-static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params,
-		char **errmsg)
+static int	pp_excute_jsonpath_query(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_variant_t *value,
+		const char *params, char **errmsg)
 {
-	char	*data = NULL;
+	char			*data = NULL;
+	const zbx_jsonpath_t	*jsonpath;
 
 	if (NULL == cache || ZBX_PREPROC_JSONPATH != cache->type)
 	{
-		zbx_jsonobj_t	obj;
-
 		if (FAIL == item_preproc_convert_value(value, ZBX_VARIANT_STR, errmsg))
 			return FAIL;
 
-		if (FAIL == zbx_jsonobj_open(value->data.str, &obj))
+		if (NULL != (jsonpath = pp_context_jsonpath(ctx, params)))
 		{
-			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
-			return FAIL;
+			if (FAIL == zbx_jsonpath_query_data(value->data.str, jsonpath, &data))
+			{
+				*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+				return FAIL;
+			}
 		}
-
-		if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+		else
 		{
+			zbx_jsonobj_t	obj;
+
+			/* invalid json data must be reported before invalid path */
+			if (FAIL == zbx_jsonobj_open(value->data.str, &obj))
+			{
+				*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+				return FAIL;
+			}
+
+			if (FAIL == zbx_jsonobj_query(&obj, params, &data))
+			{
+				zbx_jsonobj_clear(&obj);
+				*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
+				return FAIL;
+			}
+
 			zbx_jsonobj_clear(&obj);
-			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
-			return FAIL;
 		}
-
-		zbx_jsonobj_clear(&obj);
 	}
 	else
 	{
@@ -292,9 +306,8 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 			index = (zbx_pp_cache_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_pp_cache_jsonpath_t));
 
-			if (SUCCEED != zbx_jsonobj_open(value->data.str, &index->obj))
+			if (NULL == (index->tape = zbx_jsontape_open(value->data.str, &cache->error)))
 			{
-				cache->error = zbx_strdup(NULL, zbx_json_strerror());
 				*errmsg = zbx_strdup(NULL, cache->error);
 				zbx_free(index);
 				return FAIL;
@@ -302,7 +315,7 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 
 			if (NULL == (index->index = zbx_jsonpath_index_create(errmsg)))
 			{
-				zbx_jsonobj_clear(&index->obj);
+				zbx_jsontape_free(index->tape);
 				zbx_free(index);
 				cache->type = ZBX_PREPROC_NONE;
 				return FAIL;
@@ -311,7 +324,8 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
 			cache->data = (void *)index;
 		}
 
-		if (FAIL == zbx_jsonobj_query_ext(&index->obj, index->index, params, &data))
+		if (NULL == (jsonpath = pp_context_jsonpath(ctx, params)) ||
+				FAIL == zbx_jsontape_query(index->tape, index->index, jsonpath, &data))
 		{
 			*errmsg = zbx_strdup(*errmsg, zbx_json_strerror());
 			return FAIL;
@@ -334,7 +348,8 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *                                                                            *
  * Purpose: execute 'jsonpath' step                                           *
  *                                                                            *
- * Parameters: cache  - [IN] preprocessing cache                              *
+ * Parameters: ctx    - [IN] worker specific execution context                *
+ *             cache  - [IN] preprocessing cache                              *
  *             value  - [IN/OUT] value to process                             *
  *             params - [IN] step parameters                                  *
  *                                                                            *
@@ -342,12 +357,13 @@ static int	pp_excute_jsonpath_query(zbx_pp_cache_t *cache, zbx_variant_t *value,
  *               FAIL    - otherwise. The error message is stored in value.   *
  *                                                                            *
  ******************************************************************************/
-static int	pp_execute_jsonpath(zbx_pp_cache_t *cache, zbx_variant_t *value, const char *params)
+static int	pp_execute_jsonpath(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_variant_t *value,
+		const char *params)
 {
 	char	*errmsg = NULL, *error = NULL;
 	size_t	error_alloc = 0, error_offset = 0;
 
-	if (SUCCEED == pp_excute_jsonpath_query(cache, value, params, &errmsg))
+	if (SUCCEED == pp_excute_jsonpath_query(ctx, cache, value, params, &errmsg))
 		return SUCCEED;
 
 	zbx_variant_clear(value);
@@ -1118,7 +1134,7 @@ int	pp_execute_step(zbx_pp_context_t *ctx, zbx_pp_cache_t *cache, zbx_dc_um_shar
 			ret = pp_execute_xpath(value, params);
 			goto out;
 		case ZBX_PREPROC_JSONPATH:
-			ret = pp_execute_jsonpath(cache, value, params);
+			ret = pp_execute_jsonpath(ctx, cache, value, params);
 			goto out;
 		case ZBX_PREPROC_VALIDATE_RANGE:
 			ret = pp_validate_range(value_type, value, params);
@@ -1367,6 +1383,9 @@ void	pp_context_destroy(zbx_pp_context_t *ctx)
 {
 	if (0 != ctx->es_initialized)
 		zbx_es_destroy(&ctx->es_engine);
+
+	if (NULL != ctx->jsonpath_cache)
+		zbx_jsonpath_cache_free(ctx->jsonpath_cache);
 }
 
 zbx_es_t	*pp_context_es_engine(zbx_pp_context_t *ctx)
@@ -1379,3 +1398,25 @@ zbx_es_t	*pp_context_es_engine(zbx_pp_context_t *ctx)
 
 	return &ctx->es_engine;
 }
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get compiled jsonpath from worker specific cache                  *
+ *                                                                            *
+ * Parameters: ctx  - [IN] worker specific execution context                  *
+ *             path - [IN] the jsonpath                                       *
+ *                                                                            *
+ * Return value: The compiled jsonpath or NULL if the path is not valid.      *
+ *                                                                            *
+ * Comments: Step parameters can contain user macros resolved before each     *
+ *           execution, so compiled paths are cached by the resolved path     *
+ *           text rather than stored in preprocessing steps.                  *
+ *                                                                            *
+ ******************************************************************************/
+const zbx_jsonpath_t	*pp_context_jsonpath(zbx_pp_context_t *ctx, const char *path)
+{
+	if (NULL == ctx->jsonpath_cache)
+		ctx->jsonpath_cache = zbx_jsonpath_cache_create();
+
+	return zbx_jsonpath_cache_get(ctx->jsonpath_cache, path);
+}
@@ -252,39 +252,40 @@ static void	zbx_pp_manager_queue_value_preproc(zbx_pp_manager_t *manager, zbx_ve
  *                                                                            *
  * Purpose: create preprocessing task from request                            *
  *                                                                            *
- * Parameters: manager   - [IN]                                               *
- *             itemid    - [IN] item identifier                               *
- *             value     - [IN] value to preprocess, its contents will be     *
- *                              directly copied over and cleared by the task  *
- *             ts        - [IN] value timestamp                               *
- *             value_opt - [IN] optional value data (optional)                *
+ * Parameters: manager - [IN]                                                 *
+ *             item    - [IN] the item (can be NULL)                          *
+ *             view    - [IN] the value decoded from request, its data is     *
+ *                            copied to the task                              *
  *                                                                            *
  * Return value: The created task or NULL if the data can be flushed directly.*
  *                                                                            *
  ******************************************************************************/
-static zbx_pp_task_t	*zbx_pp_manager_create_task(zbx_pp_manager_t *manager, zbx_uint64_t itemid,
-		zbx_variant_t *value, zbx_timespec_t ts, const zbx_pp_value_opt_t *value_opt)
+static zbx_pp_task_t	*zbx_pp_manager_create_task(zbx_pp_manager_t *manager, zbx_pp_item_t *item,
+		const zbx_pp_value_view_t *view)
 {
-	zbx_pp_item_t	*item;
+	zbx_variant_t		value;
+	zbx_pp_value_opt_t	value_opt;
 
-	if (ZBX_VARIANT_NONE == value->type)
+	if (ZBX_VARIANT_NONE == view->value.type)
 		return NULL;
 
-	if (NULL == (item = (zbx_pp_item_t *)zbx_hashset_search(&manager->items, &itemid)))
+	if (NULL == item)
 		return NULL;
 
 	if (0 == item->preproc->dep_itemids_num && 0 == item->preproc->steps_num)
 		return NULL;
 
+	zbx_pp_value_view_copy(view, &value, &value_opt);
+
 	if (ZBX_PP_PROCESS_PARALLEL == item->preproc->mode)
 	{
-		return pp_task_value_create(item->itemid, item->preproc, manager->um_handle, value, ts, value_opt,
-				NULL);
+		return pp_task_value_create(item->itemid, item->preproc, manager->um_handle, &value, view->ts,
+				&value_opt, NULL);
 	}
 	else
 	{
-		return pp_task_value_seq_create(item->itemid, item->preproc, manager->um_handle, value, ts, value_opt,
-				NULL);
+		return pp_task_value_seq_create(item->itemid, item->preproc, manager->um_handle, &value, view->ts,
+				&value_opt, NULL);
 	}
 }
 
@@ -458,19 +459,20 @@ static zbx_pp_task_t	*pp_manager_queue_dependent_task_result(zbx_pp_manager_t *m
  *                                                                            *
  * Parameters: manager  - [IN] manager                                        *
  *             task_seq - [IN] finished sequence task                         *
+ *             tasks    - [OUT] processed tasks of the sequence               *
  *                                                                            *
  * Comments: This function called within task queue lock.                     *
  *                                                                            *
  ******************************************************************************/
-static zbx_pp_task_t	*pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *manager, zbx_pp_task_t *task_seq)
+static void	pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *manager, zbx_pp_task_t *task_seq,
+		zbx_vector_pp_task_ptr_t *tasks)
 {
 	zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task_seq);
-	zbx_pp_task_t		*task = NULL, *tmp_task;
+	zbx_pp_task_t		*task, *tmp_task;
 
-	if (SUCCEED == zbx_list_pop(&d_seq->tasks, (void **)&task))
+	/* pop the tasks processed by worker, their processing time was already set */
+	for (int i = 0; i < d_seq->batch_num && SUCCEED == zbx_list_pop(&d_seq->tasks, (void **)&task); i++)
 	{
-		task->time_ms = task_seq->time_ms;
-
 		switch (task->type)
 		{
 			case ZBX_PP_TASK_VALUE:
@@ -484,8 +486,12 @@ static zbx_pp_task_t	*pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *ma
 				THIS_SHOULD_NEVER_HAPPEN;
 				break;
 		}
+
+		zbx_vector_pp_task_ptr_append(tasks, task);
 	}
 
+	d_seq->batch_num = 0;
+
 	if (SUCCEED == zbx_list_peek(&d_seq->tasks, (void **)&tmp_task))
 	{
 		pp_task_queue_push_immediate(&manager->queue, task_seq);
@@ -496,8 +502,6 @@ static zbx_pp_task_t	*pp_manager_requeue_next_sequence_task(zbx_pp_manager_t *ma
 		pp_task_queue_remove_sequence(&manager->queue, task_seq->itemid);
 		pp_task_free(task_seq);
 	}
-
-	return task;
 }
 
 /******************************************************************************
@@ -539,8 +543,8 @@ static void	zbx_pp_manager_process_finished(zbx_pp_manager_t *manager, zbx_vecto
 					task = pp_manager_queue_dependent_task_result(manager, task);
 					break;
 				case ZBX_PP_TASK_SEQUENCE:
-					task = pp_manager_requeue_next_sequence_task(manager, task);
-					break;
+					pp_manager_requeue_next_sequence_task(manager, task, tasks);
+					continue;
 				default:
 					break;
 			}
@@ -725,6 +729,8 @@ static void	preprocessor_sync_configuration(zbx_pp_manager_t *manager)
  *                                                                            *
  * Parameters: manager    - [IN] preprocessing manager                        *
  *             message    - [IN] packed preprocessing request                 *
+ *             values     - [IN] vector for decoded request values, reused    *
+ *                               between requests                             *
  *             direct_num - [OUT] number of directly flushed values           *
  *             direct_sz  - [OUT] size of directly flushed values             *
  *                                                                            *
@@ -732,9 +738,9 @@ static void	preprocessor_sync_configuration(zbx_pp_manager_t *manager)
  *                                                                            *
  ******************************************************************************/
 static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_message_t *message,
-		zbx_uint64_t *direct_num, zbx_uint64_t *direct_sz, zbx_vector_pp_task_ptr_t *tasks)
+		zbx_vector_pp_value_view_t *values, zbx_uint64_t *direct_num, zbx_uint64_t *direct_sz,
+		zbx_vector_pp_task_ptr_t *tasks)
 {
-	zbx_uint32_t	offset = 0;
 	zbx_uint64_t	queued_num = 0;
 	unsigned char	preprocessing_last = ZBX_ITEM_PREPROCESSING_NONE;
 
@@ -742,56 +748,57 @@ static zbx_uint64_t	preprocessor_add_request(zbx_pp_manager_t *manager, zbx_ipc_
 
 	preprocessor_sync_configuration(manager);
 
-	while (offset < message->size)
+	if (SUCCEED != zbx_pp_values_batch_unpack(message->data, message->size, values))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot unpack preprocessing request: malformed data");
+
+	for (int i = 0; i < values->values_num; i++)
 	{
-		zbx_uint32_t		offset_prev = offset;
-		zbx_uint64_t		sz;
-		zbx_variant_t		var;
-		zbx_pp_value_opt_t	var_opt;
-		zbx_timespec_t		ts;
+		zbx_pp_value_view_t	*view = &values->values[i];
 		zbx_pp_task_t		*task;
 		zbx_pp_item_t		*item;
-		zbx_uint64_t		itemid;
-		unsigned char		value_type, item_flags, preprocessing;
 
-		offset += zbx_preprocessor_deserialize_value(message->data + offset, &itemid, &value_type, &item_flags,
-				&preprocessing, &var, &ts, &var_opt);
+		item = (zbx_pp_item_t *)zbx_hashset_search(&manager->items, &view->itemid);
 
-		sz = offset - offset_prev;
-
-		if (NULL == (task = zbx_pp_manager_create_task(manager, itemid, &var, ts, &var_opt)))
+		if (NULL == (task = zbx_pp_manager_create_task(manager, item, view)))
 		{
+			zbx_variant_t	value = view->value;
+
 			(*direct_num)++;
-			*direct_sz += sz;
+			*direct_sz += view->size;
 			/* allow empty values */
-			preproc_flush_value_func_cb(manager, itemid, value_type, item_flags, &var, ts, &var_opt);
+			preproc_flush_value_func_cb(manager, view->itemid, view->value_type, view->item_flags, &value,
+					view->ts, &view->opt);
 
-			zbx_variant_clear(&var);
-			zbx_pp_value_opt_clear(&var_opt);
+			/* the value strings belong to request, the flush callback can only convert numeric */
+			/* values to strings, which must be freed                                          */
+			if (value.type != view->value.type)
+				zbx_variant_clear(&value);
 		}
 		else
 		{
-			if (preprocessing_last != preprocessing)
+			if (preprocessing_last != view->preprocessing)
 			{
 				if (0 != tasks->values_num)
 				{
-					zbx_pp_manager_queue_value_preproc(manager, tasks, preprocessing);
+					zbx_pp_manager_queue_value_preproc(manager, tasks, view->preprocessing);
 					queued_num += (zbx_uint64_t)tasks->values_num;
 					zbx_vector_pp_task_ptr_clear(tasks);
 				}
-				preprocessing_last = preprocessing;
+				preprocessing_last = view->preprocessing;
 			}
 
 			zbx_vector_pp_task_ptr_append(tasks, task);
 		}
 
-		if (NULL != (item = (zbx_pp_item_t *)zbx_hashset_search(&manager->items, &itemid)))
+		if (NULL != item)
 		{
 			item->preproc->values_num++;
-			item->preproc->values_sz += sz;
+			item->preproc->values_sz += view->size;
 		}
 	}
 
+	zbx_vector_pp_value_view_clear(values);
+
 	if (0 != tasks->values_num)
 		zbx_pp_manager_queue_value_preproc(manager, tasks, preprocessing_last);
 
@@ -1213,6 +1220,7 @@ void	*zbx_pp_manager_thread(void *args)
 	const zbx_thread_pp_manager_args_t	*pp_args = (const zbx_thread_pp_manager_args_t *)unit_args->args.args;
 	zbx_pp_manager_t			*manager;
 	zbx_vector_pp_task_ptr_t		tasks;
+	zbx_vector_pp_value_view_t		values;
 	zbx_uint32_t				rtc_worker_msgs[] = {ZBX_RTC_LOG_LEVEL_INCREASE,
 									ZBX_RTC_LOG_LEVEL_DECREASE};
 	zbx_uint32_t				rtc_manager_msgs[] = {ZBX_RTC_PROF_ENABLE,
@@ -1253,6 +1261,7 @@ void	*zbx_pp_manager_thread(void *args)
 			pp_args->config_timeout, ZBX_IPC_SERVICE_PREPROCESSING);
 
 	zbx_vector_pp_task_ptr_create(&tasks);
+	zbx_vector_pp_value_view_create(&values);
 	zbx_vector_pp_task_ptr_reserve(&tasks, ZBX_PREPROCESSING_BATCH_SIZE);
 
 	/* initialize statistics */
@@ -1304,8 +1313,8 @@ void	*zbx_pp_manager_thread(void *args)
 			{
 				case ZBX_IPC_PREPROCESSOR_REQUEST:
 					direct_sz = 0;
-					queued_once = preprocessor_add_request(manager, message, &direct_num,
-							&direct_sz, &tasks);
+					queued_once = preprocessor_add_request(manager, message, &values,
+							&direct_num, &direct_sz, &tasks);
 					queued_num += queued_once;
 					counter_queued_num += queued_once;
 					counter_queued_sz += (zbx_uint64_t)message->size - direct_sz;
@@ -1444,6 +1453,7 @@ void	*zbx_pp_manager_thread(void *args)
 		zbx_rtc_unsubscribe_service(pp_args->config_timeout, ZBX_IPC_SERVICE_PREPROCESSING);
 
 	zbx_vector_pp_task_ptr_destroy(&tasks);
+	zbx_vector_pp_value_view_destroy(&values);
 	zbx_pp_manager_free(manager);
 
 	zbx_ipc_service_close(&service);
@@ -30,13 +30,13 @@
 #define PACKED_FIELD_RAW	0
 #define PACKED_FIELD_STRING	1
 
+/* pollers flush values in large batches, so the ring must hold several of them */
+#define PP_IPC_RING_SIZE	(4 * ZBX_MEBIBYTE)
+
 #define PACKED_FIELD(value, size)	\
 		(zbx_packed_field_t){(value), (size), (0 == (size) ? PACKED_FIELD_STRING : PACKED_FIELD_RAW)}
 
-static ZBX_THREAD_LOCAL unsigned char	*preproc_data;
-static ZBX_THREAD_LOCAL zbx_uint32_t	preproc_alloc;
-static ZBX_THREAD_LOCAL zbx_uint32_t	preproc_offset;
-static ZBX_THREAD_LOCAL int		preproc_values;
+static ZBX_THREAD_LOCAL zbx_pp_values_batch_t	preproc_batch;
 
 ZBX_PTR_VECTOR_IMPL(ipcmsg, zbx_ipc_message_t *)
 
@@ -133,23 +133,77 @@ static zbx_uint32_t	message_pack_data(zbx_ipc_message_t *message, zbx_packed_fie
 	return data_size;
 }
 
-static void     preprocessor_serialize_value(zbx_uint64_t itemid, unsigned char value_type, unsigned char item_flags,
-		unsigned char preprocessing, AGENT_RESULT *result, zbx_timespec_t *ts, unsigned char state,
-		const char *error)
+ZBX_VECTOR_IMPL(pp_value_view, zbx_pp_value_view_t)
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: frees values batch resources                                      *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_values_batch_destroy(zbx_pp_values_batch_t *batch)
 {
-	zbx_uint32_t	data_len = 0, value_len = 0, source_len = 0;
+	zbx_free(batch->data);
+	batch->data_alloc = 0;
+	batch->data_offset = 0;
+	batch->values_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resets values batch after it has been sent                        *
+ *                                                                            *
+ * Comments: The buffer is kept for the next batch unless it has grown large. *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_values_batch_clear(zbx_pp_values_batch_t *batch)
+{
+	if (ZBX_PP_VALUES_BATCH_KEEP_SIZE < batch->data_alloc)
+		zbx_pp_values_batch_destroy(batch);
+
+	batch->data_offset = 0;
+	batch->values_num = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds value to preprocessing values batch                          *
+ *                                                                            *
+ * Parameters: batch         - [IN/OUT] the values batch                      *
+ *             itemid        - [IN] the item identifier                       *
+ *             value_type    - [IN] the item value type                       *
+ *             item_flags    - [IN] the item flags                            *
+ *             preprocessing - [IN] the preprocessing type                    *
+ *             result        - [IN] the value (optional)                      *
+ *             ts            - [IN] the value timestamp (optional)            *
+ *             state         - [IN] the item state                            *
+ *             error         - [IN] the error message (optional)              *
+ *                                                                            *
+ * Return value: SUCCEED - the value was added                                *
+ *               FAIL    - the batch would exceed 4GB message size limit      *
+ *                                                                            *
+ * Comments: Batch starts with format version and value count followed by    *
+ *           values, each prefixed with its record size.                      *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_pp_values_batch_add(zbx_pp_values_batch_t *batch, zbx_uint64_t itemid, unsigned char value_type,
+		unsigned char item_flags, unsigned char preprocessing, const AGENT_RESULT *result,
+		const zbx_timespec_t *ts, unsigned char state, const char *error)
+{
+	zbx_uint32_t	data_len = 0, record_len, header_len = 0, value_len = 0, source_len = 0, version;
 	unsigned char	var_type = ZBX_VARIANT_NONE, opt_flags = 0;
 	zbx_timespec_t	ts_local;
 	const char	*errmsg = NULL;
+	unsigned char	*ptr;
 
 	if (NULL == ts)
 	{
+		ts_local.sec = ts_local.ns = 0;
 		ts = &ts_local;
-		ts->sec = ts->ns = 0;
 	}
 
-	/* calculate message length */
+	/* calculate record length */
 
+	zbx_serialize_prepare_value(data_len, record_len);
 	zbx_serialize_prepare_value(data_len, itemid);
 	zbx_serialize_prepare_value(data_len, value_type);
 	zbx_serialize_prepare_value(data_len, item_flags);
@@ -231,44 +285,41 @@ static void     preprocessor_serialize_value(zbx_uint64_t itemid, unsigned char
 		zbx_serialize_prepare_value(data_len, result->mtime);
 	}
 
-	if ((zbx_uint64_t)UINT32_MAX < (zbx_uint64_t)preproc_offset + data_len + ZBX_IPC_HEADER_SIZE)
-	{
-		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, preproc_data, preproc_offset, NULL);
-		preproc_offset = 0;
-		preproc_values = 0;
-	}
+	if (0 == batch->data_offset)
+		header_len = ZBX_PP_VALUES_BATCH_HEADER_SIZE;
 
-	if ((zbx_uint64_t)UINT32_MAX < (zbx_uint64_t)preproc_offset + data_len + ZBX_IPC_HEADER_SIZE)
-	{
-		THIS_SHOULD_NEVER_HAPPEN_MSG("Too large data for preprocessing");
-		return;
-	}
+	if ((zbx_uint64_t)UINT32_MAX < (zbx_uint64_t)batch->data_offset + header_len + data_len + ZBX_IPC_HEADER_SIZE)
+		return FAIL;
 
-	if (0 == preproc_alloc)
+	if (batch->data_alloc - batch->data_offset < header_len + data_len)
 	{
-		preproc_alloc = data_len;
-		preproc_data = (unsigned char *)zbx_malloc(NULL, (size_t)preproc_alloc);
-	}
-	else if (preproc_alloc - preproc_offset < data_len)
-	{
-		zbx_uint32_t	old_alloc = preproc_alloc;
+		if (0 == batch->data_alloc)
+			batch->data_alloc = ZBX_PP_VALUES_BATCH_HEADER_SIZE;
 
-		while (preproc_alloc - preproc_offset < data_len)
+		while (batch->data_alloc - batch->data_offset < header_len + data_len)
 		{
-			if ((UINT32_MAX >> 1) > preproc_alloc)
-				preproc_alloc <<= 1;
+			if ((UINT32_MAX >> 1) > batch->data_alloc)
+				batch->data_alloc <<= 1;
 			else
-				preproc_alloc = UINT32_MAX;
+				batch->data_alloc = UINT32_MAX;
 		}
 
-		if (old_alloc < preproc_alloc)
-			preproc_data = (unsigned char *)zbx_realloc(preproc_data, (size_t)preproc_alloc);
+		batch->data = (unsigned char *)zbx_realloc(batch->data, (size_t)batch->data_alloc);
+	}
+
+	if (0 != header_len)
+	{
+		version = ZBX_PP_VALUES_BATCH_VERSION;
+		(void)zbx_serialize_value(batch->data, version);
+		batch->data_offset = header_len;
 	}
 
 	/* serialize */
 
-	unsigned char	*ptr = preproc_data + preproc_offset;
+	ptr = batch->data + batch->data_offset;
+	record_len = data_len;
 
+	ptr += zbx_serialize_value(ptr, record_len);
 	ptr += zbx_serialize_value(ptr, itemid);
 	ptr += zbx_serialize_value(ptr, value_type);
 	ptr += zbx_serialize_value(ptr, item_flags);
@@ -314,76 +365,257 @@ static void     preprocessor_serialize_value(zbx_uint64_t itemid, unsigned char
 		(void)zbx_serialize_value(ptr, result->mtime);
 	}
 
-	preproc_offset += data_len;
+	batch->data_offset += data_len;
+	batch->values_num++;
+
+	/* keep the value count in header up to date so the batch can be sent at any time */
+	(void)zbx_serialize_value(batch->data + sizeof(zbx_uint32_t), batch->values_num);
+
+	return SUCCEED;
 }
 
-static zbx_uint32_t	preprocessor_deserialize_variant(const unsigned char *data, zbx_variant_t *value)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets string stored in batch without copying it                    *
+ *                                                                            *
+ * Parameters: ptr   - [IN/OUT] the serialized string, moved after it         *
+ *             end   - [IN] the end of value record                           *
+ *             value - [OUT] the string, pointing into data (NULL if empty)   *
+ *                                                                            *
+ * Return value: SUCCEED - the string was parsed                              *
+ *               FAIL    - the string does not fit in the record or is not    *
+ *                         zero terminated                                    *
+ *                                                                            *
+ * Comments: Serialized strings include the terminating zero, so they can be  *
+ *           used in place.                                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_values_batch_get_str(unsigned char **ptr, const unsigned char *end, char **value)
 {
-	const unsigned char	*ptr = data;
-	zbx_uint32_t		len;
+	zbx_uint32_t	len;
 
-	ptr += zbx_deserialize_value(ptr, &value->type);
+	if ((size_t)(end - *ptr) < sizeof(zbx_uint32_t))
+		return FAIL;
 
-	switch (value->type)
+	memcpy(&len, *ptr, sizeof(zbx_uint32_t));
+	*ptr += sizeof(zbx_uint32_t);
+
+	if (0 == len)
+	{
+		*value = NULL;
+		return SUCCEED;
+	}
+
+	if ((size_t)(end - *ptr) < len || '\0' != (*ptr)[len - 1])
+		return FAIL;
+
+	*value = (char *)*ptr;
+	*ptr += len;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes value record                                              *
+ *                                                                            *
+ * Parameters: data  - [IN] the value record (without size prefix)            *
+ *             size  - [IN] the value record size (without size prefix)       *
+ *             view  - [OUT] the decoded value                                *
+ *                                                                            *
+ * Return value: SUCCEED - the record was decoded                             *
+ *               FAIL    - the record fields do not match record size or      *
+ *                         contain unsupported value type                     *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_values_batch_get_value(unsigned char *data, zbx_uint32_t size, zbx_pp_value_view_t *view)
+{
+	unsigned char		*ptr = data, opt_flags;
+	const unsigned char	*end = data + size;
+
+	if ((size_t)(end - ptr) < sizeof(view->itemid) + sizeof(view->value_type) + sizeof(view->item_flags) +
+			sizeof(view->preprocessing) + sizeof(view->value.type))
+	{
+		return FAIL;
+	}
+
+	ptr += zbx_deserialize_value(ptr, &view->itemid);
+	ptr += zbx_deserialize_value(ptr, &view->value_type);
+	ptr += zbx_deserialize_value(ptr, &view->item_flags);
+	ptr += zbx_deserialize_value(ptr, &view->preprocessing);
+	ptr += zbx_deserialize_value(ptr, &view->value.type);
+
+	switch (view->value.type)
 	{
 		case ZBX_VARIANT_UI64:
-			ptr += zbx_deserialize_value(ptr, &value->data.ui64);
+			if ((size_t)(end - ptr) < sizeof(view->value.data.ui64))
+				return FAIL;
+
+			ptr += zbx_deserialize_value(ptr, &view->value.data.ui64);
 			break;
 		case ZBX_VARIANT_DBL:
-			ptr += zbx_deserialize_value(ptr, &value->data.dbl);
+			if ((size_t)(end - ptr) < sizeof(view->value.data.dbl))
+				return FAIL;
+
+			ptr += zbx_deserialize_value(ptr, &view->value.data.dbl);
 			break;
 		case ZBX_VARIANT_STR:
-			ptr += zbx_deserialize_str(ptr, &value->data.str, len);
+			if (SUCCEED != pp_values_batch_get_str(&ptr, end, &view->value.data.str) ||
+					NULL == view->value.data.str)
+			{
+				return FAIL;
+			}
 			break;
 		case ZBX_VARIANT_ERR:
-			ptr += zbx_deserialize_str(ptr, &value->data.err, len);
+			if (SUCCEED != pp_values_batch_get_str(&ptr, end, &view->value.data.err) ||
+					NULL == view->value.data.err)
+			{
+				return FAIL;
+			}
 			break;
 		case ZBX_VARIANT_NONE:
 			break;
 		default:
-			THIS_SHOULD_NEVER_HAPPEN_MSG("Unsupported variant type: %s", zbx_variant_type_desc(value));
-			zbx_exit(EXIT_FAILURE);
+			return FAIL;
 	}
 
-	return ptr - data;
+	if ((size_t)(end - ptr) < sizeof(view->ts.sec) + sizeof(view->ts.ns) + sizeof(opt_flags))
+		return FAIL;
+
+	ptr += zbx_deserialize_value(ptr, &view->ts.sec);
+	ptr += zbx_deserialize_value(ptr, &view->ts.ns);
+
+	ptr += zbx_deserialize_value(ptr, &opt_flags);
+	view->opt.flags = opt_flags;
+
+	if (0 != (view->opt.flags & ZBX_PP_VALUE_OPT_LOG))
+	{
+		if (SUCCEED != pp_values_batch_get_str(&ptr, end, &view->opt.source))
+			return FAIL;
+
+		if ((size_t)(end - ptr) < sizeof(view->opt.logeventid) + sizeof(view->opt.severity) +
+				sizeof(view->opt.timestamp))
+		{
+			return FAIL;
+		}
+
+		ptr += zbx_deserialize_value(ptr, &view->opt.logeventid);
+		ptr += zbx_deserialize_value(ptr, &view->opt.severity);
+		ptr += zbx_deserialize_value(ptr, &view->opt.timestamp);
+	}
+	else
+		view->opt.source = NULL;
+
+	if (0 != (view->opt.flags & ZBX_PP_VALUE_OPT_META))
+	{
+		if ((size_t)(end - ptr) < sizeof(view->opt.lastlogsize) + sizeof(view->opt.mtime))
+			return FAIL;
+
+		ptr += zbx_deserialize_value(ptr, &view->opt.lastlogsize);
+		ptr += zbx_deserialize_value(ptr, &view->opt.mtime);
+	}
+
+	/* the record size must match its fields */
+	return end == ptr ? SUCCEED : FAIL;
 }
 
-zbx_uint32_t    zbx_preprocessor_deserialize_value(const unsigned char *data, zbx_uint64_t *itemid,
-		unsigned char *value_type, unsigned char *item_flags, unsigned char *preprocessing,
-		zbx_variant_t *value, zbx_timespec_t *ts, zbx_pp_value_opt_t *opt)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: decodes preprocessing values batch                                *
+ *                                                                            *
+ * Parameters: data   - [IN] the batch data                                   *
+ *             size   - [IN] the batch data size                              *
+ *             values - [OUT] the decoded values                              *
+ *                                                                            *
+ * Return value: SUCCEED - the batch was decoded                              *
+ *               FAIL    - unsupported batch version or malformed batch       *
+ *                                                                            *
+ * Comments: The decoded values reference strings in batch data, so they are  *
+ *           valid only while the data is not freed. Use                      *
+ *           zbx_pp_value_view_copy() to get values owning their data.        *
+ *           The values vector is not cleared, so its memory can be reused    *
+ *           between batches. When malformed record is found the values       *
+ *           decoded before it are left in the vector.                        *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_pp_values_batch_unpack(unsigned char *data, zbx_uint32_t size, zbx_vector_pp_value_view_t *values)
 {
-	const unsigned char	*ptr = data;
-	unsigned char		opt_flags;
+	zbx_uint32_t		version, values_num, record_len, offset;
+	zbx_pp_value_view_t	view;
+	int			values_start = values->values_num;
 
-	ptr += zbx_deserialize_value(ptr, itemid);
-	ptr += zbx_deserialize_value(ptr, value_type);
-	ptr += zbx_deserialize_value(ptr, item_flags);
-	ptr += zbx_deserialize_value(ptr, preprocessing);
+	if (ZBX_PP_VALUES_BATCH_HEADER_SIZE > size)
+		return FAIL;
 
-	ptr += preprocessor_deserialize_variant(ptr, value);
-	ptr += zbx_deserialize_value(ptr, &ts->sec);
-	ptr += zbx_deserialize_value(ptr, &ts->ns);
+	offset = zbx_deserialize_value(data, &version);
 
-	ptr += zbx_deserialize_value(ptr, &opt_flags);
-	opt->flags = opt_flags;
+	if (ZBX_PP_VALUES_BATCH_VERSION != version)
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "unsupported preprocessing values batch version %u", version);
+		return FAIL;
+	}
 
-	if (0 != (opt->flags & ZBX_PP_VALUE_OPT_LOG))
+	offset += zbx_deserialize_value(data + offset, &values_num);
+
+	/* do not trust value count to reserve more than the records could fit */
+	if ((size - offset) / ZBX_PP_VALUES_BATCH_RECORD_MIN < values_num)
+		return FAIL;
+
+	zbx_vector_pp_value_view_reserve(values, (size_t)(values->values_num + (int)values_num));
+
+	while (offset < size)
 	{
-		zbx_uint32_t	len;
+		if (size - offset < sizeof(zbx_uint32_t))
+			return FAIL;
+
+		memcpy(&record_len, data + offset, sizeof(zbx_uint32_t));
+
+		if (record_len <= sizeof(zbx_uint32_t) || size - offset < record_len)
+			return FAIL;
+
+		view.size = record_len;
+
+		if (SUCCEED != pp_values_batch_get_value(data + offset + sizeof(zbx_uint32_t),
+				record_len - (zbx_uint32_t)sizeof(zbx_uint32_t), &view))
+		{
+			return FAIL;
+		}
+
+		zbx_vector_pp_value_view_append_ptr(values, &view);
 
-		ptr += zbx_deserialize_str(ptr, &opt->source, len);
-		ptr += zbx_deserialize_value(ptr, &opt->logeventid);
-		ptr += zbx_deserialize_value(ptr, &opt->severity);
-		ptr += zbx_deserialize_value(ptr, &opt->timestamp);
+		offset += record_len;
 	}
 
-	if (0 != (opt->flags & ZBX_PP_VALUE_OPT_META))
+	return values_num == (zbx_uint32_t)(values->values_num - values_start) ? SUCCEED : FAIL;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: copies decoded value data so it's not referencing batch anymore   *
+ *                                                                            *
+ * Parameters: view  - [IN] the decoded value                                 *
+ *             value - [OUT] the value                                        *
+ *             opt   - [OUT] the optional value data                          *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_pp_value_view_copy(const zbx_pp_value_view_t *view, zbx_variant_t *value, zbx_pp_value_opt_t *opt)
+{
+	switch (view->value.type)
 	{
-		ptr += zbx_deserialize_value(ptr, &opt->lastlogsize);
-		ptr += zbx_deserialize_value(ptr, &opt->mtime);
+		case ZBX_VARIANT_STR:
+			zbx_variant_set_str(value, zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(view->value.data.str)));
+			break;
+		case ZBX_VARIANT_ERR:
+			zbx_variant_set_error(value, zbx_strdup(NULL, ZBX_NULL2EMPTY_STR(view->value.data.err)));
+			break;
+		default:
+			*value = view->value;
 	}
 
-	return ptr - data;
+	*opt = view->opt;
+
+	if (NULL != view->opt.source)
+		opt->source = zbx_strdup(NULL, view->opt.source);
 }
 
 /******************************************************************************
@@ -1059,11 +1291,15 @@ static void	preprocessor_send(zbx_uint32_t code, unsigned char *data, zbx_uint32
 	static zbx_ipc_socket_t	socket = {0};
 
 	/* each process has a permanent connection to preprocessing manager */
-	if (0 == socket.fd && FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN,
-			&error))
+	if (0 == socket.fd)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
-		zbx_exit(EXIT_FAILURE);
+		if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_PREPROCESSING, SEC_PER_MIN, &error))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot connect to preprocessing service: %s", error);
+			zbx_exit(EXIT_FAILURE);
+		}
+
+		zbx_ipc_socket_attach_ring(&socket, PP_IPC_RING_SIZE);
 	}
 
 	if (FAIL == zbx_ipc_socket_write(&socket, code, data, size))
@@ -1141,10 +1377,25 @@ void	zbx_preprocess_item_value(zbx_uint64_t itemid, unsigned char item_value_typ
 
 	if (ZBX_ITEM_PREPROCESSING_NONE != preprocessing)
 	{
-		preprocessor_serialize_value(itemid, item_value_type, item_flags, preprocessing, result, ts, state,
-				error);
+		if (SUCCEED != zbx_pp_values_batch_add(&preproc_batch, itemid, item_value_type, item_flags,
+				preprocessing, result, ts, state, error))
+		{
+			if (0 < preproc_batch.values_num)
+			{
+				preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, preproc_batch.data,
+						preproc_batch.data_offset, NULL);
+				zbx_pp_values_batch_clear(&preproc_batch);
+			}
+
+			if (SUCCEED != zbx_pp_values_batch_add(&preproc_batch, itemid, item_value_type, item_flags,
+					preprocessing, result, ts, state, error))
+			{
+				THIS_SHOULD_NEVER_HAPPEN_MSG("Too large data for preprocessing");
+				goto out;
+			}
+		}
 
-		if (ZBX_PREPROCESSING_BATCH_SIZE < ++preproc_values)
+		if (ZBX_PREPROCESSING_BATCH_SIZE < preproc_batch.values_num)
 			zbx_preprocessor_flush();
 	}
 	else
@@ -1221,13 +1472,10 @@ out:
  ******************************************************************************/
 size_t	zbx_preprocessor_flush(void)
 {
-	if (0 < preproc_offset)
+	if (0 < preproc_batch.values_num)
 	{
-		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, preproc_data, preproc_offset, NULL);
-		preproc_offset = 0;
-		preproc_alloc = 0;
-		preproc_values = 0;
-		zbx_free(preproc_data);
+		preprocessor_send(ZBX_IPC_PREPROCESSOR_REQUEST, preproc_batch.data, preproc_batch.data_offset, NULL);
+		zbx_pp_values_batch_clear(&preproc_batch);
 	}
 
 	return zbx_dc_flush_history();
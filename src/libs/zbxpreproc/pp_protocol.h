@@ -45,6 +45,42 @@
 
 ZBX_PTR_VECTOR_DECL(ipcmsg, zbx_ipc_message_t *)
 
+/* The preprocessing request is a batch of values starting with header containing format */
+/* version and value count. Each value is prefixed with its record size.                 */
+#define ZBX_PP_VALUES_BATCH_VERSION	1
+#define ZBX_PP_VALUES_BATCH_HEADER_SIZE	(sizeof(zbx_uint32_t) * 2)
+
+/* the smallest record - record size, itemid, value/item flags and types, timestamp and option flags */
+#define ZBX_PP_VALUES_BATCH_RECORD_MIN	(sizeof(zbx_uint32_t) + sizeof(zbx_uint64_t) + 4 + sizeof(int) * 2 + 1)
+
+/* larger batch buffers are freed after sending instead of being reused */
+#define ZBX_PP_VALUES_BATCH_KEEP_SIZE	(ZBX_MEBIBYTE)
+
+typedef struct
+{
+	unsigned char	*data;
+	zbx_uint32_t	data_alloc;
+	zbx_uint32_t	data_offset;
+	int		values_num;
+}
+zbx_pp_values_batch_t;
+
+/* value decoded from batch, the string data points into batch */
+typedef struct
+{
+	zbx_uint64_t		itemid;
+	zbx_variant_t		value;
+	zbx_timespec_t		ts;
+	zbx_pp_value_opt_t	opt;
+	zbx_uint32_t		size;
+	unsigned char		value_type;
+	unsigned char		item_flags;
+	unsigned char		preprocessing;
+}
+zbx_pp_value_view_t;
+
+ZBX_VECTOR_DECL(pp_value_view, zbx_pp_value_view_t)
+
 /* packed field data description */
 typedef struct
 {
@@ -93,8 +129,13 @@ void	zbx_preprocessor_unpack_top_stats_result(zbx_vector_pp_top_stats_ptr_t *sta
 
 zbx_uint32_t	zbx_preprocessor_pack_usage_stats(unsigned char **data, const zbx_vector_dbl_t *usage, int count);
 
-zbx_uint32_t    zbx_preprocessor_deserialize_value(const unsigned char *data, zbx_uint64_t *itemid,
-		unsigned char *value_type, unsigned char *item_flags, unsigned char *preprocessing,
-		zbx_variant_t *value, zbx_timespec_t *ts, zbx_pp_value_opt_t *opt);
+int	zbx_pp_values_batch_add(zbx_pp_values_batch_t *batch, zbx_uint64_t itemid, unsigned char value_type,
+		unsigned char item_flags, unsigned char preprocessing, const AGENT_RESULT *result,
+		const zbx_timespec_t *ts, unsigned char state, const char *error);
+void	zbx_pp_values_batch_clear(zbx_pp_values_batch_t *batch);
+void	zbx_pp_values_batch_destroy(zbx_pp_values_batch_t *batch);
+
+int	zbx_pp_values_batch_unpack(unsigned char *data, zbx_uint32_t size, zbx_vector_pp_value_view_t *values);
+void	zbx_pp_value_view_copy(const zbx_pp_value_view_t *view, zbx_variant_t *value, zbx_pp_value_opt_t *opt);
 
 #endif
@@ -399,6 +399,52 @@ zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue)
 	return NULL;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: pop batch of tasks from task queue                                *
+ *                                                                            *
+ * Parameters: queue - [IN] task queue                                        *
+ *             tasks - [OUT] popped tasks                                     *
+ *                                                                            *
+ * Comments: This function is used by workers to pop multiple tasks within    *
+ *           single lock. The batch size is limited by worker share of        *
+ *           pending tasks to keep other workers busy. Leading tasks of       *
+ *           popped sequence tasks are selected for processing in the same   *
+ *           batch.                                                           *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_queue_pop_new_batch(zbx_pp_queue_t *queue, zbx_vector_pp_task_ptr_t *tasks)
+{
+#define PP_TASK_QUEUE_BATCH_MAX	64
+	zbx_uint64_t	batch_num;
+	zbx_pp_task_t	*task;
+
+	batch_num = queue->pending_num / (zbx_uint64_t)MAX(queue->workers_num, 1) + 1;
+
+	if (PP_TASK_QUEUE_BATCH_MAX < batch_num)
+		batch_num = PP_TASK_QUEUE_BATCH_MAX;
+
+	while ((zbx_uint64_t)tasks->values_num < batch_num && NULL != (task = pp_task_queue_pop_new(queue)))
+	{
+		if (ZBX_PP_TASK_SEQUENCE == task->type)
+		{
+			zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task);
+
+			pp_task_sequence_prepare_batch(task);
+
+			/* the first task in sequence was already accounted when popping sequence task */
+			if (1 < d_seq->batch_num)
+			{
+				queue->pending_num -= (zbx_uint64_t)d_seq->batch_num - 1;
+				queue->processing_num += (zbx_uint64_t)d_seq->batch_num - 1;
+			}
+		}
+
+		zbx_vector_pp_task_ptr_append(tasks, task);
+	}
+#undef PP_TASK_QUEUE_BATCH_MAX
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: push finished task into queue                                     *
@@ -413,6 +459,14 @@ void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task)
 	queue->processing_num--;
 	task->state = ZBX_PP_TASK_FINISHED;
 
+	if (ZBX_PP_TASK_SEQUENCE == task->type)
+	{
+		zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task);
+
+		if (1 < d_seq->batch_num)
+			queue->processing_num -= (zbx_uint64_t)d_seq->batch_num - 1;
+	}
+
 	if (ZBX_PP_TASK_VALUE == task->type &&
 			NULL != (item_tasks = (zbx_pp_item_tasks_t *)zbx_hashset_search(&queue->tasks, &task->itemid)))
 	{
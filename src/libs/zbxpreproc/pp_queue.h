@@ -55,6 +55,7 @@ void	pp_task_queue_push_test(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push(zbx_pp_queue_t *queue, zbx_pp_task_t *task, unsigned char preprocessing);
 
 zbx_pp_task_t	*pp_task_queue_pop_new(zbx_pp_queue_t *queue);
+void	pp_task_queue_pop_new_batch(zbx_pp_queue_t *queue, zbx_vector_pp_task_ptr_t *tasks);
 void	pp_task_queue_push_immediate(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 void	pp_task_queue_push_finished(zbx_pp_queue_t *queue, zbx_pp_task_t *task);
 zbx_pp_task_t	*pp_task_queue_pop_finished(zbx_pp_queue_t *queue);
@@ -246,10 +246,35 @@ zbx_pp_task_t	*pp_task_sequence_create(zbx_uint64_t itemid)
 	task->itemid = itemid;
 	task->type = ZBX_PP_TASK_SEQUENCE;
 	zbx_list_create(&d->tasks);
+	d->batch_num = 0;
 
 	return task;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: select leading sequence tasks to be processed by worker          *
+ *                                                                            *
+ * Parameters: task_seq - [IN] sequence task                                  *
+ *                                                                            *
+ * Comments: This function must be called within task queue lock. The        *
+ *           selected tasks are not modified by manager until the sequence    *
+ *           task is finished, so worker can process them without lock.      *
+ *                                                                            *
+ ******************************************************************************/
+void	pp_task_sequence_prepare_batch(zbx_pp_task_t *task_seq)
+{
+	zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task_seq);
+	zbx_list_iterator_t	li;
+
+	d_seq->batch_num = 0;
+
+	zbx_list_iterator_init(&d_seq->tasks, &li);
+
+	while (PP_TASK_SEQUENCE_BATCH_MAX > d_seq->batch_num && SUCCEED == zbx_list_iterator_next(&li))
+		(void)zbx_list_iterator_peek(&li, (void **)&d_seq->batch[d_seq->batch_num++]);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: clear sequence of tasks                                           *
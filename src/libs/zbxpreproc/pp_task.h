@@ -64,9 +64,15 @@ typedef struct
 }
 zbx_pp_task_dependent_t;
 
+#define PP_TASK_SEQUENCE_BATCH_MAX	32
+
 typedef struct
 {
 	zbx_list_t	tasks;
+
+	/* leading tasks of the sequence to be processed by worker in one go */
+	zbx_pp_task_t	*batch[PP_TASK_SEQUENCE_BATCH_MAX];
+	int		batch_num;
 }
 zbx_pp_task_sequence_t;
 
@@ -82,5 +88,6 @@ zbx_pp_task_t	*pp_task_value_seq_create(zbx_uint64_t itemid, zbx_pp_item_preproc
 		zbx_dc_um_shared_handle_t *um_handle, zbx_variant_t *value, zbx_timespec_t ts,
 		const zbx_pp_value_opt_t *value_opt, zbx_pp_cache_t *cache);
 zbx_pp_task_t	*pp_task_sequence_create(zbx_uint64_t itemid);
+void	pp_task_sequence_prepare_batch(zbx_pp_task_t *task_seq);
 
 #endif
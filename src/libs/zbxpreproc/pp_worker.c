@@ -24,10 +24,14 @@
 #include "zbxthreads.h"
 #include "zbxnix.h"
 #include "zbxlog.h"
+#include "zbxtime.h"
 
 #define PP_WORKER_INIT_NONE	0x00
 #define PP_WORKER_INIT_THREAD	0x01
 
+/* the maximum time (seconds) processed tasks can be held by worker before being returned to manager */
+#define PP_WORKER_FLUSH_TIME	0.01
+
 /******************************************************************************
  *                                                                            *
  * Purpose: process preprocessing testing task                                *
@@ -69,16 +73,19 @@ static void	pp_task_process_dependent(zbx_pp_context_t *ctx, zbx_pp_task_t *task
 
 /******************************************************************************
  *                                                                            *
- * Purpose: process first task in sequence task                               *
+ * Purpose: process leading tasks selected from sequence task                 *
  *                                                                            *
  ******************************************************************************/
-static	void	pp_task_process_sequence(zbx_pp_context_t *ctx, zbx_pp_task_t *task_seq, const char *config_source_ip)
+static	void	pp_task_process_sequence(zbx_pp_worker_t *worker, zbx_pp_task_t *task_seq)
 {
 	zbx_pp_task_sequence_t	*d_seq = (zbx_pp_task_sequence_t *)PP_TASK_DATA(task_seq);
-	zbx_pp_task_t		*task;
+	zbx_pp_context_t	*ctx = &worker->execute_ctx;
+	const char		*config_source_ip = worker->config_source_ip;
 
-	if (SUCCEED == zbx_list_peek(&d_seq->tasks, (void **)&task))
+	for (int i = 0; i < d_seq->batch_num; i++)
 	{
+		zbx_pp_task_t	*task = d_seq->batch[i];
+
 		switch (task->type)
 		{
 			case ZBX_PP_TASK_VALUE:
@@ -92,7 +99,175 @@ static	void	pp_task_process_sequence(zbx_pp_context_t *ctx, zbx_pp_task_t *task_
 				THIS_SHOULD_NEVER_HAPPEN;
 				break;
 		}
+
+		task->time_ms = zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
+		task_seq->time_ms += task->time_ms;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process task popped from task queue                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_task_process(zbx_pp_worker_t *worker, zbx_pp_task_t *task)
+{
+	zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__, task->type,
+			task->itemid);
+
+	switch (task->type)
+	{
+		case ZBX_PP_TASK_TEST:
+			pp_task_process_test(&worker->execute_ctx, task, worker->config_source_ip);
+			break;
+		case ZBX_PP_TASK_VALUE:
+		case ZBX_PP_TASK_VALUE_SEQ:
+			pp_task_process_value(&worker->execute_ctx, task, worker->config_source_ip);
+			break;
+		case ZBX_PP_TASK_DEPENDENT:
+			pp_task_process_dependent(&worker->execute_ctx, task, worker->config_source_ip);
+			break;
+		case ZBX_PP_TASK_SEQUENCE:
+			task->time_ms = 0;
+			pp_task_process_sequence(worker, task);
+			return;
+	}
+
+	task->time_ms = zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: return processed tasks to manager                                 *
+ *                                                                            *
+ * Parameters: worker - [IN]                                                  *
+ *             tasks  - [IN] popped tasks                                     *
+ *             from   - [IN] the first processed task to return               *
+ *             to     - [IN] the task after the last processed task to return *
+ *                                                                            *
+ * Comments: This function must be called within task queue lock.             *
+ *                                                                            *
+ ******************************************************************************/
+static void	pp_worker_finish_tasks(zbx_pp_worker_t *worker, const zbx_vector_pp_task_ptr_t *tasks, int from,
+		int to)
+{
+	for (int i = from; i < to; i++)
+		pp_task_queue_push_finished(worker->queue, tasks->values[i]);
+
+	if (NULL != worker->pp_finished_task_cb)
+		worker->pp_finished_task_cb(worker->pp_finished_task_data);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if item preprocessing consists only of steps with cost      *
+ *          linear to value size                                              *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_preproc_is_cheap(const zbx_pp_item_preproc_t *preproc)
+{
+	for (int i = 0; i < preproc->steps_num; i++)
+	{
+		switch (preproc->steps[i].type)
+		{
+			case ZBX_PREPROC_MULTIPLIER:
+			case ZBX_PREPROC_RTRIM:
+			case ZBX_PREPROC_LTRIM:
+			case ZBX_PREPROC_TRIM:
+			case ZBX_PREPROC_BOOL2DEC:
+			case ZBX_PREPROC_OCT2DEC:
+			case ZBX_PREPROC_HEX2DEC:
+			case ZBX_PREPROC_DELTA_VALUE:
+			case ZBX_PREPROC_DELTA_SPEED:
+			case ZBX_PREPROC_VALIDATE_RANGE:
+			case ZBX_PREPROC_THROTTLE_VALUE:
+			case ZBX_PREPROC_THROTTLE_TIMED_VALUE:
+			case ZBX_PREPROC_STR_REPLACE:
+			case ZBX_PREPROC_VALIDATE_NOT_SUPPORTED:
+				continue;
+			default:
+				return FAIL;
+		}
+	}
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: check if task is known to be processed quickly                    *
+ *                                                                            *
+ * Return value: SUCCEED - the task has only cheap preprocessing steps        *
+ *               FAIL    - the task can take arbitrary time (scripts,         *
+ *                         parsing of structured data, testing requests)      *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_task_is_cheap(const zbx_pp_task_t *task)
+{
+	const zbx_pp_task_sequence_t	*d_seq;
+
+	switch (task->type)
+	{
+		case ZBX_PP_TASK_VALUE:
+		case ZBX_PP_TASK_VALUE_SEQ:
+			return pp_preproc_is_cheap(((const zbx_pp_task_value_t *)PP_TASK_DATA(task))->preproc);
+		case ZBX_PP_TASK_DEPENDENT:
+			return pp_task_is_cheap(((const zbx_pp_task_dependent_t *)PP_TASK_DATA(task))->primary);
+		case ZBX_PP_TASK_SEQUENCE:
+			d_seq = (const zbx_pp_task_sequence_t *)PP_TASK_DATA(task);
+
+			for (int i = 0; i < d_seq->batch_num; i++)
+			{
+				if (SUCCEED != pp_task_is_cheap(d_seq->batch[i]))
+					return FAIL;
+			}
+
+			return SUCCEED;
+		default:
+			return FAIL;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: process popped tasks                                              *
+ *                                                                            *
+ * Parameters: worker - [IN]                                                  *
+ *             tasks  - [IN] popped tasks                                     *
+ *                                                                            *
+ * Return value: The number of leading tasks already returned to manager.     *
+ *                                                                            *
+ * Comments: Before starting the next task the processed tasks are returned   *
+ *           to manager if the next task is not known to be cheap or if they  *
+ *           have been held for PP_WORKER_FLUSH_TIME, so slow tasks in batch  *
+ *           do not delay results of the tasks processed before them.         *
+ *                                                                            *
+ ******************************************************************************/
+static int	pp_worker_process_tasks(zbx_pp_worker_t *worker, const zbx_vector_pp_task_ptr_t *tasks)
+{
+	int	finished_num = 0;
+	double	time_held = 0;
+
+	for (int i = 0; i < tasks->values_num; i++)
+	{
+		if (i > finished_num && (SUCCEED != pp_task_is_cheap(tasks->values[i]) ||
+				PP_WORKER_FLUSH_TIME <= zbx_time() - time_held))
+		{
+			pp_task_queue_lock(worker->queue);
+			pp_worker_finish_tasks(worker, tasks, finished_num, i);
+			pp_task_queue_unlock(worker->queue);
+
+			finished_num = i;
+		}
+
+		pp_task_process(worker, tasks->values[i]);
+
+		/* remember when the oldest of the held tasks was processed */
+		if (i == finished_num)
+			time_held = zbx_time();
 	}
+
+	return finished_num;
 }
 
 /******************************************************************************
@@ -103,10 +278,10 @@ static	void	pp_task_process_sequence(zbx_pp_context_t *ctx, zbx_pp_task_t *task_
 static void	*pp_worker_entry(void *args)
 {
 	zbx_pp_worker_t		*worker = (zbx_pp_worker_t *)args;
-	zbx_pp_queue_t		*queue = worker->queue;
-	zbx_pp_task_t		*in;
-	char			*error = NULL, component[ZBX_LOG_COMPONENT_NAME_LEN];
-	sigjmp_buf		jmp_ret;
+	zbx_pp_queue_t			*queue = worker->queue;
+	char				*error = NULL, component[ZBX_LOG_COMPONENT_NAME_LEN];
+	sigjmp_buf			jmp_ret;
+	zbx_vector_pp_task_ptr_t	tasks;
 
 	zbx_snprintf(component, sizeof(component), "preprocessing worker #%d", worker->id);
 	zbx_set_log_component(component, &worker->logger);
@@ -119,44 +294,28 @@ static void	*pp_worker_entry(void *args)
 	worker->stop = 0;
 
 	pp_context_init(&worker->execute_ctx);
+	zbx_vector_pp_task_ptr_create(&tasks);
+
 	pp_task_queue_lock(queue);
 	pp_task_queue_register_worker(queue);
 
 	while (0 == worker->stop)
 	{
-		if (NULL != (in = pp_task_queue_pop_new(queue)))
+		pp_task_queue_pop_new_batch(queue, &tasks);
+
+		if (0 != tasks.values_num)
 		{
+			int	finished_num;
+
 			pp_task_queue_unlock(queue);
 
 			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_BUSY);
-
-			zabbix_log(LOG_LEVEL_TRACE, "%s() process task type:%u itemid:" ZBX_FS_UI64, __func__,
-					in->type, in->itemid);
-
-			switch (in->type)
-			{
-				case ZBX_PP_TASK_TEST:
-					pp_task_process_test(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_VALUE:
-				case ZBX_PP_TASK_VALUE_SEQ:
-					pp_task_process_value(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_DEPENDENT:
-					pp_task_process_dependent(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-				case ZBX_PP_TASK_SEQUENCE:
-					pp_task_process_sequence(&worker->execute_ctx, in, worker->config_source_ip);
-					break;
-			}
-
-			in->time_ms = zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
+			finished_num = pp_worker_process_tasks(worker, &tasks);
+			zbx_timekeeper_update(worker->timekeeper, worker->id - 1, ZBX_PROCESS_STATE_IDLE);
 
 			pp_task_queue_lock(queue);
-			pp_task_queue_push_finished(queue, in);
-
-			if (NULL != worker->pp_finished_task_cb)
-				worker->pp_finished_task_cb(worker->pp_finished_task_data);
+			pp_worker_finish_tasks(worker, &tasks, finished_num, tasks.values_num);
+			zbx_vector_pp_task_ptr_clear(&tasks);
 
 			continue;
 		}
@@ -176,6 +335,8 @@ static void	*pp_worker_entry(void *args)
 
 	pp_task_queue_deregister_worker(queue);
 	pp_task_queue_unlock(queue);
+
+	zbx_vector_pp_task_ptr_destroy(&tasks);
 	zbx_deinit_regexp_env();
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "thread stopped");
@@ -1621,6 +1621,77 @@ static void	prometheus_filter_rows(zbx_vector_prometheus_row_t *rows, zbx_promet
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s() rows:%d", __func__, rows_out->values_num);
 }
 
+static zbx_hash_t	prometheus_index_hash_func(const void *d)
+{
+	const zbx_prometheus_index_t	*index = (const zbx_prometheus_index_t *)d;
+
+	return ZBX_DEFAULT_STRING_HASH_FUNC(index->value);
+}
+
+static int	prometheus_index_compare_func(const void *d1, const void *d2)
+{
+	const zbx_prometheus_index_t	*i1 = (const zbx_prometheus_index_t *)d1;
+	const zbx_prometheus_index_t	*i2 = (const zbx_prometheus_index_t *)d2;
+
+	return strcmp(i1->value, i2->value);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: adds row to the index                                             *
+ *                                                                            *
+ * Parameters: index - [IN/OUT] the index                                     *
+ *             value - [IN] the indexed value, must be valid as long as the   *
+ *                          index is used                                     *
+ *             row   - [IN] the row                                           *
+ *                                                                            *
+ ******************************************************************************/
+static void	prometheus_index_add_row(zbx_hashset_t *index, char *value, zbx_prometheus_row_t *row)
+{
+	zbx_prometheus_index_t	*entry, entry_local;
+
+	entry_local.value = value;
+
+	if (NULL == (entry = (zbx_prometheus_index_t *)zbx_hashset_search(index, &entry_local)))
+	{
+		entry = (zbx_prometheus_index_t *)zbx_hashset_insert(index, &entry_local, sizeof(entry_local));
+		zbx_vector_prometheus_row_create(&entry->rows);
+	}
+
+	zbx_vector_prometheus_row_append(&entry->rows, row);
+}
+
+static void	prometheus_index_clear(zbx_hashset_t *index)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_prometheus_index_t	*entry;
+
+	zbx_hashset_iter_reset(index, &iter);
+	while (NULL != (entry = (zbx_prometheus_index_t *)zbx_hashset_iter_next(&iter)))
+		zbx_vector_prometheus_row_destroy(&entry->rows);
+
+	zbx_hashset_destroy(index);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: indexes parsed rows by metric name                                *
+ *                                                                            *
+ * Parameters: prom - [IN/OUT] the prometheus cache                           *
+ *                                                                            *
+ * Comments: Most filters select rows by metric name. The index is created    *
+ *           once when the data is parsed, so every filter can get its rows   *
+ *           with a hash lookup instead of scanning all rows.                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	prometheus_index_metrics(zbx_prometheus_t *prom)
+{
+	int	i;
+
+	for (i = 0; i < prom->rows.values_num; i++)
+		prometheus_index_add_row(&prom->metrics, prom->rows.values[i]->metric, prom->rows.values[i]);
+}
+
 static void	prometheus_hint_clear(void *d)
 {
 	zbx_prometheus_hint_t	*hint = (zbx_prometheus_hint_t *)d;
@@ -1648,6 +1719,7 @@ int	zbx_prometheus_init(zbx_prometheus_t *prom, const char *data, char **error)
 	int			ret = FAIL;
 
 	zbx_vector_prometheus_row_create(&prom->rows);
+	zbx_hashset_create(&prom->metrics, 0, prometheus_index_hash_func, prometheus_index_compare_func);
 	zbx_vector_prometheus_label_index_create(&prom->indexes);
 
 	zbx_hashset_create_ext(&prom->hints, 100, prometheus_hint_hash, prometheus_hint_compare, prometheus_hint_clear,
@@ -1665,6 +1737,8 @@ int	zbx_prometheus_init(zbx_prometheus_t *prom, const char *data, char **error)
 	if (FAIL == prometheus_parse_rows(&filter, data, &prom->rows, &prom->hints, error))
 		goto out;
 
+	prometheus_index_metrics(prom);
+
 	ret = SUCCEED;
 out:
 	prometheus_filter_clear(&filter);
@@ -1677,16 +1751,8 @@ out:
 
 static void	prometheus_label_index_free(zbx_prometheus_label_index_t *label_index)
 {
-	zbx_hashset_iter_t	iter;
-	zbx_prometheus_index_t	*index;
-
 	zbx_free(label_index->label);
-
-	zbx_hashset_iter_reset(&label_index->index, &iter);
-	while (NULL != (index = (zbx_prometheus_index_t *)zbx_hashset_iter_next(&iter)))
-		zbx_vector_prometheus_row_destroy(&index->rows);
-
-	zbx_hashset_destroy(&label_index->index);
+	prometheus_index_clear(&label_index->index);
 	zbx_free(label_index);
 }
 
@@ -1704,6 +1770,8 @@ void	zbx_prometheus_clear(zbx_prometheus_t *prom)
 	zbx_vector_prometheus_label_index_clear_ext(&prom->indexes, prometheus_label_index_free);
 	zbx_vector_prometheus_label_index_destroy(&prom->indexes);
 
+	prometheus_index_clear(&prom->metrics);
+
 	zbx_vector_prometheus_row_clear_ext(&prom->rows, prometheus_row_free);
 	zbx_vector_prometheus_row_destroy(&prom->rows);
 
@@ -1764,21 +1832,6 @@ static void	prometheus_add_index(zbx_prometheus_t *prom, zbx_prometheus_label_in
 	prometheus_unlock(prom);
 }
 
-static zbx_hash_t	prometheus_index_hash_func(const void *d)
-{
-	const zbx_prometheus_index_t	*index = (const zbx_prometheus_index_t *)d;
-
-	return ZBX_DEFAULT_STRING_HASH_FUNC(index->value);
-}
-
-static int	prometheus_index_compare_func(const void *d1, const void *d2)
-{
-	const zbx_prometheus_index_t	*i1 = (const zbx_prometheus_index_t *)d1;
-	const zbx_prometheus_index_t	*i2 = (const zbx_prometheus_index_t *)d2;
-
-	return strcmp(i1->value, i2->value);
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: get label from row by the specified name                          *
@@ -1857,17 +1910,7 @@ static int	prometheus_get_indexed_rows_by_label(zbx_prometheus_t *prom, zbx_prom
 			if (NULL == (label = prometheus_get_row_label(row, label_index->label)))
 				continue;
 
-			index_local.value = label->value;
-
-			if (NULL == (index = (zbx_prometheus_index_t *)zbx_hashset_search(&label_index->index,
-					&index_local)))
-			{
-				index = (zbx_prometheus_index_t *)zbx_hashset_insert(&label_index->index, &index_local,
-						sizeof(index_local));
-				zbx_vector_prometheus_row_create(&index->rows);
-			}
-
-			zbx_vector_prometheus_row_append(&index->rows, row);
+			prometheus_index_add_row(&label_index->index, label->value, row);
 		}
 
 		prometheus_add_index(prom, label_index);
@@ -1883,6 +1926,43 @@ static int	prometheus_get_indexed_rows_by_label(zbx_prometheus_t *prom, zbx_prom
 	return SUCCEED;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get rows that must be checked by the filter                       *
+ *                                                                            *
+ * Parameters: prom   - [IN] the prometheus cache                             *
+ *             filter - [IN] the filter                                       *
+ *                                                                            *
+ * Return value: The candidate rows or NULL if there are no matching rows.    *
+ *                                                                            *
+ * Comments: Rows are looked up in the metric name index if the filter        *
+ *           matches exact metric name, otherwise in the label index if the   *
+ *           filter has 'label equals' condition. All rows are returned if    *
+ *           the filter cannot be indexed.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static zbx_vector_prometheus_row_t	*prometheus_get_filter_rows(zbx_prometheus_t *prom,
+		zbx_prometheus_filter_t *filter)
+{
+	zbx_vector_prometheus_row_t	*rows;
+	zbx_prometheus_index_t		*index, index_local;
+
+	if (NULL != filter->metric && ZBX_PROMETHEUS_CONDITION_OP_EQUAL == filter->metric->op)
+	{
+		index_local.value = filter->metric->pattern;
+
+		if (NULL == (index = (zbx_prometheus_index_t *)zbx_hashset_search(&prom->metrics, &index_local)))
+			return NULL;
+
+		return &index->rows;
+	}
+
+	if (SUCCEED != prometheus_get_indexed_rows_by_label(prom, filter, &rows))
+		rows = &prom->rows;
+
+	return rows;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: validate prometheus pattern request and output                    *
@@ -1953,10 +2033,7 @@ int	zbx_prometheus_pattern_ex(zbx_prometheus_t *prom, const char *filter_data, c
 	if (SUCCEED != prometheus_validate_request(request, output, error))
 		goto cleanup;
 
-	if (SUCCEED != prometheus_get_indexed_rows_by_label(prom, &filter, &prows))
-		prows = &prom->rows;
-
-	if (NULL != prows)
+	if (NULL != (prows = prometheus_get_filter_rows(prom, &filter)))
 		prometheus_filter_rows(prows, &filter, &rows);
 
 	if (FAIL == (ret = prometheus_query_rows(&rows, request, output, value, &errmsg)))
@@ -2127,10 +2204,7 @@ int	zbx_prometheus_to_json_ex(zbx_prometheus_t *prom, const char *filter_data, c
 
 	zbx_vector_prometheus_row_create(&rows);
 
-	if (SUCCEED != prometheus_get_indexed_rows_by_label(prom, &filter, &prows))
-		prows = &prom->rows;
-
-	if (NULL != prows)
+	if (NULL != (prows = prometheus_get_filter_rows(prom, &filter)))
 		prometheus_filter_rows(prows, &filter, &rows);
 
 	prometheus_to_json(&rows, &prom->hints, value);
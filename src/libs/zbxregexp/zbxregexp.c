@@ -24,6 +24,7 @@ struct zbx_regexp
 {
 	pcre2_code		*pcre2_regexp;
 	pcre2_match_context	*match_ctx;
+	unsigned char		jit;	/* 1 if the regexp was compiled by JIT compiler */
 };
 
 typedef struct
@@ -49,8 +50,35 @@ zbx_match_t;
 ZBX_PTR_VECTOR_DECL(match, zbx_match_t *)
 ZBX_PTR_VECTOR_IMPL(match, zbx_match_t *)
 
-static ZBX_THREAD_LOCAL zbx_regexp_t	*curr_regexp = NULL;
-static ZBX_THREAD_LOCAL char		*curr_pattern = NULL;
+/* compiled regular expression cache entry */
+typedef struct regexp_cache_entry
+{
+	char				*pattern;
+	uint32_t			flags;
+	zbx_regexp_t			*regexp;
+
+	/* least recently used list, the most recently used entry is the first */
+	struct regexp_cache_entry	*prev;
+	struct regexp_cache_entry	*next;
+}
+regexp_cache_entry_t;
+
+typedef struct
+{
+	zbx_hashset_t		entries;
+	regexp_cache_entry_t	*head;
+	regexp_cache_entry_t	*tail;
+}
+regexp_cache_t;
+
+#define REGEXP_CACHE_SIZE	64
+
+/* JIT stack is allocated when needed up to the maximum size */
+#define REGEXP_JIT_STACK_START	(32 * ZBX_KIBIBYTE)
+#define REGEXP_JIT_STACK_MAX	(512 * ZBX_KIBIBYTE)
+
+static ZBX_THREAD_LOCAL regexp_cache_t		*regexp_cache = NULL;
+static ZBX_THREAD_LOCAL pcre2_jit_stack		*regexp_jit_stack = NULL;
 
 #ifdef HAVE_PCRE2_H
 static void	zbx_match_free(zbx_match_t *match)
@@ -148,6 +176,7 @@ static int	regexp_compile(const char *pattern, uint32_t flags, zbx_regexp_t **re
 		*regexp = (zbx_regexp_t *)zbx_malloc(NULL, sizeof(zbx_regexp_t));
 		(*regexp)->pcre2_regexp = pcre2_regexp;
 		(*regexp)->match_ctx = match_ctx;
+		(*regexp)->jit = 0;
 	}
 	else
 		pcre2_code_free(pcre2_regexp);
@@ -201,39 +230,218 @@ int	zbx_regexp_compile_ext(const char *pattern, zbx_regexp_t **regexp,
 	return regexp_compile(pattern, flags, regexp, err_msg);
 }
 
-/****************************************************************************************************
- *                                                                                                  *
- * Purpose: wrapper for zbx_regexp_compile. Caches and reuses the last used regexp.                 *
- *                                                                                                  *
- ****************************************************************************************************/
+/******************************************************************************
+ *                                                                            *
+ * Purpose: compiles regular expression into machine code                     *
+ *                                                                            *
+ * Parameters: regexp - [IN/OUT] compiled regular expression                  *
+ *                                                                            *
+ * Comments: The machine code is matched using JIT stack of the calling       *
+ *           thread, so the regexp must not be used by other threads.         *
+ *           If JIT compilation is not supported the regexp is interpreted.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	regexp_jit_compile(zbx_regexp_t *regexp)
+{
+	if (0 != pcre2_jit_compile(regexp->pcre2_regexp, PCRE2_JIT_COMPLETE))
+		return;
+
+	regexp->jit = 1;
+
+	if (NULL == regexp_jit_stack && NULL == (regexp_jit_stack = pcre2_jit_stack_create(REGEXP_JIT_STACK_START,
+			REGEXP_JIT_STACK_MAX, NULL)))
+	{
+		/* the default 32KB JIT stack on machine stack is used */
+		return;
+	}
+
+	pcre2_jit_stack_assign(regexp->match_ctx, NULL, regexp_jit_stack);
+}
+
+static zbx_hash_t	regexp_cache_entry_hash(const void *data)
+{
+	const regexp_cache_entry_t	*entry = (const regexp_cache_entry_t *)data;
+	zbx_hash_t			hash;
+
+	hash = ZBX_DEFAULT_STRING_HASH_FUNC(entry->pattern);
+
+	return ZBX_DEFAULT_UINT64_HASH_ALGO(&entry->flags, sizeof(entry->flags), hash);
+}
+
+static int	regexp_cache_entry_compare(const void *d1, const void *d2)
+{
+	const regexp_cache_entry_t	*e1 = (const regexp_cache_entry_t *)d1;
+	const regexp_cache_entry_t	*e2 = (const regexp_cache_entry_t *)d2;
+
+	ZBX_RETURN_IF_NOT_EQUAL(e1->flags, e2->flags);
+
+	return strcmp(e1->pattern, e2->pattern);
+}
+
+static void	regexp_cache_entry_clear(void *data)
+{
+	regexp_cache_entry_t	*entry = (regexp_cache_entry_t *)data;
+
+	zbx_regexp_free(entry->regexp);
+	zbx_free(entry->pattern);
+}
+
+static void	regexp_cache_unlink(regexp_cache_entry_t *entry)
+{
+	if (NULL != entry->prev)
+		entry->prev->next = entry->next;
+	else
+		regexp_cache->head = entry->next;
+
+	if (NULL != entry->next)
+		entry->next->prev = entry->prev;
+	else
+		regexp_cache->tail = entry->prev;
+}
+
+static void	regexp_cache_link_head(regexp_cache_entry_t *entry)
+{
+	entry->prev = NULL;
+
+	if (NULL != (entry->next = regexp_cache->head))
+		regexp_cache->head->prev = entry;
+	else
+		regexp_cache->tail = entry;
+
+	regexp_cache->head = entry;
+}
+
+static void	regexp_cache_destroy(void)
+{
+	if (NULL == regexp_cache)
+		return;
+
+	zbx_hashset_destroy(&regexp_cache->entries);
+	zbx_free(regexp_cache);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets compiled regular expression from the cache of the calling    *
+ *          thread, compiles and caches it if necessary                       *
+ *                                                                            *
+ * Parameters: pattern - [IN] regular expression                              *
+ *             flags   - [IN] option bitmask as passed to pcre2_compile       *
+ *             regexp  - [OUT] compiled regular expression, owned by cache    *
+ *             err_msg - [OUT] dynamically allocated error message            *
+ *                                                                            *
+ * Return value: SUCCEED or FAIL                                              *
+ *                                                                            *
+ * Comments: The least recently used regexp is freed when the cache is full,  *
+ *           so the returned regexp is valid only until the next regexp cache *
+ *           access by the calling thread.                                    *
+ *                                                                            *
+ ******************************************************************************/
 static int	regexp_prepare(const char *pattern, uint32_t flags, zbx_regexp_t **regexp, char **err_msg)
 {
-	static ZBX_THREAD_LOCAL uint32_t	curr_flags = 0;
-	int					ret = SUCCEED;
+	regexp_cache_entry_t	entry_local, *entry;
 
-	if (NULL == curr_regexp || 0 != strcmp(curr_pattern, pattern) || curr_flags != flags)
+	if (NULL == regexp_cache)
 	{
-		if (NULL != curr_regexp)
-		{
-			zbx_regexp_free(curr_regexp);
-			zbx_free(curr_pattern);
-		}
+		regexp_cache = (regexp_cache_t *)zbx_malloc(NULL, sizeof(regexp_cache_t));
+		zbx_hashset_create_ext(&regexp_cache->entries, REGEXP_CACHE_SIZE, regexp_cache_entry_hash,
+				regexp_cache_entry_compare, regexp_cache_entry_clear, ZBX_DEFAULT_MEM_MALLOC_FUNC,
+				ZBX_DEFAULT_MEM_REALLOC_FUNC, ZBX_DEFAULT_MEM_FREE_FUNC);
+		regexp_cache->head = NULL;
+		regexp_cache->tail = NULL;
+	}
 
-		curr_regexp = NULL;
-		curr_pattern = NULL;
-		curr_flags = 0;
+	entry_local.pattern = (char *)(uintptr_t)pattern;
+	entry_local.flags = flags;
 
-		if (SUCCEED == regexp_compile(pattern, flags, &curr_regexp, err_msg))
+	if (NULL != (entry = (regexp_cache_entry_t *)zbx_hashset_search(&regexp_cache->entries, &entry_local)))
+	{
+		if (entry != regexp_cache->head)
 		{
-			curr_pattern = zbx_strdup(curr_pattern, pattern);
-			curr_flags = flags;
+			regexp_cache_unlink(entry);
+			regexp_cache_link_head(entry);
 		}
-		else
-			ret = FAIL;
+
+		*regexp = entry->regexp;
+
+		return SUCCEED;
 	}
 
-	*regexp = curr_regexp;
-	return ret;
+	if (SUCCEED != regexp_compile(pattern, flags, &entry_local.regexp, err_msg))
+		return FAIL;
+
+	regexp_jit_compile(entry_local.regexp);
+
+	if (REGEXP_CACHE_SIZE <= regexp_cache->entries.num_data)
+	{
+		entry = regexp_cache->tail;
+		regexp_cache_unlink(entry);
+		zbx_hashset_remove_direct(&regexp_cache->entries, entry);
+	}
+
+	entry_local.pattern = zbx_strdup(NULL, pattern);
+	entry = (regexp_cache_entry_t *)zbx_hashset_insert(&regexp_cache->entries, &entry_local, sizeof(entry_local));
+	regexp_cache_link_head(entry);
+
+	*regexp = entry->regexp;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets regular expression compiled with default options from the    *
+ *          cache of the calling thread                                       *
+ *                                                                            *
+ * Parameters: pattern - [IN] regular expression                              *
+ *             regexp  - [OUT] compiled regular expression, owned by cache    *
+ *             err_msg - [OUT] dynamically allocated error message            *
+ *                                                                            *
+ * Return value: SUCCEED or FAIL                                              *
+ *                                                                            *
+ * Comments: Use this function instead of zbx_regexp_compile() when the       *
+ *           same patterns are matched repeatedly, but cannot be kept         *
+ *           compiled by the caller. The regexp must not be freed and is      *
+ *           valid only until the next regular expression function call by    *
+ *           the calling thread.                                              *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_compile_cached(const char *pattern, const zbx_regexp_t **regexp, char **err_msg)
+{
+	uint32_t	flags = PCRE2_MULTILINE;
+
+#ifdef PCRE2_NO_AUTO_CAPTURE
+	flags |= PCRE2_NO_AUTO_CAPTURE;
+#endif
+	return zbx_regexp_compile_ext_cached(pattern, regexp, flags, err_msg);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets regular expression compiled with specified options from the  *
+ *          cache of the calling thread                                       *
+ *                                                                            *
+ * Parameters: pattern - [IN] regular expression                              *
+ *             regexp  - [OUT] compiled regular expression, owned by cache    *
+ *             flags   - [IN] option bitmask as passed to pcre2_compile       *
+ *             err_msg - [OUT] dynamically allocated error message            *
+ *                                                                            *
+ * Return value: SUCCEED or FAIL                                              *
+ *                                                                            *
+ * Comments: See zbx_regexp_compile_cached().                                 *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_regexp_compile_ext_cached(const char *pattern, const zbx_regexp_t **regexp, zbx_uint32_t flags,
+		char **err_msg)
+{
+	zbx_regexp_t	*rxp;
+
+	if (SUCCEED != regexp_prepare(pattern, flags, &rxp, err_msg))
+		return FAIL;
+
+	*regexp = rxp;
+
+	return SUCCEED;
 }
 
 /* calculate recursion limit, PCRE man page suggests to reckon on about 500 bytes per recursion */
@@ -259,10 +467,12 @@ void	zbx_init_regexp_env(void)
 
 void	zbx_deinit_regexp_env(void)
 {
-	if (NULL != curr_regexp)
+	regexp_cache_destroy();
+
+	if (NULL != regexp_jit_stack)
 	{
-		zbx_regexp_free(curr_regexp);
-		zbx_free(curr_pattern);
+		pcre2_jit_stack_free(regexp_jit_stack);
+		regexp_jit_stack = NULL;
 	}
 }
 
@@ -382,8 +592,17 @@ static int	regexp_exec(const char *string, const zbx_regexp_t *regexp, int flags
 		flags |= PCRE2_NO_UTF_CHECK;
 #endif
 
-		if (0 <= (r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset,
-			flags, match_data, regexp->match_ctx)))
+		r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset, flags,
+				match_data, regexp->match_ctx);
+
+		/* interpreter uses heap for backtracking and is limited only by recursion limit */
+		if (PCRE2_ERROR_JIT_STACKLIMIT == r && 0 != regexp->jit)
+		{
+			r = pcre2_match(regexp->pcre2_regexp, (PCRE2_SPTR)string, PCRE2_ZERO_TERMINATED, offset,
+					flags | PCRE2_NO_JIT, match_data, regexp->match_ctx);
+		}
+
+		if (0 <= r)
 		{
 			if (NULL != matches)
 			{
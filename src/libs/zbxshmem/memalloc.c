@@ -103,6 +103,8 @@ static void	*__mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
 static void	*__mem_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size);
 static void	__mem_free(zbx_shmem_info_t *info, void *ptr);
 
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size);
+
 #define SHMEM_SIZE_FIELD	sizeof(zbx_uint64_t)
 
 #define SHMEM_FLG_USED		((__UINT64_C(1))<<63)
@@ -521,10 +523,291 @@ static void	__mem_free(zbx_shmem_info_t *info, void *ptr)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ *                    Slab (size class) allocator layout                      *
+ *                  --------------------------------------                    *
+ *                                                                            *
+ * When ZBX_SHMEM_FLAG_SLAB is set small allocations are served from fixed    *
+ * size slots carved out of slab pages. A slab page is a regular used chunk:  *
+ *                                                                            *
+ *     |size|page header|hdr|slot|hdr|slot| ... |hdr|slot|size|               *
+ *                                                                            *
+ * Slot header has the same size as chunk size field, but has SHMEM_FLG_SLAB  *
+ * bit set and holds offset of the slot header from the page header. This    *
+ * way slots are recognized when freed and returned to their page without     *
+ * splitting or merging chunks.                                               *
+ *                                                                            *
+ * Free slots of a page are kept in singly linked list (the pointer to next   *
+ * free slot is stored in slot data) and pages having free slots are kept in  *
+ * doubly linked list of their size class.                                    *
+ *                                                                            *
+ * Slot memory is accounted as free memory until the slot is allocated, page  *
+ * header, slot headers and chunk padding are accounted as overhead.          *
+ *                                                                            *
+ ******************************************************************************/
+
+#define SHMEM_FLG_SLAB		((__UINT64_C(1))<<62)
+
+#define SLAB_SLOT(ptr)		(0 != ((*(zbx_uint64_t *)(ptr)) & SHMEM_FLG_SLAB))
+#define SLAB_SLOT_OFFSET(ptr)	((*(zbx_uint64_t *)(ptr)) & ~(SHMEM_FLG_USED | SHMEM_FLG_SLAB))
+
+#define SHMEM_SLAB_PAGE_SLOTS	64
+#define SHMEM_SLAB_MAX_SIZE	256
+
+typedef struct zbx_shmem_slab_page
+{
+	struct zbx_shmem_slab_page	*prev;
+	struct zbx_shmem_slab_page	*next;
+	void				*free_slots;
+	unsigned int			used;
+	unsigned int			cls;
+}
+zbx_shmem_slab_page_t;
+
+#define SHMEM_SLAB_PAGE_HDR	ZBX_SIZE_T_ALIGN8(sizeof(zbx_shmem_slab_page_t))
+
+struct zbx_shmem_slab_class
+{
+	zbx_shmem_slab_page_t	*partial;	/* pages having free slots */
+	zbx_uint64_t		slot_size;
+	zbx_uint64_t		overhead;
+	unsigned int		pages;
+	unsigned int		slots_used;
+};
+
+static const zbx_uint64_t	slab_slot_sizes[ZBX_SHMEM_SLAB_CLASS_COUNT] = {
+	24, 32, 40, 48, 64, 80, 96, 128, 160, 192, SHMEM_SLAB_MAX_SIZE
+};
+
+/* size class index by (proper allocation size / 8) */
+static const unsigned char	slab_class_index[SHMEM_SLAB_MAX_SIZE / 8 + 1] = {
+	0, 0, 0, 0, 1, 2, 3, 4, 4, 5, 5, 6, 6, 7, 7, 7, 7, 8, 8, 8, 8, 9, 9, 9, 9, 10, 10, 10, 10, 10, 10, 10, 10
+};
+
+static void	mem_slab_link_page(zbx_shmem_slab_class_t *cls, zbx_shmem_slab_page_t *page)
+{
+	page->prev = NULL;
+	page->next = cls->partial;
+
+	if (NULL != cls->partial)
+		cls->partial->prev = page;
+
+	cls->partial = page;
+}
+
+static void	mem_slab_unlink_page(zbx_shmem_slab_class_t *cls, zbx_shmem_slab_page_t *page)
+{
+	if (NULL != page->prev)
+		page->prev->next = page->next;
+	else
+		cls->partial = page->next;
+
+	if (NULL != page->next)
+		page->next->prev = page->prev;
+}
+
+static zbx_shmem_slab_page_t	*mem_slab_get_page(void *slot)
+{
+	return (zbx_shmem_slab_page_t *)((char *)slot - SLAB_SLOT_OFFSET(slot));
+}
+
+static zbx_shmem_slab_page_t	*mem_slab_create_page(zbx_shmem_info_t *info, zbx_shmem_slab_class_t *cls)
+{
+	void			*chunk, *slot;
+	zbx_shmem_slab_page_t	*page;
+	zbx_uint64_t		slots_size, offset;
+	int			i;
+
+	if (NULL == (chunk = __mem_malloc(info, SHMEM_SLAB_PAGE_HDR + SHMEM_SLAB_PAGE_SLOTS *
+			(SHMEM_SIZE_FIELD + cls->slot_size))))
+	{
+		return NULL;
+	}
+
+	page = (zbx_shmem_slab_page_t *)((char *)chunk + SHMEM_SIZE_FIELD);
+	page->cls = (unsigned int)(cls - info->slabs);
+	page->used = 0;
+	page->free_slots = NULL;
+
+	/* link slots in reverse order so that they are allocated in address order */
+	for (i = SHMEM_SLAB_PAGE_SLOTS - 1; 0 <= i; i--)
+	{
+		offset = SHMEM_SLAB_PAGE_HDR + (zbx_uint64_t)i * (SHMEM_SIZE_FIELD + cls->slot_size);
+		slot = (char *)page + offset;
+
+		*(zbx_uint64_t *)slot = SHMEM_FLG_USED | SHMEM_FLG_SLAB | offset;
+		*(void **)((char *)slot + SHMEM_SIZE_FIELD) = page->free_slots;
+		page->free_slots = slot;
+	}
+
+	mem_slab_link_page(cls, page);
+
+	slots_size = SHMEM_SLAB_PAGE_SLOTS * cls->slot_size;
+	cls->pages++;
+	cls->overhead += CHUNK_SIZE(chunk) - slots_size;
+
+	info->used_size -= CHUNK_SIZE(chunk);
+	info->free_size += slots_size;
+
+	return page;
+}
+
+static void	mem_slab_release_page(zbx_shmem_info_t *info, zbx_shmem_slab_class_t *cls, zbx_shmem_slab_page_t *page)
+{
+	zbx_uint64_t	slots_size, chunk_size;
+
+	mem_slab_unlink_page(cls, page);
+
+	slots_size = SHMEM_SLAB_PAGE_SLOTS * cls->slot_size;
+	chunk_size = CHUNK_SIZE((char *)page - SHMEM_SIZE_FIELD);
+	cls->pages--;
+	cls->overhead -= chunk_size - slots_size;
+
+	info->used_size += chunk_size;
+	info->free_size -= slots_size;
+
+	__mem_free(info, page);
+}
+
+static void	*mem_slab_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	zbx_shmem_slab_class_t	*cls;
+	zbx_shmem_slab_page_t	*page;
+	void			*slot;
+
+	cls = &info->slabs[slab_class_index[size >> 3]];
+
+	if (NULL == (page = cls->partial) && NULL == (page = mem_slab_create_page(info, cls)))
+		return NULL;
+
+	slot = page->free_slots;
+	page->free_slots = *(void **)((char *)slot + SHMEM_SIZE_FIELD);
+
+	if (SHMEM_SLAB_PAGE_SLOTS == ++page->used)
+		mem_slab_unlink_page(cls, page);
+
+	cls->slots_used++;
+	info->used_size += cls->slot_size;
+	info->free_size -= cls->slot_size;
+
+	return slot;
+}
+
+static void	mem_slab_free(zbx_shmem_info_t *info, void *ptr)
+{
+	void			*slot;
+	zbx_shmem_slab_page_t	*page;
+	zbx_shmem_slab_class_t	*cls;
+
+	slot = (void *)((char *)ptr - SHMEM_SIZE_FIELD);
+	page = mem_slab_get_page(slot);
+	cls = &info->slabs[page->cls];
+
+	*(void **)ptr = page->free_slots;
+	page->free_slots = slot;
+
+	if (SHMEM_SLAB_PAGE_SLOTS == page->used--)
+		mem_slab_link_page(cls, page);
+
+	cls->slots_used--;
+	info->used_size -= cls->slot_size;
+	info->free_size += cls->slot_size;
+
+	/* keep the last page with free slots to avoid page allocation thrashing */
+	if (0 == page->used && (NULL != page->prev || NULL != page->next))
+		mem_slab_release_page(info, cls, page);
+}
+
+static void	*mem_slab_realloc(zbx_shmem_info_t *info, void *old, zbx_uint64_t size)
+{
+	void			*slot, *chunk;
+	zbx_shmem_slab_page_t	*page;
+	zbx_uint64_t		slot_size;
+
+	slot = (void *)((char *)old - SHMEM_SIZE_FIELD);
+	page = mem_slab_get_page(slot);
+	slot_size = info->slabs[page->cls].slot_size;
+
+	size = mem_proper_alloc_size(size);
+
+	if (SHMEM_SLAB_MAX_SIZE >= size && slab_class_index[size >> 3] == page->cls)
+		return slot;
+
+	if (NULL == (chunk = mem_malloc(info, size)))
+		return NULL;
+
+	memcpy((char *)chunk + SHMEM_SIZE_FIELD, old, MIN(size, slot_size));
+	mem_slab_free(info, old);
+
+	return chunk;
+}
+
+static void	mem_slab_init(zbx_shmem_slab_class_t *slabs)
+{
+	int	i;
+
+	for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+	{
+		slabs[i].partial = NULL;
+		slabs[i].slot_size = slab_slot_sizes[i];
+		slabs[i].overhead = 0;
+		slabs[i].pages = 0;
+		slabs[i].slots_used = 0;
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: allocate memory chunk, using slab allocator for small sizes if    *
+ *          enabled                                                           *
+ *                                                                            *
+ * Return value: the allocated chunk or NULL if out of memory                 *
+ *                                                                            *
+ ******************************************************************************/
+static void	*mem_malloc(zbx_shmem_info_t *info, zbx_uint64_t size)
+{
+	if (NULL != info->slabs)
+	{
+		void	*slot;
+
+		size = mem_proper_alloc_size(size);
+
+		/* fall back to regular chunks if there is no space for a new slab page */
+		if (SHMEM_SLAB_MAX_SIZE >= size && NULL != (slot = mem_slab_malloc(info, size)))
+			return slot;
+	}
+
+	return __mem_malloc(info, size);
+}
+
 /* public memory interface */
 
 int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
 		int allow_oom, char **error)
+{
+	return zbx_shmem_create_ext(info, size, descr, param, allow_oom, 0, error);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create shared memory with the specified allocator options         *
+ *                                                                            *
+ * Parameters: info      - [OUT] the shared memory information                *
+ *             size      - [IN] the shared memory size                        *
+ *             descr     - [IN] the shared memory description                 *
+ *             param     - [IN] the configuration parameter name              *
+ *             allow_oom - [IN] 1 - return NULL on out of memory, 0 - exit    *
+ *             flags     - [IN] ZBX_SHMEM_FLAG_SLAB - serve small allocations *
+ *                              from size class slabs                         *
+ *             error     - [OUT] the error message                            *
+ *                                                                            *
+ * Return value: SUCCEED - the memory was allocated successfully              *
+ *               FAIL - otherwise                                             *
+ *                                                                            *
+ ******************************************************************************/
+int	zbx_shmem_create_ext(zbx_shmem_info_t **info, zbx_uint64_t size, const char *descr, const char *param,
+		int allow_oom, unsigned char flags, char **error)
 {
 	int	shm_id, index, ret = FAIL;
 	void	*base;
@@ -532,8 +815,8 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	descr = ZBX_NULL2STR(descr);
 	param = ZBX_NULL2STR(param);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s() param:'%s' description: %s size:" ZBX_FS_SIZE_T, __func__, param,
-			descr, (zbx_fs_size_t)size);
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() param:'%s' description: %s size:" ZBX_FS_SIZE_T " flags:%x", __func__,
+			param, descr, (zbx_fs_size_t)size, (unsigned int)flags);
 
 	/* allocate shared memory */
 
@@ -594,6 +877,16 @@ int	zbx_shmem_create(zbx_shmem_info_t **info, zbx_uint64_t size, const char *des
 	size -= strlen(param) + 1;
 	base = (void *)((char *)base + strlen(param) + 1);
 
+	if (0 != (flags & ZBX_SHMEM_FLAG_SLAB))
+	{
+		(*info)->slabs = (zbx_shmem_slab_class_t *)ALIGN8(base);
+		mem_slab_init((*info)->slabs);
+		size -= (char *)((*info)->slabs + ZBX_SHMEM_SLAB_CLASS_COUNT) - (char *)base;
+		base = (void *)((*info)->slabs + ZBX_SHMEM_SLAB_CLASS_COUNT);
+	}
+	else
+		(*info)->slabs = NULL;
+
 	(*info)->allow_oom = allow_oom;
 	(*info)->unlock_shmem_on_oom = NULL;
 
@@ -682,7 +975,7 @@ void	*__zbx_shmem_malloc(const char *file, int line, zbx_shmem_info_t *info, con
 		zbx_exit(EXIT_FAILURE);
 	}
 
-	chunk = __mem_malloc(info, size);
+	chunk = mem_malloc(info, size);
 
 	if (NULL == chunk)
 	{
@@ -718,7 +1011,9 @@ void	*__zbx_shmem_realloc(const char *file, int line, zbx_shmem_info_t *info, vo
 	}
 
 	if (NULL == old)
-		chunk = __mem_malloc(info, size);
+		chunk = mem_malloc(info, size);
+	else if (SLAB_SLOT((char *)old - SHMEM_SIZE_FIELD))
+		chunk = mem_slab_realloc(info, old, size);
 	else
 		chunk = __mem_realloc(info, old, size);
 
@@ -752,7 +1047,10 @@ void	__zbx_shmem_free(const char *file, int line, zbx_shmem_info_t *info, void *
 		zbx_exit(EXIT_FAILURE);
 	}
 
-	__mem_free(info, ptr);
+	if (SLAB_SLOT((char *)ptr - SHMEM_SIZE_FIELD))
+		mem_slab_free(info, ptr);
+	else
+		__mem_free(info, ptr);
 }
 
 void	zbx_shmem_clear(zbx_shmem_info_t *info)
@@ -770,6 +1068,9 @@ void	zbx_shmem_clear(zbx_shmem_info_t *info)
 	info->used_size = 0;
 	info->free_size = info->total_size;
 
+	if (NULL != info->slabs)
+		mem_slab_init(info->slabs);
+
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
@@ -777,7 +1078,8 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 {
 	void		*chunk;
 	int		i;
-	zbx_uint64_t	counter;
+	zbx_uint64_t	counter, slab_overhead = 0;
+	unsigned int	slots_used = 0;
 
 	stats->free_chunks = 0;
 	stats->max_chunk_size = __UINT64_C(0);
@@ -803,8 +1105,28 @@ void	zbx_shmem_get_stats(const zbx_shmem_info_t *info, zbx_shmem_stats_t *stats)
 	if (__UINT64_C(0xffffffffffffffff) == stats->min_chunk_size)
 		stats->min_chunk_size = 0;
 
+	stats->slabs_num = 0;
+
+	if (NULL != info->slabs)
+	{
+		stats->slabs_num = ZBX_SHMEM_SLAB_CLASS_COUNT;
+
+		for (i = 0; i < ZBX_SHMEM_SLAB_CLASS_COUNT; i++)
+		{
+			stats->slabs[i].slot_size = info->slabs[i].slot_size;
+			stats->slabs[i].pages = info->slabs[i].pages;
+			stats->slabs[i].slots_total = info->slabs[i].pages * SHMEM_SLAB_PAGE_SLOTS;
+			stats->slabs[i].slots_used = info->slabs[i].slots_used;
+
+			slab_overhead += info->slabs[i].overhead;
+			slots_used += info->slabs[i].slots_used;
+		}
+	}
+
+	/* used chunks include slab pages and allocated slots */
 	stats->overhead = info->total_size - info->used_size - info->free_size;
-	stats->used_chunks = stats->overhead / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks;
+	stats->used_chunks = (stats->overhead - slab_overhead) / (2 * SHMEM_SIZE_FIELD) + 1 - stats->free_chunks +
+			slots_used;
 	stats->free_size = info->free_size;
 	stats->used_size = info->used_size;
 }
@@ -827,6 +1149,16 @@ void	zbx_shmem_dump_stats(int level, zbx_shmem_info_t *info)
 			ZBX_SHMEM_MIN_BUCKET_SIZE + 8 * i, stats.chunks_num[i]);
 	}
 
+	for (i = 0; i < stats.slabs_num; i++)
+	{
+		if (0 == stats.slabs[i].pages)
+			continue;
+
+		zabbix_log(level, "slab slots of size %3llu bytes: %8u used of %8u in %6u pages",
+				(unsigned long long)stats.slabs[i].slot_size, stats.slabs[i].slots_used,
+				stats.slabs[i].slots_total, stats.slabs[i].pages);
+	}
+
 	zabbix_log(level, "min chunk size: %10llu bytes", (unsigned long long)stats.min_chunk_size);
 	zabbix_log(level, "max chunk size: %10llu bytes", (unsigned long long)stats.max_chunk_size);
 
@@ -231,14 +231,14 @@ static void	recv_agenthistory(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, s
  *                                                                            *
  ******************************************************************************/
 static void	recv_senderhistory(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, struct zbx_json_parse *jp,
-		zbx_timespec_t *ts, int config_timeout)
+		zbx_sender_data_stream_t *stream, zbx_timespec_t *ts, int config_timeout)
 {
 	char	*info = NULL, *ext = NULL;
 	int	ret;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (FAIL == (ret = zbx_process_sender_history_data(rtc, sock, jp, ts, &info)))
+	if (FAIL == (ret = zbx_process_sender_history_data(rtc, sock, jp, stream, ts, &info)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot process sender data from \"%s\": %s", sock->peer, info);
 	}
@@ -1309,7 +1309,7 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts,
 #ifndef ZBX_DEBUG
 		zabbix_log(LOG_LEVEL_DEBUG, "trapper got '%s'", s);
 #endif
-			recv_senderhistory(rtc, sock, &jp, ts, config_comms->config_timeout);
+			recv_senderhistory(rtc, sock, &jp, NULL, ts, config_comms->config_timeout);
 		}
 		else if (0 == strcmp(value, ZBX_PROTO_VALUE_PROXY_HEARTBEAT))
 		{
@@ -1474,6 +1474,186 @@ static int	process_trap(zbx_socket_t *sock, char *s, zbx_timespec_t *ts,
 	return ret;
 }
 
+/* sender data request processed while receiving */
+typedef struct
+{
+	zbx_sender_data_stream_t	*stream;
+	zbx_ipc_async_socket_t		*rtc;
+	zbx_socket_t			*sock;
+	zbx_timespec_t			*ts;
+	int				config_timeout;
+}
+trapper_sender_stream_t;
+
+static int	trapper_sender_stream_feed(void *data, const char *buf, size_t len)
+{
+	trapper_sender_stream_t	*sender = (trapper_sender_stream_t *)data;
+
+	return zbx_sender_data_stream_feed(sender->stream, buf, len);
+}
+
+static void	trapper_sender_stream_process(void *data)
+{
+	trapper_sender_stream_t	*sender = (trapper_sender_stream_t *)data;
+	const char		*json;
+	struct zbx_json_parse	jp;
+
+	if (NULL == (json = zbx_sender_data_stream_get_json(sender->stream)) || SUCCEED != zbx_json_open(json, &jp))
+	{
+		zbx_send_response(sender->sock, FAIL, zbx_json_strerror(), sender->config_timeout);
+		return;
+	}
+
+	recv_senderhistory(sender->rtc, sender->sock, &jp, sender->stream, sender->ts, sender->config_timeout);
+}
+
+static void	trapper_sender_stream_free(void *data)
+{
+	trapper_sender_stream_t	*sender = (trapper_sender_stream_t *)data;
+
+	zbx_sender_data_stream_free(sender->stream);
+	zbx_free(sender);
+}
+
+static void	trapper_sender_stream_create(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, zbx_timespec_t *ts,
+		int config_timeout, zbx_trapper_stream_t *stream)
+{
+	trapper_sender_stream_t	*sender;
+
+	sender = (trapper_sender_stream_t *)zbx_malloc(NULL, sizeof(trapper_sender_stream_t));
+	sender->stream = zbx_sender_data_stream_create(rtc, sock);
+	sender->rtc = rtc;
+	sender->sock = sock;
+	sender->ts = ts;
+	sender->config_timeout = config_timeout;
+
+	stream->feed_cb = trapper_sender_stream_feed;
+	stream->process_cb = trapper_sender_stream_process;
+	stream->free_cb = trapper_sender_stream_free;
+	stream->data = sender;
+}
+
+#define TRAPPER_RECV_DETECT	0	/* reading the first member to detect request */
+#define TRAPPER_RECV_BUFFER	1	/* buffering the whole message */
+#define TRAPPER_RECV_STREAM	2	/* passing the message to request stream */
+
+/* trapper message receiving state */
+typedef struct
+{
+	int					mode;
+	zbx_json_stream_t			json_stream;
+	zbx_trapper_stream_t			stream;
+
+	/* the received data, kept till the request is detected or buffered */
+	char					*data;
+	size_t					data_alloc;
+	size_t					data_offset;
+
+	zbx_socket_t				*sock;
+	zbx_timespec_t				*ts;
+	const zbx_config_comms_args_t		*config_comms;
+	int					proxydata_frequency;
+	const zbx_events_funcs_t		*events_cbs;
+	zbx_trapper_stream_request_func_t	trapper_stream_request_cb;
+	zbx_ipc_async_socket_t			*rtc;
+}
+trapper_recv_t;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: detects request from the first member of received JSON data       *
+ *                                                                            *
+ * Comments: Requests that are processed while receiving must start with      *
+ *           request member, otherwise the whole message is buffered and      *
+ *           processed by process_trap().                                     *
+ *           The callback always fails to stop reading after the first member.*
+ *                                                                            *
+ ******************************************************************************/
+static int	trapper_recv_detect_cb(void *data, int event, const char *name, const char *value, size_t len)
+{
+	trapper_recv_t	*recv = (trapper_recv_t *)data;
+	char		request[MAX_STRING_LEN];
+
+	ZBX_UNUSED(len);
+
+	recv->mode = TRAPPER_RECV_BUFFER;
+
+	if (ZBX_JSON_STREAM_MEMBER != event || 0 != strcmp(name, ZBX_PROTO_TAG_REQUEST) ||
+			NULL == zbx_json_decodevalue(value, request, sizeof(request), NULL))
+	{
+		return FAIL;
+	}
+
+	/* unencrypted connections are rejected when processing buffered request */
+	if (ZBX_TCP_SEC_UNENCRYPTED == recv->sock->connection_type &&
+			NULL != recv->config_comms->config_tls->tls_listen)
+	{
+		return FAIL;
+	}
+
+	if (0 == strcmp(request, ZBX_PROTO_VALUE_SENDER_DATA))
+	{
+		trapper_sender_stream_create(recv->rtc, recv->sock, recv->ts, recv->config_comms->config_timeout,
+				&recv->stream);
+	}
+	else if (NULL == recv->trapper_stream_request_cb || SUCCEED != recv->trapper_stream_request_cb(request,
+			recv->sock, recv->ts, recv->config_comms, recv->proxydata_frequency, recv->events_cbs,
+			recv->rtc, &recv->stream))
+	{
+		return FAIL;
+	}
+
+	zabbix_log(LOG_LEVEL_DEBUG, "trapper got request '%s', processing it while receiving", request);
+	recv->mode = TRAPPER_RECV_STREAM;
+
+	return FAIL;
+}
+
+static void	trapper_recv_append(trapper_recv_t *recv, const char *buf, size_t len)
+{
+	if (recv->data_alloc < recv->data_offset + len + 1)
+	{
+		while (recv->data_alloc < recv->data_offset + len + 1)
+			recv->data_alloc = (0 == recv->data_alloc ? ZBX_KIBIBYTE : recv->data_alloc * 2);
+
+		recv->data = (char *)zbx_realloc(recv->data, recv->data_alloc);
+	}
+
+	memcpy(recv->data + recv->data_offset, buf, len);
+	recv->data_offset += len;
+	recv->data[recv->data_offset] = '\0';
+}
+
+static int	trapper_recv_feed(void *data, const char *buf, size_t len)
+{
+	trapper_recv_t	*recv = (trapper_recv_t *)data;
+	int		ret;
+
+	if (TRAPPER_RECV_STREAM == recv->mode)
+		return recv->stream.feed_cb(recv->stream.data, buf, len);
+
+	trapper_recv_append(recv, buf, len);
+
+	if (TRAPPER_RECV_DETECT != recv->mode || SUCCEED == zbx_json_stream_feed(&recv->json_stream, buf, len))
+		return SUCCEED;
+
+	if (TRAPPER_RECV_STREAM != recv->mode)
+	{
+		/* not a JSON object or the request is not processed while receiving */
+		recv->mode = TRAPPER_RECV_BUFFER;
+		return SUCCEED;
+	}
+
+	/* pass the data received so far to request stream */
+	ret = recv->stream.feed_cb(recv->stream.data, recv->data, recv->data_offset);
+
+	zbx_free(recv->data);
+	recv->data_alloc = 0;
+	recv->data_offset = 0;
+
+	return ret;
+}
+
 static void	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts,
 		const zbx_config_comms_args_t *config_comms, const zbx_config_vault_t *config_vault,
 		int config_startup_time, const zbx_events_funcs_t *events_cbs, int proxydata_frequency,
@@ -1482,21 +1662,53 @@ static void	process_trapper_child(zbx_socket_t *sock, zbx_timespec_t *ts,
 		int config_enable_global_scripts, zbx_get_value_internal_ext_f zbx_get_value_internal_ext_cb,
 		const char *config_ssh_key_location, const char *config_webdriver_url,
 		zbx_trapper_process_request_func_t trapper_process_request_cb,
+		zbx_trapper_stream_request_func_t trapper_stream_request_cb,
 		zbx_autoreg_update_host_func_t autoreg_update_host_cb, const char *config_frontend_allowed_ip,
 		const char *config_bridge_adapter_url, const char *config_bridge_adapter_connect_to,
 		zbx_ipc_async_socket_t *rtc)
 {
-	if (FAIL == zbx_tcp_recv_to(sock, config_comms->config_trapper_timeout))
-		return;
+	trapper_recv_t	recv = {
+			.mode = TRAPPER_RECV_DETECT,
+			.sock = sock,
+			.ts = ts,
+			.config_comms = config_comms,
+			.proxydata_frequency = proxydata_frequency,
+			.events_cbs = events_cbs,
+			.trapper_stream_request_cb = trapper_stream_request_cb,
+			.rtc = rtc
+		};
+
+	zbx_json_stream_init(&recv.json_stream, trapper_recv_detect_cb, &recv);
+
+	/* large data (sender data, proxy data on server) is processed while receiving, */
+	/* other requests are buffered and processed after the whole data is received   */
+	if (FAIL == zbx_tcp_recv_stream(sock, config_comms->config_trapper_timeout, 0, trapper_recv_feed, &recv))
+		goto out;
+
+	if (TRAPPER_RECV_STREAM == recv.mode)
+	{
+		recv.stream.process_cb(recv.stream.data);
+		goto out;
+	}
 
-	process_trap(sock, sock->buffer, ts, config_comms, config_vault, config_startup_time,
-			events_cbs, proxydata_frequency, get_config_forks, config_stats_allowed_ip, progname,
-			config_java_gateway, config_java_gateway_port, config_externalscripts,
+	process_trap(sock, NULL != recv.data ? recv.data : sock->buffer, ts, config_comms, config_vault,
+			config_startup_time, events_cbs, proxydata_frequency, get_config_forks, config_stats_allowed_ip,
+			progname, config_java_gateway, config_java_gateway_port, config_externalscripts,
 			config_enable_global_scripts, zbx_get_value_internal_ext_cb, config_ssh_key_location,
 			config_webdriver_url, trapper_process_request_cb, autoreg_update_host_cb,
 			config_frontend_allowed_ip, config_bridge_adapter_url, config_bridge_adapter_connect_to, rtc);
+out:
+	if (TRAPPER_RECV_STREAM == recv.mode)
+		recv.stream.free_cb(recv.stream.data);
+
+	zbx_json_stream_clear(&recv.json_stream);
+	zbx_free(recv.data);
 }
 
+#undef TRAPPER_RECV_DETECT
+#undef TRAPPER_RECV_BUFFER
+#undef TRAPPER_RECV_STREAM
+
 ZBX_THREAD_ENTRY(zbx_trapper_thread, args)
 {
 #define POLL_TIMEOUT	1
@@ -1599,6 +1811,7 @@ ZBX_THREAD_ENTRY(zbx_trapper_thread, args)
 					trapper_args_in->config_ssh_key_location,
 					trapper_args_in->config_webdriver_url,
 					trapper_args_in->trapper_process_request_func_cb,
+					trapper_args_in->trapper_stream_request_func_cb,
 					trapper_args_in->autoreg_update_host_cb,
 					trapper_args_in->config_frontend_allowed_ip,
 					trapper_args_in->config_bridge_adapter_url,
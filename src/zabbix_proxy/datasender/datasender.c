@@ -88,6 +88,8 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 		const zbx_thread_info_t *info, zbx_thread_datasender_args *args, int *task_timestamp)
 {
 	static int		data_timestamp = 0, upload_state = SUCCEED;
+	/* compression codec selected by server in the last response, zlib until server replies */
+	static unsigned char	codec = 0;
 
 	zbx_socket_t		sock;
 	struct zbx_json		j;
@@ -109,6 +111,9 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 	zbx_json_addstring(&j, ZBX_PROTO_TAG_HOST, args->config_hostname, ZBX_JSON_TYPE_STRING);
 	zbx_json_addstring(&j, ZBX_PROTO_TAG_SESSION, zbx_dc_get_session_token(), ZBX_JSON_TYPE_STRING);
 
+	/* version precedes history data so that server can process history while receiving */
+	zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
+
 	if (SUCCEED == upload_state && args->config_proxydata_frequency <= now - data_timestamp &&
 			ZBX_PROXY_UPLOAD_DISABLED != *hist_upload_state)
 	{
@@ -170,7 +175,7 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 			*more = ZBX_PROXY_DATA_MORE;
 		}
 
-		zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
+		zbx_add_compress_codecs(&j);
 
 		zbx_timespec(&ts);
 		zbx_json_adduint64(&j, ZBX_PROTO_TAG_CLOCK, ts.sec);
@@ -179,7 +184,8 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 		if (0 != (flags & ZBX_DATASENDER_HISTORY) && 0 != (proxy_delay = zbx_proxy_get_delay(history_lastid)))
 			zbx_json_adduint64(&j, ZBX_PROTO_TAG_PROXY_DELAY, proxy_delay);
 
-		if (SUCCEED != zbx_compress(j.buffer, j.buffer_size, &buffer, &buffer_size))
+		if (SUCCEED != zbx_compress_ext(zbx_tcp_compress_codec(codec), j.buffer, j.buffer_size, &buffer,
+				&buffer_size))
 		{
 			zabbix_log(LOG_LEVEL_ERR,"cannot compress data: %s", zbx_compress_strerror());
 			goto clean;
@@ -204,11 +210,14 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
 
-		upload_state = zbx_put_data_to_server(&sock, &buffer, buffer_size, reserved, &error);
+		upload_state = zbx_put_data_to_server(&sock, &buffer, buffer_size, reserved, codec, &error);
 		get_hist_upload_state(sock.buffer, hist_upload_state);
 
 		if (SUCCEED != upload_state)
 		{
+			/* fall back to zlib in the case server was replaced with older version */
+			codec = 0;
+
 			zbx_addrs_failover(args->config_server_addrs);
 
 			*more = ZBX_PROXY_DATA_DONE;
@@ -221,6 +230,8 @@ static int	proxy_data_sender(int *more, int now, int *hist_upload_state, int *ne
 		}
 		else
 		{
+			codec = sock.protocol & ZBX_TCP_COMPRESS_CODECS;
+
 			if (0 != (flags & ZBX_DATASENDER_AVAILABILITY))
 				zbx_set_availability_diff_ts(availability_ts);
 
@@ -69,15 +69,16 @@ static void	active_passive_misconfig(zbx_socket_t *sock, int config_timeout)
  *             buffer          - [IN/OUT]                                     *
  *             buffer_size     - [IN]                                         *
  *             reserved        - [IN]                                         *
+ *             codec           - [IN] compression codec flag, 0 for zlib      *
  *             config_timeout  - [IN]                                         *
  *             error           - [OUT] error message                          *
  *                                                                            *
  ******************************************************************************/
 static int	send_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_size, size_t reserved,
-		int config_timeout, char **error)
+		unsigned char codec, int config_timeout, char **error)
 {
-	if (SUCCEED != zbx_tcp_send_ext(sock, *buffer, buffer_size, reserved, ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS,
-			config_timeout))
+	if (SUCCEED != zbx_tcp_send_ext(sock, *buffer, buffer_size, reserved,
+			ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | codec, config_timeout))
 	{
 		*error = zbx_strdup(*error, zbx_socket_strerror());
 		return FAIL;
@@ -96,13 +97,14 @@ static int	send_data_to_server(zbx_socket_t *sock, char **buffer, size_t buffer_
  * Purpose: sends 'proxy data' request to server                              *
  *                                                                            *
  * Parameters: sock                - [IN] connection socket                   *
+ *             jp_request          - [IN] received request                    *
  *             ts                  - [IN] connection timestamp                *
  *             config_comms        - [IN] proxy configuration for             *
  *                                        communication with server           *
  *             get_program_type_cb - [IN] callback to get program type        *
  *                                                                            *
  ******************************************************************************/
-static void	send_proxy_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
+static void	send_proxy_data(zbx_socket_t *sock, const struct zbx_json_parse *jp_request, const zbx_timespec_t *ts,
 		const zbx_config_comms_args_t *config_comms, zbx_get_program_type_f get_program_type_cb,
 		zbx_ipc_async_socket_t *rtc)
 {
@@ -113,6 +115,7 @@ static void	send_proxy_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
 	zbx_vector_tm_task_t	tasks;
 	struct zbx_json_parse	jp, jp_tasks;
 	size_t			buffer_size, reserved;
+	unsigned char		codec;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -128,6 +131,8 @@ static void	send_proxy_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
 
 	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
 
+	/* version and session precede history data so that server can process history while receiving */
+	zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
 	zbx_json_addstring(&j, ZBX_PROTO_TAG_SESSION, zbx_dc_get_session_token(), ZBX_JSON_TYPE_STRING);
 	zbx_get_interface_availability_data(&j, &availability_ts);
 	zbx_pb_history_get_rows(&j, &history_lastid, &more_history);
@@ -150,14 +155,16 @@ static void	send_proxy_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
 	else
 		more = ZBX_PROXY_DATA_DONE;
 
-	zbx_json_addstring(&j, ZBX_PROTO_TAG_VERSION, ZABBIX_VERSION, ZBX_JSON_TYPE_STRING);
 	zbx_json_addint64(&j, ZBX_PROTO_TAG_CLOCK, ts->sec);
 	zbx_json_addint64(&j, ZBX_PROTO_TAG_NS, ts->ns);
 
 	if (0 != history_lastid && 0 != (proxy_delay = zbx_proxy_get_delay(history_lastid)))
 		zbx_json_addint64(&j, ZBX_PROTO_TAG_PROXY_DELAY, proxy_delay);
 
-	if (SUCCEED != zbx_compress(j.buffer, j.buffer_size, &buffer, &buffer_size))
+	codec = zbx_get_compress_codec(jp_request);
+
+	if (SUCCEED != zbx_compress_ext(zbx_tcp_compress_codec(codec), j.buffer, j.buffer_size, &buffer,
+			&buffer_size))
 	{
 		zabbix_log(LOG_LEVEL_ERR,"cannot compress data: %s", zbx_compress_strerror());
 		goto clean;
@@ -166,7 +173,7 @@ static void	send_proxy_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
 	reserved = j.buffer_size;
 	zbx_json_free(&j);	/* json buffer can be large, free as fast as possible */
 
-	if (SUCCEED == send_data_to_server(sock, &buffer, buffer_size, reserved, config_comms->config_timeout,
+	if (SUCCEED == send_data_to_server(sock, &buffer, buffer_size, reserved, codec, config_comms->config_timeout,
 			&error))
 	{
 		zbx_set_availability_diff_ts(availability_ts);
@@ -276,7 +283,7 @@ static void	send_task_data(zbx_socket_t *sock, const zbx_timespec_t *ts,
 	reserved = j.buffer_size;
 	zbx_json_free(&j);	/* json buffer can be large, free as fast as possible */
 
-	if (SUCCEED == send_data_to_server(sock, &buffer, buffer_size, reserved, config_comms->config_timeout,
+	if (SUCCEED == send_data_to_server(sock, &buffer, buffer_size, reserved, 0, config_comms->config_timeout,
 			&error))
 	{
 		zbx_db_begin();
@@ -379,7 +386,7 @@ int	trapper_process_request_proxy(const char *request, zbx_socket_t *sock, const
 	{
 		if (0 != (get_program_type_cb() & ZBX_PROGRAM_TYPE_PROXY_PASSIVE))
 		{
-			send_proxy_data(sock, ts, config_comms, get_program_type_cb, rtc);
+			send_proxy_data(sock, jp, ts, config_comms, get_program_type_cb, rtc);
 			return SUCCEED;
 		}
 		return FAIL;
@@ -131,89 +131,6 @@ static void	get_object_ids(const zbx_vector_db_event_t *esc_events, zbx_vector_u
 	zbx_vector_uint64_uniq(objectids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 }
 
-/******************************************************************************
- *                                                                            *
- * Parameters: esc_events - [IN]     events to check                          *
- *             condition  - [IN/OUT] Condition for matching, outputs          *
- *                                   event ids that match condition.          *
- *                                                                            *
- * Return value: SUCCEED - supported operator                                 *
- *               NOTSUPPORTED - not supported operator                        *
- *                                                                            *
- ******************************************************************************/
-static int	check_host_group_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition)
-{
-	char			*sql = NULL;
-	size_t			sql_alloc = 0, sql_offset = 0;
-	zbx_db_result_t		result;
-	zbx_db_row_t		row;
-	zbx_vector_uint64_t	objectids, groupids;
-	zbx_uint64_t		condition_value;
-
-	if (ZBX_CONDITION_OPERATOR_EQUAL != condition->op && ZBX_CONDITION_OPERATOR_NOT_EQUAL != condition->op)
-		return NOTSUPPORTED;
-
-	if (SUCCEED != zbx_is_uint64(condition->value, &condition_value))
-		return NOTSUPPORTED;
-
-	zbx_vector_uint64_create(&objectids);
-	zbx_vector_uint64_create(&groupids);
-
-	get_object_ids(esc_events, &objectids);
-	zbx_dc_get_nested_hostgroupids(&condition_value, 1, &groupids);
-
-	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
-		"select distinct f.triggerid"
-		" from hosts_groups hg,hosts h,items i,functions f"
-		" where hg.hostid=h.hostid"
-			" and h.hostid=i.hostid"
-			" and i.itemid=f.itemid"
-			" and");
-
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid",
-			objectids.values, objectids.values_num);
-
-	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, " and");
-	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "hg.groupid", groupids.values, groupids.values_num);
-
-	result = zbx_db_select("%s", sql);
-
-	while (NULL != (row = zbx_db_fetch(result)))
-	{
-		zbx_uint64_t	objectid;
-
-		ZBX_STR2UINT64(objectid, row[0]);
-		if (ZBX_CONDITION_OPERATOR_NOT_EQUAL == condition->op)
-		{
-			int	index;
-
-			if (FAIL != (index = zbx_vector_uint64_search(&objectids, objectid,
-					ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
-			{
-				zbx_vector_uint64_remove_noorder(&objectids, index);
-			}
-		}
-		else
-			add_condition_match(esc_events, condition, objectid, EVENT_OBJECT_TRIGGER);
-
-	}
-	zbx_db_free_result(result);
-
-	if (ZBX_CONDITION_OPERATOR_NOT_EQUAL == condition->op)
-	{
-		int	i;
-
-		for (i = 0; i < objectids.values_num; i++)
-			add_condition_match(esc_events, condition, objectids.values[i], EVENT_OBJECT_TRIGGER);
-	}
-
-	zbx_vector_uint64_destroy(&groupids);
-	zbx_vector_uint64_destroy(&objectids);
-	zbx_free(sql);
-
-	return SUCCEED;
-}
-
 /******************************************************************************
  *                                                                            *
  * Purpose: mapping between discovered triggers and their prototypes          *
@@ -393,39 +310,211 @@ static void	check_object_hierarchy(int object, const zbx_vector_db_event_t *esc_
 	zbx_vector_uint64_destroy(&objectids_tmp);
 }
 
+/* trigger hierarchy shared by trigger source conditions of one event batch */
+typedef struct
+{
+	zbx_uint64_t		triggerid;
+	zbx_vector_uint64_t	hostids;	/* hosts of trigger items */
+	zbx_vector_uint64_t	templateids;	/* templates the trigger is inherited from */
+}
+zbx_action_trigger_t;
+
+#define ZBX_ACTION_TRIGGER_CACHE_HOSTS		0x01
+#define ZBX_ACTION_TRIGGER_CACHE_TEMPLATES	0x02
+
+typedef struct
+{
+	zbx_hashset_t	triggers;
+	unsigned char	flags;
+}
+zbx_action_trigger_cache_t;
+
+static void	action_trigger_clean(void *data)
+{
+	zbx_action_trigger_t	*trigger = (zbx_action_trigger_t *)data;
+
+	zbx_vector_uint64_destroy(&trigger->hostids);
+	zbx_vector_uint64_destroy(&trigger->templateids);
+}
+
+static void	action_trigger_cache_init(zbx_action_trigger_cache_t *cache)
+{
+	zbx_hashset_create_ext(&cache->triggers, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC,
+			action_trigger_clean, ZBX_DEFAULT_MEM_MALLOC_FUNC, ZBX_DEFAULT_MEM_REALLOC_FUNC,
+			ZBX_DEFAULT_MEM_FREE_FUNC);
+	cache->flags = 0;
+}
+
+static void	action_trigger_cache_destroy(zbx_action_trigger_cache_t *cache)
+{
+	zbx_hashset_destroy(&cache->triggers);
+}
+
+static zbx_action_trigger_t	*action_trigger_cache_get(zbx_action_trigger_cache_t *cache, zbx_uint64_t triggerid)
+{
+	zbx_action_trigger_t	*trigger, trigger_local;
+
+	if (NULL == (trigger = (zbx_action_trigger_t *)zbx_hashset_search(&cache->triggers, &triggerid)))
+	{
+		trigger_local.triggerid = triggerid;
+		trigger = (zbx_action_trigger_t *)zbx_hashset_insert(&cache->triggers, &trigger_local,
+				sizeof(trigger_local));
+		zbx_vector_uint64_create(&trigger->hostids);
+		zbx_vector_uint64_create(&trigger->templateids);
+	}
+
+	return trigger;
+}
+
 /******************************************************************************
  *                                                                            *
- * Parameters: esc_events - [IN] events to check                              *
- *             condition  - [IN/OUT] Condition for matching, outputs          *
- *                                   event ids that match condition.          *
+ * Purpose: finds the first pair with the specified first value               *
  *                                                                            *
- * Return value: SUCCEED - supported operator                                 *
- *               NOTSUPPORTED - not supported operator                        *
+ * Parameters: pairs - [IN] pairs sorted by first value                       *
+ *             first - [IN] the value to find                                 *
+ *                                                                            *
+ * Return value: index of the first pair with the specified or larger first   *
+ *               value                                                        *
  *                                                                            *
  ******************************************************************************/
-static int	check_host_template_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition)
+static int	uint64_pair_lower_bound(const zbx_vector_uint64_pair_t *pairs, zbx_uint64_t first)
+{
+	int	lo = 0, hi = pairs->values_num;
+
+	while (lo < hi)
+	{
+		int	mid = lo + (hi - lo) / 2;
+
+		if (pairs->values[mid].first < first)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolves hosts of escalation event triggers                       *
+ *                                                                            *
+ * Parameters: cache      - [IN/OUT] trigger hierarchy cache                  *
+ *             esc_events - [IN] trigger events                               *
+ *                                                                            *
+ * Comments: Hosts are taken from configuration cache, database is queried    *
+ *           only for triggers missing from configuration cache. The hosts    *
+ *           are resolved once per event batch.                               *
+ *                                                                            *
+ ******************************************************************************/
+static void	action_trigger_cache_resolve_hosts(zbx_action_trigger_cache_t *cache,
+		const zbx_vector_db_event_t *esc_events)
+{
+	zbx_vector_uint64_t		triggerids;
+	zbx_vector_uint64_pair_t	trigger_hosts;
+
+	if (0 != (cache->flags & ZBX_ACTION_TRIGGER_CACHE_HOSTS))
+		return;
+
+	cache->flags |= ZBX_ACTION_TRIGGER_CACHE_HOSTS;
+
+	zbx_vector_uint64_create(&triggerids);
+	zbx_vector_uint64_pair_create(&trigger_hosts);
+
+	get_object_ids(esc_events, &triggerids);
+	zbx_dc_get_hostids_by_triggerids(&triggerids, &trigger_hosts);
+
+	for (int i = 0; i < trigger_hosts.values_num; i++)
+	{
+		zbx_action_trigger_t	*trigger = action_trigger_cache_get(cache, trigger_hosts.values[i].first);
+
+		zbx_vector_uint64_append(&trigger->hostids, trigger_hosts.values[i].second);
+	}
+
+	for (int i = 0; i < triggerids.values_num;)
+	{
+		if (0 != action_trigger_cache_get(cache, triggerids.values[i])->hostids.values_num)
+			zbx_vector_uint64_remove_noorder(&triggerids, i);
+		else
+			i++;
+	}
+
+	if (0 != triggerids.values_num)
+	{
+		char		*sql = NULL;
+		size_t		sql_alloc = 0, sql_offset = 0;
+		zbx_db_result_t	result;
+		zbx_db_row_t	row;
+
+		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+				"select distinct f.triggerid,i.hostid"
+				" from items i,functions f"
+				" where i.itemid=f.itemid"
+					" and");
+
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "f.triggerid", triggerids.values,
+				triggerids.values_num);
+
+		result = zbx_db_select("%s", sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_uint64_t	triggerid, hostid;
+
+			ZBX_STR2UINT64(triggerid, row[0]);
+			ZBX_STR2UINT64(hostid, row[1]);
+
+			zbx_vector_uint64_append(&action_trigger_cache_get(cache, triggerid)->hostids, hostid);
+		}
+		zbx_db_free_result(result);
+
+		zbx_free(sql);
+	}
+
+	zbx_vector_uint64_pair_destroy(&trigger_hosts);
+	zbx_vector_uint64_destroy(&triggerids);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: resolves templates escalation event triggers are inherited from   *
+ *                                                                            *
+ * Parameters: cache      - [IN/OUT] trigger hierarchy cache                  *
+ *             esc_events - [IN] trigger events                               *
+ *                                                                            *
+ * Comments: Discovered triggers are resolved through their prototypes. All   *
+ *           template levels are resolved once per event batch with one query *
+ *           per level, regardless of the number of template conditions.      *
+ *                                                                            *
+ ******************************************************************************/
+static void	action_trigger_cache_resolve_templates(zbx_action_trigger_cache_t *cache,
+		const zbx_vector_db_event_t *esc_events)
 {
 	char				*sql = NULL;
 	size_t				sql_alloc = 0;
 	zbx_db_result_t			result;
 	zbx_db_row_t			row;
-	zbx_uint64_t			condition_value;
-	zbx_vector_uint64_t		objectids;
-	zbx_vector_uint64_pair_t	objectids_pair;
+	zbx_vector_uint64_t		triggerids;
+	zbx_vector_uint64_pair_t	objectids_pair, objectids_pair_tmp, parents, parent_hosts;
+	zbx_hashset_iter_t		iter;
+	zbx_action_trigger_t		*trigger;
 
-	if (ZBX_CONDITION_OPERATOR_EQUAL != condition->op && ZBX_CONDITION_OPERATOR_NOT_EQUAL != condition->op)
-		return NOTSUPPORTED;
+	if (0 != (cache->flags & ZBX_ACTION_TRIGGER_CACHE_TEMPLATES))
+		return;
 
-	if (SUCCEED != zbx_is_uint64(condition->value, &condition_value))
-		return NOTSUPPORTED;
+	cache->flags |= ZBX_ACTION_TRIGGER_CACHE_TEMPLATES;
 
-	zbx_vector_uint64_create(&objectids);
+	zbx_vector_uint64_create(&triggerids);
 	zbx_vector_uint64_pair_create(&objectids_pair);
+	zbx_vector_uint64_pair_create(&objectids_pair_tmp);
+	zbx_vector_uint64_pair_create(&parents);
+	zbx_vector_uint64_pair_create(&parent_hosts);
 
-	get_object_ids(esc_events, &objectids);
-	objectids_to_pair(&objectids, &objectids_pair);
+	get_object_ids(esc_events, &triggerids);
+	objectids_to_pair(&triggerids, &objectids_pair);
 
-	trigger_parents_sql_alloc(&sql, &sql_alloc, &objectids);
+	trigger_parents_sql_alloc(&sql, &sql_alloc, &triggerids);
 
 	result = zbx_db_select("%s", sql);
 
@@ -436,23 +525,210 @@ static int	check_host_template_condition(const zbx_vector_db_event_t *esc_events
 
 		ZBX_STR2UINT64(pair.first, row[0]);
 
-		if (FAIL != (i = zbx_vector_uint64_pair_search(&objectids_pair, pair, ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
+		if (FAIL != (i = zbx_vector_uint64_pair_bsearch(&objectids_pair, pair, ZBX_DEFAULT_UINT64_COMPARE_FUNC)))
 			ZBX_STR2UINT64(objectids_pair.values[i].second, row[1]);
 	}
 	zbx_db_free_result(result);
 
-	check_object_hierarchy(EVENT_OBJECT_TRIGGER, esc_events, &objectids, &objectids_pair, condition,
-			condition_value,
-			"select distinct t.triggerid,t.templateid,i.hostid"
+	/* objectids_pair contains (event triggerid, triggerid which parents must be resolved) pairs */
+	while (0 != objectids_pair.values_num)
+	{
+		size_t	sql_offset = 0;
+
+		zbx_vector_uint64_clear(&triggerids);
+
+		for (int i = 0; i < objectids_pair.values_num; i++)
+			zbx_vector_uint64_append(&triggerids, objectids_pair.values[i].second);
+
+		zbx_vector_uint64_sort(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&triggerids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset,
+				"select distinct t.triggerid,t.templateid,i.hostid"
 				" from items i,functions f,triggers t"
 				" where i.itemid=f.itemid"
 					" and f.triggerid=t.templateid"
-					" and",
-			"t.triggerid");
+					" and");
 
-	zbx_vector_uint64_destroy(&objectids);
+		zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "t.triggerid", triggerids.values,
+				triggerids.values_num);
+
+		result = zbx_db_select("%s", sql);
+
+		while (NULL != (row = zbx_db_fetch(result)))
+		{
+			zbx_uint64_pair_t	parent, parent_host;
+
+			ZBX_STR2UINT64(parent.first, row[0]);
+			ZBX_STR2UINT64(parent.second, row[1]);
+			ZBX_STR2UINT64(parent_host.second, row[2]);
+			parent_host.first = parent.first;
+
+			zbx_vector_uint64_pair_append(&parents, parent);
+			zbx_vector_uint64_pair_append(&parent_hosts, parent_host);
+		}
+		zbx_db_free_result(result);
+
+		zbx_vector_uint64_pair_sort(&parents, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+		zbx_vector_uint64_pair_uniq(&parents, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+		zbx_vector_uint64_pair_sort(&parent_hosts, ZBX_DEFAULT_UINT64_PAIR_COMPARE_FUNC);
+
+		/* record template hosts of this level and continue with parent triggers in the next one */
+		for (int i = 0; i < objectids_pair.values_num; i++)
+		{
+			zbx_uint64_pair_t	*pair = &objectids_pair.values[i];
+			int			j;
+
+			j = uint64_pair_lower_bound(&parent_hosts, pair->second);
+
+			if (j == parent_hosts.values_num || parent_hosts.values[j].first != pair->second)
+				continue;
+
+			trigger = action_trigger_cache_get(cache, pair->first);
+
+			for (; j < parent_hosts.values_num && parent_hosts.values[j].first == pair->second; j++)
+				zbx_vector_uint64_append(&trigger->templateids, parent_hosts.values[j].second);
+
+			for (j = uint64_pair_lower_bound(&parents, pair->second);
+					j < parents.values_num && parents.values[j].first == pair->second; j++)
+			{
+				zbx_uint64_pair_t	next = {pair->first, parents.values[j].second};
+
+				zbx_vector_uint64_pair_append(&objectids_pair_tmp, next);
+			}
+		}
+
+		zbx_vector_uint64_pair_clear(&objectids_pair);
+		zbx_vector_uint64_pair_append_array(&objectids_pair, objectids_pair_tmp.values,
+				objectids_pair_tmp.values_num);
+		zbx_vector_uint64_pair_clear(&objectids_pair_tmp);
+
+		zbx_vector_uint64_pair_clear(&parents);
+		zbx_vector_uint64_pair_clear(&parent_hosts);
+	}
+
+	zbx_hashset_iter_reset(&cache->triggers, &iter);
+
+	while (NULL != (trigger = (zbx_action_trigger_t *)zbx_hashset_iter_next(&iter)))
+	{
+		zbx_vector_uint64_sort(&trigger->templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(&trigger->templateids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+
+	zbx_vector_uint64_pair_destroy(&parent_hosts);
+	zbx_vector_uint64_pair_destroy(&parents);
+	zbx_vector_uint64_pair_destroy(&objectids_pair_tmp);
 	zbx_vector_uint64_pair_destroy(&objectids_pair);
+	zbx_vector_uint64_destroy(&triggerids);
 	zbx_free(sql);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Parameters: esc_events - [IN] events to check                              *
+ *             condition  - [IN/OUT] Condition for matching, outputs          *
+ *                                   event ids that match condition.          *
+ *             cache      - [IN/OUT] trigger hierarchy cache                  *
+ *                                                                            *
+ * Return value: SUCCEED - supported operator                                 *
+ *               NOTSUPPORTED - not supported operator                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	check_host_group_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition,
+		zbx_action_trigger_cache_t *cache)
+{
+	zbx_vector_uint64_t	objectids, hostids;
+	zbx_uint64_t		condition_value;
+
+	if (ZBX_CONDITION_OPERATOR_EQUAL != condition->op && ZBX_CONDITION_OPERATOR_NOT_EQUAL != condition->op)
+		return NOTSUPPORTED;
+
+	if (SUCCEED != zbx_is_uint64(condition->value, &condition_value))
+		return NOTSUPPORTED;
+
+	zbx_vector_uint64_create(&objectids);
+	zbx_vector_uint64_create(&hostids);
+
+	action_trigger_cache_resolve_hosts(cache, esc_events);
+
+	get_object_ids(esc_events, &objectids);
+	zbx_dc_get_hostids_by_groupids(&condition_value, 1, &hostids);
+
+	for (int i = 0; i < objectids.values_num; i++)
+	{
+		const zbx_action_trigger_t	*trigger;
+		int				ret = FAIL;
+
+		if (NULL != (trigger = (const zbx_action_trigger_t *)zbx_hashset_search(&cache->triggers,
+				&objectids.values[i])))
+		{
+			for (int j = 0; j < trigger->hostids.values_num; j++)
+			{
+				if (FAIL != zbx_vector_uint64_bsearch(&hostids, trigger->hostids.values[j],
+						ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+				{
+					ret = SUCCEED;
+					break;
+				}
+			}
+		}
+
+		if ((ZBX_CONDITION_OPERATOR_EQUAL == condition->op) == (SUCCEED == ret))
+			add_condition_match(esc_events, condition, objectids.values[i], EVENT_OBJECT_TRIGGER);
+	}
+
+	zbx_vector_uint64_destroy(&hostids);
+	zbx_vector_uint64_destroy(&objectids);
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Parameters: esc_events - [IN] events to check                              *
+ *             condition  - [IN/OUT] Condition for matching, outputs          *
+ *                                   event ids that match condition.          *
+ *             cache      - [IN/OUT] trigger hierarchy cache                  *
+ *                                                                            *
+ * Return value: SUCCEED - supported operator                                 *
+ *               NOTSUPPORTED - not supported operator                        *
+ *                                                                            *
+ ******************************************************************************/
+static int	check_host_template_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition,
+		zbx_action_trigger_cache_t *cache)
+{
+	zbx_uint64_t		condition_value;
+	zbx_vector_uint64_t	objectids;
+
+	if (ZBX_CONDITION_OPERATOR_EQUAL != condition->op && ZBX_CONDITION_OPERATOR_NOT_EQUAL != condition->op)
+		return NOTSUPPORTED;
+
+	if (SUCCEED != zbx_is_uint64(condition->value, &condition_value))
+		return NOTSUPPORTED;
+
+	zbx_vector_uint64_create(&objectids);
+
+	action_trigger_cache_resolve_templates(cache, esc_events);
+
+	get_object_ids(esc_events, &objectids);
+
+	for (int i = 0; i < objectids.values_num; i++)
+	{
+		const zbx_action_trigger_t	*trigger;
+		int				ret = FAIL;
+
+		if (NULL != (trigger = (const zbx_action_trigger_t *)zbx_hashset_search(&cache->triggers,
+				&objectids.values[i])) && FAIL != zbx_vector_uint64_bsearch(&trigger->templateids,
+				condition_value, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+		{
+			ret = SUCCEED;
+		}
+
+		if ((ZBX_CONDITION_OPERATOR_EQUAL == condition->op) == (SUCCEED == ret))
+			add_condition_match(esc_events, condition, objectids.values[i], EVENT_OBJECT_TRIGGER);
+	}
+
+	zbx_vector_uint64_destroy(&objectids);
 
 	return SUCCEED;
 }
@@ -865,11 +1141,13 @@ static void	check_condition_event_tag_value(const zbx_vector_db_event_t *esc_eve
  * Parameters: esc_event - [IN] trigger events to check                       *
  *                              (event->source == EVENT_SOURCE_TRIGGERS)      *
  *             condition - [IN] condition for matching                        *
+ *             cache     - [IN/OUT] trigger hierarchy cache                   *
  *                                                                            *
  * Return value: SUCCEED - matches, FAIL - otherwise                          *
  *                                                                            *
  ******************************************************************************/
-static void	check_trigger_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition)
+static void	check_trigger_condition(const zbx_vector_db_event_t *esc_events, zbx_condition_t *condition,
+		zbx_action_trigger_cache_t *cache)
 {
 	int	ret;
 
@@ -878,10 +1156,10 @@ static void	check_trigger_condition(const zbx_vector_db_event_t *esc_events, zbx
 	switch (condition->conditiontype)
 	{
 		case ZBX_CONDITION_TYPE_HOST_GROUP:
-			ret = check_host_group_condition(esc_events, condition);
+			ret = check_host_group_condition(esc_events, condition, cache);
 			break;
 		case ZBX_CONDITION_TYPE_HOST_TEMPLATE:
-			ret = check_host_template_condition(esc_events, condition);
+			ret = check_host_template_condition(esc_events, condition, cache);
 			break;
 		case ZBX_CONDITION_TYPE_HOST:
 			ret = check_host_condition(esc_events, condition);
@@ -2663,9 +2941,12 @@ static void	check_internal_condition(const zbx_vector_db_event_t *esc_events, zb
  *             source     - [IN] specific event source that needs checking    *
  *             condition  - [IN/OUT] Condition for matching, outputs          *
  *                                   event ids that match condition.          *
+ *             cache      - [IN/OUT] trigger hierarchy cache, shared by       *
+ *                                   conditions of the same events            *
  *                                                                            *
  ******************************************************************************/
-static void	check_events_condition(const zbx_vector_db_event_t *esc_events, int source, zbx_condition_t *condition)
+static void	check_events_condition(const zbx_vector_db_event_t *esc_events, int source, zbx_condition_t *condition,
+		zbx_action_trigger_cache_t *cache)
 {
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() actionid:" ZBX_FS_UI64 " conditionid:" ZBX_FS_UI64 " cond.value:'%s'"
 			" cond.value2:'%s'", __func__, condition->actionid, condition->conditionid,
@@ -2674,7 +2955,7 @@ static void	check_events_condition(const zbx_vector_db_event_t *esc_events, int
 	switch (source)
 	{
 		case EVENT_SOURCE_TRIGGERS:
-			check_trigger_condition(esc_events, condition);
+			check_trigger_condition(esc_events, condition, cache);
 			break;
 		case EVENT_SOURCE_DISCOVERY:
 			check_discovery_condition(esc_events, condition);
@@ -2706,8 +2987,9 @@ static void	check_events_condition(const zbx_vector_db_event_t *esc_events, int
  ******************************************************************************/
 int	check_action_condition(zbx_db_event *event, zbx_condition_t *condition)
 {
-	int			ret;
-	zbx_vector_db_event_t	esc_events;
+	int				ret;
+	zbx_vector_db_event_t		esc_events;
+	zbx_action_trigger_cache_t	cache;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() actionid:" ZBX_FS_UI64 " conditionid:" ZBX_FS_UI64 " cond.value:'%s'"
 			" cond.value2:'%s'", __func__, condition->actionid, condition->conditionid,
@@ -2716,11 +2998,13 @@ int	check_action_condition(zbx_db_event *event, zbx_condition_t *condition)
 	zbx_vector_db_event_create(&esc_events);
 
 	zbx_vector_db_event_append(&esc_events, event);
+	action_trigger_cache_init(&cache);
 
-	check_events_condition(&esc_events, event->source, condition);
+	check_events_condition(&esc_events, event->source, condition, &cache);
 
 	ret = 0 != condition->eventids.values_num ? SUCCEED : FAIL;
 
+	action_trigger_cache_destroy(&cache);
 	zbx_vector_db_event_destroy(&esc_events);
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
@@ -3277,6 +3561,84 @@ static void	prepare_actions_conditions_eval(zbx_vector_action_eval_ptr_t *action
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: checks if action can match any of the evaluated events            *
+ *                                                                            *
+ * Parameters: action - [IN] action with evaluated conditions                 *
+ *                                                                            *
+ * Return value: SUCCEED - action can match some events                       *
+ *               FAIL    - action conditions cannot be satisfied by any event *
+ *                                                                            *
+ * Comments: Custom expressions can negate conditions, so such actions are    *
+ *           always considered as matching.                                   *
+ *                                                                            *
+ ******************************************************************************/
+static int	action_can_match(const zbx_action_eval_t *action)
+{
+	int	matched_num = 0;
+
+	if (ZBX_CONDITION_EVAL_TYPE_EXPRESSION == action->evaltype)
+		return SUCCEED;
+
+	for (int i = 0; i < action->conditions.values_num; i++)
+	{
+		const zbx_condition_t	*condition = action->conditions.values[i];
+
+		if (0 != condition->eventids.values_num)
+			matched_num++;
+
+		if (ZBX_CONDITION_EVAL_TYPE_OR == action->evaltype)
+			continue;
+
+		/* conditions of the same type are sorted together and form OR block for and/or evaluation */
+		if (ZBX_CONDITION_EVAL_TYPE_AND_OR == action->evaltype && i + 1 < action->conditions.values_num &&
+				action->conditions.values[i + 1]->conditiontype == condition->conditiontype)
+		{
+			continue;
+		}
+
+		if (0 == matched_num)
+			return FAIL;
+
+		matched_num = 0;
+	}
+
+	if (ZBX_CONDITION_EVAL_TYPE_OR == action->evaltype && 0 != action->conditions.values_num && 0 == matched_num)
+		return FAIL;
+
+	return SUCCEED;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes actions that cannot match any of the evaluated events     *
+ *                                                                            *
+ * Parameters: actions - [IN/OUT] actions with evaluated conditions           *
+ *                                                                            *
+ * Comments: Conditions are evaluated for all events of a batch at once, so   *
+ *           actions failing for every event are dropped before matching      *
+ *           events to actions one by one.                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	prune_actions(zbx_vector_action_eval_ptr_t *actions)
+{
+	for (int i = 0; i < actions->values_num;)
+	{
+		if (SUCCEED == action_can_match(actions->values[i]))
+		{
+			i++;
+			continue;
+		}
+
+		zabbix_log(LOG_LEVEL_DEBUG, "%s() actionid:" ZBX_FS_UI64 " cannot match any event", __func__,
+				actions->values[i]->actionid);
+
+		zbx_action_eval_free(actions->values[i]);
+		zbx_vector_action_eval_ptr_remove(actions, i);
+	}
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes all actions of each event in list                       *
@@ -3297,6 +3659,7 @@ void	process_actions(zbx_vector_db_event_t *events, const zbx_vector_uint64_pair
 	zbx_hashset_iter_t		iter;
 	zbx_condition_t			*condition;
 	zbx_dc_um_handle_t		*um_handle;
+	zbx_action_trigger_cache_t	cache;
 	zbx_vector_escalation_new_ptr_t *new_escalations = escalations, local_escalations, local_rec_escalations;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() events_num:" ZBX_FS_SIZE_T, __func__, (zbx_fs_size_t)events->values_num);
@@ -3329,13 +3692,18 @@ void	process_actions(zbx_vector_db_event_t *events, const zbx_vector_uint64_pair
 			continue;
 
 		zbx_vector_db_event_sort(&esc_events[i], compare_events);
+		action_trigger_cache_init(&cache);
 
 		zbx_hashset_iter_reset(&uniq_conditions[i], &iter);
 
 		while (NULL != (condition = (zbx_condition_t *)zbx_hashset_iter_next(&iter)))
-			check_events_condition(&esc_events[i], i, condition);
+			check_events_condition(&esc_events[i], i, condition, &cache);
+
+		action_trigger_cache_destroy(&cache);
 	}
 
+	prune_actions(&actions);
+
 	zbx_dc_close_user_macros(um_handle);
 
 	/* 1. All event sources: match PROBLEM events to action conditions, add them to 'new_escalations' list.      */
@@ -3578,6 +3946,7 @@ int	process_actions_by_acknowledgments(const zbx_vector_ack_task_ptr_t *ack_task
 	zbx_hashset_iter_t		iter;
 	zbx_condition_t			*condition;
 	zbx_dc_um_handle_t		*um_handle;
+	zbx_action_trigger_cache_t	cache;
 	zbx_vector_db_event_t		events;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
@@ -3627,13 +3996,18 @@ int	process_actions_by_acknowledgments(const zbx_vector_ack_task_ptr_t *ack_task
 			continue;
 
 		zbx_vector_db_event_sort(&esc_events[i], compare_events);
+		action_trigger_cache_init(&cache);
 
 		zbx_hashset_iter_reset(&uniq_conditions[i], &iter);
 
 		while (NULL != (condition = (zbx_condition_t *)zbx_hashset_iter_next(&iter)))
-			check_events_condition(&esc_events[i], i, condition);
+			check_events_condition(&esc_events[i], i, condition, &cache);
+
+		action_trigger_cache_destroy(&cache);
 	}
 
+	prune_actions(&actions);
+
 	zbx_dc_close_user_macros(um_handle);
 
 	for (int i = 0; i < eventids.values_num; i++)
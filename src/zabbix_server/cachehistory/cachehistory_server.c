@@ -1529,18 +1529,14 @@ void	zbx_sync_history_cache_server(const zbx_events_funcs_t *events_cbs, zbx_ipc
 
 		stats->more = ZBX_SYNC_DONE;
 
-		zbx_dbcache_lock();
 		zbx_hc_pop_items(&history_items);		/* select and take items out of history cache */
-		zbx_dbcache_unlock();
 
 		if (0 != history_items.values_num)
 		{
 			if (0 == (history_num = zbx_dc_config_lock_triggers_by_history_items(&history_items,
 					&triggerids)))
 			{
-				zbx_dbcache_lock();
 				zbx_hc_push_items(&history_items);
-				zbx_dbcache_unlock();
 				zbx_vector_hc_item_ptr_clear(&history_items);
 			}
 		}
@@ -1783,9 +1779,7 @@ void	zbx_sync_history_cache_server(const zbx_events_funcs_t *events_cbs, zbx_ipc
 
 		if (0 != history_num)
 		{
-			zbx_dbcache_lock();
 			zbx_hc_push_items(&history_items);	/* return items to history cache */
-			zbx_dbcache_set_history_num(zbx_dbcache_get_history_num() - history_num);
 
 			if (0 != zbx_hc_queue_get_size())
 			{
@@ -1797,8 +1791,6 @@ void	zbx_sync_history_cache_server(const zbx_events_funcs_t *events_cbs, zbx_ipc
 				if (ZBX_HC_SYNC_MIN_PCNT <= history_num * 100 / history_items.values_num)
 					stats->more = ZBX_SYNC_MORE;
 			}
-
-			zbx_dbcache_unlock();
 		}
 
 		if (FAIL != ret)
@@ -27,9 +27,11 @@
 
 #define ZBX_DIAG_LLD_RULES		0x00000001
 #define ZBX_DIAG_LLD_VALUES		0x00000002
+#define ZBX_DIAG_LLD_STATEMENTS		0x00000004
 
 #define ZBX_DIAG_LLD_SIMPLE		(ZBX_DIAG_LLD_RULES | \
-					ZBX_DIAG_LLD_VALUES)
+					ZBX_DIAG_LLD_VALUES | \
+					ZBX_DIAG_LLD_STATEMENTS)
 
 #define ZBX_DIAG_ALERTING_ALERTS	0x00000001
 
@@ -260,6 +262,7 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 							{"", ZBX_DIAG_LLD_SIMPLE},
 							{"rules", ZBX_DIAG_LLD_RULES},
 							{"values", ZBX_DIAG_LLD_VALUES},
+							{"statements", ZBX_DIAG_LLD_STATEMENTS},
 							{NULL, 0}
 						};
 
@@ -271,10 +274,10 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 
 		if (0 != (fields & ZBX_DIAG_LLD_SIMPLE))
 		{
-			zbx_uint64_t	values_num, items_num;
+			zbx_uint64_t	values_num, items_num, statements_num;
 
 			time1 = zbx_time();
-			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, error)))
+			if (FAIL == (ret = zbx_lld_get_diag_stats(&items_num, &values_num, &statements_num, error)))
 				goto out;
 			time2 = zbx_time();
 			time_total += time2 - time1;
@@ -283,6 +286,8 @@ static int	diag_add_lld_info(const struct zbx_json_parse *jp, struct zbx_json *j
 				zbx_json_addint64(json, "rules", items_num);
 			if (0 != (fields & ZBX_DIAG_LLD_VALUES))
 				zbx_json_addint64(json, "values", values_num);
+			if (0 != (fields & ZBX_DIAG_LLD_STATEMENTS))
+				zbx_json_adduint64(json, "statements", statements_num);
 		}
 
 		if (0 != tops.values_num)
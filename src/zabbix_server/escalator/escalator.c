@@ -2941,6 +2941,149 @@ static void	escalation_update_diff(const zbx_db_escalation *escalation, zbx_esca
 	}
 }
 
+/* in-memory timer of escalation step */
+typedef struct
+{
+	zbx_uint64_t	escalationid;
+	int		nextcheck;
+	unsigned int	source;
+}
+zbx_escalation_timer_t;
+
+/* Schedule of escalations handled by escalator. The escalations table is scanned once per     */
+/* CONFIG_ESCALATOR_FREQUENCY seconds and the escalations becoming due before the next scan,   */
+/* as well as the escalations postponed by escalator itself, are kept in schedule. Between the */
+/* scans scheduled escalations are dispatched by their identifiers exactly when they are due.  */
+typedef struct
+{
+	zbx_hashset_t		timers;
+	zbx_binary_heap_t	queue;
+
+	/* the time of the last escalations table scan */
+	int			scan_time;
+}
+zbx_escalation_schedule_t;
+
+static int	escalation_timer_compare_func(const void *d1, const void *d2)
+{
+	const zbx_binary_heap_elem_t	*e1 = (const zbx_binary_heap_elem_t *)d1;
+	const zbx_binary_heap_elem_t	*e2 = (const zbx_binary_heap_elem_t *)d2;
+	const zbx_escalation_timer_t	*timer1 = (const zbx_escalation_timer_t *)e1->data;
+	const zbx_escalation_timer_t	*timer2 = (const zbx_escalation_timer_t *)e2->data;
+
+	ZBX_RETURN_IF_NOT_EQUAL(timer1->nextcheck, timer2->nextcheck);
+
+	return 0;
+}
+
+static void	escalation_schedule_init(zbx_escalation_schedule_t *schedule)
+{
+	zbx_hashset_create(&schedule->timers, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_binary_heap_create(&schedule->queue, escalation_timer_compare_func, ZBX_BINARY_HEAP_OPTION_DIRECT);
+	schedule->scan_time = 0;
+}
+
+static void	escalation_schedule_destroy(zbx_escalation_schedule_t *schedule)
+{
+	zbx_binary_heap_destroy(&schedule->queue);
+	zbx_hashset_destroy(&schedule->timers);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: schedules escalation to be processed at the specified time        *
+ *                                                                            *
+ * Parameters: schedule     - [IN/OUT]                                        *
+ *             escalationid - [IN]                                            *
+ *             source       - [IN] ZBX_ESCALATION_SOURCE_* escalation source  *
+ *             nextcheck    - [IN] time when escalation must be processed     *
+ *                                                                            *
+ * Comments: Already scheduled escalation is rescheduled to the new time.     *
+ *                                                                            *
+ ******************************************************************************/
+static void	escalation_schedule_set(zbx_escalation_schedule_t *schedule, zbx_uint64_t escalationid,
+		unsigned int source, int nextcheck)
+{
+	zbx_escalation_timer_t	*timer, timer_local;
+	zbx_binary_heap_elem_t	elem;
+
+	if (NULL != (timer = (zbx_escalation_timer_t *)zbx_hashset_search(&schedule->timers, &escalationid)))
+	{
+		if (timer->nextcheck == nextcheck)
+			return;
+
+		timer->nextcheck = nextcheck;
+		elem.key = escalationid;
+		elem.data = (void *)timer;
+		zbx_binary_heap_update_direct(&schedule->queue, &elem);
+
+		return;
+	}
+
+	timer_local.escalationid = escalationid;
+	timer_local.nextcheck = nextcheck;
+	timer_local.source = source;
+
+	timer = (zbx_escalation_timer_t *)zbx_hashset_insert(&schedule->timers, &timer_local, sizeof(timer_local));
+	elem.key = escalationid;
+	elem.data = (void *)timer;
+	zbx_binary_heap_insert(&schedule->queue, &elem);
+}
+
+static void	escalation_schedule_remove(zbx_escalation_schedule_t *schedule, zbx_uint64_t escalationid)
+{
+	if (NULL == zbx_hashset_search(&schedule->timers, &escalationid))
+		return;
+
+	zbx_binary_heap_remove_direct(&schedule->queue, escalationid);
+	zbx_hashset_remove(&schedule->timers, &escalationid);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes due escalations from schedule                             *
+ *                                                                            *
+ * Parameters: schedule - [IN/OUT]                                            *
+ *             now      - [IN] current time                                   *
+ *             due      - [OUT] escalation identifier and source pairs        *
+ *                                                                            *
+ ******************************************************************************/
+static void	escalation_schedule_pop(zbx_escalation_schedule_t *schedule, int now, zbx_vector_uint64_pair_t *due)
+{
+	while (FAIL == zbx_binary_heap_empty(&schedule->queue))
+	{
+		zbx_binary_heap_elem_t	*elem = zbx_binary_heap_find_min(&schedule->queue);
+		zbx_escalation_timer_t	*timer = (zbx_escalation_timer_t *)elem->data;
+		zbx_uint64_pair_t	pair;
+
+		if (timer->nextcheck > now)
+			break;
+
+		pair.first = timer->escalationid;
+		pair.second = timer->source;
+		zbx_vector_uint64_pair_append(due, pair);
+
+		zbx_binary_heap_remove_min(&schedule->queue);
+		zbx_hashset_remove(&schedule->timers, &pair.first);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: gets time of the next scheduled escalation                        *
+ *                                                                            *
+ * Return value: the time of the next scheduled escalation or FAIL if         *
+ *               schedule is empty                                            *
+ *                                                                            *
+ ******************************************************************************/
+static int	escalation_schedule_nextcheck(const zbx_escalation_schedule_t *schedule)
+{
+	if (SUCCEED == zbx_binary_heap_empty(&schedule->queue))
+		return FAIL;
+
+	return ((const zbx_escalation_timer_t *)zbx_binary_heap_find_min(&schedule->queue)->data)->nextcheck;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: Checks if acknowledgment events of current escalation has related *
@@ -3213,7 +3356,8 @@ static void	service_role_clean_wrapper(void *data)
 	service_role_clean((zbx_service_role_t*)data);
 }
 
-static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalation_ptr_t *escalations,
+static int	process_db_escalations(int now, int *nextcheck, zbx_escalation_schedule_t *schedule,
+		unsigned int escalation_source, zbx_vector_db_escalation_ptr_t *escalations,
 		zbx_vector_uint64_t *eventids, zbx_vector_uint64_t *problem_eventids, zbx_vector_uint64_t *actionids,
 		const char *default_timezone, int config_timeout, int config_trapper_timeout,
 		const char *config_source_ip, const char *config_ssh_key_location,
@@ -3521,6 +3665,9 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalat
 
 				if (diff->nextcheck < *nextcheck)
 					*nextcheck = diff->nextcheck;
+
+				escalation_schedule_set(schedule, diff->escalationid, escalation_source,
+						diff->nextcheck);
 			}
 
 			if (0 != (diff->flags & ZBX_DIFF_ESCALATION_UPDATE_ESC_STEP))
@@ -3552,6 +3699,9 @@ static int	process_db_escalations(int now, int *nextcheck, zbx_vector_db_escalat
 	{
 		zbx_vector_uint64_sort(&escalationids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 		zbx_db_execute_multiple_query("delete from escalations where", "escalationid", &escalationids);
+
+		for (int i = 0; i < escalationids.values_num; i++)
+			escalation_schedule_remove(schedule, escalationids.values[i]);
 	}
 
 	zbx_db_commit();
@@ -3598,6 +3748,7 @@ out:
  *                                                                              *
  * Parameters: now                     - [IN] current time                      *
  *             nextcheck               - [IN/OUT] time of next invocation       *
+ *             schedule                - [IN/OUT] escalation schedule           *
  *             escalation_source       - [IN] type of escalations to be handled *
  *             default_timezone        - [IN]                                   *
  *             process_num             - [IN] process number                    *
@@ -3607,7 +3758,8 @@ out:
  *             config_ssh_key_location - [IN]                                   *
  *             get_config_forks        - [IN]                                   *
  *             program_type            - [IN]                                   *
- *             escalationids           - [IN]                                   *
+ *             escalationids           - [IN] escalations to process instead of *
+ *                                       scanning escalations table (optional)  *
  *                                                                              *
  * Return value: count of deleted escalations                                   *
  *                                                                              *
@@ -3618,7 +3770,8 @@ out:
  *           in process_actions().                                              *
  *                                                                              *
  ********************************************************************************/
-static int	process_escalations(int now, int *nextcheck, unsigned int escalation_source,
+static int	process_escalations(int now, int *nextcheck, zbx_escalation_schedule_t *schedule,
+		unsigned int escalation_source,
 		const char *default_timezone, int process_num, int config_timeout, int config_trapper_timeout,
 		const char *config_source_ip, const char *config_ssh_key_location,
 		zbx_get_config_forks_f get_config_forks, int config_enable_global_scripts, unsigned char program_type,
@@ -3727,12 +3880,17 @@ static int	process_escalations(int now, int *nextcheck, unsigned int escalation_
 
 		esc_nextcheck = atoi(row[5]);
 
-		/* skip escalations that must be checked in next CONFIG_ESCALATOR_FREQUENCY period */
+		/* schedule escalations that must be checked in next CONFIG_ESCALATOR_FREQUENCY period */
 		if (esc_nextcheck > now)
 		{
+			zbx_uint64_t	escalationid;
+
 			if (esc_nextcheck < *nextcheck)
 				*nextcheck = esc_nextcheck;
 
+			ZBX_STR2UINT64(escalationid, row[0]);
+			escalation_schedule_set(schedule, escalationid, escalation_source, esc_nextcheck);
+
 			continue;
 		}
 
@@ -3760,9 +3918,10 @@ static int	process_escalations(int now, int *nextcheck, unsigned int escalation_
 
 		if (ZBX_ESCALATIONS_PER_STEP <= escalations.values_num)
 		{
-			ret += process_db_escalations(now, nextcheck, &escalations, &eventids, &problem_eventids,
-					&actionids, default_timezone, config_timeout, config_trapper_timeout,
-					config_source_ip, config_ssh_key_location, get_config_forks, config_enable_global_scripts, program_type);
+			ret += process_db_escalations(now, nextcheck, schedule, escalation_source, &escalations,
+					&eventids, &problem_eventids, &actionids, default_timezone, config_timeout,
+					config_trapper_timeout, config_source_ip, config_ssh_key_location,
+					get_config_forks, config_enable_global_scripts, program_type);
 			zbx_vector_db_escalation_ptr_clear_ext(&escalations, db_escalation_free);
 			zbx_vector_uint64_clear(&actionids);
 			zbx_vector_uint64_clear(&eventids);
@@ -3775,9 +3934,10 @@ static int	process_escalations(int now, int *nextcheck, unsigned int escalation_
 
 	if (0 < escalations.values_num)
 	{
-		ret += process_db_escalations(now, nextcheck, &escalations, &eventids, &problem_eventids,
-				&actionids, default_timezone, config_timeout, config_trapper_timeout,
-				config_source_ip, config_ssh_key_location, get_config_forks, config_enable_global_scripts, program_type);
+		ret += process_db_escalations(now, nextcheck, schedule, escalation_source, &escalations,
+				&eventids, &problem_eventids, &actionids, default_timezone, config_timeout,
+				config_trapper_timeout, config_source_ip, config_ssh_key_location, get_config_forks,
+				config_enable_global_scripts, program_type);
 		zbx_vector_db_escalation_ptr_clear_ext(&escalations, db_escalation_free);
 	}
 
@@ -3810,7 +3970,9 @@ static	void deserialize_escalationids(zbx_vector_uint64_t *escalationids, const
  *                                                                            *
  * Purpose: periodically checks table escalations and generates alerts        *
  *                                                                            *
- * Comments: never returns                                                    *
+ * Comments: Escalations table is scanned once per CONFIG_ESCALATOR_FREQUENCY *
+ *           seconds. Between the scans only the scheduled and notified       *
+ *           escalations are processed. Never returns.                        *
  *                                                                            *
  ******************************************************************************/
 ZBX_THREAD_ENTRY(escalator_thread, args)
@@ -3831,7 +3993,12 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 	zbx_ipc_async_socket_t		rtc;
 	zbx_ipc_socket_t		alerter;
 	char				*error = NULL;
-	zbx_vector_uint64_t		escalationids;
+	zbx_vector_uint64_t		escalationids, source_escalationids;
+	zbx_vector_uint64_pair_t	due_escalations;
+	zbx_escalation_schedule_t	schedule;
+	unsigned int			escalation_sources[] = {ZBX_ESCALATION_SOURCE_TRIGGER,
+							ZBX_ESCALATION_SOURCE_ITEM, ZBX_ESCALATION_SOURCE_SERVICE,
+							ZBX_ESCALATION_SOURCE_DEFAULT};
 
 	zabbix_log(LOG_LEVEL_INFORMATION, "%s #%d started [%s #%d]", get_program_type_string(info->program_type),
 			server_num, get_process_type_string(process_type), process_num);
@@ -3860,10 +4027,13 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 			&rtc);
 
 	zbx_vector_uint64_create(&escalationids);
+	zbx_vector_uint64_create(&source_escalationids);
+	zbx_vector_uint64_pair_create(&due_escalations);
+	escalation_schedule_init(&schedule);
 
 	while (ZBX_IS_RUNNING())
 	{
-		int			now, nextcheck;
+		int			now, nextcheck, schedule_nextcheck;
 		double			sec;
 		zbx_config_t		cfg;
 		zbx_uint32_t		rtc_cmd;
@@ -3883,28 +4053,78 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 
 		zbx_config_get(&cfg, ZBX_CONFIG_FLAGS_DEFAULT_TIMEZONE);
 
-		nextcheck = time(NULL) + CONFIG_ESCALATOR_FREQUENCY;
-		escalations_count += process_escalations(time(NULL), &nextcheck, ZBX_ESCALATION_SOURCE_TRIGGER,
-				cfg.default_timezone, process_num, escalator_args_in->config_timeout,
-				escalator_args_in->config_trapper_timeout, escalator_args_in->config_source_ip,
-				escalator_args_in->config_ssh_key_location, escalator_args_in->get_process_forks_cb_arg,
-				escalator_args_in->config_enable_global_scripts, info->program_type, &escalationids);
-		escalations_count += process_escalations(time(NULL), &nextcheck, ZBX_ESCALATION_SOURCE_ITEM,
-				cfg.default_timezone, process_num, escalator_args_in->config_timeout,
-				escalator_args_in->config_trapper_timeout, escalator_args_in->config_source_ip,
-				escalator_args_in->config_ssh_key_location, escalator_args_in->get_process_forks_cb_arg,
-				escalator_args_in->config_enable_global_scripts, info->program_type, NULL);
-		escalations_count += process_escalations(time(NULL), &nextcheck, ZBX_ESCALATION_SOURCE_SERVICE,
-				cfg.default_timezone, process_num, escalator_args_in->config_timeout,
-				escalator_args_in->config_trapper_timeout, escalator_args_in->config_source_ip,
-				escalator_args_in->config_ssh_key_location, escalator_args_in->get_process_forks_cb_arg,
-				escalator_args_in->config_enable_global_scripts, info->program_type, NULL);
-		escalations_count += process_escalations(time(NULL), &nextcheck, ZBX_ESCALATION_SOURCE_DEFAULT,
-				cfg.default_timezone, process_num, escalator_args_in->config_timeout,
-				escalator_args_in->config_trapper_timeout, escalator_args_in->config_source_ip,
-				escalator_args_in->config_ssh_key_location, escalator_args_in->get_process_forks_cb_arg,
-				escalator_args_in->config_enable_global_scripts, info->program_type, NULL);
+		now = (int)time(NULL);
+		escalation_schedule_pop(&schedule, now, &due_escalations);
+
+		if (CONFIG_ESCALATOR_FREQUENCY <= now - schedule.scan_time)
+		{
+			/* the scan also picks up due scheduled and notified escalations */
+			schedule.scan_time = now;
+			nextcheck = now + CONFIG_ESCALATOR_FREQUENCY;
+
+			for (int i = 0; i < (int)ARRSIZE(escalation_sources); i++)
+			{
+				escalations_count += process_escalations(now, &nextcheck, &schedule,
+						escalation_sources[i], cfg.default_timezone, process_num,
+						escalator_args_in->config_timeout,
+						escalator_args_in->config_trapper_timeout,
+						escalator_args_in->config_source_ip,
+						escalator_args_in->config_ssh_key_location,
+						escalator_args_in->get_process_forks_cb_arg,
+						escalator_args_in->config_enable_global_scripts, info->program_type,
+						NULL);
+			}
+		}
+		else
+		{
+			nextcheck = schedule.scan_time + CONFIG_ESCALATOR_FREQUENCY;
+
+			/* escalations are processed in batches of the same source */
+			for (int i = 0; i < (int)ARRSIZE(escalation_sources); i++)
+			{
+				/* escalation notifications are sent only for trigger based escalations */
+				if (ZBX_ESCALATION_SOURCE_TRIGGER == escalation_sources[i])
+				{
+					zbx_vector_uint64_append_array(&source_escalationids, escalationids.values,
+							escalationids.values_num);
+				}
+
+				for (int j = 0; j < due_escalations.values_num; j++)
+				{
+					if (escalation_sources[i] == due_escalations.values[j].second)
+					{
+						zbx_vector_uint64_append(&source_escalationids,
+								due_escalations.values[j].first);
+					}
+				}
+
+				if (0 == source_escalationids.values_num)
+					continue;
+
+				zbx_vector_uint64_sort(&source_escalationids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+				zbx_vector_uint64_uniq(&source_escalationids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+				escalations_count += process_escalations(now, &nextcheck, &schedule,
+						escalation_sources[i], cfg.default_timezone, process_num,
+						escalator_args_in->config_timeout,
+						escalator_args_in->config_trapper_timeout,
+						escalator_args_in->config_source_ip,
+						escalator_args_in->config_ssh_key_location,
+						escalator_args_in->get_process_forks_cb_arg,
+						escalator_args_in->config_enable_global_scripts, info->program_type,
+						&source_escalationids);
+
+				zbx_vector_uint64_clear(&source_escalationids);
+			}
+		}
+
+		if (FAIL != (schedule_nextcheck = escalation_schedule_nextcheck(&schedule)) &&
+				schedule_nextcheck < nextcheck)
+		{
+			nextcheck = schedule_nextcheck;
+		}
 
+		zbx_vector_uint64_pair_clear(&due_escalations);
 		zbx_vector_uint64_clear(&escalationids);
 
 		zbx_config_clean(&cfg);
@@ -3969,6 +4189,9 @@ ZBX_THREAD_ENTRY(escalator_thread, args)
 
 out:
 	zbx_ipc_async_socket_close(&rtc);
+	escalation_schedule_destroy(&schedule);
+	zbx_vector_uint64_pair_destroy(&due_escalations);
+	zbx_vector_uint64_destroy(&source_escalationids);
 	zbx_vector_uint64_destroy(&escalationids);
 	notify_alerter(ALERTER_CLOSE);
 	zbx_db_close();
@@ -60,8 +60,9 @@ void	lld_item_link_free(zbx_lld_item_link_t *item_link);
 
 typedef struct
 {
-	char	*lld_macro;
-	char	*path;
+	char		*lld_macro;
+	char		*path;
+	zbx_jsonpath_t	*jsonpath;	/* compiled path, NULL if the path is not valid */
 }
 zbx_lld_macro_path_t;
 
@@ -105,6 +106,7 @@ int	lld_extract_entries(zbx_hashset_t *entries, zbx_vector_lld_entry_ptr_t *entr
 		const zbx_jsonobj_t *lld_obj, const zbx_vector_lld_macro_path_ptr_t *lld_macro_paths, char **error);
 void	lld_free_entries(zbx_hashset_t *entries);
 int	lld_compare_entries(const zbx_hashset_t *entries1, const zbx_hashset_t *entries2);
+zbx_uint64_t	lld_entries_fingerprint(const zbx_hashset_t *entries, const zbx_vector_lld_macro_t *exported_macros);
 
 int	lld_macro_value_by_name(const zbx_lld_entry_t *lld_obj, const char *macro, char **value);
 void	lld_macro_clear(zbx_lld_macro_t *macro);
@@ -519,6 +521,9 @@ void	lld_process_lost_object(zbx_lld_discovery_t *discovery, unsigned char objec
 		const zbx_lld_lifetime_t *lifetime, unsigned char discovery_status, int disable_source, int ts_delete);
 void	lld_disable_lost_object(zbx_lld_discovery_t *discovery, unsigned char object_status, int lastcheck, int now,
 		const zbx_lld_lifetime_t *lifetime, int ts_disable);
+void	lld_reset_lifetime_deadline(void);
+void	lld_update_lifetime_deadline(int now, int ts);
+int	lld_get_lifetime_deadline(void);
 void	lld_flush_discoveries(zbx_hashset_t *discoveries, const char *id_field, const char *object_table,
 		const char *discovery_table, int now, get_object_status_val cb_status, delete_ids_f cb_delete_objects,
 		object_audit_entry_create_f cb_audit_create, object_audit_entry_update_status_f cb_audit_update_status);
@@ -553,6 +558,8 @@ int	zbx_substitute_macros_in_json_pairs(char **data, const zbx_lld_entry_t *lld_
 
 void	lld_sync_exported_macros(const zbx_vector_uint64_t *ruleids, const zbx_lld_entry_t *entry);
 void	lld_rule_get_exported_macros(zbx_uint64_t ruleid, zbx_vector_lld_macro_t *macros);
+zbx_uint64_t	lld_rule_get_config_fingerprint(const zbx_dc_item_t *item);
+void	lld_rule_refresh_lastcheck(zbx_uint64_t ruleid, int now);
 
 void	lld_rule_get_prototype_macro_paths(zbx_vector_lld_item_prototype_ptr_t *item_prototypes,
 		zbx_vector_uint64_t *protoids);
@@ -77,6 +77,55 @@ static int	lld_check_lifetime_elapsed(int lastcheck, int ts)
 	return SUCCEED;
 }
 
+/* the nearest time when lifetime of a lost object expires, 0 if none */
+static int	lld_lifetime_deadline;
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: reset lost object lifetime deadline before processing discovery   *
+ *          rule                                                              *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_reset_lifetime_deadline(void)
+{
+	lld_lifetime_deadline = 0;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: update the nearest lost object lifetime deadline                  *
+ *                                                                            *
+ * Parameters: now - [IN] current timestamp                                   *
+ *             ts  - [IN] time when lost object must be deleted or disabled,  *
+ *                        0 if never                                          *
+ *                                                                            *
+ * Comments: Only lifetimes that have not yet elapsed are tracked, elapsed    *
+ *           ones are handled during the current processing.                  *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_update_lifetime_deadline(int now, int ts)
+{
+	if (SUCCEED == lld_check_lifetime_elapsed(now, ts) || 0 == ts)
+		return;
+
+	if (0 == lld_lifetime_deadline || ts < lld_lifetime_deadline)
+		lld_lifetime_deadline = ts;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get the nearest lost object lifetime deadline                     *
+ *                                                                            *
+ * Return value: The time after which discovery rule must be processed        *
+ *               again to delete or disable lost objects, 0 if there are      *
+ *               none.                                                        *
+ *                                                                            *
+ ******************************************************************************/
+int	lld_get_lifetime_deadline(void)
+{
+	return lld_lifetime_deadline;
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: add new discovery record                                          *
@@ -188,6 +237,8 @@ void	lld_process_lost_object(zbx_lld_discovery_t *discovery, unsigned char objec
 		discovery->discovery_status = ZBX_LLD_DISCOVERY_STATUS_LOST;
 	}
 
+	lld_update_lifetime_deadline(now, ts);
+
 	if (SUCCEED == lld_check_lifetime_elapsed(now, ts))
 	{
 		if (ZBX_LLD_OBJECT_STATUS_ENABLED == object_status || ZBX_DISABLE_SOURCE_LLD_LOST == disable_source)
@@ -224,6 +275,8 @@ void	lld_disable_lost_object(zbx_lld_discovery_t *discovery, unsigned char objec
 		discovery->ts_disable = ts;
 	}
 
+	lld_update_lifetime_deadline(now, ts);
+
 	if (SUCCEED != lld_check_lifetime_elapsed(now, ts))
 		return;
 
@@ -18,6 +18,7 @@
 #include "zbxjson.h"
 #include "zbxexpr.h"
 #include "zbxstr.h"
+#include "zbxhash.h"
 
 ZBX_VECTOR_IMPL(lld_macro, zbx_lld_macro_t)
 
@@ -101,8 +102,14 @@ static void	lld_entry_create(zbx_lld_entry_t *entry, const zbx_jsonobj_t *obj,
 		zbx_lld_macro_t			lld_macro;
 		const zbx_lld_macro_path_t	*macro_path = lld_macro_paths->values[i];
 		char				*value = NULL;
+		int				ret;
 
-		if (SUCCEED != zbx_jsonobj_query(obj, macro_path->path, &value) || NULL == value)
+		if (NULL != macro_path->jsonpath)
+			ret = zbx_jsonobj_query_path(obj, NULL, macro_path->jsonpath, &value);
+		else
+			ret = zbx_jsonobj_query(obj, macro_path->path, &value);
+
+		if (SUCCEED != ret || NULL == value)
 			continue;
 
 		lld_macro.macro = zbx_strdup(NULL, macro_path->lld_macro);
@@ -271,6 +278,64 @@ int	lld_compare_entries(const zbx_hashset_t *entries1, const zbx_hashset_t *entr
 	return SUCCEED;
 }
 
+static zbx_uint64_t	lld_macros_hash(const zbx_vector_lld_macro_t *macros, unsigned char type)
+{
+	md5_state_t	state;
+	md5_byte_t	hash[ZBX_MD5_DIGEST_SIZE];
+	zbx_uint64_t	value;
+
+	zbx_md5_init(&state);
+	zbx_md5_append(&state, &type, sizeof(type));
+
+	for (int i = 0; i < macros->values_num; i++)
+	{
+		const zbx_lld_macro_t	*macro = &macros->values[i];
+
+		zbx_md5_append(&state, (const md5_byte_t *)macro->macro, (int)strlen(macro->macro) + 1);
+		zbx_md5_append(&state, (const md5_byte_t *)macro->value, (int)strlen(macro->value) + 1);
+	}
+
+	zbx_md5_finish(&state, hash);
+	memcpy(&value, hash, sizeof(value));
+
+	return value;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculate fingerprint of lld entries                              *
+ *                                                                            *
+ * Parameters: entries         - [IN] the lld entries                         *
+ *             exported_macros - [IN] the macros exported to the rule by      *
+ *                                    parent rule                             *
+ *                                                                            *
+ * Return value: The entries fingerprint.                                     *
+ *                                                                            *
+ * Comments: The fingerprint is a sum of entry macro-value pair hashes, so it *
+ *           does not depend on the order of entries in discovery data.       *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	lld_entries_fingerprint(const zbx_hashset_t *entries, const zbx_vector_lld_macro_t *exported_macros)
+{
+#define LLD_HASH_ENTRY		0
+#define LLD_HASH_EXPORTED	1
+
+	zbx_hashset_const_iter_t	iter;
+	const zbx_lld_entry_t		*entry;
+	zbx_uint64_t			fingerprint;
+
+	fingerprint = lld_macros_hash(exported_macros, LLD_HASH_EXPORTED);
+
+	zbx_hashset_const_iter_reset(entries, &iter);
+	while (NULL != (entry = (const zbx_lld_entry_t *)zbx_hashset_const_iter_next(&iter)))
+		fingerprint += lld_macros_hash(&entry->macros, LLD_HASH_ENTRY);
+
+	return fingerprint;
+
+#undef LLD_HASH_ENTRY
+#undef LLD_HASH_EXPORTED
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: print entry contents as comma delimited macro:value string        *
@@ -4820,78 +4820,83 @@ out:
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
 
-static int	lld_host_disable_validate(zbx_uint64_t hostid)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: keeps only hosts matching the specified condition                 *
+ *                                                                            *
+ * Parameters: hostids - [IN/OUT] IN - identifiers of hosts to validate       *
+ *                                OUT - sorted identifiers of valid hosts     *
+ *             sql     - [IN] host selection query ending with where clause   *
+ *                            condition to which host identifier condition    *
+ *                            can be appended                                 *
+ *                                                                            *
+ * Comments: The hosts are validated with a single query instead of querying  *
+ *           each host separately.                                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_hostids_filter(zbx_vector_uint64_t *hostids, const char *sql)
 {
-	int		ret;
-	char		*sql;
-	zbx_db_result_t	result;
+	char			*sql_select = NULL;
+	size_t			sql_select_alloc = 0, sql_select_offset = 0;
+	zbx_vector_uint64_t	valid_hostids;
+	zbx_db_large_query_t	query;
+	zbx_db_row_t		row;
 
-	sql = zbx_dsprintf(NULL, "select null from hosts where status=%d and hostid=" ZBX_FS_UI64,
-			HOST_STATUS_MONITORED, hostid);
-	result = zbx_db_select_n(sql, 1);
-	zbx_free(sql);
+	if (0 == hostids->values_num)
+		return;
 
-	if (NULL != zbx_db_fetch(result))
-		ret = SUCCEED;
-	else
-		ret = FAIL;
+	zbx_vector_uint64_sort(hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_create(&valid_hostids);
 
-	zbx_db_free_result(result);
+	zbx_strcpy_alloc(&sql_select, &sql_select_alloc, &sql_select_offset, sql);
+	zbx_db_large_query_prepare_uint(&query, &sql_select, &sql_select_alloc, &sql_select_offset, "h.hostid",
+			hostids);
 
-	return ret;
-}
+	while (NULL != (row = zbx_db_large_query_fetch(&query)))
+	{
+		zbx_uint64_t	hostid;
 
-static int	lld_host_enable_validate(zbx_uint64_t hostid)
-{
-	int		ret;
-	char		*sql;
-	zbx_db_result_t	result;
+		ZBX_STR2UINT64(hostid, row[0]);
+		zbx_vector_uint64_append(&valid_hostids, hostid);
+	}
 
-	sql = zbx_dsprintf(NULL, "select null"
-			" from hosts h"
-			" join host_discovery d on h.hostid=d.hostid"
-			" where h.status=%d"
-				" and d.disable_source=%d"
-				" and h.hostid=" ZBX_FS_UI64,
-				HOST_STATUS_NOT_MONITORED, ZBX_DISABLE_SOURCE_LLD_LOST, hostid);
+	zbx_db_large_query_clear(&query);
+	zbx_free(sql_select);
 
-	result = zbx_db_select_n(sql, 1);
-	zbx_free(sql);
+	zbx_vector_uint64_sort(&valid_hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
 
-	if (NULL != zbx_db_fetch(result))
-		ret = SUCCEED;
-	else
-		ret = FAIL;
+	zbx_vector_uint64_clear(hostids);
+	zbx_vector_uint64_append_array(hostids, valid_hostids.values, valid_hostids.values_num);
 
-	zbx_db_free_result(result);
-
-	return ret;
+	zbx_vector_uint64_destroy(&valid_hostids);
 }
 
-static int	lld_host_delete_validate(zbx_uint64_t hostid)
+/******************************************************************************
+ *                                                                            *
+ * Purpose: registers status change of validated hosts in audit               *
+ *                                                                            *
+ * Parameters: hosts      - [IN] discovered hosts                             *
+ *             hostids    - [IN] sorted identifiers of validated hosts        *
+ *             status_old - [IN] old host status                              *
+ *             status_new - [IN] new host status                              *
+ *             dflags     - [IN] discovery flags                              *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_hosts_audit_status(const zbx_vector_lld_host_ptr_t *hosts, const zbx_vector_uint64_t *hostids,
+		int status_old, int status_new, int dflags)
 {
-	int		ret;
-	char		*sql;
-	zbx_db_result_t	result;
-
-	sql = zbx_dsprintf(NULL, "select null"
-			" from hosts h"
-			" join host_discovery d on h.hostid=d.hostid"
-			" where h.hostid=" ZBX_FS_UI64
-				" and (h.status=%d or d.disable_source=%d)",
-				hostid, HOST_STATUS_MONITORED, ZBX_DISABLE_SOURCE_LLD_LOST);
-
-	result = zbx_db_select_n(sql, 1);
-	zbx_free(sql);
-
-	if (NULL != zbx_db_fetch(result))
-		ret = SUCCEED;
-	else
-		ret = FAIL;
+	for (int i = 0; i < hosts->values_num; i++)
+	{
+		const zbx_lld_host_t	*host = hosts->values[i];
+		zbx_audit_entry_t	*audit_entry;
 
-	zbx_db_free_result(result);
+		if (FAIL == zbx_vector_uint64_bsearch(hostids, host->hostid, ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			continue;
 
-	return ret;
+		audit_entry = zbx_audit_host_get_or_create_entry(ZBX_AUDIT_LLD_CONTEXT, ZBX_AUDIT_ACTION_UPDATE,
+				host->hostid, host->host, dflags);
+		zbx_audit_entry_update_int(audit_entry, "status", status_old, status_new);
+	}
 }
 
 /*******************************************************************************
@@ -4905,7 +4910,8 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 	char			*sql = NULL;
 	size_t			sql_alloc = 0, sql_offset = 0;
 	const zbx_lld_host_t	*host;
-	zbx_vector_uint64_t	del_hostids, lc_hostids, lost_hostids, discovered_hostids, dis_hostids, en_hostids;
+	zbx_vector_uint64_t	del_hostids, lc_hostids, lost_hostids, discovered_hostids, dis_hostids, en_hostids,
+				lock_hostids;
 	zbx_vector_str_t	del_hosts;
 	zbx_hashset_t		ids_names;
 	zbx_id_name_pair_t	local_id_name_pair;
@@ -4926,13 +4932,41 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 	zbx_vector_uint64_create(&discovered_hostids);
 	zbx_vector_uint64_create(&dis_hostids);
 	zbx_vector_uint64_create(&en_hostids);
+	zbx_vector_uint64_create(&lock_hostids);
 
 	zbx_db_begin();
 
+	/* validate lost hosts with expired lifetime at once before deciding what to do with them */
 	for (int i = 0; i < hosts->values_num; i++)
 	{
-		zbx_audit_entry_t	*audit_entry;
+		host = hosts->values[i];
+
+		if (0 == host->hostid || 0 != (host->flags & ZBX_FLAG_LLD_HOST_DISCOVERED))
+			continue;
+
+		if (ZBX_LLD_LIFETIME_TYPE_IMMEDIATELY == lifetime->type || (ZBX_LLD_LIFETIME_TYPE_AFTER ==
+				lifetime->type && lastcheck > lld_end_of_life(host->lastcheck, lifetime->duration)))
+		{
+			zbx_vector_uint64_append(&del_hostids, host->hostid);
+		}
+	}
+
+	if (0 != del_hostids.values_num)
+	{
+		char	*sql_validate;
 
+		sql_validate = zbx_dsprintf(NULL, "select h.hostid"
+				" from hosts h"
+				" join host_discovery d on h.hostid=d.hostid"
+				" where (h.status=%d or d.disable_source=%d)"
+					" and",
+				HOST_STATUS_MONITORED, ZBX_DISABLE_SOURCE_LLD_LOST);
+		lld_hostids_filter(&del_hostids, sql_validate);
+		zbx_free(sql_validate);
+	}
+
+	for (int i = 0; i < hosts->values_num; i++)
+	{
 		host = hosts->values[i];
 
 		if (0 == host->hostid)
@@ -4940,14 +4974,11 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 
 		if (0 == (host->flags & ZBX_FLAG_LLD_HOST_DISCOVERED))
 		{
-			int	ts_disable, ts_delete = 0;
+			int	ts_disable, ts_delete;
 
-			if ((ZBX_LLD_LIFETIME_TYPE_IMMEDIATELY == lifetime->type ||
-					(ZBX_LLD_LIFETIME_TYPE_AFTER == lifetime->type && lastcheck > (ts_delete =
-					lld_end_of_life(host->lastcheck, lifetime->duration)))) &&
-					SUCCEED == lld_host_delete_validate(host->hostid))
+			if (FAIL != zbx_vector_uint64_bsearch(&del_hostids, host->hostid,
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC))
 			{
-				zbx_vector_uint64_append(&del_hostids, host->hostid);
 				local_id_name_pair.id = host->hostid;
 				local_id_name_pair.name = zbx_strdup(NULL, host->host);
 				zbx_hashset_insert(&ids_names, &local_id_name_pair, sizeof(local_id_name_pair));
@@ -4961,6 +4992,10 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 				ts_delete = 0;
 			else if (ZBX_LLD_LIFETIME_TYPE_IMMEDIATELY == lifetime->type)
 				ts_delete = 1;
+			else
+				ts_delete = lld_end_of_life(host->lastcheck, lifetime->duration);
+
+			lld_update_lifetime_deadline(lastcheck, ts_delete);
 
 			if (host->ts_delete != ts_delete)
 			{
@@ -4978,6 +5013,9 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 			else
 				ts_disable = lld_end_of_life(host->lastcheck, enabled_lifetime->duration);
 
+			if (HOST_STATUS_MONITORED == host->status)
+				lld_update_lifetime_deadline(lastcheck, ts_disable);
+
 			if (host->ts_disable != ts_disable)
 			{
 				zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
@@ -4989,19 +5027,12 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 
 			if ((ZBX_LLD_LIFETIME_TYPE_AFTER == enabled_lifetime->type && lastcheck <= ts_disable) ||
 					ZBX_LLD_LIFETIME_TYPE_NEVER == enabled_lifetime->type ||
-					HOST_STATUS_NOT_MONITORED == host->status ||
-					SUCCEED != zbx_db_lock_hostid(host->hostid) ||
-					FAIL == lld_host_disable_validate(host->hostid))
+					HOST_STATUS_NOT_MONITORED == host->status)
 			{
 				continue;
 			}
 
 			zbx_vector_uint64_append(&dis_hostids, host->hostid);
-
-			audit_entry = zbx_audit_host_get_or_create_entry(ZBX_AUDIT_LLD_CONTEXT, ZBX_AUDIT_ACTION_UPDATE,
-					host->hostid, host->host, dflags);
-			zbx_audit_entry_update_int(audit_entry, "status", HOST_STATUS_MONITORED,
-					HOST_STATUS_NOT_MONITORED);
 		}
 		else
 		{
@@ -5011,19 +5042,56 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 				zbx_vector_uint64_append(&discovered_hostids, host->hostid);
 
 			if (HOST_STATUS_MONITORED == host->status ||
-					ZBX_DISABLE_SOURCE_LLD_LOST != host->disable_source ||
-					SUCCEED != zbx_db_lock_hostid(host->hostid) ||
-					SUCCEED != lld_host_enable_validate(host->hostid))
+					ZBX_DISABLE_SOURCE_LLD_LOST != host->disable_source)
 			{
 				continue;
 			}
 
 			zbx_vector_uint64_append(&en_hostids, host->hostid);
+		}
+	}
 
-			audit_entry = zbx_audit_host_get_or_create_entry(ZBX_AUDIT_LLD_CONTEXT, ZBX_AUDIT_ACTION_UPDATE,
-					host->hostid, host->host, dflags);
-			zbx_audit_entry_update_int(audit_entry, "status", HOST_STATUS_NOT_MONITORED,
+	/* lock and validate hosts with changing status in bulk, locking in identifier order avoids deadlocks */
+	zbx_vector_uint64_append_array(&lock_hostids, dis_hostids.values, dis_hostids.values_num);
+	zbx_vector_uint64_append_array(&lock_hostids, en_hostids.values, en_hostids.values_num);
+
+	if (0 != lock_hostids.values_num)
+	{
+		char	*sql_validate;
+
+		zbx_vector_uint64_sort(&lock_hostids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+		if (SUCCEED != zbx_db_lock_ids("hosts", "hostid", &lock_hostids))
+		{
+			zbx_vector_uint64_clear(&dis_hostids);
+			zbx_vector_uint64_clear(&en_hostids);
+		}
+
+		if (0 != dis_hostids.values_num)
+		{
+			sql_validate = zbx_dsprintf(NULL, "select h.hostid from hosts h where h.status=%d and",
 					HOST_STATUS_MONITORED);
+			lld_hostids_filter(&dis_hostids, sql_validate);
+			zbx_free(sql_validate);
+
+			lld_hosts_audit_status(hosts, &dis_hostids, HOST_STATUS_MONITORED,
+					HOST_STATUS_NOT_MONITORED, dflags);
+		}
+
+		if (0 != en_hostids.values_num)
+		{
+			sql_validate = zbx_dsprintf(NULL, "select h.hostid"
+					" from hosts h"
+					" join host_discovery d on h.hostid=d.hostid"
+					" where h.status=%d"
+						" and d.disable_source=%d"
+						" and",
+					HOST_STATUS_NOT_MONITORED, ZBX_DISABLE_SOURCE_LLD_LOST);
+			lld_hostids_filter(&en_hostids, sql_validate);
+			zbx_free(sql_validate);
+
+			lld_hosts_audit_status(hosts, &en_hostids, HOST_STATUS_NOT_MONITORED,
+					HOST_STATUS_MONITORED, dflags);
 		}
 	}
 
@@ -5125,6 +5193,7 @@ static void	lld_hosts_remove(const zbx_vector_lld_host_ptr_t *hosts, const zbx_l
 		zbx_db_commit();
 	}
 
+	zbx_vector_uint64_destroy(&lock_hostids);
 	zbx_vector_uint64_destroy(&en_hostids);
 	zbx_vector_uint64_destroy(&dis_hostids);
 	zbx_vector_uint64_destroy(&lost_hostids);
@@ -5196,6 +5265,8 @@ static void	lld_groups_remove(const zbx_vector_lld_group_ptr_t *groups, const zb
 				if (ZBX_LLD_DISCOVERY_STATUS_LOST != discovery->discovery_status)
 					zbx_vector_uint64_append(&lost_ids, discovery->groupdiscoveryid);
 
+				lld_update_lifetime_deadline(lastcheck, ts_delete);
+
 				if (discovery->ts_delete != ts_delete)
 				{
 					zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
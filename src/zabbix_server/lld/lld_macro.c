@@ -66,21 +66,17 @@ int	zbx_lld_macro_paths_get(zbx_uint64_t lld_ruleid, zbx_vector_lld_macro_path_p
 
 	while (NULL != (row = zbx_db_fetch(result)))
 	{
-		zbx_jsonpath_t	path;
+		lld_macro_path = lld_macro_path_create(row[0], row[1]);
 
-		if (SUCCEED != (ret = zbx_jsonpath_compile(row[1], &path)))
+		if (NULL == lld_macro_path->jsonpath)
 		{
 			*error = zbx_dsprintf(*error, "Cannot process LLD macro \"%s\": %s.\n", row[0],
 					zbx_json_strerror());
+			zbx_lld_macro_path_free(lld_macro_path);
+			ret = FAIL;
 			break;
 		}
 
-		zbx_jsonpath_clear(&path);
-
-		lld_macro_path = (zbx_lld_macro_path_t *)zbx_malloc(NULL, sizeof(zbx_lld_macro_path_t));
-		lld_macro_path->lld_macro = zbx_strdup(NULL, row[0]);
-		lld_macro_path->path = zbx_strdup(NULL, row[1]);
-
 		zbx_vector_lld_macro_path_ptr_append(lld_macro_paths, lld_macro_path);
 	}
 	zbx_db_free_result(result);
@@ -92,6 +88,20 @@ int	zbx_lld_macro_paths_get(zbx_uint64_t lld_ruleid, zbx_vector_lld_macro_path_p
 	return ret;
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: create lld macro path                                             *
+ *                                                                            *
+ * Parameters: lld_macro - [IN] lld macro                                     *
+ *             path      - [IN] json path to extract macro value from lld row *
+ *                                                                            *
+ * Return value: The created lld macro path.                                  *
+ *                                                                            *
+ * Comments: The path is compiled once so it can be applied to all lld rows.  *
+ *           If the compilation fails the jsonpath is set to NULL and the     *
+ *           error can be retrieved with zbx_json_strerror().                 *
+ *                                                                            *
+ ******************************************************************************/
 zbx_lld_macro_path_t	*lld_macro_path_create(const char *lld_macro, const char *path)
 {
 	zbx_lld_macro_path_t	*lld_macro_path;
@@ -99,6 +109,10 @@ zbx_lld_macro_path_t	*lld_macro_path_create(const char *lld_macro, const char *p
 	lld_macro_path = (zbx_lld_macro_path_t *)zbx_malloc(NULL, sizeof(zbx_lld_macro_path_t));
 	lld_macro_path->lld_macro = zbx_strdup(NULL, lld_macro);
 	lld_macro_path->path = zbx_strdup(NULL, path);
+	lld_macro_path->jsonpath = (zbx_jsonpath_t *)zbx_malloc(NULL, sizeof(zbx_jsonpath_t));
+
+	if (SUCCEED != zbx_jsonpath_compile(path, lld_macro_path->jsonpath))
+		zbx_free(lld_macro_path->jsonpath);
 
 	return lld_macro_path;
 }
@@ -112,6 +126,12 @@ zbx_lld_macro_path_t	*lld_macro_path_create(const char *lld_macro, const char *p
  ******************************************************************************/
 void	zbx_lld_macro_path_free(zbx_lld_macro_path_t *lld_macro_path)
 {
+	if (NULL != lld_macro_path->jsonpath)
+	{
+		zbx_jsonpath_clear(lld_macro_path->jsonpath);
+		zbx_free(lld_macro_path->jsonpath);
+	}
+
 	zbx_free(lld_macro_path->path);
 	zbx_free(lld_macro_path->lld_macro);
 	zbx_free(lld_macro_path);
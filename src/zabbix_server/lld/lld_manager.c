@@ -40,6 +40,17 @@
  * values in the list the rule is removed from the index (rule_index hashset),
  * otherwise the rule is enqueued back in LLD queue.
  *
+ * After successful processing worker returns fingerprint of the discovery data,
+ * which is kept by manager and sent back to worker with the next value of the
+ * same rule. Worker skips processing of unchanged data unless the fingerprint
+ * is older than ZBX_LLD_FINGERPRINT_TTL or lifetime of a lost object has
+ * expired. The fingerprint includes rule configuration read from database, so
+ * skipped values still cost a number of configuration queries, but not the
+ * loading and comparison of discovered objects. Values of rules rescheduled
+ * by 'check now' requests are sent without fingerprint. The done response also
+ * carries the number of SQL statements executed by worker, which is reported
+ * in diagnostic statistics.
+ *
  */
 
 typedef struct
@@ -52,6 +63,24 @@ zbx_lld_worker_t;
 ZBX_PTR_VECTOR_DECL(lld_worker_ptr, zbx_lld_worker_t*)
 ZBX_PTR_VECTOR_IMPL(lld_worker_ptr, zbx_lld_worker_t*)
 
+/* fingerprint of the last processed discovery data */
+typedef struct
+{
+	zbx_uint64_t	itemid;
+	zbx_uint64_t	fingerprint;
+
+	/* the time when discovery data was processed, 0 if there is no valid fingerprint */
+	int		processed;
+
+	/* the nearest time when lost objects must be deleted or disabled, 0 if none */
+	int		deadline;
+
+	/* the time of 'check now' request, values received after it are processed */
+	/* without fingerprint, 0 if there is no pending request                  */
+	int		forced;
+}
+zbx_lld_fingerprint_t;
+
 typedef struct
 {
 	/* workers vector, created during manager initialization */
@@ -75,6 +104,11 @@ typedef struct
 	/* the number of queued LLD rules */
 	zbx_uint64_t			queued_num;
 
+	/* fingerprints of processed discovery data, indexed by LLD rule id */
+	zbx_hashset_t			fingerprints;
+
+	/* the number of SQL statements executed by workers to process values */
+	zbx_uint64_t			statements_num;
 }
 zbx_lld_manager_t;
 
@@ -152,6 +186,8 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 
 	zbx_binary_heap_create(&manager->rule_queue, rule_elem_compare_func, ZBX_BINARY_HEAP_OPTION_EMPTY);
 
+	zbx_hashset_create(&manager->fingerprints, 0, ZBX_DEFAULT_UINT64_HASH_FUNC, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
 	manager->next_worker_index = 0;
 
 	for (int i = 0; i < get_config_forks_cb(ZBX_PROCESS_TYPE_LLDWORKER); i++)
@@ -164,6 +200,7 @@ static void	lld_manager_init(zbx_lld_manager_t *manager, zbx_get_config_forks_f
 	}
 
 	manager->queued_num = 0;
+	manager->statements_num = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
 }
@@ -365,15 +402,128 @@ static void	lld_process_queue(zbx_lld_manager_t *manager)
 	}
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: updates fingerprint of processed discovery data and SQL           *
+ *          statement statistics                                              *
+ *                                                                            *
+ * Parameters: manager - [IN/OUT]                                             *
+ *             itemid  - [IN] LLD rule id                                     *
+ *             message - [IN] 'done' response with optional processing result *
+ *                                                                            *
+ * Comments: Response without fingerprint means that the discovery data was   *
+ *           not processed successfully and the old fingerprint is removed.   *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_update_fingerprint(zbx_lld_manager_t *manager, zbx_uint64_t itemid,
+		const zbx_ipc_message_t *message)
+{
+	zbx_lld_fingerprint_t	*fingerprint;
+	zbx_uint64_t		statements_num = 0, fingerprint_value = 0;
+	int			processed = 0, deadline = 0;
+
+	if (0 != message->size)
+	{
+		zbx_lld_deserialize_result(message->data, &statements_num, &fingerprint_value, &processed,
+				&deadline);
+	}
+
+	manager->statements_num += statements_num;
+
+	fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_search(&manager->fingerprints, &itemid);
+
+	if (0 == processed)
+	{
+		if (NULL != fingerprint)
+		{
+			if (0 == fingerprint->forced)
+				zbx_hashset_remove_direct(&manager->fingerprints, fingerprint);
+			else
+				fingerprint->processed = 0;
+		}
+
+		return;
+	}
+
+	if (NULL == fingerprint)
+	{
+		zbx_lld_fingerprint_t	fingerprint_local = {.itemid = itemid};
+
+		fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_insert(&manager->fingerprints, &fingerprint_local,
+				sizeof(fingerprint_local));
+	}
+
+	fingerprint->fingerprint = fingerprint_value;
+	fingerprint->processed = processed;
+	fingerprint->deadline = deadline;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: removes fingerprints that are too old to skip processing and      *
+ *          'check now' requests that were not followed by values             *
+ *                                                                            *
+ * Parameters: manager - [IN/OUT]                                             *
+ *             now     - [IN] current time                                    *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_remove_expired_fingerprints(zbx_lld_manager_t *manager, int now)
+{
+	zbx_hashset_iter_t	iter;
+	zbx_lld_fingerprint_t	*fingerprint;
+
+	zbx_hashset_iter_reset(&manager->fingerprints, &iter);
+	while (NULL != (fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_iter_next(&iter)))
+	{
+		if (now - MAX(fingerprint->processed, fingerprint->forced) >= ZBX_LLD_FINGERPRINT_TTL)
+			zbx_hashset_iter_remove(&iter);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes 'check now' request for rescheduled items               *
+ *                                                                            *
+ * Parameters: manager - [IN/OUT]                                             *
+ *             message - [IN] request with rescheduled item identifiers and   *
+ *                            rescheduling time                               *
+ *                                                                            *
+ * Comments: The next value of each item received after the request is        *
+ *           processed in full, even if it was not changed.                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_process_check_now(zbx_lld_manager_t *manager, const zbx_ipc_message_t *message)
+{
+	zbx_vector_uint64_t	itemids;
+	int			now;
+
+	zbx_vector_uint64_create(&itemids);
+
+	zbx_lld_deserialize_check_now(message->data, &itemids, &now);
+
+	for (int i = 0; i < itemids.values_num; i++)
+	{
+		zbx_lld_fingerprint_t	*fingerprint, fingerprint_local = {.itemid = itemids.values[i]};
+
+		fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_insert(&manager->fingerprints, &fingerprint_local,
+				sizeof(fingerprint_local));
+		fingerprint->forced = now;
+	}
+
+	zbx_vector_uint64_destroy(&itemids);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: processes LLD worker 'done' response                              *
  *                                                                            *
  * Parameters: manager - [IN]                                                 *
  *             client  - [IN] worker's IPC client connection                  *
+ *             message - [IN] received message                                *
  *                                                                            *
  ******************************************************************************/
-static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client)
+static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *client,
+		const zbx_ipc_message_t *message)
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
@@ -390,6 +540,8 @@ static void	lld_process_result(zbx_lld_manager_t *manager, zbx_ipc_client_t *cli
 
 	rule->dup = NULL;
 	data = rule->head;
+
+	lld_update_fingerprint(manager, data->itemid, message);
 	rule->head = rule->head->next;
 
 	if (NULL == rule->head)
@@ -448,6 +600,8 @@ static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *clien
 {
 	zbx_lld_worker_t	*worker;
 	zbx_lld_rule_t		*rule;
+	unsigned char		*buf;
+	zbx_uint32_t		buf_len;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
@@ -483,13 +637,32 @@ static void	lld_process_next(zbx_lld_manager_t *manager, zbx_ipc_client_t *clien
 
 	if (NULL == (rule->dup = lld_data_get_next_value(rule->head->next, rule->head->itemid)))
 	{
-		zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, NULL, 0);
+		zbx_lld_fingerprint_t	*fingerprint;
+
+		if (NULL != (fingerprint = (zbx_lld_fingerprint_t *)zbx_hashset_search(&manager->fingerprints,
+				&rule->head->itemid)))
+		{
+			/* value requested by 'check now' must not be skipped */
+			if (0 != fingerprint->forced && rule->head->ts.sec >= fingerprint->forced)
+			{
+				fingerprint->forced = 0;
+				fingerprint->processed = 0;
+			}
+		}
+
+		if (NULL != fingerprint && 0 != fingerprint->processed)
+		{
+			buf_len = zbx_lld_serialize_fingerprint(&buf, fingerprint->fingerprint, fingerprint->processed,
+					fingerprint->deadline);
+			zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, buf, buf_len);
+			zbx_free(buf);
+		}
+		else
+			zbx_ipc_client_send(client, ZBX_IPC_LLD_PROCESS, NULL, 0);
+
 		goto out;
 	}
 
-	unsigned char	*buf;
-	zbx_uint32_t	buf_len;
-
 	buf_len = zbx_lld_serialize_value(&buf, rule->dup->value);
 	zbx_ipc_client_send(client, ZBX_IPC_LLD_CHECK_VALUE, buf, buf_len);
 	zbx_free(buf);
@@ -510,7 +683,8 @@ static void	lld_process_diag_stats(zbx_lld_manager_t *manager, zbx_ipc_client_t
 	unsigned char	*data;
 	zbx_uint32_t	data_len;
 
-	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num);
+	data_len = zbx_lld_serialize_diag_stats(&data, manager->rule_index.num_data, manager->queued_num,
+			manager->statements_num);
 	zbx_ipc_client_send(client, ZBX_IPC_LLD_DIAG_STATS_RESULT, data, data_len);
 	zbx_free(data);
 }
@@ -618,7 +792,7 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 	char			*error = NULL;
 	zbx_ipc_client_t	*client;
 	zbx_ipc_message_t	*message;
-	double			time_stat, time_now, sec, time_idle = 0;
+	double			time_stat, time_now, sec, time_idle = 0, time_cleanup;
 	zbx_lld_manager_t	manager;
 	zbx_uint64_t		processed_num = 0;
 	zbx_timespec_t		timeout = {1, 0};
@@ -647,6 +821,7 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 
 	/* initialize statistics */
 	time_stat = zbx_time();
+	time_cleanup = time_stat;
 
 	zbx_setproctitle("%s #%d started", get_process_type_string(process_type), process_num);
 
@@ -670,6 +845,12 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 			processed_num = 0;
 		}
 
+		if (ZBX_LLD_FINGERPRINT_TTL < time_now - time_cleanup)
+		{
+			lld_remove_expired_fingerprints(&manager, (int)time_now);
+			time_cleanup = time_now;
+		}
+
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_IDLE);
 		ret = zbx_ipc_service_recv(&lld_service, &timeout, &client, &message);
 		zbx_update_selfmon_counter(info, ZBX_PROCESS_STATE_BUSY);
@@ -692,9 +873,12 @@ ZBX_THREAD_ENTRY(lld_manager_thread, args)
 					lld_process_queue(&manager);
 					break;
 				case ZBX_IPC_LLD_DONE:
-					lld_process_result(&manager, client);
+					lld_process_result(&manager, client, message);
 					processed_num++;
 					break;
+				case ZBX_IPC_LLD_CHECK_NOW:
+					lld_process_check_now(&manager, message);
+					break;
 				case ZBX_IPC_LLD_NEXT:
 					lld_process_next(&manager, client);
 					break;
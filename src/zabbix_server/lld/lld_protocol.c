@@ -18,6 +18,8 @@
 #include "zbxipcservice.h"
 #include "zbxsysinfo.h"
 
+#define LLD_IPC_RING_SIZE	ZBX_MEBIBYTE
+
 zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t itemid, zbx_uint64_t hostid,
 		const char *value, const zbx_timespec_t *ts, unsigned char meta, zbx_uint64_t lastlogsize, int mtime,
 		const char *error)
@@ -103,28 +105,130 @@ void	zbx_lld_deserialize_value(const unsigned char *data, char **value)
 }
 
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num)
+zbx_uint32_t	zbx_lld_serialize_fingerprint(unsigned char **data, zbx_uint64_t fingerprint, int processed,
+		int deadline)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0;
+
+	zbx_serialize_prepare_value(data_len, fingerprint);
+	zbx_serialize_prepare_value(data_len, processed);
+	zbx_serialize_prepare_value(data_len, deadline);
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, fingerprint);
+	ptr += zbx_serialize_value(ptr, processed);
+	(void)zbx_serialize_value(ptr, deadline);
+
+	return data_len;
+}
+
+void	zbx_lld_deserialize_fingerprint(const unsigned char *data, zbx_uint64_t *fingerprint, int *processed,
+		int *deadline)
+{
+	data += zbx_deserialize_value(data, fingerprint);
+	data += zbx_deserialize_value(data, processed);
+	(void)zbx_deserialize_value(data, deadline);
+}
+
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, zbx_uint64_t statements_num, zbx_uint64_t fingerprint,
+		int processed, int deadline)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0;
+
+	zbx_serialize_prepare_value(data_len, statements_num);
+	zbx_serialize_prepare_value(data_len, fingerprint);
+	zbx_serialize_prepare_value(data_len, processed);
+	zbx_serialize_prepare_value(data_len, deadline);
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, statements_num);
+	ptr += zbx_serialize_value(ptr, fingerprint);
+	ptr += zbx_serialize_value(ptr, processed);
+	(void)zbx_serialize_value(ptr, deadline);
+
+	return data_len;
+}
+
+void	zbx_lld_deserialize_result(const unsigned char *data, zbx_uint64_t *statements_num, zbx_uint64_t *fingerprint,
+		int *processed, int *deadline)
+{
+	data += zbx_deserialize_value(data, statements_num);
+	data += zbx_deserialize_value(data, fingerprint);
+	data += zbx_deserialize_value(data, processed);
+	(void)zbx_deserialize_value(data, deadline);
+}
+
+static zbx_uint32_t	zbx_lld_serialize_check_now(unsigned char **data, const zbx_vector_uint64_t *itemids, int now)
+{
+	unsigned char	*ptr;
+	zbx_uint32_t	data_len = 0;
+
+	zbx_serialize_prepare_value(data_len, now);
+	zbx_serialize_prepare_value(data_len, itemids->values_num);
+	data_len += (zbx_uint32_t)(itemids->values_num * sizeof(zbx_uint64_t));
+
+	*data = (unsigned char *)zbx_malloc(NULL, data_len);
+
+	ptr = *data;
+	ptr += zbx_serialize_value(ptr, now);
+	ptr += zbx_serialize_value(ptr, itemids->values_num);
+
+	for (int i = 0; i < itemids->values_num; i++)
+		ptr += zbx_serialize_value(ptr, itemids->values[i]);
+
+	return data_len;
+}
+
+void	zbx_lld_deserialize_check_now(const unsigned char *data, zbx_vector_uint64_t *itemids, int *now)
+{
+	int	itemids_num;
+
+	data += zbx_deserialize_value(data, now);
+	data += zbx_deserialize_value(data, &itemids_num);
+
+	zbx_vector_uint64_reserve(itemids, (size_t)itemids_num);
+
+	for (int i = 0; i < itemids_num; i++)
+	{
+		zbx_uint64_t	itemid;
+
+		data += zbx_deserialize_value(data, &itemid);
+		zbx_vector_uint64_append(itemids, itemid);
+	}
+}
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		zbx_uint64_t statements_num)
 {
 	unsigned char	*ptr;
 	zbx_uint32_t	data_len = 0;
 
 	zbx_serialize_prepare_value(data_len, items_num);
 	zbx_serialize_prepare_value(data_len, values_num);
+	zbx_serialize_prepare_value(data_len, statements_num);
 
 	*data = (unsigned char *)zbx_malloc(NULL, data_len);
 
 	ptr = *data;
 	ptr += zbx_serialize_value(ptr, items_num);
-	(void)zbx_serialize_value(ptr, values_num);
+	ptr += zbx_serialize_value(ptr, values_num);
+	(void)zbx_serialize_value(ptr, statements_num);
 
 	return data_len;
 }
 
 static void	zbx_lld_deserialize_diag_stats(const unsigned char *data, zbx_uint64_t *items_num,
-		zbx_uint64_t *values_num)
+		zbx_uint64_t *values_num, zbx_uint64_t *statements_num)
 {
 	data += zbx_deserialize_value(data, items_num);
-	(void)zbx_deserialize_value(data, values_num);
+	data += zbx_deserialize_value(data, values_num);
+	(void)zbx_deserialize_value(data, statements_num);
 }
 
 static zbx_uint32_t	zbx_lld_serialize_top_items_request(unsigned char **data, int limit)
@@ -217,10 +321,15 @@ void	zbx_lld_queue_value(zbx_uint64_t itemid, zbx_uint64_t hostid, const char *v
 	zbx_uint32_t		data_len;
 
 	/* each process has a permanent connection to manager */
-	if (0 == socket.fd && FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_LLD, SEC_PER_MIN, &errmsg))
+	if (0 == socket.fd)
 	{
-		zabbix_log(LOG_LEVEL_CRIT, "cannot connect to LLD manager service: %s", errmsg);
-		zbx_exit(EXIT_FAILURE);
+		if (FAIL == zbx_ipc_socket_open(&socket, ZBX_IPC_SERVICE_LLD, SEC_PER_MIN, &errmsg))
+		{
+			zabbix_log(LOG_LEVEL_CRIT, "cannot connect to LLD manager service: %s", errmsg);
+			zbx_exit(EXIT_FAILURE);
+		}
+
+		zbx_ipc_socket_attach_ring(&socket, LLD_IPC_RING_SIZE);
 	}
 
 	data_len = zbx_lld_serialize_item_value(&data, itemid, hostid, value, ts, meta, lastlogsize, mtime, error);
@@ -268,6 +377,39 @@ void	zbx_lld_process_agent_result(zbx_uint64_t itemid, zbx_uint64_t hostid, AGEN
 		zbx_lld_queue_value(itemid, hostid, value, ts, meta, lastlogsize, mtime, error);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: notifies LLD manager about items rescheduled by 'check now'       *
+ *          request, so their next discovery values are processed even if     *
+ *          unchanged                                                         *
+ *                                                                            *
+ * Parameters: itemids - [IN] rescheduled item identifiers                    *
+ *             now     - [IN] time when the items were rescheduled            *
+ *                                                                            *
+ ******************************************************************************/
+void	zbx_lld_check_now(const zbx_vector_uint64_t *itemids, int now)
+{
+	zbx_ipc_socket_t	lld_socket;
+	char			*error = NULL;
+	unsigned char		*data;
+	zbx_uint32_t		data_len;
+
+	if (FAIL == zbx_ipc_socket_open(&lld_socket, ZBX_IPC_SERVICE_LLD, SEC_PER_MIN, &error))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "cannot connect to LLD manager service: %s", error);
+		zbx_free(error);
+		return;
+	}
+
+	data_len = zbx_lld_serialize_check_now(&data, itemids, now);
+
+	if (FAIL == zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_CHECK_NOW, data, data_len))
+		zabbix_log(LOG_LEVEL_WARNING, "cannot send check now request to LLD manager service");
+
+	zbx_free(data);
+	zbx_ipc_socket_close(&lld_socket);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: gets queue size (enqueued value count) of LLD manager             *
@@ -315,8 +457,15 @@ out:
  *                                                                            *
  * Purpose: gets LLD manager diagnostic statistics                            *
  *                                                                            *
+ * Parameters: items_num      - [OUT] number of LLD rules with queued values  *
+ *             values_num     - [OUT] number of queued values                 *
+ *             statements_num - [OUT] number of SQL statements executed by    *
+ *                                    LLD workers to process values           *
+ *             error          - [OUT] error message                           *
+ *                                                                            *
  ******************************************************************************/
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error)
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_uint64_t *statements_num,
+		char **error)
 {
 	unsigned char	*result;
 
@@ -326,7 +475,7 @@ int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, ch
 		return FAIL;
 	}
 
-	zbx_lld_deserialize_diag_stats(result, items_num, values_num);
+	zbx_lld_deserialize_diag_stats(result, items_num, values_num, statements_num);
 	zbx_free(result);
 
 	return SUCCEED;
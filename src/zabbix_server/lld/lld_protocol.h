@@ -49,6 +49,12 @@
 /* manager -> process */
 #define ZBX_IPC_LLD_TOP_ITEMS_RESULT	1403
 
+/* process -> manager */
+#define ZBX_IPC_LLD_CHECK_NOW		1500
+
+/* the period after which unchanged discovery data is processed again */
+#define ZBX_LLD_FINGERPRINT_TTL		SEC_PER_HOUR
+
 zbx_uint32_t	zbx_lld_serialize_item_value(unsigned char **data, zbx_uint64_t itemid, zbx_uint64_t hostid,
 		const char *value, const zbx_timespec_t *ts, unsigned char meta, zbx_uint64_t lastlogsize, int mtime,
 		const char *error);
@@ -59,9 +65,24 @@ void	zbx_lld_deserialize_item_value(const unsigned char *data, zbx_uint64_t *ite
 
 zbx_uint32_t	zbx_lld_serialize_value(unsigned char **data, const char *value);
 
+zbx_uint32_t	zbx_lld_serialize_fingerprint(unsigned char **data, zbx_uint64_t fingerprint, int processed,
+		int deadline);
+
+void	zbx_lld_deserialize_fingerprint(const unsigned char *data, zbx_uint64_t *fingerprint, int *processed,
+		int *deadline);
+
+zbx_uint32_t	zbx_lld_serialize_result(unsigned char **data, zbx_uint64_t statements_num, zbx_uint64_t fingerprint,
+		int processed, int deadline);
+
+void	zbx_lld_deserialize_result(const unsigned char *data, zbx_uint64_t *statements_num, zbx_uint64_t *fingerprint,
+		int *processed, int *deadline);
+
 void	zbx_lld_deserialize_value(const unsigned char *data, char **value);
 
-zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num);
+void	zbx_lld_deserialize_check_now(const unsigned char *data, zbx_vector_uint64_t *itemids, int *now);
+
+zbx_uint32_t	zbx_lld_serialize_diag_stats(unsigned char **data, zbx_uint64_t items_num, zbx_uint64_t values_num,
+		zbx_uint64_t statements_num);
 
 void	zbx_lld_deserialize_top_items_request(const unsigned char *data, int *limit);
 
@@ -74,9 +95,12 @@ void	zbx_lld_queue_value(zbx_uint64_t itemid, zbx_uint64_t hostid, const char *v
 void	zbx_lld_process_agent_result(zbx_uint64_t itemid, zbx_uint64_t hostid, AGENT_RESULT *result,
 		zbx_timespec_t *ts, char *error);
 
+void	zbx_lld_check_now(const zbx_vector_uint64_t *itemids, int now);
+
 int	zbx_lld_get_queue_size(zbx_uint64_t *size, char **error);
 
-int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, char **error);
+int	zbx_lld_get_diag_stats(zbx_uint64_t *items_num, zbx_uint64_t *values_num, zbx_uint64_t *statements_num,
+		char **error);
 
 int	zbx_lld_get_top_items(int limit, zbx_vector_uint64_pair_t *items, char **error);
 
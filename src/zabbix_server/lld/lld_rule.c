@@ -30,6 +30,7 @@
 #include "zbxjson.h"
 #include "zbxtypes.h"
 #include "zbxexpr.h"
+#include "zbxhash.h"
 
 /* lld_override table columns */
 #define LLD_OVERRIDE_COL_NAME			0
@@ -351,6 +352,368 @@ void	lld_rule_get_exported_macros(zbx_uint64_t ruleid, zbx_vector_lld_macro_t *m
 	zbx_vector_lld_macro_sort(macros, lld_macro_compare);
 }
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: hash all fields of table rows selected by identifiers             *
+ *                                                                            *
+ * Parameters: state     - [IN/OUT] md5 state, NULL to only get identifiers   *
+ *             tablename - [IN] table name                                    *
+ *             field     - [IN] field to select rows by                       *
+ *             ids       - [IN] sorted values of the field                    *
+ *             out_field - [IN] field to return values of (optional)          *
+ *             out_ids   - [OUT] sorted unique values of out_field (optional) *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rule_hash_rows(md5_state_t *state, const char *tablename, const char *field,
+		const zbx_vector_uint64_t *ids, const char *out_field, zbx_vector_uint64_t *out_ids)
+{
+	const zbx_db_table_t	*table;
+	zbx_db_result_t		result;
+	zbx_db_row_t		row;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+	int			fields_num = 0, out_index = -1;
+
+	if (0 == ids->values_num)
+		return;
+
+	if (NULL == (table = zbx_db_get_table(tablename)))
+	{
+		THIS_SHOULD_NEVER_HAPPEN;
+		return;
+	}
+
+	zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, "select ");
+
+	for (; NULL != table->fields[fields_num].name; fields_num++)
+	{
+		if (0 != fields_num)
+			zbx_chrcpy_alloc(&sql, &sql_alloc, &sql_offset, ',');
+
+		zbx_strcpy_alloc(&sql, &sql_alloc, &sql_offset, table->fields[fields_num].name);
+
+		if (NULL != out_field && 0 == strcmp(table->fields[fields_num].name, out_field))
+			out_index = fields_num;
+	}
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " from %s where", tablename);
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, field, ids->values, ids->values_num);
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset, " order by %s", table->recid);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		if (NULL != state)
+		{
+			for (int i = 0; i < fields_num; i++)
+			{
+				/* distinguish NULL from empty string */
+				if (SUCCEED == zbx_db_is_null(row[i]))
+					zbx_md5_append(state, (const md5_byte_t *)"\1", 1);
+				else
+					zbx_md5_append(state, (const md5_byte_t *)row[i], (int)strlen(row[i]) + 1);
+			}
+		}
+
+		if (-1 != out_index && SUCCEED != zbx_db_is_null(row[out_index]))
+		{
+			zbx_uint64_t	id;
+
+			ZBX_STR2UINT64(id, row[out_index]);
+			zbx_vector_uint64_append(out_ids, id);
+		}
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+
+	if (NULL != out_ids)
+	{
+		zbx_vector_uint64_sort(out_ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+		zbx_vector_uint64_uniq(out_ids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: get identifiers of prototypes of LLD rule and its nested rule     *
+ *          prototypes                                                        *
+ *                                                                            *
+ * Parameters: table    - [IN] prototype table (items or hosts)               *
+ *             id_field - [IN] prototype identifier field                     *
+ *             link     - [IN] discovery link table                           *
+ *             ruleids  - [IN] LLD rule identifiers                           *
+ *             protoids - [OUT] sorted prototype identifiers                  *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rule_get_protoids(const char *table, const char *id_field, const char *link,
+		const zbx_vector_uint64_t *ruleids, zbx_vector_uint64_t *protoids)
+{
+	zbx_db_result_t	result;
+	zbx_db_row_t	row;
+	char		*sql = NULL;
+	size_t		sql_alloc = 0, sql_offset = 0;
+
+	zbx_snprintf_alloc(&sql, &sql_alloc, &sql_offset,
+			"select p.%s"
+			" from %s p,%s d"
+			" where p.%s=d.%s"
+				" and p.flags&%d<>0"
+				" and",
+			id_field, table, link, id_field, id_field, ZBX_FLAG_DISCOVERY_PROTOTYPE);
+	zbx_db_add_condition_alloc(&sql, &sql_alloc, &sql_offset, "d.lldruleid", ruleids->values,
+			ruleids->values_num);
+
+	result = zbx_db_select("%s", sql);
+
+	while (NULL != (row = zbx_db_fetch(result)))
+	{
+		zbx_uint64_t	id;
+
+		ZBX_STR2UINT64(id, row[0]);
+		zbx_vector_uint64_append(protoids, id);
+	}
+	zbx_db_free_result(result);
+
+	zbx_free(sql);
+
+	zbx_vector_uint64_sort(protoids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+	zbx_vector_uint64_uniq(protoids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: calculate fingerprint of LLD rule configuration                   *
+ *                                                                            *
+ * Parameters: item - [IN] LLD rule                                           *
+ *                                                                            *
+ * Return value: The configuration fingerprint.                               *
+ *                                                                            *
+ * Comments: The fingerprint covers the rule itself with its filter, lifetime *
+ *           and override settings, item, trigger, graph, host and nested     *
+ *           rule prototypes and the revision of user macros available to the *
+ *           rule host.                                                       *
+ *           The configuration is read from database on every call, with one  *
+ *           query per table having rows to select - up to about 35 queries   *
+ *           for rules with overrides and host prototypes. Configuration      *
+ *           cache revisions cannot replace it, because host prototypes,      *
+ *           filters, macro paths and overrides are not cached. Skipping      *
+ *           unchanged data therefore saves loading of discovered objects,    *
+ *           their comparison and updates, but not the configuration reads.   *
+ *                                                                            *
+ ******************************************************************************/
+zbx_uint64_t	lld_rule_get_config_fingerprint(const zbx_dc_item_t *item)
+{
+	md5_state_t		state;
+	md5_byte_t		hash[ZBX_MD5_DIGEST_SIZE];
+	zbx_uint64_t		fingerprint, revision;
+	zbx_vector_uint64_t	ruleids, itemids, protoids, overrideids, operationids, triggerids, graphids, hostids,
+				interfaceids;
+	zbx_dc_um_handle_t	*um_handle;
+	const char		*optables[] = {"lld_override_opstatus", "lld_override_opdiscover",
+					"lld_override_opperiod", "lld_override_ophistory", "lld_override_optrends",
+					"lld_override_opseverity", "lld_override_optag", "lld_override_optemplate",
+					"lld_override_opinventory"};
+
+	zbx_vector_uint64_create(&ruleids);
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_create(&protoids);
+	zbx_vector_uint64_create(&overrideids);
+	zbx_vector_uint64_create(&operationids);
+	zbx_vector_uint64_create(&triggerids);
+	zbx_vector_uint64_create(&graphids);
+	zbx_vector_uint64_create(&hostids);
+	zbx_vector_uint64_create(&interfaceids);
+
+	/* collect item prototypes of the rule and of its nested rule prototypes */
+	zbx_vector_uint64_append(&ruleids, item->itemid);
+
+	while (0 != ruleids.values_num)
+	{
+		zbx_vector_uint64_append_array(&itemids, ruleids.values, ruleids.values_num);
+		lld_rule_get_protoids("items", "itemid", "item_discovery", &ruleids, &protoids);
+
+		zbx_vector_uint64_clear(&ruleids);
+
+		for (int i = 0; i < protoids.values_num; i++)
+		{
+			if (FAIL == zbx_vector_uint64_search(&itemids, protoids.values[i],
+					ZBX_DEFAULT_UINT64_COMPARE_FUNC))
+			{
+				zbx_vector_uint64_append(&ruleids, protoids.values[i]);
+			}
+		}
+
+		zbx_vector_uint64_clear(&protoids);
+	}
+
+	zbx_vector_uint64_sort(&itemids, ZBX_DEFAULT_UINT64_COMPARE_FUNC);
+
+	zbx_md5_init(&state);
+
+	um_handle = zbx_dc_open_user_macros();
+	revision = zbx_dc_get_user_macro_revision(um_handle, item->host.hostid);
+	zbx_dc_close_user_macros(um_handle);
+
+	zbx_md5_append(&state, (const md5_byte_t *)&revision, sizeof(revision));
+
+	/* rules, filters, overrides and item prototypes */
+	lld_rule_hash_rows(&state, "items", "itemid", &itemids, NULL, NULL);
+	lld_rule_hash_rows(&state, "item_preproc", "itemid", &itemids, NULL, NULL);
+	lld_rule_hash_rows(&state, "item_tag", "itemid", &itemids, NULL, NULL);
+	lld_rule_hash_rows(&state, "item_parameter", "itemid", &itemids, NULL, NULL);
+	lld_rule_hash_rows(&state, "item_condition", "itemid", &itemids, NULL, NULL);
+	lld_rule_hash_rows(&state, "lld_macro_path", "itemid", &itemids, NULL, NULL);
+
+	lld_rule_hash_rows(&state, "lld_override", "itemid", &itemids, "lld_overrideid", &overrideids);
+	lld_rule_hash_rows(&state, "lld_override_condition", "lld_overrideid", &overrideids, NULL, NULL);
+	lld_rule_hash_rows(&state, "lld_override_operation", "lld_overrideid", &overrideids,
+			"lld_override_operationid", &operationids);
+
+	for (size_t i = 0; i < ARRSIZE(optables); i++)
+		lld_rule_hash_rows(&state, optables[i], "lld_override_operationid", &operationids, NULL, NULL);
+
+	/* trigger prototypes */
+	lld_rule_hash_rows(&state, "functions", "itemid", &itemids, "triggerid", &triggerids);
+	lld_rule_hash_rows(&state, "triggers", "triggerid", &triggerids, NULL, NULL);
+	lld_rule_hash_rows(&state, "trigger_tag", "triggerid", &triggerids, NULL, NULL);
+	lld_rule_hash_rows(&state, "trigger_depends", "triggerid_down", &triggerids, NULL, NULL);
+
+	/* graph prototypes */
+	lld_rule_hash_rows(NULL, "graphs_items", "itemid", &itemids, "graphid", &graphids);
+	lld_rule_hash_rows(&state, "graphs", "graphid", &graphids, NULL, NULL);
+	lld_rule_hash_rows(&state, "graphs_items", "graphid", &graphids, NULL, NULL);
+
+	/* host prototypes */
+	lld_rule_get_protoids("hosts", "hostid", "host_discovery", &itemids, &hostids);
+	lld_rule_hash_rows(&state, "hosts", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "hosts_templates", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "group_prototype", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "hostmacro", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "host_tag", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "host_inventory", "hostid", &hostids, NULL, NULL);
+	lld_rule_hash_rows(&state, "interface", "hostid", &hostids, "interfaceid", &interfaceids);
+	lld_rule_hash_rows(&state, "interface_snmp", "interfaceid", &interfaceids, NULL, NULL);
+
+	zbx_md5_finish(&state, hash);
+	memcpy(&fingerprint, hash, sizeof(fingerprint));
+
+	zbx_vector_uint64_destroy(&interfaceids);
+	zbx_vector_uint64_destroy(&hostids);
+	zbx_vector_uint64_destroy(&graphids);
+	zbx_vector_uint64_destroy(&triggerids);
+	zbx_vector_uint64_destroy(&operationids);
+	zbx_vector_uint64_destroy(&overrideids);
+	zbx_vector_uint64_destroy(&protoids);
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_uint64_destroy(&ruleids);
+
+	return fingerprint;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: add lastcheck update of discovered objects to SQL batch           *
+ *                                                                            *
+ * Parameters: sql        - [IN/OUT] SQL batch                                *
+ *             sql_alloc  - [IN/OUT]                                          *
+ *             sql_offset - [IN/OUT]                                          *
+ *             table      - [IN] discovery table name                         *
+ *             field      - [IN] parent prototype field                       *
+ *             subquery   - [IN] prototype subquery (optional)                *
+ *             sub_field  - [IN] subquery field to select by (optional)       *
+ *             ids        - [IN] identifiers to select prototypes by          *
+ *             now        - [IN] current timestamp                            *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_rule_add_lastcheck_update(char **sql, size_t *sql_alloc, size_t *sql_offset, const char *table,
+		const char *field, const char *subquery, const char *sub_field, const zbx_vector_uint64_t *ids, int now)
+{
+	if (0 == ids->values_num)
+		return;
+
+	zbx_snprintf_alloc(sql, sql_alloc, sql_offset,
+			"update %s set lastcheck=%d"
+			" where status=%d"
+				" and lastcheck<>%d"
+				" and",
+			table, now, ZBX_LLD_DISCOVERY_STATUS_NORMAL, now);
+
+	if (NULL != subquery)
+	{
+		zbx_snprintf_alloc(sql, sql_alloc, sql_offset, " %s in (%s where", field, subquery);
+		zbx_db_add_condition_alloc(sql, sql_alloc, sql_offset, sub_field, ids->values, ids->values_num);
+		zbx_chrcpy_alloc(sql, sql_alloc, sql_offset, ')');
+	}
+	else
+		zbx_db_add_condition_alloc(sql, sql_alloc, sql_offset, field, ids->values, ids->values_num);
+
+	zbx_strcpy_alloc(sql, sql_alloc, sql_offset, ";\n");
+
+	zbx_db_execute_overflowed_sql(sql, sql_alloc, sql_offset);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: refresh last check time of objects discovered by LLD rule         *
+ *                                                                            *
+ * Parameters: ruleid - [IN] LLD rule identifier                              *
+ *             now    - [IN] current timestamp                                *
+ *                                                                            *
+ * Comments: Used when unchanged discovery data is skipped. Such data would   *
+ *           discover the same objects as the last processing, so all items,  *
+ *           triggers, graphs, hosts and host groups that are currently       *
+ *           discovered by the rule prototypes are updated with a single      *
+ *           statement per discovery table.                                   *
+ *                                                                            *
+ ******************************************************************************/
+void	lld_rule_refresh_lastcheck(zbx_uint64_t ruleid, int now)
+{
+	zbx_vector_uint64_t	ruleids, itemids, hostids;
+	char			*sql = NULL;
+	size_t			sql_alloc = 0, sql_offset = 0;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s() ruleid:" ZBX_FS_UI64, __func__, ruleid);
+
+	zbx_vector_uint64_create(&ruleids);
+	zbx_vector_uint64_create(&itemids);
+	zbx_vector_uint64_create(&hostids);
+
+	zbx_vector_uint64_append(&ruleids, ruleid);
+
+	lld_rule_get_protoids("items", "itemid", "item_discovery", &ruleids, &itemids);
+	lld_rule_get_protoids("hosts", "hostid", "host_discovery", &ruleids, &hostids);
+
+	if (0 == itemids.values_num && 0 == hostids.values_num)
+		goto out;
+
+	zbx_db_begin();
+
+	lld_rule_add_lastcheck_update(&sql, &sql_alloc, &sql_offset, "item_discovery", "parent_itemid", NULL, NULL,
+			&itemids, now);
+	lld_rule_add_lastcheck_update(&sql, &sql_alloc, &sql_offset, "trigger_discovery", "parent_triggerid",
+			"select triggerid from functions", "itemid", &itemids, now);
+	lld_rule_add_lastcheck_update(&sql, &sql_alloc, &sql_offset, "graph_discovery", "parent_graphid",
+			"select graphid from graphs_items", "itemid", &itemids, now);
+	lld_rule_add_lastcheck_update(&sql, &sql_alloc, &sql_offset, "host_discovery", "parent_hostid", NULL, NULL,
+			&hostids, now);
+	lld_rule_add_lastcheck_update(&sql, &sql_alloc, &sql_offset, "group_discovery", "parent_group_prototypeid",
+			"select group_prototypeid from group_prototype", "hostid", &hostids, now);
+
+	(void)zbx_db_flush_overflowed_sql(sql, sql_offset);
+
+	zbx_db_commit();
+
+	zbx_free(sql);
+out:
+	zbx_vector_uint64_destroy(&hostids);
+	zbx_vector_uint64_destroy(&itemids);
+	zbx_vector_uint64_destroy(&ruleids);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
 /******************************************************************************
  *                                                                            *
  * Purpose: updates existing LLD rule macro paths and creates new ones based  *
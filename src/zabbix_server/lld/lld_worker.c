@@ -44,6 +44,17 @@ typedef struct
 	zbx_vector_lld_entry_ptr_t	entries_sorted;
 	zbx_vector_lld_macro_path_ptr_t	macro_paths;
 	zbx_jsonobj_t			source;
+
+	/* fingerprint of discovery data and the time it was processed, */
+	/* 0 if the data was not processed successfully                  */
+	zbx_uint64_t			fingerprint;
+	int				processed;
+
+	/* the nearest time when lost objects must be deleted or disabled, 0 if none */
+	int				deadline;
+
+	/* the number of SQL statements executed to process the value */
+	zbx_uint64_t			statements_num;
 }
 zbx_lld_value_t;
 
@@ -81,6 +92,11 @@ static void	lld_value_init(zbx_lld_value_t *lld_value)
 	zbx_vector_lld_macro_path_ptr_create(&lld_value->macro_paths);
 
 	zbx_jsonobj_init(&lld_value->source);
+
+	lld_value->fingerprint = 0;
+	lld_value->processed = 0;
+	lld_value->deadline = 0;
+	lld_value->statements_num = 0;
 }
 
 /******************************************************************************
@@ -291,20 +307,95 @@ out:
  *                                                                            *
  * Purpose: process LLD value                                                 *
  *                                                                            *
+ * Parameters: lld_value - [IN/OUT]                                           *
+ *             message   - [IN] process request with optional fingerprint     *
+ *                              of the last processed data                    *
+ *                                                                            *
+ * Comments: Processing is skipped if discovery data, the macros exported by  *
+ *           parent rule and the rule configuration have not changed since    *
+ *           the last processing and no lost object lifetime has expired      *
+ *           since then. Last check time of the discovered objects is still   *
+ *           refreshed. The data is processed again after                     *
+ *           ZBX_LLD_FINGERPRINT_TTL to repair objects changed outside LLD.   *
+ *                                                                            *
  ******************************************************************************/
-static void	lld_process_value(zbx_lld_value_t *lld_value)
+static void	lld_process_value(zbx_lld_value_t *lld_value, const zbx_ipc_message_t *message)
 {
-	char		*error = NULL;
-	unsigned char	state;
+	char			*error = NULL;
+	unsigned char		state;
+	zbx_uint64_t		fingerprint = 0, statements_num;
+	int			processed = 0, deadline = 0, now;
+	zbx_vector_lld_macro_t	exported_macros;
+
+	statements_num = zbx_db_get_statements_num();
+
+	if (ZBX_IPC_LLD_PROCESS == message->code && 0 != message->size)
+		zbx_lld_deserialize_fingerprint(message->data, &fingerprint, &processed, &deadline);
+
+	zbx_vector_lld_macro_create(&exported_macros);
+	lld_rule_get_exported_macros(lld_value->item.itemid, &exported_macros);
+
+	lld_value->fingerprint = lld_entries_fingerprint(&lld_value->entries, &exported_macros) +
+			lld_rule_get_config_fingerprint(&lld_value->item);
+
+	for (int i = 0; i < exported_macros.values_num; i++)
+		lld_macro_clear(&exported_macros.values[i]);
+
+	zbx_vector_lld_macro_destroy(&exported_macros);
+
+	now = (int)time(NULL);
+
+	if (0 != processed && fingerprint == lld_value->fingerprint && now >= processed &&
+			ZBX_LLD_FINGERPRINT_TTL > now - processed && (0 == deadline || now <= deadline))
+	{
+		zabbix_log(LOG_LEVEL_DEBUG, "skipped unchanged value for LLD rule " ZBX_FS_UI64,
+				lld_value->item.itemid);
+
+		lld_rule_refresh_lastcheck(lld_value->item.itemid, now);
+
+		lld_value->processed = processed;
+		lld_value->deadline = deadline;
+		lld_flush_value(lld_value, ITEM_STATE_NORMAL, NULL);
+
+		goto out;
+	}
+
+	lld_reset_lifetime_deadline();
 
 	if (SUCCEED == lld_process_discovery_rule(&lld_value->item, &lld_value->entries_sorted, &error))
 		state = ITEM_STATE_NORMAL;
 	else
 		state = ITEM_STATE_NOTSUPPORTED;
 
+	/* remember only data that was discovered without errors, so failed objects are retried */
+	if (ITEM_STATE_NORMAL == state && NULL != error && '\0' == *error)
+	{
+		lld_value->processed = now;
+		lld_value->deadline = lld_get_lifetime_deadline();
+	}
+
 	lld_flush_value(lld_value, state, error);
 
 	zbx_free(error);
+out:
+	lld_value->statements_num = zbx_db_get_statements_num() - statements_num;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: send 'done' response with fingerprint of processed data and the   *
+ *          number of SQL statements executed to process it                   *
+ *                                                                            *
+ ******************************************************************************/
+static void	lld_send_result(zbx_ipc_socket_t *socket, const zbx_lld_value_t *lld_value)
+{
+	unsigned char	*data;
+	zbx_uint32_t	data_len;
+
+	data_len = zbx_lld_serialize_result(&data, lld_value->statements_num, lld_value->fingerprint,
+			lld_value->processed, lld_value->deadline);
+	zbx_ipc_socket_write(socket, ZBX_IPC_LLD_DONE, data, data_len);
+	zbx_free(data);
 }
 
 ZBX_THREAD_ENTRY(lld_worker_thread, args)
@@ -411,9 +502,9 @@ ZBX_THREAD_ENTRY(lld_worker_thread, args)
 				}
 				ZBX_FALLTHROUGH;
 			case ZBX_IPC_LLD_PROCESS:
-				lld_process_value(&lld_value);
+				lld_process_value(&lld_value, &message);
+				lld_send_result(&lld_socket, &lld_value);
 				lld_value_clear(&lld_value);
-				zbx_ipc_socket_write(&lld_socket, ZBX_IPC_LLD_DONE, NULL, 0);
 				processed_num++;
 				break;
 			case ZBX_RTC_SHUTDOWN:
@@ -113,13 +113,27 @@ static int	send_data_to_proxy(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock, c
 	return ret;
 }
 
-static int	recv_data_from_proxy(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock)
+static int	recv_data_from_proxy(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock, zbx_proxy_data_stream_t *stream,
+		const char **data)
 {
 	int	ret;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
-	if (FAIL == (ret = zbx_tcp_recv(sock)))
+	if (NULL != stream)
+	{
+		if (FAIL == zbx_tcp_recv_stream(sock, 0, 0, zbx_proxy_data_stream_feed, stream))
+		{
+			zabbix_log(LOG_LEVEL_ERR, "cannot obtain data from proxy \"%s\": %s", proxy->name,
+					zbx_socket_strerror());
+			ret = FAIL;
+		}
+		else if (NULL == (*data = zbx_proxy_data_stream_get_json(stream)))
+			ret = FAIL;
+		else
+			ret = SUCCEED;
+	}
+	else if (FAIL == (ret = zbx_tcp_recv(sock)))
 	{
 		zabbix_log(LOG_LEVEL_ERR, "cannot obtain data from proxy \"%s\": %s", proxy->name,
 				zbx_socket_strerror());
@@ -127,6 +141,7 @@ static int	recv_data_from_proxy(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock)
 	else
 	{
 		zabbix_log(LOG_LEVEL_DEBUG, "obtained data from proxy \"%s\": [%s]", proxy->name, sock->buffer);
+		*data = sock->buffer;
 	}
 
 	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
@@ -155,21 +170,26 @@ static void	disconnect_proxy(zbx_socket_t *sock)
  *             data                   - [OUT] data received from proxy          *
  *             ts                     - [OUT] timestamp when the proxy          *
  *                                            connection was established        *
+ *             stream                 - [IN] optional proxy data stream         *
  *                                                                              *
  * Return value: SUCCESS - processed successfully                               *
  *               other code - an error occurred                                 *
  *                                                                              *
  * Comments: The proxy->compress property is updated depending on the           *
  *           protocol flags sent by proxy.                                      *
+ *           When stream is set the received data is passed to stream while    *
+ *           receiving and only the data left for processing is returned.      *
  *                                                                              *
  ********************************************************************************/
 static int	get_data_from_proxy(zbx_dc_proxy_t *proxy, const char *request, int config_timeout,
-		int config_trapper_timeout, const char *config_source_ip, char **data, zbx_timespec_t *ts)
+		int config_trapper_timeout, const char *config_source_ip, char **data, zbx_timespec_t *ts,
+		zbx_proxy_data_stream_t *stream)
 {
 	zbx_socket_t	s;
 	struct zbx_json	j;
 	int		ret, flags = ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS;
 	char		*buffer = NULL;
+	const char	*json;
 	size_t		buffer_size, reserved = 0;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s() request:'%s'", __func__, request);
@@ -177,6 +197,7 @@ static int	get_data_from_proxy(zbx_dc_proxy_t *proxy, const char *request, int c
 	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
 
 	zbx_json_addstring(&j, "request", request, ZBX_JSON_TYPE_STRING);
+	zbx_add_compress_codecs(&j);
 
 	if (SUCCEED != zbx_compress(j.buffer, j.buffer_size, &buffer, &buffer_size))
 	{
@@ -199,7 +220,7 @@ static int	get_data_from_proxy(zbx_dc_proxy_t *proxy, const char *request, int c
 
 		if (SUCCEED == ret)
 		{
-			if (SUCCEED == (ret = recv_data_from_proxy(proxy, &s)))
+			if (SUCCEED == (ret = recv_data_from_proxy(proxy, &s, stream, &json)))
 			{
 				if (!ZBX_IS_RUNNING())
 				{
@@ -218,10 +239,11 @@ static int	get_data_from_proxy(zbx_dc_proxy_t *proxy, const char *request, int c
 				else
 				{
 					ret = zbx_send_proxy_data_response(proxy, &s, NULL, SUCCEED,
-							ZBX_PROXY_UPLOAD_UNDEFINED, 0);
+							ZBX_PROXY_UPLOAD_UNDEFINED, s.protocol & ZBX_TCP_COMPRESS_CODECS,
+							0);
 
 					if (SUCCEED == ret)
-						*data = zbx_strdup(*data, s.buffer);
+						*data = zbx_strdup(*data, json);
 				}
 			}
 		}
@@ -371,6 +393,8 @@ out:
  * Parameters: rtc                 - [IN] RTC socket                          *
  *             proxy               - [IN/OUT] proxy data                      *
  *             answer              - [IN] data received from proxy            *
+ *             stream              - [IN] proxy data stream the answer was    *
+ *                                        received with, optional             *
  *             ts                  - [IN] timestamp when the proxy connection *
  *                                        was established                     *
  *             events_cbs          - [IN]                                     *
@@ -385,7 +409,8 @@ out:
  *                                                                            *
  ******************************************************************************/
 static int	proxy_process_proxy_data(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t *proxy, const char *answer,
-		zbx_timespec_t *ts, const zbx_events_funcs_t *events_cbs, int proxydata_frequency, int *more)
+		zbx_proxy_data_stream_t *stream, zbx_timespec_t *ts, const zbx_events_funcs_t *events_cbs,
+		int proxydata_frequency, int *more)
 {
 	struct zbx_json_parse	jp;
 	char			*error = NULL, *version_str = NULL;
@@ -420,11 +445,12 @@ static int	proxy_process_proxy_data(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t
 		goto out;
 	}
 
-	if (SUCCEED != (ret = zbx_process_proxy_data(rtc, proxy, &jp, ts, PROXY_OPERATING_MODE_PASSIVE, events_cbs,
-			proxydata_frequency, zbx_discovery_update_host_server, zbx_discovery_update_hosts_server,
-			zbx_discovery_update_service_server, zbx_discovery_update_service_down_server,
-			zbx_discovery_find_host_server, zbx_discovery_update_drule_server,
-			zbx_autoreg_host_free_server, (zbx_autoreg_flush_hosts_func_t)zbx_autoreg_flush_hosts_server,
+	if (SUCCEED != (ret = zbx_process_proxy_data(rtc, proxy, &jp, stream, ts, PROXY_OPERATING_MODE_PASSIVE,
+			events_cbs, proxydata_frequency, zbx_discovery_update_host_server,
+			zbx_discovery_update_hosts_server, zbx_discovery_update_service_server,
+			zbx_discovery_update_service_down_server, zbx_discovery_find_host_server,
+			zbx_discovery_update_drule_server, zbx_autoreg_host_free_server,
+			(zbx_autoreg_flush_hosts_func_t)zbx_autoreg_flush_hosts_server,
 			(zbx_autoreg_prepare_host_func_t)zbx_autoreg_prepare_host_server, more, &error)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "proxy \"%s\" at \"%s\" returned invalid proxy data: %s",
@@ -464,14 +490,18 @@ static int	proxy_get_data(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t *proxy, in
 		int config_trapper_timeout, const zbx_events_funcs_t *events_cbs, int proxydata_frequency,
 		const char *config_source_ip, int *more)
 {
-	char		*answer = NULL;
-	int		ret;
-	zbx_timespec_t	ts;
+	char			*answer = NULL;
+	int			ret;
+	zbx_timespec_t		ts;
+	zbx_proxy_data_stream_t	*stream;
 
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
+	stream = zbx_proxy_data_stream_create(rtc, proxy, NULL, NULL, &ts, PROXY_OPERATING_MODE_PASSIVE,
+			proxydata_frequency);
+
 	if (SUCCEED != (ret = get_data_from_proxy(proxy, ZBX_PROTO_VALUE_PROXY_DATA, config_timeout,
-			config_trapper_timeout, config_source_ip, &answer, &ts)))
+			config_trapper_timeout, config_source_ip, &answer, &ts, stream)))
 	{
 		goto out;
 	}
@@ -487,9 +517,11 @@ static int	proxy_get_data(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t *proxy, in
 	}
 
 	proxy->lastaccess = time(NULL);
-	ret = proxy_process_proxy_data(rtc, proxy, answer, &ts, events_cbs, proxydata_frequency, more);
+	ret = proxy_process_proxy_data(rtc, proxy, answer, stream, &ts, events_cbs, proxydata_frequency, more);
 	zbx_free(answer);
 out:
+	zbx_proxy_data_stream_free(stream);
+
 	if (SUCCEED == ret)
 		zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s more:%d", __func__, zbx_result_string(ret), *more);
 	else
@@ -528,7 +560,7 @@ static int	proxy_get_tasks(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t *proxy, i
 	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
 
 	if (SUCCEED != (ret = get_data_from_proxy(proxy, ZBX_PROTO_VALUE_PROXY_TASKS, config_timeout,
-			config_trapper_timeout, config_source_ip, &answer, &ts)))
+			config_trapper_timeout, config_source_ip, &answer, &ts, NULL)))
 	{
 		goto out;
 	}
@@ -545,7 +577,7 @@ static int	proxy_get_tasks(zbx_ipc_async_socket_t *rtc, zbx_dc_proxy_t *proxy, i
 
 	proxy->lastaccess = time(NULL);
 
-	ret = proxy_process_proxy_data(rtc, proxy, answer, &ts, events_cbs, proxydata_frequency, &more);
+	ret = proxy_process_proxy_data(rtc, proxy, answer, NULL, &ts, events_cbs, proxydata_frequency, &more);
 
 	zbx_free(answer);
 out:
@@ -338,6 +338,9 @@ static zbx_uint64_t	config_trend_func_cache_size	= 4 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_value_cache_size		= 8 * ZBX_MEBIBYTE;
 static zbx_uint64_t	config_vmware_cache_size	= 8 * ZBX_MEBIBYTE;
 
+static int	config_value_cache_lockfree_reads	= 0;
+static int	config_value_cache_compression		= 0;
+
 static int	config_unreachable_period		= 45;
 static int	config_unreachable_delay		= 15;
 static int	config_max_concurrent_checks_per_poller	= 1000;
@@ -1033,6 +1036,10 @@ static void	zbx_load_config(ZBX_TASK_EX *task)
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(2) * ZBX_GIBIBYTE},
 		{"ValueCacheSize",		&config_value_cache_size,		ZBX_CFG_TYPE_UINT64,
 				ZBX_CONF_PARM_OPT,	0,			__UINT64_C(64) * ZBX_GIBIBYTE},
+		{"ValueCacheLockFreeReads",	&config_value_cache_lockfree_reads,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
+		{"ValueCacheCompression",	&config_value_cache_compression,	ZBX_CFG_TYPE_INT,
+				ZBX_CONF_PARM_OPT,	0,			1},
 		{"CacheUpdateFrequency",	&config_confsyncer_frequency,		ZBX_CFG_TYPE_INT,
 				ZBX_CONF_PARM_OPT,	1,			SEC_PER_HOUR},
 		{"HousekeepingFrequency",	&config_housekeeping_frequency,		ZBX_CFG_TYPE_INT,
@@ -1719,6 +1726,7 @@ static void	start_processes(zbx_socket_t *listen_sock, zbx_proc_startup_t *runle
 			.config_ssh_key_location = config_ssh_key_location,
 			.config_webdriver_url = config_webdriver_url,
 			.trapper_process_request_func_cb = zbx_trapper_process_request_server,
+			.trapper_stream_request_func_cb = zbx_trapper_stream_request_server,
 			.autoreg_update_host_cb = zbx_autoreg_update_host_server,
 			.config_frontend_allowed_ip = config_frontend_allowed_ip,
 			.config_bridge_adapter_url = config_bridge_adapter_url,
@@ -2158,10 +2166,12 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 {
 	char			*error = NULL;
 	int			ret = FAIL;
+	unsigned char		vc_flags = 0;
 	zbx_proc_startup_t	*runlevels = NULL;
 
-	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_history_cache_server,
-			config_history_cache_size, config_history_index_cache_size, &config_trends_cache_size, &error))
+	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, get_config_forks,
+			zbx_sync_history_cache_server, config_history_cache_size, config_history_index_cache_size,
+			&config_trends_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
@@ -2185,7 +2195,13 @@ static int	server_startup(zbx_socket_t *listen_sock, int *ha_stat, int *ha_failo
 		goto out;
 	}
 
-	if (SUCCEED != zbx_vc_init(config_value_cache_size, &error))
+	if (0 != config_value_cache_lockfree_reads)
+		vc_flags |= ZBX_VC_FLAG_LOCKFREE_READS;
+
+	if (0 != config_value_cache_compression)
+		vc_flags |= ZBX_VC_FLAG_COMPRESSION;
+
+	if (SUCCEED != zbx_vc_init(config_value_cache_size, vc_flags, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize history value cache: %s", error);
 		zbx_free(error);
@@ -2698,8 +2714,9 @@ int	MAIN_ZABBIX_ENTRY(int flags)
 		goto out;
 	}
 
-	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, zbx_sync_history_cache_server,
-			config_history_cache_size, config_history_index_cache_size, &config_trends_cache_size, &error))
+	if (SUCCEED != zbx_init_database_cache(get_zbx_program_type, get_config_forks,
+			zbx_sync_history_cache_server, config_history_cache_size, config_history_index_cache_size,
+			&config_trends_cache_size, &error))
 	{
 		zabbix_log(LOG_LEVEL_CRIT, "cannot initialize database cache: %s", error);
 		zbx_free(error);
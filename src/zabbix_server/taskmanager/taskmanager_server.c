@@ -17,6 +17,7 @@
 #include "../db_lengths_constants.h"
 #include "../events/events.h"
 #include "../actions/actions.h"
+#include "../lld/lld_protocol.h"
 #include "../audit/audit_server.h"
 
 #include "zbxtimekeeper.h"
@@ -661,7 +662,7 @@ static int	tm_process_check_now(zbx_vector_uint64_t *taskids)
 {
 	zbx_db_row_t		row;
 	zbx_db_result_t		result;
-	int			processed_num = 0;
+	int			processed_num = 0, now;
 	char			*sql = NULL;
 	size_t			sql_alloc = 0, sql_offset = 0;
 	zbx_vector_tm_task_t	tasks;
@@ -726,8 +727,12 @@ static int	tm_process_check_now(zbx_vector_uint64_t *taskids)
 			zbx_vector_uint64_append(&itemids, data->itemid);
 		}
 
+		now = (int)time(NULL);
 		proxyids = (zbx_uint64_t *)zbx_malloc(NULL, tasks.values_num * sizeof(zbx_uint64_t));
-		zbx_dc_reschedule_items(&itemids, time(NULL), proxyids);
+		zbx_dc_reschedule_items(&itemids, now, proxyids);
+
+		/* discovery rules must process the requested values even if discovery data did not change */
+		zbx_lld_check_now(&itemids, now);
 
 		sql_offset = 0;
 
@@ -27,8 +27,25 @@
 #include "zbxtasks.h"
 #include "zbxcacheconfig.h"
 
+/******************************************************************************
+ *                                                                            *
+ * Purpose: sends response to 'proxy data' request or data                    *
+ *                                                                            *
+ * Parameters: proxy          - [IN] the proxy                                *
+ *             sock           - [IN] connection socket                        *
+ *             info           - [IN] the info message (optional)              *
+ *             status         - [IN] the processing status                    *
+ *             upload_status  - [IN] the history upload status                *
+ *             codec          - [IN] the compression codec flag               *
+ *                                   (ZBX_TCP_COMPRESS_*), 0 for zlib         *
+ *             config_timeout - [IN]                                          *
+ *                                                                            *
+ * Comments: The codec flag in response header tells active proxy to compress *
+ *           next data with this codec.                                       *
+ *                                                                            *
+ ******************************************************************************/
 int	zbx_send_proxy_data_response(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock, const char *info, int status,
-		int upload_status, int config_timeout)
+		int upload_status, unsigned char codec, int config_timeout)
 {
 	struct zbx_json		json;
 	zbx_vector_tm_task_t	tasks;
@@ -65,7 +82,7 @@ int	zbx_send_proxy_data_response(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock
 	if (0 != tasks.values_num)
 		zbx_tm_json_serialize_tasks(&json, &tasks);
 
-	flags |= ZBX_TCP_COMPRESS;
+	flags |= ZBX_TCP_COMPRESS | codec;
 
 	if (SUCCEED == (ret = zbx_tcp_send_ext(sock, json.buffer, strlen(json.buffer), 0, flags, config_timeout)))
 	{
@@ -85,19 +102,24 @@ int	zbx_send_proxy_data_response(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock
  *                                                                            *
  * Purpose: checks if 'proxy data' packet has more flag                       *
  *                                                                            *
- * Return value: SUCCEED - 'proxy data' contains more flag                    *
- *               FAIL    - otherwise                                          *
+ * Parameters: jp              - [IN] received JSON data                      *
+ *             pending_history - [IN] the result if more flag is missing      *
+ *                                                                            *
+ * Return value: ZBX_PROXY_PENDING_HISTORY_YES - 'proxy data' contains more   *
+ *                                               flag                         *
+ *               ZBX_PROXY_PENDING_HISTORY_NO  - 'proxy data' contains no     *
+ *                                               more flag                    *
  *                                                                            *
  ******************************************************************************/
-static int	proxy_data_has_pending_history(const struct zbx_json_parse *jp)
+static int	proxy_data_has_pending_history(const struct zbx_json_parse *jp, int pending_history)
 {
 	char	value[MAX_STRING_LEN];
 
-	if (SUCCEED == zbx_json_value_by_name(jp, ZBX_PROTO_TAG_MORE, value, sizeof(value), NULL) &&
-			1 == atoi(value))
-	{
+	if (SUCCEED != zbx_json_value_by_name(jp, ZBX_PROTO_TAG_MORE, value, sizeof(value), NULL))
+		return pending_history;
+
+	if (1 == atoi(value))
 		return ZBX_PROXY_PENDING_HISTORY_YES;
-	}
 
 	return ZBX_PROXY_PENDING_HISTORY_NO;
 }
@@ -129,114 +151,319 @@ static int	proxy_data_no_history(const struct zbx_json_parse *jp)
 	return SUCCEED;
 }
 
+/* 'proxy data' request receiving state */
+typedef struct
+{
+	zbx_ipc_async_socket_t		*rtc;
+	zbx_socket_t			*sock;
+	const zbx_timespec_t		*ts;
+	const zbx_events_funcs_t	*events_cbs;
+	int				config_timeout;
+	int				proxydata_frequency;
+
+	/* set when history data is processed while receiving */
+	zbx_proxy_data_stream_t		*stream;
+
+	/* set when proxy was checked, before history data or after the whole data was received */
+	unsigned char			checked;
+	zbx_dc_proxy_t			proxy;
+	int				status;
+	int				version_ret;
+	int				history_ret;
+	int				upload_status;
+	char				*version_str;
+	int				version_int;
+	char				*error;
+}
+proxy_data_recv_t;
+
+static void	proxy_data_recv_init(proxy_data_recv_t *recv, zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock,
+		const zbx_timespec_t *ts, const zbx_events_funcs_t *events_cbs, int config_timeout,
+		int proxydata_frequency)
+{
+	memset(recv, 0, sizeof(proxy_data_recv_t));
+
+	recv->rtc = rtc;
+	recv->sock = sock;
+	recv->ts = ts;
+	recv->events_cbs = events_cbs;
+	recv->config_timeout = config_timeout;
+	recv->proxydata_frequency = proxydata_frequency;
+
+	recv->status = FAIL;
+	recv->version_ret = FAIL;
+	recv->history_ret = FAIL;
+}
+
+static void	proxy_data_recv_clear(proxy_data_recv_t *recv)
+{
+	if (NULL != recv->stream)
+		zbx_proxy_data_stream_free(recv->stream);
+
+	zbx_free(recv->error);
+	zbx_free(recv->version_str);
+}
+
 /******************************************************************************
  *                                                                            *
- * Purpose: receives 'proxy data' request from proxy                          *
+ * Purpose: identifies active proxy and checks if its history data can be     *
+ *          accepted                                                          *
  *                                                                            *
- * Parameters: rtc                 - [IN] RTC socket                          *
- *             sock                - [IN] connection socket                   *
- *             jp                  - [IN] received JSON data                  *
- *             ts                  - [IN] connection timestamp                *
- *             events_cbs          - [IN]                                     *
- *             config_timeout      - [IN]                                     *
- *             proxydata_frequency - [IN]                                     *
+ * Parameters: recv    - [IN/OUT] the receiving state                         *
+ *             jp      - [IN] received JSON data                              *
+ *             partial - [IN] 1 if jp contains only members preceding history *
+ *                            data, 0 otherwise                               *
+ *                                                                            *
+ * Return value: SUCCEED - history data can be processed                      *
+ *               FAIL    - otherwise                                          *
  *                                                                            *
  ******************************************************************************/
-void	recv_proxy_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, const struct zbx_json_parse *jp,
-		const zbx_timespec_t *ts, const zbx_events_funcs_t *events_cbs, int config_timeout,
-		int proxydata_frequency)
+static int	proxy_data_check(proxy_data_recv_t *recv, const struct zbx_json_parse *jp, int partial)
 {
-	int			ret = FAIL, upload_status = 0, status, version_int, responded = 0;
-	char			*error = NULL, *version_str = NULL;
-	zbx_dc_proxy_t		proxy;
+	int	pending_history;
 
-	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+	recv->checked = 1;
 
-	if (SUCCEED != (status = zbx_get_active_proxy_from_request(jp, &proxy, &error)))
+	if (SUCCEED != (recv->status = zbx_get_active_proxy_from_request(jp, &recv->proxy, &recv->error)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot parse proxy data from active proxy at \"%s\": %s",
-				sock->peer, error);
-		goto out;
+				recv->sock->peer, recv->error);
+		return FAIL;
 	}
 
-	if (SUCCEED != (status = zbx_proxy_check_permissions(&proxy, sock, &error)))
+	if (SUCCEED != (recv->status = zbx_proxy_check_permissions(&recv->proxy, recv->sock, &recv->error)))
 	{
 		zabbix_log(LOG_LEVEL_WARNING, "cannot accept connection from proxy \"%s\" at \"%s\", allowed address:"
-				" \"%s\": %s", proxy.name, sock->peer, proxy.allowed_addresses, error);
-		goto out;
+				" \"%s\": %s", recv->proxy.name, recv->sock->peer, recv->proxy.allowed_addresses,
+				recv->error);
+		return FAIL;
 	}
 
-	version_str = zbx_get_proxy_protocol_version_str(jp);
-	version_int = zbx_get_proxy_protocol_version_int(version_str);
+	recv->version_str = zbx_get_proxy_protocol_version_str(jp);
+	recv->version_int = zbx_get_proxy_protocol_version_int(recv->version_str);
 
-	if (SUCCEED != zbx_check_protocol_version(&proxy, version_int))
+	if (SUCCEED != (recv->version_ret = zbx_check_protocol_version(&recv->proxy, recv->version_int)))
 	{
-		upload_status = ZBX_PROXY_UPLOAD_DISABLED;
-		error = zbx_strdup(error, "current proxy version is not supported by server");
-		goto reply;
+		recv->upload_status = ZBX_PROXY_UPLOAD_DISABLED;
+		recv->error = zbx_strdup(recv->error, "current proxy version is not supported by server");
+		return FAIL;
 	}
 
-	upload_status = ZBX_PROXY_UPLOAD_ENABLED;
+	recv->upload_status = ZBX_PROXY_UPLOAD_ENABLED;
 
-	if (FAIL == (ret = zbx_hc_check_proxy(proxy.proxyid, proxy_data_has_pending_history(jp)))
-			|| SUCCEED == zbx_vps_monitor_capped())
+	/* more flag follows history data, while receiving use the flag of the previous proxy data */
+	pending_history = proxy_data_has_pending_history(jp, 0 != partial ? recv->proxy.pending_history :
+			ZBX_PROXY_PENDING_HISTORY_NO);
+
+	if (FAIL == (recv->history_ret = zbx_hc_check_proxy(recv->proxy.proxyid, pending_history)) ||
+			SUCCEED == zbx_vps_monitor_capped())
 	{
-		upload_status = ZBX_PROXY_UPLOAD_DISABLED;
-		ret = proxy_data_no_history(jp);
+		recv->upload_status = ZBX_PROXY_UPLOAD_DISABLED;
+		recv->history_ret = FAIL;
 	}
 
+	return recv->history_ret;
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: processes received 'proxy data' request and sends response        *
+ *                                                                            *
+ * Parameters: recv - [IN/OUT] the receiving state                            *
+ *             jp   - [IN] received JSON data, without history data if it      *
+ *                         was processed while receiving                      *
+ *                                                                            *
+ ******************************************************************************/
+static void	proxy_data_process(proxy_data_recv_t *recv, const struct zbx_json_parse *jp)
+{
+	int	ret = FAIL, responded = 0;
+
+	if (0 == recv->checked)
+		(void)proxy_data_check(recv, jp, 0);
+
+	if (SUCCEED != recv->status)
+		goto out;
+
+	if (SUCCEED != recv->version_ret)
+		goto reply;
+
+	if (SUCCEED != (ret = recv->history_ret))
+		ret = proxy_data_no_history(jp);
+
 	if (SUCCEED == ret)
 	{
-		if (SUCCEED != (ret = zbx_process_proxy_data(rtc, &proxy, jp, ts, PROXY_OPERATING_MODE_ACTIVE,
-				events_cbs, proxydata_frequency, zbx_discovery_update_host_server,
-				zbx_discovery_update_hosts_server, zbx_discovery_update_service_server,
-				zbx_discovery_update_service_down_server, zbx_discovery_find_host_server,
-				zbx_discovery_update_drule_server, zbx_autoreg_host_free_server,
-				zbx_autoreg_flush_hosts_server, zbx_autoreg_prepare_host_server, NULL, &error)))
+		if (SUCCEED != (ret = zbx_process_proxy_data(recv->rtc, &recv->proxy, jp, recv->stream, recv->ts,
+				PROXY_OPERATING_MODE_ACTIVE, recv->events_cbs, recv->proxydata_frequency,
+				zbx_discovery_update_host_server, zbx_discovery_update_hosts_server,
+				zbx_discovery_update_service_server, zbx_discovery_update_service_down_server,
+				zbx_discovery_find_host_server, zbx_discovery_update_drule_server,
+				zbx_autoreg_host_free_server, zbx_autoreg_flush_hosts_server,
+				zbx_autoreg_prepare_host_server, NULL, &recv->error)))
 		{
 			zabbix_log(LOG_LEVEL_WARNING, "received invalid proxy data from proxy \"%s\" at \"%s\": %s",
-					proxy.name, sock->peer, error);
+					recv->proxy.name, recv->sock->peer, recv->error);
 			goto out;
 		}
 	}
 
 	if (!ZBX_IS_RUNNING())
 	{
-		error = zbx_strdup(error, "Zabbix server shutdown in progress");
+		recv->error = zbx_strdup(recv->error, "Zabbix server shutdown in progress");
 		zabbix_log(LOG_LEVEL_WARNING, "cannot process proxy data from active proxy at \"%s\": %s",
-				sock->peer, error);
+				recv->sock->peer, recv->error);
 		ret = FAIL;
 		goto out;
 	}
 reply:
-	zbx_send_proxy_data_response(&proxy, sock, error, ret, upload_status, config_timeout);
+	zbx_send_proxy_data_response(&recv->proxy, recv->sock, recv->error, ret, recv->upload_status,
+			zbx_get_compress_codec(jp), recv->config_timeout);
 	responded = 1;
 out:
-	if (SUCCEED == status)	/* moved the unpredictable long operation to the end */
-				/* we are trying to save info about lastaccess to detect communication problem */
+	if (SUCCEED == recv->status)	/* moved the unpredictable long operation to the end */
+					/* we are trying to save info about lastaccess to detect communication problem */
 	{
 		time_t	lastaccess;
 
-		if (ZBX_PROXY_UPLOAD_DISABLED == upload_status)
+		if (ZBX_PROXY_UPLOAD_DISABLED == recv->upload_status)
 			lastaccess = (int)time(NULL);
 		else
-			lastaccess = ts->sec;
+			lastaccess = recv->ts->sec;
 
-		zbx_update_proxy_data(&proxy, version_str, version_int, lastaccess, 0, 0);
+		/* the pending history flag is used when next proxy data is processed while receiving */
+		zbx_update_proxy_data(&recv->proxy, recv->version_str, recv->version_int, lastaccess,
+				proxy_data_has_pending_history(jp, ZBX_PROXY_PENDING_HISTORY_NO),
+				ZBX_FLAGS_PROXY_DIFF_UPDATE_PENDING_HISTORY);
 	}
 
 	if (0 == responded)
 	{
 		int	flags = ZBX_TCP_PROTOCOL;
 
-		if (0 != (sock->protocol & ZBX_TCP_COMPRESS))
+		if (0 != (recv->sock->protocol & ZBX_TCP_COMPRESS))
 			flags |= ZBX_TCP_COMPRESS;
 
-		zbx_send_response_ext(sock, ret, error, NULL, flags, config_timeout);
+		zbx_send_response_ext(recv->sock, ret, recv->error, NULL, flags, recv->config_timeout);
 	}
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: receives 'proxy data' request from proxy                          *
+ *                                                                            *
+ * Parameters: rtc                 - [IN] RTC socket                          *
+ *             sock                - [IN] connection socket                   *
+ *             jp                  - [IN] received JSON data                  *
+ *             ts                  - [IN] connection timestamp                *
+ *             events_cbs          - [IN]                                     *
+ *             config_timeout      - [IN]                                     *
+ *             proxydata_frequency - [IN]                                     *
+ *                                                                            *
+ ******************************************************************************/
+void	recv_proxy_data(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, const struct zbx_json_parse *jp,
+		const zbx_timespec_t *ts, const zbx_events_funcs_t *events_cbs, int config_timeout,
+		int proxydata_frequency)
+{
+	proxy_data_recv_t	recv;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	proxy_data_recv_init(&recv, rtc, sock, ts, events_cbs, config_timeout, proxydata_frequency);
+	proxy_data_process(&recv, jp);
+	proxy_data_recv_clear(&recv);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+static int	proxy_data_stream_check(void *data, const struct zbx_json_parse *jp, const zbx_dc_proxy_t **proxy)
+{
+	proxy_data_recv_t	*recv = (proxy_data_recv_t *)data;
+
+	/* proxy name follows history data, check proxy after the whole data is received */
+	if (NULL == zbx_json_pair_by_name(jp, ZBX_PROTO_TAG_HOST))
+		return ZBX_PROXY_DATA_HISTORY_BUFFER;
+
+	if (SUCCEED != proxy_data_check(recv, jp, 1))
+		return ZBX_PROXY_DATA_HISTORY_DISCARD;
+
+	*proxy = &recv->proxy;
+
+	return ZBX_PROXY_DATA_HISTORY_PROCESS;
+}
+
+static int	proxy_data_stream_feed(void *data, const char *buf, size_t len)
+{
+	proxy_data_recv_t	*recv = (proxy_data_recv_t *)data;
+
+	if (SUCCEED != zbx_proxy_data_stream_feed(recv->stream, buf, len))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid proxy data from active proxy at \"%s\": %s",
+				recv->sock->peer, zbx_json_strerror());
+		return FAIL;
+	}
+
+	return SUCCEED;
+}
+
+static void	proxy_data_stream_process(void *data)
+{
+	proxy_data_recv_t	*recv = (proxy_data_recv_t *)data;
+	const char		*json;
+	struct zbx_json_parse	jp;
+
+	zabbix_log(LOG_LEVEL_DEBUG, "In %s()", __func__);
+
+	if (NULL == (json = zbx_proxy_data_stream_get_json(recv->stream)) || SUCCEED != zbx_json_open(json, &jp))
+	{
+		zabbix_log(LOG_LEVEL_WARNING, "received invalid proxy data from active proxy at \"%s\": %s",
+				recv->sock->peer, zbx_json_strerror());
+		zbx_send_response(recv->sock, FAIL, zbx_json_strerror(), recv->config_timeout);
+	}
+	else
+		proxy_data_process(recv, &jp);
+
+	zabbix_log(LOG_LEVEL_DEBUG, "End of %s()", __func__);
+}
+
+static void	proxy_data_stream_free(void *data)
+{
+	proxy_data_recv_t	*recv = (proxy_data_recv_t *)data;
+
+	proxy_data_recv_clear(recv);
+	zbx_free(recv);
+}
+
+/******************************************************************************
+ *                                                                            *
+ * Purpose: prepares receiving 'proxy data' request from proxy as stream      *
+ *                                                                            *
+ * Parameters: rtc                 - [IN] RTC socket                          *
+ *             sock                - [IN] connection socket                   *
+ *             ts                  - [IN] connection timestamp                *
+ *             events_cbs          - [IN]                                     *
+ *             config_timeout      - [IN]                                     *
+ *             proxydata_frequency - [IN]                                     *
+ *             stream              - [OUT] the trapper request stream         *
+ *                                                                            *
+ * Comments: When proxy name, version and data session precede history data   *
+ *           the proxy is checked before history data and history rows are    *
+ *           processed in batches while receiving. The rest of proxy data is  *
+ *           processed after the whole data is received, the same as by       *
+ *           recv_proxy_data().                                               *
+ *                                                                            *
+ ******************************************************************************/
+void	recv_proxy_data_stream(zbx_ipc_async_socket_t *rtc, zbx_socket_t *sock, const zbx_timespec_t *ts,
+		const zbx_events_funcs_t *events_cbs, int config_timeout, int proxydata_frequency,
+		zbx_trapper_stream_t *stream)
+{
+	proxy_data_recv_t	*recv;
 
-	zbx_free(error);
-	zbx_free(version_str);
+	recv = (proxy_data_recv_t *)zbx_malloc(NULL, sizeof(proxy_data_recv_t));
+	proxy_data_recv_init(recv, rtc, sock, ts, events_cbs, config_timeout, proxydata_frequency);
+	recv->stream = zbx_proxy_data_stream_create(rtc, NULL, proxy_data_stream_check, recv, ts,
+			PROXY_OPERATING_MODE_ACTIVE, proxydata_frequency);
 
-	zabbix_log(LOG_LEVEL_DEBUG, "End of %s():%s", __func__, zbx_result_string(ret));
+	stream->feed_cb = proxy_data_stream_feed;
+	stream->process_cb = proxy_data_stream_process;
+	stream->free_cb = proxy_data_stream_free;
+	stream->data = recv;
 }
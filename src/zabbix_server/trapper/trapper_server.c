@@ -312,3 +312,18 @@ int	zbx_trapper_process_request_server(const char *request, zbx_socket_t *sock,
 
 	return FAIL;
 }
+
+int	zbx_trapper_stream_request_server(const char *request, zbx_socket_t *sock, const zbx_timespec_t *ts,
+		const zbx_config_comms_args_t *config_comms, int proxydata_frequency,
+		const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc, zbx_trapper_stream_t *stream)
+{
+	if (0 == strcmp(request, ZBX_PROTO_VALUE_PROXY_DATA))
+	{
+		recv_proxy_data_stream(rtc, sock, ts, events_cbs, config_comms->config_timeout, proxydata_frequency,
+				stream);
+
+		return SUCCEED;
+	}
+
+	return FAIL;
+}
@@ -22,9 +22,10 @@
 #include "zbxtime.h"
 #include "zbxjson.h"
 #include "zbxipcservice.h"
+#include "zbxtrapper.h"
 
 int	zbx_send_proxy_data_response(const zbx_dc_proxy_t *proxy, zbx_socket_t *sock, const char *info, int status,
-		int upload_status, int config_timeout);
+		int upload_status, unsigned char codec, int config_timeout);
 
 int	zbx_trapper_process_request_server(const char *request, zbx_socket_t *sock, const struct zbx_json_parse *jp,
 		const zbx_timespec_t *ts, const zbx_config_comms_args_t *config_comms,
@@ -33,5 +34,8 @@ int	zbx_trapper_process_request_server(const char *request, zbx_socket_t *sock,
 		zbx_get_config_forks_f get_config_forks,
 		const zbx_config_tls_t *config_tls, const char *config_frontend_allowed_ip,
 		zbx_ipc_async_socket_t *rtc);
+int	zbx_trapper_stream_request_server(const char *request, zbx_socket_t *sock, const zbx_timespec_t *ts,
+		const zbx_config_comms_args_t *config_comms, int proxydata_frequency,
+		const zbx_events_funcs_t *events_cbs, zbx_ipc_async_socket_t *rtc, zbx_trapper_stream_t *stream);
 
 #endif
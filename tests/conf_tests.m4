@@ -56,6 +56,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxcomms/Makefile
 			tests/libs/zbxcommshigh/Makefile
 			tests/libs/zbxcfg/Makefile
+			tests/libs/zbxcachehistory/Makefile
 			tests/libs/zbxcachevalue/Makefile
 			tests/libs/zbxcacheconfig/Makefile
 			tests/libs/zbxdb/Makefile
@@ -65,6 +66,7 @@ AC_DEFUN([CONF_TESTS],
 			tests/libs/zbxfile/Makefile
 			tests/libs/zbxhistory/Makefile
 			tests/libs/zbxicmpping/Makefile
+			tests/libs/zbxipcservice/Makefile
 			tests/libs/zbxjson/Makefile
 			tests/libs/zbxmodules/Makefile
 			tests/libs/zbxnum/Makefile
@@ -0,0 +1,170 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "../../../src/libs/zbxcacheconfig/dbsync.c"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#define DBSYNC_TEST_COLUMNS_NUM		3
+#define DBSYNC_TEST_COMPARES_MAX	32
+
+static zbx_dbsync_t	test_syncs[DBSYNC_TEST_COMPARES_MAX];
+static zbx_dbsync_t	test_syncs_serial[DBSYNC_TEST_COMPARES_MAX];
+
+/* database connection used to calculate changeset, NULL for the default connection */
+static zbx_dbconn_t	*test_conns[DBSYNC_TEST_COMPARES_MAX];
+
+static int		test_rows_num, test_fail_index;
+
+/* generates changeset rows depending only on changeset index, like diffing the same table would */
+static int	test_compare(zbx_dbsync_t *sync)
+{
+	int			index;
+	char			id[MAX_ID_LEN + 1], name[64], value[64];
+	const struct timespec	delay = {0, 1000000};
+
+	if (sync >= test_syncs && sync < test_syncs + DBSYNC_TEST_COMPARES_MAX)
+	{
+		index = (int)(sync - test_syncs);
+		test_conns[index] = dbsync_conn;
+
+		/* let other threads take the next changesets */
+		nanosleep(&delay, NULL);
+	}
+	else
+		index = (int)(sync - test_syncs_serial);
+
+	if (index == test_fail_index)
+		return FAIL;
+
+	dbsync_prepare(sync, DBSYNC_TEST_COLUMNS_NUM, NULL);
+
+	for (int i = 0; i < test_rows_num; i++)
+	{
+		char	*row[DBSYNC_TEST_COLUMNS_NUM] = {id, name, value};
+
+		zbx_snprintf(id, sizeof(id), "%d", i + 1);
+		zbx_snprintf(name, sizeof(name), "name%d", i % 7);
+		zbx_snprintf(value, sizeof(value), "value%d.%d", index, i);
+
+		dbsync_add_row(sync, (zbx_uint64_t)(i + 1), (unsigned char)(ZBX_DBSYNC_ROW_ADD + i % 3), row);
+	}
+
+	return SUCCEED;
+}
+
+static void	test_compare_changesets(const zbx_dbsync_t *sync, const zbx_dbsync_t *sync_serial)
+{
+	zbx_mock_assert_int_eq("rows", sync_serial->rows.values_num, sync->rows.values_num);
+	zbx_mock_assert_int_eq("added rows", sync_serial->add_num, sync->add_num);
+	zbx_mock_assert_int_eq("updated rows", sync_serial->update_num, sync->update_num);
+	zbx_mock_assert_int_eq("removed rows", sync_serial->remove_num, sync->remove_num);
+
+	for (int i = 0; i < sync->rows.values_num; i++)
+	{
+		const zbx_dbsync_row_t	*row = (const zbx_dbsync_row_t *)sync->rows.values[i],
+					*row_serial = (const zbx_dbsync_row_t *)sync_serial->rows.values[i];
+
+		zbx_mock_assert_uint64_eq("rowid", row_serial->rowid, row->rowid);
+		zbx_mock_assert_int_eq("tag", row_serial->tag, row->tag);
+
+		for (int j = 0; j < DBSYNC_TEST_COLUMNS_NUM; j++)
+		{
+			zbx_mock_assert_str_eq("column", row_serial->row[j], row->row[j]);
+
+			/* string pool must not be corrupted by concurrent changeset calculation */
+			zbx_mock_assert_ptr_eq("pooled string", row_serial->row[j], row->row[j]);
+		}
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_dbsync_compare_t	compares[DBSYNC_TEST_COMPARES_MAX];
+	int			compares_num, conns_num, parallel = 0, ret;
+	unsigned char		mode;
+
+	ZBX_UNUSED(state);
+
+	compares_num = zbx_mock_get_parameter_int("in.compares");
+	conns_num = zbx_mock_get_parameter_int("in.connections");
+	test_rows_num = zbx_mock_get_parameter_int("in.rows");
+	test_fail_index = (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.fail") ?
+			zbx_mock_get_parameter_int("in.fail") : -1);
+	mode = (0 == strcmp(zbx_mock_get_parameter_string("in.mode"), "INIT") ? ZBX_DBSYNC_INIT :
+			ZBX_DBSYNC_UPDATE);
+
+	if (DBSYNC_TEST_COMPARES_MAX < compares_num || ZBX_DBSYNC_THREADS_MAX <= conns_num)
+		fail_msg("too many changesets or connections");
+
+	zbx_hashset_create(&dbsync_env.strpool, 100, dbsync_strpool_hash_func, dbsync_strpool_compare_func);
+	dbsync_env.changelog_num = zbx_mock_get_parameter_int("in.changelog");
+
+	/* connections are only passed to calculation threads, so they are not opened */
+	for (int i = 0; i < conns_num; i++)
+		dbsync_env.conns[i] = (zbx_dbconn_t *)&dbsync_env.conns[i];
+
+	dbsync_env.conns_num = conns_num;
+	dbsync_env.conns_opened = 1;
+
+	/* rows are stored in changesets like in update mode, the mode only decides about parallel calculation */
+	for (int i = 0; i < compares_num; i++)
+	{
+		dbsync_init(&test_syncs[i], ZBX_DBSYNC_UPDATE);
+		test_syncs[i].mode = mode;
+		dbsync_init(&test_syncs_serial[i], ZBX_DBSYNC_UPDATE);
+
+		compares[i].compare_func = test_compare;
+		compares[i].sync = &test_syncs[i];
+		test_conns[i] = NULL;
+	}
+
+	ret = zbx_dbsync_compare_parallel(compares, compares_num);
+	zbx_mock_assert_int_eq("return value", zbx_mock_str_to_return_code(zbx_mock_get_parameter_string(
+			"out.return")), ret);
+
+	for (int i = 0; i < compares_num; i++)
+	{
+		if (NULL != test_conns[i])
+			parallel = 1;
+	}
+
+	zbx_mock_assert_int_eq("calculated in parallel", zbx_mock_get_parameter_int("out.parallel"), parallel);
+
+	if (SUCCEED == ret)
+	{
+		for (int i = 0; i < compares_num; i++)
+		{
+			zbx_mock_assert_int_eq("serial calculation", SUCCEED, test_compare(&test_syncs_serial[i]));
+			test_compare_changesets(&test_syncs[i], &test_syncs_serial[i]);
+		}
+	}
+
+	for (int i = 0; i < compares_num; i++)
+	{
+		test_syncs[i].mode = ZBX_DBSYNC_UPDATE;
+		zbx_dbsync_clear(&test_syncs[i]);
+		zbx_dbsync_clear(&test_syncs_serial[i]);
+	}
+
+	zbx_mock_assert_int_eq("string pool", 0, dbsync_env.strpool.num_data);
+	zbx_hashset_destroy(&dbsync_env.strpool);
+
+	memset(&dbsync_env.conns, 0, sizeof(dbsync_env.conns));
+	dbsync_env.conns_num = 0;
+	dbsync_env.conns_opened = 0;
+}
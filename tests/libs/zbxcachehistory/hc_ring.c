@@ -0,0 +1,350 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "../../../src/libs/zbxcachehistory/cachehistory.c"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#define HC_RING_TEST_GROW		1
+#define HC_RING_TEST_WRAP		2
+#define HC_RING_TEST_FLUSH		3
+#define HC_RING_TEST_CLEAR		4
+#define HC_RING_TEST_FRAGMENTED		5
+#define HC_RING_TEST_POOL		6
+
+static int	get_test_type(const char *str)
+{
+	if (0 == strcmp(str, "GROW"))
+		return HC_RING_TEST_GROW;
+
+	if (0 == strcmp(str, "WRAP"))
+		return HC_RING_TEST_WRAP;
+
+	if (0 == strcmp(str, "FLUSH"))
+		return HC_RING_TEST_FLUSH;
+
+	if (0 == strcmp(str, "CLEAR"))
+		return HC_RING_TEST_CLEAR;
+
+	if (0 == strcmp(str, "FRAGMENTED"))
+		return HC_RING_TEST_FRAGMENTED;
+
+	if (0 == strcmp(str, "POOL"))
+		return HC_RING_TEST_POOL;
+
+	fail_msg("unknown test type: %s", str);
+	return FAIL;
+}
+
+static void	mock_read_sizes(const char *path, zbx_vector_int32_t *sizes)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hsizes, hvalue;
+	int			value;
+
+	hsizes = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hsizes, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_int(hvalue, &value)))
+			fail_msg("Cannot read vector member: %s", zbx_mock_error_string(err));
+
+		zbx_vector_int32_append(sizes, value);
+	}
+}
+
+static void	hc_ring_test_init(void)
+{
+	char	*error = NULL;
+
+	if (SUCCEED != zbx_shmem_create(&shard_mem, zbx_mock_get_parameter_uint64("in.memory"), "history cache",
+			"HistoryCacheSize", 1, &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+}
+
+/* creates item with tail node holding value 0, like history cache does for the first value */
+static void	hc_ring_test_item_init(zbx_hc_item_t *item)
+{
+	memset(item, 0, sizeof(zbx_hc_item_t));
+
+	item->tail = (zbx_hc_data_t *)__hc_shmem_malloc_func(NULL, sizeof(zbx_hc_data_t));
+	memset(item->tail, 0, sizeof(zbx_hc_data_t));
+	item->head = item->tail;
+}
+
+static void	hc_ring_test_append(zbx_hc_item_t *item, zbx_uint64_t value)
+{
+	dc_item_value_t	item_value;
+
+	memset(&item_value, 0, sizeof(item_value));
+	item_value.value_type = ITEM_VALUE_TYPE_UINT64;
+	item_value.state = ITEM_STATE_NORMAL;
+	item_value.value.value_uint = value;
+	item_value.ts.sec = (int)value;
+
+	zbx_mock_assert_int_eq("ring accepts value", SUCCEED, hc_ring_accepts_value(item->ring, &item_value));
+	zbx_mock_assert_int_eq("ring append", SUCCEED, hc_ring_append(item, &item_value));
+}
+
+static void	hc_ring_test_pop(zbx_hc_item_t *item, zbx_uint64_t value)
+{
+	zbx_hc_data_t	data;
+
+	if (NULL == item->ring)
+		fail_msg("ring is empty while expecting value " ZBX_FS_UI64, value);
+
+	hc_ring_pop(item, &data);
+
+	zbx_mock_assert_uint64_eq("popped value", value, data.value.ui64);
+	zbx_mock_assert_int_eq("popped timestamp", (int)value, data.ts.sec);
+	zbx_mock_assert_int_eq("popped value type", ITEM_VALUE_TYPE_UINT64, data.value_type);
+}
+
+static void	hc_ring_test_check_chunks(const zbx_hc_ring_t *ring)
+{
+	zbx_vector_int32_t	sizes;
+	int			i = 0;
+
+	zbx_vector_int32_create(&sizes);
+	mock_read_sizes("out.chunks", &sizes);
+
+	for (const zbx_hc_ring_chunk_t *chunk = ring->tail; NULL != chunk; chunk = chunk->next, i++)
+	{
+		if (i >= sizes.values_num)
+			fail_msg("more chunks than expected %d", sizes.values_num);
+
+		zbx_mock_assert_int_eq("chunk size", sizes.values[i], chunk->values_alloc);
+	}
+
+	zbx_mock_assert_int_eq("number of chunks", sizes.values_num, i);
+	zbx_vector_int32_destroy(&sizes);
+}
+
+/* appends values and checks chunk sizes, the first chunk must stay in place */
+static void	test_hc_ring_grow(void)
+{
+	zbx_hc_item_t	item;
+	zbx_uint64_t	values_num;
+
+	hc_ring_test_item_init(&item);
+	values_num = zbx_mock_get_parameter_uint64("in.values");
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_append(&item, i);
+
+	zbx_mock_assert_int_eq("ring values", (int)values_num, item.ring->values_num);
+	zbx_mock_assert_ptr_eq("first chunk", &item.ring->chunk, item.ring->tail);
+	hc_ring_test_check_chunks(item.ring);
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_pop(&item, i);
+
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+}
+
+/* appends and pops values in batches, so values cross chunk boundaries while ring is not empty */
+static void	test_hc_ring_wrap(void)
+{
+	zbx_hc_item_t	item;
+	zbx_uint64_t	iterations, append_num, pop_num, appended = 0, popped = 0;
+
+	hc_ring_test_item_init(&item);
+	iterations = zbx_mock_get_parameter_uint64("in.iterations");
+	append_num = zbx_mock_get_parameter_uint64("in.append");
+	pop_num = zbx_mock_get_parameter_uint64("in.pop");
+
+	for (zbx_uint64_t i = 0; i < iterations; i++)
+	{
+		for (zbx_uint64_t j = 0; j < append_num; j++)
+			hc_ring_test_append(&item, ++appended);
+
+		for (zbx_uint64_t j = 0; j < pop_num && popped < appended; j++)
+			hc_ring_test_pop(&item, ++popped);
+	}
+
+	zbx_mock_assert_int_eq("ring values", (int)(appended - popped), NULL == item.ring ? 0 : item.ring->values_num);
+
+	while (popped < appended)
+		hc_ring_test_pop(&item, ++popped);
+
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+}
+
+/* moves ring values to history data nodes and checks that they follow existing nodes in order */
+static void	test_hc_ring_flush(void)
+{
+	zbx_hc_item_t	item;
+	zbx_hc_data_t	*data;
+	zbx_uint64_t	values_num, value = 0;
+
+	hc_ring_test_item_init(&item);
+	values_num = zbx_mock_get_parameter_uint64("in.values");
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_append(&item, i);
+
+	zbx_mock_assert_int_eq("ring flush", SUCCEED, hc_ring_flush(&item));
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+
+	for (data = item.tail; NULL != data; data = data->next, value++)
+	{
+		zbx_mock_assert_uint64_eq("node value", value, data->value.ui64);
+
+		if (NULL == data->next)
+			zbx_mock_assert_ptr_eq("head node", item.head, data);
+	}
+
+	zbx_mock_assert_uint64_eq("number of nodes", values_num + 1, value);
+}
+
+/* removes all ring values except the newest one */
+static void	test_hc_ring_clear(void)
+{
+	zbx_hc_item_t	item;
+	zbx_uint64_t	values_num;
+
+	hc_ring_test_item_init(&item);
+	values_num = zbx_mock_get_parameter_uint64("in.values");
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_append(&item, i);
+
+	zbx_mock_assert_int_eq("removed values", (int)values_num - 1, hc_ring_clear_middle(&item));
+	zbx_mock_assert_ptr_eq("single chunk", item.ring->head, item.ring->tail);
+
+	hc_ring_test_pop(&item, values_num);
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+}
+
+/* leaves only holes fitting ring header in shared memory, so ring must grow with the smallest chunks */
+static void	test_hc_ring_fragmented(void)
+{
+	zbx_hc_item_t		item;
+	zbx_vector_ptr_t	blocks;
+	zbx_uint64_t		values_num;
+	size_t			hole_size;
+	void			*ptr;
+
+	hc_ring_test_item_init(&item);
+	values_num = zbx_mock_get_parameter_uint64("in.values");
+
+	zbx_vector_ptr_create(&blocks);
+	hole_size = ZBX_SIZE_T_ALIGN8(sizeof(zbx_hc_ring_t)) + ZBX_HC_RING_VALUES_SIZE(ZBX_HC_RING_CHUNK_MIN);
+
+	while (NULL != (ptr = __hc_shmem_malloc_func(NULL, hole_size)))
+		zbx_vector_ptr_append(&blocks, ptr);
+
+	for (int i = 0; i < blocks.values_num; i += 2)
+		__hc_shmem_free_func(blocks.values[i]);
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_append(&item, i);
+
+	hc_ring_test_check_chunks(item.ring);
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_pop(&item, i);
+
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+
+	for (int i = 1; i < blocks.values_num; i += 2)
+		__hc_shmem_free_func(blocks.values[i]);
+
+	zbx_vector_ptr_destroy(&blocks);
+}
+
+/* fills shard memory, so ring must be allocated from shared history pool and returned there when emptied */
+static void	test_hc_ring_pool(void)
+{
+	zbx_hc_item_t		item;
+	zbx_vector_ptr_t	blocks;
+	zbx_uint64_t		values_num, pool_used;
+	char			*error = NULL;
+	void			*ptr;
+
+	if (SUCCEED != zbx_shmem_create(&hc_pool_mem, zbx_mock_get_parameter_uint64("in.pool"), "history cache pool",
+			"HistoryCacheSize", 1, &error))
+	{
+		fail_msg("cannot create shared memory: %s", error);
+	}
+
+	hc_ring_test_item_init(&item);
+	values_num = zbx_mock_get_parameter_uint64("in.values");
+	pool_used = hc_pool_mem->used_size;
+
+	zbx_vector_ptr_create(&blocks);
+
+	while (NULL != (ptr = zbx_shmem_malloc(shard_mem, NULL, SHMEM_MIN_ALLOC)))
+		zbx_vector_ptr_append(&blocks, ptr);
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_append(&item, i);
+
+	zbx_mock_assert_int_eq("ring in pool", SUCCEED, hc_pool_owns(item.ring));
+
+	for (const zbx_hc_ring_chunk_t *chunk = item.ring->tail; NULL != chunk; chunk = chunk->next)
+		zbx_mock_assert_int_eq("chunk in pool", SUCCEED, hc_pool_owns(chunk));
+
+	hc_ring_test_check_chunks(item.ring);
+
+	for (zbx_uint64_t i = 1; i <= values_num; i++)
+		hc_ring_test_pop(&item, i);
+
+	zbx_mock_assert_ptr_eq("ring", NULL, item.ring);
+	zbx_mock_assert_uint64_eq("pool used size", pool_used, hc_pool_mem->used_size);
+
+	for (int i = 0; i < blocks.values_num; i++)
+		__hc_shmem_free_func(blocks.values[i]);
+
+	zbx_vector_ptr_destroy(&blocks);
+
+	zbx_shmem_destroy(hc_pool_mem);
+	hc_pool_mem = NULL;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	hc_ring_test_init();
+
+	switch (get_test_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case HC_RING_TEST_GROW:
+			test_hc_ring_grow();
+			break;
+		case HC_RING_TEST_WRAP:
+			test_hc_ring_wrap();
+			break;
+		case HC_RING_TEST_FLUSH:
+			test_hc_ring_flush();
+			break;
+		case HC_RING_TEST_CLEAR:
+			test_hc_ring_clear();
+			break;
+		case HC_RING_TEST_FRAGMENTED:
+			test_hc_ring_fragmented();
+			break;
+		case HC_RING_TEST_POOL:
+			test_hc_ring_pool();
+			break;
+	}
+
+	zbx_shmem_destroy(shard_mem);
+}
@@ -38,8 +38,10 @@ int	zbx_vc_get_cached_values(zbx_uint64_t itemid, unsigned char value_type, zbx_
 
 	for (chunk = item->tail; NULL != chunk; chunk = chunk->next)
 	{
+		zbx_history_record_t	*slots = vch_chunk_slots(item, chunk);
+
 		for (i = chunk->first_value; i <= chunk->last_value; i++)
-			vc_history_record_vector_append(values, value_type, &chunk->slots[i]);
+			vc_history_record_vector_append(values, value_type, &slots[i]);
 	}
 
 	return SUCCEED;
@@ -0,0 +1,57 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxhistory.h"
+#include "valuecache_codec.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vector_history_record_t	values, returned;
+	unsigned char			value_type, data[ZBX_KIBIBYTE * 16];
+	size_t				size;
+	int				ret;
+
+	ZBX_UNUSED(state);
+
+	zbx_history_record_vector_create(&values);
+	zbx_history_record_vector_create(&returned);
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in.value type"));
+	zbx_vcmock_read_values(zbx_mock_get_parameter_handle("in.data"), value_type, &values);
+
+	size = zbx_vc_codec_encode(values.values, values.values_num, value_type, data, sizeof(data));
+
+	if (0 == size)
+		fail_msg("cannot encode values");
+
+	if (size > zbx_mock_get_parameter_uint64("out.max size"))
+		fail_msg("encoded size " ZBX_FS_SIZE_T " exceeds expected maximum", (zbx_fs_size_t)size);
+
+	zbx_vector_history_record_reserve(&returned, (size_t)values.values_num);
+	returned.values_num = values.values_num;
+
+	ret = zbx_vc_codec_decode(data, size, value_type, returned.values, returned.values_num);
+	zbx_mock_assert_result_eq("zbx_vc_codec_decode() return value", SUCCEED, ret);
+
+	zbx_vcmock_check_records("Decoded values", value_type, &values, &returned);
+
+	zbx_history_record_vector_destroy(&returned, value_type);
+	zbx_history_record_vector_destroy(&values, value_type);
+}
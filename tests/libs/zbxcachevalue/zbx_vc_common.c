@@ -62,7 +62,7 @@ void	zbx_vc_common_test_func(
 	err = zbx_locks_create(&error);
 	zbx_mock_assert_result_eq("Lock initialization failed", SUCCEED, err);
 
-	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), 0, &error);
 	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
 
 	zbx_vc_enable();
@@ -0,0 +1,179 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxnum.h"
+#include "zbxcachevalue.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+#include "zbx_vc_common.h"
+
+static unsigned char	zbx_vc_test_str_to_window_type(const char *str)
+{
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_SUM"))
+		return ZBX_VC_WINDOW_SUM;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_AVG"))
+		return ZBX_VC_WINDOW_AVG;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_MIN"))
+		return ZBX_VC_WINDOW_MIN;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_MAX"))
+		return ZBX_VC_WINDOW_MAX;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_COUNT"))
+		return ZBX_VC_WINDOW_COUNT;
+
+	fail_msg("Unknown window type \"%s\"", str);
+
+	return ZBX_VC_WINDOW_SUM;
+}
+
+static unsigned char	zbx_vc_test_str_to_window_op(const char *str)
+{
+	if (NULL == str || 0 == strcmp(str, "ZBX_VC_WINDOW_OP_ANY"))
+		return ZBX_VC_WINDOW_OP_ANY;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_EQ"))
+		return ZBX_VC_WINDOW_OP_EQ;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_NE"))
+		return ZBX_VC_WINDOW_OP_NE;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_GT"))
+		return ZBX_VC_WINDOW_OP_GT;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_GE"))
+		return ZBX_VC_WINDOW_OP_GE;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_LT"))
+		return ZBX_VC_WINDOW_OP_LT;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_LE"))
+		return ZBX_VC_WINDOW_OP_LE;
+	if (0 == strcmp(str, "ZBX_VC_WINDOW_OP_BITAND"))
+		return ZBX_VC_WINDOW_OP_BITAND;
+
+	fail_msg("Unknown window filter \"%s\"", str);
+
+	return ZBX_VC_WINDOW_OP_ANY;
+}
+
+static void	zbx_vc_test_read_window(zbx_mock_handle_t handle, unsigned char value_type, zbx_vc_window_t *window)
+{
+	const char	*data;
+
+	memset(window, 0, sizeof(zbx_vc_window_t));
+
+	window->type = zbx_vc_test_str_to_window_type(zbx_mock_get_object_member_string(handle, "type"));
+	window->seconds = atoi(zbx_mock_get_object_member_string(handle, "seconds"));
+	window->op = zbx_vc_test_str_to_window_op(zbx_mock_get_optional_object_member_string(handle, "op"));
+
+	if (NULL != (data = zbx_mock_get_optional_object_member_string(handle, "pattern")))
+	{
+		if (ITEM_VALUE_TYPE_FLOAT == value_type)
+			window->pattern.dbl = atof(data);
+		else if (SUCCEED != zbx_is_uint64(data, &window->pattern.ui64))
+			fail_msg("Invalid window pattern \"%s\"", data);
+	}
+
+	if (NULL != (data = zbx_mock_get_optional_object_member_string(handle, "mask")) &&
+			SUCCEED != zbx_is_uint64(data, &window->mask))
+	{
+		fail_msg("Invalid window mask \"%s\"", data);
+	}
+}
+
+static void	zbx_vc_test_check_window_value(zbx_mock_handle_t hrequest, unsigned char value_type,
+		const zbx_vc_window_t *window, const zbx_history_value_t *value, int values_num)
+{
+	const char	*data;
+	zbx_uint64_t	expected;
+
+	zbx_mock_assert_int_eq("values_num", atoi(zbx_mock_get_object_member_string(hrequest, "values_num")),
+			values_num);
+
+	data = zbx_mock_get_object_member_string(hrequest, "value");
+
+	/* unsigned values are averaged as floating point sum, count is always unsigned */
+	if ((ITEM_VALUE_TYPE_FLOAT == value_type && ZBX_VC_WINDOW_COUNT != window->type) ||
+			ZBX_VC_WINDOW_AVG == window->type)
+	{
+		zbx_mock_assert_double_eq("window value", atof(data), value->dbl);
+		return;
+	}
+
+	if (SUCCEED != zbx_is_uint64(data, &expected))
+		fail_msg("Invalid window value \"%s\"", data);
+
+	zbx_mock_assert_uint64_eq("window value", expected, value->ui64);
+}
+
+void	zbx_vc_test_get_window_value_setup(zbx_mock_handle_t *handle, zbx_vector_dc_history_ptr_t *history,
+		int *err, const char **data, zbx_uint64_t *flush_err)
+{
+	zbx_mock_handle_t	hrequests, hrequest;
+	zbx_mock_error_t	mock_err;
+	zbx_uint64_t		itemid;
+	unsigned char		value_type;
+	zbx_vc_window_t		window;
+	zbx_history_value_t	value;
+	zbx_timespec_t		ts;
+	int			values_num;
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+
+	if (FAIL == zbx_is_uint64(zbx_mock_get_object_member_string(*handle, "itemid"), &itemid))
+		fail_msg("Invalid itemid value");
+
+	value_type = zbx_mock_str_to_value_type(zbx_mock_get_object_member_string(*handle, "value type"));
+	zbx_vc_test_read_window(zbx_mock_get_object_member_handle(*handle, "window"), value_type, &window);
+
+	/* the first request registers window */
+
+	zbx_strtime_to_timespec(zbx_mock_get_object_member_string(*handle, "register"), &ts);
+	*err = zbx_vc_get_window_value(itemid, value_type, &window, &ts, &value, &values_num);
+	zbx_vc_flush_stats();
+	zbx_mock_assert_result_eq("zbx_vc_get_window_value() registration return value", FAIL, *err);
+
+	zbx_vector_dc_history_ptr_create(history);
+	zbx_vcmock_get_dc_history(zbx_mock_get_object_member_handle(*handle, "values"), history);
+
+	*err = zbx_vc_add_values(history, flush_err);
+	zbx_mock_assert_result_eq("zbx_vc_add_values() return value", SUCCEED, *err);
+
+	zbx_vector_dc_history_ptr_clear_ext(history, zbx_vcmock_free_dc_history);
+	zbx_vector_dc_history_ptr_destroy(history);
+
+	hrequests = zbx_mock_get_object_member_handle(*handle, "requests");
+
+	while (ZBX_MOCK_END_OF_VECTOR != (mock_err = (zbx_mock_vector_element(hrequests, &hrequest))))
+	{
+		if (ZBX_MOCK_SUCCESS != mock_err)
+			fail_msg("Cannot read request: %s", zbx_mock_error_string(mock_err));
+
+		zbx_strtime_to_timespec(zbx_mock_get_object_member_string(hrequest, "end"), &ts);
+		*err = zbx_vc_get_window_value(itemid, value_type, &window, &ts, &value, &values_num);
+		zbx_vc_flush_stats();
+
+		*data = zbx_mock_get_object_member_string(hrequest, "return");
+		zbx_mock_assert_result_eq("zbx_vc_get_window_value() return value", zbx_mock_str_to_return_code(*data),
+				*err);
+
+		if (SUCCEED == *err)
+			zbx_vc_test_check_window_value(hrequest, value_type, &window, &value, values_num);
+	}
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vc_common_test_func(state, zbx_vc_test_get_window_value_setup, NULL, NULL, 0);
+}
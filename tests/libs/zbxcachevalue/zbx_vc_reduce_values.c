@@ -0,0 +1,89 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcachevalue.h"
+#include "zbxtime.h"
+#include "valuecache_test.h"
+#include "mocks/valuecache/valuecache_mock.h"
+
+#include "zbx_vc_common.h"
+
+typedef struct
+{
+	unsigned char			value_type;
+	zbx_vector_history_record_t	*records;
+}
+zbx_vc_test_reduce_t;
+
+/* collects reduced values in descending order to compare them with zbx_vc_get_values() output */
+static void	zbx_vc_test_collect(const zbx_history_record_t *records, int records_num, void *data)
+{
+	zbx_vc_test_reduce_t	*reduce = (zbx_vc_test_reduce_t *)data;
+	int			i;
+
+	for (i = 1; i < records_num; i++)
+	{
+		if (0 < zbx_timespec_compare(&records[i - 1].timestamp, &records[i].timestamp))
+			fail_msg("reduced values are not sorted in ascending order");
+	}
+
+	for (i = records_num - 1; 0 <= i; i--)
+	{
+		zbx_history_record_t	record;
+
+		zbx_history_record_copy(&record, &records[i], reduce->value_type);
+		zbx_vector_history_record_append_ptr(reduce->records, &record);
+	}
+}
+
+static void	zbx_vc_test_reduce_values_setup(zbx_mock_handle_t *handle, zbx_uint64_t *itemid,
+		unsigned char *value_type, zbx_timespec_t *ts, int *err, zbx_vector_history_record_t *expected,
+		zbx_vector_history_record_t *returned, int *seconds, int *count)
+{
+	zbx_vc_test_reduce_t	reduce;
+
+	/* perform request */
+
+	*handle = zbx_mock_get_parameter_handle("in.test");
+	zbx_vcmock_set_time(*handle, "time");
+	zbx_vcmock_set_mode(*handle, "cache mode");
+
+	zbx_vcmock_get_request_params(*handle, itemid, value_type, seconds, count, ts);
+
+	reduce.value_type = *value_type;
+	reduce.records = returned;
+
+	*err = zbx_vc_reduce_values(*itemid, *value_type, *seconds, *count, ts, zbx_vc_test_collect, &reduce);
+	zbx_vc_flush_stats();
+	zbx_mock_assert_result_eq("zbx_vc_reduce_values() return value", SUCCEED, *err);
+
+	/* validate results */
+
+	zbx_vcmock_read_values(zbx_mock_get_parameter_handle("out.values"), *value_type, expected);
+	zbx_vcmock_check_records("Reduced values", *value_type, expected, returned);
+
+	zbx_history_record_vector_clean(returned, *value_type);
+	zbx_history_record_vector_clean(expected, *value_type);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	zbx_vc_common_test_func(state, NULL, NULL, zbx_vc_test_reduce_values_setup, 1);
+}
@@ -29,6 +29,7 @@
 
 #include "mocks/valuecache/valuecache_mock.h"
 #include "../../../src/libs/zbxtrends/trends.h"
+#include "../../../src/libs/zbxcalc/funcreduce.h"
 
 int	__wrap_zbx_substitute_macros_args(zbx_token_search_t search, char **data, char *error, size_t maxerrlen,
 		zbx_macro_resolv_func_t resolver, va_list args);
@@ -96,7 +97,9 @@ zbx_uint64_t	__wrap_zbx_history_get_trends_flags(void)
 
 void	zbx_mock_test_entry(void **state)
 {
-	int			err, expected_ret, returned_ret;
+	int			err, expected_ret, returned_ret, impl,
+				impls[] = {FUNC_REDUCE_IMPL_SCALAR, FUNC_REDUCE_IMPL_AVX2};
+	size_t			i;
 	char			*error = NULL;
 	const char		*function, *params;
 	zbx_dc_item_t		item;
@@ -111,7 +114,7 @@ void	zbx_mock_test_entry(void **state)
 
 	zbx_update_epsilon_to_float_precision();
 
-	err = zbx_vc_init(get_zbx_config_value_cache_size(), &error);
+	err = zbx_vc_init(get_zbx_config_value_cache_size(), 0, &error);
 	zbx_mock_assert_result_eq("Value cache initialization failed", SUCCEED, err);
 
 	zbx_vc_enable();
@@ -139,55 +142,68 @@ void	zbx_mock_test_entry(void **state)
 	evaluate_item.host = item.host.host;
 	evaluate_item.key_orig = item.key_orig;
 
-	if (SUCCEED != (returned_ret = zbx_evaluate_function(&returned_value, &evaluate_item, function, params, &ts,
-			&selector, &error)))
-	{
-		printf("zbx_evaluate_function returned error: %s\n", error);
-		zbx_free(error);
-	}
-
-	zbx_vc_flush_stats();
-
-	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
-	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+	impl = func_reduce_get_impl();
 
-	if (SUCCEED == expected_ret)
+	for (i = 0; i < ARRSIZE(impls); i++)
 	{
-		const char		*expected_value;
-		zbx_uint64_t		expected_ui64;
+		/* skip implementations not supported by build or CPU */
+		if (SUCCEED != func_reduce_set_impl(impls[i]))
+			continue;
 
-		handle = zbx_mock_get_parameter_handle("out.value");
+		if (SUCCEED != (returned_ret = zbx_evaluate_function(&returned_value, &evaluate_item, function, params,
+				&ts, &selector, &error)))
+		{
+			printf("zbx_evaluate_function returned error: %s\n", error);
+			zbx_free(error);
+		}
 
-		if (ZBX_MOCK_SUCCESS != (err = zbx_mock_string_ex(handle, &expected_value)))
-			fail_msg("Cannot read output value: %s", zbx_mock_error_string(err));
+		zbx_vc_flush_stats();
 
-		switch (returned_value.type)
+		expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+		zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+
+		if (SUCCEED == expected_ret)
 		{
-			case ZBX_VARIANT_DBL:
-				zbx_mock_assert_double_eq("function result", atof(expected_value),
-						returned_value.data.dbl);
-				break;
-			case ZBX_VARIANT_UI64:
-				if (SUCCEED != zbx_is_uint64(expected_value, &expected_ui64))
-				{
-					fail_msg("function result '" ZBX_FS_UI64
-							"' does not match expected result '%s'",
-							returned_value.data.ui64, expected_value);
-				}
-				zbx_mock_assert_uint64_eq("function result", expected_ui64, returned_value.data.ui64);
-				break;
-			case ZBX_VARIANT_STR:
-				zbx_mock_assert_str_eq("function result", expected_value, returned_value.data.str);
-				break;
-			default:
-				fail_msg("function result '%s' has unexpected type '%s'",
-						zbx_variant_value_desc(&returned_value),
-						zbx_variant_type_desc(&returned_value));
-				break;
+			const char		*expected_value;
+			zbx_uint64_t		expected_ui64;
+
+			handle = zbx_mock_get_parameter_handle("out.value");
+
+			if (ZBX_MOCK_SUCCESS != (err = zbx_mock_string_ex(handle, &expected_value)))
+				fail_msg("Cannot read output value: %s", zbx_mock_error_string(err));
+
+			switch (returned_value.type)
+			{
+				case ZBX_VARIANT_DBL:
+					zbx_mock_assert_double_eq("function result", atof(expected_value),
+							returned_value.data.dbl);
+					break;
+				case ZBX_VARIANT_UI64:
+					if (SUCCEED != zbx_is_uint64(expected_value, &expected_ui64))
+					{
+						fail_msg("function result '" ZBX_FS_UI64
+								"' does not match expected result '%s'",
+								returned_value.data.ui64, expected_value);
+					}
+					zbx_mock_assert_uint64_eq("function result", expected_ui64,
+							returned_value.data.ui64);
+					break;
+				case ZBX_VARIANT_STR:
+					zbx_mock_assert_str_eq("function result", expected_value,
+							returned_value.data.str);
+					break;
+				default:
+					fail_msg("function result '%s' has unexpected type '%s'",
+							zbx_variant_value_desc(&returned_value),
+							zbx_variant_type_desc(&returned_value));
+					break;
+			}
 		}
+		if (SUCCEED == returned_ret)
+			zbx_variant_clear(&returned_value);
 	}
-	if (SUCCEED == returned_ret)
-		zbx_variant_clear(&returned_value);
+
+	(void)func_reduce_set_impl(impl);
 
 	zbx_vcmock_ds_destroy();
 
@@ -0,0 +1,130 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxcomms.h"
+#include "zbxcompress.h"
+#include "zbxjson.h"
+#include "zbxtime.h"
+
+static unsigned char	mock_get_codec_flag(const char *codec)
+{
+	if (0 == strcmp(codec, "zlib"))
+		return 0;
+
+	if (0 == strcmp(codec, "zstd"))
+		return ZBX_TCP_COMPRESS_ZSTD;
+
+	if (0 == strcmp(codec, "lz4"))
+		return ZBX_TCP_COMPRESS_LZ4;
+
+	fail_msg("unknown compression codec \"%s\"", codec);
+
+	return 0;
+}
+
+/* generates data similar to history data sent by proxy */
+static void	mock_proxy_data(struct zbx_json *j, int records)
+{
+	int	i;
+	char	value[64];
+
+	zbx_json_addstring(j, ZBX_PROTO_TAG_REQUEST, ZBX_PROTO_VALUE_PROXY_DATA, ZBX_JSON_TYPE_STRING);
+	zbx_json_addstring(j, ZBX_PROTO_TAG_HOST, "proxy", ZBX_JSON_TYPE_STRING);
+	zbx_json_addarray(j, ZBX_PROTO_TAG_HISTORY_DATA);
+
+	for (i = 0; i < records; i++)
+	{
+		zbx_json_addobject(j, NULL);
+		zbx_json_adduint64(j, ZBX_PROTO_TAG_ID, (zbx_uint64_t)i + 1);
+		zbx_json_adduint64(j, ZBX_PROTO_TAG_ITEMID, 10000 + (zbx_uint64_t)(i % 1000));
+		zbx_json_adduint64(j, ZBX_PROTO_TAG_CLOCK, 1700000000 + (zbx_uint64_t)(i / 1000));
+		zbx_json_adduint64(j, ZBX_PROTO_TAG_NS, (zbx_uint64_t)(i * 7919 % 1000000000));
+
+		if (0 == i % 3)
+			zbx_snprintf(value, sizeof(value), "%d", i * 31 % 65536);
+		else if (1 == i % 3)
+			zbx_snprintf(value, sizeof(value), "%.4f", (double)(i % 977) / 7);
+		else
+			zbx_snprintf(value, sizeof(value), "status of service %d: running", i % 50);
+
+		zbx_json_addstring(j, ZBX_PROTO_TAG_VALUE, value, ZBX_JSON_TYPE_STRING);
+		zbx_json_close(j);
+	}
+
+	zbx_json_close(j);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*codec_name = zbx_mock_get_parameter_string("in.codec");
+	int			records = zbx_mock_get_parameter_int("in.records"),
+				rounds = zbx_mock_get_parameter_int("in.rounds"), i, ret;
+	unsigned char		codec = mock_get_codec_flag(codec_name),
+				flags = ZBX_TCP_PROTOCOL | ZBX_TCP_COMPRESS | codec;
+	struct zbx_json		j;
+	char			*out;
+	size_t			out_size, compressed_size = 0;
+	double			t, t_compress = 0, t_uncompress = 0;
+	zbx_tcp_send_context_t	context;
+
+	ZBX_UNUSED(state);
+
+	if (SUCCEED != zbx_compress_codec_supported(zbx_tcp_compress_codec(codec)))
+		skip();
+
+	zbx_json_init(&j, ZBX_JSON_STAT_BUF_LEN);
+	mock_proxy_data(&j, records);
+
+	out = (char *)zbx_malloc(NULL, j.buffer_size);
+
+	for (i = 0; i < rounds; i++)
+	{
+		t = zbx_time();
+		ret = zbx_tcp_send_context_init(j.buffer, j.buffer_size, 0, flags, &context);
+		t_compress += zbx_time() - t;
+
+		zbx_mock_assert_result_eq("zbx_tcp_send_context_init() return value", SUCCEED, ret);
+		zbx_mock_assert_int_eq("protocol flags", flags, context.header_buf[ZBX_CONST_STRLEN("ZBXD")]);
+
+		out_size = j.buffer_size;
+
+		t = zbx_time();
+		ret = zbx_uncompress_ext(zbx_tcp_compress_codec(flags), context.data, context.send_len, out, &out_size);
+		t_uncompress += zbx_time() - t;
+
+		zbx_mock_assert_result_eq("zbx_uncompress_ext() return value", SUCCEED, ret);
+		zbx_mock_assert_uint64_eq("uncompressed size", j.buffer_size, out_size);
+
+		if (0 != memcmp(j.buffer, out, out_size))
+			fail_msg("uncompressed data does not match original data");
+
+		compressed_size = context.send_len;
+		zbx_tcp_send_context_clear(&context);
+	}
+
+	printf("%s: " ZBX_FS_SIZE_T " -> " ZBX_FS_SIZE_T " bytes (%.1f%%), compress %.1f MB/s,"
+			" uncompress %.1f MB/s\n", codec_name, (zbx_fs_size_t)j.buffer_size,
+			(zbx_fs_size_t)compressed_size, (double)compressed_size * 100 / (double)j.buffer_size,
+			(double)j.buffer_size * rounds / t_compress / ZBX_MEBIBYTE,
+			(double)j.buffer_size * rounds / t_uncompress / ZBX_MEBIBYTE);
+
+	zbx_free(out);
+	zbx_json_free(&j);
+}
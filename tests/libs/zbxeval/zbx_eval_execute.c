@@ -45,9 +45,44 @@ static void	check_expected_error(const char *actual_error)
 		fail_msg("Got\n'%s'\ninstead of\n'%s'", actual_error, expected_error);
 }
 
+static void	check_result(int expected_ret, int returned_ret, zbx_variant_t *value, const char *error)
+{
+	if (SUCCEED != returned_ret)
+		printf("ERROR: %s\n", error);
+
+	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+
+	if (SUCCEED == expected_ret)
+	{
+		/* use custom epsilon for floating point values to account for */
+		/* rounding differences with various systems/libs              */
+		if (ZBX_VARIANT_DBL == value->type)
+		{
+			double	expected_value = atof(zbx_mock_get_parameter_string("out.value"));
+
+			if (SUCCEED != zbx_double_compare(value->data.dbl, expected_value))
+			{
+				fail_msg("Expected value \"%.20f\" while got \"%.20f\"", expected_value,
+						value->data.dbl);
+			}
+		}
+		else
+		{
+			zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
+					zbx_variant_value_desc(value));
+		}
+
+		zbx_variant_clear(value);
+	}
+	else
+	{
+		check_expected_error(error);
+	}
+}
+
 void	zbx_mock_test_entry(void **state)
 {
-	zbx_eval_context_t	ctx;
+	zbx_eval_context_t	ctx, ctx_bin;
 	char			*error = NULL;
 	zbx_uint64_t		rules;
 	int			expected_ret, returned_ret;
@@ -55,6 +90,7 @@ void	zbx_mock_test_entry(void **state)
 	zbx_mock_handle_t	htime;
 	zbx_timespec_t		ts, *pts = NULL;
 	const char		*expression;
+	unsigned char		*data;
 
 	ZBX_UNUSED(state);
 
@@ -78,6 +114,9 @@ void	zbx_mock_test_entry(void **state)
 		goto out;
 	}
 
+	/* serialized context contains compiled expression, values are replaced after deserialization */
+	zbx_eval_serialize(&ctx, NULL, &data);
+
 	mock_eval_read_values(&ctx, "in.replace");
 
 	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("in.time", &htime))
@@ -97,38 +136,17 @@ void	zbx_mock_test_entry(void **state)
 	}
 
 	returned_ret = zbx_eval_execute(&ctx, pts, &value, &error);
+	check_result(expected_ret, returned_ret, &value, error);
+	zbx_free(error);
 
-	if (SUCCEED != returned_ret)
-		printf("ERROR: %s\n", error);
-
-	zbx_mock_assert_result_eq("return value", expected_ret, returned_ret);
+	zbx_eval_deserialize(&ctx_bin, expression, rules, data);
+	zbx_free(data);
 
-	if (SUCCEED == expected_ret)
-	{
-		/* use custom epsilon for floating point values to account for */
-		/* rounding differences with various systems/libs              */
-		if (ZBX_VARIANT_DBL == value.type)
-		{
-			double	expected_value = atof(zbx_mock_get_parameter_string("out.value"));
+	mock_eval_read_values(&ctx_bin, "in.replace");
 
-			if (SUCCEED != zbx_double_compare(value.data.dbl, expected_value))
-			{
-				fail_msg("Expected value \"%.20f\" while got \"%.20f\"", expected_value,
-						value.data.dbl);
-			}
-		}
-		else
-		{
-			zbx_mock_assert_str_eq("output value", zbx_mock_get_parameter_string("out.value"),
-					zbx_variant_value_desc(&value));
-		}
-
-		zbx_variant_clear(&value);
-	}
-	else
-	{
-		check_expected_error(error);
-	}
+	returned_ret = zbx_eval_execute(&ctx_bin, pts, &value, &error);
+	check_result(expected_ret, returned_ret, &value, error);
+	zbx_eval_clear(&ctx_bin);
 out:
 	zbx_free(error);
 	zbx_eval_clear(&ctx);
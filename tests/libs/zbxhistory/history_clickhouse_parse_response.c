@@ -21,9 +21,77 @@
 
 #include "../../../src/libs/zbxhistory/history_clickhouse.c"
 
+/* build RowBinary encoded response from the list of typed fields */
+static size_t	read_response(zbx_mock_handle_t hdata, char **response)
+{
+	zbx_mock_handle_t	hfield;
+	zbx_mock_error_t	err;
+	size_t			response_alloc = 0, response_offset = 0;
+
+	*response = zbx_strdup(NULL, "");
+	response_alloc = 1;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hdata, &hfield))))
+	{
+		const char	*type, *value;
+
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read response field: %s", zbx_mock_error_string(err));
+
+		type = zbx_mock_get_object_member_string(hfield, "type");
+		value = zbx_mock_get_object_member_string(hfield, "value");
+
+		if (0 == strcmp(type, "datetime64"))
+		{
+			zbx_timespec_t	ts;
+
+			if (ZBX_MOCK_SUCCESS != zbx_strtime_to_timespec(value, &ts))
+				fail_msg("invalid timestamp '%s'", value);
+
+			history_clickhouse_write_uint64((zbx_uint64_t)ts.sec * 1000000000ULL + ts.ns, response,
+					&response_alloc, &response_offset);
+		}
+		else if (0 == strcmp(type, "uint64"))
+		{
+			zbx_uint64_t	ui64;
+
+			if (SUCCEED != zbx_is_uint64(value, &ui64))
+				fail_msg("invalid uint64 value '%s'", value);
+
+			history_clickhouse_write_uint64(ui64, response, &response_alloc, &response_offset);
+		}
+		else if (0 == strcmp(type, "uint32"))
+		{
+			history_clickhouse_write_uint32((zbx_uint32_t)atoi(value), response, &response_alloc,
+					&response_offset);
+		}
+		else if (0 == strcmp(type, "float64"))
+		{
+			history_clickhouse_write_dbl(atof(value), response, &response_alloc, &response_offset);
+		}
+		else if (0 == strcmp(type, "string"))
+		{
+			history_clickhouse_write_text(value, response, &response_alloc, &response_offset);
+		}
+		else if (0 == strcmp(type, "raw"))
+		{
+			char	buf[ZBX_KIBIBYTE];
+			int	len;
+
+			len = zbx_hex2bin((const unsigned char *)value, (unsigned char *)buf, (int)sizeof(buf));
+			zbx_str_memcpy_alloc(response, &response_alloc, &response_offset, buf, (size_t)len);
+		}
+		else
+			fail_msg("unknown field type '%s'", type);
+	}
+
+	return response_offset;
+}
+
 void	zbx_mock_test_entry(void **state)
 {
 	char				*response;
+	size_t				response_size;
 	unsigned char			value_type;
 	zbx_vector_history_record_t	values_exp, values_out;
 	zbx_history_record_t		*values = NULL;
@@ -34,14 +102,14 @@ void	zbx_mock_test_entry(void **state)
 	zbx_vector_history_record_create(&values_exp);
 	zbx_vector_history_record_create(&values_out);
 
-	response = zbx_strdup(NULL, zbx_mock_get_parameter_string("in.data"));
+	response_size = read_response(zbx_mock_get_parameter_handle("in.data"), &response);
 	value_type = zbx_mock_str_to_value_type(zbx_mock_get_parameter_string("in['value type']"));
 	ret_exp = zbx_mock_get_parameter_int("out.result");
 
 	if (0 < ret_exp)
 		zbx_vcmock_read_values(zbx_mock_get_parameter_handle("out.values"), value_type, &values_exp);
 
-	ret_out = history_clickhouse_parse_response(response, value_type, &values);
+	ret_out = history_clickhouse_parse_response(response, response_size, value_type, &values);
 
 	zbx_mock_assert_int_eq("history_clickhouse_parse_response() return value", ret_exp, ret_out);
 
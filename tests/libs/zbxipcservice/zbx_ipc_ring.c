@@ -0,0 +1,308 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+/* ring source must be included first as it defines _GNU_SOURCE */
+#include "../../../src/libs/zbxipcservice/ipcring.c"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#ifdef ZBX_IPC_RING
+
+#define RING_TEST_WRAPAROUND	1
+#define RING_TEST_MARKER	2
+#define RING_TEST_OVERSIZED	3
+#define RING_TEST_INVALID	4
+
+#define RING_TEST_MESSAGE_CODE	1
+
+static int	get_test_type(const char *str)
+{
+	if (0 == strcmp(str, "WRAPAROUND"))
+		return RING_TEST_WRAPAROUND;
+
+	if (0 == strcmp(str, "MARKER"))
+		return RING_TEST_MARKER;
+
+	if (0 == strcmp(str, "OVERSIZED"))
+		return RING_TEST_OVERSIZED;
+
+	if (0 == strcmp(str, "INVALID"))
+		return RING_TEST_INVALID;
+
+	fail_msg("unknown test type: %s", str);
+	return FAIL;
+}
+
+static void	mock_read_sizes(zbx_mock_handle_t hdata, zbx_vector_uint32_t *sizes)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hvalue;
+	zbx_uint64_t		value;
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hdata, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_uint64(hvalue, &value)))
+			fail_msg("Cannot read vector member: %s", zbx_mock_error_string(err));
+
+		zbx_vector_uint32_append(sizes, (zbx_uint32_t)value);
+	}
+}
+
+static unsigned char	*ring_message_create(zbx_uint32_t size, zbx_uint32_t seed)
+{
+	unsigned char	*data;
+
+	data = (unsigned char *)zbx_malloc(NULL, MAX(size, 1));
+
+	for (zbx_uint32_t i = 0; i < size; i++)
+		data[i] = (unsigned char)(seed + i * 31);
+
+	return data;
+}
+
+static void	ring_message_check(zbx_ipc_ring_t *ring, zbx_uint32_t code, zbx_uint32_t size, zbx_uint32_t seed)
+{
+	zbx_uint32_t	code_read, size_read;
+	unsigned char	*data, *expected;
+	char		*error = NULL;
+
+	zbx_mock_assert_int_eq("ring read", SUCCEED, zbx_ipc_ring_read(ring, &code_read, &data, &size_read, &error));
+	zbx_mock_assert_uint64_eq("message code", code, code_read);
+	zbx_mock_assert_uint64_eq("message size", size, size_read);
+
+	if (0 == size)
+	{
+		zbx_mock_assert_ptr_eq("message data", NULL, data);
+		return;
+	}
+
+	expected = ring_message_create(size, seed);
+
+	if (0 != memcmp(expected, data, size))
+		fail_msg("message data mismatch, size:%u seed:%u", size, seed);
+
+	zbx_free(expected);
+	zbx_free(data);
+}
+
+static void	ring_check_empty(zbx_ipc_ring_t *ring)
+{
+	zbx_uint32_t	code, size;
+	unsigned char	*data;
+	char		*error = NULL;
+
+	zbx_mock_assert_int_eq("ring read", ZBX_IPC_RING_EMPTY, zbx_ipc_ring_read(ring, &code, &data, &size, &error));
+}
+
+static zbx_ipc_ring_t	*ring_create(void)
+{
+	zbx_ipc_ring_t	*ring;
+	char		*error = NULL;
+
+	if (SUCCEED != zbx_ipc_ring_create(&ring, (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.size"), &error))
+		fail_msg("cannot create ring: %s", error);
+
+	zbx_mock_assert_uint64_eq("ring size", zbx_mock_get_parameter_uint64("out.size"), ring->size);
+
+	return ring;
+}
+
+/* writes and reads messages of the specified sizes, so record positions move over the ring end */
+static void	test_ring_wraparound(void)
+{
+	zbx_ipc_ring_t		*ring;
+	zbx_vector_uint32_t	sizes;
+	int			iterations;
+	zbx_uint32_t		seed = 0;
+	unsigned char		*data;
+
+	zbx_vector_uint32_create(&sizes);
+	mock_read_sizes(zbx_mock_get_parameter_handle("in.messages"), &sizes);
+	iterations = zbx_mock_get_parameter_int("in.iterations");
+
+	ring = ring_create();
+
+	for (int i = 0; i < iterations; i++)
+	{
+		for (int j = 0; j < sizes.values_num; j++)
+		{
+			data = ring_message_create(sizes.values[j], seed + (zbx_uint32_t)j);
+			zbx_mock_assert_int_eq("ring write", SUCCEED, zbx_ipc_ring_write(ring, RING_TEST_MESSAGE_CODE,
+					data, sizes.values[j]));
+			zbx_free(data);
+		}
+
+		for (int j = 0; j < sizes.values_num; j++)
+			ring_message_check(ring, RING_TEST_MESSAGE_CODE, sizes.values[j], seed + (zbx_uint32_t)j);
+
+		ring_check_empty(ring);
+		seed += (zbx_uint32_t)sizes.values_num;
+	}
+
+	if ((zbx_uint32_t)atomic_load(&ring->ctl->tail) <= ring->size)
+		fail_msg("ring positions did not wrap around");
+
+	zbx_ipc_ring_free(ring);
+	zbx_vector_uint32_destroy(&sizes);
+}
+
+/* fills ring and checks that marker still fits and that reading rings the space doorbell */
+static void	test_ring_marker(void)
+{
+	zbx_ipc_ring_t	*ring;
+	zbx_uint32_t	size, seed, written = 0;
+	unsigned char	*data;
+	int		fds[2];
+	zbx_uint64_t	value;
+
+	size = (zbx_uint32_t)zbx_mock_get_parameter_uint64("in.message_size");
+	ring = ring_create();
+
+	if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+		fail_msg("cannot create socket pair: %s", zbx_strerror(errno));
+
+	for (seed = 0;; seed++)
+	{
+		data = ring_message_create(size, seed);
+
+		if (SUCCEED != zbx_ipc_ring_write(ring, RING_TEST_MESSAGE_CODE, data, size))
+		{
+			zbx_free(data);
+			break;
+		}
+
+		zbx_free(data);
+		written++;
+	}
+
+	zbx_mock_assert_uint64_eq("messages written", zbx_mock_get_parameter_uint64("out.messages"), written);
+	zbx_mock_assert_int_eq("write marker", SUCCEED, zbx_ipc_ring_write_marker(ring, fds[0]));
+
+	/* simulate client waiting for free space */
+	atomic_store(&ring->ctl->writer_waiting, 1);
+
+	for (seed = 0; seed < written; seed++)
+	{
+		ring_message_check(ring, RING_TEST_MESSAGE_CODE, size, seed);
+
+		if (0 == seed)
+		{
+			zbx_mock_assert_int_eq("writer waiting", 0, atomic_load(&ring->ctl->writer_waiting));
+			zbx_mock_assert_int_eq("space doorbell", sizeof(value), (int)read(ring->space, &value,
+					sizeof(value)));
+		}
+	}
+
+	ring_message_check(ring, ZBX_IPC_RING_CODE_MARKER, 0, 0);
+	ring_check_empty(ring);
+
+	/* the doorbell is rung only once per wait */
+	zbx_mock_assert_int_eq("space doorbell", -1, (int)read(ring->space, &value, sizeof(value)));
+
+	close(fds[0]);
+	close(fds[1]);
+	zbx_ipc_ring_free(ring);
+}
+
+/* checks that messages larger than quarter of ring are left for socket */
+static void	test_ring_oversized(void)
+{
+	zbx_ipc_ring_t	*ring;
+	zbx_uint32_t	size;
+	unsigned char	*data;
+
+	ring = ring_create();
+	size = ZBX_IPC_RING_MESSAGE_MAX(ring);
+
+	data = ring_message_create(size + 1, 0);
+
+	zbx_mock_assert_int_eq("oversized write", FAIL, zbx_ipc_ring_write(ring, RING_TEST_MESSAGE_CODE, data,
+			size + 1));
+	ring_check_empty(ring);
+
+	zbx_mock_assert_int_eq("maximum size write", SUCCEED, zbx_ipc_ring_write(ring, RING_TEST_MESSAGE_CODE, data,
+			size));
+	ring_message_check(ring, RING_TEST_MESSAGE_CODE, size, 0);
+	ring_check_empty(ring);
+
+	zbx_free(data);
+	zbx_ipc_ring_free(ring);
+}
+
+/* corrupts ring record the same way a misbehaving client could and checks that it's rejected */
+static void	test_ring_invalid(void)
+{
+	zbx_ipc_ring_t	*ring;
+	zbx_uint32_t	code, size, header[2];
+	unsigned char	*data;
+	const char	*corrupt;
+	char		*error = NULL;
+
+	ring = ring_create();
+	data = ring_message_create(64, 0);
+	zbx_mock_assert_int_eq("ring write", SUCCEED, zbx_ipc_ring_write(ring, RING_TEST_MESSAGE_CODE, data, 64));
+	zbx_free(data);
+
+	corrupt = zbx_mock_get_parameter_string("in.corrupt");
+	memcpy(header, ring->data, sizeof(header));
+
+	if (0 == strcmp(corrupt, "message_max"))
+		header[1] = ZBX_IPC_RING_MESSAGE_MAX(ring) + 1;
+	else if (0 == strcmp(corrupt, "record"))
+		header[1] = 65;
+	else if (0 == strcmp(corrupt, "tail"))
+		atomic_store(&ring->ctl->tail, ring->size + 8);
+	else if (0 == strcmp(corrupt, "header"))
+		atomic_store(&ring->ctl->tail, ZBX_IPC_HEADER_SIZE - 1);
+	else
+		fail_msg("unknown corruption type: %s", corrupt);
+
+	memcpy(ring->data, header, sizeof(header));
+
+	zbx_mock_assert_int_eq("ring read", FAIL, zbx_ipc_ring_read(ring, &code, &data, &size, &error));
+	zbx_mock_assert_ptr_ne("error", NULL, error);
+	zbx_mock_assert_uint64_eq("head", 0, atomic_load(&ring->ctl->head));
+
+	zbx_free(error);
+	zbx_ipc_ring_free(ring);
+}
+#endif
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+#ifdef ZBX_IPC_RING
+	switch (get_test_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case RING_TEST_WRAPAROUND:
+			test_ring_wraparound();
+			break;
+		case RING_TEST_MARKER:
+			test_ring_marker();
+			break;
+		case RING_TEST_OVERSIZED:
+			test_ring_oversized();
+			break;
+		case RING_TEST_INVALID:
+			test_ring_invalid();
+			break;
+	}
+#else
+	skip();
+#endif
+}
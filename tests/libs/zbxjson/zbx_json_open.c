@@ -0,0 +1,82 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+#include "../../../src/libs/zbxjson/json_scan.h"
+
+#define JSON_TEST_ALIGN	64
+
+/* open JSON placed at the specified offset from 64 byte boundary to cover all block positions */
+static void	json_test_open(const char *json, int offset, int expected_ret, int expected_count)
+{
+	struct zbx_json_parse	jp, jp_brackets;
+	char			*buffer, *ptr;
+	size_t			len;
+	int			ret;
+
+	len = strlen(json);
+	buffer = (char *)zbx_malloc(NULL, len + JSON_TEST_ALIGN * 2 + 1);
+	ptr = (char *)(((uintptr_t)buffer + JSON_TEST_ALIGN - 1) & ~(uintptr_t)(JSON_TEST_ALIGN - 1)) + offset;
+	memcpy(ptr, json, len + 1);
+
+	ret = zbx_json_open(ptr, &jp);
+	zbx_mock_assert_result_eq("zbx_json_open() return value", expected_ret, ret);
+
+	if (SUCCEED == ret)
+	{
+		zbx_mock_assert_int_eq("element count", expected_count, zbx_json_count(&jp));
+
+		ret = zbx_json_brackets_open(jp.start, &jp_brackets);
+		zbx_mock_assert_result_eq("zbx_json_brackets_open() return value", SUCCEED, ret);
+		zbx_mock_assert_ptr_eq("closing bracket position", jp.end, jp_brackets.end);
+	}
+
+	zbx_free(buffer);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*json;
+	int		expected_ret, expected_count = 0, offset, impl,
+			impls[] = {JSON_SCAN_IMPL_SCALAR, JSON_SCAN_IMPL_SSE2, JSON_SCAN_IMPL_AVX2};
+	size_t		i;
+
+	ZBX_UNUSED(state);
+
+	json = zbx_mock_get_parameter_string("in.json");
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+
+	if (SUCCEED == expected_ret)
+		expected_count = (int)zbx_mock_get_parameter_uint64("out.count");
+
+	impl = json_scan_get_impl();
+
+	for (i = 0; i < ARRSIZE(impls); i++)
+	{
+		/* skip implementations not supported by build or CPU */
+		if (SUCCEED != json_scan_set_impl(impls[i]))
+			continue;
+
+		for (offset = 0; offset < JSON_TEST_ALIGN; offset++)
+			json_test_open(json, offset, expected_ret, expected_count);
+	}
+
+	(void)json_scan_set_impl(impl);
+}
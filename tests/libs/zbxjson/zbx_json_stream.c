@@ -0,0 +1,102 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxcommon.h"
+#include "zbxjson.h"
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+typedef struct
+{
+	char	*events;
+	size_t	events_alloc;
+	size_t	events_offset;
+}
+zbx_stream_events_t;
+
+static int	json_stream_cb(void *data, int event, const char *name, const char *value, size_t len)
+{
+	zbx_stream_events_t	*events = (zbx_stream_events_t *)data;
+
+	zbx_mock_assert_uint64_eq("Value length", strlen(value), len);
+
+	switch (event)
+	{
+		case ZBX_JSON_STREAM_MEMBER:
+			zbx_snprintf_alloc(&events->events, &events->events_alloc, &events->events_offset,
+					"member:%s=%s\n", name, value);
+			break;
+		case ZBX_JSON_STREAM_ARRAY:
+			zbx_snprintf_alloc(&events->events, &events->events_alloc, &events->events_offset,
+					"array:%s\n", name);
+			break;
+		case ZBX_JSON_STREAM_ELEMENT:
+			zbx_snprintf_alloc(&events->events, &events->events_alloc, &events->events_offset,
+					"element:%s=%s\n", name, value);
+			break;
+		case ZBX_JSON_STREAM_ARRAY_END:
+			zbx_snprintf_alloc(&events->events, &events->events_alloc, &events->events_offset,
+					"end:%s\n", name);
+			break;
+		default:
+			fail_msg("unknown event %d", event);
+	}
+
+	return SUCCEED;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char	*json, *expected_events;
+	size_t		json_len, chunk_size, offset;
+	int		expected_ret;
+
+	ZBX_UNUSED(state);
+
+	json = zbx_mock_get_parameter_string("in.json");
+	json_len = strlen(json);
+	expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.return"));
+	expected_events = zbx_mock_get_parameter_string("out.events");
+
+	/* the result must not depend on how data is split into chunks */
+	for (chunk_size = 1; chunk_size <= json_len; chunk_size++)
+	{
+		zbx_json_stream_t	stream;
+		zbx_stream_events_t	events = {0};
+		int			ret = SUCCEED;
+
+		zbx_strcpy_alloc(&events.events, &events.events_alloc, &events.events_offset, "");
+		zbx_json_stream_init(&stream, json_stream_cb, &events);
+
+		for (offset = 0; offset < json_len && SUCCEED == ret; offset += chunk_size)
+			ret = zbx_json_stream_feed(&stream, json + offset, MIN(chunk_size, json_len - offset));
+
+		if (SUCCEED == ret)
+			ret = zbx_json_stream_finish(&stream);
+
+		if (SUCCEED != ret)
+			printf("chunk size " ZBX_FS_SIZE_T ": %s\n", (zbx_fs_size_t)chunk_size, zbx_json_strerror());
+
+		zbx_mock_assert_result_eq("zbx_json_stream_feed() return value", expected_ret, ret);
+
+		if (SUCCEED == expected_ret)
+			zbx_mock_assert_str_eq("Stream events", expected_events, events.events);
+
+		zbx_json_stream_clear(&stream);
+		zbx_free(events.events);
+	}
+}
@@ -46,22 +46,18 @@ static void	check_indefinite_path_result(zbx_mock_handle_t handle, const char *r
 	zbx_mock_assert_json_eq("Indefinite query result", expected_output, returned_output);
 }
 
-static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
+static void	check_query_result(const char *func, int returned_ret, const char *output, int expected_ret)
 {
-	char			*output = NULL;
-	int			returned_ret;
 	zbx_mock_handle_t	handle;
 
-	returned_ret = zbx_jsonobj_query(obj, path, &output);
-
 	if (FAIL == returned_ret)
-		printf("\tzbx_jsonpath_query() failed with: %s\n", zbx_json_strerror());
+		printf("\t%s failed with: %s\n", func, zbx_json_strerror());
 
 	zbx_mock_assert_result_eq("zbx_jsonpath_query() return value", expected_ret, returned_ret);
 
 	if (SUCCEED == returned_ret)
 	{
-		printf("\tzbx_jsonpath_query() query result: %s\n", ZBX_NULL2EMPTY_STR(output));
+		printf("\t%s query result: %s\n", func, ZBX_NULL2EMPTY_STR(output));
 		if (ZBX_MOCK_SUCCESS == zbx_mock_parameter("out.value", &handle))
 		{
 			zbx_mock_assert_ptr_ne("Query result", NULL, output);
@@ -77,16 +73,61 @@ static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
 	}
 	else
 		zbx_mock_assert_str_ne("tzbx_jsonpath_query() error", "", zbx_json_strerror());
+}
+
+static void	test_query(zbx_jsonobj_t *obj, const char *path, int expected_ret)
+{
+	char	*output = NULL;
+	int	returned_ret;
+
+	returned_ret = zbx_jsonobj_query(obj, path, &output);
+	check_query_result("zbx_jsonobj_query()", returned_ret, output, expected_ret);
+
+	zbx_free(output);
+}
+
+static void	test_query_data(zbx_jsonpath_cache_t *cache, const char *data, const char *path, int expected_ret)
+{
+	char			*output = NULL;
+	int			returned_ret;
+	const zbx_jsonpath_t	*jsonpath;
+
+	if (NULL != (jsonpath = zbx_jsonpath_cache_get(cache, path)))
+		returned_ret = zbx_jsonpath_query_data(data, jsonpath, &output);
+	else
+		returned_ret = FAIL;
+
+	check_query_result("zbx_jsonpath_query_data()", returned_ret, output, expected_ret);
 
 	zbx_free(output);
+}
+
+static void	test_query_tape(zbx_jsontape_t *tape, zbx_jsonpath_index_t *index, const char *path, int expected_ret)
+{
+	char		*output = NULL;
+	int		returned_ret;
+	zbx_jsonpath_t	jsonpath;
 
+	if (SUCCEED == (returned_ret = zbx_jsonpath_compile(path, &jsonpath)))
+	{
+		returned_ret = zbx_jsontape_query(tape, index, &jsonpath, &output);
+		zbx_jsonpath_clear(&jsonpath);
+	}
+
+	check_query_result("zbx_jsontape_query()", returned_ret, output, expected_ret);
+
+	zbx_free(output);
 }
 
 void	zbx_mock_test_entry(void **state)
 {
-	const char	*data, *path;
-	int		expected_ret;
-	zbx_jsonobj_t	obj;
+	const char		*data, *path;
+	int			expected_ret;
+	char			*error = NULL;
+	zbx_jsonobj_t		obj;
+	zbx_jsonpath_cache_t	*cache;
+	zbx_jsontape_t		*tape;
+	zbx_jsonpath_index_t	*index;
 
 	ZBX_UNUSED(state);
 
@@ -106,4 +147,27 @@ void	zbx_mock_test_entry(void **state)
 	test_query(&obj, path, expected_ret);
 
 	zbx_jsonobj_clear(&obj);
+
+	/* query json data with compiled path, the second query uses cached path */
+	cache = zbx_jsonpath_cache_create();
+
+	zbx_set_json_strerror("%s", "");
+	test_query_data(cache, data, path, expected_ret);
+	test_query_data(cache, data, path, expected_ret);
+
+	zbx_jsonpath_cache_free(cache);
+
+	/* query json tape, the second query uses lookup indexes and json objects created by the first query */
+	if (NULL == (tape = zbx_jsontape_open(data, &error)))
+		fail_msg("Cannot open json tape: %s", error);
+
+	if (NULL == (index = zbx_jsonpath_index_create(&error)))
+		fail_msg("Cannot create jsonpath index: %s", error);
+
+	zbx_set_json_strerror("%s", "");
+	test_query_tape(tape, index, path, expected_ret);
+	test_query_tape(tape, index, path, expected_ret);
+
+	zbx_jsonpath_index_free(index);
+	zbx_jsontape_free(tape);
 }
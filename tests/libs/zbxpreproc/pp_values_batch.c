@@ -0,0 +1,305 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcachehistory.h"
+#include "zbx_item_constants.h"
+#include "zbxtime.h"
+#include "libs/zbxpreproc/pp_protocol.h"
+
+static void	read_result(zbx_mock_handle_t hvalue, AGENT_RESULT *result, unsigned char *state, const char **error)
+{
+	const char		*type, *value, *str;
+	zbx_mock_handle_t	hmember;
+
+	zbx_init_agent_result(result);
+	*state = ITEM_STATE_NORMAL;
+	*error = NULL;
+
+	type = zbx_mock_get_object_member_string(hvalue, "type");
+	value = zbx_mock_get_object_member_string(hvalue, "value");
+
+	if (0 == strcmp(type, "ui64"))
+	{
+		zbx_uint64_t	ui64;
+
+		if (SUCCEED != zbx_is_uint64(value, &ui64))
+			fail_msg("invalid unsigned value '%s'", value);
+
+		SET_UI64_RESULT(result, ui64);
+	}
+	else if (0 == strcmp(type, "dbl"))
+	{
+		SET_DBL_RESULT(result, atof(value));
+	}
+	else if (0 == strcmp(type, "str"))
+	{
+		SET_STR_RESULT(result, zbx_strdup(NULL, value));
+	}
+	else if (0 == strcmp(type, "err"))
+	{
+		*state = ITEM_STATE_NOTSUPPORTED;
+		*error = value;
+	}
+	else if (0 == strcmp(type, "log"))
+	{
+		zbx_log_t	*log;
+
+		log = (zbx_log_t *)zbx_malloc(NULL, sizeof(zbx_log_t));
+		memset(log, 0, sizeof(zbx_log_t));
+		log->value = zbx_strdup(NULL, value);
+
+		if (NULL != (str = zbx_mock_get_optional_object_member_string(hvalue, "source")))
+			log->source = zbx_strdup(NULL, str);
+
+		log->severity = zbx_mock_get_object_member_int(hvalue, "severity");
+		log->logeventid = zbx_mock_get_object_member_int(hvalue, "logeventid");
+		log->timestamp = zbx_mock_get_object_member_int(hvalue, "timestamp");
+
+		SET_LOG_RESULT(result, log);
+	}
+	else
+		fail_msg("unknown value type '%s'", type);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_object_member(hvalue, "lastlogsize", &hmember))
+	{
+		result->lastlogsize = zbx_mock_get_object_member_uint64(hvalue, "lastlogsize");
+		result->mtime = zbx_mock_get_object_member_int(hvalue, "mtime");
+		result->type |= AR_META;
+	}
+}
+
+static void	check_value(zbx_mock_handle_t hvalue, zbx_uint64_t itemid, const zbx_timespec_t *ts,
+		const zbx_pp_value_view_t *view)
+{
+	AGENT_RESULT		result;
+	unsigned char		state;
+	const char		*error;
+	zbx_variant_t		value;
+	zbx_pp_value_opt_t	opt;
+
+	zbx_mock_assert_uint64_eq("itemid", itemid, view->itemid);
+	zbx_mock_assert_timespec_eq("timestamp", ts, &view->ts);
+
+	read_result(hvalue, &result, &state, &error);
+
+	/* compare owned copy to check both the view and copying */
+	zbx_pp_value_view_copy(view, &value, &opt);
+
+	if (ITEM_STATE_NOTSUPPORTED == state)
+	{
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_ERR, value.type);
+		zbx_mock_assert_str_eq("error", error, value.data.err);
+	}
+	else if (ZBX_ISSET_LOG(&result))
+	{
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_STR, value.type);
+		zbx_mock_assert_str_eq("value", result.log->value, value.data.str);
+
+		if (0 == (opt.flags & ZBX_PP_VALUE_OPT_LOG))
+			fail_msg("expected log options");
+
+		if (NULL != result.log->source)
+			zbx_mock_assert_str_eq("source", result.log->source, opt.source);
+		else
+			zbx_mock_assert_ptr_eq("source", NULL, opt.source);
+
+		zbx_mock_assert_int_eq("severity", result.log->severity, opt.severity);
+		zbx_mock_assert_int_eq("logeventid", result.log->logeventid, opt.logeventid);
+		zbx_mock_assert_int_eq("log timestamp", result.log->timestamp, opt.timestamp);
+	}
+	else if (ZBX_ISSET_UI64(&result))
+	{
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_UI64, value.type);
+		zbx_mock_assert_uint64_eq("value", result.ui64, value.data.ui64);
+	}
+	else if (ZBX_ISSET_DBL(&result))
+	{
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_DBL, value.type);
+		zbx_mock_assert_double_eq("value", result.dbl, value.data.dbl);
+	}
+	else if (ZBX_ISSET_STR(&result))
+	{
+		zbx_mock_assert_int_eq("variant type", ZBX_VARIANT_STR, value.type);
+		zbx_mock_assert_str_eq("value", result.str, value.data.str);
+	}
+
+	if (ZBX_ISSET_META(&result))
+	{
+		if (0 == (opt.flags & ZBX_PP_VALUE_OPT_META))
+			fail_msg("expected meta options");
+
+		zbx_mock_assert_uint64_eq("lastlogsize", result.lastlogsize, opt.lastlogsize);
+		zbx_mock_assert_int_eq("mtime", result.mtime, opt.mtime);
+	}
+	else if (0 != (opt.flags & ZBX_PP_VALUE_OPT_META))
+		fail_msg("unexpected meta options");
+
+	zbx_variant_clear(&value);
+	zbx_free(opt.source);
+	zbx_free_agent_result(&result);
+}
+
+static void	test_values(void)
+{
+	zbx_pp_values_batch_t		batch = {0};
+	zbx_vector_pp_value_view_t	values;
+	zbx_mock_handle_t		hvalues, hvalue;
+	zbx_mock_error_t		err;
+	AGENT_RESULT			result;
+	unsigned char			state;
+	const char			*error;
+	zbx_timespec_t			ts;
+	int				i, ret;
+
+	zbx_vector_pp_value_view_create(&values);
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	for (i = 0; ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))); i++)
+	{
+		if (ZBX_MOCK_SUCCESS != err)
+			fail_msg("cannot read value #%d: %s", i, zbx_mock_error_string(err));
+
+		read_result(hvalue, &result, &state, &error);
+
+		ts.sec = i;
+		ts.ns = i * 1000;
+
+		ret = zbx_pp_values_batch_add(&batch, (zbx_uint64_t)i + 1, ITEM_VALUE_TYPE_TEXT, 0,
+				ZBX_PREPROC_NONE, &result, &ts, state, error);
+		zbx_mock_assert_result_eq("zbx_pp_values_batch_add() return value", SUCCEED, ret);
+
+		zbx_free_agent_result(&result);
+	}
+
+	zbx_mock_assert_int_eq("batch value count", i, batch.values_num);
+
+	ret = zbx_pp_values_batch_unpack(batch.data, batch.data_offset, &values);
+	zbx_mock_assert_result_eq("zbx_pp_values_batch_unpack() return value", SUCCEED, ret);
+	zbx_mock_assert_int_eq("unpacked value count", batch.values_num, values.values_num);
+
+	hvalues = zbx_mock_get_parameter_handle("in.values");
+
+	for (i = 0; ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue); i++)
+	{
+		ts.sec = i;
+		ts.ns = i * 1000;
+		check_value(hvalue, (zbx_uint64_t)i + 1, &ts, &values.values[i]);
+	}
+
+	/* truncated batches must be rejected */
+	if (ZBX_PP_VALUES_BATCH_HEADER_SIZE < batch.data_offset)
+	{
+		zbx_vector_pp_value_view_clear(&values);
+		ret = zbx_pp_values_batch_unpack(batch.data, batch.data_offset - 1, &values);
+		zbx_mock_assert_result_eq("zbx_pp_values_batch_unpack() truncated return value", FAIL, ret);
+	}
+
+	zbx_vector_pp_value_view_destroy(&values);
+	zbx_pp_values_batch_destroy(&batch);
+}
+
+/* corrupts fields of a single string value record and checks that the batch is rejected */
+static void	test_corrupt(void)
+{
+/* offsets of the first record fields in batch */
+#define PP_TEST_RECORD_LEN	ZBX_PP_VALUES_BATCH_HEADER_SIZE
+#define PP_TEST_VARIANT_TYPE	(PP_TEST_RECORD_LEN + sizeof(zbx_uint32_t) + sizeof(zbx_uint64_t) + 3)
+#define PP_TEST_STR_LEN		(PP_TEST_VARIANT_TYPE + 1)
+#define PP_TEST_STR		(PP_TEST_STR_LEN + sizeof(zbx_uint32_t))
+	zbx_pp_values_batch_t		batch = {0};
+	zbx_vector_pp_value_view_t	values;
+	AGENT_RESULT			result;
+	zbx_timespec_t			ts = {1, 0};
+	zbx_uint32_t			size, value, len;
+	const char			*corrupt;
+	int				ret;
+
+	zbx_vector_pp_value_view_create(&values);
+	zbx_init_agent_result(&result);
+	SET_STR_RESULT(&result, zbx_strdup(NULL, zbx_mock_get_parameter_string("in.value")));
+
+	ret = zbx_pp_values_batch_add(&batch, 1, ITEM_VALUE_TYPE_STR, 0, ZBX_PREPROC_NONE, &result, &ts,
+			ITEM_STATE_NORMAL, NULL);
+	zbx_mock_assert_result_eq("zbx_pp_values_batch_add() return value", SUCCEED, ret);
+
+	size = batch.data_offset;
+	memcpy(&len, batch.data + PP_TEST_STR_LEN, sizeof(len));
+	corrupt = zbx_mock_get_parameter_string("in.corrupt");
+
+	if (0 == strcmp(corrupt, "none"))
+	{
+		/* valid record to ensure the offsets used by the test are correct */
+		ret = zbx_pp_values_batch_unpack(batch.data, size, &values);
+		zbx_mock_assert_result_eq("zbx_pp_values_batch_unpack() return value", SUCCEED, ret);
+		zbx_mock_assert_str_eq("value", (const char *)batch.data + PP_TEST_STR, values.values[0].value.data.str);
+	}
+	else
+	{
+		if (0 == strcmp(corrupt, "value_count"))
+		{
+			value = zbx_mock_get_parameter_uint32("in.field");
+			memcpy(batch.data + sizeof(zbx_uint32_t), &value, sizeof(value));
+		}
+		else if (0 == strcmp(corrupt, "record_length"))
+		{
+			/* the record and the batch shrink together, so only the record fields are out of bounds */
+			memcpy(&value, batch.data + PP_TEST_RECORD_LEN, sizeof(value));
+			value -= zbx_mock_get_parameter_uint32("in.field");
+			size -= zbx_mock_get_parameter_uint32("in.field");
+			memcpy(batch.data + PP_TEST_RECORD_LEN, &value, sizeof(value));
+		}
+		else if (0 == strcmp(corrupt, "variant_type"))
+		{
+			batch.data[PP_TEST_VARIANT_TYPE] = (unsigned char)zbx_mock_get_parameter_uint32("in.field");
+		}
+		else if (0 == strcmp(corrupt, "string_length"))
+		{
+			value = len + zbx_mock_get_parameter_uint32("in.field");
+			memcpy(batch.data + PP_TEST_STR_LEN, &value, sizeof(value));
+		}
+		else if (0 == strcmp(corrupt, "string_terminator"))
+		{
+			batch.data[PP_TEST_STR + len - 1] = 'x';
+		}
+		else
+			fail_msg("unknown corruption type: %s", corrupt);
+
+		ret = zbx_pp_values_batch_unpack(batch.data, size, &values);
+		zbx_mock_assert_result_eq("zbx_pp_values_batch_unpack() return value", FAIL, ret);
+	}
+
+	zbx_free_agent_result(&result);
+	zbx_vector_pp_value_view_destroy(&values);
+	zbx_pp_values_batch_destroy(&batch);
+#undef PP_TEST_RECORD_LEN
+#undef PP_TEST_VARIANT_TYPE
+#undef PP_TEST_STR_LEN
+#undef PP_TEST_STR
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.corrupt"))
+		test_corrupt();
+	else
+		test_values();
+}
@@ -0,0 +1,317 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxcacheconfig.h"
+#include "zbx_item_constants.h"
+#include "zbxtime.h"
+#include "libs/zbxpreproc/pp_queue.h"
+#include "libs/zbxpreproc/pp_task.h"
+#include "libs/zbxpreproc/pp_worker.h"
+
+#define PP_TEST_QUEUE	1
+#define PP_TEST_WORKER	2
+
+typedef struct
+{
+	zbx_pp_queue_t			*queue;
+	zbx_vector_pp_task_ptr_t	finished;
+	int				flushes_num;
+}
+pp_test_worker_data_t;
+
+/* the reference held by test keeps tasks from releasing user macro cache */
+static zbx_dc_um_shared_handle_t	test_um_handle = {NULL, 1};
+
+static int	get_test_type(const char *str)
+{
+	if (0 == strcmp(str, "QUEUE"))
+		return PP_TEST_QUEUE;
+
+	if (0 == strcmp(str, "WORKER"))
+		return PP_TEST_WORKER;
+
+	fail_msg("unknown test type: %s", str);
+	return FAIL;
+}
+
+static void	mock_read_ints(const char *path, zbx_vector_int32_t *values)
+{
+	zbx_mock_error_t	err;
+	zbx_mock_handle_t	hvalues, hvalue;
+	int			value;
+
+	hvalues = zbx_mock_get_parameter_handle(path);
+
+	while (ZBX_MOCK_END_OF_VECTOR != (err = (zbx_mock_vector_element(hvalues, &hvalue))))
+	{
+		if (ZBX_MOCK_SUCCESS != err || ZBX_MOCK_SUCCESS != (err = zbx_mock_int(hvalue, &value)))
+			fail_msg("Cannot read vector member: %s", zbx_mock_error_string(err));
+
+		zbx_vector_int32_append(values, value);
+	}
+}
+
+/* queues values for items in round robin order, value timestamp is the value index */
+static void	pp_test_push_values(zbx_pp_queue_t *queue, zbx_pp_item_preproc_t **preprocs, int values_num,
+		int items_num)
+{
+	for (int i = 0; i < values_num; i++)
+	{
+		zbx_variant_t	value;
+		zbx_timespec_t	ts = {i, 0};
+		zbx_pp_task_t	*task;
+
+		zbx_variant_set_ui64(&value, (zbx_uint64_t)i);
+		task = pp_task_value_create((zbx_uint64_t)(i % items_num + 1), preprocs[i % items_num], &test_um_handle,
+				&value, ts, NULL, NULL);
+		pp_task_queue_push(queue, task, ZBX_ITEM_PREPROCESSING_REGULAR);
+	}
+}
+
+/* checks that all values were finished and values of each item were returned in the order they were queued */
+static void	pp_test_check_order(const zbx_vector_pp_task_ptr_t *finished, int values_num, int items_num)
+{
+	zbx_vector_int32_t	last;
+
+	zbx_mock_assert_int_eq("finished tasks", values_num, finished->values_num);
+
+	zbx_vector_int32_create(&last);
+
+	for (int i = 0; i < items_num; i++)
+		zbx_vector_int32_append(&last, -1);
+
+	for (int i = 0; i < finished->values_num; i++)
+	{
+		zbx_pp_task_t		*task = finished->values[i];
+		zbx_pp_task_value_t	*d = (zbx_pp_task_value_t *)PP_TASK_DATA(task);
+		int			index = (int)task->itemid - 1;
+
+		if (d->ts.sec <= last.values[index])
+		{
+			fail_msg("item " ZBX_FS_UI64 " value %d finished after value %d", task->itemid, d->ts.sec,
+					last.values[index]);
+		}
+
+		last.values[index] = d->ts.sec;
+	}
+
+	zbx_vector_int32_destroy(&last);
+}
+
+/* pops batches as a single worker would while other workers are idle, then finishes tasks in reverse order */
+static void	test_pp_queue(void)
+{
+	zbx_pp_queue_t			queue;
+	zbx_pp_item_preproc_t		*preproc, **preprocs;
+	zbx_vector_pp_task_ptr_t	tasks, popped, finished;
+	zbx_vector_int32_t		batches;
+	zbx_pp_task_t			*task;
+	int				values_num, items_num, workers_num, batch = 0;
+	char				*error = NULL;
+
+	values_num = zbx_mock_get_parameter_int("in.values");
+	items_num = zbx_mock_get_parameter_int("in.items");
+	workers_num = zbx_mock_get_parameter_int("in.workers");
+
+	memset(&queue, 0, sizeof(queue));
+
+	if (SUCCEED != pp_task_queue_init(&queue, 1000, &error))
+		fail_msg("cannot initialize task queue: %s", error);
+
+	for (int i = 0; i < workers_num; i++)
+		pp_task_queue_register_worker(&queue);
+
+	preproc = zbx_pp_item_preproc_create(0, ITEM_VALUE_TYPE_UINT64, 0);
+	preprocs = (zbx_pp_item_preproc_t **)zbx_malloc(NULL, sizeof(zbx_pp_item_preproc_t *) * (size_t)items_num);
+
+	for (int i = 0; i < items_num; i++)
+		preprocs[i] = preproc;
+
+	pp_test_push_values(&queue, preprocs, values_num, items_num);
+
+	zbx_vector_pp_task_ptr_create(&tasks);
+	zbx_vector_pp_task_ptr_create(&popped);
+	zbx_vector_pp_task_ptr_create(&finished);
+	zbx_vector_int32_create(&batches);
+	mock_read_ints("out.batches", &batches);
+
+	for (pp_task_queue_pop_new_batch(&queue, &tasks); 0 != tasks.values_num;
+			pp_task_queue_pop_new_batch(&queue, &tasks))
+	{
+		if (batch >= batches.values_num)
+			fail_msg("more batches than expected %d", batches.values_num);
+
+		zbx_mock_assert_int_eq("batch size", batches.values[batch++], tasks.values_num);
+		zbx_vector_pp_task_ptr_append_array(&popped, tasks.values, tasks.values_num);
+		zbx_vector_pp_task_ptr_clear(&tasks);
+	}
+
+	zbx_mock_assert_int_eq("number of batches", batches.values_num, batch);
+	zbx_mock_assert_uint64_eq("processing tasks", (zbx_uint64_t)values_num, queue.processing_num);
+
+	for (int i = popped.values_num - 1; 0 <= i; i--)
+		pp_task_queue_push_finished(&queue, popped.values[i]);
+
+	while (NULL != (task = pp_task_queue_pop_finished(&queue)))
+		zbx_vector_pp_task_ptr_append(&finished, task);
+
+	pp_test_check_order(&finished, values_num, items_num);
+	zbx_mock_assert_uint64_eq("processing tasks", 0, queue.processing_num);
+
+	zbx_pp_tasks_clear(&finished);
+	zbx_vector_pp_task_ptr_destroy(&finished);
+	zbx_vector_pp_task_ptr_destroy(&popped);
+	zbx_vector_pp_task_ptr_destroy(&tasks);
+	zbx_vector_int32_destroy(&batches);
+
+	zbx_free(preprocs);
+	zbx_pp_item_preproc_release(preproc);
+	pp_task_queue_destroy(&queue);
+}
+
+/* called by worker within task queue lock, collects finished tasks like manager would */
+static void	pp_test_finished_task_cb(void *data)
+{
+	pp_test_worker_data_t	*worker_data = (pp_test_worker_data_t *)data;
+	zbx_pp_task_t		*task;
+
+	worker_data->flushes_num++;
+
+	while (NULL != (task = pp_task_queue_pop_finished(worker_data->queue)))
+		zbx_vector_pp_task_ptr_append(&worker_data->finished, task);
+}
+
+/* processes single batch by worker thread and checks how many times the results were returned to manager */
+static void	test_pp_worker(void)
+{
+	zbx_pp_queue_t		queue;
+	zbx_pp_worker_t		worker;
+	zbx_pp_item_preproc_t	*preproc, *preproc_script, **preprocs;
+	zbx_timekeeper_t	*timekeeper;
+	pp_test_worker_data_t	worker_data;
+	int			values_num, items_num, finished_num;
+	const char		*script;
+	char			*error = NULL;
+
+	values_num = zbx_mock_get_parameter_int("in.values");
+	items_num = zbx_mock_get_parameter_int("in.items");
+
+	memset(&queue, 0, sizeof(queue));
+
+	if (SUCCEED != pp_task_queue_init(&queue, 1000, &error))
+		fail_msg("cannot initialize task queue: %s", error);
+
+	preproc = zbx_pp_item_preproc_create(0, ITEM_VALUE_TYPE_UINT64, 0);
+	preproc_script = zbx_pp_item_preproc_create(0, ITEM_VALUE_TYPE_UINT64, 0);
+	preprocs = (zbx_pp_item_preproc_t **)zbx_malloc(NULL, sizeof(zbx_pp_item_preproc_t *) * (size_t)items_num);
+
+	for (int i = 0; i < items_num; i++)
+		preprocs[i] = preproc;
+
+	if (NULL != (script = zbx_mock_get_optional_parameter_string("in.script")))
+	{
+		zbx_vector_int32_t	script_items;
+
+		preproc_script->steps_num = 1;
+		preproc_script->steps = (zbx_pp_step_t *)zbx_malloc(NULL, sizeof(zbx_pp_step_t));
+		preproc_script->steps[0].type = ZBX_PREPROC_SCRIPT;
+		preproc_script->steps[0].error_handler = ZBX_PREPROC_FAIL_DEFAULT;
+		preproc_script->steps[0].params = zbx_strdup(NULL, script);
+		preproc_script->steps[0].error_handler_params = NULL;
+
+		/* script is used by all items unless only some of them are listed */
+		zbx_vector_int32_create(&script_items);
+
+		if (ZBX_MOCK_SUCCESS == zbx_mock_parameter_exists("in.script_items"))
+			mock_read_ints("in.script_items", &script_items);
+
+		for (int i = 0; i < items_num; i++)
+		{
+			if (0 == script_items.values_num || FAIL != zbx_vector_int32_search(&script_items, i + 1,
+					ZBX_DEFAULT_INT_COMPARE_FUNC))
+			{
+				preprocs[i] = preproc_script;
+			}
+		}
+
+		zbx_vector_int32_destroy(&script_items);
+	}
+
+	/* queue all values before worker starts, so they are popped in single batch */
+	pp_test_push_values(&queue, preprocs, values_num, items_num);
+
+	worker_data.queue = &queue;
+	worker_data.flushes_num = 0;
+	zbx_vector_pp_task_ptr_create(&worker_data.finished);
+
+	timekeeper = zbx_timekeeper_create(1, NULL);
+
+	memset(&worker, 0, sizeof(worker));
+	pp_worker_set_finished_task_cb(&worker, pp_test_finished_task_cb, &worker_data);
+
+	if (SUCCEED != pp_worker_init(&worker, 1, &queue, timekeeper, NULL, &error))
+		fail_msg("cannot start worker: %s", error);
+
+	do
+	{
+		const struct timespec	delay = {0, 1000000};
+
+		nanosleep(&delay, NULL);
+
+		pp_task_queue_lock(&queue);
+		finished_num = worker_data.finished.values_num;
+		pp_task_queue_unlock(&queue);
+	}
+	while (finished_num < values_num);
+
+	pp_task_queue_lock(&queue);
+	pp_worker_stop(&worker);
+	pp_task_queue_notify_all(&queue);
+	pp_task_queue_unlock(&queue);
+
+	pp_worker_destroy(&worker);
+
+	zbx_mock_assert_int_eq("results returned to manager", zbx_mock_get_parameter_int("out.flushes"),
+			worker_data.flushes_num);
+	pp_test_check_order(&worker_data.finished, values_num, items_num);
+
+	zbx_pp_tasks_clear(&worker_data.finished);
+	zbx_vector_pp_task_ptr_destroy(&worker_data.finished);
+
+	zbx_timekeeper_free(timekeeper);
+	zbx_free(preprocs);
+	zbx_pp_item_preproc_release(preproc_script);
+	zbx_pp_item_preproc_release(preproc);
+	pp_task_queue_destroy(&queue);
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	ZBX_UNUSED(state);
+
+	switch (get_test_type(zbx_mock_get_parameter_string("in.type")))
+	{
+		case PP_TEST_QUEUE:
+			test_pp_queue();
+			break;
+		case PP_TEST_WORKER:
+			test_pp_worker();
+			break;
+	}
+}
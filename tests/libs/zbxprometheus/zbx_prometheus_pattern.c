@@ -22,9 +22,10 @@
 
 void	zbx_mock_test_entry(void **state)
 {
-	const char	*data, *params, *output, *request;
-	char		*ret_err = NULL, *ret_output = NULL;
-	int		ret, expected_ret;
+	const char		*data, *params, *output, *request;
+	char			*ret_err = NULL, *ret_output = NULL;
+	int			ret, expected_ret;
+	zbx_prometheus_t	prom;
 
 	ZBX_UNUSED(state);
 
@@ -41,10 +42,30 @@ void	zbx_mock_test_entry(void **state)
 
 	if (SUCCEED == ret)
 	{
-		output = zbx_mock_get_parameter_string("out.output");
-		zbx_mock_assert_str_eq("Invalid zbx_prometheus_pattern() returned output", output, ret_output);
-		zbx_free(ret_output);
+		zbx_mock_assert_str_eq("Invalid zbx_prometheus_pattern() returned output",
+				zbx_mock_get_parameter_string("out.output"), ret_output);
 	}
 	else
 		zbx_free(ret_err);
+
+	/* the data parsed once and cached must give the same results */
+	if (SUCCEED == zbx_prometheus_init(&prom, data, &ret_err))
+	{
+		char	*prom_output = NULL;
+
+		ret = zbx_prometheus_pattern_ex(&prom, params, request, output, &prom_output, &ret_err);
+		zbx_mock_assert_result_eq("Invalid zbx_prometheus_pattern_ex() return value", expected_ret, ret);
+
+		if (SUCCEED == ret)
+		{
+			zbx_mock_assert_str_eq("Invalid zbx_prometheus_pattern_ex() returned output", ret_output,
+					prom_output);
+			zbx_free(prom_output);
+		}
+
+		zbx_prometheus_clear(&prom);
+	}
+
+	zbx_free(ret_err);
+	zbx_free(ret_output);
 }
@@ -0,0 +1,102 @@
+/*
+** Copyright (C) 2001-2026 Zabbix SIA
+**
+** This program is free software: you can redistribute it and/or modify it under the terms of
+** the GNU Affero General Public License as published by the Free Software Foundation, version 3.
+**
+** This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+** without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+** See the GNU Affero General Public License for more details.
+**
+** You should have received a copy of the GNU Affero General Public License along with this program.
+** If not, see <https://www.gnu.org/licenses/>.
+**/
+
+#include "zbxmocktest.h"
+#include "zbxmockdata.h"
+#include "zbxmockassert.h"
+#include "zbxmockutil.h"
+
+#include "zbxregexp.h"
+
+/* matches value against cached and freshly compiled patterns */
+static int	regexp_match_cached(const char *pattern, const char *value)
+{
+	const zbx_regexp_t	*cached;
+	zbx_regexp_t		*regexp;
+	char			*error = NULL;
+	int			ret, expected_ret;
+
+	if (SUCCEED != zbx_regexp_compile(pattern, &regexp, &error))
+		fail_msg("cannot compile pattern \"%s\": %s", pattern, error);
+
+	expected_ret = zbx_regexp_match_precompiled2(value, regexp, NULL);
+	zbx_regexp_free(regexp);
+
+	if (SUCCEED != zbx_regexp_compile_cached(pattern, &cached, &error))
+		fail_msg("cannot compile cached pattern \"%s\": %s", pattern, error);
+
+	ret = zbx_regexp_match_precompiled2(value, cached, NULL);
+	zbx_mock_assert_int_eq("cached regexp match result", expected_ret, ret);
+
+	return ret;
+}
+
+void	zbx_mock_test_entry(void **state)
+{
+	const char		*pattern, *value;
+	zbx_mock_handle_t	hvalues, hvalue;
+	int			i, j, rounds, patterns_num, ret, expected_ret;
+	char			*error = NULL;
+	const zbx_regexp_t	*regexp;
+
+	ZBX_UNUSED(state);
+
+	pattern = zbx_mock_get_parameter_string("in.pattern");
+	rounds = zbx_mock_get_parameter_int("in.rounds");
+	patterns_num = zbx_mock_get_parameter_int("in.patterns");
+
+	if (SUCCEED == zbx_mock_str_to_return_code(zbx_mock_get_parameter_string("out.compile")))
+	{
+		if (SUCCEED != zbx_regexp_compile_cached(pattern, &regexp, &error))
+			fail_msg("cannot compile pattern \"%s\": %s", pattern, error);
+	}
+	else
+	{
+		if (SUCCEED == zbx_regexp_compile_cached(pattern, &regexp, &error))
+			fail_msg("invalid pattern \"%s\" was compiled", pattern);
+
+		zbx_free(error);
+		goto out;
+	}
+
+	for (i = 0; i < rounds; i++)
+	{
+		hvalues = zbx_mock_get_parameter_handle("out.values");
+
+		while (ZBX_MOCK_SUCCESS == zbx_mock_vector_element(hvalues, &hvalue))
+		{
+			value = zbx_mock_get_object_member_string(hvalue, "value");
+			expected_ret = zbx_mock_str_to_return_code(zbx_mock_get_object_member_string(hvalue, "result"));
+
+			ret = (ZBX_REGEXP_MATCH == regexp_match_cached(pattern, value) ? SUCCEED : FAIL);
+
+			if (ret != expected_ret)
+			{
+				fail_msg("String \"%s\" unexpectedly %s pattern \"%s\"", value,
+						SUCCEED == ret ? "matches" : "doesn't match", pattern);
+			}
+
+			/* other patterns used in between can evict the pattern from cache */
+			for (j = 0; j < patterns_num; j++)
+			{
+				char	buf[32];
+
+				zbx_snprintf(buf, sizeof(buf), "^value%d$", j);
+				(void)regexp_match_cached(buf, value);
+			}
+		}
+	}
+out:
+	zbx_deinit_regexp_env();
+}
@@ -35,9 +35,8 @@ void	get_macros(const char *path, zbx_vector_lld_macro_path_ptr_t *macros)
 		if (ZBX_MOCK_SUCCESS != err)
 			fail_msg("Cannot read macro #%d: %s", macros_num, zbx_mock_error_string(err));
 
-		macro = (zbx_lld_macro_path_t *)zbx_malloc(NULL, sizeof(zbx_lld_macro_path_t));
-		macro->lld_macro = zbx_strdup(NULL, zbx_mock_get_object_member_string(hmacro, "macro"));
-		macro->path = zbx_strdup(NULL, zbx_mock_get_object_member_string(hmacro, "path"));
+		macro = lld_macro_path_create(zbx_mock_get_object_member_string(hmacro, "macro"),
+				zbx_mock_get_object_member_string(hmacro, "path"));
 		zbx_vector_lld_macro_path_ptr_append(macros, macro);
 
 		macros_num++;
@@ -30,6 +30,8 @@ void	zbx_mock_test_entry(void **state)
 	zbx_jsonobj_t			obj1, obj2;
 	zbx_hashset_t			entries1, entries2;
 	int				expected_ret, returned_ret;
+	zbx_vector_lld_macro_t		exported_macros;
+	zbx_uint64_t			fingerprint1, fingerprint2;
 
 	ZBX_UNUSED(state);
 
@@ -59,6 +61,18 @@ void	zbx_mock_test_entry(void **state)
 
 	zbx_mock_assert_result_eq("lld_compare_entries", expected_ret, returned_ret);
 
+	zbx_vector_lld_macro_create(&exported_macros);
+
+	fingerprint1 = lld_entries_fingerprint(&entries1, &exported_macros);
+	fingerprint2 = lld_entries_fingerprint(&entries2, &exported_macros);
+
+	if (SUCCEED == expected_ret)
+		zbx_mock_assert_uint64_eq("lld_entries_fingerprint", fingerprint1, fingerprint2);
+	else
+		zbx_mock_assert_uint64_ne("lld_entries_fingerprint", fingerprint1, fingerprint2);
+
+	zbx_vector_lld_macro_destroy(&exported_macros);
+
 	zbx_hashset_destroy(&entries1);
 	zbx_hashset_destroy(&entries2);
 
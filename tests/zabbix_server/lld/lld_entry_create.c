@@ -39,10 +39,7 @@ static void	load_macro_paths(zbx_vector_lld_macro_path_ptr_t *macro_paths)
 		macro = zbx_mock_get_object_member_string(element, "macro");
 		path = zbx_mock_get_object_member_string(element, "path");
 
-		macro_path = (zbx_lld_macro_path_t *)zbx_malloc(NULL, sizeof(zbx_lld_macro_path_t));
-		macro_path->lld_macro = zbx_strdup(NULL, macro);
-		macro_path->path = zbx_strdup(NULL, path);
-
+		macro_path = lld_macro_path_create(macro, path);
 		zbx_vector_lld_macro_path_ptr_append(macro_paths, macro_path);
 	}
 }